@@ -0,0 +1,179 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisConvolutionEnginesBenchmark.h"
+
+#include <simpletest.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QtMath>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_iterator_ng.h>
+#include <kis_convolution_painter.h>
+#include <kis_convolution_kernel.h>
+
+/**
+ * Compares the convolution engines on kernels of different size and
+ * rank. The box kernel is separable, so the separable engine should
+ * be the fastest one for it. The disc kernel has high rank, so the
+ * automatic selection should fall back to FFT for the big ones.
+ */
+
+#define IMAGE_WIDTH 1024
+#define IMAGE_HEIGHT 1024
+
+namespace {
+
+void addEngineRows(const QList<int> &sizes)
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("engine");
+
+    const QList<QPair<QString, KisConvolutionPainter::EnginePreference>> engines = {
+        {"auto", KisConvolutionPainter::NONE},
+        {"spatial", KisConvolutionPainter::SPATIAL},
+        {"fftw", KisConvolutionPainter::FFTW},
+        {"separable", KisConvolutionPainter::SEPARABLE}
+    };
+
+    for (int size : sizes) {
+        for (const auto &engine : engines) {
+            // the spatial engine is just too slow for the huge kernels
+            if (engine.second == KisConvolutionPainter::SPATIAL && size > 33) continue;
+
+            QTest::newRow(QString("%1-%2").arg(size).arg(engine.first).toLatin1())
+                << size << int(engine.second);
+        }
+    }
+}
+
+void benchmarkKernel(KisPaintDeviceSP src, KisConvolutionKernelSP kernel, int engine)
+{
+    const QRect rc(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+
+    KisConvolutionPainter painter(dst, KisConvolutionPainter::EnginePreference(engine));
+
+    QBENCHMARK_ONCE {
+        painter.applyMatrix(kernel, src, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+    }
+}
+
+}
+
+void KisConvolutionEnginesBenchmark::initTestCase()
+{
+    m_colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    m_device = new KisPaintDevice(m_colorSpace);
+
+    KoColor color(m_colorSpace);
+    srand(31524744);
+
+    KisSequentialIterator it(m_device, QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        color.fromQColor(QColor(rand() % 255, rand() % 255, rand() % 255));
+        memcpy(it.rawData(), color.data(), m_colorSpace->pixelSize());
+    }
+}
+
+void KisConvolutionEnginesBenchmark::testBoxKernel_data()
+{
+    addEngineRows({5, 9, 17, 33, 65, 129});
+}
+
+void KisConvolutionEnginesBenchmark::testBoxKernel()
+{
+    QFETCH(int, size);
+    QFETCH(int, engine);
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix =
+        Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>::Ones(size, size);
+
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0.0, size * size);
+    benchmarkKernel(m_device, kernel, engine);
+}
+
+void KisConvolutionEnginesBenchmark::testDiscKernel_data()
+{
+    addEngineRows({5, 9, 17, 33, 65, 129});
+}
+
+void KisConvolutionEnginesBenchmark::testDiscKernel()
+{
+    QFETCH(int, size);
+    QFETCH(int, engine);
+
+    QImage image(size, size, QImage::Format_RGB32);
+    image.fill(0);
+
+    {
+        QPainter gc(&image);
+        gc.setRenderHint(QPainter::Antialiasing);
+        gc.setPen(Qt::NoPen);
+        gc.setBrush(Qt::white);
+        gc.drawEllipse(QRectF(0, 0, size, size));
+    }
+
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromQImage(image);
+    benchmarkKernel(m_device, kernel, engine);
+}
+
+void KisConvolutionEnginesBenchmark::testMotionLine_data()
+{
+    QTest::addColumn<int>("length");
+    QTest::addColumn<bool>("useLineIntegral");
+
+    for (int length : {16, 32, 64, 128, 256}) {
+        QTest::newRow(QString("%1-matrix").arg(length).toLatin1()) << length << false;
+        QTest::newRow(QString("%1-line-integral").arg(length).toLatin1()) << length << true;
+    }
+}
+
+void KisConvolutionEnginesBenchmark::testMotionLine()
+{
+    QFETCH(int, length);
+    QFETCH(bool, useLineIntegral);
+
+    const QRect rc(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+    KisPaintDeviceSP dst = new KisPaintDevice(m_colorSpace);
+    KisConvolutionPainter painter(dst);
+
+    // a diagonal line, the worst case for the matrix kernel
+    const QPointF halfLine(0.5 * length, 0.25 * length);
+
+    if (useLineIntegral) {
+        QBENCHMARK_ONCE {
+            painter.applyLineIntegral(halfLine, m_device, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+        }
+    } else {
+        const QSize kernelSize(2 * qCeil(qAbs(halfLine.x())) + 1, 2 * qCeil(qAbs(halfLine.y())) + 1);
+
+        QImage image(kernelSize, QImage::Format_RGB32);
+        image.fill(0);
+
+        {
+            QPainter gc(&image);
+            gc.setRenderHint(QPainter::Antialiasing);
+            gc.setPen(QPen(Qt::white, 1.0));
+            const QPointF center(0.5 * kernelSize.width(), 0.5 * kernelSize.height());
+            gc.drawLine(center - halfLine, center + halfLine);
+        }
+
+        KisConvolutionKernelSP kernel = KisConvolutionKernel::fromQImage(image);
+
+        QBENCHMARK_ONCE {
+            painter.applyMatrix(kernel, m_device, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisConvolutionEnginesBenchmark)
@@ -0,0 +1,35 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISCONVOLUTIONENGINESBENCHMARK_H
+#define KISCONVOLUTIONENGINESBENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+class KoColorSpace;
+
+class KisConvolutionEnginesBenchmark : public QObject
+{
+    Q_OBJECT
+private:
+    const KoColorSpace *m_colorSpace;
+    KisPaintDeviceSP m_device;
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testBoxKernel_data();
+    void testBoxKernel();
+
+    void testDiscKernel_data();
+    void testDiscKernel();
+
+    void testMotionLine_data();
+    void testMotionLine();
+};
+
+#endif // KISCONVOLUTIONENGINESBENCHMARK_H
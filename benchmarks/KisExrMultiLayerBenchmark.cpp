@@ -0,0 +1,140 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisExrMultiLayerBenchmark.h"
+
+#include <QTemporaryFile>
+#include <QDir>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+
+#include <KisPart.h>
+#include <KisDocument.h>
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_group_layer.h>
+#include <kis_sequential_iterator.h>
+#include <kis_properties_configuration.h>
+
+/**
+ * Saves and loads a multilayer render-sized image, both as scanlines and
+ * as tiles, to measure the parallel EXR converter
+ */
+
+#define IMAGE_WIDTH 4096
+#define IMAGE_HEIGHT 2160
+#define NUM_LAYERS 8
+
+namespace {
+
+const QByteArray ExrMimetype = "application/x-extension-exr";
+
+KisPropertiesConfigurationSP exportConfiguration(bool tiled)
+{
+    KisPropertiesConfigurationSP configuration = new KisPropertiesConfiguration();
+    configuration->setProperty("flatten", false);
+    configuration->setProperty("tiled", tiled);
+    return configuration;
+}
+
+void addTiledRows()
+{
+    QTest::addColumn<bool>("tiled");
+
+    QTest::newRow("scanlines") << false;
+    QTest::newRow("tiled") << true;
+}
+
+}
+
+void KisExrMultiLayerBenchmark::initTestCase()
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float16BitsColorDepthID.id(), QString());
+
+    m_image = new KisImage(0, IMAGE_WIDTH, IMAGE_HEIGHT, cs, "exr benchmark");
+
+    // smooth gradients, which is how renders usually look
+    QVector<float> channels(4);
+
+    for (int i = 0; i < NUM_LAYERS; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(m_image, QString("layer%1").arg(i), OPACITY_OPAQUE_U8);
+
+        KisSequentialIterator it(layer->paintDevice(), QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+        while (it.nextPixel()) {
+            channels[0] = float(it.x()) / IMAGE_WIDTH * (i + 1);
+            channels[1] = float(it.y()) / IMAGE_HEIGHT;
+            channels[2] = float((it.x() + it.y()) % 256) / 256.0f;
+            channels[3] = 1.0f;
+            cs->fromNormalisedChannelsValue(it.rawData(), channels);
+        }
+
+        m_image->addNode(layer, m_image->root());
+    }
+
+    m_image->waitForDone();
+}
+
+void KisExrMultiLayerBenchmark::cleanupTestCase()
+{
+    m_image.clear();
+}
+
+void KisExrMultiLayerBenchmark::testSaving_data()
+{
+    addTiledRows();
+}
+
+void KisExrMultiLayerBenchmark::testSaving()
+{
+    QFETCH(bool, tiled);
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setFileBatchMode(true);
+    doc->setCurrentImage(m_image);
+
+    QTemporaryFile savedFile(QDir::tempPath() + QLatin1String("/krita_XXXXXX") + QLatin1String(".exr"));
+    savedFile.setAutoRemove(true);
+    savedFile.open();
+
+    KisPropertiesConfigurationSP configuration = exportConfiguration(tiled);
+
+    QBENCHMARK {
+        QVERIFY(doc->exportDocumentSync(savedFile.fileName(), ExrMimetype, configuration));
+    }
+}
+
+void KisExrMultiLayerBenchmark::testLoading_data()
+{
+    addTiledRows();
+}
+
+void KisExrMultiLayerBenchmark::testLoading()
+{
+    QFETCH(bool, tiled);
+
+    QTemporaryFile savedFile(QDir::tempPath() + QLatin1String("/krita_XXXXXX") + QLatin1String(".exr"));
+    savedFile.setAutoRemove(true);
+    savedFile.open();
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        doc->setFileBatchMode(true);
+        doc->setCurrentImage(m_image);
+        QVERIFY(doc->exportDocumentSync(savedFile.fileName(), ExrMimetype, exportConfiguration(tiled)));
+    }
+
+    QBENCHMARK {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        doc->setFileBatchMode(true);
+        QVERIFY(doc->importDocument(savedFile.fileName()));
+        QCOMPARE(doc->image()->root()->childCount(), quint32(NUM_LAYERS));
+    }
+}
+
+SIMPLE_TEST_MAIN(KisExrMultiLayerBenchmark)
@@ -0,0 +1,30 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISEXRMULTILAYERBENCHMARK_H
+#define KISEXRMULTILAYERBENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+class KisExrMultiLayerBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testSaving_data();
+    void testSaving();
+
+    void testLoading_data();
+    void testLoading();
+
+private:
+    KisImageSP m_image;
+};
+
+#endif // KISEXRMULTILAYERBENCHMARK_H
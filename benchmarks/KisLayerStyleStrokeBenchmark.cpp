@@ -0,0 +1,124 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLayerStyleStrokeBenchmark.h"
+
+#include <simpletest.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_paint_device.h>
+#include <kis_painter.h>
+#include <kis_psd_layer_style.h>
+#include <KisGlobalResourcesInterface.h>
+
+/**
+ * Simulates a stroke of round dabs on a layer with and without layer
+ * styles. The stroke is a diagonal line, so the dirty rects of the
+ * updates are much bigger than the areas actually touched by the dabs,
+ * which is a usual case for the real strokes.
+ */
+
+#define IMAGE_WIDTH 2048
+#define IMAGE_HEIGHT 2048
+#define DAB_SIZE 40
+#define NUM_DABS 400
+#define DABS_PER_UPDATE 8
+
+namespace {
+
+KisPSDLayerStyleSP createStyle(const QString &styles)
+{
+    KisPSDLayerStyleSP style(new KisPSDLayerStyle());
+
+    if (styles.contains("shadow")) {
+        style->dropShadow()->setEffectEnabled(true);
+        style->dropShadow()->setSize(20);
+        style->dropShadow()->setDistance(10);
+        style->dropShadow()->setSpread(10);
+        style->dropShadow()->setOpacity(70);
+        style->dropShadow()->setNoise(0);
+    }
+
+    if (styles.contains("bevel")) {
+        style->bevelAndEmboss()->setEffectEnabled(true);
+        style->bevelAndEmboss()->setSize(10);
+    }
+
+    if (styles.contains("stroke")) {
+        style->stroke()->setEffectEnabled(true);
+        style->stroke()->setSize(5);
+        style->stroke()->setColor(KoColor(Qt::blue, KoColorSpaceRegistry::instance()->rgb8()));
+    }
+
+    if (styles.contains("satin")) {
+        style->satin()->setEffectEnabled(true);
+        style->satin()->setSize(15);
+    }
+
+    return style->cloneWithResourcesSnapshot(KisGlobalResourcesInterface::instance(), nullptr);
+}
+
+}
+
+void KisLayerStyleStrokeBenchmark::testStroke_data()
+{
+    QTest::addColumn<QString>("styles");
+
+    QTest::newRow("no-styles") << QString();
+    QTest::newRow("shadow") << QString("shadow");
+    QTest::newRow("shadow-bevel-stroke-satin") << QString("shadow bevel stroke satin");
+}
+
+void KisLayerStyleStrokeBenchmark::testStroke()
+{
+    QFETCH(QString, styles);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, IMAGE_WIDTH, IMAGE_HEIGHT, cs, "layer style benchmark");
+
+    KisPaintLayerSP layer = new KisPaintLayer(image, "layer", OPACITY_OPAQUE_U8);
+    image->addNode(layer);
+
+    if (!styles.isEmpty()) {
+        layer->setLayerStyle(createStyle(styles));
+    }
+
+    image->initialRefreshGraph();
+
+    KisPainter gc(layer->paintDevice());
+    gc.setPaintColor(KoColor(Qt::red, cs));
+    gc.setFillStyle(KisPainter::FillStyleForegroundColor);
+
+    const QPointF start(100, 100);
+    const QPointF end(IMAGE_WIDTH - 100, IMAGE_HEIGHT - 100);
+
+    QBENCHMARK_ONCE {
+        QRect dirtyRect;
+
+        for (int i = 0; i < NUM_DABS; i++) {
+            const QPointF center = start + (end - start) * qreal(i) / (NUM_DABS - 1);
+            const QRect dabRect(center.toPoint() - QPoint(DAB_SIZE / 2, DAB_SIZE / 2),
+                                QSize(DAB_SIZE, DAB_SIZE));
+
+            gc.paintEllipse(dabRect);
+            dirtyRect |= dabRect;
+
+            if ((i + 1) % DABS_PER_UPDATE == 0 || i == NUM_DABS - 1) {
+                layer->setDirty(dirtyRect);
+                dirtyRect = QRect();
+            }
+        }
+
+        image->waitForDone();
+    }
+}
+
+SIMPLE_TEST_MAIN(KisLayerStyleStrokeBenchmark)
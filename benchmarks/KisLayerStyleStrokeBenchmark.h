@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISLAYERSTYLESTROKEBENCHMARK_H
+#define KISLAYERSTYLESTROKEBENCHMARK_H
+
+#include <simpletest.h>
+
+class KisLayerStyleStrokeBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testStroke_data();
+    void testStroke();
+};
+
+#endif // KISLAYERSTYLESTROKEBENCHMARK_H
@@ -0,0 +1,96 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPngEncodingBenchmark.h"
+
+#include <QBuffer>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <KisPart.h>
+#include <KisDocument.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+#include <kis_png_converter.h>
+
+/**
+ * Compares the sequential and the parallel PNG encoders on a 16-bit
+ * image, which is where the deflate time dominates
+ */
+
+#define IMAGE_WIDTH 4096
+#define IMAGE_HEIGHT 4096
+
+void KisPngEncodingBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    const int pixelSize = cs->pixelSize();
+
+    m_device = new KisPaintDevice(cs);
+
+    // smooth gradients with some noise, like a painting; the noise is
+    // generated with a fixed seed, so the size of the file is stable
+    quint32 seed = 1;
+
+    KisSequentialIterator it(m_device, QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        quint8 *dst = it.rawData();
+
+        seed = seed * 1103515245 + 12345;
+        const int noise = (seed >> 16) % 8;
+
+        for (int i = 0; i < pixelSize; i++) {
+            dst[i] = quint8(it.x() + it.y() * (i + 1) + noise);
+        }
+
+        cs->setOpacity(dst, OPACITY_OPAQUE_U8, 1);
+    }
+}
+
+void KisPngEncodingBenchmark::cleanupTestCase()
+{
+    m_device.clear();
+}
+
+void KisPngEncodingBenchmark::testEncoding_data()
+{
+    QTest::addColumn<bool>("parallelEncoding");
+    QTest::addColumn<int>("compression");
+
+    QTest::newRow("sequential-fast") << false << 1;
+    QTest::newRow("parallel-fast") << true << 1;
+    QTest::newRow("sequential-default") << false << 6;
+    QTest::newRow("parallel-default") << true << 6;
+}
+
+void KisPngEncodingBenchmark::testEncoding()
+{
+    QFETCH(bool, parallelEncoding);
+    QFETCH(int, compression);
+
+    const QRect rc(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+
+    KisPNGOptions options;
+    options.compression = compression;
+    options.parallelEncoding = parallelEncoding;
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    vKisAnnotationSP annotations;
+
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+
+        KisPNGConverter encoder(doc.data(), true);
+        KisImportExportErrorCode result =
+            encoder.buildFile(&buffer, rc, 72, 72, m_device, annotations.begin(), annotations.end(), options, 0);
+
+        QVERIFY(result.isOk());
+    }
+}
+
+SIMPLE_TEST_MAIN(KisPngEncodingBenchmark)
@@ -0,0 +1,27 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPNGENCODINGBENCHMARK_H
+#define KISPNGENCODINGBENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+class KisPngEncodingBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testEncoding_data();
+    void testEncoding();
+
+private:
+    KisPaintDeviceSP m_device;
+};
+
+#endif // KISPNGENCODINGBENCHMARK_H
@@ -0,0 +1,176 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPrescaledProjectionBenchmark.h"
+
+#include <QElapsedTimer>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_paint_device.h>
+#include <kis_paint_layer.h>
+#include <kis_group_layer.h>
+#include <kis_update_info.h>
+
+#include "canvas/kis_coordinates_converter.h"
+#include "canvas/kis_prescaled_projection.h"
+
+namespace {
+
+const int ImageWidth = 4000;
+const int ImageHeight = 3000;
+const QSize CanvasSize(1920, 1080);
+const int NumFrames = 100;
+
+void initProjection(KisPrescaledProjection &projection,
+                    KisCoordinatesConverter &converter,
+                    KisImageSP image,
+                    qreal zoom)
+{
+    converter.setImage(image);
+    converter.setResolution(image->xRes(), image->yRes());
+    converter.setZoom(zoom);
+
+    projection.setCoordinatesConverter(&converter);
+    projection.setMonitorProfile(0,
+                                 KoColorConversionTransformation::internalRenderingIntent(),
+                                 KoColorConversionTransformation::internalConversionFlags());
+    projection.setImage(image);
+    projection.notifyCanvasSizeChanged(CanvasSize);
+}
+
+QPointF panOffset(int frame)
+{
+    return QPointF((frame * 37) % 1000, (frame * 23) % 700);
+}
+
+void reportFps(const QString &name, int frames, qint64 msecs)
+{
+    qDebug() << qPrintable(name)
+             << "frames:" << frames
+             << "time:" << msecs << "ms"
+             << "fps:" << (msecs > 0 ? 1000.0 * frames / msecs : 0.0);
+}
+
+}
+
+void KisPrescaledProjectionBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    m_image = new KisImage(0, ImageWidth, ImageHeight, cs, "benchmark");
+
+    KisPaintLayerSP layer = new KisPaintLayer(m_image, "layer", OPACITY_OPAQUE_U8, cs);
+    m_image->addNode(layer, m_image->rootLayer());
+
+    KisPaintDeviceSP dev = layer->paintDevice();
+
+    const int cellSize = 100;
+    for (int y = 0; y < ImageHeight; y += cellSize) {
+        for (int x = 0; x < ImageWidth; x += cellSize) {
+            const QColor color = QColor::fromHsv((x / cellSize * 17 + y / cellSize * 29) % 360,
+                                                 160 + (x / cellSize) % 96, 255);
+            dev->fill(QRect(x, y, cellSize, cellSize), KoColor(color, cs));
+        }
+    }
+
+    m_image->initialRefreshGraph();
+}
+
+void KisPrescaledProjectionBenchmark::cleanupTestCase()
+{
+    m_image = 0;
+}
+
+void KisPrescaledProjectionBenchmark::testPan_data()
+{
+    QTest::addColumn<qreal>("zoom");
+
+    QTest::newRow("100%") << 1.0;
+    QTest::newRow("66%") << 0.66;
+    QTest::newRow("50%") << 0.5;
+    QTest::newRow("33%") << 0.33;
+    QTest::newRow("25%") << 0.25;
+    QTest::newRow("12%") << 0.125;
+}
+
+void KisPrescaledProjectionBenchmark::testPan()
+{
+    QFETCH(qreal, zoom);
+
+    KisPrescaledProjection projection;
+    KisCoordinatesConverter converter;
+    initProjection(projection, converter, m_image, zoom);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < NumFrames; i++) {
+        projection.viewportMoved(panOffset(i));
+    }
+
+    reportFps(QString("pan %1").arg(QTest::currentDataTag()), NumFrames, timer.elapsed());
+}
+
+void KisPrescaledProjectionBenchmark::testZoom()
+{
+    KisPrescaledProjection projection;
+    KisCoordinatesConverter converter;
+    initProjection(projection, converter, m_image, 1.0);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < NumFrames; i++) {
+        // zoom out from 100% to 10% and back
+        const int step = i % 20;
+        const qreal zoom = 1.0 - 0.09 * (step < 10 ? step : 20 - step);
+
+        converter.setZoom(zoom);
+        projection.preScale();
+    }
+
+    reportFps("zoom", NumFrames, timer.elapsed());
+}
+
+void KisPrescaledProjectionBenchmark::testUpdateWhilePanning_data()
+{
+    QTest::addColumn<qreal>("zoom");
+
+    QTest::newRow("100%") << 1.0;
+    QTest::newRow("50%") << 0.5;
+    QTest::newRow("25%") << 0.25;
+}
+
+void KisPrescaledProjectionBenchmark::testUpdateWhilePanning()
+{
+    QFETCH(qreal, zoom);
+
+    KisPrescaledProjection projection;
+    KisCoordinatesConverter converter;
+    initProjection(projection, converter, m_image, zoom);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < NumFrames; i++) {
+        // a dab-sized update somewhere on the image, like the one
+        // coming from a brush stroke
+        const QRect dirtyRect(QPoint((i * 131) % (ImageWidth - 256),
+                                     (i * 97) % (ImageHeight - 256)),
+                              QSize(256, 256));
+
+        KisUpdateInfoSP info = projection.updateCache(dirtyRect);
+        projection.recalculateCache(info);
+        projection.viewportMoved(panOffset(i));
+    }
+
+    reportFps(QString("update+pan %1").arg(QTest::currentDataTag()), NumFrames, timer.elapsed());
+}
+
+SIMPLE_TEST_MAIN(KisPrescaledProjectionBenchmark)
@@ -0,0 +1,37 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPRESCALEDPROJECTIONBENCHMARK_H
+#define KISPRESCALEDPROJECTIONBENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+/**
+ * Measures the frame rate of the QPainter canvas backend while panning and
+ * zooming. No GPU is needed: the frames are rendered by KisPrescaledProjection
+ * into a QImage.
+ */
+class KisPrescaledProjectionBenchmark : public QObject
+{
+    Q_OBJECT
+private:
+    KisImageSP m_image;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testPan_data();
+    void testPan();
+
+    void testZoom();
+
+    void testUpdateWhilePanning_data();
+    void testUpdateWhilePanning();
+};
+
+#endif // KISPRESCALEDPROJECTIONBENCHMARK_H
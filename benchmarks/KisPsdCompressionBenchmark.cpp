@@ -0,0 +1,156 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPsdCompressionBenchmark.h"
+
+#include <algorithm>
+#include <random>
+
+#include <QtConcurrentMap>
+
+#include <compression.h>
+
+/**
+ * The codecs are used the way the PSD loader and saver use them: RLE
+ * compresses every row separately, ZIP compresses the whole channel.
+ * The parallel variants process four channels at once.
+ */
+
+#define PLANE_WIDTH 2048
+#define PLANE_HEIGHT 1024
+#define NUM_CHANNELS 4
+
+namespace {
+
+/**
+ * The units of work are split the same way as in the PSD pixel utils
+ */
+struct Unit {
+    int channel;
+    int offset;
+    int length;
+    QByteArray compressed;
+    QByteArray decompressed;
+};
+
+QVector<Unit> splitIntoUnits(psd_compression_type type)
+{
+    QVector<Unit> units;
+
+    for (int i = 0; i < NUM_CHANNELS; i++) {
+        if (type == psd_compression_type::RLE) {
+            for (int row = 0; row < PLANE_HEIGHT; row++) {
+                units.append({i, row * PLANE_WIDTH, PLANE_WIDTH, {}, {}});
+            }
+        } else {
+            units.append({i, 0, PLANE_WIDTH * PLANE_HEIGHT, {}, {}});
+        }
+    }
+
+    return units;
+}
+
+void addCodecRows()
+{
+    QTest::addColumn<int>("compressionType");
+    QTest::addColumn<bool>("parallel");
+
+    QTest::newRow("rle") << int(psd_compression_type::RLE) << false;
+    QTest::newRow("rle-parallel") << int(psd_compression_type::RLE) << true;
+    QTest::newRow("zip") << int(psd_compression_type::ZIP) << false;
+    QTest::newRow("zip-parallel") << int(psd_compression_type::ZIP) << true;
+}
+
+template <typename Func>
+void processUnits(QVector<Unit> &units, bool parallel, Func func)
+{
+    if (parallel) {
+        QtConcurrent::blockingMap(units, func);
+    } else {
+        std::for_each(units.begin(), units.end(), func);
+    }
+}
+
+}
+
+void KisPsdCompressionBenchmark::initTestCase()
+{
+    // smooth gradients with some noise and a few flat areas, like
+    // a channel of a painted layer; the seed is fixed so that the
+    // compression ratio is the same on every run
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> noise(0, 3);
+
+    for (int i = 0; i < NUM_CHANNELS; i++) {
+        QByteArray plane(PLANE_WIDTH * PLANE_HEIGHT, '\0');
+
+        for (int y = 0; y < PLANE_HEIGHT; y++) {
+            char *row = plane.data() + y * PLANE_WIDTH;
+            for (int x = 0; x < PLANE_WIDTH; x++) {
+                if ((x / 256 + y / 256) % 3 != 0) {
+                    row[x] = static_cast<char>((x + y) / 8 + noise(generator));
+                }
+            }
+        }
+
+        m_planes << plane;
+    }
+}
+
+void KisPsdCompressionBenchmark::testEncoding_data()
+{
+    addCodecRows();
+}
+
+void KisPsdCompressionBenchmark::testEncoding()
+{
+    QFETCH(int, compressionType);
+    QFETCH(bool, parallel);
+    const psd_compression_type type = static_cast<psd_compression_type>(compressionType);
+
+    QVector<Unit> units = splitIntoUnits(type);
+
+    auto encode = [&] (Unit &unit) {
+        unit.compressed = Compression::compress(QByteArray::fromRawData(m_planes[unit.channel].constData() + unit.offset, unit.length), type);
+    };
+
+    QBENCHMARK {
+        processUnits(units, parallel, encode);
+    }
+}
+
+void KisPsdCompressionBenchmark::testDecoding_data()
+{
+    addCodecRows();
+}
+
+void KisPsdCompressionBenchmark::testDecoding()
+{
+    QFETCH(int, compressionType);
+    QFETCH(bool, parallel);
+    const psd_compression_type type = static_cast<psd_compression_type>(compressionType);
+
+    QVector<Unit> units = splitIntoUnits(type);
+
+    for (Unit &unit : units) {
+        unit.compressed = Compression::compress(QByteArray::fromRawData(m_planes[unit.channel].constData() + unit.offset, unit.length), type);
+        unit.decompressed.resize(unit.length);
+    }
+
+    auto decode = [&] (Unit &unit) {
+        Compression::uncompress(unit.compressed.constData(), unit.compressed.size(), unit.decompressed.data(), unit.length, type);
+    };
+
+    QBENCHMARK {
+        processUnits(units, parallel, decode);
+    }
+
+    for (const Unit &unit : units) {
+        QCOMPARE(unit.decompressed, QByteArray::fromRawData(m_planes[unit.channel].constData() + unit.offset, unit.length));
+    }
+}
+
+SIMPLE_TEST_MAIN(KisPsdCompressionBenchmark)
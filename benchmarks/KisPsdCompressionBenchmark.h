@@ -0,0 +1,28 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPSDCOMPRESSIONBENCHMARK_H
+#define KISPSDCOMPRESSIONBENCHMARK_H
+
+#include <simpletest.h>
+
+class KisPsdCompressionBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void testEncoding_data();
+    void testEncoding();
+
+    void testDecoding_data();
+    void testDecoding();
+
+private:
+    QVector<QByteArray> m_planes;
+};
+
+#endif // KISPSDCOMPRESSIONBENCHMARK_H
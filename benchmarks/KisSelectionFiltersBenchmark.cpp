@@ -0,0 +1,106 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSelectionFiltersBenchmark.h"
+
+#include <simpletest.h>
+
+#include <QImage>
+#include <QPainter>
+
+#include <kis_pixel_selection.h>
+#include <kis_selection_filters.h>
+
+/**
+ * Applies the selection filters to a complex selection with different
+ * radii. The time spent by grow, shrink and border should stay the same
+ * for the big radii, since they use the distance transform there.
+ */
+
+#define SELECTION_SIZE 4096
+#define NUM_ELLIPSES 300
+
+namespace {
+
+KisPixelSelectionSP createSelection(bool antialiasing)
+{
+    QImage image(SELECTION_SIZE, SELECTION_SIZE, QImage::Format_Grayscale8);
+    image.fill(0);
+
+    QPainter gc(&image);
+    gc.setRenderHint(QPainter::Antialiasing, antialiasing);
+    gc.setPen(Qt::NoPen);
+    gc.setBrush(Qt::white);
+
+    srand(31524744);
+    for (int i = 0; i < NUM_ELLIPSES; i++) {
+        const int size = 20 + rand() % 300;
+        const QRectF rc(rand() % SELECTION_SIZE, rand() % SELECTION_SIZE, size, size * (0.2 + 0.8 * (rand() % 100) / 100.0));
+
+        gc.setCompositionMode(i % 4 ? QPainter::CompositionMode_SourceOver : QPainter::CompositionMode_Clear);
+        gc.drawEllipse(rc);
+    }
+    gc.end();
+
+    KisPixelSelectionSP selection = new KisPixelSelection();
+
+    for (int y = 0; y < SELECTION_SIZE; y++) {
+        selection->writeBytes(image.constScanLine(y), 0, y, SELECTION_SIZE, 1);
+    }
+
+    return selection;
+}
+
+}
+
+void KisSelectionFiltersBenchmark::testFilter_data()
+{
+    QTest::addColumn<QString>("filter");
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<bool>("antialiasing");
+
+    const QStringList filters = {"grow", "shrink", "border", "feather"};
+    const QList<int> radii = {4, 16, 64, 256};
+
+    for (const QString &filter : filters) {
+        for (int radius : radii) {
+            for (bool antialiasing : {false, true}) {
+                const QString name = QString("%1-r%2-%3").arg(filter).arg(radius).arg(antialiasing ? "aa" : "binary");
+                QTest::newRow(name.toLatin1()) << filter << radius << antialiasing;
+            }
+        }
+    }
+}
+
+void KisSelectionFiltersBenchmark::testFilter()
+{
+    QFETCH(QString, filter);
+    QFETCH(int, radius);
+    QFETCH(bool, antialiasing);
+
+    KisPixelSelectionSP selection = createSelection(antialiasing);
+
+    QScopedPointer<KisSelectionFilter> selectionFilter;
+
+    if (filter == "grow") {
+        selectionFilter.reset(new KisGrowSelectionFilter(radius, radius));
+    } else if (filter == "shrink") {
+        selectionFilter.reset(new KisShrinkSelectionFilter(radius, radius, false));
+    } else if (filter == "border") {
+        selectionFilter.reset(new KisBorderSelectionFilter(radius, radius, antialiasing));
+    } else {
+        selectionFilter.reset(new KisFeatherSelectionFilter(radius));
+    }
+
+    const QRect rect = selectionFilter->changeRect(QRect(0, 0, SELECTION_SIZE, SELECTION_SIZE),
+                                                   selection->defaultBounds());
+
+    QBENCHMARK_ONCE {
+        selectionFilter->process(selection, rect);
+    }
+}
+
+SIMPLE_TEST_MAIN(KisSelectionFiltersBenchmark)
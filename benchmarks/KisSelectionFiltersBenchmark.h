@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSELECTIONFILTERSBENCHMARK_H
+#define KISSELECTIONFILTERSBENCHMARK_H
+
+#include <simpletest.h>
+
+class KisSelectionFiltersBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testFilter_data();
+    void testFilter();
+};
+
+#endif // KISSELECTIONFILTERSBENCHMARK_H
@@ -0,0 +1,179 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSlidingWindowHistogramBenchmark.h"
+
+#include <simpletest.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_iterator_ng.h>
+#include <KisSlidingWindowHistogram.h>
+
+/**
+ * The time per pixel of the sliding window engine should stay the
+ * same for all the radii, while the brute force one grows quadratically
+ */
+
+#define IMAGE_WIDTH 1024
+#define IMAGE_HEIGHT 1024
+
+void KisSlidingWindowHistogramBenchmark::initTestCase()
+{
+    m_colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    m_device = new KisPaintDevice(m_colorSpace);
+
+    KoColor color(m_colorSpace);
+    srand(31524744);
+
+    KisSequentialIterator it(m_device, QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        color.fromQColor(QColor(rand() % 255, rand() % 255, rand() % 255));
+        memcpy(it.rawData(), color.data(), m_colorSpace->pixelSize());
+    }
+}
+
+void KisSlidingWindowHistogramBenchmark::testSlidingWindowMedian_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("4") << 4;
+    QTest::newRow("8") << 8;
+    QTest::newRow("16") << 16;
+    QTest::newRow("32") << 32;
+    QTest::newRow("64") << 64;
+}
+
+void KisSlidingWindowHistogramBenchmark::testSlidingWindowMedian()
+{
+    QFETCH(int, radius);
+
+    const KoColorSpace *cs = m_colorSpace;
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    KisSlidingWindowHistogram histogram(256);
+
+    auto sampleFunc = [cs] (const quint8 *pixel, float *, QVector<float> &) {
+        return int(cs->intensity8(pixel));
+    };
+
+    auto resultFunc = [] (const KisSlidingWindowHistogram::Window &window, const quint8 *, quint8 *dst, QVector<float> &) {
+        const int bin = KisSlidingWindowHistogram::findRank(window, 0.5);
+        dst[0] = dst[1] = dst[2] = quint8(bin);
+        dst[3] = 255;
+    };
+
+    QBENCHMARK_ONCE {
+        histogram.process(m_device, dst, QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT),
+                          radius, sampleFunc, resultFunc);
+    }
+}
+
+void KisSlidingWindowHistogramBenchmark::testSlidingWindowMode_data()
+{
+    testSlidingWindowMedian_data();
+}
+
+void KisSlidingWindowHistogramBenchmark::testSlidingWindowMode()
+{
+    QFETCH(int, radius);
+
+    const KoColorSpace *cs = m_colorSpace;
+    const int channelCount = cs->channelCount();
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    // the configuration of the oil paint filter with the default smoothness
+    const int numBins = 31;
+    const qreal scale = (numBins - 1) / 255.0;
+
+    KisSlidingWindowHistogram histogram(numBins, channelCount);
+
+    auto sampleFunc = [cs, scale] (const quint8 *pixel, float *accumulators, QVector<float> &channels) {
+        cs->normalisedChannelsValue(pixel, channels);
+        std::copy(channels.begin(), channels.end(), accumulators);
+        return int(cs->intensity8(pixel) * scale);
+    };
+
+    auto resultFunc = [cs, channelCount] (const KisSlidingWindowHistogram::Window &window, const quint8 *, quint8 *dst, QVector<float> &channels) {
+        const int bin = KisSlidingWindowHistogram::findMode(window);
+
+        for (int i = 0; i < channelCount; i++) {
+            channels[i] = window.binSums(bin)[i] / window.counts[bin];
+        }
+        cs->fromNormalisedChannelsValue(dst, channels);
+    };
+
+    QBENCHMARK_ONCE {
+        histogram.process(m_device, dst, QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT),
+                          radius, sampleFunc, resultFunc);
+    }
+}
+
+void KisSlidingWindowHistogramBenchmark::testBruteForceMedian_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("4") << 4;
+    QTest::newRow("8") << 8;
+}
+
+void KisSlidingWindowHistogramBenchmark::testBruteForceMedian()
+{
+    QFETCH(int, radius);
+
+    const KoColorSpace *cs = m_colorSpace;
+    const QRect applyRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+    const QRect srcRect = applyRect.adjusted(-radius, -radius, radius, radius);
+    const int pixelSize = cs->pixelSize();
+    const int windowSize = 2 * radius + 1;
+
+    QVector<quint8> srcData(srcRect.width() * srcRect.height() * pixelSize);
+    QVector<quint8> dstData(applyRect.width() * applyRect.height() * pixelSize);
+
+    QBENCHMARK_ONCE {
+        m_device->readBytes(srcData.data(), srcRect);
+
+        quint8 *dstPtr = dstData.data();
+        QVector<quint32> counts(256);
+
+        for (int y = 0; y < applyRect.height(); y++) {
+            for (int x = 0; x < applyRect.width(); x++) {
+                std::fill(counts.begin(), counts.end(), 0);
+
+                for (int j = 0; j < windowSize; j++) {
+                    const quint8 *srcPtr = srcData.constData() +
+                        ((y + j) * srcRect.width() + x) * pixelSize;
+
+                    for (int i = 0; i < windowSize; i++) {
+                        counts[cs->intensity8(srcPtr)]++;
+                        srcPtr += pixelSize;
+                    }
+                }
+
+                const quint32 medianIndex = windowSize * windowSize / 2;
+                quint32 cumulativeCount = 0;
+                int bin = 0;
+                for (; bin < 256; bin++) {
+                    cumulativeCount += counts[bin];
+                    if (cumulativeCount > medianIndex) break;
+                }
+
+                dstPtr[0] = dstPtr[1] = dstPtr[2] = quint8(bin);
+                dstPtr[3] = 255;
+                dstPtr += pixelSize;
+            }
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisSlidingWindowHistogramBenchmark)
@@ -0,0 +1,35 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSLIDINGWINDOWHISTOGRAMBENCHMARK_H
+#define KISSLIDINGWINDOWHISTOGRAMBENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+class KoColorSpace;
+
+class KisSlidingWindowHistogramBenchmark : public QObject
+{
+    Q_OBJECT
+private:
+    const KoColorSpace *m_colorSpace;
+    KisPaintDeviceSP m_device;
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testSlidingWindowMedian_data();
+    void testSlidingWindowMedian();
+
+    void testSlidingWindowMode_data();
+    void testSlidingWindowMode();
+
+    void testBruteForceMedian_data();
+    void testBruteForceMedian();
+};
+
+#endif // KISSLIDINGWINDOWHISTOGRAMBENCHMARK_H
@@ -0,0 +1,197 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTextureUploadBenchmark.h"
+
+#include <QElapsedTimer>
+#include <QtConcurrentMap>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_update_info.h>
+
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+#include "opengl/KisTextureUploadMemoryBackend.h"
+#include "opengl/KisTextureUploadStagingRing.h"
+#include "opengl/kis_texture_tile_update_info.h"
+
+namespace {
+
+const int ImageWidth = 2048;
+const int ImageHeight = 2048;
+const int TextureSize = 256;
+const int TextureBorder = 4;
+const int NumStagingBuffers = 96;
+const int NumUploadIterations = 20;
+
+struct UpdateInfoBuilder
+{
+    UpdateInfoBuilder(const KoColorSpace *dstColorSpace)
+    {
+        builder.setTextureInfoPool(poolRegistry.getPool(TextureSize, TextureSize));
+        builder.setConversionOptions(
+            ConversionOptions(dstColorSpace,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags()));
+        builder.setTextureBorder(TextureBorder);
+        builder.setEffectiveTextureSize(QSize(TextureSize - 2 * TextureBorder,
+                                              TextureSize - 2 * TextureBorder));
+    }
+
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisOpenGLUpdateInfoBuilder builder;
+};
+
+struct StagingJob {
+    KisTextureTileUpdateInfoSP tileInfo;
+    KisTextureUploadStagingBufferSP buffer;
+};
+
+QVector<StagingJob> stageAll(KisTextureUploadStagingRing &ring, KisOpenGLUpdateInfoSP info)
+{
+    QVector<StagingJob> jobs;
+    Q_FOREACH (KisTextureTileUpdateInfoSP tileInfo, info->tileList) {
+        jobs << StagingJob{tileInfo, KisTextureUploadStagingBufferSP()};
+    }
+
+    QtConcurrent::blockingMap(jobs,
+        [&ring] (StagingJob &job) {
+            job.buffer = ring.stage(*job.tileInfo);
+        });
+
+    return jobs;
+}
+
+}
+
+void KisTextureUploadBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    m_bounds = QRect(0, 0, ImageWidth, ImageHeight);
+    m_device = new KisPaintDevice(cs);
+
+    const int cellSize = 100;
+    for (int y = 0; y < ImageHeight; y += cellSize) {
+        for (int x = 0; x < ImageWidth; x += cellSize) {
+            const QColor color = QColor::fromHsv((x / cellSize * 17 + y / cellSize * 29) % 360,
+                                                 160 + (x / cellSize) % 96, 255);
+            m_device->fill(QRect(x, y, cellSize, cellSize), KoColor(color, cs));
+        }
+    }
+}
+
+void KisTextureUploadBenchmark::cleanupTestCase()
+{
+    m_device = nullptr;
+}
+
+void KisTextureUploadBenchmark::benchmarkBuildUpdateInfo_data()
+{
+    QTest::addColumn<bool>("convertColorSpace");
+
+    QTest::newRow("rgb8") << false;
+    QTest::newRow("rgb8-to-rgb16") << true;
+}
+
+void KisTextureUploadBenchmark::benchmarkBuildUpdateInfo()
+{
+    QFETCH(bool, convertColorSpace);
+
+    const KoColorSpace *dstColorSpace = convertColorSpace ?
+        KoColorSpaceRegistry::instance()->rgb16() :
+        KoColorSpaceRegistry::instance()->rgb8();
+
+    UpdateInfoBuilder builder(dstColorSpace);
+
+    QBENCHMARK {
+        KisOpenGLUpdateInfoSP info =
+            builder.builder.buildUpdateInfo(m_bounds, m_device, m_bounds, 0, convertColorSpace);
+        Q_UNUSED(info);
+    }
+}
+
+void KisTextureUploadBenchmark::benchmarkStage()
+{
+    const int pixelSize = m_device->pixelSize();
+
+    UpdateInfoBuilder builder(m_device->colorSpace());
+    KisOpenGLUpdateInfoSP info = builder.builder.buildUpdateInfo(m_bounds, m_device, m_bounds, 0, false);
+    QVERIFY(info->tileList.size() <= NumStagingBuffers);
+
+    KisTextureUploadStagingRing ring;
+    QVERIFY(ring.allocate(new KisTextureUploadMemoryBackend(pixelSize),
+                          NumStagingBuffers, TextureSize * TextureSize * pixelSize));
+
+    QBENCHMARK {
+        // the staged buffers return to the ring when the jobs are destroyed
+        QVector<StagingJob> jobs = stageAll(ring, info);
+        Q_UNUSED(jobs);
+    }
+}
+
+void KisTextureUploadBenchmark::benchmarkUploadStaged_data()
+{
+    QTest::addColumn<bool>("emulateTextures");
+
+    QTest::newRow("commands-only") << false;
+    QTest::newRow("emulated-textures") << true;
+}
+
+void KisTextureUploadBenchmark::benchmarkUploadStaged()
+{
+    QFETCH(bool, emulateTextures);
+
+    const int pixelSize = m_device->pixelSize();
+
+    UpdateInfoBuilder builder(m_device->colorSpace());
+    KisOpenGLUpdateInfoSP info = builder.builder.buildUpdateInfo(m_bounds, m_device, m_bounds, 0, false);
+
+    KisTextureUploadMemoryBackend *backend = new KisTextureUploadMemoryBackend(pixelSize);
+    KisTextureUploadMemoryBackend::Texture texture(QSize(TextureSize, TextureSize), pixelSize);
+    backend->bindTexture(emulateTextures ? &texture : nullptr);
+
+    KisTextureUploadStagingRing ring;
+    QVERIFY(ring.allocate(backend, NumStagingBuffers, TextureSize * TextureSize * pixelSize));
+
+    /**
+     * Only the GUI thread part is measured, the buffers are staged
+     * outside of the timed section
+     */
+    qint64 uploadNsecs = 0;
+    int numUploadedTiles = 0;
+
+    for (int i = 0; i < NumUploadIterations; i++) {
+        QVector<StagingJob> jobs = stageAll(ring, info);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        Q_FOREACH (const StagingJob &job, jobs) {
+            if (job.buffer && job.buffer->upload()) {
+                numUploadedTiles++;
+            }
+        }
+        ring.fenceUploadedBuffers();
+
+        uploadNsecs += timer.nsecsElapsed();
+
+        jobs.clear();
+        ring.recycleSignaledBuffers();
+    }
+
+    QCOMPARE(numUploadedTiles, NumUploadIterations * info->tileList.size());
+
+    qDebug() << qPrintable(QString("upload %1").arg(QTest::currentDataTag()))
+             << "tiles:" << numUploadedTiles
+             << "copies:" << backend->numCopies()
+             << "time:" << uploadNsecs / 1000000.0 << "ms"
+             << "per tile:" << uploadNsecs / 1000.0 / qMax(1, numUploadedTiles) << "us";
+}
+
+SIMPLE_TEST_MAIN(KisTextureUploadBenchmark)
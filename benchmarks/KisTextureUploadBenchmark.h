@@ -0,0 +1,39 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTEXTUREUPLOADBENCHMARK_H
+#define KISTEXTUREUPLOADBENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+/**
+ * Measures the CPU side of the openGL canvas texture uploads: building the
+ * tile updates, packing them into the staging ring in the worker threads
+ * and issuing the copy commands in the GUI thread. No GPU is needed, the
+ * staging buffers and textures are emulated by KisTextureUploadMemoryBackend.
+ */
+class KisTextureUploadBenchmark : public QObject
+{
+    Q_OBJECT
+private:
+    KisPaintDeviceSP m_device;
+    QRect m_bounds;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkBuildUpdateInfo_data();
+    void benchmarkBuildUpdateInfo();
+
+    void benchmarkStage();
+
+    void benchmarkUploadStaged_data();
+    void benchmarkUploadStaged();
+};
+
+#endif // KISTEXTUREUPLOADBENCHMARK_H
@@ -12,6 +12,7 @@
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
 #include <KoColor.h>
 
 #include <kis_image.h>
@@ -54,8 +55,25 @@ void KisBContrastBenchmark::cleanupTestCase()
 }
 
 
+void KisBContrastBenchmark::benchmarkFilter_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+
+    QTest::newRow("rgb8") << Integer8BitsColorDepthID.id();
+    QTest::newRow("rgb16") << Integer16BitsColorDepthID.id();
+    QTest::newRow("rgbF32") << Float32BitsColorDepthID.id();
+}
+
 void KisBContrastBenchmark::benchmarkFilter()
 {
+    QFETCH(QString, colorDepthId);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+
+    KisPaintDeviceSP device = new KisPaintDevice(*m_device);
+    device->convertTo(cs);
+
     KisFilterSP filter = KisFilterRegistry::instance()->value("brightnesscontrast");
     KisFilterConfigurationSP  kfc = filter->defaultConfiguration(KisGlobalResourcesInterface::instance());
 
@@ -79,7 +97,7 @@ void KisBContrastBenchmark::benchmarkFilter()
 
     QBENCHMARK{
         Q_FOREACH (const QRect &rc, rects) {
-            filter->process(m_device, rc, kfc);
+            filter->process(device, rc, kfc);
         }
     }
 }
@@ -28,6 +28,7 @@ private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
     
+    void benchmarkFilter_data();
     void benchmarkFilter();
     
 };
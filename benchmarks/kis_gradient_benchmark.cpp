@@ -18,6 +18,7 @@
 #include <KoCompositeOpRegistry.h>
 
 #include <kis_image.h>
+#include <kis_default_bounds.h>
 
 #include "kis_gradient_benchmark.h"
 
@@ -35,39 +36,76 @@ void KisGradientBenchmark::initTestCase()
     m_device->fill( 0,0,GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT,m_color.data() );
 }
 
+void KisGradientBenchmark::benchmarkGradient_data()
+{
+    QTest::addColumn<int>("shape");
+    QTest::addColumn<int>("repeat");
+    QTest::addColumn<bool>("use16Bit");
+    QTest::addColumn<bool>("useDithering");
+
+    const QVector<QPair<QString, KisGradientPainter::enumGradientShape>> shapes = {
+        {"linear", KisGradientPainter::GradientShapeLinear},
+        {"bilinear", KisGradientPainter::GradientShapeBiLinear},
+        {"radial", KisGradientPainter::GradientShapeRadial},
+        {"square", KisGradientPainter::GradientShapeSquare},
+        {"conical", KisGradientPainter::GradientShapeConical},
+        {"conical-symetric", KisGradientPainter::GradientShapeConicalSymetric},
+        {"spiral", KisGradientPainter::GradientShapeSpiral},
+        {"reverse-spiral", KisGradientPainter::GradientShapeReverseSpiral},
+        {"polygonal", KisGradientPainter::GradientShapePolygonal}
+    };
+
+    for (const auto &shape : shapes) {
+        QTest::newRow(qPrintable(shape.first + "-8bit"))
+            << int(shape.second) << int(KisGradientPainter::GradientRepeatNone) << false << false;
+        QTest::newRow(qPrintable(shape.first + "-8bit-forwards"))
+            << int(shape.second) << int(KisGradientPainter::GradientRepeatForwards) << false << false;
+        QTest::newRow(qPrintable(shape.first + "-16bit-dithered"))
+            << int(shape.second) << int(KisGradientPainter::GradientRepeatNone) << true << true;
+    }
+}
+
 void KisGradientBenchmark::benchmarkGradient()
 {
-    KoColor fg(m_colorSpace);
-    KoColor bg(m_colorSpace);
-    fg.fromQColor(Qt::blue);
-    bg.fromQColor(Qt::black);
-    
+    QFETCH(int, shape);
+    QFETCH(int, repeat);
+    QFETCH(bool, use16Bit);
+    QFETCH(bool, useDithering);
+
+    const KoColorSpace *cs = use16Bit ? KoColorSpaceRegistry::instance()->rgb16() : m_colorSpace;
+
+    // the polygonal shape is computed for the bounds of the image
+    KisImageSP image = new KisImage(0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT, cs, "gradient benchmark");
+    KisPaintDeviceSP device = new KisPaintDevice(cs);
+    device->setDefaultBounds(new KisDefaultBounds(image));
+
+    QLinearGradient grad;
+    grad.setColorAt(0, Qt::white);
+    grad.setColorAt(1.0, Qt::red);
+    KoAbstractGradientSP kograd(KoStopGradient::fromQGradient(&grad));
+    Q_ASSERT(kograd);
+
     QBENCHMARK
     {
-        QLinearGradient grad;
-        grad.setColorAt(0, Qt::white);
-        grad.setColorAt(1.0, Qt::red);
-        KoAbstractGradientSP kograd(KoStopGradient::fromQGradient(&grad));
-        Q_ASSERT(kograd);
-        KisGradientPainter fillPainter(m_device);
-        //setupPainter(&fillPainter);
+        KisGradientPainter fillPainter(device);
         fillPainter.setGradient(kograd);
 
         fillPainter.beginTransaction(kundo2_noi18n("Gradient Fill"));
 
-        //fillPainter.setProgress(updater->startSubtask());
         fillPainter.setOpacity(OPACITY_OPAQUE_U8);
         // default
         fillPainter.setCompositeOpId(COMPOSITE_OVER);
-        fillPainter.setGradientShape(KisGradientPainter::GradientShapeBiLinear);
-        fillPainter.paintGradient(QPointF(0,0), QPointF(3000,3000), KisGradientPainter::GradientRepeatNone, 1.0, false, 0, 0, GMP_IMAGE_WIDTH,GMP_IMAGE_HEIGHT);
+        fillPainter.setGradientShape(KisGradientPainter::enumGradientShape(shape));
+        fillPainter.paintGradient(QPointF(GMP_IMAGE_WIDTH / 2, GMP_IMAGE_HEIGHT / 2), QPointF(3000, 2000),
+                                  KisGradientPainter::enumGradientRepeat(repeat), 1.0, false,
+                                  0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT, useDithering);
 
         fillPainter.deleteTransaction();
     }
-    
+
     // uncomment this to see the output
-    QImage out = m_device->convertToQImage(m_colorSpace->profile(),0,0,GMP_IMAGE_WIDTH,GMP_IMAGE_HEIGHT);
-    out.save("fill_output.png");
+    // QImage out = device->convertToQImage(cs->profile(), 0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    // out.save(QString("fill_output_%1.png").arg(QTest::currentDataTag()));
 }
 
 
@@ -29,6 +29,7 @@ private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
     
+    void benchmarkGradient_data();
     void benchmarkGradient();
     
     
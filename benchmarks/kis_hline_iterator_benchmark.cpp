@@ -16,6 +16,7 @@
 #include <simpletest.h>
 
 #include "kis_iterator_ng.h"
+#include "KisTileSpanIterator.h"
 
 void KisHLineIteratorBenchmark::initTestCase()
 {
@@ -178,5 +179,98 @@ void KisHLineIteratorBenchmark::benchmarkTwoIteratorsNoMemCpy(){
 }
 
 
+namespace {
+/**
+ * m_device is not reference counted, so the span iterators,
+ * which take a shared pointer, get their own copy of it
+ */
+KisPaintDeviceSP createFilledDevice(const KoColorSpace *cs, const KoColor &color)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->fill(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, color.data());
+    return dev;
+}
+}
+
+void KisHLineIteratorBenchmark::benchmarkSpanWriteBytes()
+{
+    KisPaintDeviceSP dev = createFilledDevice(m_colorSpace, *m_color);
+    const int pixelSize = m_colorSpace->pixelSize();
+
+    QBENCHMARK{
+        KisTileSpanIterator it(dev, QRect(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT));
+        while (it.nextSpan()) {
+            quint8 *row = it.rawData();
+            for (int j = 0; j < it.spanHeight(); j++) {
+                quint8 *pixel = row;
+                for (int i = 0; i < it.spanWidth(); i++) {
+                    memcpy(pixel, m_color->data(), pixelSize);
+                    pixel += pixelSize;
+                }
+                row += it.rowStride();
+            }
+        }
+    }
+}
+
+void KisHLineIteratorBenchmark::benchmarkSpanConstReadBytes()
+{
+    KisPaintDeviceSP dev = createFilledDevice(m_colorSpace, *m_color);
+    const int pixelSize = m_colorSpace->pixelSize();
+
+    QBENCHMARK{
+        KisTileSpanConstIterator it(dev, QRect(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT));
+        while (it.nextSpan()) {
+            const quint8 *row = it.oldRawData();
+            for (int j = 0; j < it.spanHeight(); j++) {
+                const quint8 *pixel = row;
+                for (int i = 0; i < it.spanWidth(); i++) {
+                    memcpy(m_color->data(), pixel, pixelSize);
+                    pixel += pixelSize;
+                }
+                row += it.rowStride();
+            }
+        }
+    }
+}
+
+void KisHLineIteratorBenchmark::benchmarkSpanReadWriteBytes()
+{
+    KoColor c(m_colorSpace);
+    c.fromQColor(QColor(250,120,0));
+    KisPaintDeviceSP dab = new KisPaintDevice(m_colorSpace);
+    dab->fill(0,0,TEST_IMAGE_WIDTH,TEST_IMAGE_HEIGHT, c.data());
+
+    KisPaintDeviceSP dev = createFilledDevice(m_colorSpace, *m_color);
+    const QRect rect(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT);
+    const int pixelSize = m_colorSpace->pixelSize();
+
+    // both devices have zero offset, so their spans coincide
+    QBENCHMARK{
+        KisTileSpanIterator writeIterator(dev, rect);
+        KisTileSpanConstIterator constReadIterator(dab, rect);
+
+        while (writeIterator.nextSpan() && constReadIterator.nextSpan()) {
+            quint8 *dstRow = writeIterator.rawData();
+            const quint8 *srcRow = constReadIterator.oldRawData();
+
+            for (int j = 0; j < writeIterator.spanHeight(); j++) {
+                memcpy(dstRow, srcRow, writeIterator.spanWidth() * pixelSize);
+                dstRow += writeIterator.rowStride();
+                srcRow += constReadIterator.rowStride();
+            }
+        }
+    }
+}
+
+void KisHLineIteratorBenchmark::benchmarkSpanNoMemCpy()
+{
+    KisPaintDeviceSP dev = createFilledDevice(m_colorSpace, *m_color);
+
+    QBENCHMARK{
+        KisTileSpanIterator it(dev, QRect(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT));
+        while (it.nextSpan()) {}
+    }
+}
 
 SIMPLE_TEST_MAIN(KisHLineIteratorBenchmark)
@@ -44,6 +44,12 @@ private Q_SLOTS:
     void benchmarkConstNoMemCpy();
     // copy from one device to another
     void benchmarkTwoIteratorsNoMemCpy();
+
+    // the same operations done with KisTileSpanIterator
+    void benchmarkSpanWriteBytes();
+    void benchmarkSpanConstReadBytes();
+    void benchmarkSpanReadWriteBytes();
+    void benchmarkSpanNoMemCpy();
     
 
     
@@ -11,6 +11,7 @@
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
 #include <KoColor.h>
 
 #include <kis_image.h>
@@ -18,6 +19,7 @@
 #include "filter/kis_filter_registry.h"
 #include "filter/kis_filter_configuration.h"
 #include "filter/kis_color_transformation_configuration.h"
+#include "KisLevelsCurve.h"
 #include "filter/kis_filter.h"
 
 #include "kis_processing_information.h"
@@ -53,12 +55,34 @@ void KisLevelFilterBenchmark::cleanupTestCase()
 {
 }
 
+void KisLevelFilterBenchmark::benchmarkFilter_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<bool>("useLightnessMode");
+
+    QTest::newRow("rgb8-lightness") << Integer8BitsColorDepthID.id() << true;
+    QTest::newRow("rgb16-lightness") << Integer16BitsColorDepthID.id() << true;
+    QTest::newRow("rgbF32-lightness") << Float32BitsColorDepthID.id() << true;
+    QTest::newRow("rgb8-channels") << Integer8BitsColorDepthID.id() << false;
+    QTest::newRow("rgb16-channels") << Integer16BitsColorDepthID.id() << false;
+    QTest::newRow("rgbF32-channels") << Float32BitsColorDepthID.id() << false;
+}
+
 void KisLevelFilterBenchmark::benchmarkFilter()
 {
+    QFETCH(QString, colorDepthId);
+    QFETCH(bool, useLightnessMode);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+
+    KisPaintDeviceSP device = new KisPaintDevice(*m_device);
+    device->convertTo(cs);
+
     KisFilterSP filter = KisFilterRegistry::instance()->value("levels");
     //KisFilterConfigurationSP  kfc = filter->defaultConfiguration(m_device);
 
-    KisColorTransformationConfiguration * kfc= new KisColorTransformationConfiguration("levels", 1, KisGlobalResourcesInterface::instance());
+    KisFilterConfigurationSP kfc = filter->factoryConfiguration(KisGlobalResourcesInterface::instance());
 
     kfc->setProperty("blackvalue", 75);
     kfc->setProperty("whitevalue", 231);
@@ -80,12 +104,24 @@ void KisLevelFilterBenchmark::benchmarkFilter()
         kfc->fromXML(s);
     }
 
+    if (!useLightnessMode) {
+        // the first virtual channel is the lightness of all the colors,
+        // then go the color channels in display order and the alpha
+        const KisLevelsCurve curve(75.0 / 255.0, 231.0 / 255.0, 1.0, 0.0, 1.0);
+
+        kfc->setProperty("mode", "channels");
+        kfc->setProperty("number_of_channels", 5);
+        for (int i = 1; i <= 3; i++) {
+            kfc->setProperty(QString("channel_%1").arg(i), curve.toString());
+        }
+    }
+
     QSize size = KritaUtils::optimalPatchSize();
     QVector<QRect> rects = KritaUtils::splitRectIntoPatches(QRect(0, 0, GMP_IMAGE_WIDTH,GMP_IMAGE_HEIGHT), size);
 
     QBENCHMARK{
         Q_FOREACH (const QRect &rc, rects) {
-            filter->process(m_device, rc, kfc);
+            filter->process(device, rc, kfc);
         }
     }
 }
@@ -27,6 +27,7 @@ private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
 
+    void benchmarkFilter_data();
     void benchmarkFilter();
 };
 
@@ -5,11 +5,17 @@
  */
 
 #include <simpletest.h>
+#include <QtMath>
 
 #include "kis_mask_generator_benchmark.h"
 
 #include "kis_circle_mask_generator.h"
 #include "kis_rect_mask_generator.h"
+#include "kis_gauss_circle_mask_generator.h"
+#include "kis_gauss_rect_mask_generator.h"
+#include "kis_curve_circle_mask_generator.h"
+#include "kis_curve_rect_mask_generator.h"
+#include "kis_cubic_curve.h"
 
 void KisMaskGeneratorBenchmark::benchmarkCircle()
 {
@@ -32,6 +38,8 @@ void KisMaskGeneratorBenchmark::benchmarkCircle()
 #include "kis_brush_mask_applicator_base.h"
 #include "krita_utils.h"
 
+#include <KisSupportedArchitectures.h>
+
 
 void benchmarkSIMD(qreal fade) {
     const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -81,4 +89,119 @@ void KisMaskGeneratorBenchmark::benchmarkSquare()
     }
 }
 
+enum GeneratorType {
+    Circle, GaussCircle, CurveCircle, Rect, GaussRect, CurveRect
+};
+
+struct GeneratorOptions {
+    const char *name;
+    qreal diameter;
+    qreal fade;
+    int spikes;
+    bool antialiasEdges;
+};
+
+const GeneratorOptions benchmarkOptions[] = {
+    {"sharp", 300, 1.0, 2, false},
+    {"faded", 300, 0.5, 2, false},
+    {"antialiased", 300, 0.5, 2, true},
+    {"spikes", 300, 0.5, 5, true},
+    // dabs smaller than 10px are supersampled
+    {"small", 7, 0.5, 2, true}
+};
+
+template<class MaskGenerator>
+KisMaskGenerator *prepareGenerator(MaskGenerator *generator, bool useScalar)
+{
+    if (useScalar) {
+        generator->setMaskScalarApplicator();
+    }
+    return generator;
+}
+
+KisMaskGenerator *createGenerator(GeneratorType type, const GeneratorOptions &o, bool useScalar)
+{
+    const KisCubicCurve curve(QString("0,1;1,0"));
+
+    switch (type) {
+    case Circle:
+        return prepareGenerator(new KisCircleMaskGenerator(o.diameter, 1.0, o.fade, o.fade, o.spikes, o.antialiasEdges), useScalar);
+    case GaussCircle:
+        return prepareGenerator(new KisGaussCircleMaskGenerator(o.diameter, 1.0, o.fade, o.fade, o.spikes, o.antialiasEdges), useScalar);
+    case CurveCircle:
+        return prepareGenerator(new KisCurveCircleMaskGenerator(o.diameter, 1.0, o.fade, o.fade, o.spikes, curve, o.antialiasEdges), useScalar);
+    case Rect:
+        return prepareGenerator(new KisRectangleMaskGenerator(o.diameter, 0.5, o.fade, o.fade, o.spikes, o.antialiasEdges), useScalar);
+    case GaussRect:
+        return prepareGenerator(new KisGaussRectangleMaskGenerator(o.diameter, 0.5, o.fade, o.fade, o.spikes, o.antialiasEdges), useScalar);
+    case CurveRect:
+        return prepareGenerator(new KisCurveRectangleMaskGenerator(o.diameter, 0.5, o.fade, o.fade, o.spikes, curve, o.antialiasEdges), useScalar);
+    }
+
+    return nullptr;
+}
+
+void KisMaskGeneratorBenchmark::benchmarkApplicator_data()
+{
+    QTest::addColumn<int>("generatorType");
+    QTest::addColumn<int>("optionsIndex");
+    QTest::addColumn<bool>("useScalar");
+
+    const QStringList generatorNames = {"circle", "gauss-circle", "curve-circle",
+                                        "rect", "gauss-rect", "curve-rect"};
+    const QString optimizedName = QString("optimized-%1").arg(KisSupportedArchitectures::bestArchName());
+
+    for (int type = Circle; type <= CurveRect; type++) {
+        for (int options = 0; options < int(sizeof(benchmarkOptions) / sizeof(GeneratorOptions)); options++) {
+            const char *optionsName = benchmarkOptions[options].name;
+
+            QTest::addRow("%s-%s-scalar", qPrintable(generatorNames[type]), optionsName)
+                << type << options << true;
+            QTest::addRow("%s-%s-%s", qPrintable(generatorNames[type]), optionsName, qPrintable(optimizedName))
+                << type << options << false;
+        }
+    }
+}
+
+void KisMaskGeneratorBenchmark::benchmarkApplicator()
+{
+    QFETCH(int, generatorType);
+    QFETCH(int, optionsIndex);
+    QFETCH(bool, useScalar);
+
+    const GeneratorOptions &options = benchmarkOptions[optionsIndex];
+
+    /**
+     * Small dabs take so little time that we paint a batch of them
+     * to get meaningful numbers
+     */
+    const int numDabs = options.diameter < 10 ? 2000 : 1;
+    const int dabSize = qCeil(options.diameter) + 2;
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+    dev->setRect(QRect(0, 0, dabSize, dabSize));
+    dev->initialize();
+
+    MaskProcessingData data(dev, cs, nullptr,
+                            0.0, 1.0,
+                            0.5 * dabSize, 0.5 * dabSize, 0);
+
+    QScopedPointer<KisMaskGenerator> gen(
+        createGenerator(GeneratorType(generatorType), options, useScalar));
+
+    KisBrushMaskApplicatorBase *applicator = gen->applicator();
+    applicator->initializeData(&data);
+
+    QVector<QRect> rects = KritaUtils::splitRectIntoPatches(dev->bounds(), QSize(63, 63));
+
+    QBENCHMARK {
+        for (int i = 0; i < numDabs; i++) {
+            Q_FOREACH (const QRect &rc, rects) {
+                applicator->process(rc);
+            }
+        }
+    }
+}
+
 SIMPLE_TEST_MAIN(KisMaskGeneratorBenchmark)
@@ -18,6 +18,9 @@ private Q_SLOTS:
     void benchmarkSIMD_FadedBrush();
     void benchmarkSquare();
 
+    void benchmarkApplicator_data();
+    void benchmarkApplicator();
+
 };
 
 #endif
@@ -16,6 +16,7 @@ inline double drand48()
 #include <simpletest.h>
 
 #include <QImage>
+#include <cmath>
 #include <kis_debug.h>
 
 #include "kis_painter_benchmark.h"
@@ -448,6 +449,108 @@ void KisPainterBenchmark::benchmarkMassiveBltFixed()
     }
 }
 
+void KisPainterBenchmark::benchmarkMassiveBltFixedDenseStroke_data()
+{
+    QTest::addColumn<int>("diameter");
+    QTest::addColumn<qreal>("spacing");
+    QTest::addColumn<bool>("useSelection");
+
+    for (int diameter : {5, 10, 25, 50}) {
+        for (qreal spacing : {0.05, 0.1, 0.25}) {
+            for (bool useSelection : {false, true}) {
+                QTest::newRow(QString("d%1-s%2%3")
+                              .arg(diameter)
+                              .arg(spacing)
+                              .arg(useSelection ? "-sel" : "")
+                              .toLatin1())
+                    << diameter << spacing << useSelection;
+            }
+        }
+    }
+}
+
+void KisPainterBenchmark::benchmarkMassiveBltFixedDenseStroke()
+{
+    QFETCH(int, diameter);
+    QFETCH(qreal, spacing);
+    QFETCH(bool, useSelection);
+
+    const KoColorSpace* cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    /**
+     * Emulate the dab stream of the brush engine: a wavy stroke of
+     * round soft dabs with the pressure-dependent opacity, split into
+     * the patches the same way as KisBrushOp does it.
+     */
+    const int strokeLength = 1000;
+    const qreal step = qMax(1.0, spacing * diameter);
+    const int numDabs = strokeLength / step;
+
+    QRect devicesRect;
+    QList<KisRenderedDab> devices;
+    QVector<QRect> dabRects;
+
+    KisFixedPaintDeviceSP dabDevice = new KisFixedPaintDevice(cs);
+    dabDevice->setRect(QRect(0, 0, diameter, diameter));
+    dabDevice->initialize();
+
+    {
+        const qreal radius = 0.5 * diameter;
+        quint8 *pixel = dabDevice->data();
+
+        for (int y = 0; y < diameter; y++) {
+            for (int x = 0; x < diameter; x++) {
+                const qreal dist = std::hypot(x + 0.5 - radius, y + 0.5 - radius) / radius;
+                const quint8 alpha = dist < 1.0 ? qRound(255 * (1.0 - dist * dist)) : 0;
+
+                memcpy(pixel, m_color.data(), cs->pixelSize());
+                cs->setOpacity(pixel, alpha, 1);
+                pixel += cs->pixelSize();
+            }
+        }
+    }
+
+    for (int i = 0; i < numDabs; i++) {
+        const qreal x = 10 + i * step;
+        const qreal y = 300 + 100 * std::sin(x / 150.0);
+        const QRect rc(QPoint(qRound(x), qRound(y)), QSize(diameter, diameter));
 
+        // the dabs are shared, just like the cached ones in KisDabRenderingQueue
+        KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(*dabDevice);
+        dev->setRect(rc);
+
+        KisRenderedDab dab;
+        dab.device = dev;
+        dab.offset = rc.topLeft();
+        dab.opacity = 0.5 + 0.5 * std::sin(i * 0.05);
+        dab.flow = 0.8;
+
+        devices << dab;
+        dabRects << rc;
+        devicesRect |= rc;
+    }
+
+    KisSelectionSP selection;
+    if (useSelection) {
+        selection = new KisSelection();
+        selection->pixelSelection()->select(kisGrowRect(devicesRect, -diameter), 200);
+    }
+
+    const int idealNumPatches = 8;
+    const QVector<QRect> rects =
+        KisPaintOpUtils::splitDabsIntoRects(dabRects, idealNumPatches, diameter, spacing);
+
+    QBENCHMARK {
+        KisPainter painter(dst);
+        painter.setSelection(selection);
+        Q_FOREACH (const QRect &rc, rects) {
+            painter.bltFixed(rc, devices);
+        }
+        painter.end();
+    }
+
+    qDebug() << "dabs:" << numDabs << "patches:" << rects.size();
+}
 
 SIMPLE_TEST_MAIN(KisPainterBenchmark)
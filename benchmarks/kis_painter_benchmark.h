@@ -41,6 +41,9 @@ private Q_SLOTS:
     void benchmarkBitBltOldData();
     void benchmarkMassiveBltFixed();
 
+    void benchmarkMassiveBltFixedDenseStroke_data();
+    void benchmarkMassiveBltFixedDenseStroke();
+
     
 };
 
@@ -311,6 +311,12 @@ void KisStrokeBenchmark::softbrushSoftness()
     benchmarkLine(presetFileName);
 }
 
+void KisStrokeBenchmark::softbrushSteadyStateAllocations()
+{
+    QString presetFileName = "softbrush_30px.kpp";
+    benchmarkSteadyStateAllocations(presetFileName);
+}
+
 void KisStrokeBenchmark::dynabrush()
 {
     QString presetFileName = "dyna301.kpp";
@@ -584,6 +590,55 @@ void KisStrokeBenchmark::benchmarkStroke(QString presetFileName)
 #endif
 }
 
+void KisStrokeBenchmark::benchmarkSteadyStateAllocations(QString presetFileName)
+{
+    KisPaintOpPresetSP preset(new KisPaintOpPreset(m_dataPath + presetFileName));
+    bool loadedOk = preset->load(KisGlobalResourcesInterface::instance());
+    if (!loadedOk){
+        dbgKrita << "The preset was not loaded correctly. Done.";
+        return;
+    } else {
+        dbgKrita << "preset : " << presetFileName;
+    }
+
+    /**
+     * Emulate the stroke-wide pool created by KisPainterBasedStrokeStrategy.
+     * The allocator should be set before the paintop is created.
+     */
+    KisOptimizedByteArray::PooledMemoryAllocatorSP allocator(
+        new KisOptimizedByteArray::PooledMemoryAllocator());
+
+    KisPainter painter(m_layer->paintDevice());
+    painter.setPaintColor(KoColor(Qt::black, m_colorSpace));
+    painter.setMemoryAllocator(allocator);
+    painter.setPaintOpPreset(preset, m_layer, m_image);
+
+    // the first pass fills in the pool with the dabs of all the sizes
+    // used in the stroke
+    {
+        KisDistanceInformation currentDistance;
+        painter.paintBezierCurve(m_pi1, m_c1, m_c1, m_pi2, &currentDistance);
+        painter.paintBezierCurve(m_pi2, m_c2, m_c2, m_pi3, &currentDistance);
+    }
+
+    allocator->resetStatistics();
+
+    QBENCHMARK{
+        KisDistanceInformation currentDistance;
+        painter.paintBezierCurve(m_pi1, m_c1, m_c1, m_pi2, &currentDistance);
+        painter.paintBezierCurve(m_pi2, m_c2, m_c2, m_pi3, &currentDistance);
+    }
+
+    const KisOptimizedByteArray::PooledMemoryAllocator::Statistics stats =
+        allocator->statistics();
+
+    qDebug() << "allocations:" << stats.numAllocations
+             << "system allocations:" << stats.numSystemAllocations;
+
+    QVERIFY(stats.numAllocations > 0);
+    QCOMPARE(stats.numSystemAllocations, 0);
+}
+
 static const int COUNT = 1000000;
 void KisStrokeBenchmark::benchmarkRand48()
 {
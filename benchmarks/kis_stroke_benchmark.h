@@ -56,6 +56,7 @@ private:
         inline void benchmarkLine(QString presetFileName);
         inline void benchmarkCircle(QString presetFileName);
         inline void benchmarkRectangle(QString presetFileName);
+        inline void benchmarkSteadyStateAllocations(QString presetFileName);
 
 private Q_SLOTS:
     void initTestCase();
@@ -76,6 +77,7 @@ private Q_SLOTS:
 
     void softbrushSoftness();
     void softbrushOpacity();
+    void softbrushSteadyStateAllocations();
 
     // Hairy brush benchmarks
     void hairy30pxDefault();
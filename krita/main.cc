@@ -621,7 +621,7 @@ extern "C" MAIN_EXPORT int MAIN_FN(int argc, char **argv)
     if (app.isRunning()) {
         // only pass arguments to main instance if they are not for batch processing
         // any batch processing would be done in this separate instance
-        const bool batchRun = args.exportAs() || args.exportSequence();
+        const bool batchRun = args.exportAs() || args.exportSequence() || args.batchService();
 
         if (!batchRun) {
             if (app.sendMessage(args.serialize())) {
@@ -32,11 +32,13 @@
 #include "KisQPainterStateSaver.h"
 #include "KoSvgTextChunkShape.h"
 #include "KoSvgTextShape.h"
+#include "KoBakedShapeRenderer.h"
 #include <QApplication>
 
 #include <QPainter>
 #include <QPainterPath>
 #include <QTimer>
+#include <QtConcurrentMap>
 #include <FlakeDebug.h>
 
 #include "kis_painting_tweaks.h"
@@ -244,6 +246,49 @@ void renderShapes(typename KisForest<KoShape*>::child_iterator beginIt,
     }
 }
 
+/**
+ * Render a tile of the raster cache with the \p shapes intersecting it
+ *
+ * @return a null image if the tile has no shapes
+ */
+QImage renderCacheTile(const QList<KoShape*> &shapes,
+                       const QRect &tileRect,
+                       const QTransform &cacheTransform,
+                       QPainter::RenderHints renderHints,
+                       qreal devicePixelRatio)
+{
+    KisForest<KoShape*> renderTree;
+    buildRenderTree(shapes, renderTree);
+
+    if (childBegin(renderTree) == childEnd(renderTree)) {
+        return QImage();
+    }
+
+    QPainterPath tileOutline;
+    tileOutline.addRect(tileRect);
+
+    const QTransform patternTransform;
+
+    KoBakedShapeRenderer renderer(tileOutline, QTransform(),
+                                  cacheTransform.inverted(),
+                                  tileRect,
+                                  false, QRectF(),
+                                  false,
+                                  patternTransform);
+
+    QPainter *painter = renderer.bakeShapePainter();
+    painter->setRenderHints(renderHints);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(Qt::NoBrush);
+
+    renderShapes(childBegin(renderTree), childEnd(renderTree), *painter);
+    painter->end();
+
+    QImage image = renderer.patchImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    return image;
+}
+
 }
 
 void KoShapeManager::Private::updateTree()
@@ -308,6 +353,87 @@ void KoShapeManager::Private::forwardCompressedUpdate()
 
 }
 
+void KoShapeManager::Private::paintCached(QPainter &painter)
+{
+    const QRectF rect = KisPaintingTweaks::safeClipBoundingRect(painter);
+    const qreal devicePixelRatio = painter.device()->devicePixelRatioF();
+
+    rasterCache->setDeviceTransform(painter.deviceTransform());
+
+    const QTransform cacheTransform = rasterCache->cacheTransform();
+    const QTransform cacheToDocument = cacheTransform.inverted();
+    const int generation = rasterCache->generation();
+
+    struct TileJob {
+        QPoint index;
+        QList<KoShape*> shapes;
+        QImage image;
+    };
+
+    QVector<QPair<QPoint, QImage>> tiles;
+    QVector<TileJob> jobs;
+
+    Q_FOREACH (const QPoint &index, rasterCache->tilesForRect(rect)) {
+        QImage image;
+
+        if (rasterCache->fetchTile(index, &image)) {
+            if (!image.isNull()) {
+                tiles << qMakePair(index, image);
+            }
+            continue;
+        }
+
+        // account for the antialiased edges of the shapes lying outside the tile
+        const QRectF tileDocRect =
+            cacheToDocument.mapRect(QRectF(kisGrowRect(KoShapeRasterCache::tileRect(index), 2)));
+
+        TileJob job;
+        job.index = index;
+
+        {
+            QMutexLocker l(&treeMutex);
+            job.shapes = tree.intersects(tileDocRect);
+        }
+
+        jobs << job;
+    }
+
+    /**
+     * The shapes are not modified while we hold shapesMutex, since all
+     * the writes happen in the GUI thread, so they can be safely read from
+     * multiple threads at once.
+     */
+    const QPainter::RenderHints renderHints = painter.renderHints();
+
+    QtConcurrent::blockingMap(jobs,
+        [&] (TileJob &job) {
+            job.image = renderCacheTile(job.shapes, KoShapeRasterCache::tileRect(job.index),
+                                        cacheTransform, renderHints, devicePixelRatio);
+        });
+
+    Q_FOREACH (const TileJob &job, jobs) {
+        rasterCache->storeTile(job.index, job.image, generation);
+
+        if (!job.image.isNull()) {
+            tiles << qMakePair(job.index, job.image);
+        }
+    }
+
+    const QPoint deviceOffset = rasterCache->deviceOffset();
+
+    {
+        KisQPainterStateSaver saver(&painter);
+        painter.resetTransform();
+
+        for (auto it = tiles.constBegin(); it != tiles.constEnd(); ++it) {
+            const QPoint devicePos = deviceOffset + KoShapeRasterCache::tileRect(it->first).topLeft();
+            painter.drawImage(QPointF(devicePos) / devicePixelRatio, it->second);
+        }
+    }
+
+    rasterCache->limitTiles(rect);
+}
+
 KoShapeManager::KoShapeManager(KoCanvasBase *canvas, const QList<KoShape *> &shapes)
     : d(new Private(this, canvas))
 {
@@ -370,6 +496,10 @@ void KoShapeManager::setShapes(const QList<KoShape *> &shapes, Repaint repaint)
         d->shapeIndexesBeforeUpdate.clear();
         d->tree.clear();
         d->shapes.clear();
+
+        if (d->rasterCache) {
+            d->rasterCache->clear();
+        }
     }
 
     Q_FOREACH (KoShape *shape, shapes) {
@@ -392,6 +522,10 @@ void KoShapeManager::addShape(KoShape *shape, Repaint repaint)
 
             QRectF br(shape->boundingRect());
             d->tree.insert(br, shape);
+
+            if (d->rasterCache) {
+                d->rasterCache->invalidate(br);
+            }
         }
     }
 
@@ -427,6 +561,10 @@ void KoShapeManager::remove(KoShape *shape)
             d->tree.remove(shape);
         }
         d->shapes.removeAll(shape);
+
+        if (d->rasterCache) {
+            d->rasterCache->invalidate(dirtyRect);
+        }
     }
 
     if (!dirtyRect.isEmpty()) {
@@ -463,6 +601,11 @@ void KoShapeManager::ShapeInterface::notifyShapeDestructed(KoShape *shape)
     }
 
     q->d->shapes.removeAll(shape);
+
+    // the shape cannot tell its bounds anymore
+    if (q->d->rasterCache) {
+        q->d->rasterCache->clear();
+    }
 }
 
 
@@ -562,6 +705,11 @@ void KoShapeManager::paint(QPainter &painter)
     painter.setPen(Qt::NoPen);  // painters by default have a black stroke, lets turn that off.
     painter.setBrush(Qt::NoBrush);
 
+    if (d->rasterCache && KoShapeRasterCache::canCache(painter)) {
+        d->paintCached(painter);
+        return;
+    }
+
     QList<KoShape*> unsortedShapes;
     if (painter.hasClipping()) {
         QMutexLocker l(&d->treeMutex);
@@ -689,6 +837,10 @@ QList<KoShape *> KoShapeManager::shapesAt(const QRectF &rect, bool omitHiddenSha
 
 void KoShapeManager::update(const QRectF &rect, const KoShape *shape, bool selectionHandles)
 {
+    if (d->rasterCache) {
+        d->rasterCache->invalidate(rect);
+    }
+
     if (d->updatesBlocked) return;
 
     {
@@ -713,6 +865,23 @@ bool KoShapeManager::updatesBlocked() const
 {
     return d->updatesBlocked;
 }
+
+void KoShapeManager::setRasterCacheEnabled(bool value)
+{
+    QMutexLocker l(&d->shapesMutex);
+
+    if (value && !d->rasterCache) {
+        d->rasterCache.reset(new KoShapeRasterCache());
+    } else if (!value) {
+        d->rasterCache.reset();
+    }
+}
+
+bool KoShapeManager::rasterCacheEnabled() const
+{
+    return !d->rasterCache.isNull();
+}
+
 void KoShapeManager::notifyShapeChanged(KoShape *shape)
 {
     {
@@ -727,6 +896,10 @@ void KoShapeManager::notifyShapeChanged(KoShape *shape)
         d->shapeIndexesBeforeUpdate.insert(shape, shape->zIndex());
     }
 
+    if (d->rasterCache) {
+        d->rasterCache->invalidate(shape->boundingRect());
+    }
+
     KoShapeContainer *container = dynamic_cast<KoShapeContainer*>(shape);
     if (container) {
         Q_FOREACH (KoShape *child, container->shapes())
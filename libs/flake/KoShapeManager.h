@@ -181,6 +181,26 @@ public:
      */
     void paint(QPainter &painter);
 
+    /**
+     * Enables the raster cache for paint(). When the cache is enabled, the
+     * shapes are rendered into tiles at the current zoom level, and the
+     * following calls to paint() reuse the tiles until the shapes covering
+     * them are updated or the zoom level changes. The missing tiles are
+     * rendered in parallel.
+     *
+     * The cache should only be enabled for the managers painted from the GUI
+     * thread, and only when painting of the shapes is reentrant, because
+     * the same shape may be painted into several tiles at once.
+     *
+     * The cache is disabled by default.
+     */
+    void setRasterCacheEnabled(bool value);
+
+    /**
+     * \see setRasterCacheEnabled()
+     */
+    bool rasterCacheEnabled() const;
+
     /**
      * Returns the shape located at a specific point in the document.
      * If more than one shape is located at the specific point, the given selection type
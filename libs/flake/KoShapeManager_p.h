@@ -17,6 +17,7 @@
 #include <KoRTree.h>
 #include <QMutex>
 #include "kis_thread_safe_signal_compressor.h"
+#include "KoShapeRasterCache.h"
 
 class KoCanvasBase;
 class KoShapeGroup;
@@ -47,6 +48,12 @@ public:
 
     void forwardCompressedUpdate();
 
+    /**
+     * Paints the shapes through the raster cache, the missing tiles
+     * are rendered in parallel
+     */
+    void paintCached(QPainter &painter);
+
 
     /**
      * Recursively detach the shapes from this shape manager
@@ -69,6 +76,8 @@ public:
     QSet<const KoShape*> compressedUpdatedShapes;
 
     bool updatesBlocked = false;
+
+    QScopedPointer<KoShapeRasterCache> rasterCache;
 };
 
 #endif
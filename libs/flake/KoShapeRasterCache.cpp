@@ -0,0 +1,190 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoShapeRasterCache.h"
+
+#include <QPainter>
+#include <QtMath>
+
+#include <kis_algebra_2d.h>
+#include <kis_global.h>
+
+
+KoShapeRasterCache::KoShapeRasterCache(int maxTiles)
+    : m_maxTiles(maxTiles)
+{
+}
+
+bool KoShapeRasterCache::canCache(const QPainter &painter)
+{
+    return painter.hasClipping() &&
+        painter.deviceTransform().type() <= QTransform::TxScale &&
+        painter.deviceTransform().m11() > 0.0 &&
+        painter.deviceTransform().m22() > 0.0 &&
+        qFuzzyCompare(painter.opacity(), 1.0) &&
+        painter.compositionMode() == QPainter::CompositionMode_SourceOver;
+}
+
+void KoShapeRasterCache::setDeviceTransform(const QTransform &transform)
+{
+    const qreal offsetX = std::floor(transform.dx());
+    const qreal offsetY = std::floor(transform.dy());
+
+    const QTransform cacheTransform =
+        QTransform::fromScale(transform.m11(), transform.m22()) *
+        QTransform::fromTranslate(transform.dx() - offsetX, transform.dy() - offsetY);
+
+    QMutexLocker l(&m_mutex);
+
+    if (!m_hasTransform ||
+        !KisAlgebra2D::fuzzyMatrixCompare(cacheTransform, m_cacheTransform, 1e-6)) {
+
+        m_tiles.clear();
+        m_generation++;
+        m_cacheTransform = cacheTransform;
+        m_hasTransform = true;
+    }
+
+    m_deviceOffset = QPoint(int(offsetX), int(offsetY));
+}
+
+QTransform KoShapeRasterCache::cacheTransform() const
+{
+    QMutexLocker l(&m_mutex);
+    return m_cacheTransform;
+}
+
+QPoint KoShapeRasterCache::deviceOffset() const
+{
+    QMutexLocker l(&m_mutex);
+    return m_deviceOffset;
+}
+
+QRect KoShapeRasterCache::cacheRectForDocRect(const QRectF &docRect) const
+{
+    return m_cacheTransform.mapRect(docRect).toAlignedRect();
+}
+
+QVector<QPoint> KoShapeRasterCache::tilesForRect(const QRectF &docRect) const
+{
+    QMutexLocker l(&m_mutex);
+
+    const QRect rc = cacheRectForDocRect(docRect);
+    if (rc.isEmpty()) return {};
+
+    const int firstCol = KisAlgebra2D::divideFloor(rc.left(), TileSize);
+    const int lastCol = KisAlgebra2D::divideFloor(rc.right(), TileSize);
+    const int firstRow = KisAlgebra2D::divideFloor(rc.top(), TileSize);
+    const int lastRow = KisAlgebra2D::divideFloor(rc.bottom(), TileSize);
+
+    QVector<QPoint> result;
+    result.reserve((lastCol - firstCol + 1) * (lastRow - firstRow + 1));
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int col = firstCol; col <= lastCol; col++) {
+            result << QPoint(col, row);
+        }
+    }
+
+    return result;
+}
+
+QRect KoShapeRasterCache::tileRect(const QPoint &index)
+{
+    return QRect(index.x() * TileSize, index.y() * TileSize, TileSize, TileSize);
+}
+
+bool KoShapeRasterCache::fetchTile(const QPoint &index, QImage *image) const
+{
+    QMutexLocker l(&m_mutex);
+
+    auto it = m_tiles.constFind(tileKey(index));
+    if (it == m_tiles.constEnd()) return false;
+
+    *image = *it;
+    return true;
+}
+
+void KoShapeRasterCache::storeTile(const QPoint &index, const QImage &image, int generation)
+{
+    QMutexLocker l(&m_mutex);
+
+    if (generation != m_generation) return;
+
+    m_tiles.insert(tileKey(index), image);
+}
+
+int KoShapeRasterCache::generation() const
+{
+    QMutexLocker l(&m_mutex);
+    return m_generation;
+}
+
+void KoShapeRasterCache::invalidate(const QRectF &docRect)
+{
+    QMutexLocker l(&m_mutex);
+
+    m_generation++;
+
+    if (m_tiles.isEmpty()) return;
+
+    // the antialiased edges may spill into the neighbouring pixels
+    const QRect rc = kisGrowRect(cacheRectForDocRect(docRect), 2);
+
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        if (tileRect(tileIndex(it.key())).intersects(rc)) {
+            it = m_tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void KoShapeRasterCache::clear()
+{
+    QMutexLocker l(&m_mutex);
+
+    m_generation++;
+    m_tiles.clear();
+}
+
+void KoShapeRasterCache::limitTiles(const QRectF &docRect)
+{
+    QMutexLocker l(&m_mutex);
+
+    if (m_tiles.size() <= m_maxTiles) return;
+
+    const QRect rc = cacheRectForDocRect(docRect);
+    const QPoint center = rc.center();
+
+    QVector<QPair<qint64, quint64>> candidates;
+
+    for (auto it = m_tiles.constBegin(); it != m_tiles.constEnd(); ++it) {
+        const QRect tile = tileRect(tileIndex(it.key()));
+        if (tile.intersects(rc)) continue;
+
+        const QPoint diff = tile.center() - center;
+        candidates << qMakePair(qint64(diff.x()) * diff.x() + qint64(diff.y()) * diff.y(), it.key());
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [] (const QPair<qint64, quint64> &lhs, const QPair<qint64, quint64> &rhs) {
+                  return lhs.first > rhs.first;
+              });
+
+    for (auto it = candidates.constBegin();
+         it != candidates.constEnd() && m_tiles.size() > m_maxTiles;
+         ++it) {
+
+        m_tiles.remove(it->second);
+    }
+}
+
+int KoShapeRasterCache::numTiles() const
+{
+    QMutexLocker l(&m_mutex);
+    return m_tiles.size();
+}
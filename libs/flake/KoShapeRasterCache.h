@@ -0,0 +1,144 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOSHAPERASTERCACHE_H
+#define KOSHAPERASTERCACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPoint>
+#include <QRect>
+#include <QTransform>
+#include <QVector>
+
+class QPainter;
+
+/**
+ * A tiled raster cache of the shapes rendered by KoShapeManager::paint()
+ *
+ * The tiles are stored in the "cache space", which is the document space
+ * scaled to the current level of detail and shifted by the subpixel part
+ * of the view offset. The integer part of the offset is applied when the
+ * tiles are drawn, so panning the view by whole pixels reuses the existing
+ * tiles, while zooming drops them.
+ *
+ * Only the transformations without rotation or shear can be cached, see
+ * canCache().
+ *
+ * All the methods are thread-safe.
+ */
+class KoShapeRasterCache
+{
+public:
+    static const int TileSize = 256;
+
+    /**
+     * @param maxTiles the number of tiles the cache keeps when the
+     * painted area is smaller than that
+     */
+    KoShapeRasterCache(int maxTiles = 128);
+
+    /**
+     * @return true if the shapes painted with \p painter can be served from
+     * the cache: the world transform has no rotation or shear, the painter
+     * has a clip region and paints with the default opacity and composition
+     * mode
+     */
+    static bool canCache(const QPainter &painter);
+
+    /**
+     * Sets the device transform of the painter the shapes are going to be
+     * painted with. All the tiles are dropped if the level of detail or the
+     * subpixel offset has changed.
+     */
+    void setDeviceTransform(const QTransform &transform);
+
+    /**
+     * @return the transformation from the document space into the cache space
+     */
+    QTransform cacheTransform() const;
+
+    /**
+     * @return the offset of the cache space in the device pixels
+     */
+    QPoint deviceOffset() const;
+
+    /**
+     * @return the indexes of the tiles covering \p docRect
+     */
+    QVector<QPoint> tilesForRect(const QRectF &docRect) const;
+
+    /**
+     * @return the rect of a tile in the cache space
+     */
+    static QRect tileRect(const QPoint &index);
+
+    /**
+     * Fetches a tile from the cache.
+     *
+     * @param image the tile image, it is null for the tiles with no shapes
+     * @return false if the tile is not present in the cache
+     */
+    bool fetchTile(const QPoint &index, QImage *image) const;
+
+    /**
+     * Stores a tile rendered for the cache state \p generation. The tile is
+     * dropped if the cache has been invalidated since then.
+     */
+    void storeTile(const QPoint &index, const QImage &image, int generation);
+
+    /**
+     * @return the counter incremented on every invalidation
+     */
+    int generation() const;
+
+    /**
+     * Drops the tiles intersecting \p docRect
+     */
+    void invalidate(const QRectF &docRect);
+
+    /**
+     * Drops all the tiles
+     */
+    void clear();
+
+    /**
+     * Drops the tiles farthest from \p docRect when there are more tiles than
+     * the limit. The tiles intersecting \p docRect are never dropped.
+     */
+    void limitTiles(const QRectF &docRect);
+
+    /**
+     * @return the number of stored tiles
+     */
+    int numTiles() const;
+
+private:
+    QRect cacheRectForDocRect(const QRectF &docRect) const;
+
+    static inline quint64 tileKey(const QPoint &index) {
+        return (quint64(quint32(index.x())) << 32) | quint32(index.y());
+    }
+
+    static inline QPoint tileIndex(quint64 key) {
+        return QPoint(qint32(quint32(key >> 32)), qint32(quint32(key)));
+    }
+
+private:
+    mutable QMutex m_mutex;
+
+    int m_maxTiles;
+    int m_generation {0};
+
+    QTransform m_cacheTransform;
+    QPoint m_deviceOffset;
+    bool m_hasTransform {false};
+
+    QHash<quint64, QImage> m_tiles;
+};
+
+#endif // KOSHAPERASTERCACHE_H
@@ -8,12 +8,15 @@
 #include <QtGui>
 #include "KoShapeContainer.h"
 #include "KoShapeManager.h"
+#include "KoPathShape.h"
+#include "KoColorBackground.h"
 
 #include <MockShapes.h>
 #include <testflake.h>
 
 
 #include <simpletest.h>
+#include <qimage_test_util.h>
 
 void TestShapePainting::testPaintShape()
 {
@@ -298,4 +301,95 @@ void TestShapePainting::testGroupUngroup()
     }
 }
 
+void TestShapePainting::testRasterCache()
+{
+    MockCanvas canvas;
+    KoShapeManager referenceManager(&canvas);
+    KoShapeManager cachedManager(&canvas);
+    cachedManager.setRasterCacheEnabled(true);
+    QVERIFY(cachedManager.rasterCacheEnabled());
+
+    QList<KoShape*> shapes;
+
+    for (int i = 0; i < 20; i++) {
+        QPainterPath path;
+        path.addEllipse(QRectF(i * 23.3, i * 17.1, 80.0, 60.0));
+
+        KoPathShape *shape = KoPathShape::createShapeFromPainterPath(path);
+        shape->setBackground(QSharedPointer<KoColorBackground>(
+                                 new KoColorBackground(QColor::fromHsv(i * 18, 200, 200, 160))));
+        shape->setZIndex(i);
+        shapes << shape;
+
+        referenceManager.addShape(shape, KoShapeManager::AddWithoutRepaint);
+        cachedManager.addShape(shape, KoShapeManager::AddWithoutRepaint);
+    }
+
+    // the mock shape doesn't paint anything, it just counts the repaints
+    MockShape *mockShape = new MockShape();
+    mockShape->setPosition(QPointF(10, 10));
+    mockShape->setSize(QSizeF(20, 20));
+    shapes << mockShape;
+
+    cachedManager.addShape(mockShape, KoShapeManager::AddWithoutRepaint);
+
+    auto render = [] (KoShapeManager &manager, const QTransform &transform) {
+        QImage image(600, 500, QImage::Format_ARGB32_Premultiplied);
+        image.fill(0);
+
+        QPainter gc(&image);
+        gc.setRenderHint(QPainter::Antialiasing);
+        gc.setClipRect(image.rect());
+        gc.setTransform(transform);
+        manager.paint(gc);
+
+        return image;
+    };
+
+    auto checkSameRendering = [&] (const QTransform &transform) {
+        const QImage reference = render(referenceManager, transform);
+        const QImage cached = render(cachedManager, transform);
+
+        QPoint pt;
+        return TestUtil::compareQImages(pt, reference, cached, 2, 2);
+    };
+
+    const QTransform transform = QTransform::fromScale(1.5, 1.5) * QTransform::fromTranslate(7.3, 3.6);
+
+    QVERIFY(checkSameRendering(transform));
+    QCOMPARE(mockShape->paintedCount, 1);
+
+    // the second paint is served from the cache
+    QVERIFY(checkSameRendering(transform));
+    QCOMPARE(mockShape->paintedCount, 1);
+
+    // panning by whole pixels reuses the tiles
+    QVERIFY(checkSameRendering(transform * QTransform::fromTranslate(-40, -30)));
+    QCOMPARE(mockShape->paintedCount, 1);
+
+    // an updated shape is rendered again
+    mockShape->update();
+    QVERIFY(checkSameRendering(transform));
+    QCOMPARE(mockShape->paintedCount, 2);
+
+    // a moved shape is rendered in the new position
+    shapes[3]->update();
+    shapes[3]->setPosition(shapes[3]->position() + QPointF(100, 50));
+    shapes[3]->update();
+    QVERIFY(checkSameRendering(transform));
+    QCOMPARE(mockShape->paintedCount, 2);
+
+    // zooming drops the cache
+    QVERIFY(checkSameRendering(QTransform::fromScale(0.7, 0.7)));
+    QCOMPARE(mockShape->paintedCount, 3);
+
+    // rotated views are not cached
+    QVERIFY(checkSameRendering(QTransform().rotate(30)));
+    QCOMPARE(mockShape->paintedCount, 4);
+    QVERIFY(checkSameRendering(QTransform().rotate(30)));
+    QCOMPARE(mockShape->paintedCount, 5);
+
+    qDeleteAll(shapes);
+}
+
 KISTEST_MAIN(TestShapePainting)
@@ -12,6 +12,7 @@
 #include <text/KoFontRegistry.h>
 #include <text/KoSvgText.h>
 #include <text/KoSvgTextProperties.h>
+#include <text/KoSvgTextShapingCache.h>
 
 #include "KoSvgTextShapeMarkupConverter.h"
 #include "SvgParserTestingUtils.h"
@@ -2358,6 +2359,65 @@ void TestSvgText::testShapeInsideRender()
     }
 }
 
+/**
+ * Tests that the text laid out from the shaping cache is the same as the
+ * text shaped from scratch.
+ */
+void TestSvgText::testShapingCache()
+{
+    QFile file(TestUtil::fetchDataFileLazy("fonts/textTestSvgs/text-test-simple-text.svg"));
+    bool res = file.open(QIODevice::ReadOnly | QIODevice::Text);
+    QVERIFY2(res, QString("Cannot open test svg file.").toLatin1());
+
+    QXmlInputSource data;
+    data.setData(file.readAll());
+
+    SvgTester t(data.data());
+    t.parser.setResolution(QRectF(0, 0, 140, 40) /* px */, 72 /* ppi */);
+    t.run();
+
+    KoSvgTextShape *textShape = dynamic_cast<KoSvgTextShape*>(t.findShape("testRect"));
+    QVERIFY(textShape);
+
+    auto outline = [textShape] () {
+        QPainterPath path;
+        Q_FOREACH (KoShape *shape, textShape->textOutline()) {
+            path.addPath(shape->transformation().map(shape->outline()));
+            delete shape;
+        }
+        return path;
+    };
+
+    KoSvgTextShapingCache *cache = KoSvgTextShapingCache::instance();
+
+    cache->clear();
+    QCOMPARE(cache->size(), 0);
+    QCOMPARE(cache->hits(), 0);
+
+    textShape->relayout();
+    const QPainterPath shapedOutline = outline();
+    QVERIFY(!shapedOutline.isEmpty());
+
+    const int numEntries = cache->size();
+    const int numHits = cache->hits();
+    QVERIFY(numEntries > 0);
+
+    // the second layout reuses the shaped text
+    textShape->relayout();
+    QCOMPARE(outline(), shapedOutline);
+    QVERIFY(cache->hits() > numHits);
+    QCOMPARE(cache->size(), numEntries);
+
+    cache->clear();
+    QCOMPARE(cache->size(), 0);
+    QCOMPARE(cache->hits(), 0);
+
+    // shaped from scratch again
+    textShape->relayout();
+    QCOMPARE(outline(), shapedOutline);
+    QCOMPARE(cache->size(), numEntries);
+}
+
 #include "kistest.h"
 
 
@@ -88,6 +88,8 @@ private Q_SLOTS:
 
     void testCssShapeParsing();
     void testShapeInsideRender();
+
+    void testShapingCache();
 };
 
 #endif // TESTSVGTEXT_H
@@ -8,6 +8,8 @@
 #include "KoCssTextUtils.h"
 
 #include <QApplication>
+#include <QAtomicInt>
+#include <QCache>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -55,15 +57,17 @@ private:
         FT_LibraryUP m_library;
         QHash<FcChar32, FcPatternUP> m_patterns;
         QHash<FcChar32, FcFontSetUP> m_fontSets;
-        QHash<QString, FT_FaceUP> m_faces;
+        QCache<QString, FT_FaceUP> m_faces;
 
-        ThreadData(FT_LibraryUP lib)
+        ThreadData(FT_LibraryUP lib, int maxFaces)
             : m_library(std::move(lib))
+            , m_faces(maxFaces)
         {
         }
     };
 
     QThreadStorage<QSharedPointer<ThreadData>> m_data;
+    QAtomicInt m_faceCacheSize {256};
 
     void initialize()
     {
@@ -74,7 +78,7 @@ private:
                 errorFlake << "Error with initializing FreeType library:" << error << "Current thread:" << QThread::currentThread()
                            << "GUI thread:" << qApp->thread();
             } else {
-                m_data.setLocalData(QSharedPointer<ThreadData>::create(lib));
+                m_data.setLocalData(QSharedPointer<ThreadData>::create(lib, m_faceCacheSize.loadAcquire()));
             }
         }
     }
@@ -122,11 +126,29 @@ public:
         return m_data.localData()->m_fontSets;
     }
 
-    QHash<QString, FT_FaceUP> &typeFaces()
+    QCache<QString, FT_FaceUP> &typeFaces()
     {
         if (!m_data.hasLocalData())
             initialize();
-        return m_data.localData()->m_faces;
+
+        QCache<QString, FT_FaceUP> &faces = m_data.localData()->m_faces;
+
+        // the limit may have been changed from another thread
+        const int maxFaces = m_faceCacheSize.loadAcquire();
+        if (faces.maxCost() != maxFaces) {
+            faces.setMaxCost(maxFaces);
+        }
+        return faces;
+    }
+
+    void setFaceCacheSize(int size)
+    {
+        m_faceCacheSize.storeRelease(qMax(1, size));
+    }
+
+    int faceCacheSize() const
+    {
+        return m_faceCacheSize.loadAcquire();
     }
 
     FcConfigUP config() const
@@ -147,6 +169,21 @@ KoFontRegistry *KoFontRegistry::instance()
     return s_instance;
 }
 
+FT_LibraryUP KoFontRegistry::library()
+{
+    return d->library();
+}
+
+void KoFontRegistry::setFaceCacheSize(int size)
+{
+    d->setFaceCacheSize(size);
+}
+
+int KoFontRegistry::faceCacheSize() const
+{
+    return d->faceCacheSize();
+}
+
 std::vector<FT_FaceUP> KoFontRegistry::facesForCSSValues(const QStringList &families,
                                                          QVector<int> &lengths,
                                                          const QMap<QString, qreal> &axisSettings,
@@ -392,9 +429,9 @@ std::vector<FT_FaceUP> KoFontRegistry::facesForCSSValues(const QStringList &fami
     for (int i = 0; i < lengths.size(); i++) {
         const FontEntry &font = fonts.at(i);
         const QString fontCacheEntry = font.fileName + "#" + QString::number(font.fontIndex) + "#" + modifications;
-        auto entry = d->typeFaces().find(fontCacheEntry);
-        if (entry != d->typeFaces().end()) {
-            faces.emplace_back(entry.value());
+        FT_FaceUP *entry = d->typeFaces().object(fontCacheEntry);
+        if (entry) {
+            faces.emplace_back(*entry);
         } else {
             FT_Face f = nullptr;
             QByteArray utfData = font.fileName.toUtf8();
@@ -402,7 +439,7 @@ std::vector<FT_FaceUP> KoFontRegistry::facesForCSSValues(const QStringList &fami
                 FT_FaceUP face(f);
                 configureFaces({face}, size, fontSizeAdjust, xRes, yRes, axisSettings);
                 faces.emplace_back(face);
-                d->typeFaces().insert(fontCacheEntry, face);
+                d->typeFaces().insert(fontCacheEntry, new FT_FaceUP(face));
             }
         }
     }
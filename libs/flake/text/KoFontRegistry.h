@@ -73,6 +73,31 @@ public:
                         quint32 yRes,
                         const QMap<QString, qreal> &axisSettings);
 
+    /**
+     * @brief library
+     * @returns the freetype library of the current thread. The faces
+     * returned by facesForCSSValues() belong to this library, so the
+     * objects holding the faces past the current call should hold the
+     * library as well.
+     */
+    FT_LibraryUP library();
+
+    /**
+     * @brief setFaceCacheSize
+     * Every thread keeps the recently used faces loaded, because loading
+     * a face from the file is expensive. The least recently used ones are
+     * unloaded when there are more than \p size of them in a thread. The
+     * faces still used by the laid out text stay alive until the text is
+     * laid out again.
+     */
+    void setFaceCacheSize(int size);
+
+    /**
+     * @brief faceCacheSize
+     * @returns the maximum number of the faces cached per thread.
+     */
+    int faceCacheSize() const;
+
 private:
     class Private;
 
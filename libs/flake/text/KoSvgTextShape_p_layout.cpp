@@ -14,12 +14,14 @@
 #include "KoFontRegistry.h"
 #include "KoSvgTextChunkShapeLayoutInterface.h"
 #include "KoSvgTextProperties.h"
+#include "KoSvgTextShapingCache.h"
 
 #include <FlakeDebug.h>
 #include <KoPathShape.h>
 
 #include <kis_global.h>
 
+#include <QDataStream>
 #include <QPainterPath>
 #include <QtMath>
 
@@ -38,8 +40,6 @@
 
 #include <raqm.h>
 
-using raqm_t_up = KisLibraryResourcePointer<raqm_t, raqm_destroy>;
-
 using KoSvgTextShapeLayoutFunc::calculateLineHeight;
 using KoSvgTextShapeLayoutFunc::breakLines;
 using KoSvgTextShapeLayoutFunc::getShapes;
@@ -180,18 +180,40 @@ void KoSvgTextShape::Private::relayout(const KoSvgTextShape *q)
 
     QMap<int, KoSvgText::TabSizeInfo> tabSizeInfo;
 
-    // pass everything to a css-compatible text-layout algortihm.
-    raqm_t_up layout(raqm_create());
+    /**
+     * The inputs of the shaping of a single chunk. The shaped text depends
+     * only on them, so they form the key of the shaping cache together
+     * with the text itself.
+     */
+    struct ShapingChunk {
+        int start = 0;
+        int length = 0;
+        QString text;
+        QStringList fontFamilies;
+        QMap<QString, qreal> axisSettings;
+        qreal fontSize = 0.0;
+        qreal fontSizeAdjust = 1.0;
+        int fontWeight = 400;
+        int fontStretch = 100;
+        QFont::Style fontStyle = QFont::StyleNormal;
+        QString language;
+        QStringList fontFeatures;
+        KoSvgText::AutoValue letterSpacing;
+        KoSvgText::AutoValue wordSpacing;
+        KoSvgText::LineHeightInfo lineHeight;
+    };
 
-    if (raqm_set_text_utf16(layout.data(), text.utf16(), static_cast<size_t>(text.size()))) {
-        if (writingMode == KoSvgText::VerticalRL || writingMode == KoSvgText::VerticalLR) {
-            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_TTB);
-        } else if (direction == KoSvgText::DirectionRightToLeft) {
-            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_RTL);
-        } else {
-            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_LTR);
-        }
+    QVector<ShapingChunk> shapingChunks;
+    QVector<int> runBreaks;
+
+    raqm_direction_t parDirection = RAQM_DIRECTION_LTR;
+    if (writingMode == KoSvgText::VerticalRL || writingMode == KoSvgText::VerticalLR) {
+        parDirection = raqm_direction_t::RAQM_DIRECTION_TTB;
+    } else if (direction == KoSvgText::DirectionRightToLeft) {
+        parDirection = raqm_direction_t::RAQM_DIRECTION_RTL;
+    }
 
+    {
         int start = 0;
         Q_FOREACH (const KoSvgTextChunkShapeLayoutInterface::SubChunk &chunk, textChunks) {
             int length = chunk.text.size();
@@ -290,7 +312,7 @@ void KoSvgTextShape::Private::relayout(const KoSvgTextShape *q)
                 }
 
                 if (resolvedTransforms.at(start + i).startsNewChunk()) {
-                    raqm_set_arbitrary_run_break(layout.data(), static_cast<size_t>(start + i), true);
+                    runBreaks << start + i;
                 }
 
                 if (chunk.firstTextInPath && i == 0) {
@@ -299,179 +321,256 @@ void KoSvgTextShape::Private::relayout(const KoSvgTextShape *q)
                 result[start + i] = cr;
             }
 
-            QVector<int> lengths;
-            QStringList fontFeatures = properties.fontFeaturesForText(start, length);
+            ShapingChunk shapingChunk;
+            shapingChunk.start = start;
+            shapingChunk.length = length;
+            shapingChunk.text = chunk.text;
+            shapingChunk.fontFamilies = properties.property(KoSvgTextProperties::FontFamiliesId).toStringList();
+            shapingChunk.axisSettings = properties.fontAxisSettings();
+            shapingChunk.fontFeatures = properties.fontFeaturesForText(start, length);
+            shapingChunk.fontSize = properties.property(KoSvgTextProperties::FontSizeId).toReal();
+            shapingChunk.fontStyle = QFont::Style(properties.propertyOrDefault(KoSvgTextProperties::FontStyleId).toInt());
 
-            qreal fontSize = properties.property(KoSvgTextProperties::FontSizeId).toReal();
-            const QFont::Style style = QFont::Style(properties.propertyOrDefault(KoSvgTextProperties::FontStyleId).toInt());
             KoSvgText::AutoValue fontSizeAdjust = properties.propertyOrDefault(KoSvgTextProperties::FontSizeAdjustId).value<KoSvgText::AutoValue>();
             if (properties.hasProperty(KoSvgTextProperties::KraTextVersionId)) {
                 fontSizeAdjust.isAuto = (properties.property(KoSvgTextProperties::KraTextVersionId).toInt() < 3);
             }
-            const std::vector<FT_FaceUP> faces = KoFontRegistry::instance()->facesForCSSValues(
-                properties.property(KoSvgTextProperties::FontFamiliesId).toStringList(),
-                lengths,
-                properties.fontAxisSettings(),
-                chunk.text,
-                static_cast<quint32>(finalRes),
-                static_cast<quint32>(finalRes),
-                fontSize,
-                fontSizeAdjust.isAuto ? 1.0 : fontSizeAdjust.customValue,
-                properties.propertyOrDefault(KoSvgTextProperties::FontWeightId).toInt(),
-                properties.propertyOrDefault(KoSvgTextProperties::FontStretchId).toInt(),
-                style != QFont::StyleNormal);
+            shapingChunk.fontSizeAdjust = fontSizeAdjust.isAuto ? 1.0 : fontSizeAdjust.customValue;
+
+            shapingChunk.fontWeight = properties.propertyOrDefault(KoSvgTextProperties::FontWeightId).toInt();
+            shapingChunk.fontStretch = properties.propertyOrDefault(KoSvgTextProperties::FontStretchId).toInt();
             if (properties.hasProperty(KoSvgTextProperties::TextLanguage)) {
-                raqm_set_language(layout.data(),
-                                  properties.property(KoSvgTextProperties::TextLanguage).toString().toUtf8(),
-                                  static_cast<size_t>(start),
-                                  static_cast<size_t>(length));
-            }
-            Q_FOREACH (const QString &feature, fontFeatures) {
-                debugFlake << "adding feature" << feature;
-                raqm_add_font_feature(layout.data(), feature.toUtf8(), feature.toUtf8().size());
+                shapingChunk.language = properties.property(KoSvgTextProperties::TextLanguage).toString();
             }
+            shapingChunk.letterSpacing = letterSpacing;
+            shapingChunk.wordSpacing = wordSpacing;
+            shapingChunk.lineHeight = lineHeight;
 
-            if (!letterSpacing.isAuto) {
-                raqm_set_letter_spacing_range(layout.data(),
-                                              static_cast<int>(letterSpacing.customValue * ftFontUnit * scaleToPixel),
-                                              static_cast<size_t>(start),
-                                              static_cast<size_t>(length));
-            }
+            shapingChunks << shapingChunk;
 
-            if (!wordSpacing.isAuto) {
-                raqm_set_word_spacing_range(layout.data(),
-                                            static_cast<int>(wordSpacing.customValue * ftFontUnit * scaleToPixel),
-                                            static_cast<size_t>(start),
-                                            static_cast<size_t>(length));
+            start += length;
+        }
+    }
+
+    QByteArray shapingKey;
+    {
+        QDataStream stream(&shapingKey, QIODevice::WriteOnly);
+        stream << text << int(parDirection) << qint32(loadFlags) << finalRes << isHorizontal << runBreaks;
+
+        Q_FOREACH (const ShapingChunk &chunk, shapingChunks) {
+            stream << chunk.length << chunk.fontFamilies << chunk.axisSettings
+                   << chunk.fontSize << chunk.fontSizeAdjust
+                   << chunk.fontWeight << chunk.fontStretch << int(chunk.fontStyle)
+                   << chunk.language << chunk.fontFeatures
+                   << chunk.letterSpacing.isAuto << chunk.letterSpacing.customValue
+                   << chunk.wordSpacing.isAuto << chunk.wordSpacing.customValue;
+        }
+    }
+
+    KoSvgTextShapingCache::ResultSP shaped = KoSvgTextShapingCache::instance()->find(shapingKey);
+
+    if (!shaped) {
+        QSharedPointer<KoSvgTextShapingCache::Result> newShaped(new KoSvgTextShapingCache::Result());
+        newShaped->library = KoFontRegistry::instance()->library();
+        newShaped->metrics.resize(text.size());
+
+        // pass everything to a css-compatible text-layout algortihm.
+        raqm_t_up layout(raqm_create());
+
+        if (raqm_set_text_utf16(layout.data(), text.utf16(), static_cast<size_t>(text.size()))) {
+            raqm_set_par_direction(layout.data(), parDirection);
+
+            Q_FOREACH (int runBreak, runBreaks) {
+                raqm_set_arbitrary_run_break(layout.data(), static_cast<size_t>(runBreak), true);
             }
 
-            for (int i = 0; i < lengths.size(); i++) {
-                length = lengths.at(i);
-                const FT_FaceUP &face = faces.at(static_cast<size_t>(i));
-                const FT_Int32 faceLoadFlags = loadFlagsForFace(face.data());
-                if (start == 0) {
-                    raqm_set_freetype_face(layout.data(), face.data());
-                    raqm_set_freetype_load_flags(layout.data(), faceLoadFlags);
+            Q_FOREACH (const ShapingChunk &chunk, shapingChunks) {
+                int start = chunk.start;
+                int length = chunk.length;
+
+                QVector<int> lengths;
+                const std::vector<FT_FaceUP> faces = KoFontRegistry::instance()->facesForCSSValues(
+                    chunk.fontFamilies,
+                    lengths,
+                    chunk.axisSettings,
+                    chunk.text,
+                    static_cast<quint32>(finalRes),
+                    static_cast<quint32>(finalRes),
+                    chunk.fontSize,
+                    chunk.fontSizeAdjust,
+                    chunk.fontWeight,
+                    chunk.fontStretch,
+                    chunk.fontStyle != QFont::StyleNormal);
+                if (!chunk.language.isNull()) {
+                    raqm_set_language(layout.data(),
+                                      chunk.language.toUtf8(),
+                                      static_cast<size_t>(start),
+                                      static_cast<size_t>(length));
                 }
-                if (length > 0) {
-                    raqm_set_freetype_face_range(layout.data(),
-                                                 face.data(),
-                                                 static_cast<size_t>(start),
-                                                 static_cast<size_t>(length));
-                    raqm_set_freetype_load_flags_range(layout.data(),
-                                                       faceLoadFlags,
-                                                       static_cast<size_t>(start),
-                                                       static_cast<size_t>(length));
+                Q_FOREACH (const QString &feature, chunk.fontFeatures) {
+                    debugFlake << "adding feature" << feature;
+                    raqm_add_font_feature(layout.data(), feature.toUtf8(), feature.toUtf8().size());
                 }
 
-                hb_font_t_up font(hb_ft_font_create_referenced(face.data()));
-                hb_position_t ascender = 0;
-                hb_position_t descender = 0;
-                hb_position_t lineGap = 0;
+                if (!chunk.letterSpacing.isAuto) {
+                    raqm_set_letter_spacing_range(layout.data(),
+                                                  static_cast<int>(chunk.letterSpacing.customValue * ftFontUnit * scaleToPixel),
+                                                  static_cast<size_t>(start),
+                                                  static_cast<size_t>(length));
+                }
 
-                if (isHorizontal) {
-                    /**
-                     * There's 3 different definitions of the so-called vertical metrics, that is,
-                     * the ascender and descender for horizontally laid out script. WinAsc & Desc,
-                     * HHAE asc&desc, and OS/2... we need the last one, but harfbuzz doesn't return
-                     * it unless there's a flag set in the font, which is missing in a lot of fonts
-                     * that were from the transitional period, like Deja Vu Sans. Hence we need to get
-                     * the OS/2 table and calculate the values manually (and fall back in various ways).
-                     *
-                     * https://www.w3.org/TR/css-inline-3/#ascent-descent
-                     * https://www.w3.org/TR/CSS2/visudet.html#sTypoAscender
-                     * https://wiki.inkscape.org/wiki/Text_Rendering_Notes#Ascent_and_Descent
-                     *
-                     * Related HB issue: https://github.com/harfbuzz/harfbuzz/issues/1920
-                     */
-                    TT_OS2 *os2Table = nullptr;
-                    os2Table = (TT_OS2*)FT_Get_Sfnt_Table(face.data(), FT_SFNT_OS2);
-                    if (os2Table) {
-                        int yscale = face.data()->size->metrics.y_scale;
-
-                        ascender = FT_MulFix(os2Table->sTypoAscender, yscale);
-                        descender = FT_MulFix(os2Table->sTypoDescender, yscale);
-                        lineGap = FT_MulFix(os2Table->sTypoLineGap, yscale);
+                if (!chunk.wordSpacing.isAuto) {
+                    raqm_set_word_spacing_range(layout.data(),
+                                                static_cast<int>(chunk.wordSpacing.customValue * ftFontUnit * scaleToPixel),
+                                                static_cast<size_t>(start),
+                                                static_cast<size_t>(length));
+                }
+
+                for (int i = 0; i < lengths.size(); i++) {
+                    length = lengths.at(i);
+                    const FT_FaceUP &face = faces.at(static_cast<size_t>(i));
+                    const FT_Int32 faceLoadFlags = loadFlagsForFace(face.data());
+                    if (start == 0) {
+                        raqm_set_freetype_face(layout.data(), face.data());
+                        raqm_set_freetype_load_flags(layout.data(), faceLoadFlags);
+                    }
+                    if (length > 0) {
+                        raqm_set_freetype_face_range(layout.data(),
+                                                     face.data(),
+                                                     static_cast<size_t>(start),
+                                                     static_cast<size_t>(length));
+                        raqm_set_freetype_load_flags_range(layout.data(),
+                                                           faceLoadFlags,
+                                                           static_cast<size_t>(start),
+                                                           static_cast<size_t>(length));
                     }
 
-                    constexpr unsigned USE_TYPO_METRICS = 1u << 7;
-                    if (!os2Table || os2Table->version == 0xFFFFU || !(os2Table->fsSelection & USE_TYPO_METRICS)) {
-                        hb_position_t altAscender = 0;
-                        hb_position_t altDescender = 0;
-                        hb_position_t altLineGap = 0;
-                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER, &altAscender)) {
-                            altAscender = face.data()->ascender;
+                    hb_font_t_up font(hb_ft_font_create_referenced(face.data()));
+                    hb_position_t ascender = 0;
+                    hb_position_t descender = 0;
+                    hb_position_t lineGap = 0;
+
+                    if (isHorizontal) {
+                        /**
+                         * There's 3 different definitions of the so-called vertical metrics, that is,
+                         * the ascender and descender for horizontally laid out script. WinAsc & Desc,
+                         * HHAE asc&desc, and OS/2... we need the last one, but harfbuzz doesn't return
+                         * it unless there's a flag set in the font, which is missing in a lot of fonts
+                         * that were from the transitional period, like Deja Vu Sans. Hence we need to get
+                         * the OS/2 table and calculate the values manually (and fall back in various ways).
+                         *
+                         * https://www.w3.org/TR/css-inline-3/#ascent-descent
+                         * https://www.w3.org/TR/CSS2/visudet.html#sTypoAscender
+                         * https://wiki.inkscape.org/wiki/Text_Rendering_Notes#Ascent_and_Descent
+                         *
+                         * Related HB issue: https://github.com/harfbuzz/harfbuzz/issues/1920
+                         */
+                        TT_OS2 *os2Table = nullptr;
+                        os2Table = (TT_OS2*)FT_Get_Sfnt_Table(face.data(), FT_SFNT_OS2);
+                        if (os2Table) {
+                            int yscale = face.data()->size->metrics.y_scale;
+
+                            ascender = FT_MulFix(os2Table->sTypoAscender, yscale);
+                            descender = FT_MulFix(os2Table->sTypoDescender, yscale);
+                            lineGap = FT_MulFix(os2Table->sTypoLineGap, yscale);
                         }
-                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER, &altDescender)) {
-                            altDescender = face.data()->descender;
+
+                        constexpr unsigned USE_TYPO_METRICS = 1u << 7;
+                        if (!os2Table || os2Table->version == 0xFFFFU || !(os2Table->fsSelection & USE_TYPO_METRICS)) {
+                            hb_position_t altAscender = 0;
+                            hb_position_t altDescender = 0;
+                            hb_position_t altLineGap = 0;
+                            if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER, &altAscender)) {
+                                altAscender = face.data()->ascender;
+                            }
+                            if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER, &altDescender)) {
+                                altDescender = face.data()->descender;
+                            }
+                            if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP, &altLineGap)) {
+                                altLineGap = face.data()->height - (altAscender-altDescender);
+                            }
+
+                            // Some fonts have sTypo metrics that are too small compared
+                            // to the HHEA values which make the default line height too
+                            // tight (e.g. Microsoft JhengHei, Source Han Sans), so we
+                            // compare them and take the ones that are larger.
+                            if (!os2Table || (altAscender - altDescender + altLineGap) > (ascender - descender + lineGap)) {
+                                ascender = altAscender;
+                                descender = altDescender;
+                                lineGap = altLineGap;
+                            }
                         }
-                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP, &altLineGap)) {
-                            altLineGap = face.data()->height - (altAscender-altDescender);
+                    } else {
+                        hb_font_extents_t fontExtends;
+                        hb_font_get_extents_for_direction (font.data(), HB_DIRECTION_TTB, &fontExtends);
+                        qreal height = fontExtends.ascender - fontExtends.descender;
+                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_ASCENDER, &ascender)) {
+                            ascender = height*0.5;
                         }
-
-                        // Some fonts have sTypo metrics that are too small compared
-                        // to the HHEA values which make the default line height too
-                        // tight (e.g. Microsoft JhengHei, Source Han Sans), so we
-                        // compare them and take the ones that are larger.
-                        if (!os2Table || (altAscender - altDescender + altLineGap) > (ascender - descender + lineGap)) {
-                            ascender = altAscender;
-                            descender = altDescender;
-                            lineGap = altLineGap;
+                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_DESCENDER, &descender)) {
+                            descender = -(height*0.5);
+                        }
+                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_LINE_GAP, &lineGap)) {
+                            lineGap = 0;
                         }
                     }
-                } else {
-                    hb_font_extents_t fontExtends;
-                    hb_font_get_extents_for_direction (font.data(), HB_DIRECTION_TTB, &fontExtends);
-                    qreal height = fontExtends.ascender - fontExtends.descender;
-                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_ASCENDER, &ascender)) {
-                        ascender = height*0.5;
-                    }
-                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_DESCENDER, &descender)) {
-                        descender = -(height*0.5);
-                    }
-                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_LINE_GAP, &lineGap)) {
-                        lineGap = 0;
+
+                    for (int j = start; j < start + length; j++) {
+                        KoSvgTextShapingCache::FontMetrics &metrics = newShaped->metrics[j];
+                        metrics.ascender = ascender;
+                        metrics.descender = descender;
+                        metrics.lineGap = lineGap;
                     }
+
+                    start += length;
                 }
+            }
+            debugFlake << "text-length:" << text.size();
+        }
 
-                for (int j=start; j<start+length; j++) {
-                    result[j].fontAscent = ascender;
-                    result[j].fontDescent = descender;
-                    qreal leading = lineGap;
+        if (raqm_layout(layout.data())) {
+            debugFlake << "layout succeeded";
+        }
 
-                    if (!lineHeight.isNormal) {
-                        if (lineHeight.isNumber) {
-                            leading = (fontSize*scaleToPixel*ftFontUnit)*lineHeight.value;
-                            leading -= (ascender-descender);
-                        } else {
-                            QPointF val = ftTF.inverted().map(QPointF(lineHeight.value, lineHeight.value));
-                            leading = isHorizontal? val.x(): val.y();
-                            leading -= (ascender-descender);
-                        }
-                    }
-                    result[j].fontHalfLeading = leading * 0.5;
-                    result[j].fontStyle = style;
-                    result[j].fontWeight = properties.propertyOrDefault(KoSvgTextProperties::FontWeightId).toInt();
-                }
+        newShaped->layout = layout;
+        KoSvgTextShapingCache::instance()->insert(shapingKey, newShaped, text.size());
+        shaped = newShaped;
+    }
+
+    // the metrics of the fonts are cached, but the line height is applied every time
+    Q_FOREACH (const ShapingChunk &chunk, shapingChunks) {
+        for (int j = chunk.start; j < chunk.start + chunk.length; j++) {
+            const KoSvgTextShapingCache::FontMetrics &metrics = shaped->metrics.at(j);
 
-                start += length;
+            result[j].fontAscent = metrics.ascender;
+            result[j].fontDescent = metrics.descender;
+            qreal leading = metrics.lineGap;
+
+            if (!chunk.lineHeight.isNormal) {
+                if (chunk.lineHeight.isNumber) {
+                    leading = (chunk.fontSize*scaleToPixel*ftFontUnit)*chunk.lineHeight.value;
+                    leading -= (metrics.ascender-metrics.descender);
+                } else {
+                    QPointF val = ftTF.inverted().map(QPointF(chunk.lineHeight.value, chunk.lineHeight.value));
+                    leading = isHorizontal? val.x(): val.y();
+                    leading -= (metrics.ascender-metrics.descender);
+                }
             }
+            result[j].fontHalfLeading = leading * 0.5;
+            result[j].fontStyle = chunk.fontStyle;
+            result[j].fontWeight = chunk.fontWeight;
         }
-        debugFlake << "text-length:" << text.size();
     }
+
     // set very first character as anchored chunk.
     if (!result.empty()) {
         result[0].anchored_chunk = true;
     }
 
-    if (raqm_layout(layout.data())) {
-        debugFlake << "layout succeeded";
-    }
-
     // 2. Set flags and assign initial positions
     // We also retreive a glyph path here.
     size_t count = 0;
-    const raqm_glyph_t *glyphs = raqm_get_glyphs(layout.data(), &count);
+    const raqm_glyph_t *glyphs = raqm_get_glyphs(shaped->layout.data(), &count);
     if (!glyphs) {
         return;
     }
@@ -0,0 +1,62 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoSvgTextShapingCache.h"
+
+#include <QThreadStorage>
+
+namespace {
+/**
+ * The limit of the total length of the cached texts of a thread
+ */
+const int MaxCachedTextLength = 256 * 1024;
+}
+
+KoSvgTextShapingCache::KoSvgTextShapingCache()
+    : m_cache(MaxCachedTextLength)
+{
+}
+
+KoSvgTextShapingCache *KoSvgTextShapingCache::instance()
+{
+    static QThreadStorage<KoSvgTextShapingCache*> s_caches;
+
+    if (!s_caches.hasLocalData()) {
+        s_caches.setLocalData(new KoSvgTextShapingCache());
+    }
+
+    return s_caches.localData();
+}
+
+KoSvgTextShapingCache::ResultSP KoSvgTextShapingCache::find(const QByteArray &key) const
+{
+    ResultSP *result = m_cache.object(key);
+    if (!result) return ResultSP();
+
+    m_hits++;
+    return *result;
+}
+
+void KoSvgTextShapingCache::insert(const QByteArray &key, ResultSP result, int textLength)
+{
+    m_cache.insert(key, new ResultSP(result), qMax(1, textLength));
+}
+
+void KoSvgTextShapingCache::clear()
+{
+    m_cache.clear();
+    m_hits = 0;
+}
+
+int KoSvgTextShapingCache::size() const
+{
+    return m_cache.size();
+}
+
+int KoSvgTextShapingCache::hits() const
+{
+    return m_hits;
+}
@@ -0,0 +1,100 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOSVGTEXTSHAPINGCACHE_H
+#define KOSVGTEXTSHAPINGCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <raqm.h>
+
+#include "KoFontLibraryResourceUtils.h"
+#include "kritaflake_export.h"
+
+using raqm_t_up = KisLibraryResourcePointer<raqm_t, raqm_destroy>;
+
+/**
+ * A cache of the shaped text of KoSvgTextShape
+ *
+ * Shaping (font selection, loading of the faces and running HarfBuzz over the
+ * text) is the most expensive part of the text layout, but its result depends
+ * only on the text and a small subset of the text properties. So when the
+ * shape is laid out again after a change of any other property (fill, stroke,
+ * anchoring, inline-size, the shape to flow into, etc.) or after an undo, the
+ * shaped text is fetched from the cache and only the line layout is redone.
+ *
+ * The key of the cache is the serialized shaping input, see
+ * KoSvgTextShape::Private::relayout(). The cache is limited by the total
+ * length of the cached texts.
+ *
+ * FreeType faces cannot be shared between threads, so every thread has its
+ * own cache, see instance().
+ */
+class KRITAFLAKE_EXPORT KoSvgTextShapingCache
+{
+public:
+    /**
+     * The font metrics of a single character
+     */
+    struct FontMetrics {
+        int ascender = 0;
+        int descender = 0;
+        int lineGap = 0;
+    };
+
+    struct Result {
+        /// the library should outlive the faces referenced by the layout
+        FT_LibraryUP library;
+        raqm_t_up layout;
+        QVector<FontMetrics> metrics;
+    };
+
+    using ResultSP = QSharedPointer<const Result>;
+
+    /**
+     * @return the cache of the current thread
+     */
+    static KoSvgTextShapingCache *instance();
+
+    /**
+     * @return the cached result for \p key or a null pointer
+     */
+    ResultSP find(const QByteArray &key) const;
+
+    /**
+     * Adds \p result to the cache. The cost of the entry is the length
+     * of the text.
+     */
+    void insert(const QByteArray &key, ResultSP result, int textLength);
+
+    /**
+     * Drops all the entries and resets the hit counter
+     */
+    void clear();
+
+    /**
+     * @return the number of the cached entries
+     */
+    int size() const;
+
+    /**
+     * @return the number of the successful find() calls since the cache
+     * has been created or cleared
+     */
+    int hits() const;
+
+private:
+    KoSvgTextShapingCache();
+
+private:
+    QCache<QByteArray, ResultSP> m_cache;
+    mutable int m_hits = 0;
+};
+
+#endif // KOSVGTEXTSHAPINGCACHE_H
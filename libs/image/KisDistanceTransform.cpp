@@ -0,0 +1,143 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisDistanceTransform.h"
+
+#include <vector>
+
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+/**
+ * The buffers used by the 1D pass, they are allocated once per job
+ * to avoid allocations on every line
+ */
+struct LineScratch
+{
+    LineScratch(int size)
+        : f(size),
+          v(size),
+          z(size + 1)
+    {
+    }
+
+    std::vector<float> f;
+    std::vector<int> v;
+    std::vector<double> z;
+};
+
+void transformLineImpl(float *data, int size, int stride, float weight, LineScratch &s)
+{
+    float *f = s.f.data();
+    int *v = s.v.data();
+    double *z = s.z.data();
+
+    for (int q = 0; q < size; q++) {
+        f[q] = data[q * stride];
+    }
+
+    /**
+     * The samples at infinity cannot be the nearest ones, so they
+     * are not added to the lower envelope at all. It also avoids
+     * calculating the intersections of infinite parabolas.
+     */
+    int k = -1;
+
+    for (int q = 0; q < size; q++) {
+        if (f[q] == KisDistanceTransform::Infinity) continue;
+
+        const double fq = f[q] + double(weight) * q * q;
+        double intersection = -std::numeric_limits<double>::infinity();
+
+        while (k >= 0) {
+            const int p = v[k];
+            intersection = (fq - (f[p] + double(weight) * p * p)) / (2.0 * weight * (q - p));
+
+            if (intersection > z[k]) break;
+            k--;
+        }
+
+        if (k < 0) {
+            intersection = -std::numeric_limits<double>::infinity();
+        }
+
+        k++;
+        v[k] = q;
+        z[k] = intersection;
+    }
+
+    if (k < 0) {
+        for (int q = 0; q < size; q++) {
+            data[q * stride] = KisDistanceTransform::Infinity;
+        }
+        return;
+    }
+
+    z[k + 1] = std::numeric_limits<double>::infinity();
+
+    int j = 0;
+    for (int q = 0; q < size; q++) {
+        while (z[j + 1] < q) {
+            j++;
+        }
+
+        const int dq = q - v[j];
+        data[q * stride] = weight * dq * dq + f[v[j]];
+    }
+}
+
+void transformLines(float *data, int numLines, int lineSize,
+                    int lineStride, int sampleStride, float weight)
+{
+    const int linesPerJob = 64;
+
+    QVector<int> jobs;
+    for (int i = 0; i < numLines; i += linesPerJob) {
+        jobs << i;
+    }
+
+    QtConcurrent::blockingMap(jobs,
+        [&] (int firstLine) {
+            LineScratch scratch(lineSize);
+
+            const int lastLine = qMin(firstLine + linesPerJob, numLines);
+            for (int i = firstLine; i < lastLine; i++) {
+                transformLineImpl(data + size_t(i) * lineStride, lineSize,
+                                  sampleStride, weight, scratch);
+            }
+        });
+}
+
+}
+
+void KisDistanceTransform::transform(float *data, int width, int height,
+                                     float xWeight, float yWeight)
+{
+    if (width <= 0 || height <= 0) return;
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(xWeight > 0.0f && yWeight > 0.0f);
+
+    // columns
+    transformLines(data, width, height, 1, width, yWeight);
+
+    // rows
+    transformLines(data, height, width, width, 1, xWeight);
+}
+
+void KisDistanceTransform::transformLine(float *data, int size, int stride, float weight)
+{
+    if (size <= 0) return;
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(weight > 0.0f);
+
+    LineScratch scratch(size);
+    transformLineImpl(data, size, stride, weight, scratch);
+}
@@ -0,0 +1,59 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISDISTANCETRANSFORM_H
+#define KISDISTANCETRANSFORM_H
+
+#include <limits>
+
+#include <QtGlobal>
+
+#include "kritaimage_export.h"
+
+/**
+ * An exact Euclidean distance transform based on the algorithm described
+ * by Felzenszwalb and Huttenlocher in "Distance Transforms of Sampled
+ * Functions" (Theory of Computing, 2012).
+ *
+ * The transform is separable: every column is transformed first and then
+ * every row, each 1D pass computes the lower envelope of the parabolas
+ * rooted at the samples in linear time. Therefore the cost per pixel does
+ * not depend on the distances involved. The columns and the rows are
+ * processed in parallel.
+ */
+class KRITAIMAGE_EXPORT KisDistanceTransform
+{
+public:
+    /**
+     * The value of the samples that are not feature points
+     */
+    static constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+    /**
+     * Transforms \p data in-place. On input every element contains the cost
+     * of the sample: 0 for the feature points and Infinity for the rest (any
+     * other non-negative values are also allowed). On output every element
+     * contains the weighted squared distance to the nearest feature point:
+     *
+     *     D(x, y) = min(xWeight * (x - i)^2 + yWeight * (y - j)^2 + f(i, j))
+     *
+     * The weights make it possible to measure the distance in an elliptic
+     * metric, e.g. with xWeight = 1 / rx^2 and yWeight = 1 / ry^2 all the
+     * points inside the ellipse with the radii (rx, ry) will have D <= 1.
+     *
+     * The data is stored row by row with the stride equal to \p width.
+     */
+    static void transform(float *data, int width, int height,
+                          float xWeight = 1.0f, float yWeight = 1.0f);
+
+    /**
+     * Transforms a single line of \p size samples located \p stride
+     * elements apart.
+     */
+    static void transformLine(float *data, int size, int stride, float weight);
+};
+
+#endif // KISDISTANCETRANSFORM_H
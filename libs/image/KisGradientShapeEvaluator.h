@@ -0,0 +1,227 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISGRADIENTSHAPEEVALUATOR_H
+#define KISGRADIENTSHAPEEVALUATOR_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "KisGradientShapeEvaluatorBase.h"
+
+/**
+ * The math operations used by the shape kernels on a single double.
+ * The vector version of it is defined in the per-arch build of
+ * KisGradientShapeEvaluatorFactory, so the kernels are written once
+ * for both of them.
+ */
+struct KisGradientShapeScalarMath
+{
+    using value_type = double;
+    static constexpr int size = 1;
+
+    static inline value_type sequence() {
+        return 0.0;
+    }
+
+    static inline void store(value_type value, double *ptr) {
+        *ptr = value;
+    }
+
+    static inline value_type sqrt(value_type value) {
+        return std::sqrt(value);
+    }
+
+    static inline value_type atan2(value_type y, value_type x) {
+        return std::atan2(y, x);
+    }
+
+    static inline value_type abs(value_type value) {
+        return std::fabs(value);
+    }
+
+    static inline value_type max(value_type a, value_type b) {
+        return std::max(a, b);
+    }
+
+    static inline value_type select(bool condition, value_type a, value_type b) {
+        return condition ? a : b;
+    }
+};
+
+namespace KisGradientShapeKernels {
+
+/**
+ * The angle of the point (px, py) from 0 to 2 PI,
+ * counted from the gradient vector
+ */
+template<class Math>
+inline typename Math::value_type vectorAngle(const KisGradientShapeParams &p,
+                                             typename Math::value_type px,
+                                             typename Math::value_type py)
+{
+    using T = typename Math::value_type;
+
+    const T angle = Math::atan2(py, px) + T(M_PI - p.vectorAngle);
+    return Math::select(angle < T(0), angle + T(2 * M_PI), angle);
+}
+
+template<class Math>
+struct Linear {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        // Project the vector onto the normalised gradient vector and
+        // scale to 0 to 1 over the gradient vector length
+        return (px * T(p.normalisedVectorX) + py * T(p.normalisedVectorY)) * T(p.invVectorLength);
+    }
+};
+
+template<class Math>
+struct BiLinear {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        return Math::abs(Linear<Math>::value(p, px, py));
+    }
+};
+
+template<class Math>
+struct Radial {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        return Math::sqrt(px * px + py * py) * T(p.invVectorLength);
+    }
+};
+
+template<class Math>
+struct Square {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        const T nx(p.normalisedVectorX);
+        const T ny(p.normalisedVectorY);
+
+        // the distances to the gradient vector and to its perpendicular
+        const T distance1 = Math::abs(nx * py - ny * px);
+        const T distance2 = Math::abs(ny * py + nx * px);
+
+        return Math::max(distance1, distance2) * T(p.invVectorLength);
+    }
+};
+
+template<class Math>
+struct Conical {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        return vectorAngle<Math>(p, px, py) * T(1.0 / (2 * M_PI));
+    }
+};
+
+template<class Math>
+struct ConicalSymetric {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        const T t = vectorAngle<Math>(p, px, py) * T(1.0 / M_PI);
+        return Math::select(t < T(1), t, T(2) - t);
+    }
+};
+
+template<class Math>
+struct Spiral {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        return Radial<Math>::value(p, px, py) + Conical<Math>::value(p, px, py);
+    }
+};
+
+template<class Math>
+struct ReverseSpiral {
+    using T = typename Math::value_type;
+
+    static inline T value(const KisGradientShapeParams &p, T px, T py) {
+        //Reverse direction of spiral gradient
+        return Radial<Math>::value(p, px, py) + T(1) - Conical<Math>::value(p, px, py);
+    }
+};
+
+}
+
+template<class Math>
+class KisGradientShapeEvaluator : public KisGradientShapeEvaluatorBase
+{
+public:
+    KisGradientShapeEvaluator(const KisGradientShapeParams &params)
+        : m_params(params)
+    {
+    }
+
+    void valuesAt(double x, double y, int numPixels, double *values) const override
+    {
+        using namespace KisGradientShapeKernels;
+
+        switch (m_params.shape) {
+        case KisGradientShapeParams::Linear:
+            evaluate<Linear>(x, y, numPixels, values);
+            break;
+        case KisGradientShapeParams::BiLinear:
+            evaluate<BiLinear>(x, y, numPixels, values);
+            break;
+        case KisGradientShapeParams::Radial:
+            evaluate<Radial>(x, y, numPixels, values);
+            break;
+        case KisGradientShapeParams::Square:
+            evaluate<Square>(x, y, numPixels, values);
+            break;
+        case KisGradientShapeParams::Conical:
+            evaluate<Conical>(x, y, numPixels, values);
+            break;
+        case KisGradientShapeParams::ConicalSymetric:
+            evaluate<ConicalSymetric>(x, y, numPixels, values);
+            break;
+        case KisGradientShapeParams::Spiral:
+            evaluate<Spiral>(x, y, numPixels, values);
+            break;
+        case KisGradientShapeParams::ReverseSpiral:
+            evaluate<ReverseSpiral>(x, y, numPixels, values);
+            break;
+        }
+    }
+
+private:
+    template<template<class> class Kernel>
+    void evaluate(double x, double y, int numPixels, double *values) const
+    {
+        using T = typename Math::value_type;
+
+        const double px0 = x - m_params.startX;
+        const double py0 = y - m_params.startY;
+
+        const T py(py0);
+        const T increment(double(Math::size));
+        T px = Math::sequence() + T(px0);
+
+        int i = 0;
+
+        for (; i + Math::size <= numPixels; i += Math::size) {
+            Math::store(Kernel<Math>::value(m_params, px, py), values + i);
+            px = px + increment;
+        }
+
+        for (; i < numPixels; i++) {
+            values[i] = Kernel<KisGradientShapeScalarMath>::value(m_params, px0 + i, py0);
+        }
+    }
+
+private:
+    const KisGradientShapeParams m_params;
+};
+
+#endif // KISGRADIENTSHAPEEVALUATOR_H
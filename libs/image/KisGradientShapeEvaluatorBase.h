@@ -0,0 +1,92 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISGRADIENTSHAPEEVALUATORBASE_H
+#define KISGRADIENTSHAPEEVALUATORBASE_H
+
+#include <cfloat>
+#include <cmath>
+
+#include <QPointF>
+#include <QtMath>
+
+/**
+ * The parameters of an analytic gradient shape, precomputed from
+ * the gradient vector
+ */
+struct KisGradientShapeParams
+{
+    enum Shape {
+        Linear,
+        BiLinear,
+        Radial,
+        Square,
+        Conical,
+        ConicalSymetric,
+        Spiral,
+        ReverseSpiral
+    };
+
+    KisGradientShapeParams(Shape _shape, const QPointF &gradientVectorStart, const QPointF &gradientVectorEnd)
+        : shape(_shape)
+        , startX(gradientVectorStart.x())
+        , startY(gradientVectorStart.y())
+    {
+        const double dx = gradientVectorEnd.x() - gradientVectorStart.x();
+        const double dy = gradientVectorEnd.y() - gradientVectorStart.y();
+
+        const double vectorLength = std::sqrt(dx * dx + dy * dy);
+
+        if (vectorLength < DBL_EPSILON) {
+            normalisedVectorX = 0;
+            normalisedVectorY = 0;
+            invVectorLength = 0;
+        } else {
+            normalisedVectorX = dx / vectorLength;
+            normalisedVectorY = dy / vectorLength;
+            invVectorLength = 1.0 / vectorLength;
+        }
+
+        // Get angle from 0 to 2 PI.
+        vectorAngle = std::atan2(dy, dx) + M_PI;
+    }
+
+    Shape shape;
+
+    double startX;
+    double startY;
+
+    double normalisedVectorX;
+    double normalisedVectorY;
+
+    /**
+     * The inverted length of the gradient vector, it is also the inverted
+     * radius of the radial and spiral shapes. It is zero for a degenerated
+     * vector, which makes all the length-based shapes evaluate to zero.
+     */
+    double invVectorLength;
+
+    double vectorAngle;
+};
+
+/**
+ * Evaluates an analytic gradient shape for a whole row of pixels at once.
+ * The implementations are built for every supported architecture, see
+ * KisGradientShapeEvaluatorFactory.
+ */
+class KisGradientShapeEvaluatorBase
+{
+public:
+    virtual ~KisGradientShapeEvaluatorBase() = default;
+
+    /**
+     * Writes the values of the shape at the points (x + i, y),
+     * 0 <= i < numPixels, into \p values
+     */
+    virtual void valuesAt(double x, double y, int numPixels, double *values) const = 0;
+};
+
+#endif // KISGRADIENTSHAPEEVALUATORBASE_H
@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisGradientShapeEvaluatorFactory.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+
+#include "KisGradientShapeEvaluator.h"
+
+namespace {
+
+template<typename _impl>
+struct VectorMath
+{
+    using value_type = xsimd::batch<double, _impl>;
+    static constexpr int size = int(value_type::size);
+
+    static inline value_type sequence() {
+        return xsimd::detail::make_sequence_as_batch<value_type>();
+    }
+
+    static inline void store(value_type value, double *ptr) {
+        value.store_unaligned(ptr);
+    }
+
+    static inline value_type sqrt(value_type value) {
+        return xsimd::sqrt(value);
+    }
+
+    static inline value_type atan2(value_type y, value_type x) {
+        return xsimd::atan2(y, x);
+    }
+
+    static inline value_type abs(value_type value) {
+        return xsimd::abs(value);
+    }
+
+    static inline value_type max(value_type a, value_type b) {
+        return xsimd::max(a, b);
+    }
+
+    static inline value_type select(typename value_type::batch_bool_type condition,
+                                    value_type a, value_type b) {
+        return xsimd::select(condition, a, b);
+    }
+};
+
+}
+
+template<>
+KisGradientShapeEvaluatorBase *
+KisGradientShapeEvaluatorFactory::create<xsimd::current_arch>(const KisGradientShapeParams &params)
+{
+#if XSIMD_WITH_NEON && !XSIMD_WITH_NEON64
+    // 32-bit NEON has no double precision vectors
+    return new KisGradientShapeEvaluator<KisGradientShapeScalarMath>(params);
+#else
+    return new KisGradientShapeEvaluator<VectorMath<xsimd::current_arch>>(params);
+#endif
+}
+
+#endif /* XSIMD_UNIVERSAL_BUILD_PASS */
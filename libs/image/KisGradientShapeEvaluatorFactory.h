@@ -0,0 +1,19 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISGRADIENTSHAPEEVALUATORFACTORY_H
+#define KISGRADIENTSHAPEEVALUATORFACTORY_H
+
+#include <KoMultiArchBuildSupport.h>
+
+#include "KisGradientShapeEvaluatorBase.h"
+
+struct KisGradientShapeEvaluatorFactory {
+    template<typename _impl>
+    static KisGradientShapeEvaluatorBase *create(const KisGradientShapeParams &params);
+};
+
+#endif // KISGRADIENTSHAPEEVALUATORFACTORY_H
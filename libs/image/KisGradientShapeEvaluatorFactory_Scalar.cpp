@@ -0,0 +1,16 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisGradientShapeEvaluatorFactory.h"
+
+#include "KisGradientShapeEvaluator.h"
+
+template<>
+KisGradientShapeEvaluatorBase *
+KisGradientShapeEvaluatorFactory::create<xsimd::generic>(const KisGradientShapeParams &params)
+{
+    return new KisGradientShapeEvaluator<KisGradientShapeScalarMath>(params);
+}
@@ -0,0 +1,380 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisHistogramIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtMath>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+
+#include "kis_paint_device.h"
+#include "kis_datamanager.h"
+#include "kis_default_bounds_base.h"
+#include "kis_algebra_2d.h"
+#include "kis_assert.h"
+#include "tiles3/KisTileRevisionTracker.h"
+
+
+namespace {
+
+const int TileSize = 64;
+const int NumBins = 256;
+
+/**
+ * The images bigger than this are sampled sparsely
+ */
+const int SampledAreaLog2 = 20;
+
+/**
+ * The bins of a single tile. A tile has 4096 pixels, so the counters
+ * always fit into 16 bits.
+ */
+using TileBins = std::vector<quint16>;
+
+inline quint64 tileKey(qint32 col, qint32 row)
+{
+    return (quint64(quint32(col)) << 32) | quint32(row);
+}
+
+/**
+ * @return the first sampled coordinate not less than \p pos on the grid
+ * starting at \p origin, \p pos should not be less than \p origin
+ */
+inline int firstSample(int pos, int origin, int step)
+{
+    return origin + (pos - origin + step - 1) / step * step;
+}
+
+inline int numSamples(int first, int last, int origin, int step)
+{
+    const int start = firstSample(first, origin, step);
+    return start > last ? 0 : (last - start) / step + 1;
+}
+
+}
+
+struct KisHistogramIndex::Private
+{
+    mutable QMutex mutex;
+
+    KisTileRevisionTracker revisions;
+    KisTileRevisionTracker pendingRevisions;
+    int pendingTiles = 0;
+    QHash<quint64, TileBins> tileBins;
+
+    std::vector<quint64> bins;
+    quint64 pixelCount = 0;
+    int lastUpdatedTiles = 0;
+
+    QRect imageBounds;
+    QPoint offset;
+    int sampleStep = 1;
+    const KoColorSpace *colorSpace = nullptr;
+    QByteArray defaultPixel;
+    std::vector<int> defaultPixelBins;
+
+    bool needsRebuild(KisPaintDeviceSP device) const;
+    void reset(KisPaintDeviceSP device);
+    quint64 samplesInRect(const QRect &rc) const;
+    void binTile(KisPaintDeviceSP device, const QRect &rc, TileBins &tileBins) const;
+    void replaceTileBins(quint64 key, const QRect &rc, bool tileExists, TileBins &newBins);
+    void completeTiles(int numTiles);
+};
+
+KisHistogramIndex::KisHistogramIndex()
+    : m_d(new Private)
+{
+}
+
+KisHistogramIndex::~KisHistogramIndex()
+{
+}
+
+bool KisHistogramIndex::Private::needsRebuild(KisPaintDeviceSP device) const
+{
+    const KoColor devicePixel = device->defaultPixel();
+
+    return !colorSpace ||
+        imageBounds != device->defaultBounds()->bounds() ||
+        offset != QPoint(device->x(), device->y()) ||
+        !(*colorSpace == *device->colorSpace()) ||
+        defaultPixel != QByteArray(reinterpret_cast<const char*>(devicePixel.data()), devicePixel.colorSpace()->pixelSize());
+}
+
+void KisHistogramIndex::Private::reset(KisPaintDeviceSP device)
+{
+    imageBounds = device->defaultBounds()->bounds();
+    offset = QPoint(device->x(), device->y());
+    colorSpace = device->colorSpace();
+
+    const KoColor devicePixel = device->defaultPixel();
+    defaultPixel = QByteArray(reinterpret_cast<const char*>(devicePixel.data()), devicePixel.colorSpace()->pixelSize());
+
+    /**
+     * Count about a million of pixels, like the histogram docker used to
+     * do, but sample them on a grid instead of skipping the pixels in the
+     * scanline order, so that every tile is sampled independently
+     */
+    const qint64 imageArea = qint64(imageBounds.width()) * imageBounds.height();
+    sampleStep = qMax(1, qCeil(std::sqrt(1.0 + double(imageArea >> SampledAreaLog2))));
+
+    const int numChannels = int(colorSpace->channelCount());
+
+    defaultPixelBins.resize(numChannels);
+    for (int chan = 0; chan < numChannels; chan++) {
+        defaultPixelBins[chan] = colorSpace->scaleToU8(reinterpret_cast<const quint8*>(defaultPixel.constData()), chan);
+    }
+
+    revisions.clear();
+    tileBins.clear();
+
+    // until the tiles are binned, the whole image is filled with the default pixel
+    pixelCount = samplesInRect(imageBounds);
+
+    bins.assign(size_t(numChannels) * NumBins, 0);
+    for (int chan = 0; chan < numChannels; chan++) {
+        bins[chan * NumBins + defaultPixelBins[chan]] = pixelCount;
+    }
+}
+
+quint64 KisHistogramIndex::Private::samplesInRect(const QRect &rect) const
+{
+    const QRect rc = rect & imageBounds;
+    if (rc.isEmpty()) return 0;
+
+    return quint64(numSamples(rc.left(), rc.right(), imageBounds.left(), sampleStep)) *
+        quint64(numSamples(rc.top(), rc.bottom(), imageBounds.top(), sampleStep));
+}
+
+void KisHistogramIndex::Private::binTile(KisPaintDeviceSP device, const QRect &rc, TileBins &result) const
+{
+    const KoColorSpace *cs = device->colorSpace();
+    const int channelCount = int(cs->channelCount());
+    const int pixelSize = int(cs->pixelSize());
+
+    result.assign(size_t(channelCount) * NumBins, 0);
+
+    std::vector<quint8> buffer(size_t(rc.width()) * rc.height() * pixelSize);
+    device->readBytes(buffer.data(), rc);
+
+    const int firstX = firstSample(rc.left(), imageBounds.left(), sampleStep);
+    const int firstY = firstSample(rc.top(), imageBounds.top(), sampleStep);
+
+    for (int y = firstY; y <= rc.bottom(); y += sampleStep) {
+        const quint8 *row = buffer.data() + size_t(y - rc.top()) * rc.width() * pixelSize;
+
+        for (int x = firstX; x <= rc.right(); x += sampleStep) {
+            const quint8 *pixel = row + (x - rc.left()) * pixelSize;
+
+            for (int chan = 0; chan < channelCount; chan++) {
+                result[chan * NumBins + cs->scaleToU8(pixel, chan)]++;
+            }
+        }
+    }
+}
+
+void KisHistogramIndex::Private::replaceTileBins(quint64 key, const QRect &rc, bool tileExists, TileBins &newBins)
+{
+    const int numChannels = int(defaultPixelBins.size());
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(bins.size() == size_t(numChannels) * NumBins);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!tileExists || newBins.size() == bins.size());
+
+    /**
+     * The bins are unsigned, but the total never goes below zero after
+     * both the subtraction and the addition, so wrapping around in the
+     * middle is harmless
+     */
+    auto it = tileBins.find(key);
+    if (it != tileBins.end()) {
+        for (size_t i = 0; i < bins.size(); i++) {
+            bins[i] -= it.value()[i];
+        }
+    } else {
+        const quint64 samples = samplesInRect(rc);
+        for (int chan = 0; chan < numChannels; chan++) {
+            bins[chan * NumBins + defaultPixelBins[chan]] -= samples;
+        }
+    }
+
+    if (tileExists) {
+        for (size_t i = 0; i < bins.size(); i++) {
+            bins[i] += newBins[i];
+        }
+
+        if (it != tileBins.end()) {
+            it.value().swap(newBins);
+        } else {
+            tileBins.insert(key, std::move(newBins));
+        }
+    } else {
+        const quint64 samples = samplesInRect(rc);
+        for (int chan = 0; chan < numChannels; chan++) {
+            bins[chan * NumBins + defaultPixelBins[chan]] += samples;
+        }
+
+        if (it != tileBins.end()) {
+            tileBins.erase(it);
+        }
+    }
+}
+
+void KisHistogramIndex::Private::completeTiles(int numTiles)
+{
+    pendingTiles -= numTiles;
+    KIS_SAFE_ASSERT_RECOVER_NOOP(pendingTiles >= 0);
+
+    if (pendingTiles <= 0) {
+        revisions = pendingRevisions;
+    }
+}
+
+QVector<QRect> KisHistogramIndex::beginUpdate(KisPaintDeviceSP device)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (m_d->needsRebuild(device)) {
+        m_d->reset(device);
+    }
+
+    QVector<QRect> rects;
+
+    /**
+     * The new revisions are committed only when all the returned tiles
+     * have been binned. The update may be interrupted, e.g. when the
+     * idle stroke running it is cancelled, then the next update will
+     * report the same tiles again.
+     */
+    m_d->pendingRevisions = m_d->revisions;
+
+    if (!m_d->imageBounds.isEmpty()) {
+        rects = m_d->pendingRevisions.update(device->dataManager(), m_d->imageBounds.translated(-m_d->offset));
+
+        for (QRect &rc : rects) {
+            rc.translate(m_d->offset);
+        }
+    }
+
+    m_d->lastUpdatedTiles = rects.size();
+    m_d->pendingTiles = rects.size();
+    m_d->completeTiles(0);
+
+    return rects;
+}
+
+void KisHistogramIndex::updateTiles(KisPaintDeviceSP device, const QVector<QRect> &tileRects)
+{
+    KisDataManagerSP dm = device->dataManager();
+
+    QRect imageBounds;
+    QPoint offset;
+    {
+        QMutexLocker l(&m_d->mutex);
+        KIS_SAFE_ASSERT_RECOVER_RETURN(m_d->colorSpace);
+        KIS_SAFE_ASSERT_RECOVER_RETURN(*m_d->colorSpace == *device->colorSpace());
+
+        imageBounds = m_d->imageBounds;
+        offset = m_d->offset;
+    }
+
+    TileBins newBins;
+
+    for (const QRect &tileRect : tileRects) {
+        const QRect rc = tileRect & imageBounds;
+
+        using KisAlgebra2D::divideFloor;
+        const qint32 col = divideFloor(tileRect.x() - offset.x(), TileSize);
+        const qint32 row = divideFloor(tileRect.y() - offset.y(), TileSize);
+
+        bool tileExists = false;
+
+        if (!rc.isEmpty()) {
+            dm->getReadOnlyTileLazy(col, row, tileExists);
+
+            if (tileExists) {
+                // the bins are computed without the lock, the parameters
+                // used by binTile() don't change during the update
+                m_d->binTile(device, rc, newBins);
+            }
+        }
+
+        QMutexLocker l(&m_d->mutex);
+
+        if (!rc.isEmpty()) {
+            m_d->replaceTileBins(tileKey(col, row), rc, tileExists, newBins);
+        }
+        m_d->completeTiles(1);
+    }
+}
+
+void KisHistogramIndex::update(KisPaintDeviceSP device)
+{
+    updateTiles(device, beginUpdate(device));
+}
+
+void KisHistogramIndex::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->revisions.clear();
+    m_d->pendingRevisions.clear();
+    m_d->pendingTiles = 0;
+    m_d->tileBins.clear();
+    m_d->bins.clear();
+    m_d->pixelCount = 0;
+    m_d->lastUpdatedTiles = 0;
+    m_d->colorSpace = nullptr;
+}
+
+bool KisHistogramIndex::isValid() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->colorSpace != nullptr;
+}
+
+const KoColorSpace* KisHistogramIndex::colorSpace() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->colorSpace;
+}
+
+KisHistogramIndex::Bins KisHistogramIndex::bins() const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    const int numChannels = int(m_d->bins.size() / NumBins);
+
+    Bins result(numChannels);
+    for (int chan = 0; chan < numChannels; chan++) {
+        auto begin = m_d->bins.begin() + chan * NumBins;
+        result[chan].reserve(NumBins);
+        std::transform(begin, begin + NumBins, std::back_inserter(result[chan]),
+                       [] (quint64 value) { return quint32(qMin(value, quint64(std::numeric_limits<quint32>::max()))); });
+    }
+
+    return result;
+}
+
+quint64 KisHistogramIndex::pixelCount() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->pixelCount;
+}
+
+int KisHistogramIndex::lastUpdatedTiles() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->lastUpdatedTiles;
+}
@@ -0,0 +1,127 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISHISTOGRAMINDEX_H
+#define KISHISTOGRAMINDEX_H
+
+#include <vector>
+
+#include <QScopedPointer>
+#include <QVector>
+#include <QRect>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class KoColorSpace;
+
+/**
+ * An incrementally updated per-channel histogram of a paint device.
+ *
+ * Every channel has 256 bins, the channel values are scaled into them with
+ * KoColorSpace::scaleToU8(). Only the pixels inside the bounds of the image
+ * the device belongs to are counted. For the images bigger than a megapixel
+ * the pixels are sampled on a regular grid, so that about a million of
+ * them is counted, see pixelCount().
+ *
+ * The index stores the bins of every tile of the device separately and
+ * remembers the revisions of the tiles (see KisTileRevisionTracker). On
+ * update only the tiles written into since the previous update are binned
+ * again, their old bins are subtracted from the total and the new ones are
+ * added. The tiles that don't exist in the device are accounted for with
+ * the default pixel and take no memory.
+ *
+ * The update is split into three steps, so that the tiles could be binned
+ * by several stroke jobs in parallel:
+ *
+ * \code
+ * const QVector<QRect> rects = index->beginUpdate(device);
+ * // in any number of concurrent jobs
+ * index->updateTiles(device, someOfTheRects);
+ * // after all the jobs have completed
+ * KisHistogramIndex::Bins bins = index->bins();
+ * \endcode
+ *
+ * The revisions of the tiles are remembered only when all the rects
+ * returned by beginUpdate() have been passed to updateTiles(). If the
+ * update is abandoned halfway, the next beginUpdate() returns the same
+ * tiles again.
+ *
+ * Every paint device owns its own index, see
+ * KisPaintDevice::histogramIndex(), so all the users of the histogram of
+ * the projection share it.
+ *
+ * All the methods are thread-safe, but the device should not be modified
+ * while the update is in progress, e.g. it should be done in an idle task
+ * stroke.
+ */
+class KRITAIMAGE_EXPORT KisHistogramIndex
+{
+public:
+    using Bins = std::vector<std::vector<quint32>>;
+
+    KisHistogramIndex();
+    ~KisHistogramIndex();
+
+    /**
+     * Starts updating the bins from \p device. The bins are reset when the
+     * bounds, the offset, the color space or the default pixel of the
+     * device have changed.
+     *
+     * @return the rects of the tiles that should be passed to
+     * updateTiles() to bring the bins in sync with the device
+     */
+    QVector<QRect> beginUpdate(KisPaintDeviceSP device);
+
+    /**
+     * Bins \p tileRects of \p device, the rects should be the ones returned
+     * by the last beginUpdate(). Can be called from several threads at once
+     * for different rects.
+     */
+    void updateTiles(KisPaintDeviceSP device, const QVector<QRect> &tileRects);
+
+    /**
+     * Brings the bins in sync with \p device in the calling thread
+     */
+    void update(KisPaintDeviceSP device);
+
+    /**
+     * Drops the bins and the remembered tile revisions
+     */
+    void clear();
+
+    /**
+     * @return true if the index has been updated at least once
+     */
+    bool isValid() const;
+
+    /**
+     * @return the color space of the device the bins have been computed for
+     */
+    const KoColorSpace* colorSpace() const;
+
+    /**
+     * @return the bins of every channel of the color space, in the order
+     * of KoColorSpace::channels()
+     */
+    Bins bins() const;
+
+    /**
+     * @return the number of pixels counted in the bins of every channel
+     */
+    quint64 pixelCount() const;
+
+    /**
+     * @return the number of tiles returned by the last call to beginUpdate()
+     */
+    int lastUpdatedTiles() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISHISTOGRAMINDEX_H
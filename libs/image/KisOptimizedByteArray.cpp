@@ -13,6 +13,11 @@
 
 namespace {
 
+/**
+ * The number of chunks PooledMemoryAllocator keeps regardless of their size
+ */
+const int minimalPoolSize = 4;
+
 /*****************************************************************/
 /*         DefaultMemoryAllocator                                */
 /*****************************************************************/
@@ -83,11 +88,26 @@ KisOptimizedByteArray::PooledMemoryAllocator::alloc(int size)
 
     {
         QMutexLocker l(&m_mutex);
-        if (!m_chunks.isEmpty()) {
+
+        // prefer the most recently freed chunk that can hold the data,
+        // otherwise reuse the last one to avoid growing the pool
+        for (int i = m_chunks.size() - 1; i >= 0; i--) {
+            if (m_chunks[i].second >= size) {
+                chunk = m_chunks.takeAt(i);
+                break;
+            }
+        }
+
+        if (!chunk.first && !m_chunks.isEmpty()) {
             chunk = m_chunks.takeLast();
         }
 
         m_meanSize(size);
+
+        m_statistics.numAllocations++;
+        if (chunk.second < size) {
+            m_statistics.numSystemAllocations++;
+        }
     }
 
     if (chunk.second < size) {
@@ -108,8 +128,11 @@ void KisOptimizedByteArray::PooledMemoryAllocator::free(KisOptimizedByteArray::M
         QMutexLocker l(&m_mutex);
 
         // keep bigger chunks for ourselves and return the
-        // smaller ones to the system
-        if (chunk.second > 0.8 * m_meanSize.rollingMean()) {
+        // smaller ones to the system; a few small chunks are
+        // still kept, since dabs of a stroke share the pool with
+        // the (smaller) masks and selections
+        if (chunk.second > 0.8 * m_meanSize.rollingMean() ||
+            m_chunks.size() < minimalPoolSize) {
             m_chunks.append(chunk);
         } else {
             delete[] chunk.first;
@@ -117,6 +140,19 @@ void KisOptimizedByteArray::PooledMemoryAllocator::free(KisOptimizedByteArray::M
     }
 }
 
+KisOptimizedByteArray::PooledMemoryAllocator::Statistics
+KisOptimizedByteArray::PooledMemoryAllocator::statistics() const
+{
+    QMutexLocker l(&m_mutex);
+    return m_statistics;
+}
+
+void KisOptimizedByteArray::PooledMemoryAllocator::resetStatistics()
+{
+    QMutexLocker l(&m_mutex);
+    m_statistics = Statistics();
+}
+
 
 /*****************************************************************/
 /*         KisOptimizedByteArray::Private                        */
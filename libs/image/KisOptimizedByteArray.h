@@ -32,18 +32,34 @@ public:
     typedef QSharedPointer<MemoryAllocator> MemoryAllocatorSP;
 
     struct KRITAIMAGE_EXPORT PooledMemoryAllocator : public MemoryAllocator {
+        /**
+         * The number of chunks requested from the allocator and the
+         * number of them that could not be served from the pool and
+         * caused a real allocation in the system heap
+         */
+        struct Statistics {
+            int numAllocations = 0;
+            int numSystemAllocations = 0;
+        };
+
         PooledMemoryAllocator();
         ~PooledMemoryAllocator();
 
         MemoryChunk alloc(int size) override;
         void free(MemoryChunk chunk) override;
 
+        Statistics statistics() const;
+        void resetStatistics();
+
     private:
-        QMutex m_mutex;
+        mutable QMutex m_mutex;
         QVector<MemoryChunk> m_chunks;
         KisRollingMeanAccumulatorWrapper m_meanSize;
+        Statistics m_statistics;
     };
 
+    typedef QSharedPointer<PooledMemoryAllocator> PooledMemoryAllocatorSP;
+
 public:
     KisOptimizedByteArray(MemoryAllocatorSP allocator = MemoryAllocatorSP());
     KisOptimizedByteArray(const KisOptimizedByteArray &rhs);
@@ -0,0 +1,316 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSlidingWindowHistogram.h"
+
+#include <vector>
+
+#include <QtConcurrentMap>
+
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include "kis_assert.h"
+#include "kis_paint_device.h"
+#include "kis_algebra_2d.h"
+#include "krita_utils.h"
+
+
+namespace {
+
+inline void addHistogram(quint32 *dstCounts, float *dstSums,
+                         const quint32 *srcCounts, const float *srcSums,
+                         int numBins, int numAccumulators)
+{
+    for (int i = 0; i < numBins; i++) {
+        dstCounts[i] += srcCounts[i];
+    }
+
+    const int numSums = numBins * numAccumulators;
+    for (int i = 0; i < numSums; i++) {
+        dstSums[i] += srcSums[i];
+    }
+}
+
+inline void subtractHistogram(quint32 *dstCounts, float *dstSums,
+                              const quint32 *srcCounts, const float *srcSums,
+                              int numBins, int numAccumulators)
+{
+    for (int i = 0; i < numBins; i++) {
+        dstCounts[i] -= srcCounts[i];
+    }
+
+    const int numSums = numBins * numAccumulators;
+    for (int i = 0; i < numSums; i++) {
+        dstSums[i] -= srcSums[i];
+    }
+}
+
+}
+
+KisSlidingWindowHistogram::KisSlidingWindowHistogram(int numBins, int numAccumulators)
+    : m_numBins(numBins),
+      m_numAccumulators(numAccumulators),
+      m_patchSize(256, 256)
+{
+    KIS_ASSERT(numBins > 0);
+    KIS_ASSERT(numAccumulators >= 0);
+}
+
+int KisSlidingWindowHistogram::numBins() const
+{
+    return m_numBins;
+}
+
+int KisSlidingWindowHistogram::numAccumulators() const
+{
+    return m_numAccumulators;
+}
+
+void KisSlidingWindowHistogram::setPatchSize(const QSize &size)
+{
+    m_patchSize = size;
+}
+
+QSize KisSlidingWindowHistogram::patchSize() const
+{
+    return m_patchSize;
+}
+
+void KisSlidingWindowHistogram::process(KisPaintDeviceSP src,
+                                        KisPaintDeviceSP dst,
+                                        const QRect &applyRect,
+                                        int radius,
+                                        SampleFunction sampleFunc,
+                                        ResultFunction resultFunc,
+                                        KoUpdater *progressUpdater) const
+{
+    if (applyRect.isEmpty()) return;
+
+    KIS_SAFE_ASSERT_RECOVER(radius >= 0) { radius = 0; }
+    KIS_SAFE_ASSERT_RECOVER_RETURN(*src->colorSpace() == *dst->colorSpace());
+
+    /**
+     * When processing in-place, the patches written by one thread would
+     * be read by the neighbouring ones. Read from a copy-on-write snapshot
+     * instead, it costs only a shallow copy of the tiles.
+     */
+    KisPaintDeviceSP source = src;
+    if (src == dst) {
+        source = new KisPaintDevice(*src);
+    }
+
+    const int pixelSize = src->pixelSize();
+
+    /**
+     * Smaller patches would be dominated by the initialization of the
+     * column histograms, which costs O(radius) per column
+     */
+    const QSize patchSize(qMax(m_patchSize.width(), 4 * radius),
+                          qMax(m_patchSize.height(), 4 * radius));
+
+    using KisAlgebra2D::divideFloor;
+
+    const int firstBand = divideFloor(applyRect.top(), patchSize.height());
+    const int lastBand = divideFloor(applyRect.bottom(), patchSize.height());
+    const int numBands = lastBand - firstBand + 1;
+
+    auto processJob = [&] (const QRect &dstRect) {
+        const QRect srcRect = dstRect.adjusted(-radius, -radius, radius, radius);
+
+        std::vector<quint8> srcData(size_t(srcRect.width()) * srcRect.height() * pixelSize);
+        std::vector<quint8> dstData(size_t(dstRect.width()) * dstRect.height() * pixelSize);
+
+        source->readBytes(srcData.data(), srcRect);
+        processPatch(srcData.data(), srcRect, pixelSize,
+                     dstData.data(), dstRect, radius,
+                     sampleFunc, resultFunc);
+        dst->writeBytes(dstData.data(), dstRect);
+    };
+
+    for (int band = firstBand; band <= lastBand; band++) {
+        const QRect bandRect =
+            applyRect & QRect(applyRect.x(), band * patchSize.height(),
+                              applyRect.width(), patchSize.height());
+
+        QVector<QRect> patches = KritaUtils::splitRectIntoPatches(bandRect, patchSize);
+        QtConcurrent::blockingMap(patches, processJob);
+
+        if (progressUpdater) {
+            if (progressUpdater->interrupted()) break;
+            progressUpdater->setProgress(100 * (band - firstBand + 1) / numBands);
+        }
+    }
+}
+
+void KisSlidingWindowHistogram::processPatch(const quint8 *srcData,
+                                             const QRect &srcRect,
+                                             int pixelSize,
+                                             quint8 *dstData,
+                                             const QRect &dstRect,
+                                             int radius,
+                                             const SampleFunction &sampleFunc,
+                                             const ResultFunction &resultFunc) const
+{
+    const int numBins = m_numBins;
+    const int numAccumulators = m_numAccumulators;
+    const int numSums = numBins * numAccumulators;
+
+    const int srcWidth = srcRect.width();
+    const int srcHeight = srcRect.height();
+    const int windowSize = 2 * radius + 1;
+
+    /**
+     * Sample all the source pixels once, so that the sliding loops
+     * would touch only the prepared bins and accumulators.
+     */
+    std::vector<int> bins(size_t(srcWidth) * srcHeight);
+    std::vector<float> accumulators(size_t(srcWidth) * srcHeight * numAccumulators);
+    QVector<float> scratch(numAccumulators);
+
+    {
+        const quint8 *srcPtr = srcData;
+        int *binPtr = bins.data();
+        float *accPtr = accumulators.data();
+
+        for (size_t i = 0; i < bins.size(); i++) {
+            *binPtr = sampleFunc(srcPtr, accPtr, scratch);
+            KIS_SAFE_ASSERT_RECOVER(*binPtr < numBins) { *binPtr = numBins - 1; }
+
+            srcPtr += pixelSize;
+            binPtr++;
+            accPtr += numAccumulators;
+        }
+    }
+
+    std::vector<quint32> columnCounts(size_t(srcWidth) * numBins, 0);
+    std::vector<float> columnSums(size_t(srcWidth) * numSums, 0.0f);
+    std::vector<quint32> columnTotals(srcWidth, 0);
+
+    auto updateColumn = [&] (int column, int row, bool add) {
+        const size_t index = size_t(row) * srcWidth + column;
+        const int bin = bins[index];
+        if (bin < 0) return;
+
+        quint32 *counts = columnCounts.data() + size_t(column) * numBins;
+        float *sums = columnSums.data() + size_t(column) * numSums + bin * numAccumulators;
+        const float *acc = accumulators.data() + index * numAccumulators;
+
+        if (add) {
+            columnTotals[column]++;
+            counts[bin]++;
+            for (int i = 0; i < numAccumulators; i++) {
+                sums[i] += acc[i];
+            }
+        } else {
+            columnTotals[column]--;
+            counts[bin]--;
+            for (int i = 0; i < numAccumulators; i++) {
+                sums[i] -= acc[i];
+            }
+        }
+    };
+
+    // initialize the column histograms with the window of the first row
+    for (int row = 0; row < windowSize; row++) {
+        for (int column = 0; column < srcWidth; column++) {
+            updateColumn(column, row, true);
+        }
+    }
+
+    std::vector<quint32> windowCounts(numBins);
+    std::vector<float> windowSums(numSums);
+
+    Window window;
+    window.numBins = numBins;
+    window.numAccumulators = numAccumulators;
+    window.counts = windowCounts.data();
+    window.sums = windowSums.data();
+
+    quint8 *dstPtr = dstData;
+
+    for (int y = 0; y < dstRect.height(); y++) {
+        if (y > 0) {
+            for (int column = 0; column < srcWidth; column++) {
+                updateColumn(column, y - 1, false);
+                updateColumn(column, y + windowSize - 1, true);
+            }
+        }
+
+        /**
+         * The window histogram is reset on every row to avoid
+         * accumulating floating point errors in the sums
+         */
+        std::fill(windowCounts.begin(), windowCounts.end(), 0);
+        std::fill(windowSums.begin(), windowSums.end(), 0.0f);
+        window.totalCount = 0;
+
+        for (int column = 0; column < windowSize; column++) {
+            window.totalCount += columnTotals[column];
+            addHistogram(windowCounts.data(), windowSums.data(),
+                         columnCounts.data() + size_t(column) * numBins,
+                         columnSums.data() + size_t(column) * numSums,
+                         numBins, numAccumulators);
+        }
+
+        const quint8 *centerRowPtr =
+            srcData + (size_t(y + radius) * srcWidth + radius) * pixelSize;
+
+        for (int x = 0; x < dstRect.width(); x++) {
+            if (x > 0) {
+                window.totalCount -= columnTotals[x - 1];
+                window.totalCount += columnTotals[x + windowSize - 1];
+
+                subtractHistogram(windowCounts.data(), windowSums.data(),
+                                  columnCounts.data() + size_t(x - 1) * numBins,
+                                  columnSums.data() + size_t(x - 1) * numSums,
+                                  numBins, numAccumulators);
+
+                addHistogram(windowCounts.data(), windowSums.data(),
+                             columnCounts.data() + size_t(x + windowSize - 1) * numBins,
+                             columnSums.data() + size_t(x + windowSize - 1) * numSums,
+                             numBins, numAccumulators);
+            }
+
+            resultFunc(window, centerRowPtr + x * pixelSize, dstPtr, scratch);
+            dstPtr += pixelSize;
+        }
+    }
+}
+
+int KisSlidingWindowHistogram::findMode(const Window &window)
+{
+    int result = -1;
+    quint32 maxCount = 0;
+
+    for (int i = 0; i < window.numBins; i++) {
+        if (window.counts[i] > maxCount) {
+            maxCount = window.counts[i];
+            result = i;
+        }
+    }
+
+    return result;
+}
+
+int KisSlidingWindowHistogram::findRank(const Window &window, qreal rank)
+{
+    if (!window.totalCount) return -1;
+
+    const quint32 targetIndex =
+        quint32(qBound(0.0, rank, 1.0) * (window.totalCount - 1) + 0.5);
+
+    quint32 cumulativeCount = 0;
+
+    for (int i = 0; i < window.numBins; i++) {
+        cumulativeCount += window.counts[i];
+        if (cumulativeCount > targetIndex) {
+            return i;
+        }
+    }
+
+    return window.numBins - 1;
+}
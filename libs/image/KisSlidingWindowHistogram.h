@@ -0,0 +1,140 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSLIDINGWINDOWHISTOGRAM_H
+#define KISSLIDINGWINDOWHISTOGRAM_H
+
+#include <functional>
+
+#include <QRect>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class KoUpdater;
+
+/**
+ * A constant-time sliding window histogram engine based on the algorithm
+ * described by Perreault and Hébert in "Median Filtering in Constant Time"
+ * (IEEE Transactions on Image Processing, 2007).
+ *
+ * Every source pixel is mapped into one of numBins() bins (and, optionally,
+ * into a set of numAccumulators() float values that are summed per bin). For
+ * every destination pixel the engine provides a histogram of the square
+ * window of size (2 * radius + 1) centered at this pixel. The histograms are
+ * maintained incrementally: one histogram per column is slid down, and the
+ * window histogram is slid right by adding/removing whole column histograms,
+ * so the per-pixel cost depends on the number of bins only, not on the
+ * radius.
+ *
+ * The processing rect is split into tile-aligned patches which are processed
+ * in parallel, one band of patches at a time.
+ */
+class KRITAIMAGE_EXPORT KisSlidingWindowHistogram
+{
+public:
+    /**
+     * The histogram of the window around the current destination pixel
+     */
+    struct Window {
+        int numBins = 0;
+        int numAccumulators = 0;
+
+        /// numBins counters
+        const quint32 *counts = nullptr;
+
+        /// numBins * numAccumulators sums, accumulators of bin \p i
+        /// start at sums[i * numAccumulators]
+        const float *sums = nullptr;
+
+        /// the number of pixels that fell into any bin
+        quint32 totalCount = 0;
+
+        inline const float* binSums(int bin) const {
+            return sums + bin * numAccumulators;
+        }
+    };
+
+    /**
+     * Maps a source pixel into a bin and fills its accumulators. Returning
+     * a negative value excludes the pixel from the histogram (e.g. for
+     * fully transparent pixels).
+     *
+     * \p scratch is a buffer of numAccumulators() values owned by the
+     * calling thread. It can be used as a temporary for KoColorSpace's
+     * normalised channel functions instead of allocating one per pixel.
+     */
+    using SampleFunction = std::function<int (const quint8 *srcPixel, float *accumulators, QVector<float> &scratch)>;
+
+    /**
+     * Writes the destination pixel \p dstPixel from the histogram of the
+     * window. \p centerPixel is the source pixel at the same position.
+     * \p scratch is the same per-thread buffer as in SampleFunction.
+     */
+    using ResultFunction = std::function<void (const Window &window, const quint8 *centerPixel, quint8 *dstPixel, QVector<float> &scratch)>;
+
+public:
+    KisSlidingWindowHistogram(int numBins, int numAccumulators = 0);
+
+    int numBins() const;
+    int numAccumulators() const;
+
+    /**
+     * Set the size of the patches the processing rect is split into.
+     * The engine always uses patches at least 4 * radius wide, otherwise
+     * the column initialization would dominate the processing time.
+     */
+    void setPatchSize(const QSize &size);
+    QSize patchSize() const;
+
+    /**
+     * Processes \p applyRect of \p src and writes the result into \p dst.
+     * The source device is read in the area grown by \p radius. The devices
+     * may be the same, in that case the source is read from a
+     * copy-on-write snapshot of the device.
+     *
+     * The functions are called concurrently from several threads, so they
+     * should not modify any shared state.
+     */
+    void process(KisPaintDeviceSP src,
+                 KisPaintDeviceSP dst,
+                 const QRect &applyRect,
+                 int radius,
+                 SampleFunction sampleFunc,
+                 ResultFunction resultFunc,
+                 KoUpdater *progressUpdater = nullptr) const;
+
+    /**
+     * @return the most populated bin of the window (the first one if there
+     * are several), or -1 if the window is empty
+     */
+    static int findMode(const Window &window);
+
+    /**
+     * @return the bin containing the element of the window with the
+     * given rank (0.0 is the minimum, 0.5 is the median, 1.0 is the
+     * maximum), or -1 if the window is empty
+     */
+    static int findRank(const Window &window, qreal rank);
+
+private:
+    void processPatch(const quint8 *srcData,
+                      const QRect &srcRect,
+                      int pixelSize,
+                      quint8 *dstData,
+                      const QRect &dstRect,
+                      int radius,
+                      const SampleFunction &sampleFunc,
+                      const ResultFunction &resultFunc) const;
+
+private:
+    int m_numBins;
+    int m_numAccumulators;
+    QSize m_patchSize;
+};
+
+#endif // KISSLIDINGWINDOWHISTOGRAM_H
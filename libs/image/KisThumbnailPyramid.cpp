@@ -0,0 +1,346 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisThumbnailPyramid.h"
+
+#include <vector>
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoMixColorsOp.h>
+
+#include "kis_paint_device.h"
+#include "kis_datamanager.h"
+#include "tiles3/KisTileRevisionTracker.h"
+#include "kis_algebra_2d.h"
+#include "krita_utils.h"
+#include "KisRegion.h"
+
+
+namespace {
+
+/**
+ * The levels smaller than this are not stored
+ */
+const int MinLevelSize = 16;
+
+/**
+ * The maximum size of the source area processed at once when downsampling
+ */
+const int MaxSourcePatchSize = 256;
+
+const int TileSize = 64;
+
+QRect toLevelRect(const QRect &rc, int scaleLog2)
+{
+    using KisAlgebra2D::divideFloor;
+
+    if (!scaleLog2) return rc;
+
+    const int scale = 1 << scaleLog2;
+
+    const int left = divideFloor(rc.left(), scale);
+    const int top = divideFloor(rc.top(), scale);
+    const int right = divideFloor(rc.right(), scale);
+    const int bottom = divideFloor(rc.bottom(), scale);
+
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+QRect fromLevelRect(const QRect &rc, int scaleLog2)
+{
+    return QRect(rc.x() << scaleLog2, rc.y() << scaleLog2,
+                 rc.width() << scaleLog2, rc.height() << scaleLog2);
+}
+
+int levelSize(const QRect &bounds, int scaleLog2)
+{
+    return qMax(bounds.width(), bounds.height()) >> scaleLog2;
+}
+
+/**
+ * Downsamples \p dstRect of \p dst from \p src with the box filter. Every
+ * destination pixel is the average of a square of 2^scaleLog2 source
+ * pixels. The area is halved step by step, so that every step mixes only
+ * four pixels with the colorspace's mixing op, which handles the alpha
+ * channel correctly.
+ */
+void downsampleRect(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                    const QRect &dstRect, int scaleLog2)
+{
+    const int pixelSize = src->pixelSize();
+    const KoMixColorsOp *mixOp = src->colorSpace()->mixColorsOp();
+
+    const int patchSize = qMax(1, MaxSourcePatchSize >> scaleLog2);
+    const QVector<QRect> patches = KritaUtils::splitRectIntoPatches(dstRect, QSize(patchSize, patchSize));
+
+    std::vector<quint8> buffer;
+    std::vector<quint8> halved;
+
+    for (const QRect &patch : patches) {
+        const QRect srcRect = fromLevelRect(patch, scaleLog2);
+
+        buffer.resize(size_t(srcRect.width()) * srcRect.height() * pixelSize);
+        src->readBytes(buffer.data(), srcRect);
+
+        int width = srcRect.width();
+        int height = srcRect.height();
+
+        for (int step = 0; step < scaleLog2; step++) {
+            const int newWidth = width / 2;
+            const int newHeight = height / 2;
+            const size_t rowStride = size_t(width) * pixelSize;
+
+            halved.resize(size_t(newWidth) * newHeight * pixelSize);
+            quint8 *dstPtr = halved.data();
+
+            for (int y = 0; y < newHeight; y++) {
+                const quint8 *srcRow = buffer.data() + 2 * y * rowStride;
+
+                for (int x = 0; x < newWidth; x++) {
+                    const quint8 *srcPtr = srcRow + 2 * x * pixelSize;
+                    const quint8 *colors[4] = {srcPtr, srcPtr + pixelSize,
+                                               srcPtr + rowStride, srcPtr + rowStride + pixelSize};
+
+                    mixOp->mixColors(colors, 4, dstPtr);
+                    dstPtr += pixelSize;
+                }
+            }
+
+            std::swap(buffer, halved);
+            width = newWidth;
+            height = newHeight;
+        }
+
+        dst->writeBytes(buffer.data(), patch);
+    }
+}
+
+/**
+ * Downsamples the given rects of \p dst in parallel. The rects are grouped
+ * by the tiles of the destination device, so that no tile is written by
+ * two threads at the same time.
+ */
+void downsampleRects(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                     const QVector<QRect> &dstRects, int scaleLog2)
+{
+    QMap<QPair<int, int>, QVector<QRect>> tileJobs;
+
+    for (const QRect &rc : dstRects) {
+        for (const QRect &patch : KritaUtils::splitRectIntoPatches(rc, QSize(TileSize, TileSize))) {
+            using KisAlgebra2D::divideFloor;
+            tileJobs[qMakePair(divideFloor(patch.x(), TileSize), divideFloor(patch.y(), TileSize))] << patch;
+        }
+    }
+
+    QVector<QVector<QRect>> jobs;
+    jobs.reserve(tileJobs.size());
+    for (auto it = tileJobs.begin(); it != tileJobs.end(); ++it) {
+        jobs << it.value();
+    }
+
+    QtConcurrent::blockingMap(jobs,
+        [&] (const QVector<QRect> &rects) {
+            for (const QRect &rc : rects) {
+                downsampleRect(src, dst, rc, scaleLog2);
+            }
+        });
+}
+
+}
+
+struct KisThumbnailPyramid::Private
+{
+    mutable QMutex mutex;
+
+    KisTileRevisionTracker revisions;
+    QVector<KisPaintDeviceSP> levels;
+    int firstLevel = 0;
+    int minSize = 0;
+    QRect imageBounds;
+    QPoint offset;
+    const KoColorSpace *colorSpace = nullptr;
+    QByteArray defaultPixel;
+
+    bool needsRebuild(KisPaintDeviceSP device, int minSize) const;
+    void rebuild(KisPaintDeviceSP device, int minSize);
+    QVector<QRect> changedRects(KisPaintDeviceSP device);
+    void updateLevels(KisPaintDeviceSP device, const QVector<QRect> &dirtyRects);
+};
+
+KisThumbnailPyramid::KisThumbnailPyramid()
+    : m_d(new Private)
+{
+}
+
+KisThumbnailPyramid::~KisThumbnailPyramid()
+{
+}
+
+bool KisThumbnailPyramid::Private::needsRebuild(KisPaintDeviceSP device, int newMinSize) const
+{
+    const KoColor devicePixel = device->defaultPixel();
+
+    return levels.isEmpty() ||
+        newMinSize > minSize ||
+        imageBounds != device->defaultBounds()->bounds() ||
+        offset != QPoint(device->x(), device->y()) ||
+        !colorSpace || !(*colorSpace == *device->colorSpace()) ||
+        defaultPixel != QByteArray(reinterpret_cast<const char*>(devicePixel.data()), devicePixel.colorSpace()->pixelSize());
+}
+
+void KisThumbnailPyramid::Private::rebuild(KisPaintDeviceSP device, int newMinSize)
+{
+    minSize = newMinSize;
+    imageBounds = device->defaultBounds()->bounds();
+    offset = QPoint(device->x(), device->y());
+    colorSpace = device->colorSpace();
+
+    const KoColor devicePixel = device->defaultPixel();
+    defaultPixel = QByteArray(reinterpret_cast<const char*>(devicePixel.data()), devicePixel.colorSpace()->pixelSize());
+
+    firstLevel = 0;
+    while (levelSize(imageBounds, firstLevel + 1) >= minSize) {
+        firstLevel++;
+    }
+
+    levels.clear();
+
+    int level = firstLevel;
+    do {
+        KisPaintDeviceSP levelDevice = new KisPaintDevice(colorSpace);
+        levelDevice->setDefaultPixel(devicePixel);
+        levels << levelDevice;
+        level++;
+    } while (levelSize(imageBounds, level) >= MinLevelSize);
+
+    revisions.clear();
+    updateLevels(device, changedRects(device));
+}
+
+QVector<QRect> KisThumbnailPyramid::Private::changedRects(KisPaintDeviceSP device)
+{
+    QVector<QRect> rects = revisions.update(device->dataManager());
+
+    for (QRect &rc : rects) {
+        rc.translate(offset);
+    }
+
+    return rects;
+}
+
+void KisThumbnailPyramid::Private::updateLevels(KisPaintDeviceSP device, const QVector<QRect> &dirtyRects)
+{
+    if (!dirtyRects.isEmpty()) {
+        QVector<QRect> levelRects;
+        for (const QRect &rc : dirtyRects) {
+            levelRects << toLevelRect(rc, firstLevel);
+        }
+
+        levelRects = KisRegion::fromOverlappingRects(levelRects, TileSize).rects();
+        downsampleRects(device, levels[0], levelRects, firstLevel);
+
+        for (int i = 1; i < levels.size(); i++) {
+            for (QRect &rc : levelRects) {
+                rc = toLevelRect(rc, 1);
+            }
+
+            levelRects = KisRegion::fromOverlappingRects(levelRects, TileSize).rects();
+            downsampleRects(levels[i - 1], levels[i], levelRects, 1);
+        }
+    }
+}
+
+void KisThumbnailPyramid::update(KisPaintDeviceSP device, int minSize)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (m_d->needsRebuild(device, minSize)) {
+        m_d->rebuild(device, qMax(minSize, m_d->minSize));
+    } else {
+        m_d->updateLevels(device, m_d->changedRects(device));
+    }
+}
+
+void KisThumbnailPyramid::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->revisions.clear();
+    m_d->levels.clear();
+    m_d->minSize = 0;
+    m_d->colorSpace = nullptr;
+}
+
+KisPaintDeviceSP KisThumbnailPyramid::levelDevice(const QSize &size, const QRect &rect, QRect *levelRect) const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (m_d->levels.isEmpty()) return nullptr;
+
+    int index = 0;
+    while (index + 1 < m_d->levels.size()) {
+        const QRect nextRect = toLevelRect(rect, m_d->firstLevel + index + 1);
+        if (nextRect.width() < size.width() || nextRect.height() < size.height()) break;
+
+        index++;
+    }
+
+    if (levelRect) {
+        *levelRect = toLevelRect(rect, m_d->firstLevel + index);
+    }
+
+    return new KisPaintDevice(*m_d->levels[index]);
+}
+
+QImage KisThumbnailPyramid::createThumbnail(qint32 maxw, qint32 maxh, const QRect &rect,
+                                            const KoColorProfile *profile,
+                                            KoColorConversionTransformation::Intent renderingIntent,
+                                            KoColorConversionTransformation::ConversionFlags conversionFlags) const
+{
+    if (maxw <= 0 || maxh <= 0 || rect.isEmpty()) return QImage();
+
+    const QSize thumbnailSize = rect.size().scaled(maxw, maxh, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+
+    QRect levelRect;
+    KisPaintDeviceSP level = levelDevice(2 * thumbnailSize, rect, &levelRect);
+    if (!level) return QImage();
+
+    if (levelRect.width() < thumbnailSize.width() ||
+        levelRect.height() < thumbnailSize.height()) {
+
+        // the rect is too small for the stored levels
+        return QImage();
+    }
+
+    QImage image = level->convertToQImage(profile, levelRect, renderingIntent, conversionFlags);
+
+    return image.size() != thumbnailSize ?
+        image.scaled(thumbnailSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation) : image;
+}
+
+bool KisThumbnailPyramid::isValid() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return !m_d->levels.isEmpty();
+}
+
+int KisThumbnailPyramid::firstLevel() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->firstLevel;
+}
+
+int KisThumbnailPyramid::numLevels() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->levels.size();
+}
@@ -0,0 +1,110 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTHUMBNAILPYRAMID_H
+#define KISTHUMBNAILPYRAMID_H
+
+#include <QScopedPointer>
+#include <QImage>
+#include <QRect>
+
+#include <KoColorConversionTransformation.h>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class KoColorProfile;
+
+/**
+ * A multi-level cache of downsampled copies of a paint device, used for
+ * generating thumbnails without reading the device in full resolution.
+ *
+ * Level N of the pyramid is the device downsampled 2^N times with a box
+ * filter. The pyramid stores only the levels small enough to be useful
+ * for thumbnails: the first stored level is the smallest one that is
+ * still at least minSize pixels on its longest side, measured for the
+ * bounds of the image.
+ *
+ * The pyramid is updated incrementally. It remembers the revisions of the
+ * tiles of the device (see KisTileRevisionTracker), so only the tiles
+ * written into since the previous update are downsampled again.
+ *
+ * Every paint device owns its own pyramid, see
+ * KisPaintDevice::thumbnailPyramid(), so all the thumbnail generators
+ * (the layers docker, the overview docker) share the same cache.
+ *
+ * All the methods are thread-safe, but update() should not be called
+ * while the device is being modified, e.g. it should be called from
+ * an idle task stroke.
+ */
+class KRITAIMAGE_EXPORT KisThumbnailPyramid
+{
+public:
+    KisThumbnailPyramid();
+    ~KisThumbnailPyramid();
+
+    /**
+     * Brings the pyramid in sync with \p device.
+     *
+     * @param minSize the minimal size of the longest side of the first
+     * stored level. The pyramid is rebuilt when the requested size is
+     * bigger than the one it has been built for, smaller requests are
+     * served by the existing levels.
+     */
+    void update(KisPaintDeviceSP device, int minSize);
+
+    /**
+     * Drops all the levels and the remembered tile revisions
+     */
+    void clear();
+
+    /**
+     * @return the smallest level whose part corresponding to \p rect is
+     * still at least \p size big, or the first stored level if none of
+     * them are big enough. The returned device is a copy-on-write copy
+     * of the level, it is not affected by the following updates.
+     *
+     * @param levelRect returns the rect of the level corresponding to \p rect
+     */
+    KisPaintDeviceSP levelDevice(const QSize &size, const QRect &rect, QRect *levelRect) const;
+
+    /**
+     * Creates a thumbnail of \p rect of the device, which fits into
+     * (maxw, maxh) with the aspect ratio preserved. The thumbnail is
+     * generated from the smallest level that is still at least twice as
+     * big as the requested size.
+     *
+     * @return a null image if the pyramid has not been built yet or
+     * if \p rect is too small to be represented by the stored levels
+     * in the requested size. The callers are expected to generate the
+     * thumbnail from the device itself in such a case.
+     */
+    QImage createThumbnail(qint32 maxw, qint32 maxh, const QRect &rect,
+                           const KoColorProfile *profile,
+                           KoColorConversionTransformation::Intent renderingIntent,
+                           KoColorConversionTransformation::ConversionFlags conversionFlags) const;
+
+    /**
+     * @return true if the pyramid has been built at least once
+     */
+    bool isValid() const;
+
+    /**
+     * @return the scale of the first stored level as a power of two
+     */
+    int firstLevel() const;
+
+    /**
+     * @return the number of stored levels
+     */
+    int numLevels() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISTHUMBNAILPYRAMID_H
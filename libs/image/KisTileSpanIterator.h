@@ -0,0 +1,218 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILESPANITERATOR_H
+#define KISTILESPANITERATOR_H
+
+#include <KoAlwaysInline.h>
+
+#include "kis_types.h"
+#include "kis_paint_device.h"
+#include "kis_random_accessor_ng.h"
+#include "KisSequentialIteratorProgress.h"
+
+
+struct ReadOnlySpanPolicy {
+    ReadOnlySpanPolicy(KisPaintDeviceSP dev)
+        : m_accessor(dev->createRandomConstAccessorNG())
+    {
+    }
+
+    ALWAYS_INLINE void moveTo(int x, int y) {
+        m_accessor->moveTo(x, y);
+        m_rawDataConst = m_accessor->rawDataConst();
+        m_oldRawData = m_accessor->oldRawData();
+    }
+
+    ALWAYS_INLINE const quint8* rawDataConst() const {
+        return m_rawDataConst;
+    }
+
+    ALWAYS_INLINE const quint8* oldRawData() const {
+        return m_oldRawData;
+    }
+
+    KisRandomConstAccessorSP m_accessor;
+
+private:
+    const quint8 *m_rawDataConst {nullptr};
+    const quint8 *m_oldRawData {nullptr};
+};
+
+struct WritableSpanPolicy {
+    WritableSpanPolicy(KisPaintDeviceSP dev)
+        : m_accessor(dev->createRandomAccessorNG())
+    {
+    }
+
+    ALWAYS_INLINE void moveTo(int x, int y) {
+        m_accessor->moveTo(x, y);
+        m_rawData = m_accessor->rawData();
+        m_oldRawData = m_accessor->oldRawData();
+    }
+
+    ALWAYS_INLINE quint8* rawData() {
+        return m_rawData;
+    }
+
+    ALWAYS_INLINE const quint8* rawDataConst() const {
+        return m_rawData;
+    }
+
+    ALWAYS_INLINE const quint8* oldRawData() const {
+        return m_oldRawData;
+    }
+
+    KisRandomAccessorSP m_accessor;
+
+private:
+    quint8 *m_rawData {nullptr};
+    const quint8 *m_oldRawData {nullptr};
+};
+
+/**
+ * Span iterator walks over a rect of the device in the pieces that are
+ * stored contiguously in memory, that is, in the intersections of the
+ * rect with the tiles of the device. Every span is a block of
+ * spanWidth() x spanHeight() pixels, its rows are rowStride() bytes
+ * apart, so the user can process the whole block with tight loops (or
+ * pass the rows to the color space/composite op functions directly)
+ * without paying any iterator overhead per pixel.
+ *
+ * The spans are visited row of tiles by row of tiles, from left to
+ * right. Like with the sequential iterator, nextSpan() should be called
+ * before accessing the first span.
+ *
+ * \code{.cpp}
+ * KisTileSpanIterator it(dev, rect);
+ * while (it.nextSpan()) {
+ *     const quint8 *srcRow = it.oldRawData();
+ *     quint8 *dstRow = it.rawData();
+ *
+ *     for (int row = 0; row < it.spanHeight(); row++) {
+ *         processPixels(srcRow, dstRow, it.spanWidth());
+ *
+ *         srcRow += it.rowStride();
+ *         dstRow += it.rowStride();
+ *     }
+ * }
+ * \endcode
+ *
+ * Please note that the spans of two different devices are not
+ * guaranteed to coincide, since the tile grid depends on the offset of
+ * the device. To process two devices in one go, use random accessors
+ * and take the minimum of their numContiguousColumns()/Rows(), like
+ * KisPainter::bitBlt() does.
+ */
+template <class SpanPolicy, class ProgressPolicy = NoProgressPolicy>
+class KisTileSpanIteratorBase
+{
+public:
+    KisTileSpanIteratorBase(KisPaintDeviceSP dev, const QRect &rect, ProgressPolicy progressPolicy = ProgressPolicy())
+        : m_policy(dev),
+          m_progressPolicy(progressPolicy),
+          m_rect(rect),
+          m_x(rect.x()),
+          m_y(rect.y()),
+          m_spanWidth(0),
+          m_spanHeight(0),
+          m_rowStride(0)
+    {
+        m_progressPolicy.setRange(rect.top(), rect.top() + rect.height());
+        m_progressPolicy.setValue(rect.top());
+    }
+
+    ~KisTileSpanIteratorBase() {
+        m_progressPolicy.setFinished();
+    }
+
+    inline bool nextSpan() {
+        if (m_rect.isEmpty()) return false;
+
+        m_x += m_spanWidth;
+
+        if (m_x > m_rect.right()) {
+            m_x = m_rect.x();
+            m_y += m_spanHeight;
+            m_spanHeight = 0;
+
+            m_progressPolicy.setValue(m_y);
+        }
+
+        if (m_y > m_rect.bottom()) {
+            m_spanWidth = 0;
+            return false;
+        }
+
+        // all the spans in a row of tiles have the same height
+        if (!m_spanHeight) {
+            m_spanHeight = qMin(m_policy.m_accessor->numContiguousRows(m_y),
+                                m_rect.bottom() - m_y + 1);
+        }
+
+        m_spanWidth = qMin(m_policy.m_accessor->numContiguousColumns(m_x),
+                           m_rect.right() - m_x + 1);
+        m_rowStride = m_policy.m_accessor->rowStride(m_x, m_y);
+
+        m_policy.moveTo(m_x, m_y);
+
+        return true;
+    }
+
+    ALWAYS_INLINE int x() const {
+        return m_x;
+    }
+
+    ALWAYS_INLINE int y() const {
+        return m_y;
+    }
+
+    ALWAYS_INLINE int spanWidth() const {
+        return m_spanWidth;
+    }
+
+    ALWAYS_INLINE int spanHeight() const {
+        return m_spanHeight;
+    }
+
+    ALWAYS_INLINE int rowStride() const {
+        return m_rowStride;
+    }
+
+    // SFINAE: This method becomes undefined for const version of the
+    //         iterator automatically
+    ALWAYS_INLINE quint8* rawData() {
+        return m_policy.rawData();
+    }
+
+    ALWAYS_INLINE const quint8* rawDataConst() const {
+        return m_policy.rawDataConst();
+    }
+
+    ALWAYS_INLINE const quint8* oldRawData() const {
+        return m_policy.oldRawData();
+    }
+
+private:
+    Q_DISABLE_COPY(KisTileSpanIteratorBase)
+    SpanPolicy m_policy;
+    ProgressPolicy m_progressPolicy;
+    const QRect m_rect;
+
+    int m_x;
+    int m_y;
+    int m_spanWidth;
+    int m_spanHeight;
+    int m_rowStride;
+};
+
+typedef KisTileSpanIteratorBase<ReadOnlySpanPolicy> KisTileSpanConstIterator;
+typedef KisTileSpanIteratorBase<WritableSpanPolicy> KisTileSpanIterator;
+
+typedef KisTileSpanIteratorBase<ReadOnlySpanPolicy, ProxyBasedProgressPolicy> KisTileSpanConstIteratorProgress;
+typedef KisTileSpanIteratorBase<WritableSpanPolicy, ProxyBasedProgressPolicy> KisTileSpanIteratorProgress;
+
+#endif // KISTILESPANITERATOR_H
@@ -214,6 +214,11 @@ int KisBaseNode::thumbnailSeqNo() const
     return -1;
 }
 
+KisPaintDeviceSP KisBaseNode::thumbnailDevice() const
+{
+    return nullptr;
+}
+
 QImage KisBaseNode::createThumbnailForFrame(qint32 w, qint32 h, int time, Qt::AspectRatioMode aspectRatioMode)
 {
     Q_UNUSED(time);
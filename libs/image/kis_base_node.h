@@ -328,6 +328,14 @@ public:
      */
     virtual int thumbnailSeqNo() const;
 
+    /**
+     * @return the paint device the thumbnail of the node is generated
+     * from, or null if the node type cannot generate a thumbnail. The
+     * thumbnail generators use it to keep a KisThumbnailPyramid of the
+     * device up-to-date.
+     */
+    virtual KisPaintDeviceSP thumbnailDevice() const;
+
     /**
      * @return a thumbnail in requested size for the defined timestamp.
      * The thumbnail is a rgba Image and may have transparent parts.
@@ -13,19 +13,61 @@
 
 #if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) && XSIMD_UNIVERSAL_BUILD_PASS
 
+#include <algorithm>
+
 #include "kis_brush_mask_scalar_applicator.h"
 
 template<class V>
 struct FastRowProcessor {
     FastRowProcessor(V *maskGenerator)
         : d(maskGenerator->d.data())
+        , foldSpikes(maskGenerator->spikes() > 2)
+        , spikesAngle(static_cast<float>(M_PI / maskGenerator->spikes()))
+        , spikesCos(static_cast<float>(cos(-2 * M_PI / maskGenerator->spikes())))
+        , spikesSin(static_cast<float>(sin(-2 * M_PI / maskGenerator->spikes())))
     {
     }
 
     template<typename _impl>
     void process(float *buffer, int width, float y, float cosa, float sina, float centerX, float centerY);
 
+    /**
+     * Vectorized version of KisMaskGenerator::fixRotation(): rotates
+     * every lane back into the first spike. \p yr is expected to be
+     * non-negative, the same way the scalar valueAt() passes it.
+     */
+    template<typename _impl>
+    inline void fixRotation(xsimd::batch<float, _impl> &xr, xsimd::batch<float, _impl> &yr) const
+    {
+        using float_v = xsimd::batch<float, _impl>;
+
+        const float_v vSpikesAngle(spikesAngle);
+        const float_v vSpikesStep(2 * spikesAngle);
+        const float_v vCs(spikesCos);
+        const float_v vSs(spikesSin);
+
+        float_v angle = xsimd::atan2(yr, xr);
+        auto rotateMask = angle > vSpikesAngle;
+
+        // every lane needs at most spikes / 2 rotations
+        while (xsimd::any(rotateMask)) {
+            const float_v sx = xr;
+            const float_v sy = yr;
+
+            xr = xsimd::select(rotateMask, vCs * sx - vSs * sy, sx);
+            yr = xsimd::select(rotateMask, vSs * sx + vCs * sy, sy);
+
+            angle = xsimd::select(rotateMask, angle - vSpikesStep, angle);
+            rotateMask = angle > vSpikesAngle;
+        }
+    }
+
     typename V::Private *d;
+
+    const bool foldSpikes;
+    const float spikesAngle;
+    const float spikesCos;
+    const float spikesSin;
 };
 
 template<class MaskGenerator, typename _impl>
@@ -43,6 +85,11 @@ struct KisBrushMaskVectorApplicator : public KisBrushMaskScalarApplicator<MaskGe
 protected:
     void processVector(const QRect &rect);
 
+private:
+    void processSupersampledRow(FastRowProcessor<MaskGenerator> &processor,
+                                float *buffer, float *sampleBuffer, size_t simdWidth,
+                                int y, int supersample);
+
 private:
     template<class U, typename V>
     struct TypeHelper {
@@ -93,10 +140,21 @@ void KisBrushMaskVectorApplicator<MaskGenerator, impl>::processVector(const QRec
 
     auto *buffer =xsimd::vector_aligned_malloc<float>(simdWidth);
 
+    int supersample = 1;
+    if (m_maskGenerator->shouldSupersample()) {
+        // strengthen supersampling from 3x3 for very small dabs, to smooth out dashed strokes
+        supersample = (m_maskGenerator->shouldSupersample6x6() ? 6 : 3);
+    }
+    float *sampleBuffer = supersample > 1 ? xsimd::vector_aligned_malloc<float>(simdWidth) : nullptr;
+
     FastRowProcessor<MaskGenerator> processor(m_maskGenerator);
 
     for (int y = rect.y(); y < rect.y() + rect.height(); y++) {
-        processor.template process<impl>(buffer, simdWidth, y, m_d->cosa, m_d->sina, m_d->centerX, m_d->centerY);
+        if (supersample > 1) {
+            processSupersampledRow(processor, buffer, sampleBuffer, simdWidth, y, supersample);
+        } else {
+            processor.template process<impl>(buffer, simdWidth, y, m_d->cosa, m_d->sina, m_d->centerX, m_d->centerY);
+        }
 
         if (m_d->randomness != 0.0 || m_d->density != 1.0) {
             for (int x = 0; x < width; x++) {
@@ -136,6 +194,52 @@ void KisBrushMaskVectorApplicator<MaskGenerator, impl>::processVector(const QRec
         dabPointer += offset;
     } // endfor y
     xsimd::vector_aligned_free(buffer);
+
+    if (sampleBuffer) {
+        xsimd::vector_aligned_free(sampleBuffer);
+    }
+}
+
+template<class MaskGenerator, typename impl>
+void KisBrushMaskVectorApplicator<MaskGenerator, impl>::processSupersampledRow(FastRowProcessor<MaskGenerator> &processor,
+                                                                               float *buffer,
+                                                                               float *sampleBuffer,
+                                                                               size_t simdWidth,
+                                                                               int y,
+                                                                               int supersample)
+{
+    using float_v = xsimd::batch<float, impl>;
+
+    const MaskProcessingData *m_d = KisBrushMaskApplicatorBase::m_d;
+
+    const float invss = 1.0f / supersample;
+    const float_v vInvSampleArea(1.0f / pow2(supersample));
+
+    std::fill(buffer, buffer + simdWidth, 0.0f);
+
+    /**
+     * The same sampling grid as in processScalar(): the horizontal
+     * subpixel offset is folded into the center of the row, so the row
+     * processors don't need to know about supersampling at all.
+     */
+    for (int sy = 0; sy < supersample; sy++) {
+        for (int sx = 0; sx < supersample; sx++) {
+            processor.template process<impl>(sampleBuffer, simdWidth,
+                                             y + sy * invss,
+                                             m_d->cosa, m_d->sina,
+                                             m_d->centerX - sx * invss, m_d->centerY);
+
+            for (size_t i = 0; i < simdWidth; i += float_v::size) {
+                const float_v acc = float_v::load_aligned(buffer + i) + float_v::load_aligned(sampleBuffer + i);
+                acc.store_aligned(buffer + i);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < simdWidth; i += float_v::size) {
+        const float_v avg = float_v::load_aligned(buffer + i) * vInvSampleArea;
+        avg.store_aligned(buffer + i);
+    }
 }
 
 #endif /* defined HAVE_XSIMD */
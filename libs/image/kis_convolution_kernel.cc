@@ -8,8 +8,11 @@
 
 #include <math.h>
 
+#include <Eigen/SVD>
+
 #include <QImage>
 #include <kis_mask_generator.h>
+#include <kis_global.h>
 
 struct Q_DECL_HIDDEN KisConvolutionKernel::Private {
     qreal offset;
@@ -133,6 +136,56 @@ KisConvolutionKernelSP KisConvolutionKernel::fromMatrix(Eigen::Matrix<qreal, Eig
     return kernel;
 }
 
+QVector<KisConvolutionKernel::SeparableTerm> KisConvolutionKernel::separableTerms(int maxTerms, qreal tolerance) const
+{
+    using Matrix = Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>;
+
+    QVector<SeparableTerm> terms;
+
+    const Matrix &matrix = d->data;
+    if (matrix.size() == 0) return terms;
+
+    const qreal totalEnergy = matrix.squaredNorm();
+
+    if (totalEnergy <= 0.0) {
+        // a zero kernel is trivially separable
+        SeparableTerm term;
+        term.column = Eigen::Matrix<qreal, Eigen::Dynamic, 1>::Zero(matrix.rows());
+        term.row = Eigen::Matrix<qreal, Eigen::Dynamic, 1>::Zero(matrix.cols());
+        terms << term;
+        return terms;
+    }
+
+    /**
+     * BDCSVD falls back to the Jacobi algorithm for small matrices
+     * itself, so it is fine for any kernel size
+     */
+    Eigen::BDCSVD<Matrix> svd(matrix, Eigen::ComputeThinU | Eigen::ComputeThinV);
+
+    const auto &singularValues = svd.singularValues();
+    const qreal maxResidualEnergy = pow2(tolerance) * totalEnergy;
+
+    qreal residualEnergy = totalEnergy;
+
+    for (int i = 0; i < singularValues.size(); i++) {
+        if (residualEnergy <= maxResidualEnergy) break;
+
+        if (terms.size() >= maxTerms) {
+            terms.clear();
+            break;
+        }
+
+        SeparableTerm term;
+        term.column = svd.matrixU().col(i) * singularValues[i];
+        term.row = svd.matrixV().col(i);
+        terms << term;
+
+        residualEnergy -= pow2(singularValues[i]);
+    }
+
+    return terms;
+}
+
 
 
 
@@ -9,6 +9,7 @@
 
 #include <cstddef>
 #include <Eigen/Core>
+#include <QVector>
 #include "kis_shared.h"
 #include "kritaimage_export.h"
 #include "kis_types.h"
@@ -38,6 +39,27 @@ public:
     static KisConvolutionKernelSP fromQImage(const QImage& image);
     static KisConvolutionKernelSP fromMaskGenerator(KisMaskGenerator *, qreal angle = 0.0);
     static KisConvolutionKernelSP fromMatrix(Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix, qreal offset, qreal factor);
+
+    /**
+     * A rank-1 term of the kernel: the outer product of \p column
+     * (of size height()) and \p row (of size width()).
+     */
+    struct SeparableTerm {
+        Eigen::Matrix<qreal, Eigen::Dynamic, 1> column;
+        Eigen::Matrix<qreal, Eigen::Dynamic, 1> row;
+    };
+
+    /**
+     * Approximates the kernel matrix with a sum of separable terms
+     * using its singular value decomposition. The terms are added
+     * until the relative residual of the approximation (in Frobenius
+     * norm) becomes less than \p tolerance.
+     *
+     * @return the list of terms, or an empty list if the kernel cannot
+     *         be approximated with \p maxTerms terms or less
+     */
+    QVector<SeparableTerm> separableTerms(int maxTerms, qreal tolerance = 1e-4) const;
+
 private:
     struct Private;
     Private* const d;
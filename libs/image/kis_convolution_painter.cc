@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <cfloat>
+#include <cmath>
 
 #include <QBrush>
 #include <QColor>
@@ -20,6 +21,7 @@
 #include <QRect>
 #include <QString>
 #include <QVector>
+#include <QtMath>
 
 #include <kis_debug.h>
 #include <klocalizedstring.h>
@@ -39,6 +41,8 @@
 
 #include "kis_convolution_worker.h"
 #include "kis_convolution_worker_spatial.h"
+#include "kis_convolution_worker_separable.h"
+#include "kis_convolution_worker_line_integral.h"
 
 #include "config_convolution.h"
 
@@ -47,23 +51,102 @@
 #endif
 
 
-bool KisConvolutionPainter::useFFTImplementation(const KisConvolutionKernelSP kernel) const
+namespace {
+
+/**
+ * Kernels smaller than that are always processed by the spatial worker
+ */
+const int SpatialThresholdSize = 5;
+
+/**
+ * The rough cost of the FFT worker per pixel and channel in the units
+ * of "one multiply-add in the spatial domain". A real transform needs
+ * about 2.5 * log2(N) operations per pixel, and the worker does two
+ * of them plus a complex multiplication. The size of the processed
+ * area is not known in advance, so assume a typical patch size.
+ */
+qreal estimateFFTCostPerPixel(const KisConvolutionKernelSP kernel)
+{
+    const qreal paddedPixels = (512.0 + kernel->width()) * (512.0 + kernel->height());
+    return 5.0 * std::log2(paddedPixels) + 6.0;
+}
+
+}
+
+const KisConvolutionPainter::EngineSelection&
+KisConvolutionPainter::selectEngine(const KisConvolutionKernelSP kernel) const
 {
-    bool result = false;
+    /**
+     * The decision needs an SVD of the kernel, and it is usually asked
+     * for twice in a row: by needsTransaction() and then by applyMatrix().
+     * The cache holds a reference to the kernel, so its address cannot
+     * be reused by another kernel while the entry is alive.
+     */
+    if (m_engineSelection.kernel != kernel) {
+        m_engineSelection.separableTerms.clear();
+        m_engineSelection.engine = calculateEngine(kernel, &m_engineSelection.separableTerms);
+        m_engineSelection.kernel = kernel;
+    }
+
+    return m_engineSelection;
+}
+
+KisConvolutionPainter::EnginePreference
+KisConvolutionPainter::calculateEngine(const KisConvolutionKernelSP kernel,
+                                       QVector<KisConvolutionKernel::SeparableTerm> *separableTerms) const
+{
+    auto fetchSeparableTerms = [&] (int maxTerms) {
+        *separableTerms = kernel->separableTerms(maxTerms);
+        return *separableTerms;
+    };
+
+    if (m_enginePreference == SPATIAL) {
+        return SPATIAL;
+    }
 
+    if (m_enginePreference == FFTW) {
 #ifdef HAVE_FFTW3
-    #define THRESHOLD_SIZE 5
+        return FFTW;
+#else
+        return SPATIAL;
+#endif
+    }
+
+    const int kernelSpan = kernel->width() + kernel->height();
+    const int kernelArea = kernel->width() * kernel->height();
+
+    if (m_enginePreference == SEPARABLE) {
+        return !fetchSeparableTerms(kernelArea).isEmpty() ? SEPARABLE : SPATIAL;
+    }
+
+    if (kernel->width() <= SpatialThresholdSize &&
+        kernel->height() <= SpatialThresholdSize) {
+
+        return SPATIAL;
+    }
 
-    result =
-        m_enginePreference == FFTW ||
-        (m_enginePreference == NONE &&
-         (kernel->width() > THRESHOLD_SIZE ||
-          kernel->height() > THRESHOLD_SIZE));
+    /**
+     * Choose the engine with the cheapest estimated cost per pixel. The
+     * separable engine is only useful when the kernel can be represented
+     * with a few terms, so don't even try to decompose it with more terms
+     * than the cost of the fastest of the other engines allows.
+     */
+
+#ifdef HAVE_FFTW3
+    const qreal otherEngineCost = estimateFFTCostPerPixel(kernel);
+    const EnginePreference otherEngine = FFTW;
 #else
-    Q_UNUSED(kernel);
+    const qreal otherEngineCost = kernelArea;
+    const EnginePreference otherEngine = SPATIAL;
 #endif
 
-    return result;
+    const int maxSeparableTerms = qFloor(otherEngineCost / kernelSpan);
+
+    if (maxSeparableTerms > 0 && !fetchSeparableTerms(maxSeparableTerms).isEmpty()) {
+        return SEPARABLE;
+    }
+
+    return otherEngine;
 }
 
 template<class factory>
@@ -73,16 +156,18 @@ KisConvolutionWorker<factory>* KisConvolutionPainter::createWorker(const KisConv
 {
     KisConvolutionWorker<factory> *worker;
 
+    const EngineSelection &selection = selectEngine(kernel);
+    const EnginePreference engine = selection.engine;
+
+    if (engine == SEPARABLE) {
+        worker = new KisConvolutionWorkerSeparable<factory>(painter, progress, selection.separableTerms);
 #ifdef HAVE_FFTW3
-    if (useFFTImplementation(kernel)) {
+    } else if (engine == FFTW) {
         worker = new KisConvolutionWorkerFFT<factory>(painter, progress);
+#endif
     } else {
         worker = new KisConvolutionWorkerSpatial<factory>(painter, progress);
     }
-#else
-    Q_UNUSED(kernel);
-    worker = new KisConvolutionWorkerSpatial<factory>(painter, progress);
-#endif
 
     return worker;
 }
@@ -125,6 +210,27 @@ KisConvolutionPainter::KisConvolutionPainter(KisPaintDeviceSP device, EnginePref
 void KisConvolutionPainter::setEnginePreference(EnginePreference value)
 {
     m_enginePreference = value;
+    m_engineSelection = EngineSelection();
+}
+
+QRect KisConvolutionPainter::repeatDataRect(const KisPaintDeviceSP src, QPoint srcPos, QSize areaSize)
+{
+    /**
+     * We don't use defaultBounds->topLevelWrapRect(), because
+     * the main purpose of this wrapping is "getting expected
+     * results when applying to the layer". If a mask is bigger
+     * than the image, then it should be wrapped around the mask
+     * instead.
+     */
+    const QRect boundsRect = src->defaultBounds()->bounds();
+    const QRect requestedRect = QRect(srcPos, areaSize);
+    QRect dataRect = requestedRect | boundsRect;
+
+    KIS_SAFE_ASSERT_RECOVER(boundsRect != KisDefaultBounds().bounds()) {
+        dataRect = requestedRect | src->exactBounds();
+    }
+
+    return dataRect;
 }
 
 void KisConvolutionPainter::applyMatrix(const KisConvolutionKernelSP kernel, const KisPaintDeviceSP src, QPoint srcPos, QPoint dstPos, QSize areaSize, KisConvolutionBorderOp borderOp)
@@ -141,20 +247,7 @@ void KisConvolutionPainter::applyMatrix(const KisConvolutionKernelSP kernel, con
     // Determine whether we convolve border pixels, or not.
     switch (borderOp) {
     case BORDER_REPEAT: {
-        /**
-         * We don't use defaultBounds->topLevelWrapRect(), because
-         * the main purpose of this wrapping is "getting expected
-         * results when applying to the layer". If a mask is bigger
-         * than the image, then it should be wrapped around the mask
-         * instead.
-         */
-        const QRect boundsRect = src->defaultBounds()->bounds();
-        const QRect requestedRect = QRect(srcPos, areaSize);
-        QRect dataRect = requestedRect | boundsRect;
-
-        KIS_SAFE_ASSERT_RECOVER(boundsRect != KisDefaultBounds().bounds()) {
-            dataRect = requestedRect | src->exactBounds();
-        }
+        const QRect dataRect = repeatDataRect(src, srcPos, areaSize);
 
         /**
          * FIXME: Implementation can return empty destination device
@@ -184,7 +277,35 @@ void KisConvolutionPainter::applyMatrix(const KisConvolutionKernelSP kernel, con
     }
 }
 
+void KisConvolutionPainter::applyLineIntegral(const QPointF &halfLine, const KisPaintDeviceSP src, QPoint srcPos, QPoint dstPos, QSize areaSize, KisConvolutionBorderOp borderOp)
+{
+    if (src->defaultBounds()->wrapAroundMode()) {
+        borderOp = BORDER_IGNORE;
+    }
+
+    switch (borderOp) {
+    case BORDER_REPEAT: {
+        const QRect dataRect = repeatDataRect(src, srcPos, areaSize);
+
+        if (dataRect.isValid()) {
+            KisConvolutionWorkerLineIntegral<RepeatIteratorFactory> worker(this, progressUpdater());
+            worker.execute(halfLine, src, srcPos, dstPos, areaSize, dataRect);
+        }
+        break;
+    }
+    case BORDER_IGNORE:
+    default: {
+        KisConvolutionWorkerLineIntegral<StandardIteratorFactory> worker(this, progressUpdater());
+        worker.execute(halfLine, src, srcPos, dstPos, areaSize, QRect());
+    }
+    }
+}
+
 bool KisConvolutionPainter::needsTransaction(const KisConvolutionKernelSP kernel) const
 {
-    return !useFFTImplementation(kernel);
+    /**
+     * Only the spatial worker writes the result while still reading
+     * the source, all the others load the source completely first.
+     */
+    return selectEngine(kernel).engine == SPATIAL;
 }
@@ -10,6 +10,7 @@
 #include "kis_painter.h"
 #include "kis_image.h"
 #include "kritaimage_export.h"
+#include "kis_convolution_kernel.h"
 
 template<class factory> class KisConvolutionWorker;
 
@@ -38,7 +39,8 @@ public:
     enum EnginePreference {
         NONE,
         SPATIAL,
-        FFTW
+        FFTW,
+        SEPARABLE
     };
 
 
@@ -71,6 +73,19 @@ public:
     void applyMatrix(const KisConvolutionKernelSP kernel, const KisPaintDeviceSP src, QPoint srcPos, QPoint dstPos, QSize areaSize,
                      KisConvolutionBorderOp borderOp = BORDER_REPEAT);
 
+    /**
+     * Averages the pixels along the line segment [-halfLine, halfLine]
+     * centered at every pixel, i.e. applies a "motion blur" kernel.
+     * The segment is rasterized as a digital line and the average is
+     * calculated with running sums, so the cost of the operation does
+     * not depend on the length of the segment.
+     *
+     * The painter reads the pixels in the area grown by \p halfLine
+     * (plus one pixel in the minor direction of the line).
+     */
+    void applyLineIntegral(const QPointF &halfLine, const KisPaintDeviceSP src, QPoint srcPos, QPoint dstPos, QSize areaSize,
+                           KisConvolutionBorderOp borderOp = BORDER_REPEAT);
+
     /**
      * The caller should ask if the painter needs an explicit transaction iff
      * the source and destination devices coincide. Otherwise, the transaction is
@@ -91,9 +106,20 @@ private:
                                                     KisPainter *painter,
                                                     KoUpdater *progress);
 
-     bool useFFTImplementation(const KisConvolutionKernelSP kernel) const;
+     static QRect repeatDataRect(const KisPaintDeviceSP src, QPoint srcPos, QSize areaSize);
+
+     struct EngineSelection {
+         KisConvolutionKernelSP kernel;
+         EnginePreference engine = NONE;
+         QVector<KisConvolutionKernel::SeparableTerm> separableTerms;
+     };
+
+     const EngineSelection& selectEngine(const KisConvolutionKernelSP kernel) const;
+     EnginePreference calculateEngine(const KisConvolutionKernelSP kernel,
+                                      QVector<KisConvolutionKernel::SeparableTerm> *separableTerms) const;
 
 private:
     EnginePreference m_enginePreference;
+    mutable EngineSelection m_engineSelection;
 };
 #endif //KIS_CONVOLUTION_PAINTER_H_
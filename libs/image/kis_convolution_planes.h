@@ -0,0 +1,246 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_CONVOLUTION_PLANES_H
+#define KIS_CONVOLUTION_PLANES_H
+
+#include <vector>
+#include <limits>
+
+#include <QVector>
+
+#include <KoChannelInfo.h>
+
+#include "kis_convolution_worker.h"
+#include "kis_math_toolbox.h"
+#include "kis_assert.h"
+
+/**
+ * A helper for the convolution workers that process the image
+ * as a set of planar double buffers, one per convolved channel.
+ *
+ * The color channels are premultiplied by alpha when loaded, and
+ * divided by the convolved alpha when written back. The planes can be
+ * either owned by the helper's caller as std::vector or be arbitrary
+ * strided buffers, like the FFT worker's transform buffers.
+ */
+template<class _IteratorFactory_>
+class KisConvolutionPlanes
+{
+public:
+    using Plane = std::vector<double>;
+
+    KisConvolutionPlanes(const QList<KoChannelInfo*> &convChannelList, qreal kernelOffset)
+        : m_convChannelList(convChannelList)
+    {
+        KisMathToolbox mathToolbox;
+
+        for (int i = 0; i < m_convChannelList.count(); ++i) {
+            m_minClamp.append(mathToolbox.minChannelValue(m_convChannelList[i]));
+            m_maxClamp.append(mathToolbox.maxChannelValue(m_convChannelList[i]));
+            m_absoluteOffset.append((m_maxClamp[i] - m_minClamp[i]) * kernelOffset);
+
+            if (m_convChannelList[i]->channelType() == KoChannelInfo::ALPHA) {
+                m_alphaCachePos = i;
+                m_alphaRealPos = m_convChannelList[i]->pos();
+            }
+        }
+
+        m_toDoubleFuncPtr.resize(m_convChannelList.count());
+        m_fromDoubleFuncPtr.resize(m_convChannelList.count());
+        m_fromDoubleCheckNullFuncPtr.resize(m_convChannelList.count());
+
+        bool result = mathToolbox.getToDoubleChannelPtr(m_convChannelList, m_toDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleChannelPtr(m_convChannelList, m_fromDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleCheckNullChannelPtr(m_convChannelList, m_fromDoubleCheckNullFuncPtr);
+
+        KIS_ASSERT(result);
+    }
+
+    inline int numChannels() const {
+        return m_convChannelList.size();
+    }
+
+    /**
+     * Reads \p rect of \p src into \p planes. The planes are stored
+     * row by row with the stride equal to rect.width().
+     */
+    void readFromDevice(KisPaintDeviceSP src,
+                        const QRect &rect,
+                        const QRect &dataRect,
+                        std::vector<Plane> &planes) const
+    {
+        planes.resize(numChannels());
+
+        QVector<double*> planePtrs;
+        for (Plane &plane : planes) {
+            plane.resize(size_t(rect.width()) * rect.height());
+            planePtrs << plane.data();
+        }
+
+        readFromDevice(src, rect, dataRect, planePtrs, rect.width());
+    }
+
+    /**
+     * Reads \p rect of \p src into externally allocated buffers, one
+     * per channel. The rows of the buffers are \p rowStride values
+     * apart, which lets the FFT worker read straight into its padded
+     * in-place transform buffers.
+     */
+    void readFromDevice(KisPaintDeviceSP src,
+                        const QRect &rect,
+                        const QRect &dataRect,
+                        const QVector<double*> &planes,
+                        int rowStride) const
+    {
+        const int channelCount = numChannels();
+        KIS_SAFE_ASSERT_RECOVER_RETURN(planes.size() == channelCount);
+
+        typename _IteratorFactory_::HLineConstIterator hitSrc =
+            _IteratorFactory_::createHLineConstIterator(src,
+                                                        rect.x(), rect.y(), rect.width(),
+                                                        dataRect);
+
+        for (int y = 0; y < rect.height(); ++y) {
+            const size_t rowOffset = size_t(y) * rowStride;
+
+            for (int x = 0; x < rect.width(); ++x) {
+                const quint8 *data = hitSrc->oldRawData();
+                const size_t index = rowOffset + x;
+
+                // no alpha is a rare case, so just multiply by 1.0 in that case
+                const double alphaValue = m_alphaRealPos >= 0 ?
+                    m_toDoubleFuncPtr[m_alphaCachePos](data, m_alphaRealPos) : 1.0;
+
+                for (int k = 0; k < channelCount; ++k) {
+                    if (k != m_alphaCachePos) {
+                        const quint32 channelPos = m_convChannelList[k]->pos();
+                        planes[k][index] = m_toDoubleFuncPtr[k](data, channelPos) * alphaValue;
+                    } else {
+                        planes[k][index] = alphaValue;
+                    }
+                }
+
+                hitSrc->nextPixel();
+            }
+
+            hitSrc->nextRow();
+        }
+    }
+
+    /**
+     * Writes \p planes into \p rect of \p dst. Every value is multiplied
+     * by \p scale before being written.
+     */
+    void writeToDevice(KisPaintDeviceSP dst,
+                       const QRect &rect,
+                       const QRect &dataRect,
+                       const std::vector<Plane> &planes,
+                       qreal scale) const
+    {
+        QVector<const double*> planePtrs;
+        for (const Plane &plane : planes) {
+            planePtrs << plane.data();
+        }
+
+        writeToDevice(dst, rect, dataRect, planePtrs, rect.width(), scale);
+    }
+
+    /**
+     * Writes externally allocated buffers with rows \p rowStride
+     * values apart into \p rect of \p dst.
+     */
+    void writeToDevice(KisPaintDeviceSP dst,
+                       const QRect &rect,
+                       const QRect &dataRect,
+                       const QVector<const double*> &planes,
+                       int rowStride,
+                       qreal scale) const
+    {
+        const int channelCount = numChannels();
+        KIS_SAFE_ASSERT_RECOVER_RETURN(planes.size() == channelCount);
+
+        typename _IteratorFactory_::HLineIterator hitDst =
+            _IteratorFactory_::createHLineIterator(dst,
+                                                   rect.x(), rect.y(), rect.width(),
+                                                   dataRect);
+
+        for (int y = 0; y < rect.height(); ++y) {
+            const size_t rowOffset = size_t(y) * rowStride;
+
+            for (int x = 0; x < rect.width(); ++x) {
+                quint8 *dstPtr = hitDst->rawData();
+                const size_t index = rowOffset + x;
+
+                if (m_alphaCachePos >= 0) {
+                    bool alphaIsNullInDstSpace = false;
+
+                    qreal alphaValue = planes[m_alphaCachePos][index] * scale + m_absoluteOffset[m_alphaCachePos];
+                    limitValue(&alphaValue, m_minClamp[m_alphaCachePos], m_maxClamp[m_alphaCachePos]);
+                    m_fromDoubleCheckNullFuncPtr[m_alphaCachePos](dstPtr, m_alphaRealPos, alphaValue, &alphaIsNullInDstSpace);
+
+                    if (!alphaIsNullInDstSpace &&
+                        alphaValue > std::numeric_limits<qreal>::epsilon()) {
+
+                        const qreal alphaValueInv = 1.0 / alphaValue;
+
+                        for (int k = 0; k < channelCount; ++k) {
+                            if (k != m_alphaCachePos) {
+                                writeOneChannel(dstPtr, k, planes[k][index] * scale * alphaValueInv);
+                            }
+                        }
+                    } else {
+                        for (int k = 0; k < channelCount; ++k) {
+                            if (k != m_alphaCachePos) {
+                                m_fromDoubleFuncPtr[k](dstPtr, m_convChannelList[k]->pos(), 0.0);
+                            }
+                        }
+                    }
+                } else {
+                    for (int k = 0; k < channelCount; ++k) {
+                        writeOneChannel(dstPtr, k, planes[k][index] * scale);
+                    }
+                }
+
+                hitDst->nextPixel();
+            }
+
+            hitDst->nextRow();
+        }
+    }
+
+private:
+    inline void limitValue(qreal *value, qreal lowBound, qreal highBound) const {
+        if (*value > highBound) {
+            *value = highBound;
+        } else if (!(*value >= lowBound)) {  // value < lowBound or value == NaN
+            // IEEE compliant comparisons with NaN are always false
+            *value = lowBound;
+        }
+    }
+
+    inline void writeOneChannel(quint8 *dstPtr, int channel, qreal value) const {
+        value += m_absoluteOffset[channel];
+        limitValue(&value, m_minClamp[channel], m_maxClamp[channel]);
+        m_fromDoubleFuncPtr[channel](dstPtr, m_convChannelList[channel]->pos(), value);
+    }
+
+private:
+    QList<KoChannelInfo*> m_convChannelList;
+
+    QVector<qreal> m_minClamp;
+    QVector<qreal> m_maxClamp;
+    QVector<qreal> m_absoluteOffset;
+
+    QVector<PtrToDouble> m_toDoubleFuncPtr;
+    QVector<PtrFromDouble> m_fromDoubleFuncPtr;
+    QVector<PtrFromDoubleCheckNull> m_fromDoubleCheckNullFuncPtr;
+
+    int m_alphaCachePos {-1};
+    int m_alphaRealPos {-1};
+};
+
+#endif // KIS_CONVOLUTION_PLANES_H
@@ -13,7 +13,7 @@
 #include <KoChannelInfo.h>
 
 #include "kis_convolution_worker.h"
-#include "kis_math_toolbox.h"
+#include "kis_convolution_planes.h"
 
 #include <QMutex>
 #include <QVector>
@@ -37,6 +37,8 @@ QMutex KisConvolutionWorkerFFTLock::fftwMutex;
 template<class _IteratorFactory_>
 class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
 {
+    using Planes = KisConvolutionPlanes<_IteratorFactory_>;
+
 public:
     KisConvolutionWorkerFFT(KisPainter *painter, KoUpdater *progress)
         : KisConvolutionWorker<_IteratorFactory_>(painter, progress)
@@ -101,16 +103,21 @@ public:
         const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
         const double fftScale = 1.0 / (m_fftHeight * m_fftWidth) / kernelFactor;
 
-        FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
-        int cacheRowStride = m_fftWidth + m_extraMem;
+        Planes planes(convChannelList, kernel->offset());
+        const int cacheRowStride = m_fftWidth + m_extraMem;
+
+        QVector<double*> cachePtrs;
+        for (fftw_complex *channel : m_channelFFT) {
+            cachePtrs << reinterpret_cast<double*>(channel);
+        }
 
-        fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
-                                  m_fftWidth,
-                                  m_fftHeight),
-                            cacheRowStride,
-                            info, dataRect);
+        planes.readFromDevice(src,
+                              QRect(srcPos.x() - halfKernelWidth,
+                                    srcPos.y() - halfKernelHeight,
+                                    m_fftWidth,
+                                    m_fftHeight),
+                              dataRect,
+                              cachePtrs, cacheRowStride);
 
         addToProgress(10);
         if (isInterrupted()) return;
@@ -149,264 +156,21 @@ public:
         KisConvolutionWorkerFFTLock::fftwMutex.unlock();
 
 
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
-                            info, dataRect);
-
-        addToProgress(20);
-        cleanUp();
-    }
-
-    struct FFTInfo {
-        FFTInfo(qreal _fftScale,
-                const QList<KoChannelInfo*> &_convChannelList,
-                const KisConvolutionKernelSP kernel,
-                const KoColorSpace */*colorSpace*/)
-            : fftScale(_fftScale),
-              convChannelList(_convChannelList)
-        {
-            KisMathToolbox mathToolbox;
-
-            for (int i = 0; i < convChannelList.count(); ++i) {
-                minClamp.append(mathToolbox.minChannelValue(convChannelList[i]));
-                maxClamp.append(mathToolbox.maxChannelValue(convChannelList[i]));
-                absoluteOffset.append((maxClamp[i] - minClamp[i]) * kernel->offset());
-
-                if (convChannelList[i]->channelType() == KoChannelInfo::ALPHA) {
-                    alphaCachePos = i;
-                    alphaRealPos = convChannelList[i]->pos();
-                }
-            }
-
-            toDoubleFuncPtr.resize(convChannelList.count());
-            fromDoubleFuncPtr.resize(convChannelList.count());
-            fromDoubleCheckNullFuncPtr.resize(convChannelList.count());
-
-            bool result = mathToolbox.getToDoubleChannelPtr(convChannelList, toDoubleFuncPtr);
-            result &= mathToolbox.getFromDoubleChannelPtr(convChannelList, fromDoubleFuncPtr);
-            result &= mathToolbox.getFromDoubleCheckNullChannelPtr(convChannelList, fromDoubleCheckNullFuncPtr);
-
-            KIS_ASSERT(result);
-        }
-
-        inline int numChannels() const {
-            return convChannelList.size();
-        }
-
-
-        QVector<qreal> minClamp;
-        QVector<qreal> maxClamp;
-        QVector<qreal> absoluteOffset;
-
-        qreal fftScale {0.0};
-        QList<KoChannelInfo*> convChannelList;
-
-        QVector<PtrToDouble> toDoubleFuncPtr;
-        QVector<PtrFromDouble> fromDoubleFuncPtr;
-        QVector<PtrFromDoubleCheckNull> fromDoubleCheckNullFuncPtr;
-
-        int alphaCachePos {-1};
-        int alphaRealPos {-1};
-    };
-
-    void fillCacheFromDevice(KisPaintDeviceSP src,
-                             const QRect &rect,
-                             const int cacheRowStride,
-                             const FFTInfo &info,
-                             const QRect &dataRect) {
-
-        typename _IteratorFactory_::HLineConstIterator hitSrc =
-            _IteratorFactory_::createHLineConstIterator(src,
-                                                        rect.x(), rect.y(), rect.width(),
-                                                        dataRect);
-
-        const int channelCount = info.numChannels();
-        QVector<double*> channelPtr(channelCount);
-        const auto channelPtrBegin = channelPtr.begin();
-        const auto channelPtrEnd = channelPtr.end();
-
-        auto iFFt = m_channelFFT.constBegin();
-        for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
-            *i = (double*)*iFFt;
-        }
-
-        // prepare cache, reused in all loops
-        QVector<double*> cacheRowStart(channelCount);
-        const auto cacheRowStartBegin = cacheRowStart.begin();
-
-        for (int y = 0; y < rect.height(); ++y) {
-            // cache current channelPtr in cacheRowStart
-            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(double*));
-
-            for (int x = 0; x < rect.width(); ++x) {
-                const quint8 *data = hitSrc->oldRawData();
-
-                // no alpha is a rare case, so just multiply by 1.0 in that case
-                double alphaValue = info.alphaRealPos >= 0 ?
-                    info.toDoubleFuncPtr[info.alphaCachePos](data, info.alphaRealPos) : 1.0;
-                int k = 0;
-                for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++k) {
-                    if (k != info.alphaCachePos) {
-                        const quint32 channelPos = info.convChannelList[k]->pos();
-                        **i = info.toDoubleFuncPtr[k](data, channelPos) * alphaValue;
-                    } else {
-                        **i = alphaValue;
-                    }
-
-                    ++(*i);
-                }
-
-                hitSrc->nextPixel();
-            }
-
-            auto iRowStart = cacheRowStartBegin;
-            for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iRowStart) {
-                *i = *iRowStart + cacheRowStride;
-            }
-
-            hitSrc->nextRow();
-        }
-
-    }
-
-    inline void limitValue(qreal *value, qreal lowBound, qreal highBound) {
-        if (*value > highBound) {
-            *value = highBound;
-        } else if (!(*value >= lowBound)) {  // value < lowBound or value == NaN
-            // IEEE compliant comparisons with NaN are always false
-            *value = lowBound;
-        }
-    }
-
-    inline qreal writeAlphaFromCache(quint8* dstPtr,
-                                     const quint32 channel,
-                                     const FFTInfo &info,
-                                     double* channelValuePtr,
-                                     bool *dstValueIsNull) {
-        qreal channelPixelValue;
-
-        channelPixelValue = *channelValuePtr * info.fftScale + info.absoluteOffset[channel];
-        limitValue(&channelPixelValue, info.minClamp[channel], info.maxClamp[channel]);
-        info.fromDoubleCheckNullFuncPtr[channel](dstPtr, info.convChannelList[channel]->pos(), channelPixelValue, dstValueIsNull);
-
-        return channelPixelValue;
-    }
-
-    template <bool additionalMultiplierActive>
-    inline qreal writeOneChannelFromCache(quint8* dstPtr,
-                                          const quint32 channel,
-                                          const FFTInfo &info,
-                                          double* channelValuePtr,
-                                          const qreal additionalMultiplier = 0.0) {
-        qreal channelPixelValue;
-
-        if (additionalMultiplierActive) {
-            channelPixelValue = *channelValuePtr * info.fftScale * additionalMultiplier + info.absoluteOffset[channel];
-        } else {
-            channelPixelValue = *channelValuePtr * info.fftScale + info.absoluteOffset[channel];
-        }
-
-        limitValue(&channelPixelValue, info.minClamp[channel], info.maxClamp[channel]);
-
-        info.fromDoubleFuncPtr[channel](dstPtr, info.convChannelList[channel]->pos(), channelPixelValue);
-
-        return channelPixelValue;
-    }
-
-    void writeResultToDevice(const QRect &rect,
-                             const int cacheRowStride,
-                             const int halfKernelWidth,
-                             const int halfKernelHeight,
-                             const FFTInfo &info,
-                             const QRect &dataRect) {
-
-        typename _IteratorFactory_::HLineIterator hitDst =
-            _IteratorFactory_::createHLineIterator(this->m_painter->device(),
-                                                   rect.x(), rect.y(), rect.width(),
-                                                   dataRect);
-
-        int initialOffset = cacheRowStride * halfKernelHeight + halfKernelWidth;
-
-        const int channelCount = info.numChannels();
-        QVector<double*> channelPtr(channelCount);
-        const auto channelPtrBegin = channelPtr.begin();
-        const auto channelPtrEnd = channelPtr.end();
+        // the result of the convolution is shifted by the kernel's half size
+        const int resultOffset = cacheRowStride * halfKernelHeight + halfKernelWidth;
 
-        auto iFFt = m_channelFFT.constBegin();
-        for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
-            *i = (double*)*iFFt + initialOffset;
+        QVector<const double*> resultPtrs;
+        for (double *ptr : cachePtrs) {
+            resultPtrs << ptr + resultOffset;
         }
 
-        // prepare cache, reused in all loops
-        QVector<double*> cacheRowStart(channelCount);
-        const auto cacheRowStartBegin = cacheRowStart.begin();
-
-        for (int y = 0; y < rect.height(); ++y) {
-            // cache current channelPtr in cacheRowStart
-            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(double*));
-
-            for (int x = 0; x < rect.width(); ++x) {
-                quint8 *dstPtr = hitDst->rawData();
-
-                if (info.alphaCachePos >= 0) {
-                    bool alphaIsNullInDstSpace = false;
-
-                    qreal alphaValue =
-                        writeAlphaFromCache(dstPtr,
-                                            info.alphaCachePos,
-                                            info,
-                                            channelPtr.at(info.alphaCachePos),
-                                            &alphaIsNullInDstSpace);
-
-                    if (!alphaIsNullInDstSpace &&
-                        alphaValue > std::numeric_limits<qreal>::epsilon()) {
-
-                        qreal alphaValueInv = 1.0 / alphaValue;
-
-                        int k = 0;
-                        for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++k) {
-                            if (k != info.alphaCachePos) {
-                                writeOneChannelFromCache<true>(dstPtr,
-                                                               k,
-                                                               info,
-                                                               *i,
-                                                               alphaValueInv);
-                            }
-                            ++(*i);
-                        }
-                    } else {
-                        int k = 0;
-                        for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++k) {
-                            if (k != info.alphaCachePos) {
-                                info.fromDoubleFuncPtr[k](dstPtr,
-                                        info.convChannelList[k]->pos(),
-                                        0.0);
-                            }
-                            ++(*i);
-                        }
-                    }
-                } else {
-                    int k = 0;
-                    for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++k) {
-                        writeOneChannelFromCache<false>(dstPtr,
-                                                        k,
-                                                        info,
-                                                        *i);
-                       ++(*i);
-                    }
-                }
-
-                hitDst->nextPixel();
-            }
-
-            auto iRowStart = cacheRowStartBegin;
-            for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iRowStart) {
-                *i = *iRowStart + cacheRowStride;
-            }
-
-            hitDst->nextRow();
-        }
+        planes.writeToDevice(this->m_painter->device(),
+                             QRect(dstPos, areaSize),
+                             dataRect,
+                             resultPtrs, cacheRowStride, fftScale);
 
+        addToProgress(20);
+        cleanUp();
     }
 
 private:
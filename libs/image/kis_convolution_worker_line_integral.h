@@ -0,0 +1,228 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_CONVOLUTION_WORKER_LINE_INTEGRAL_H
+#define KIS_CONVOLUTION_WORKER_LINE_INTEGRAL_H
+
+#include <QtConcurrentMap>
+#include <QPointF>
+#include <QtMath>
+
+#include "kis_convolution_worker.h"
+#include "kis_convolution_planes.h"
+
+/**
+ * Averages the image along a line segment (a "motion blur" kernel)
+ * using running sums.
+ *
+ * The image is traversed along the family of digital lines parallel to
+ * the segment. Every pixel belongs to exactly one line of the family, and
+ * the result for the pixel is the average of the 2 * K + 1 pixels of its
+ * line centered at it, where K is the length of the half-segment along
+ * its major axis. The sum is updated incrementally when moving along the
+ * line, so the cost per pixel does not depend on the length of the
+ * segment.
+ */
+template<class _IteratorFactory_>
+class KisConvolutionWorkerLineIntegral
+{
+    using Planes = KisConvolutionPlanes<_IteratorFactory_>;
+    using Plane = typename Planes::Plane;
+
+public:
+    KisConvolutionWorkerLineIntegral(KisPainter *painter, KoUpdater *progress)
+        : m_painter(painter),
+          m_progress(progress)
+    {
+    }
+
+    /**
+     * @param halfLine the vector from the center of the segment to its end
+     */
+    void execute(const QPointF &halfLine,
+                 const KisPaintDeviceSP src,
+                 QPoint srcPos,
+                 QPoint dstPos,
+                 QSize areaSize,
+                 const QRect &dataRect)
+    {
+        if (areaSize.isEmpty()) return;
+
+        m_xMajor = qAbs(halfLine.x()) >= qAbs(halfLine.y());
+
+        const qreal major = m_xMajor ? halfLine.x() : halfLine.y();
+        const qreal minor = m_xMajor ? halfLine.y() : halfLine.x();
+
+        m_halfLength = qRound(qAbs(major));
+        if (m_halfLength <= 0) return;
+
+        m_slope = minor / major;
+        m_minorHalfLength = qCeil(m_halfLength * qAbs(m_slope)) + 1;
+
+        m_majorSize = m_xMajor ? areaSize.width() : areaSize.height();
+        m_minorSize = m_xMajor ? areaSize.height() : areaSize.width();
+
+        if (m_progress) {
+            m_progress->setProgress(0);
+        }
+
+        const QRect cacheRect = m_xMajor ?
+            QRect(srcPos, areaSize).adjusted(-m_halfLength, -m_minorHalfLength, m_halfLength, m_minorHalfLength) :
+            QRect(srcPos, areaSize).adjusted(-m_minorHalfLength, -m_halfLength, m_minorHalfLength, m_halfLength);
+
+        m_cacheWidth = cacheRect.width();
+
+        /**
+         * The minor-axis offset of the digital line at every
+         * major-axis position of the cache
+         */
+        m_lineOffsets.resize(m_majorSize + 2 * m_halfLength);
+        for (int u = -m_halfLength; u < m_majorSize + m_halfLength; u++) {
+            m_lineOffsets[u + m_halfLength] = qRound(u * m_slope);
+        }
+
+        Planes planes(convolvableChannelList(src), 0.0);
+
+        std::vector<Plane> srcPlanes;
+        planes.readFromDevice(src, cacheRect, dataRect, srcPlanes);
+
+        if (m_progress) {
+            m_progress->setProgress(10);
+            if (m_progress->interrupted()) return;
+        }
+
+        std::vector<Plane> dstPlanes(planes.numChannels());
+
+        QVector<int> channels;
+        for (int i = 0; i < planes.numChannels(); i++) {
+            channels << i;
+        }
+
+        QtConcurrent::blockingMap(channels,
+            [&] (int channel) {
+                integratePlane(srcPlanes[channel], dstPlanes[channel], areaSize);
+
+                // free the memory as soon as possible
+                Plane().swap(srcPlanes[channel]);
+            });
+
+        if (m_progress) {
+            m_progress->setProgress(90);
+            if (m_progress->interrupted()) return;
+        }
+
+        planes.writeToDevice(m_painter->device(),
+                             QRect(dstPos, areaSize), dataRect,
+                             dstPlanes, 1.0 / (2 * m_halfLength + 1));
+
+        if (m_progress) {
+            m_progress->setProgress(100);
+        }
+    }
+
+private:
+    QList<KoChannelInfo *> convolvableChannelList(const KisPaintDeviceSP src)
+    {
+        QBitArray painterChannelFlags = m_painter->channelFlags();
+        if (painterChannelFlags.isEmpty()) {
+            painterChannelFlags = QBitArray(src->colorSpace()->channelCount(), true);
+        }
+
+        const QList<KoChannelInfo *> channelInfo = src->colorSpace()->channels();
+        QList<KoChannelInfo *> convChannelList;
+
+        for (qint32 c = 0; c < channelInfo.count(); ++c) {
+            if (painterChannelFlags.testBit(c)) {
+                convChannelList.append(channelInfo[c]);
+            }
+        }
+
+        return convChannelList;
+    }
+
+    inline int lineOffset(int u) const {
+        return m_lineOffsets[u + m_halfLength];
+    }
+
+    inline double cacheValue(const Plane &plane, int u, int v) const {
+        // (u, v) are the coordinates relative to the processed area
+        u += m_halfLength;
+        v += m_minorHalfLength;
+
+        return m_xMajor ?
+            plane[size_t(v) * m_cacheWidth + u] :
+            plane[size_t(u) * m_cacheWidth + v];
+    }
+
+    void integratePlane(const Plane &src, Plane &dst, const QSize &areaSize) const
+    {
+        dst.assign(size_t(areaSize.width()) * areaSize.height(), 0.0);
+
+        auto dstValue = [&] (int u, int v) -> double& {
+            return m_xMajor ?
+                dst[size_t(v) * areaSize.width() + u] :
+                dst[size_t(u) * areaSize.width() + v];
+        };
+
+        const int firstOffset = lineOffset(0);
+        const int lastOffset = lineOffset(m_majorSize - 1);
+
+        const int minLine = -qMax(firstOffset, lastOffset);
+        const int maxLine = m_minorSize - 1 - qMin(firstOffset, lastOffset);
+
+        for (int line = minLine; line <= maxLine; line++) {
+            // find the part of the line lying inside the processed area
+            int firstU = -1;
+            int lastU = -1;
+
+            for (int u = 0; u < m_majorSize; u++) {
+                const int v = line + lineOffset(u);
+                if (v >= 0 && v < m_minorSize) {
+                    if (firstU < 0) {
+                        firstU = u;
+                    }
+                    lastU = u;
+                } else if (firstU >= 0) {
+                    break;
+                }
+            }
+
+            if (firstU < 0) continue;
+
+            double sum = 0.0;
+            for (int u = firstU - m_halfLength; u <= firstU + m_halfLength; u++) {
+                sum += cacheValue(src, u, line + lineOffset(u));
+            }
+
+            for (int u = firstU; u <= lastU; u++) {
+                if (u > firstU) {
+                    const int removedU = u - m_halfLength - 1;
+                    const int addedU = u + m_halfLength;
+
+                    sum -= cacheValue(src, removedU, line + lineOffset(removedU));
+                    sum += cacheValue(src, addedU, line + lineOffset(addedU));
+                }
+
+                dstValue(u, line + lineOffset(u)) = sum;
+            }
+        }
+    }
+
+private:
+    KisPainter *m_painter;
+    KoUpdater *m_progress;
+
+    bool m_xMajor {true};
+    int m_halfLength {0};
+    int m_minorHalfLength {0};
+    qreal m_slope {0.0};
+    int m_majorSize {0};
+    int m_minorSize {0};
+    int m_cacheWidth {0};
+    std::vector<int> m_lineOffsets;
+};
+
+#endif // KIS_CONVOLUTION_WORKER_LINE_INTEGRAL_H
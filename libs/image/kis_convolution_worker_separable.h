@@ -0,0 +1,172 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_CONVOLUTION_WORKER_SEPARABLE_H
+#define KIS_CONVOLUTION_WORKER_SEPARABLE_H
+
+#include <QtConcurrentMap>
+
+#include "kis_convolution_worker.h"
+#include "kis_convolution_planes.h"
+#include "kis_convolution_kernel.h"
+#include "kis_selection.h"
+
+/**
+ * Applies a kernel that has been decomposed into a small number of
+ * separable terms (see KisConvolutionKernel::separableTerms()). Every
+ * term is applied as a horizontal and a vertical 1D pass over the
+ * planar double representation of the image, so the cost per pixel is
+ * proportional to numTerms * (kernel width + kernel height) instead of
+ * kernel width * kernel height.
+ *
+ * The kernel is applied with the same orientation as in
+ * KisConvolutionWorkerFFT, so the two workers are interchangeable for
+ * big kernels.
+ */
+template<class _IteratorFactory_>
+class KisConvolutionWorkerSeparable : public KisConvolutionWorker<_IteratorFactory_>
+{
+    using Planes = KisConvolutionPlanes<_IteratorFactory_>;
+    using Plane = typename Planes::Plane;
+
+public:
+    KisConvolutionWorkerSeparable(KisPainter *painter, KoUpdater *progress,
+                                  const QVector<KisConvolutionKernel::SeparableTerm> &terms)
+        : KisConvolutionWorker<_IteratorFactory_>(painter, progress),
+          m_terms(terms)
+    {
+    }
+
+    void execute(const KisConvolutionKernelSP kernel,
+                 const KisPaintDeviceSP src,
+                 QPoint srcPos,
+                 QPoint dstPos,
+                 QSize areaSize,
+                 const QRect &dataRect) override
+    {
+        // Make the area we cover as small as possible
+        if (this->m_painter->selection()) {
+            QRect r = this->m_painter->selection()->selectedRect().intersected(QRect(srcPos, areaSize));
+            dstPos += r.topLeft() - srcPos;
+            srcPos = r.topLeft();
+            areaSize = r.size();
+        }
+
+        if (areaSize.isEmpty() || m_terms.isEmpty()) return;
+
+        if (this->m_progress) {
+            this->m_progress->setProgress(0);
+        }
+
+        const int kw = kernel->width();
+        const int kh = kernel->height();
+        const int halfKernelWidth = (kw - 1) / 2;
+        const int halfKernelHeight = (kh - 1) / 2;
+
+        const QRect cacheRect(srcPos.x() - (kw - 1 - halfKernelWidth),
+                              srcPos.y() - (kh - 1 - halfKernelHeight),
+                              areaSize.width() + kw - 1,
+                              areaSize.height() + kh - 1);
+
+        Planes planes(this->convolvableChannelList(src), kernel->offset());
+
+        std::vector<Plane> srcPlanes;
+        planes.readFromDevice(src, cacheRect, dataRect, srcPlanes);
+
+        if (this->m_progress) {
+            this->m_progress->setProgress(10);
+            if (this->m_progress->interrupted()) return;
+        }
+
+        std::vector<Plane> dstPlanes(planes.numChannels());
+
+        QVector<int> channels;
+        for (int i = 0; i < planes.numChannels(); i++) {
+            channels << i;
+        }
+
+        QtConcurrent::blockingMap(channels,
+            [&] (int channel) {
+                convolvePlane(srcPlanes[channel], cacheRect.size(),
+                              dstPlanes[channel], areaSize);
+
+                // free the memory as soon as possible
+                Plane().swap(srcPlanes[channel]);
+            });
+
+        if (this->m_progress) {
+            this->m_progress->setProgress(90);
+            if (this->m_progress->interrupted()) return;
+        }
+
+        const qreal scale = kernel->factor() ? 1.0 / kernel->factor() : 1.0;
+
+        planes.writeToDevice(this->m_painter->device(),
+                             QRect(dstPos, areaSize), dataRect,
+                             dstPlanes, scale);
+
+        if (this->m_progress) {
+            this->m_progress->setProgress(100);
+        }
+    }
+
+private:
+    void convolvePlane(const Plane &src, const QSize &srcSize,
+                       Plane &dst, const QSize &dstSize) const
+    {
+        const int srcWidth = srcSize.width();
+        const int dstWidth = dstSize.width();
+        const int dstHeight = dstSize.height();
+
+        dst.assign(size_t(dstWidth) * dstHeight, 0.0);
+
+        // the result of the horizontal pass, it has all the rows of the source
+        std::vector<double> interm(size_t(dstWidth) * srcSize.height());
+
+        for (const KisConvolutionKernel::SeparableTerm &term : m_terms) {
+            const int kw = term.row.size();
+            const int kh = term.column.size();
+
+            /**
+             * Both passes apply the reversed vectors, which makes the
+             * worker compute a convolution, not a correlation, exactly
+             * like the FFT one does.
+             */
+
+            for (int y = 0; y < srcSize.height(); y++) {
+                const double *srcRow = src.data() + size_t(y) * srcWidth;
+                double *intermRow = interm.data() + size_t(y) * dstWidth;
+
+                for (int x = 0; x < dstWidth; x++) {
+                    double value = 0.0;
+                    for (int i = 0; i < kw; i++) {
+                        value += term.row[kw - 1 - i] * srcRow[x + i];
+                    }
+                    intermRow[x] = value;
+                }
+            }
+
+            for (int i = 0; i < kh; i++) {
+                const double coeff = term.column[kh - 1 - i];
+                if (coeff == 0.0) continue;
+
+                for (int y = 0; y < dstHeight; y++) {
+                    const double *intermRow = interm.data() + size_t(y + i) * dstWidth;
+                    double *dstRow = dst.data() + size_t(y) * dstWidth;
+
+                    for (int x = 0; x < dstWidth; x++) {
+                        dstRow[x] += coeff * intermRow[x];
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    QVector<KisConvolutionKernel::SeparableTerm> m_terms;
+};
+
+#endif // KIS_CONVOLUTION_WORKER_SEPARABLE_H
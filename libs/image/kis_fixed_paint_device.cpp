@@ -6,6 +6,8 @@
  */
 #include "kis_fixed_paint_device.h"
 
+#include <algorithm>
+
 #include <KoColorSpaceRegistry.h>
 #include <KoColor.h>
 #include <KoColorModelStandardIds.h>
@@ -316,27 +318,26 @@ void KisFixedPaintDevice::mirror(bool horizontal, bool vertical)
     int w = m_bounds.width();
     int h = m_bounds.height();
 
+    // the mirroring is done in-place, so that mirrored dabs
+    // would not need any temporary buffers
+
     if (horizontal){
         int rowSize = pixelSize * w;
 
-        quint8 * dabPointer = data();
-        quint8 * row = new quint8[ rowSize ];
-        quint8 * mirror = 0;
+        quint8 * rowPointer = data();
 
         for (int y = 0; y < h ; y++){
-            // TODO: implement better flipping of the data
-
-            memcpy(row, dabPointer, rowSize);
-            mirror = row;
-            mirror += (w-1) * pixelSize;
-            for (int x = 0; x < w; x++){
-                memcpy(dabPointer,mirror,pixelSize);
-                dabPointer += pixelSize;
-                mirror -= pixelSize;
+            quint8 *left = rowPointer;
+            quint8 *right = rowPointer + (w - 1) * pixelSize;
+
+            while (left < right) {
+                std::swap_ranges(left, left + pixelSize, right);
+                left += pixelSize;
+                right -= pixelSize;
             }
-        }
 
-        delete [] row;
+            rowPointer += rowSize;
+        }
     }
 
     if (vertical){
@@ -345,18 +346,13 @@ void KisFixedPaintDevice::mirror(bool horizontal, bool vertical)
 
         quint8 * startRow = data();
         quint8 * endRow = data() + (h-1) * w * pixelSize;
-        quint8 * row = new quint8[ rowSize ];
 
         for (int y = 0; y < rowsToMove; y++){
-            memcpy(row, startRow, rowSize);
-            memcpy(startRow, endRow, rowSize);
-            memcpy(endRow, row, rowSize);
+            std::swap_ranges(startRow, startRow + rowSize, endRow);
 
             startRow += rowSize;
             endRow -= rowSize;
         }
-
-        delete [] row;
     }
 
 }
@@ -22,6 +22,10 @@
 #include <resources/KoPattern.h>
 #include "kis_selection.h"
 
+#include <QScopedPointer>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <KisSequentialIteratorProgress.h>
 #include "kis_image.h"
 #include "kis_random_accessor_ng.h"
@@ -32,378 +36,51 @@
 #include "KoMixColorsOp.h"
 #include <KisDitherOp.h>
 #include <KoCachedGradient.h>
+#include "KisGradientShapeEvaluatorFactory.h"
 
 namespace
 {
 
-class LinearGradientStrategy : public KisGradientShapeStrategy
-{
-
-public:
-    LinearGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
-
-    double valueAt(double x, double y) const override;
-
-protected:
-    double m_normalisedVectorX;
-    double m_normalisedVectorY;
-    double m_vectorLength;
-};
-
-LinearGradientStrategy::LinearGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-        : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd)
-{
-    double dx = gradientVectorEnd.x() - gradientVectorStart.x();
-    double dy = gradientVectorEnd.y() - gradientVectorStart.y();
-
-    m_vectorLength = sqrt((dx * dx) + (dy * dy));
-
-    if (m_vectorLength < DBL_EPSILON) {
-        m_normalisedVectorX = 0;
-        m_normalisedVectorY = 0;
-    } else {
-        m_normalisedVectorX = dx / m_vectorLength;
-        m_normalisedVectorY = dy / m_vectorLength;
-    }
-}
-
-double LinearGradientStrategy::valueAt(double x, double y) const
-{
-    double vx = x - m_gradientVectorStart.x();
-    double vy = y - m_gradientVectorStart.y();
-
-    // Project the vector onto the normalised gradient vector.
-    double t = vx * m_normalisedVectorX + vy * m_normalisedVectorY;
-
-    if (m_vectorLength < DBL_EPSILON) {
-        t = 0;
-    } else {
-        // Scale to 0 to 1 over the gradient vector length.
-        t /= m_vectorLength;
-    }
-
-    return t;
-}
-
-
-class BiLinearGradientStrategy : public LinearGradientStrategy
-{
-
-public:
-    BiLinearGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
-
-    double valueAt(double x, double y) const override;
-};
-
-BiLinearGradientStrategy::BiLinearGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-        : LinearGradientStrategy(gradientVectorStart, gradientVectorEnd)
-{
-}
-
-double BiLinearGradientStrategy::valueAt(double x, double y) const
-{
-    double t = LinearGradientStrategy::valueAt(x, y);
-
-    // Reflect
-    if (t < -DBL_EPSILON) {
-        t = -t;
-    }
-
-    return t;
-}
-
-
-class RadialGradientStrategy : public KisGradientShapeStrategy
-{
-
-public:
-    RadialGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
-
-    double valueAt(double x, double y) const override;
-
-protected:
-    double m_radius;
-};
-
-RadialGradientStrategy::RadialGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-        : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd)
-{
-    double dx = gradientVectorEnd.x() - gradientVectorStart.x();
-    double dy = gradientVectorEnd.y() - gradientVectorStart.y();
-
-    m_radius = sqrt((dx * dx) + (dy * dy));
-}
-
-double RadialGradientStrategy::valueAt(double x, double y) const
-{
-    double dx = x - m_gradientVectorStart.x();
-    double dy = y - m_gradientVectorStart.y();
-
-    double distance = sqrt((dx * dx) + (dy * dy));
-
-    double t;
-
-    if (m_radius < DBL_EPSILON) {
-        t = 0;
-    } else {
-        t = distance / m_radius;
-    }
-
-    return t;
-}
-
-
-class SquareGradientStrategy : public KisGradientShapeStrategy
-{
-
-public:
-    SquareGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
-
-    double valueAt(double x, double y) const override;
-
-protected:
-    double m_normalisedVectorX;
-    double m_normalisedVectorY;
-    double m_vectorLength;
-};
-
-SquareGradientStrategy::SquareGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-        : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd)
-{
-    double dx = gradientVectorEnd.x() - gradientVectorStart.x();
-    double dy = gradientVectorEnd.y() - gradientVectorStart.y();
-
-    m_vectorLength = sqrt((dx * dx) + (dy * dy));
-
-    if (m_vectorLength < DBL_EPSILON) {
-        m_normalisedVectorX = 0;
-        m_normalisedVectorY = 0;
-    } else {
-        m_normalisedVectorX = dx / m_vectorLength;
-        m_normalisedVectorY = dy / m_vectorLength;
-    }
-}
-
-double SquareGradientStrategy::valueAt(double x, double y) const
-{
-    double px = x - m_gradientVectorStart.x();
-    double py = y - m_gradientVectorStart.y();
-
-    double distance1 = 0;
-    double distance2 = 0;
-
-    double t;
-
-    if (m_vectorLength > DBL_EPSILON) {
-
-        // Point to line distance is:
-        // distance = ((l0.y() - l1.y()) * p.x() + (l1.x() - l0.x()) * p.y() + l0.x() * l1.y() - l1.x() * l0.y()) / m_vectorLength;
-        //
-        // Here l0 = (0, 0) and |l1 - l0| = 1
-
-        distance1 = -m_normalisedVectorY * px + m_normalisedVectorX * py;
-        distance1 = fabs(distance1);
-
-        // Rotate point by 90 degrees and get the distance to the perpendicular
-        distance2 = -m_normalisedVectorY * -py + m_normalisedVectorX * px;
-        distance2 = fabs(distance2);
-        
-        t = qMax(distance1, distance2) / m_vectorLength;
-    } else {
-        t = 0;
-    }
-
-    return t;
-}
-
-
-class ConicalGradientStrategy : public KisGradientShapeStrategy
+/**
+ * The linear, bilinear, radial, square, conical and spiral shapes. They are
+ * evaluated a whole row at a time by the vectorized evaluator built for the
+ * current architecture.
+ */
+class AnalyticGradientShapeStrategy : public KisGradientShapeStrategy
 {
-
 public:
-    ConicalGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
+    AnalyticGradientShapeStrategy(KisGradientShapeParams::Shape shape,
+                                  const QPointF& gradientVectorStart,
+                                  const QPointF& gradientVectorEnd);
 
     double valueAt(double x, double y) const override;
+    void valuesAt(double x, double y, int numPixels, double *values) const override;
 
-protected:
-    double m_vectorAngle;
+private:
+    QScopedPointer<KisGradientShapeEvaluatorBase> m_evaluator;
 };
 
-ConicalGradientStrategy::ConicalGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-        : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd)
+AnalyticGradientShapeStrategy::AnalyticGradientShapeStrategy(KisGradientShapeParams::Shape shape,
+                                                             const QPointF& gradientVectorStart,
+                                                             const QPointF& gradientVectorEnd)
+    : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd),
+      m_evaluator(createOptimizedClass<KisGradientShapeEvaluatorFactory>(
+                      KisGradientShapeParams(shape, gradientVectorStart, gradientVectorEnd)))
 {
-    double dx = gradientVectorEnd.x() - gradientVectorStart.x();
-    double dy = gradientVectorEnd.y() - gradientVectorStart.y();
-
-    // Get angle from 0 to 2 PI.
-    m_vectorAngle = atan2(dy, dx) + M_PI;
 }
 
-double ConicalGradientStrategy::valueAt(double x, double y) const
-{
-    double px = x - m_gradientVectorStart.x();
-    double py = y - m_gradientVectorStart.y();
-
-    double angle = atan2(py, px) + M_PI;
-
-    angle -= m_vectorAngle;
-
-    if (angle < 0) {
-        angle += 2 * M_PI;
-    }
-
-    double t = angle / (2 * M_PI);
-
-    return t;
-}
-
-
-class ConicalSymetricGradientStrategy : public KisGradientShapeStrategy
+double AnalyticGradientShapeStrategy::valueAt(double x, double y) const
 {
-public:
-    ConicalSymetricGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
-
-    double valueAt(double x, double y) const override;
-
-protected:
-    double m_vectorAngle;
-};
-
-ConicalSymetricGradientStrategy::ConicalSymetricGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-        : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd)
-{
-    double dx = gradientVectorEnd.x() - gradientVectorStart.x();
-    double dy = gradientVectorEnd.y() - gradientVectorStart.y();
-
-    // Get angle from 0 to 2 PI.
-    m_vectorAngle = atan2(dy, dx) + M_PI;
+    double value;
+    m_evaluator->valuesAt(x, y, 1, &value);
+    return value;
 }
 
-double ConicalSymetricGradientStrategy::valueAt(double x, double y) const
+void AnalyticGradientShapeStrategy::valuesAt(double x, double y, int numPixels, double *values) const
 {
-    double px = x - m_gradientVectorStart.x();
-    double py = y - m_gradientVectorStart.y();
-
-    double angle = atan2(py, px) + M_PI;
-
-    angle -= m_vectorAngle;
-
-    if (angle < 0) {
-        angle += 2 * M_PI;
-    }
-
-    double t;
-
-    if (angle < M_PI) {
-        t = angle / M_PI;
-    } else {
-        t = 1 - ((angle - M_PI) / M_PI);
-    }
-
-    return t;
+    m_evaluator->valuesAt(x, y, numPixels, values);
 }
 
-class SpiralGradientStrategy : public KisGradientShapeStrategy
-{
-public:
-   SpiralGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
-
-   double valueAt(double x, double y) const override;
-
-protected:
-   double m_vectorAngle;
-    double m_radius;
-};
-
-SpiralGradientStrategy::SpiralGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-       : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd)
-{
-    double dx = gradientVectorEnd.x() - gradientVectorStart.x();
-    double dy = gradientVectorEnd.y() - gradientVectorStart.y();
-
-    // Get angle from 0 to 2 PI.
-    m_vectorAngle = atan2(dy, dx) + M_PI;
-    m_radius = sqrt((dx * dx) + (dy * dy));
-};
-
-double SpiralGradientStrategy::valueAt(double x, double y) const
-{
-    double dx = x - m_gradientVectorStart.x();
-    double dy = y - m_gradientVectorStart.y();
-
-    double distance = sqrt((dx * dx) + (dy * dy));
-    double angle = atan2(dy, dx) + M_PI;
-
-    double t;
-    angle -= m_vectorAngle;
-
-    if (m_radius < DBL_EPSILON) {
-        t = 0;
-    } else {
-        t = distance / m_radius;
-    }
-
-    if (angle < 0) {
-        angle += 2 * M_PI;
-    }
-
-    t += angle / (2 * M_PI);
-
-    return t;
-
-};
-
-class ReverseSpiralGradientStrategy : public KisGradientShapeStrategy
-{
-public:
-   ReverseSpiralGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd);
-
-   double valueAt(double x, double y) const override;
-
-protected:
-   double m_vectorAngle;
-    double m_radius;
-};
-
-ReverseSpiralGradientStrategy::ReverseSpiralGradientStrategy(const QPointF& gradientVectorStart, const QPointF& gradientVectorEnd)
-       : KisGradientShapeStrategy(gradientVectorStart, gradientVectorEnd)
-{
-    double dx = gradientVectorEnd.x() - gradientVectorStart.x();
-    double dy = gradientVectorEnd.y() - gradientVectorStart.y();
-
-    // Get angle from 0 to 2 PI.
-    m_vectorAngle = atan2(dy, dx) + M_PI;
-    m_radius = sqrt((dx * dx) + (dy * dy));
-};
-
-double ReverseSpiralGradientStrategy::valueAt(double x, double y) const
-{
-    double dx = x - m_gradientVectorStart.x();
-    double dy = y - m_gradientVectorStart.y();
-
-    double distance = sqrt((dx * dx) + (dy * dy));
-    double angle = atan2(dy, dx) + M_PI;
-
-    double t;
-    angle -= m_vectorAngle;
-
-    if (m_radius < DBL_EPSILON) {
-        t = 0;
-    } else {
-        t = distance / m_radius;
-    }
-
-    if (angle < 0) {
-        angle += 2 * M_PI;
-    }
-
-    //Reverse direction of spiral gradient
-    t += 1 - (angle / (2 * M_PI));
-
-    return t;
-
-};
-
 class GradientRepeatStrategy
 {
 public:
@@ -588,20 +265,18 @@ public:
 
     void setup(const QPointF& gradientVectorStart,
                const QPointF& gradientVectorEnd,
-               const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                const GradientRepeatStrategy *repeatStrategy,
                qreal antiAliasThreshold,
                bool reverseGradient,
                const KoCachedGradient * cachedGradient);
 
-    const quint8 *colorAt(qreal x, qreal y) const;
+    const quint8 *colorAt(qreal x, qreal y, qreal shapeValue) const;
 
 private:
     KisGradientPainter::enumGradientShape m_shape;
     qreal m_antiAliasThresholdNormalized {0};
     qreal m_antiAliasThresholdNormalizedRev {0};
     qreal m_antiAliasThresholdNormalizedDbl {0};
-    QSharedPointer<KisGradientShapeStrategy> m_shapeStrategy;
     const GradientRepeatStrategy *m_repeatStrategy {0};
     bool m_reverseGradient {false};
     const KoCachedGradient *m_cachedGradient {0};
@@ -616,7 +291,6 @@ RepeatForwardsPaintPolicy::RepeatForwardsPaintPolicy(KisGradientPainter::enumGra
 
 void RepeatForwardsPaintPolicy::setup(const QPointF& gradientVectorStart,
                                       const QPointF& gradientVectorEnd,
-                                      const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                                       const GradientRepeatStrategy *repeatStrategy,
                                       qreal antiAliasThreshold,
                                       bool reverseGradient,
@@ -631,7 +305,6 @@ void RepeatForwardsPaintPolicy::setup(const QPointF& gradientVectorStart,
     m_antiAliasThresholdNormalizedRev = 1. - m_antiAliasThresholdNormalized;
     m_antiAliasThresholdNormalizedDbl = 2. * m_antiAliasThresholdNormalized;
     
-    m_shapeStrategy = shapeStrategy;
     m_repeatStrategy = repeatStrategy;
 
     m_reverseGradient = reverseGradient;
@@ -645,9 +318,12 @@ void RepeatForwardsPaintPolicy::setup(const QPointF& gradientVectorStart,
     m_resultColor = QVector<quint8>(m_colorSpace->pixelSize());
 }
 
-const quint8 *RepeatForwardsPaintPolicy::colorAt(qreal x, qreal y) const
+const quint8 *RepeatForwardsPaintPolicy::colorAt(qreal x, qreal y, qreal shapeValue) const
 {
-    qreal t = m_shapeStrategy->valueAt(x, y);
+    Q_UNUSED(x);
+    Q_UNUSED(y);
+
+    qreal t = shapeValue;
     // Early return if the pixel is near the center of the gradient if
     // the shape is radial or square.
     // This prevents applying smoothing since there are
@@ -695,17 +371,15 @@ class ConicalGradientPaintPolicy
 public:
     void setup(const QPointF& gradientVectorStart,
                const QPointF& gradientVectorEnd,
-               const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                const GradientRepeatStrategy *repeatStrategy,
                qreal antiAliasThreshold,
                bool reverseGradient,
                const KoCachedGradient * cachedGradient);
 
-    const quint8 *colorAt(qreal x, qreal y) const;
+    const quint8 *colorAt(qreal x, qreal y, qreal shapeValue) const;
 
 private:
     QPointF m_gradientVectorStart;
-    QSharedPointer<KisGradientShapeStrategy> m_shapeStrategy;
     const GradientRepeatStrategy *m_repeatStrategy;
     qreal m_singularityThreshold;
     qreal m_antiAliasThreshold;
@@ -718,7 +392,6 @@ private:
 
 void ConicalGradientPaintPolicy::setup(const QPointF& gradientVectorStart,
                                        const QPointF& gradientVectorEnd,
-                                       const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                                        const GradientRepeatStrategy *repeatStrategy,
                                        qreal antiAliasThreshold,
                                        bool reverseGradient,
@@ -728,7 +401,6 @@ void ConicalGradientPaintPolicy::setup(const QPointF& gradientVectorStart,
 
     m_gradientVectorStart = gradientVectorStart;
     
-    m_shapeStrategy = shapeStrategy;
     m_repeatStrategy = repeatStrategy;
 
     m_singularityThreshold = 8.;
@@ -745,7 +417,7 @@ void ConicalGradientPaintPolicy::setup(const QPointF& gradientVectorStart,
     m_resultColor = QVector<quint8>(m_colorSpace->pixelSize());
 }
 
-const quint8 *ConicalGradientPaintPolicy::colorAt(qreal x, qreal y) const
+const quint8 *ConicalGradientPaintPolicy::colorAt(qreal x, qreal y, qreal shapeValue) const
 {
     // Compute the distance from the center of the gradient to the current pixel
     qreal dx = x - m_gradientVectorStart.x();
@@ -767,7 +439,7 @@ const quint8 *ConicalGradientPaintPolicy::colorAt(qreal x, qreal y) const
     qreal antiAliasThresholdNormalizedRev = 1. - antiAliasThresholdNormalized;
     qreal antiAliasThresholdNormalizedDbl = 2. * antiAliasThresholdNormalized;
 
-    qreal t = m_shapeStrategy->valueAt(x, y); 
+    qreal t = shapeValue;
     t = m_repeatStrategy->valueAt(t);
 
     if (m_reverseGradient) {
@@ -803,20 +475,18 @@ public:
 
     void setup(const QPointF& gradientVectorStart,
                const QPointF& gradientVectorEnd,
-               const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                const GradientRepeatStrategy *repeatStrategy,
                qreal antiAliasThreshold,
                bool reverseGradient,
                const KoCachedGradient * cachedGradient);
 
-    const quint8 *colorAt(qreal x, qreal y) const;
+    const quint8 *colorAt(qreal x, qreal y, qreal shapeValue) const;
 
 private:
     QPointF m_gradientVectorStart;
     qreal m_distanceInPixels {0};
     qreal m_singularityThreshold {0};
     qreal m_angle {0};
-    QSharedPointer<KisGradientShapeStrategy> m_shapeStrategy;
     const GradientRepeatStrategy *m_repeatStrategy {0};
     qreal m_antiAliasThreshold {0};
     bool m_reverseGradient {false};
@@ -834,7 +504,6 @@ SpyralGradientRepeatNonePaintPolicy::SpyralGradientRepeatNonePaintPolicy(bool is
 
 void SpyralGradientRepeatNonePaintPolicy::setup(const QPointF& gradientVectorStart,
                                                 const QPointF& gradientVectorEnd,
-                                                const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                                                 const GradientRepeatStrategy *repeatStrategy,
                                                 qreal antiAliasThreshold,
                                                 bool reverseGradient,
@@ -848,7 +517,6 @@ void SpyralGradientRepeatNonePaintPolicy::setup(const QPointF& gradientVectorSta
     m_singularityThreshold = m_distanceInPixels / 32.;
     m_angle = atan2(dy, dx) + M_PI;
     
-    m_shapeStrategy = shapeStrategy;
     m_repeatStrategy = repeatStrategy;
 
     m_antiAliasThreshold = antiAliasThreshold;
@@ -862,7 +530,7 @@ void SpyralGradientRepeatNonePaintPolicy::setup(const QPointF& gradientVectorSta
     m_resultColor = QVector<quint8>(m_colorSpace->pixelSize());
 }
 
-const quint8 *SpyralGradientRepeatNonePaintPolicy::colorAt(qreal x, qreal y) const
+const quint8 *SpyralGradientRepeatNonePaintPolicy::colorAt(qreal x, qreal y, qreal shapeValue) const
 {
     // Compute the distance from the center of the gradient to thecurrent pixel
     qreal dx = x - m_gradientVectorStart.x();
@@ -884,7 +552,7 @@ const quint8 *SpyralGradientRepeatNonePaintPolicy::colorAt(qreal x, qreal y) con
     qreal antiAliasThresholdNormalizedRev = 1. - antiAliasThresholdNormalized;
     qreal antiAliasThresholdNormalizedDbl = 2. * antiAliasThresholdNormalized;
 
-    qreal t = m_shapeStrategy->valueAt(x, y); 
+    qreal t = shapeValue;
     t = m_repeatStrategy->valueAt(t);
 
     if (m_reverseGradient) {
@@ -943,16 +611,14 @@ class NoAntialiasPaintPolicy
 public:
     void setup(const QPointF& gradientVectorStart,
                const QPointF& gradientVectorEnd,
-               const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                const GradientRepeatStrategy *repeatStrategy,
                qreal antiAliasThreshold,
                bool reverseGradient,
                const KoCachedGradient * cachedGradient);
 
-    const quint8 *colorAt(qreal x, qreal y) const;
+    const quint8 *colorAt(qreal x, qreal y, qreal shapeValue) const;
 
 private:
-    QSharedPointer<KisGradientShapeStrategy> m_shapeStrategy;
     const GradientRepeatStrategy *m_repeatStrategy {0};
     bool m_reverseGradient {false};
     const KoCachedGradient *m_cachedGradient {0};
@@ -960,7 +626,6 @@ private:
 
 void NoAntialiasPaintPolicy::setup(const QPointF& gradientVectorStart,
                                    const QPointF& gradientVectorEnd,
-                                   const QSharedPointer<KisGradientShapeStrategy> &shapeStrategy,
                                    const GradientRepeatStrategy *repeatStrategy,
                                    qreal antiAliasThreshold,
                                    bool reverseGradient,
@@ -969,15 +634,17 @@ void NoAntialiasPaintPolicy::setup(const QPointF& gradientVectorStart,
     Q_UNUSED(gradientVectorStart);
     Q_UNUSED(gradientVectorEnd);
     Q_UNUSED(antiAliasThreshold);
-    m_shapeStrategy = shapeStrategy;
     m_repeatStrategy = repeatStrategy;
     m_reverseGradient = reverseGradient;
     m_cachedGradient = cachedGradient;
 }
 
-const quint8 *NoAntialiasPaintPolicy::colorAt(qreal x, qreal y) const
+const quint8 *NoAntialiasPaintPolicy::colorAt(qreal x, qreal y, qreal shapeValue) const
 {
-    qreal t = m_shapeStrategy->valueAt(x, y);
+    Q_UNUSED(x);
+    Q_UNUSED(y);
+
+    qreal t = shapeValue;
     t = m_repeatStrategy->valueAt(t);
 
     if (m_reverseGradient) {
@@ -1190,71 +857,46 @@ bool KisGradientPainter::paintGradient(const QPointF& gradientVectorStart,
         requestedRect &= selection()->selectedExactRect();
     }
 
-    QSharedPointer<KisGradientShapeStrategy> shapeStrategy;
+    KisGradientShapeParams::Shape analyticShape = KisGradientShapeParams::Linear;
 
     switch (m_d->shape) {
-    case GradientShapeLinear: {
-        Private::ProcessRegion r(toQShared(new LinearGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeLinear:
+        analyticShape = KisGradientShapeParams::Linear;
         break;
-    }
-    case GradientShapeBiLinear: {
-        Private::ProcessRegion r(toQShared(new BiLinearGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeBiLinear:
+        analyticShape = KisGradientShapeParams::BiLinear;
         break;
-    }
-    case GradientShapeRadial: {
-        Private::ProcessRegion r(toQShared(new RadialGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeRadial:
+        analyticShape = KisGradientShapeParams::Radial;
         break;
-    }
-    case GradientShapeSquare: {
-        Private::ProcessRegion r(toQShared(new SquareGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeSquare:
+        analyticShape = KisGradientShapeParams::Square;
         break;
-    }
-    case GradientShapeConical: {
-        Private::ProcessRegion r(toQShared(new ConicalGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeConical:
+        analyticShape = KisGradientShapeParams::Conical;
         break;
-    }
-    case GradientShapeConicalSymetric: {
-        Private::ProcessRegion r(toQShared(new ConicalSymetricGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeConicalSymetric:
+        analyticShape = KisGradientShapeParams::ConicalSymetric;
         break;
-    }
-    case GradientShapeSpiral: {
-        Private::ProcessRegion r(toQShared(new SpiralGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeSpiral:
+        analyticShape = KisGradientShapeParams::Spiral;
         break;
-    }
-    case GradientShapeReverseSpiral: {
-        Private::ProcessRegion r(toQShared(new ReverseSpiralGradientStrategy(gradientVectorStart, gradientVectorEnd)),
-                                 requestedRect);
-        m_d->processRegions.clear();
-        m_d->processRegions << r;
+    case GradientShapeReverseSpiral:
+        analyticShape = KisGradientShapeParams::ReverseSpiral;
         break;
-    }
     case GradientShapePolygonal:
         precalculateShape();
         repeat = GradientRepeatNone;
         break;
     }
 
+    if (m_d->shape != GradientShapePolygonal) {
+        Private::ProcessRegion r(toQShared(new AnalyticGradientShapeStrategy(analyticShape, gradientVectorStart, gradientVectorEnd)),
+                                 requestedRect);
+        m_d->processRegions.clear();
+        m_d->processRegions << r;
+    }
+
     GradientRepeatStrategy *repeatStrategy = 0;
 
     switch (repeat) {
@@ -1285,56 +927,74 @@ bool KisGradientPainter::paintGradient(const QPointF& gradientVectorStart,
 
     const KoColorSpace *mixCs = KoColorSpaceRegistry::instance()->colorSpace(destCs->colorModelId().id(), depthId.id(), destCs->profile());
     const quint32 mixPixelSize = mixCs->pixelSize();
-
-    KisPaintDeviceSP tmp(new KisPaintDevice(mixCs));
-    tmp->setDefaultBounds(dev->defaultBounds());
-    tmp->clear();
+    const quint32 dstPixelSize = destCs->pixelSize();
 
     const KisDitherOp* op = mixCs->ditherOp(destCs->colorDepthId().id(), useDithering ? DITHER_BEST : DITHER_NONE);
 
     Q_FOREACH (const Private::ProcessRegion &r, m_d->processRegions) {
-        QRect processRect = r.processRect;
+        const QRect processRect = r.processRect;
         QSharedPointer<KisGradientShapeStrategy> shapeStrategy = r.precalculatedShapeStrategy;
 
+        /**
+         * The colors are precomputed in the mixing color space with one entry
+         * per pixel of the longest side of the processed rect, so every pixel
+         * is just a lookup into the table. The table is shared by all the
+         * threads.
+         */
         KoCachedGradient cachedGradient(gradient(), qMax(processRect.width(), processRect.height()), mixCs);
 
-        KisSequentialIteratorProgress it(tmp, processRect, progressUpdater());
-
         paintPolicy.setup(gradientVectorStart,
                           gradientVectorEnd,
-                          shapeStrategy,
                           repeatStrategy,
                           antiAliasThreshold,
                           reverseGradient,
                           &cachedGradient);
 
-        while (it.nextPixel()) {
-            const quint8 *const pixel {paintPolicy.colorAt(it.x(), it.y())};
-            memcpy(it.rawData(), pixel, mixPixelSize);
-        }
-
-        KisRandomAccessorSP dstIt = dev->createRandomAccessorNG();
-        KisRandomConstAccessorSP srcIt = tmp->createRandomConstAccessorNG();
+        /**
+         * The patches are aligned to the tiles grid, so they are filled in
+         * parallel without sharing any tiles of the destination device.
+         * The shape is evaluated for the whole row at once, then the colors
+         * are looked up and dithered into the destination color space.
+         */
+        auto fillPatch = [&] (const QRect &rc) {
+            // the policies keep the scratch color, so every thread needs its own copy
+            const T policy = paintPolicy;
+
+            QVector<double> shapeValues(rc.width());
+            QVector<quint8> mixPixels(rc.width() * rc.height() * mixPixelSize);
+            QVector<quint8> dstPixels(rc.width() * rc.height() * dstPixelSize);
+
+            quint8 *mixPtr = mixPixels.data();
+
+            for (int y = rc.top(); y <= rc.bottom(); y++) {
+                shapeStrategy->valuesAt(rc.left(), y, rc.width(), shapeValues.data());
+
+                for (int i = 0; i < rc.width(); i++) {
+                    memcpy(mixPtr, policy.colorAt(rc.left() + i, y, shapeValues[i]), mixPixelSize);
+                    mixPtr += mixPixelSize;
+                }
+            }
 
-        int rows = 1;
-        int columns = 1;
+            op->dither(mixPixels.constData(), rc.width() * mixPixelSize,
+                       dstPixels.data(), rc.width() * dstPixelSize,
+                       rc.x(), rc.y(), rc.width(), rc.height());
 
-        for (int y = processRect.y(); y <= processRect.bottom(); y += rows) {
-            rows = qMin(srcIt->numContiguousRows(y), qMin(dstIt->numContiguousRows(y), processRect.bottom() - y + 1));
+            dev->writeBytes(dstPixels.constData(), rc);
+        };
 
-            for (int x = processRect.x(); x <= processRect.right(); x += columns) {
-                columns = qMin(srcIt->numContiguousColumns(x), qMin(dstIt->numContiguousColumns(x), processRect.right() - x + 1));
+        // the size of the patches should be a multiple of the tile size
+        const QVector<QRect> patches = KritaUtils::splitRectIntoPatches(processRect, QSize(256, 256));
 
-                srcIt->moveTo(x, y);
-                dstIt->moveTo(x, y);
+        // the progress is reported from this thread after every batch of patches
+        const int batchSize = qMax(1, QThread::idealThreadCount() * 2);
 
-                const qint32 srcRowStride = srcIt->rowStride(x, y);
-                const qint32 dstRowStride = dstIt->rowStride(x, y);
-                const quint8 *srcPtr = srcIt->rawDataConst();
-                quint8 *dstPtr = dstIt->rawData();
+        ProxyBasedProgressPolicy progress(progressUpdater());
+        progress.setRange(0, patches.size());
 
-                op->dither(srcPtr, srcRowStride, dstPtr, dstRowStride, x, y, columns, rows);
-            }
+        for (int i = 0; i < patches.size(); i += batchSize) {
+            QVector<QRect> batch = patches.mid(i, batchSize);
+            QtConcurrent::blockingMap(batch, fillPatch);
+            progress.setValue(i + batch.size());
         }
     }
 
@@ -20,6 +20,14 @@ public:
 
     virtual double valueAt(double x, double y) const = 0;
 
+    /**
+     * Writes the values of the shape at the points (x + i, y),
+     * 0 <= i < numPixels, into \p values. The default implementation
+     * calls valueAt() for every point, the analytic shapes override it
+     * with a vectorized version.
+     */
+    virtual void valuesAt(double x, double y, int numPixels, double *values) const;
+
 protected:
     QPointF m_gradientVectorStart;
     QPointF m_gradientVectorEnd;
@@ -191,6 +191,13 @@ int KisImageConfig::poolLimit() const
     return totalRAM() * hp * pp;
 }
 
+int KisImageConfig::historyLimit() const
+{
+    qreal hp = qreal(memoryHistoryLimitPercent()) / 100.0;
+
+    return tilesHardLimit() * hp;
+}
+
 qreal KisImageConfig::memoryHardLimitPercent(bool requestDefault) const
 {
     return !requestDefault ?
@@ -224,6 +231,17 @@ void KisImageConfig::setMemoryPoolLimitPercent(qreal value)
     m_config.writeEntry("memoryPoolLimitPercent", value);
 }
 
+qreal KisImageConfig::memoryHistoryLimitPercent(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("memoryHistoryLimitPercent", 25.0) : 25.0;
+}
+
+void KisImageConfig::setMemoryHistoryLimitPercent(qreal value)
+{
+    m_config.writeEntry("memoryHistoryLimitPercent", value);
+}
+
 QString KisImageConfig::safelyGetWritableTempLocation(const QString &suffix, const QString &configKey, bool requestDefault) const
 {
 #ifdef Q_OS_MACOS
@@ -49,13 +49,16 @@ public:
     int tilesHardLimit() const; // MiB
     int tilesSoftLimit() const; // MiB
     int poolLimit() const; // MiB
+    int historyLimit() const; // MiB
 
     qreal memoryHardLimitPercent(bool requestDefault = false) const; // % of total RAM
     qreal memorySoftLimitPercent(bool requestDefault = false) const; // % of memoryHardLimitPercent() * (1 - 0.01 * memoryPoolLimitPercent())
     qreal memoryPoolLimitPercent(bool requestDefault = false) const; // % of memoryHardLimitPercent()
+    qreal memoryHistoryLimitPercent(bool requestDefault = false) const; // % of tilesHardLimit(), 0 means no limit
     void setMemoryHardLimitPercent(qreal value);
     void setMemorySoftLimitPercent(qreal value);
     void setMemoryPoolLimitPercent(qreal value);
+    void setMemoryHistoryLimitPercent(qreal value);
 
     static int totalRAM(); // MiB
 
@@ -910,6 +910,11 @@ int KisLayer::thumbnailSeqNo() const
     return originalDevice ? originalDevice->sequenceNumber() : -1;
 }
 
+KisPaintDeviceSP KisLayer::thumbnailDevice() const
+{
+    return original();
+}
+
 QImage KisLayer::createThumbnailForFrame(qint32 w, qint32 h, int time, Qt::AspectRatioMode aspectRatioMode)
 {
     if (w == 0 || h == 0) {
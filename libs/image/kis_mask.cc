@@ -484,6 +484,11 @@ int KisMask::thumbnailSeqNo() const
     return originalDevice ? originalDevice->sequenceNumber() : -1;
 }
 
+KisPaintDeviceSP KisMask::thumbnailDevice() const
+{
+    return selection() ? selection()->projection() : 0;
+}
+
 void KisMask::testingInitSelection(const QRect &rect, KisLayerSP parentLayer)
 {
     if (parentLayer) {
@@ -177,6 +177,7 @@ public:
     QRect changeRect(const QRect &rect, PositionToFilthy pos = N_FILTHY) const override;
     QImage createThumbnail(qint32 w, qint32 h, Qt::AspectRatioMode aspectRatioMode = Qt::IgnoreAspectRatio) override;
     int thumbnailSeqNo() const override;
+    KisPaintDeviceSP thumbnailDevice() const override;
 
     void testingInitSelection(const QRect &rect, KisLayerSP parentLayer);
 
@@ -144,12 +144,14 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.poolSize = tileStats.poolSize;
 
     stats.swapSize = tileStats.swapSize;
+    stats.swapDeduplicatedSize = tileStats.swapDeduplicatedSize;
 
     KisImageConfig cfg(true);
 
     stats.tilesHardLimit = cfg.tilesHardLimit() * MiB;
     stats.tilesSoftLimit = cfg.tilesSoftLimit() * MiB;
     stats.tilesPoolLimit = cfg.poolLimit() * MiB;
+    stats.historyLimit = cfg.historyLimit() * MiB;
     stats.totalMemoryLimit = stats.tilesHardLimit + stats.tilesPoolLimit;
 
     return stats;
@@ -33,11 +33,13 @@ public:
               poolSize(0),
 
               swapSize(0),
+              swapDeduplicatedSize(0),
 
               totalMemoryLimit(0),
               tilesHardLimit(0),
               tilesSoftLimit(0),
-              tilesPoolLimit(0)
+              tilesPoolLimit(0),
+              historyLimit(0)
         {
         }
 
@@ -52,11 +54,13 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+        qint64 swapDeduplicatedSize;
 
         qint64 totalMemoryLimit;
         qint64 tilesHardLimit;
         qint64 tilesSoftLimit;
         qint64 tilesPoolLimit;
+        qint64 historyLimit;
     };
 
 
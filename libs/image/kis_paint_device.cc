@@ -47,6 +47,9 @@
 #include "kis_default_bounds.h"
 
 #include "kis_lod_transform.h"
+#include "kis_algebra_2d.h"
+#include "tiles3/kis_tile_data.h"
+#include "tiles3/KisTileRevisionTracker.h"
 
 #include "kis_raster_keyframe_channel.h"
 
@@ -159,6 +162,7 @@ public:
     {
 
         m_lodData.reset();
+        m_lodCache.reset();
         m_externalFrameData.reset();
 
         if (!m_frames.isEmpty()) {
@@ -421,6 +425,7 @@ public:
 
     struct LodDataStructImpl;
     LodDataStruct* createLodDataStruct(int lod);
+    LodDataStruct* createIncrementalLodDataStruct(int lod, KisRegion *dirtyRegion);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
     KisRegion regionForLodSyncing() const;
@@ -595,9 +600,27 @@ private:
 private:
     friend class KisPaintDeviceFramesInterface;
 
+    /**
+     * The lod plane uploaded by the last incremental lod syncing and
+     * the revisions of the tiles of the lod0 plane it has been generated
+     * from, so the tiles changed since the syncing can be found without
+     * keeping the old lod0 tiles alive.
+     */
+    struct LodCache {
+        int levelOfDetail = 0;
+        const KoColorSpace *colorSpace = nullptr;
+        QPoint sourceOffset;
+        QByteArray sourceDefaultPixel;
+        KisTileRevisionTracker sourceRevisions;
+        KisDataManagerSP lodPlane;
+    };
+
+    bool lodCacheIsValid(Data *srcData, int lod) const;
+
 private:
     DataSP m_data;
     mutable QScopedPointer<Data> m_lodData;
+    QScopedPointer<LodCache> m_lodCache;
     mutable QScopedPointer<Data> m_externalFrameData;
     mutable QMutex m_dataSwitchLock;
 
@@ -681,6 +704,12 @@ struct KisPaintDevice::Private::StrategyPolicy {
 struct KisPaintDevice::Private::LodDataStructImpl : public KisPaintDevice::LodDataStruct {
     LodDataStructImpl(Data *_lodData) : lodData(_lodData) {}
     QScopedPointer<Data> lodData;
+
+    /**
+     * The lod cache to be saved on upload, present only
+     * for incremental syncing
+     */
+    QScopedPointer<LodCache> pendingCache;
 };
 
 KisRegion KisPaintDevice::Private::regionForLodSyncing() const
@@ -725,6 +754,66 @@ KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int
     return lodStruct;
 }
 
+bool KisPaintDevice::Private::lodCacheIsValid(Data *srcData, int lod) const
+{
+    if (!m_lodCache) return false;
+
+    KisDataManagerSP srcDataManager = srcData->dataManager();
+
+    /**
+     * We compare color spaces as pure pointers, because the lod plane
+     * should be regenerated even when the profile is the same
+     */
+    return m_lodCache->levelOfDetail == lod &&
+        m_lodCache->colorSpace == srcData->colorSpace() &&
+        m_lodCache->sourceOffset == QPoint(srcData->x(), srcData->y()) &&
+        m_lodCache->sourceDefaultPixel ==
+            QByteArray(reinterpret_cast<const char*>(srcDataManager->defaultPixel()), srcDataManager->pixelSize());
+}
+
+KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createIncrementalLodDataStruct(int newLod, KisRegion *dirtyRegion)
+{
+    Data *srcData = currentNonLodData();
+
+    KisDataManagerSP srcDataManager = srcData->dataManager();
+
+    const bool canReuseCache = lodCacheIsValid(srcData, newLod);
+
+    /**
+     * The tracker is updated on a copy, so that the cache stays intact
+     * if the syncing is cancelled before the upload. The removed tiles
+     * are also reported as changed, their lod counterparts should be
+     * reset to the default pixel.
+     */
+    KisTileRevisionTracker sourceRevisions;
+    if (canReuseCache) {
+        sourceRevisions = m_lodCache->sourceRevisions;
+    }
+
+    QVector<QRect> changedTiles = sourceRevisions.update(srcDataManager);
+
+    *dirtyRegion = canReuseCache ?
+        KisRegion(std::move(changedTiles)).translated(srcData->x(), srcData->y()) :
+        regionForLodSyncing();
+
+    LodDataStructImpl *lodStruct = static_cast<LodDataStructImpl*>(createLodDataStruct(newLod));
+
+    if (canReuseCache) {
+        KisDataManagerSP lodPlane = m_lodCache->lodPlane;
+        lodStruct->lodData->dataManager()->bitBltRough(lodPlane, lodPlane->extent());
+    }
+
+    lodStruct->pendingCache.reset(new LodCache());
+    lodStruct->pendingCache->levelOfDetail = newLod;
+    lodStruct->pendingCache->colorSpace = srcData->colorSpace();
+    lodStruct->pendingCache->sourceOffset = QPoint(srcData->x(), srcData->y());
+    lodStruct->pendingCache->sourceDefaultPixel =
+        QByteArray(reinterpret_cast<const char*>(srcDataManager->defaultPixel()), srcDataManager->pixelSize());
+    lodStruct->pendingCache->sourceRevisions = sourceRevisions;
+
+    return lodStruct;
+}
+
 void KisPaintDevice::Private::updateLodDataManager(KisDataManager *srcDataManager,
                                                    KisDataManager *dstDataManager,
                                                    const QPoint &srcOffset,
@@ -848,6 +937,11 @@ void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
 
     m_lodData->prepareClone(dst->lodData.data());
     m_lodData->dataManager()->bitBltRough(dst->lodData->dataManager(), dst->lodData->dataManager()->extent());
+
+    if (dst->pendingCache) {
+        m_lodCache.swap(dst->pendingCache);
+        m_lodCache->lodPlane = new KisDataManager(*m_lodData->dataManager());
+    }
 }
 
 void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targetDevice)
@@ -1190,6 +1284,16 @@ int KisPaintDevice::sequenceNumber() const
     return m_d->cache()->sequenceNumber();
 }
 
+KisThumbnailPyramid* KisPaintDevice::thumbnailPyramid() const
+{
+    return m_d->cache()->thumbnailPyramid();
+}
+
+KisHistogramIndex* KisPaintDevice::histogramIndex() const
+{
+    return m_d->cache()->histogramIndex();
+}
+
 void KisPaintDevice::estimateMemoryStats(qint64 &imageData, qint64 &temporaryData, qint64 &lodData) const
 {
     m_d->estimateMemoryStats(imageData, temporaryData, lodData);
@@ -2159,6 +2263,11 @@ KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod)
     return m_d->createLodDataStruct(lod);
 }
 
+KisPaintDevice::LodDataStruct* KisPaintDevice::createIncrementalLodDataStruct(int lod, KisRegion *dirtyRegion)
+{
+    return m_d->createIncrementalLodDataStruct(lod, dirtyRegion);
+}
+
 void KisPaintDevice::updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect)
 {
     m_d->updateLodDataStruct(dst, srcRect);
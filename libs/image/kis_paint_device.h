@@ -42,6 +42,9 @@ class KisRasterKeyframeChannel;
 
 class KisPaintDeviceFramesInterface;
 
+class KisThumbnailPyramid;
+class KisHistogramIndex;
+
 class KisInterstrokeData;
 using KisInterstrokeDataSP = QSharedPointer<KisInterstrokeData>;
 
@@ -824,6 +827,21 @@ public:
      */
     int sequenceNumber() const;
 
+    /**
+     * \return the cache of downsampled copies of the current frame of
+     *         the device used for generating thumbnails. The pyramid is
+     *         created on the first request and is updated by its users,
+     *         see KisThumbnailPyramid::update()
+     */
+    KisThumbnailPyramid* thumbnailPyramid() const;
+
+    /**
+     * \return the per-channel histogram of the device. The index is
+     *         created on the first request and is updated by its users,
+     *         see KisHistogramIndex::update()
+     */
+    KisHistogramIndex* histogramIndex() const;
+
 
     void estimateMemoryStats(qint64 &imageData, qint64 &temporaryData, qint64 &lodData) const;
 
@@ -919,6 +937,20 @@ public:
 
     KisRegion regionForLodSyncing() const;
     LodDataStruct* createLodDataStruct(int lod);
+
+    /**
+     * Creates a lod plane for incremental syncing. If the lod plane
+     * uploaded by the previous incremental syncing for the same \p lod is
+     * still valid, the new plane is initialized with its content and
+     * \p dirtyRegion is set to the region of the lod0 plane changed since
+     * then. Otherwise, the plane is empty and \p dirtyRegion is the same
+     * as regionForLodSyncing().
+     *
+     * The whole \p dirtyRegion should be passed to updateLodDataStruct()
+     * before the plane is uploaded.
+     */
+    LodDataStruct* createIncrementalLodDataStruct(int lod, KisRegion *dirtyRegion);
+
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
 
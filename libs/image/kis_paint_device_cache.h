@@ -12,6 +12,11 @@
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QScopedPointer>
+#include "KisThumbnailPyramid.h"
+#include "KisHistogramIndex.h"
 
 class KisPaintDeviceCache
 {
@@ -113,6 +118,29 @@ public:
         return m_sequenceNumber;
     }
 
+    /**
+     * The pyramid is not invalidated together with the rest of the
+     * cache, it is updated incrementally by its users instead
+     */
+    KisThumbnailPyramid* thumbnailPyramid() {
+        QMutexLocker l(&m_thumbnailPyramidLock);
+        if (!m_thumbnailPyramid) {
+            m_thumbnailPyramid.reset(new KisThumbnailPyramid());
+        }
+        return m_thumbnailPyramid.data();
+    }
+
+    /**
+     * The histogram index is updated incrementally by its users as well
+     */
+    KisHistogramIndex* histogramIndex() {
+        QMutexLocker l(&m_histogramIndexLock);
+        if (!m_histogramIndex) {
+            m_histogramIndex.reset(new KisHistogramIndex());
+        }
+        return m_histogramIndex.data();
+    }
+
 private:
     KisPaintDevice *m_paintDevice {nullptr};
 
@@ -154,6 +182,12 @@ private:
     bool m_thumbnailsValid {false};
     QMap<int, QMap<int, QMap<qreal,QImage> > > m_thumbnails;
 
+    QMutex m_thumbnailPyramidLock;
+    QScopedPointer<KisThumbnailPyramid> m_thumbnailPyramid;
+
+    QMutex m_histogramIndexLock;
+    QScopedPointer<KisHistogramIndex> m_histogramIndex;
+
     QAtomicInt m_sequenceNumber;
 };
 
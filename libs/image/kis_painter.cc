@@ -39,6 +39,7 @@
 #include "kis_vec.h"
 #include "kis_iterator_ng.h"
 #include "kis_random_accessor_ng.h"
+#include "KisTileSpanIterator.h"
 
 #include "filter/kis_filter_configuration.h"
 #include "kis_pixel_selection.h"
@@ -278,11 +279,22 @@ bool KisPainter::checkDeviceHasTransparency(KisPaintDeviceSP dev)
     }
 
     const KoColorSpace *cs = dev->colorSpace();
-    KisSequentialConstIterator it(dev, deviceBounds);
+    const int pixelSize = cs->pixelSize();
+    KisTileSpanConstIterator it(dev, deviceBounds);
 
-    while(it.nextPixel()) {
-        if (cs->opacityU8(it.rawDataConst()) != OPACITY_OPAQUE_U8) {
-            return true;
+    while (it.nextSpan()) {
+        const quint8 *row = it.rawDataConst();
+
+        for (int y = 0; y < it.spanHeight(); y++) {
+            const quint8 *pixel = row;
+
+            for (int x = 0; x < it.spanWidth(); x++) {
+                if (cs->opacityU8(pixel) != OPACITY_OPAQUE_U8) {
+                    return true;
+                }
+                pixel += pixelSize;
+            }
+            row += it.rowStride();
         }
     }
 
@@ -557,7 +569,8 @@ void KisPainter::bitBltWithFixedSelection(qint32 dstX, qint32 dstY,
     to the current paint device (d->device) */
     quint8* dstBytes = 0;
     try {
-        dstBytes = new quint8[srcWidth * srcHeight * d->device->pixelSize()];
+        d->dstBytesBuffer.resize(srcWidth * srcHeight * d->device->pixelSize());
+        dstBytes = d->dstBytesBuffer.data();
     } catch (const std::bad_alloc&) {
         warnKrita << "KisPainter::bitBltWithFixedSelection std::bad_alloc for " << srcWidth << " * " << srcHeight << " * " << d->device->pixelSize() << "dst bytes";
         return;
@@ -568,7 +581,8 @@ void KisPainter::bitBltWithFixedSelection(qint32 dstX, qint32 dstY,
     // Copy the relevant bytes of raw data from srcDev
     quint8* srcBytes = 0;
     try {
-        srcBytes = new quint8[srcWidth * srcHeight * srcDev->pixelSize()];
+        d->srcBytesBuffer.resize(srcWidth * srcHeight * srcDev->pixelSize());
+        srcBytes = d->srcBytesBuffer.data();
     } catch (const std::bad_alloc&) {
         warnKrita << "KisPainter::bitBltWithFixedSelection std::bad_alloc for " << srcWidth << " * " << srcHeight << " * " << d->device->pixelSize() << "src bytes";
         return;
@@ -602,7 +616,8 @@ void KisPainter::bitBltWithFixedSelection(qint32 dstX, qint32 dstY,
         quint32 totalBytes = srcWidth * srcHeight * selection->pixelSize();
         quint8* mergedSelectionBytes = 0;
         try {
-            mergedSelectionBytes = new quint8[ totalBytes ];
+            d->maskBytesBuffer.resize(totalBytes);
+            mergedSelectionBytes = d->maskBytesBuffer.data();
         } catch (const std::bad_alloc&) {
             warnKrita << "KisPainter::bitBltWithFixedSelection std::bad_alloc for " << srcWidth << " * " << srcHeight << " * " << d->device->pixelSize() << "total bytes";
             return;
@@ -635,14 +650,10 @@ void KisPainter::bitBltWithFixedSelection(qint32 dstX, qint32 dstY,
         d->paramInfo.rows          = srcHeight;
         d->paramInfo.cols          = srcWidth;
         d->colorSpace->bitBlt(srcDev->colorSpace(), d->paramInfo, compositeOp, d->renderingIntent, d->conversionFlags);
-        delete[] mergedSelectionBytes;
     }
 
     d->device->writeBytes(dstBytes, dstX, dstY, srcWidth, srcHeight);
 
-    delete[] dstBytes;
-    delete[] srcBytes;
-
     addDirtyRect(QRect(dstX, dstY, srcWidth, srcHeight));
 }
 
@@ -973,7 +984,8 @@ void KisPainter::bltFixed(qint32 dstX, qint32 dstY,
     to the current paint device (aka: d->device) */
     quint8* dstBytes = 0;
     try {
-         dstBytes = new quint8[srcWidth * srcHeight * d->device->pixelSize()];
+        d->dstBytesBuffer.resize(srcWidth * srcHeight * d->device->pixelSize());
+        dstBytes = d->dstBytesBuffer.data();
     } catch (const std::bad_alloc&) {
         warnKrita << "KisPainter::bltFixed std::bad_alloc for " << srcWidth << " * " << srcHeight << " * " << d->device->pixelSize() << "total bytes";
         return;
@@ -998,10 +1010,10 @@ void KisPainter::bltFixed(qint32 dstX, qint32 dstY,
         KisPaintDeviceSP selectionProjection(d->selection->projection());
         quint8* selBytes = 0;
         try {
-            selBytes = new quint8[srcWidth * srcHeight * selectionProjection->pixelSize()];
+            d->maskBytesBuffer.resize(srcWidth * srcHeight * selectionProjection->pixelSize());
+            selBytes = d->maskBytesBuffer.data();
         }
         catch (const std::bad_alloc&) {
-            delete[] dstBytes;
             return;
         }
 
@@ -1014,9 +1026,6 @@ void KisPainter::bltFixed(qint32 dstX, qint32 dstY,
     d->colorSpace->bitBlt(srcDev->colorSpace(), d->paramInfo, compositeOp, d->renderingIntent, d->conversionFlags);
     d->device->writeBytes(dstBytes, dstX, dstY, srcWidth, srcHeight);
 
-    delete[] d->paramInfo.maskRowStart;
-    delete[] dstBytes;
-
     addDirtyRect(QRect(dstX, dstY, srcWidth, srcHeight));
 }
 
@@ -1062,7 +1071,8 @@ void KisPainter::bltFixedWithFixedSelection(qint32 dstX, qint32 dstY,
     to the current paint device (aka: d->device) */
     quint8* dstBytes = 0;
     try {
-        dstBytes = new quint8[srcWidth * srcHeight * d->device->pixelSize()];
+        d->dstBytesBuffer.resize(srcWidth * srcHeight * d->device->pixelSize());
+        dstBytes = d->dstBytesBuffer.data();
     } catch (const std::bad_alloc&) {
         warnKrita << "KisPainter::bltFixedWithFixedSelection std::bad_alloc for " << srcWidth << " * " << srcHeight << " * " << d->device->pixelSize() << "total bytes";
         return;
@@ -1093,10 +1103,10 @@ void KisPainter::bltFixedWithFixedSelection(qint32 dstX, qint32 dstY,
         quint32 totalBytes = srcWidth * srcHeight * selection->pixelSize();
         quint8 * mergedSelectionBytes = 0;
         try {
-            mergedSelectionBytes = new quint8[ totalBytes ];
+            d->maskBytesBuffer.resize(totalBytes);
+            mergedSelectionBytes = d->maskBytesBuffer.data();
         } catch (const std::bad_alloc&) {
             warnKrita << "KisPainter::bltFixedWithFixedSelection std::bad_alloc for " << totalBytes << "total bytes";
-            delete[] dstBytes;
             return;
         }
         d->selection->projection()->readBytes(mergedSelectionBytes, dstX, dstY, srcWidth, srcHeight);
@@ -1126,14 +1136,10 @@ void KisPainter::bltFixedWithFixedSelection(qint32 dstX, qint32 dstY,
         d->paramInfo.rows          = srcHeight;
         d->paramInfo.cols          = srcWidth;
         d->colorSpace->bitBlt(srcDev->colorSpace(), d->paramInfo, compositeOp, d->renderingIntent, d->conversionFlags);
-
-        delete[] mergedSelectionBytes;
     }
 
     d->device->writeBytes(dstBytes, dstX, dstY, srcWidth, srcHeight);
 
-    delete[] dstBytes;
-
     addDirtyRect(QRect(dstX, dstY, srcWidth, srcHeight));
 }
 
@@ -2874,6 +2880,20 @@ KisRunnableStrokeJobsInterface *KisPainter::runnableStrokeJobsInterface() const
     return d->runnableStrokeJobsInterface;
 }
 
+void KisPainter::setMemoryAllocator(KisOptimizedByteArray::MemoryAllocatorSP allocator)
+{
+    d->memoryAllocator = allocator;
+
+    d->dstBytesBuffer = KisOptimizedByteArray(allocator);
+    d->srcBytesBuffer = KisOptimizedByteArray(allocator);
+    d->maskBytesBuffer = KisOptimizedByteArray(allocator);
+}
+
+KisOptimizedByteArray::MemoryAllocatorSP KisPainter::memoryAllocator() const
+{
+    return d->memoryAllocator;
+}
+
 void KisPainter::renderMirrorMaskSafe(QRect rc, KisFixedPaintDeviceSP dab, bool preserveDab)
 {
     if (!d->mirrorHorizontally && !d->mirrorVertically) return;
@@ -2978,7 +2998,7 @@ void KisPainter::renderMirrorMask(QRect rc, KisFixedPaintDeviceSP dab, KisFixedP
 
 void KisPainter::renderMirrorMask(QRect rc, KisPaintDeviceSP dab){
     if (d->mirrorHorizontally || d->mirrorVertically){
-        KisFixedPaintDeviceSP mirrorDab(new KisFixedPaintDevice(dab->colorSpace()));
+        KisFixedPaintDeviceSP mirrorDab(new KisFixedPaintDevice(dab->colorSpace(), d->memoryAllocator));
         QRect dabRc( QPoint(0,0), QSize(rc.width(),rc.height()) );
         mirrorDab->setRect(dabRc);
         mirrorDab->lazyGrowBufferWithoutInitialization();
@@ -2992,7 +3012,7 @@ void KisPainter::renderMirrorMask(QRect rc, KisPaintDeviceSP dab){
 void KisPainter::renderMirrorMask(QRect rc, KisPaintDeviceSP dab, int sx, int sy, KisFixedPaintDeviceSP mask)
 {
     if (d->mirrorHorizontally || d->mirrorVertically){
-        KisFixedPaintDeviceSP mirrorDab(new KisFixedPaintDevice(dab->colorSpace()));
+        KisFixedPaintDeviceSP mirrorDab(new KisFixedPaintDevice(dab->colorSpace(), d->memoryAllocator));
         QRect dabRc( QPoint(0,0), QSize(rc.width(),rc.height()) );
         mirrorDab->setRect(dabRc);
         mirrorDab->lazyGrowBufferWithoutInitialization();
@@ -21,6 +21,7 @@
 
 #include "kundo2magicstring.h"
 #include "kis_types.h"
+#include "KisOptimizedByteArray.h"
 #include <kis_filter_configuration.h>
 #include <kritaimage_export.h>
 
@@ -854,6 +855,22 @@ public:
      */
     KisRunnableStrokeJobsInterface* runnableStrokeJobsInterface() const;
 
+    /**
+     * Set the allocator for the temporary buffers of the painter (the
+     * intermediate buffers of bltFixed() and friends and the mirrored
+     * dabs). The paintops also use it for allocating their dabs, so that
+     * all the buffers of a stroke could be recycled in one pool, owned by
+     * the stroke.
+     *
+     * Null allocator means that the default (system) allocator is used.
+     */
+    void setMemoryAllocator(KisOptimizedByteArray::MemoryAllocatorSP allocator);
+
+    /**
+     * \see setMemoryAllocator()
+     */
+    KisOptimizedByteArray::MemoryAllocatorSP memoryAllocator() const;
+
 protected:
     /// Initialize, set everything to '0' or defaults
     void init();
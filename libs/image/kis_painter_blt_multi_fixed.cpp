@@ -12,118 +12,111 @@
 #include "kis_random_accessor_ng.h"
 #include "KisRenderedDab.h"
 
-void KisPainter::Private::applyDevice(const QRect &applyRect,
-                                      const KisRenderedDab &dab,
-                                      KisRandomAccessorSP dstIt,
-                                      const KoColorSpace *srcColorSpace,
-                                      KoCompositeOp::ParameterInfo &localParamInfo)
+void KisPainter::Private::applyDabsTileMajor(const QRect &applyRect,
+                                             const QList<KisRenderedDab> &dabs,
+                                             KisRandomAccessorSP dstIt,
+                                             KisRandomConstAccessorSP maskIt,
+                                             const KoColorSpace *srcColorSpace,
+                                             KoCompositeOp::ParameterInfo &localParamInfo)
 {
-    const QRect dabRect = dab.realBounds();
-    const QRect rc = applyRect & dabRect;
+    const KoCompositeOp *op = compositeOp(srcColorSpace);
 
     const int srcPixelSize = srcColorSpace->pixelSize();
-    const int dabRowStride = srcPixelSize * dabRect.width();
+    const int dstPixelSize = device->pixelSize();
+    const int maskPixelSize = maskIt ? selection->projection()->pixelSize() : 0;
 
+    QVector<const KisRenderedDab*> rowDabs;
+    rowDabs.reserve(dabs.size());
 
-    qint32 dstY = rc.y();
-    qint32 rowsRemaining = rc.height();
+    qint32 dstY = applyRect.y();
+    qint32 rowsRemaining = applyRect.height();
 
     while (rowsRemaining > 0) {
-        qint32 dstX = rc.x();
-
-        qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
-        qint32 rows = qMin(rowsRemaining, numContiguousDstRows);
-
-        qint32 columnsRemaining = rc.width();
-
-        while (columnsRemaining > 0) {
-
-            qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
-            qint32 columns = qMin(numContiguousDstColumns, columnsRemaining);
-
-            qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
-            dstIt->moveTo(dstX, dstY);
-
-            localParamInfo.dstRowStart   = dstIt->rawData();
-            localParamInfo.dstRowStride  = dstRowStride;
-            localParamInfo.maskRowStart  = 0;
-            localParamInfo.maskRowStride = 0;
-            localParamInfo.rows          = rows;
-            localParamInfo.cols          = columns;
-
-
-            const int dabX = dstX - dabRect.x();
-            const int dabY = dstY - dabRect.y();
-
-            localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
-            localParamInfo.srcRowStride  = dabRowStride;
-            localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
-            localParamInfo.flow = dab.flow;
-            colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp(srcColorSpace), renderingIntent, conversionFlags);
-
-            dstX += columns;
-            columnsRemaining -= columns;
+        qint32 rows = qMin(rowsRemaining, dstIt->numContiguousRows(dstY));
+        if (maskIt) {
+            rows = qMin(rows, maskIt->numContiguousRows(dstY));
         }
 
-        dstY += rows;
-        rowsRemaining -= rows;
-    }
-
-}
-
-void KisPainter::Private::applyDeviceWithSelection(const QRect &applyRect,
-                                                   const KisRenderedDab &dab,
-                                                   KisRandomAccessorSP dstIt,
-                                                   KisRandomConstAccessorSP maskIt,
-                                                   const KoColorSpace *srcColorSpace,
-                                                   KoCompositeOp::ParameterInfo &localParamInfo)
-{
-    const QRect dabRect = dab.realBounds();
-    const QRect rc = applyRect & dabRect;
+        const QRect rowRect(applyRect.x(), dstY, applyRect.width(), rows);
 
-    const int srcPixelSize = srcColorSpace->pixelSize();
-    const int dabRowStride = srcPixelSize * dabRect.width();
-
-
-    qint32 dstY = rc.y();
-    qint32 rowsRemaining = rc.height();
-
-    while (rowsRemaining > 0) {
-        qint32 dstX = rc.x();
-
-        qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
-        qint32 numContiguousMaskRows = maskIt->numContiguousRows(dstY);
-        qint32 rows = qMin(rowsRemaining, qMin(numContiguousDstRows, numContiguousMaskRows));
-
-        qint32 columnsRemaining = rc.width();
-
-        while (columnsRemaining > 0) {
-
-            qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
-            qint32 numContiguousMaskColumns = maskIt->numContiguousColumns(dstX);
-            qint32 columns = qMin(columnsRemaining, qMin(numContiguousDstColumns, numContiguousMaskColumns));
-
-            qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
-            qint32 maskRowStride = maskIt->rowStride(dstX, dstY);
-            dstIt->moveTo(dstX, dstY);
-            maskIt->moveTo(dstX, dstY);
-
-            localParamInfo.dstRowStart   = dstIt->rawData();
-            localParamInfo.dstRowStride  = dstRowStride;
-            localParamInfo.maskRowStart  = maskIt->rawDataConst();
-            localParamInfo.maskRowStride = maskRowStride;
-            localParamInfo.rows          = rows;
-            localParamInfo.cols          = columns;
-
-
-            const int dabX = dstX - dabRect.x();
-            const int dabY = dstY - dabRect.y();
+        // only the dabs touching the current row of tiles are
+        // checked against every tile of the row
+        rowDabs.clear();
+        for (const KisRenderedDab &dab : dabs) {
+            if (dab.realBounds().intersects(rowRect)) {
+                rowDabs.append(&dab);
+            }
+        }
 
-            localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
-            localParamInfo.srcRowStride  = dabRowStride;
-            localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
-            localParamInfo.flow = dab.flow;
-            colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp(srcColorSpace), renderingIntent, conversionFlags);
+        qint32 dstX = applyRect.x();
+        qint32 columnsRemaining = applyRect.width();
+
+        while (columnsRemaining > 0 && !rowDabs.isEmpty()) {
+            qint32 columns = qMin(columnsRemaining, dstIt->numContiguousColumns(dstX));
+            if (maskIt) {
+                columns = qMin(columns, maskIt->numContiguousColumns(dstX));
+            }
+
+            const QRect tileRect(dstX, dstY, columns, rows);
+
+            /**
+             * The tile is locked only once for all the dabs overlapping
+             * it, and only if there is at least one such dab. The dabs are
+             * composited in their original order, so the result is the
+             * same as if they were painted one-by-one.
+             */
+            bool tileAcquired = false;
+            quint8 *dstTileStart = 0;
+            qint32 dstRowStride = 0;
+            const quint8 *maskTileStart = 0;
+            qint32 maskRowStride = 0;
+
+            Q_FOREACH (const KisRenderedDab *dab, rowDabs) {
+                const QRect dabRect = dab->realBounds();
+                const QRect rc = tileRect & dabRect;
+                if (rc.isEmpty()) continue;
+
+                if (!tileAcquired) {
+                    dstRowStride = dstIt->rowStride(dstX, dstY);
+                    dstIt->moveTo(dstX, dstY);
+                    dstTileStart = dstIt->rawData();
+
+                    if (maskIt) {
+                        maskRowStride = maskIt->rowStride(dstX, dstY);
+                        maskIt->moveTo(dstX, dstY);
+                        maskTileStart = maskIt->rawDataConst();
+                    }
+
+                    tileAcquired = true;
+                }
+
+                const int tileX = rc.x() - dstX;
+                const int tileY = rc.y() - dstY;
+
+                localParamInfo.dstRowStart   = dstTileStart + tileY * dstRowStride + tileX * dstPixelSize;
+                localParamInfo.dstRowStride  = dstRowStride;
+
+                if (maskIt) {
+                    localParamInfo.maskRowStart  = maskTileStart + tileY * maskRowStride + tileX * maskPixelSize;
+                    localParamInfo.maskRowStride = maskRowStride;
+                } else {
+                    localParamInfo.maskRowStart  = 0;
+                    localParamInfo.maskRowStride = 0;
+                }
+
+                localParamInfo.rows          = rc.height();
+                localParamInfo.cols          = rc.width();
+
+                const int dabX = rc.x() - dabRect.x();
+                const int dabY = rc.y() - dabRect.y();
+                const int dabRowStride = srcPixelSize * dabRect.width();
+
+                localParamInfo.srcRowStart   = dab->device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
+                localParamInfo.srcRowStride  = dabRowStride;
+                localParamInfo.setOpacityAndAverage(dab->opacity, dab->averageOpacity);
+                localParamInfo.flow = dab->flow;
+                colorSpace->bitBlt(srcColorSpace, localParamInfo, op, renderingIntent, conversionFlags);
+            }
 
             dstX += columns;
             columnsRemaining -= columns;
@@ -132,7 +125,6 @@ void KisPainter::Private::applyDeviceWithSelection(const QRect &applyRect,
         dstY += rows;
         rowsRemaining -= rows;
     }
-
 }
 
 void KisPainter::bltFixed(const QRect &applyRect, const QList<KisRenderedDab> allSrcDevices)
@@ -168,15 +160,7 @@ void KisPainter::bltFixed(const QRect &applyRect, const QList<KisRenderedDab> al
     KisRandomAccessorSP dstIt = d->device->createRandomAccessorNG();
     KisRandomConstAccessorSP maskIt = d->selection ? d->selection->projection()->createRandomConstAccessorNG() : 0;
 
-    if (maskIt) {
-        Q_FOREACH (const KisRenderedDab &dab, devices) {
-            d->applyDeviceWithSelection(rc, dab, dstIt, maskIt, srcColorSpace, localParamInfo);
-        }
-    } else {
-        Q_FOREACH (const KisRenderedDab &dab, devices) {
-            d->applyDevice(rc, dab, dstIt, srcColorSpace, localParamInfo);
-        }
-    }
+    d->applyDabsTileMajor(rc, devices, dstIt, maskIt, srcColorSpace, localParamInfo);
 
 
 #if 0
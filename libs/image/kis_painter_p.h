@@ -67,6 +67,17 @@ struct Q_DECL_HIDDEN KisPainter::Private {
     QScopedPointer<KisRunnableStrokeJobsInterface> fakeRunnableStrokeJobsInterface;
     QTransform                  patternTransform;
 
+    KisOptimizedByteArray::MemoryAllocatorSP memoryAllocator;
+
+    /**
+     * Intermediate buffers for bitBlt/bltFixed with fixed selections. They
+     * are kept between the calls, so painting of dabs of the same size does
+     * not allocate anything.
+     */
+    KisOptimizedByteArray       dstBytesBuffer;
+    KisOptimizedByteArray       srcBytesBuffer;
+    KisOptimizedByteArray       maskBytesBuffer;
+
     const KoCompositeOp*        compositeOp(const KoColorSpace *srcCS);
 
     bool tryReduceSourceRect(const KisPaintDevice *srcDev,
@@ -80,18 +91,17 @@ struct Q_DECL_HIDDEN KisPainter::Private {
 
     void fillPainterPathImpl(const QPainterPath& path, const QRect &requestedRect);
 
-    void applyDevice(const QRect &applyRect,
-                     const KisRenderedDab &dab,
-                     KisRandomAccessorSP dstIt,
-                     const KoColorSpace *srcColorSpace,
-                     KoCompositeOp::ParameterInfo &localParamInfo);
-
-    void applyDeviceWithSelection(const QRect &applyRect,
-                                  const KisRenderedDab &dab,
-                                  KisRandomAccessorSP dstIt,
-                                  KisRandomConstAccessorSP maskIt,
-                                  const KoColorSpace *srcColorSpace,
-                                  KoCompositeOp::ParameterInfo &localParamInfo);
+    /**
+     * Composite \p dabs onto the device tile-by-tile: every tile of
+     * \p applyRect is locked once and all the dabs overlapping it are
+     * applied in order. \p maskIt may be null if there is no selection.
+     */
+    void applyDabsTileMajor(const QRect &applyRect,
+                            const QList<KisRenderedDab> &dabs,
+                            KisRandomAccessorSP dstIt,
+                            KisRandomConstAccessorSP maskIt,
+                            const KoColorSpace *srcColorSpace,
+                            KoCompositeOp::ParameterInfo &localParamInfo);
 
     template<class T> QVector<T> calculateMirroredObjects(const T &object);
 
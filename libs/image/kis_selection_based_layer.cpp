@@ -382,3 +382,8 @@ int KisSelectionBasedLayer::thumbnailSeqNo() const
     return originalDevice && originalSelection ? originalDevice->sequenceNumber() : -1;
 }
 
+KisPaintDeviceSP KisSelectionBasedLayer::thumbnailDevice() const
+{
+    return internalSelection() ? original() : 0;
+}
+
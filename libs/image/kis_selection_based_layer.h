@@ -153,6 +153,7 @@ public:
     QImage createThumbnail(qint32 w, qint32 h, Qt::AspectRatioMode aspectRatioMode = Qt::IgnoreAspectRatio) override;
 
     int thumbnailSeqNo() const override;
+    KisPaintDeviceSP thumbnailDevice() const override;
 
 
 protected:
@@ -8,6 +8,8 @@
 #include "kis_selection_filters.h"
 
 #include <algorithm>
+#include <array>
+#include <vector>
 
 #include <klocalizedstring.h>
 
@@ -15,12 +17,161 @@
 #include "kis_convolution_painter.h"
 #include "kis_convolution_kernel.h"
 #include "kis_pixel_selection.h"
+#include "KisDistanceTransform.h"
 #include <kis_sequential_iterator.h>
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define RINT(x) floor ((x) + 0.5)
 
+namespace {
+
+/**
+ * The approximate cost of dilating one level of a selection with the
+ * distance transform, measured in the steps of the direct morphology
+ * algorithms below. The direct algorithms need about (xRadius + yRadius)
+ * steps per pixel, so they are still used for small radii.
+ *
+ * Every level is processed separately and exactly, so an antialiased
+ * selection, which has most of the 255 levels, takes the distance
+ * transform path only for very big radii.
+ */
+const int DistanceTransformCost = 4;
+
+inline bool useDistanceTransform(qint32 xRadius, qint32 yRadius, int numLevels)
+{
+    return numLevels * DistanceTransformCost < xRadius + yRadius;
+}
+
+/**
+ * @return the levels of the selection that should be dilated separately,
+ * in descending order. When \p invert is true, the levels of the inverted
+ * selection are returned.
+ */
+QVector<int> morphologyLevels(KisPixelSelectionSP pixelSelection, const QRect &rect, bool invert)
+{
+    std::array<bool, 256> present {};
+
+    KisSequentialConstIterator it(pixelSelection, rect);
+    while (it.nextPixel()) {
+        present[*it.rawDataConst()] = true;
+    }
+
+    QVector<int> levels;
+    for (int level = 255; level > 0; level--) {
+        if (present[invert ? 255 - level : level]) {
+            levels << level;
+        }
+    }
+
+    return levels;
+}
+
+/**
+ * Dilates \p rect of the selection with an elliptic structuring element
+ * using the threshold decomposition: every level of the selection is
+ * dilated as a binary mask with the help of the distance transform, and
+ * the result is the highest level whose dilated mask covers the pixel.
+ * The erosion is calculated as the dilation of the inverted selection.
+ *
+ * The pixels outside \p rect are considered unselected, except for the
+ * erosion without the edge lock, where they are the opposite: the
+ * selection is eroded from the borders of the rect.
+ */
+void morphologyWithDistanceTransform(KisPixelSelectionSP pixelSelection, const QRect &rect,
+                                     qint32 xRadius, qint32 yRadius,
+                                     bool erode, bool edgeLock,
+                                     const QVector<int> &levels)
+{
+    /**
+     * The result depends on the rows that are less than yRadius apart
+     * only, so the rect is processed in bands to limit the memory usage
+     */
+    const int bandHeight = qMax(256, 2 * yRadius);
+
+    /**
+     * The radius is extended by half a pixel to make the structuring
+     * element as wide as the one produced by computeBorder()
+     */
+    const float xWeight = 1.0f / pow2(xRadius + 0.5f);
+    const float yWeight = 1.0f / pow2(yRadius + 0.5f);
+
+    const quint8 outsideValue = erode && !edgeLock ? 255 : 0;
+
+    // the bands are written while the following ones are still being read
+    KisPaintDeviceSP source = new KisPaintDevice(*pixelSelection);
+
+    for (int bandTop = rect.top(); bandTop <= rect.bottom(); bandTop += bandHeight) {
+        const QRect bandRect = rect & QRect(rect.x(), bandTop, rect.width(), bandHeight);
+        const QRect readRect = rect & bandRect.adjusted(0, -yRadius, 0, yRadius);
+
+        // the buffers have a one pixel frame for the pixels outside the rect
+        const int width = readRect.width() + 2;
+        const int height = readRect.height() + 2;
+
+        std::vector<quint8> values(size_t(width) * height, outsideValue);
+
+        {
+            std::vector<quint8> rows(size_t(readRect.width()) * readRect.height());
+            source->readBytes(rows.data(), readRect);
+
+            for (int y = 0; y < readRect.height(); y++) {
+                const quint8 *srcPtr = rows.data() + size_t(y) * readRect.width();
+                quint8 *dstPtr = values.data() + size_t(y + 1) * width + 1;
+
+                if (erode) {
+                    for (int x = 0; x < readRect.width(); x++) {
+                        dstPtr[x] = 255 - srcPtr[x];
+                    }
+                } else {
+                    memcpy(dstPtr, srcPtr, readRect.width());
+                }
+            }
+        }
+
+        // the frame rows lying inside the rect are too far to affect the band
+        if (readRect.top() != rect.top()) {
+            std::fill_n(values.begin(), width, 0);
+        }
+        if (readRect.bottom() != rect.bottom()) {
+            std::fill_n(values.begin() + size_t(height - 1) * width, width, 0);
+        }
+
+        const int bandOffset = bandRect.top() - readRect.top() + 1;
+        std::vector<quint8> result(size_t(bandRect.width()) * bandRect.height(), 0);
+        std::vector<float> distances(values.size());
+
+        for (int level : levels) {
+            for (size_t i = 0; i < values.size(); i++) {
+                distances[i] = values[i] >= level ? 0.0f : KisDistanceTransform::Infinity;
+            }
+
+            KisDistanceTransform::transform(distances.data(), width, height, xWeight, yWeight);
+
+            for (int y = 0; y < bandRect.height(); y++) {
+                const float *distPtr = distances.data() + size_t(y + bandOffset) * width + 1;
+                quint8 *resultPtr = result.data() + size_t(y) * bandRect.width();
+
+                for (int x = 0; x < bandRect.width(); x++) {
+                    if (!resultPtr[x] && distPtr[x] <= 1.0f) {
+                        resultPtr[x] = level;
+                    }
+                }
+            }
+        }
+
+        if (erode) {
+            for (quint8 &value : result) {
+                value = 255 - value;
+            }
+        }
+
+        pixelSelection->writeBytes(result.data(), bandRect);
+    }
+}
+
+}
+
 KisSelectionFilter::~KisSelectionFilter()
 {
 }
@@ -266,6 +417,11 @@ void KisBorderSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (useDistanceTransform(m_xRadius, m_yRadius, 1)) {
+        processWithDistanceTransform(pixelSelection, rect);
+        return;
+    }
+
     quint8  *buf[3];
     quint8 **density;
     quint8 **transition;
@@ -488,6 +644,95 @@ void KisBorderSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
     delete[] density;
 }
 
+void KisBorderSelectionFilter::processWithDistanceTransform(KisPixelSelectionSP pixelSelection, const QRect &rect)
+{
+    /**
+     * The border is the set of pixels lying closer than the radius to
+     * the transition pixels of the selection, and its density depends
+     * only on the distance to the nearest one, so it can be taken
+     * directly from the distance transform of the transitions.
+     */
+
+    const int bandHeight = qMax(256, 2 * m_yRadius);
+
+    float xWeight = 1.0f;
+    float yWeight = 1.0f;
+
+    if (!m_antialiasing) {
+        xWeight = 1.0f / pow2(m_xRadius + 0.5f);
+        yWeight = 1.0f / pow2(m_yRadius + 0.5f);
+    } else {
+        KIS_SAFE_ASSERT_RECOVER_NOOP(m_xRadius == m_yRadius && "anisotropic fading is not implemented");
+    }
+
+    const qreal maxRadius = 0.5 * (m_xRadius + m_yRadius);
+    const qreal minRadius = maxRadius - 1.0;
+
+    // the bands are written while the following ones are still being read
+    KisPaintDeviceSP source = new KisPaintDevice(*pixelSelection);
+
+    for (int bandTop = rect.top(); bandTop <= rect.bottom(); bandTop += bandHeight) {
+        const QRect bandRect = rect & QRect(rect.x(), bandTop, rect.width(), bandHeight);
+        const QRect transitionRect = rect & bandRect.adjusted(0, -m_yRadius, 0, m_yRadius);
+        const QRect readRect = rect & transitionRect.adjusted(0, -1, 0, 1);
+
+        const int width = rect.width();
+
+        std::vector<quint8> src(size_t(width) * readRect.height());
+        source->readBytes(src.data(), readRect);
+
+        // the rows outside the rect are the copies of its edge rows
+        auto srcRow = [&] (int y) {
+            y = qBound(rect.top(), y, rect.bottom());
+            return src.data() + size_t(y - readRect.top()) * width;
+        };
+
+        std::vector<float> distances(size_t(width) * transitionRect.height());
+        std::vector<quint8> transition(width);
+
+        for (int y = 0; y < transitionRect.height(); y++) {
+            const int srcY = transitionRect.top() + y;
+            quint8 *buf[3] = {srcRow(srcY - 1), srcRow(srcY), srcRow(srcY + 1)};
+
+            computeTransition(transition.data(), buf, width);
+
+            float *distPtr = distances.data() + size_t(y) * width;
+            for (int x = 0; x < width; x++) {
+                distPtr[x] = transition[x] ? 0.0f : KisDistanceTransform::Infinity;
+            }
+        }
+
+        KisDistanceTransform::transform(distances.data(), width, transitionRect.height(),
+                                        xWeight, yWeight);
+
+        std::vector<quint8> out(size_t(width) * bandRect.height());
+        const int bandOffset = bandRect.top() - transitionRect.top();
+
+        for (int y = 0; y < bandRect.height(); y++) {
+            const float *distPtr = distances.data() + size_t(y + bandOffset) * width;
+            quint8 *outPtr = out.data() + size_t(y) * width;
+
+            for (int x = 0; x < width; x++) {
+                if (!m_antialiasing) {
+                    outPtr[x] = distPtr[x] <= 1.0f ? 255 : 0;
+                } else {
+                    const qreal dist = std::sqrt(qreal(distPtr[x]));
+
+                    if (dist > maxRadius) {
+                        outPtr[x] = 0;
+                    } else if (dist > minRadius) {
+                        outPtr[x] = qRound((1.0 - dist + minRadius) * 255.0);
+                    } else {
+                        outPtr[x] = 255;
+                    }
+                }
+            }
+        }
+
+        pixelSelection->writeBytes(out.data(), bandRect);
+    }
+}
+
 
 KisFeatherSelectionFilter::KisFeatherSelectionFilter(qint32 radius)
     : m_radius(radius)
@@ -509,6 +754,13 @@ QRect KisFeatherSelectionFilter::changeRect(const QRect& rect, KisDefaultBoundsB
 
 void KisFeatherSelectionFilter::process(KisPixelSelectionSP pixelSelection, const QRect& rect)
 {
+    /**
+     * Feathering is a blur, not a morphological operation, so it cannot
+     * be expressed through the distance transform. The gaussian is used
+     * for all the radii, the convolution painter switches to the FFT
+     * engine for the big ones, so the cost stays bounded anyway.
+     */
+
     // compute horizontal kernel
     const uint kernelSize = m_radius * 2 + 1;
     Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussianMatrix(1, kernelSize);
@@ -561,6 +813,17 @@ void KisGrowSelectionFilter::process(KisPixelSelectionSP pixelSelection, const Q
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (useDistanceTransform(m_xRadius, m_yRadius, 1)) {
+        const QVector<int> levels = morphologyLevels(pixelSelection, rect, false);
+
+        if (useDistanceTransform(m_xRadius, m_yRadius, levels.size())) {
+            morphologyWithDistanceTransform(pixelSelection, rect,
+                                            m_xRadius, m_yRadius,
+                                            false, false, levels);
+            return;
+        }
+    }
+
     /**
         * Much code resembles Shrink filter, so please fix bugs
         * in both filters
@@ -688,6 +951,22 @@ void KisShrinkSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (useDistanceTransform(m_xRadius, m_yRadius, 1)) {
+        QVector<int> levels = morphologyLevels(pixelSelection, rect, true);
+
+        // without the edge lock the area outside the rect is a level as well
+        if (!m_edgeLock && (levels.isEmpty() || levels.first() != 255)) {
+            levels.prepend(255);
+        }
+
+        if (useDistanceTransform(m_xRadius, m_yRadius, levels.size())) {
+            morphologyWithDistanceTransform(pixelSelection, rect,
+                                            m_xRadius, m_yRadius,
+                                            true, m_edgeLock, levels);
+            return;
+        }
+    }
+
     /*
         pretty much the same as fatten_region only different
         blame all bugs in this function on jaycox@gimp.org
@@ -69,6 +69,13 @@ public:
 
     void process(KisPixelSelectionSP pixelSelection, const QRect &rect) override;
 
+private:
+    /**
+     * Renders the border using the distance transform of the transition
+     * pixels, the cost doesn't depend on the radius
+     */
+    void processWithDistanceTransform(KisPixelSelectionSP pixelSelection, const QRect &rect);
+
 private:
     qint32 m_xRadius;
     qint32 m_yRadius;
@@ -13,6 +13,9 @@
 #include "kis_pointer_utils.h"
 #include "KisRunnableStrokeJobUtils.h"
 
+#include <QAtomicInt>
+#include <QThread>
+
 struct KisSyncLodCacheStrokeStrategy::Private
 {
     KisImageWSP image;
@@ -59,11 +62,6 @@ void KisSyncLodCacheStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &
     using KritaUtils::splitRegionIntoPatches;
     using KritaUtils::optimalPatchSize;
 
-    using SharedData = QHash<KisPaintDeviceSP, QSharedPointer<KisPaintDevice::LodDataStruct>>;
-    using SharedDataSP = QSharedPointer<SharedData>;
-
-    SharedDataSP sharedData(new SharedData());
-
     KisPaintDeviceList deviceList = extraDevices;
 
     recursiveApplyNodes(imageRoot,
@@ -73,30 +71,66 @@ void KisSyncLodCacheStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &
 
     KritaUtils::makeContainerUnique(deviceList);
 
+    /**
+     * The lod planes are synced incrementally, only the tiles changed
+     * since the previous sync are regenerated. The dirty regions are
+     * known only after the updates are blocked, so the patches are put
+     * into a shared queue and processed by a fixed number of concurrent
+     * jobs, which are created beforehand.
+     */
+    struct SharedData {
+        SharedData(const KisPaintDeviceList &_devices)
+            : devices(_devices),
+              lodData(_devices.size()),
+              dirtyPatches(_devices.size())
+        {
+        }
+
+        KisPaintDeviceList devices;
+        QVector<QSharedPointer<KisPaintDevice::LodDataStruct>> lodData;
+        QVector<QVector<QRect>> dirtyPatches;
+
+        QVector<QPair<int, QRect>> patches;
+        QAtomicInt nextPatch;
+    };
+    using SharedDataSP = QSharedPointer<SharedData>;
+
+    SharedDataSP sharedData(new SharedData(deviceList));
+
     KritaUtils::addJobBarrierNoCancel(jobs, [updatesFacade] () {
         updatesFacade->blockUpdates();
     });
 
-    KritaUtils::addJobBarrier(jobs, [sharedData, deviceList, levelOfDetail] () mutable {
-        Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-            sharedData->insert(device, toQShared(device->createLodDataStruct(levelOfDetail)));
+    for (int i = 0; i < deviceList.size(); i++) {
+        KritaUtils::addJobConcurrent(jobs, [sharedData, i, levelOfDetail] () mutable {
+            KisRegion dirtyRegion;
+            sharedData->lodData[i] = toQShared(
+                sharedData->devices.at(i)->createIncrementalLodDataStruct(levelOfDetail, &dirtyRegion));
+            sharedData->dirtyPatches[i] = splitRegionIntoPatches(dirtyRegion, optimalPatchSize());
+        });
+    }
+
+    KritaUtils::addJobSequential(jobs, [sharedData] () mutable {
+        for (int i = 0; i < sharedData->dirtyPatches.size(); i++) {
+            Q_FOREACH (const QRect &rc, sharedData->dirtyPatches[i]) {
+                sharedData->patches.append(qMakePair(i, rc));
+            }
         }
+        sharedData->dirtyPatches.clear();
     });
 
-    KritaUtils::addJobSequential(jobs, [](){});
-
-    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-        KisRegion region = device->regionForLodSyncing();
-        QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
+    const int numWorkers = qMax(1, QThread::idealThreadCount());
 
-        Q_FOREACH (const QRect &rc, rects) {
-            KritaUtils::addJobConcurrent(jobs, [sharedData, device, rc] () mutable {
-                KIS_ASSERT(sharedData->contains(device));
+    for (int worker = 0; worker < numWorkers; worker++) {
+        KritaUtils::addJobConcurrent(jobs, [sharedData] () mutable {
+            int index = 0;
+            while ((index = sharedData->nextPatch.fetchAndAddOrdered(1)) < sharedData->patches.size()) {
+                const QPair<int, QRect> &patch = sharedData->patches.at(index);
 
-                KisPaintDevice::LodDataStruct *data = sharedData->value(device).data();
-                device->updateLodDataStruct(data, rc);
-            });
-        }
+                KisPaintDevice::LodDataStruct *data = sharedData->lodData.at(patch.first).data();
+                sharedData->devices.at(patch.first)->updateLodDataStruct(data, patch.second);
+            }
+        });
     }
 
     KritaUtils::addJobSequential(jobs, [](){});
@@ -109,12 +143,8 @@ void KisSyncLodCacheStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &
         });
 
     KritaUtils::addJobSequential(jobs, [sharedData] () mutable {
-        auto it = sharedData->begin();
-        auto end = sharedData->end();
-
-        for (; it != end; ++it) {
-            KisPaintDeviceSP dev = it.key();
-            dev->uploadLodDataStruct(it.value().data());
+        for (int i = 0; i < sharedData->devices.size(); i++) {
+            sharedData->devices.at(i)->uploadLodDataStruct(sharedData->lodData.at(i).data());
         }
     });
 
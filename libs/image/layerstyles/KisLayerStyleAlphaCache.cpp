@@ -0,0 +1,221 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLayerStyleAlphaCache.h"
+
+#include <vector>
+#include <cstring>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+
+#include <KoColorSpace.h>
+
+#include "kis_paint_device.h"
+#include "kis_pixel_selection.h"
+#include "kis_default_bounds_base.h"
+#include "kis_iterator_ng.h"
+#include "krita_utils.h"
+#include "kis_algebra_2d.h"
+
+
+namespace {
+/**
+ * The size of the patches the alpha is compared in. It is equal to the
+ * size of the tiles of the paint devices, so that the changes are tracked
+ * with the same granularity the devices use.
+ */
+const int patchSize = 64;
+
+/**
+ * The valid region collects the commit rects of all the updates, which
+ * are not aligned to anything, so it would fragment without limit.
+ */
+const int maxValidRegionRects = 256;
+
+/**
+ * Shrinks \p region to the patches lying entirely inside it. It is safe
+ * to forget about a part of the valid region, it will just be reported
+ * as changed once more.
+ */
+QRegion compactValidRegion(const QRegion &region)
+{
+    using KisAlgebra2D::divideFloor;
+
+    const QRect bounds = region.boundingRect();
+
+    const int firstColumn = divideFloor(bounds.left() + patchSize - 1, patchSize);
+    const int lastColumn = divideFloor(bounds.right() + 1, patchSize) - 1;
+    const int firstRow = divideFloor(bounds.top() + patchSize - 1, patchSize);
+    const int lastRow = divideFloor(bounds.bottom() + 1, patchSize) - 1;
+
+    QRegion result;
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        int runStart = -1;
+
+        for (int column = firstColumn; column <= lastColumn + 1; column++) {
+            const bool isValid =
+                column <= lastColumn &&
+                (QRegion(column * patchSize, row * patchSize, patchSize, patchSize) - region).isEmpty();
+
+            if (isValid && runStart < 0) {
+                runStart = column;
+            } else if (!isValid && runStart >= 0) {
+                result += QRect(runStart * patchSize, row * patchSize,
+                                (column - runStart) * patchSize, patchSize);
+                runStart = -1;
+            }
+        }
+    }
+
+    /**
+     * A checkerboard-like region may still be too complex, keep
+     * only its biggest rect then
+     */
+    if (result.rectCount() > maxValidRegionRects) {
+        QRect biggestRect;
+        for (const QRect &rc : result) {
+            if (qint64(rc.width()) * rc.height() >
+                qint64(biggestRect.width()) * biggestRect.height()) {
+
+                biggestRect = rc;
+            }
+        }
+        result = biggestRect;
+    }
+
+    return result;
+}
+
+}
+
+struct KisLayerStyleAlphaCache::Private
+{
+    QMutex mutex;
+
+    KisPixelSelectionSP alpha;
+    QRegion validRegion;
+    int levelOfDetail = 0;
+    QRect bounds;
+};
+
+KisLayerStyleAlphaCache::KisLayerStyleAlphaCache()
+    : m_d(new Private)
+{
+}
+
+KisLayerStyleAlphaCache::~KisLayerStyleAlphaCache()
+{
+}
+
+QVector<QRect> KisLayerStyleAlphaCache::update(KisPaintDeviceSP src, const QRect &compareRect, const QRect &commitRect)
+{
+    QVector<QRect> changedRects;
+    if (compareRect.isEmpty()) return changedRects;
+
+    /**
+     * The mutex guards only the bookkeeping, the comparison itself runs
+     * without it. The cached alpha device can be accessed concurrently,
+     * and the updates running in parallel commit the same source pixels
+     * anyway.
+     */
+    KisPixelSelectionSP alpha;
+    QRegion validRegion;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        /**
+         * Levels of detail of the source device have different sets of
+         * pixels, so the cache keeps only one of them. The bounds are
+         * checked, because some of the styles align their fill with them.
+         */
+        const int levelOfDetail = src->defaultBounds()->currentLevelOfDetail();
+        const QRect bounds = src->defaultBounds()->bounds();
+
+        if (!m_d->alpha ||
+            m_d->levelOfDetail != levelOfDetail ||
+            m_d->bounds != bounds) {
+
+            m_d->alpha = new KisPixelSelection();
+            m_d->validRegion = QRegion();
+            m_d->levelOfDetail = levelOfDetail;
+            m_d->bounds = bounds;
+        }
+
+        alpha = m_d->alpha;
+        validRegion = m_d->validRegion & compareRect;
+    }
+
+    const KoColorSpace *cs = src->colorSpace();
+
+    std::vector<quint8> newAlpha;
+    std::vector<quint8> oldAlpha;
+
+    Q_FOREACH (const QRect &patch, KritaUtils::splitRectIntoPatches(compareRect, QSize(patchSize, patchSize))) {
+        const size_t numPixels = size_t(patch.width()) * patch.height();
+        newAlpha.resize(numPixels);
+
+        {
+            quint8 *dstPtr = newAlpha.data();
+
+            KisSequentialConstIterator srcIt(src, patch);
+            while (srcIt.nextPixel()) {
+                *dstPtr++ = cs->opacityU8(srcIt.rawDataConst());
+            }
+        }
+
+        bool patchChanged = true;
+
+        if ((QRegion(patch) - validRegion).isEmpty()) {
+            oldAlpha.resize(numPixels);
+            alpha->readBytes(oldAlpha.data(), patch);
+            patchChanged = std::memcmp(oldAlpha.data(), newAlpha.data(), numPixels) != 0;
+        }
+
+        if (!patchChanged) continue;
+
+        changedRects << patch;
+
+        const QRect committedRect = patch & commitRect;
+
+        if (committedRect == patch) {
+            alpha->writeBytes(newAlpha.data(), patch);
+        } else if (!committedRect.isEmpty()) {
+            for (int y = committedRect.top(); y <= committedRect.bottom(); y++) {
+                const quint8 *rowPtr = newAlpha.data() +
+                    size_t(y - patch.y()) * patch.width() + (committedRect.x() - patch.x());
+
+                alpha->writeBytes(rowPtr, QRect(committedRect.x(), y, committedRect.width(), 1));
+            }
+        }
+    }
+
+    if (!commitRect.isEmpty()) {
+        QMutexLocker l(&m_d->mutex);
+
+        // the cache might have been reset while we were comparing
+        if (m_d->alpha == alpha) {
+            m_d->validRegion += commitRect & compareRect;
+
+            if (m_d->validRegion.rectCount() > maxValidRegionRects) {
+                m_d->validRegion = compactValidRegion(m_d->validRegion);
+            }
+        }
+    }
+
+    return changedRects;
+}
+
+void KisLayerStyleAlphaCache::invalidate()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->alpha = 0;
+    m_d->validRegion = QRegion();
+}
@@ -0,0 +1,61 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISLAYERSTYLEALPHACACHE_H
+#define KISLAYERSTYLEALPHACACHE_H
+
+#include <QScopedPointer>
+#include <QVector>
+#include <QRect>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * Keeps a copy of the alpha channel of the source layer of a layer style,
+ * as it was when the styles were calculated the last time.
+ *
+ * All the layer style filters depend on the alpha channel of the source
+ * only, so when the walker asks the style planes to recalculate an area,
+ * they may skip the parts, whose alpha has not changed since the previous
+ * calculation. That is a usual case for the strokes: the dirty rects of the
+ * updates are usually much bigger than the areas the brush has actually
+ * touched.
+ *
+ * The comparison is done in tile-sized patches, the cache reports the
+ * patches whose alpha has changed. The cache is reset when the level of
+ * detail or the bounds of the source device change.
+ */
+class KRITAIMAGE_EXPORT KisLayerStyleAlphaCache
+{
+public:
+    KisLayerStyleAlphaCache();
+    ~KisLayerStyleAlphaCache();
+
+    /**
+     * Compares the alpha channel of \p src in \p compareRect with the cached
+     * one. The new alpha is stored in the cache only inside \p commitRect,
+     * the caller should guarantee that everything that depends on these
+     * pixels is going to be recalculated.
+     *
+     * \return non-intersecting tile-sized patches of \p compareRect whose
+     *         alpha has changed. The pixels that have never been committed
+     *         before are considered changed.
+     */
+    QVector<QRect> update(KisPaintDeviceSP src, const QRect &compareRect, const QRect &commitRect);
+
+    /**
+     * Drops all the cached data, so the next call to update() will report
+     * the entire rect as changed
+     */
+    void invalidate();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISLAYERSTYLEALPHACACHE_H
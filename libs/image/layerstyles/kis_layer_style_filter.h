@@ -51,6 +51,16 @@ public:
      */
     virtual QRect changedRect(const QRect & rect, KisPSDLayerStyleSP style, KisLayerStyleFilterEnvironment *env) const = 0;
 
+    /**
+     * \return true if the result of the filter depends on nothing but the
+     * alpha channel of the source device. Then the filter projection plane
+     * may skip recalculation of the areas where the alpha didn't change
+     * (see KisLayerStyleAlphaCache).
+     *
+     * The default implementation returns false, which is always safe.
+     */
+    virtual bool dependsOnSourceAlphaOnly(KisPSDLayerStyleSP style) const;
+
 protected:
     KisLayerStyleFilter(const KisLayerStyleFilter &rhs);
 
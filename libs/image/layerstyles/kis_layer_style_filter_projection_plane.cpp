@@ -17,6 +17,7 @@
 #include "kis_painter.h"
 #include "kis_multiple_projection.h"
 #include "KisLayerStyleKnockoutBlower.h"
+#include "KisRegion.h"
 
 
 struct KisLayerStyleFilterProjectionPlane::Private
@@ -90,6 +91,59 @@ QRect KisLayerStyleFilterProjectionPlane::recalculate(const QRect& rect, KisNode
     return rect;
 }
 
+void KisLayerStyleFilterProjectionPlane::recalculateIncrementally(const QRect &rect,
+                                                                  const QVector<QRect> &changedSourceRects,
+                                                                  KisNodeSP filthyNode)
+{
+    if (!m_d->sourceLayer || !m_d->filter) {
+        warnKrita << "KisLayerStyleFilterProjectionPlane::recalculateIncrementally(): [BUG] is not initialized";
+        return;
+    }
+
+    if (!m_d->filter->dependsOnSourceAlphaOnly(m_d->style)) {
+        recalculate(rect, filthyNode);
+        return;
+    }
+
+    QVector<QRect> dirtyRects;
+
+    Q_FOREACH (const QRect &changedRect, changedSourceRects) {
+        dirtyRects << m_d->filter->changedRect(changedRect, m_d->style, m_d->environment.data());
+    }
+
+    KisRegion dirtyRegion = KisRegion::fromOverlappingRects(dirtyRects, 64);
+    dirtyRegion &= rect;
+
+    if (dirtyRegion.isEmpty()) return;
+
+    /**
+     * Every rect is processed together with its need-rect border, so
+     * many small rects may happen to be more expensive than a single
+     * bounding one.
+     */
+    auto processingCost = [this] (const QRect &rc) {
+        const QRect needRect = m_d->filter->neededRect(rc, m_d->style, m_d->environment.data());
+        return qint64(needRect.width()) * needRect.height();
+    };
+
+    const QVector<QRect> rects = dirtyRegion.rects();
+
+    qint64 partialCost = 0;
+    Q_FOREACH (const QRect &rc, rects) {
+        partialCost += processingCost(rc);
+    }
+
+    const QRect boundingRect = dirtyRegion.boundingRect();
+
+    if (partialCost < processingCost(boundingRect)) {
+        Q_FOREACH (const QRect &rc, rects) {
+            recalculate(rc, filthyNode);
+        }
+    } else {
+        recalculate(boundingRect, filthyNode);
+    }
+}
+
 void KisLayerStyleFilterProjectionPlane::apply(KisPainter *painter, const QRect &rect)
 {
     m_d->projection.apply(painter->device(), rect, m_d->environment.data());
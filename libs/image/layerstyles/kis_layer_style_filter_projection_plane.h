@@ -10,6 +10,7 @@
 #include "kis_abstract_projection_plane.h"
 
 #include <QScopedPointer>
+#include <QVector>
 
 #include "kis_types.h"
 
@@ -26,6 +27,16 @@ public:
     void setStyle(KisLayerStyleFilter *filter, KisPSDLayerStyleSP style);
 
     QRect recalculate(const QRect& rect, KisNodeSP filthyNode) override;
+
+    /**
+     * Recalculates only the parts of \p rect which may be affected by the
+     * changes of the source alpha channel in \p changedSourceRects. If the
+     * filter depends on anything else than the source alpha, the entire
+     * \p rect is recalculated.
+     */
+    void recalculateIncrementally(const QRect &rect,
+                                  const QVector<QRect> &changedSourceRects,
+                                  KisNodeSP filthyNode);
     void apply(KisPainter *painter, const QRect &rect) override;
 
     QRect needRect(const QRect &rect, KisLayer::PositionToFilthy pos) const override;
@@ -22,6 +22,7 @@
 #include "kis_painter.h"
 #include "kis_ls_utils.h"
 #include "KisLayerStyleKnockoutBlower.h"
+#include "KisLayerStyleAlphaCache.h"
 #include "krita_utils.h"
 
 struct Q_DECL_HIDDEN KisLayerStyleProjectionPlane::Private
@@ -35,6 +36,7 @@ struct Q_DECL_HIDDEN KisLayerStyleProjectionPlane::Private
 
     KisCachedPaintDevice cachedPaintDevice;
     KisCachedSelection cachedSelection;
+    KisLayerStyleAlphaCache alphaCache;
     KisLayer *sourceLayer = 0;
 
 
@@ -224,12 +226,27 @@ QRect KisLayerStyleProjectionPlane::recalculate(const QRect& rect, KisNodeSP fil
     QRect result = rect;
 
     if (m_d->style->isEnabled()) {
-        result = sourcePlane->recalculate(stylesNeedRect(rect), filthyNode);
-
-        Q_FOREACH (const KisAbstractProjectionPlaneSP plane, m_d->allStyles()) {
-            plane->recalculate(rect, filthyNode);
+        const QRect needRect = stylesNeedRect(rect);
+        result = sourcePlane->recalculate(needRect, filthyNode);
+
+        /**
+         * The styles are recalculated only where the alpha channel of the
+         * source has changed. The changes are committed to the cache only
+         * for the pixels that cannot affect anything outside \p rect,
+         * otherwise a pending update of a neighbouring area would find
+         * no changes there and skip its part of the styles.
+         */
+        const QVector<QRect> changedRects =
+            m_d->alphaCache.update(m_d->sourceLayer->projection(),
+                                   needRect, stylesIndependentRect(rect));
+
+        Q_FOREACH (const KisLayerStyleFilterProjectionPlaneSP plane, m_d->allStyles()) {
+            plane->recalculateIncrementally(rect, changedRects, filthyNode);
         }
     } else {
+        // the styles are not updated anymore, so the cache becomes stale
+        m_d->alphaCache.invalidate();
+
         result = sourcePlane->recalculate(rect, filthyNode);
     }
 
@@ -432,6 +449,23 @@ QRect KisLayerStyleProjectionPlane::tightUserVisibleBounds() const
     return rect;
 }
 
+QRect KisLayerStyleProjectionPlane::stylesIndependentRect(const QRect &rect) const
+{
+    /**
+     * All the styles have the change rect of the same shape for any
+     * source rect, so calculate its borders for a single pixel.
+     */
+    const QRect probeRect(0, 0, 1, 1);
+    QRect changeRect = probeRect;
+
+    Q_FOREACH (const KisAbstractProjectionPlaneSP plane, m_d->allStyles()) {
+        changeRect |= plane->changeRect(probeRect, KisLayer::N_ABOVE_FILTHY);
+    }
+
+    return rect.adjusted(-changeRect.left(), -changeRect.top(),
+                         -changeRect.right(), -changeRect.bottom());
+}
+
 QRect KisLayerStyleProjectionPlane::stylesNeedRect(const QRect &rect) const
 {
     QRect needRect = rect;
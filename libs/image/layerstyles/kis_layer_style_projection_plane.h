@@ -47,6 +47,12 @@ private:
 
     QRect stylesNeedRect(const QRect &rect) const;
 
+    /**
+     * \return the part of \p rect whose changes may affect the styles
+     *          only inside \p rect
+     */
+    QRect stylesIndependentRect(const QRect &rect) const;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
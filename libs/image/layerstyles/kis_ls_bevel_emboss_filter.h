@@ -31,6 +31,7 @@ public:
 
     QRect neededRect(const QRect & rect, KisPSDLayerStyleSP style, KisLayerStyleFilterEnvironment *env) const override;
     QRect changedRect(const QRect & rect, KisPSDLayerStyleSP style, KisLayerStyleFilterEnvironment *env) const override;
+    bool dependsOnSourceAlphaOnly(KisPSDLayerStyleSP style) const override;
 
 
 private:
@@ -118,3 +118,8 @@ QRect KisLsOverlayFilter::changedRect(const QRect &rect, KisPSDLayerStyleSP styl
     Q_UNUSED(env);
     return rect;
 }
+
+bool KisLsOverlayFilter::dependsOnSourceAlphaOnly(KisPSDLayerStyleSP style) const
+{
+    return KisLsUtils::dependsOnSourceAlphaOnly(getOverlayStruct(style));
+}
@@ -216,3 +216,8 @@ QRect KisLsSatinFilter::changedRect(const QRect &rect, KisPSDLayerStyleSP style,
     return style->context()->keep_original ?
         d.finalChangeRect() : rect | d.finalChangeRect();
 }
+
+bool KisLsSatinFilter::dependsOnSourceAlphaOnly(KisPSDLayerStyleSP style) const
+{
+    return KisLsUtils::dependsOnSourceAlphaOnly(style->satin());
+}
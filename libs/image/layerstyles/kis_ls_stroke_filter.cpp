@@ -162,6 +162,11 @@ QRect KisLsStrokeFilter::changedRect(const QRect &rect, KisPSDLayerStyleSP style
     return neededRect(rect, style, env);
 }
 
+bool KisLsStrokeFilter::dependsOnSourceAlphaOnly(KisPSDLayerStyleSP style) const
+{
+    return KisLsUtils::dependsOnSourceAlphaOnly(style->stroke());
+}
+
 KritaUtils::ThresholdMode KisLsStrokeFilter::sourcePlaneOpacityThresholdRequirement(KisPSDLayerStyleSP style) const
 {
     const psd_layer_effects_stroke *config = style->stroke();
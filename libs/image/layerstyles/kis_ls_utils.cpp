@@ -589,4 +589,16 @@ namespace KisLsUtils
 
         return result;
     }
+
+    bool dependsOnSourceAlphaOnly(const psd_layer_effects_shadow_base *config)
+    {
+        return config->noise() <= 0 &&
+            (config->fillType() != psd_fill_gradient || config->jitter() <= 0);
+    }
+
+    bool dependsOnSourceAlphaOnly(const psd_layer_effects_overlay_base *config)
+    {
+        return dependsOnSourceAlphaOnly(static_cast<const psd_layer_effects_shadow_base*>(config)) &&
+            (config->fillType() == psd_fill_solid_color || !config->alignWithLayer());
+    }
 }
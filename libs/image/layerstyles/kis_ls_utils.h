@@ -88,6 +88,19 @@ namespace KisLsUtils
 
     bool checkEffectEnabled(const psd_layer_effects_shadow_base *config, KisMultipleProjection *dst);
 
+    /**
+     * \return true if the effect uses neither noise nor jitter, which are
+     * generated for the entire requested area at once, so the effect can
+     * be recalculated partially
+     */
+    bool dependsOnSourceAlphaOnly(const psd_layer_effects_shadow_base *config);
+
+    /**
+     * Same as above, but also checks that the fill of the overlay is not
+     * aligned with the bounds of the layer, which change while painting
+     */
+    bool dependsOnSourceAlphaOnly(const psd_layer_effects_overlay_base *config);
+
     template<class ConfigStruct>
     struct LodWrapper
     {
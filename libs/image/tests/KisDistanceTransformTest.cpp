@@ -0,0 +1,256 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisDistanceTransformTest.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <kis_global.h>
+#include <kis_pixel_selection.h>
+#include <kis_selection_filters.h>
+#include <kis_convolution_kernel.h>
+#include <kis_convolution_painter.h>
+#include "KisDistanceTransform.h"
+#include "kistest.h"
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+/**
+ * A selection with two levels of selectedness and a few isolated pixels
+ */
+KisPixelSelectionSP createSelection(const QRect &rc)
+{
+    KisPixelSelectionSP selection = new KisPixelSelection();
+
+    QVector<quint8> data(rc.width() * rc.height(), 0);
+    auto fill = [&] (const QRect &fillRect, quint8 value) {
+        const QRect r = fillRect.translated(-rc.topLeft()) & QRect(QPoint(), rc.size());
+        for (int y = r.top(); y <= r.bottom(); y++) {
+            for (int x = r.left(); x <= r.right(); x++) {
+                data[y * rc.width() + x] = value;
+            }
+        }
+    };
+
+    fill(rc.adjusted(10, 20, -15, -rc.height() / 2), 255);
+    fill(rc.adjusted(25, rc.height() / 2 - 30, -5, -40), 128);
+    fill(QRect(rc.x() + 3, rc.bottom() - 12, 1, 1), 255);
+    fill(QRect(rc.x() + 30, rc.bottom() - 5, 2, 1), 128);
+
+    selection->writeBytes(data.constData(), rc);
+
+    return selection;
+}
+
+quint8 bruteForceMorphology(const QVector<quint8> &data, const QRect &rc,
+                            int x, int y, int radius, bool erode)
+{
+    const qreal maxDistance = pow2(radius + 0.5);
+    quint8 result = erode ? 255 : 0;
+
+    for (int j = y - radius; j <= y + radius; j++) {
+        for (int i = x - radius; i <= x + radius; i++) {
+            if (pow2(i - x) + pow2(j - y) > maxDistance) continue;
+
+            const quint8 value = rc.contains(i, j) ?
+                data[(j - rc.y()) * rc.width() + i - rc.x()] : 0;
+
+            result = erode ? qMin(result, value) : qMax(result, value);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * A selection with a horizontal ramp of \p numLevels levels, like
+ * an antialiased one
+ */
+KisPixelSelectionSP createRampSelection(const QRect &rc, int numLevels)
+{
+    KisPixelSelectionSP selection = new KisPixelSelection();
+
+    QVector<quint8> data(rc.width() * rc.height(), 0);
+    for (int y = rc.height() / 3; y < 2 * rc.height() / 3; y++) {
+        for (int x = 0; x < rc.width(); x++) {
+            data[y * rc.width() + x] = quint8(255 * (x * numLevels / rc.width() + 1) / numLevels);
+        }
+    }
+
+    selection->writeBytes(data.constData(), rc);
+
+    return selection;
+}
+
+void testMorphology(KisPixelSelectionSP selection, const QRect &rc, int radius, bool erode)
+{
+
+    QVector<quint8> original(rc.width() * rc.height());
+    selection->readBytes(original.data(), rc);
+
+    if (erode) {
+        KisShrinkSelectionFilter filter(radius, radius, false);
+        filter.process(selection, rc);
+    } else {
+        KisGrowSelectionFilter filter(radius, radius);
+        filter.process(selection, rc);
+    }
+
+    QVector<quint8> result(rc.width() * rc.height());
+    selection->readBytes(result.data(), rc);
+
+    for (int y = rc.top(); y <= rc.bottom(); y++) {
+        for (int x = rc.left(); x <= rc.right(); x++) {
+            const quint8 value = result[(y - rc.y()) * rc.width() + x - rc.x()];
+            const quint8 expected = bruteForceMorphology(original, rc, x, y, radius, erode);
+
+            QVERIFY2(value == expected,
+                     qPrintable(QString("the result doesn't match the brute force morphology at (%1, %2): %3 instead of %4")
+                                .arg(x).arg(y).arg(value).arg(expected)));
+        }
+    }
+}
+
+}
+
+void KisDistanceTransformTest::testTransform_data()
+{
+    QTest::addColumn<float>("xWeight");
+    QTest::addColumn<float>("yWeight");
+
+    QTest::newRow("euclidean") << 1.0f << 1.0f;
+    QTest::newRow("elliptic") << 0.25f << 1.0f;
+}
+
+void KisDistanceTransformTest::testTransform()
+{
+    QFETCH(float, xWeight);
+    QFETCH(float, yWeight);
+
+    const int width = 67;
+    const int height = 53;
+
+    QVector<QPoint> features;
+    srand(31524744);
+    for (int i = 0; i < 12; i++) {
+        features << QPoint(rand() % width, rand() % height);
+    }
+
+    std::vector<float> data(width * height, KisDistanceTransform::Infinity);
+    for (const QPoint &pt : features) {
+        data[pt.y() * width + pt.x()] = 0.0f;
+    }
+
+    KisDistanceTransform::transform(data.data(), width, height, xWeight, yWeight);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float expected = KisDistanceTransform::Infinity;
+            for (const QPoint &pt : features) {
+                expected = qMin(expected, xWeight * pow2(x - pt.x()) + yWeight * pow2(y - pt.y()));
+            }
+
+            QVERIFY(qAbs(data[y * width + x] - expected) < 1e-3);
+        }
+    }
+
+    // no features at all
+    std::fill(data.begin(), data.end(), KisDistanceTransform::Infinity);
+    KisDistanceTransform::transform(data.data(), width, height, xWeight, yWeight);
+    QVERIFY(std::all_of(data.begin(), data.end(),
+                        [] (float value) { return value == KisDistanceTransform::Infinity; }));
+}
+
+void KisDistanceTransformTest::testGrowSelection()
+{
+    // taller than one band of the distance transform based filters
+    const QRect rc(-7, 13, 60, 300);
+    testMorphology(createSelection(rc), rc, 10, false);
+}
+
+void KisDistanceTransformTest::testShrinkSelection()
+{
+    const QRect rc(-7, 13, 60, 300);
+    testMorphology(createSelection(rc), rc, 10, true);
+}
+
+void KisDistanceTransformTest::testManyLevels()
+{
+    // enough levels to be quantized before, but still a distance transform case
+    const QRect rc(5, -3, 120, 90);
+    const int numLevels = 20;
+    const int radius = 42;
+
+    testMorphology(createRampSelection(rc, numLevels), rc, radius, false);
+    testMorphology(createRampSelection(rc, numLevels), rc, radius, true);
+}
+
+void KisDistanceTransformTest::testFeatherSelection_data()
+{
+    QTest::addColumn<int>("radius");
+
+    // the feather used to switch to a box filter above the radius of 16
+    QTest::newRow("16") << 16;
+    QTest::newRow("17") << 17;
+    QTest::newRow("40") << 40;
+}
+
+void KisDistanceTransformTest::testFeatherSelection()
+{
+    QFETCH(int, radius);
+
+    const QRect rc(0, 0, 200, 160);
+    KisPixelSelectionSP selection = createSelection(rc);
+    selection->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(rc));
+    const QRect applyRect = rc.adjusted(-radius, -radius, radius, radius);
+
+    KisPixelSelectionSP reference = new KisPixelSelection(*selection);
+
+    KisFeatherSelectionFilter filter(radius);
+    filter.process(selection, applyRect);
+
+    /**
+     * The reference is the truncated gaussian applied by the spatial
+     * engine, the way the filter used to process all the radii
+     */
+    const int kernelSize = 2 * radius + 1;
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussianMatrix(1, kernelSize);
+    for (int x = 0; x < kernelSize; x++) {
+        gaussianMatrix(0, x) =
+            std::exp(-qreal(pow2(x - radius) + pow2(radius)) / (2.0 * pow2(radius))) /
+            (2.0 * M_PI * pow2(radius));
+    }
+
+    KisConvolutionKernelSP kernelHoriz = KisConvolutionKernel::fromMatrix(gaussianMatrix, 0, gaussianMatrix.sum());
+    KisConvolutionKernelSP kernelVertical = KisConvolutionKernel::fromMatrix(gaussianMatrix.transpose(), 0, gaussianMatrix.sum());
+
+    KisPaintDeviceSP interm = new KisPaintDevice(reference->colorSpace());
+    interm->prepareClone(reference);
+
+    KisConvolutionPainter horizPainter(interm, KisConvolutionPainter::SPATIAL);
+    horizPainter.applyMatrix(kernelHoriz, reference, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+    horizPainter.end();
+
+    KisConvolutionPainter verticalPainter(reference, KisConvolutionPainter::SPATIAL);
+    verticalPainter.applyMatrix(kernelVertical, interm, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+    verticalPainter.end();
+
+    QVector<quint8> result(applyRect.width() * applyRect.height());
+    QVector<quint8> expected(applyRect.width() * applyRect.height());
+
+    selection->readBytes(result.data(), applyRect);
+    reference->readBytes(expected.data(), applyRect);
+
+    for (int i = 0; i < result.size(); i++) {
+        QVERIFY2(qAbs(int(result[i]) - int(expected[i])) <= 1,
+                 qPrintable(QString("feathered value %1 differs from the gaussian %2 at index %3")
+                            .arg(result[i]).arg(expected[i]).arg(i)));
+    }
+}
+
+KISTEST_MAIN(KisDistanceTransformTest)
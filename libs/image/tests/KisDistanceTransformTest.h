@@ -0,0 +1,27 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISDISTANCETRANSFORMTEST_H
+#define KISDISTANCETRANSFORMTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisDistanceTransformTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testTransform_data();
+    void testTransform();
+    void testGrowSelection();
+    void testShrinkSelection();
+    void testManyLevels();
+    void testFeatherSelection_data();
+    void testFeatherSelection();
+};
+
+#endif // KISDISTANCETRANSFORMTEST_H
@@ -0,0 +1,204 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisHistogramIndexTest.h"
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_default_bounds.h>
+#include <kis_paint_device.h>
+#include "KisHistogramIndex.h"
+#include "kistest.h"
+
+namespace {
+
+const QRect imageRect(0, 0, 1000, 700);
+
+KisPaintDeviceSP createDevice(KisImageSP image)
+{
+    KisPaintDeviceSP device = new KisPaintDevice(image->colorSpace());
+    device->setDefaultBounds(new KisDefaultBounds(image));
+
+    const KoColorSpace *cs = device->colorSpace();
+    device->fill(QRect(100, 50, 600, 400), KoColor(Qt::red, cs));
+    device->fill(QRect(450, 300, 500, 350), KoColor(Qt::blue, cs));
+    device->fill(QRect(13, 600, 3, 7), KoColor(Qt::green, cs));
+
+    // the pixels outside the image are not counted
+    device->fill(QRect(-100, -100, 50, 50), KoColor(Qt::white, cs));
+
+    return device;
+}
+
+}
+
+void KisHistogramIndexTest::testUniformColor()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "test");
+
+    KisPaintDeviceSP device = new KisPaintDevice(cs);
+    device->setDefaultBounds(new KisDefaultBounds(image));
+    device->fill(QRect(0, 0, 500, 700), KoColor(QColor(10, 200, 30, 128), cs));
+
+    KisHistogramIndex index;
+    QVERIFY(!index.isValid());
+
+    index.update(device);
+    QVERIFY(index.isValid());
+    QCOMPARE(index.pixelCount(), quint64(1000 * 700));
+
+    const KisHistogramIndex::Bins bins = index.bins();
+    QCOMPARE(int(bins.size()), 4);
+
+    // the pixels are stored as BGRA, the other half is transparent black
+    QCOMPARE(bins[0][30], quint32(500 * 700));
+    QCOMPARE(bins[1][200], quint32(500 * 700));
+    QCOMPARE(bins[2][10], quint32(500 * 700));
+    QCOMPARE(bins[3][128], quint32(500 * 700));
+    QCOMPARE(bins[3][0], quint32(500 * 700));
+
+    index.clear();
+    QVERIFY(!index.isValid());
+}
+
+void KisHistogramIndexTest::testIncrementalUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "test");
+    KisPaintDeviceSP device = createDevice(image);
+
+    KisHistogramIndex incrementalIndex;
+    incrementalIndex.update(device);
+
+    // only the existing tiles are binned, the rest of the image is
+    // accounted for with the default pixel
+    QCOMPARE(incrementalIndex.lastUpdatedTiles(), 121);
+
+    incrementalIndex.update(device);
+    QCOMPARE(incrementalIndex.lastUpdatedTiles(), 0);
+
+    // the tile containing the pixel is changed
+    device->setPixel(500, 500, KoColor(Qt::yellow, cs));
+
+    // a new tile is created
+    device->fill(QRect(960, 10, 30, 30), KoColor(Qt::cyan, cs));
+
+    // a tile is cleared
+    device->clear(QRect(0, 576, 64, 64));
+
+    // a tile outside the image is changed
+    device->fill(QRect(-100, 800, 10, 10), KoColor(Qt::cyan, cs));
+
+    incrementalIndex.update(device);
+    QCOMPARE(incrementalIndex.lastUpdatedTiles(), 3);
+
+    KisHistogramIndex fullIndex;
+    fullIndex.update(device);
+
+    QVERIFY(incrementalIndex.bins() == fullIndex.bins());
+    QCOMPARE(incrementalIndex.pixelCount(), fullIndex.pixelCount());
+}
+
+void KisHistogramIndexTest::testInterruptedUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "test");
+    KisPaintDeviceSP device = createDevice(image);
+
+    KisHistogramIndex index;
+    index.update(device);
+
+    // changes four existing tiles
+    device->fill(QRect(100, 100, 200, 10), KoColor(Qt::yellow, cs));
+
+    QVector<QRect> rects = index.beginUpdate(device);
+    QCOMPARE(rects.size(), 4);
+
+    // only a part of the tiles is binned, like when the stroke is cancelled
+    index.updateTiles(device, rects.mid(0, 1));
+
+    rects = index.beginUpdate(device);
+    QCOMPARE(rects.size(), 4);
+
+    index.updateTiles(device, rects);
+    QCOMPARE(index.beginUpdate(device).size(), 0);
+
+    KisHistogramIndex fullIndex;
+    fullIndex.update(device);
+
+    QVERIFY(index.bins() == fullIndex.bins());
+    QCOMPARE(index.pixelCount(), fullIndex.pixelCount());
+}
+
+void KisHistogramIndexTest::testRebuild()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "test");
+    KisPaintDeviceSP device = createDevice(image);
+
+    KisHistogramIndex index;
+    index.update(device);
+
+    // moving the device changes the pixels inside the image, now one of
+    // the tiles outside the image is moved into it
+    device->moveTo(QPoint(30, 20));
+    index.update(device);
+    QCOMPARE(index.lastUpdatedTiles(), 122);
+
+    KisHistogramIndex fullIndex;
+    fullIndex.update(device);
+    QVERIFY(index.bins() == fullIndex.bins());
+
+    // so does changing the default pixel
+    device->setDefaultPixel(KoColor(Qt::white, cs));
+    index.update(device);
+
+    fullIndex.clear();
+    fullIndex.update(device);
+    QVERIFY(index.bins() == fullIndex.bins());
+    QCOMPARE(index.bins()[3][255], quint32(fullIndex.pixelCount()));
+}
+
+void KisHistogramIndexTest::testSubsampling()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // a bit more than two megapixels are sampled every second pixel
+    KisImageSP image = new KisImage(0, 2001, 1100, cs, "test");
+    KisPaintDeviceSP device = createDevice(image);
+
+    KisHistogramIndex index;
+    index.update(device);
+    QCOMPARE(index.pixelCount(), quint64(1001 * 550));
+
+    const KisHistogramIndex::Bins bins = index.bins();
+
+    quint64 alphaCount = 0;
+    for (quint32 count : bins[3]) {
+        alphaCount += count;
+    }
+    QCOMPARE(alphaCount, index.pixelCount());
+
+    // the red rect is sampled 300 x 200 times, the blue one overlaps 125 x 75
+    // of the samples, the grid goes through the partially covered tiles
+    QCOMPARE(bins[2][255], quint32(300 * 200 - 125 * 75));
+
+    device->fill(QRect(1500, 900, 101, 101), KoColor(Qt::green, cs));
+    device->clear(QRect(100, 50, 600, 400));
+    index.update(device);
+
+    KisHistogramIndex fullIndex;
+    fullIndex.update(device);
+
+    QVERIFY(index.bins() == fullIndex.bins());
+    // the green pixels of createDevice() are sampled 1 x 4 times
+    QCOMPARE(index.bins()[1][255], quint32(51 * 51 + 1 * 4));
+}
+
+KISTEST_MAIN(KisHistogramIndexTest)
@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISHISTOGRAMINDEXTEST_H
+#define KISHISTOGRAMINDEXTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisHistogramIndexTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testUniformColor();
+    void testIncrementalUpdate();
+    void testInterruptedUpdate();
+    void testRebuild();
+    void testSubsampling();
+};
+
+#endif // KISHISTOGRAMINDEXTEST_H
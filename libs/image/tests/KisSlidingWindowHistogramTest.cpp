@@ -0,0 +1,202 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSlidingWindowHistogramTest.h"
+
+#include <KoColorSpaceRegistry.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+#include "KisSlidingWindowHistogram.h"
+#include "kistest.h"
+
+namespace {
+
+KisPaintDeviceSP createRandomDevice(const QRect &rc)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    QVector<quint8> data(rc.width() * rc.height());
+    srand(31524744);
+    for (int i = 0; i < data.size(); i++) {
+        data[i] = quint8(rand() % 256);
+    }
+    dev->writeBytes(data.constData(), rc);
+
+    return dev;
+}
+
+quint8 bruteForceRank(KisPaintDeviceSP dev, int x, int y, int radius, qreal rank)
+{
+    QVector<quint8> window;
+
+    KisRandomConstAccessorSP it = dev->createRandomConstAccessorNG();
+    for (int j = y - radius; j <= y + radius; j++) {
+        for (int i = x - radius; i <= x + radius; i++) {
+            it->moveTo(i, j);
+            window << *it->oldRawData();
+        }
+    }
+
+    std::sort(window.begin(), window.end());
+    return window[int(rank * (window.size() - 1) + 0.5)];
+}
+
+}
+
+void KisSlidingWindowHistogramTest::testRank_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<qreal>("rank");
+    QTest::addColumn<QSize>("patchSize");
+
+    QTest::newRow("r0-median") << 0 << 0.5 << QSize(256, 256);
+    QTest::newRow("r1-median") << 1 << 0.5 << QSize(256, 256);
+    QTest::newRow("r3-median") << 3 << 0.5 << QSize(256, 256);
+    QTest::newRow("r3-min") << 3 << 0.0 << QSize(256, 256);
+    QTest::newRow("r3-max") << 3 << 1.0 << QSize(256, 256);
+    QTest::newRow("r5-median-small-patches") << 5 << 0.5 << QSize(16, 8);
+}
+
+void KisSlidingWindowHistogramTest::testRank()
+{
+    QFETCH(int, radius);
+    QFETCH(qreal, rank);
+    QFETCH(QSize, patchSize);
+
+    const QRect rc(-7, 13, 71, 53);
+    KisPaintDeviceSP src = createRandomDevice(rc.adjusted(-10, -10, 10, 10));
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+
+    KisSlidingWindowHistogram histogram(256);
+    histogram.setPatchSize(patchSize);
+
+    histogram.process(src, dst, rc, radius,
+                      [] (const quint8 *pixel, float *, QVector<float> &) {
+                          return int(*pixel);
+                      },
+                      [rank] (const KisSlidingWindowHistogram::Window &window, const quint8 *, quint8 *dst, QVector<float> &) {
+                          *dst = quint8(KisSlidingWindowHistogram::findRank(window, rank));
+                      });
+
+    KisRandomConstAccessorSP it = dst->createRandomConstAccessorNG();
+
+    for (int y = rc.top(); y <= rc.bottom(); y++) {
+        for (int x = rc.left(); x <= rc.right(); x++) {
+            it->moveTo(x, y);
+            QCOMPARE(*it->rawDataConst(), bruteForceRank(src, x, y, radius, rank));
+        }
+    }
+}
+
+void KisSlidingWindowHistogramTest::testAccumulators()
+{
+    const QRect rc(0, 0, 40, 30);
+    const int radius = 2;
+    KisPaintDeviceSP src = createRandomDevice(rc.adjusted(-radius, -radius, radius, radius));
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+
+    // a single bin, so that the accumulator is a plain box blur
+    KisSlidingWindowHistogram histogram(1, 1);
+
+    histogram.process(src, dst, rc, radius,
+                      [] (const quint8 *pixel, float *accumulators, QVector<float> &) {
+                          accumulators[0] = *pixel;
+                          return 0;
+                      },
+                      [] (const KisSlidingWindowHistogram::Window &window, const quint8 *, quint8 *dst, QVector<float> &) {
+                          *dst = quint8(qRound(window.binSums(0)[0] / window.totalCount));
+                      });
+
+    KisRandomConstAccessorSP srcIt = src->createRandomConstAccessorNG();
+    KisRandomConstAccessorSP dstIt = dst->createRandomConstAccessorNG();
+
+    for (int y = rc.top(); y <= rc.bottom(); y++) {
+        for (int x = rc.left(); x <= rc.right(); x++) {
+            int sum = 0;
+            for (int j = y - radius; j <= y + radius; j++) {
+                for (int i = x - radius; i <= x + radius; i++) {
+                    srcIt->moveTo(i, j);
+                    sum += *srcIt->rawDataConst();
+                }
+            }
+
+            dstIt->moveTo(x, y);
+            QCOMPARE(*dstIt->rawDataConst(), quint8(qRound(sum / 25.0)));
+        }
+    }
+}
+
+void KisSlidingWindowHistogramTest::testTotalCount()
+{
+    const QRect rc(3, -5, 60, 45);
+    const int radius = 3;
+    KisPaintDeviceSP src = createRandomDevice(rc.adjusted(-radius, -radius, radius, radius));
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+
+    KisSlidingWindowHistogram histogram(256);
+    histogram.setPatchSize(QSize(16, 16));
+
+    // the pixels excluded by the sample function must not be counted
+    histogram.process(src, dst, rc, radius,
+                      [] (const quint8 *pixel, float *, QVector<float> &) {
+                          return *pixel < 128 ? -1 : int(*pixel);
+                      },
+                      [] (const KisSlidingWindowHistogram::Window &window, const quint8 *, quint8 *dst, QVector<float> &) {
+                          *dst = quint8(window.totalCount);
+                      });
+
+    KisRandomConstAccessorSP srcIt = src->createRandomConstAccessorNG();
+    KisRandomConstAccessorSP dstIt = dst->createRandomConstAccessorNG();
+
+    for (int y = rc.top(); y <= rc.bottom(); y++) {
+        for (int x = rc.left(); x <= rc.right(); x++) {
+            int count = 0;
+            for (int j = y - radius; j <= y + radius; j++) {
+                for (int i = x - radius; i <= x + radius; i++) {
+                    srcIt->moveTo(i, j);
+                    count += *srcIt->rawDataConst() >= 128;
+                }
+            }
+
+            dstIt->moveTo(x, y);
+            QCOMPARE(int(*dstIt->rawDataConst()), count);
+        }
+    }
+}
+
+void KisSlidingWindowHistogramTest::testInPlace()
+{
+    const QRect rc(0, 0, 100, 100);
+    const int radius = 4;
+
+    KisPaintDeviceSP dev = createRandomDevice(rc.adjusted(-radius, -radius, radius, radius));
+    KisPaintDeviceSP reference = new KisPaintDevice(dev->colorSpace());
+
+    KisSlidingWindowHistogram histogram(256);
+    histogram.setPatchSize(QSize(16, 16));
+
+    auto sampleFunc = [] (const quint8 *pixel, float *, QVector<float> &) {
+        return int(*pixel);
+    };
+
+    auto resultFunc = [] (const KisSlidingWindowHistogram::Window &window, const quint8 *, quint8 *dst, QVector<float> &) {
+        *dst = quint8(KisSlidingWindowHistogram::findRank(window, 0.5));
+    };
+
+    histogram.process(dev, reference, rc, radius, sampleFunc, resultFunc);
+    histogram.process(dev, dev, rc, radius, sampleFunc, resultFunc);
+
+    QVector<quint8> expected(rc.width() * rc.height());
+    QVector<quint8> result(rc.width() * rc.height());
+
+    reference->readBytes(expected.data(), rc);
+    dev->readBytes(result.data(), rc);
+
+    QCOMPARE(result, expected);
+}
+
+KISTEST_MAIN(KisSlidingWindowHistogramTest)
@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSLIDINGWINDOWHISTOGRAMTEST_H
+#define KISSLIDINGWINDOWHISTOGRAMTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisSlidingWindowHistogramTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRank_data();
+    void testRank();
+    void testAccumulators();
+    void testTotalCount();
+    void testInPlace();
+};
+
+#endif // KISSLIDINGWINDOWHISTOGRAMTEST_H
@@ -0,0 +1,171 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisThumbnailPyramidTest.h"
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_default_bounds.h>
+#include <kis_paint_device.h>
+#include "KisThumbnailPyramid.h"
+#include "kistest.h"
+
+namespace {
+
+const QRect imageRect(0, 0, 1000, 700);
+
+KisPaintDeviceSP createDevice(KisImageSP image)
+{
+    KisPaintDeviceSP device = new KisPaintDevice(image->colorSpace());
+    device->setDefaultBounds(new KisDefaultBounds(image));
+
+    const KoColorSpace *cs = device->colorSpace();
+    device->fill(QRect(100, 50, 600, 400), KoColor(Qt::red, cs));
+    device->fill(QRect(450, 300, 500, 350), KoColor(Qt::blue, cs));
+    device->fill(QRect(13, 600, 3, 7), KoColor(Qt::green, cs));
+
+    return device;
+}
+
+bool compareLevels(const KisThumbnailPyramid &lhs, const KisThumbnailPyramid &rhs)
+{
+    for (int size = 1; size < imageRect.width(); size *= 2) {
+        QRect lhsRect;
+        QRect rhsRect;
+
+        KisPaintDeviceSP lhsLevel = lhs.levelDevice(QSize(size, size), imageRect, &lhsRect);
+        KisPaintDeviceSP rhsLevel = rhs.levelDevice(QSize(size, size), imageRect, &rhsRect);
+
+        if (lhsRect != rhsRect) {
+            qWarning() << "Level rects differ:" << ppVar(size) << ppVar(lhsRect) << ppVar(rhsRect);
+            return false;
+        }
+
+        const int numBytes = lhsRect.width() * lhsRect.height() * lhsLevel->pixelSize();
+        QByteArray lhsData(numBytes, 0);
+        QByteArray rhsData(numBytes, 0);
+
+        lhsLevel->readBytes(reinterpret_cast<quint8*>(lhsData.data()), lhsRect);
+        rhsLevel->readBytes(reinterpret_cast<quint8*>(rhsData.data()), rhsRect);
+
+        if (lhsData != rhsData) {
+            qWarning() << "Level data differs:" << ppVar(size) << ppVar(lhsRect);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+void KisThumbnailPyramidTest::testLevels()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "test");
+    KisPaintDeviceSP device = createDevice(image);
+
+    KisThumbnailPyramid pyramid;
+    QVERIFY(!pyramid.isValid());
+
+    pyramid.update(device, 64);
+    QVERIFY(pyramid.isValid());
+
+    // 1000 / 8 = 125 is the smallest level not smaller than 64,
+    // 1000 / 64 = 15 is too small to be stored
+    QCOMPARE(pyramid.firstLevel(), 3);
+    QCOMPARE(pyramid.numLevels(), 3);
+
+    QRect levelRect;
+    pyramid.levelDevice(QSize(40, 40), imageRect, &levelRect);
+    QCOMPARE(levelRect, QRect(0, 0, 63, 44));
+
+    // the requests bigger than the first level are served by the first level
+    pyramid.levelDevice(QSize(500, 500), imageRect, &levelRect);
+    QCOMPARE(levelRect, QRect(0, 0, 125, 88));
+
+    // a bigger request rebuilds the pyramid
+    pyramid.update(device, 200);
+    QCOMPARE(pyramid.firstLevel(), 2);
+    QCOMPARE(pyramid.numLevels(), 4);
+
+    // smaller requests are served by the existing levels
+    pyramid.update(device, 64);
+    QCOMPARE(pyramid.firstLevel(), 2);
+
+    pyramid.clear();
+    QVERIFY(!pyramid.isValid());
+}
+
+void KisThumbnailPyramidTest::testUniformColor()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "test");
+
+    KisPaintDeviceSP device = new KisPaintDevice(cs);
+    device->setDefaultBounds(new KisDefaultBounds(image));
+
+    const KoColor color(QColor(10, 200, 30, 128), cs);
+    device->fill(imageRect, color);
+
+    KisThumbnailPyramid pyramid;
+    pyramid.update(device, 64);
+
+    QRect levelRect;
+    KisPaintDeviceSP level = pyramid.levelDevice(QSize(16, 16), imageRect, &levelRect);
+
+    KoColor levelColor;
+    level->pixel(levelRect.center().x(), levelRect.center().y(), &levelColor);
+    QCOMPARE(levelColor, color);
+
+    const QImage thumbnail =
+        pyramid.createThumbnail(100, 100, imageRect, cs->profile(),
+                                KoColorConversionTransformation::internalRenderingIntent(),
+                                KoColorConversionTransformation::internalConversionFlags());
+
+    QCOMPARE(thumbnail.size(), QSize(100, 70));
+}
+
+void KisThumbnailPyramidTest::testIncrementalUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "test");
+    KisPaintDeviceSP device = createDevice(image);
+
+    KisThumbnailPyramid incrementalPyramid;
+    incrementalPyramid.update(device, 64);
+
+    // the tile containing the pixel is changed
+    device->setPixel(500, 500, KoColor(Qt::yellow, cs));
+
+    // a new tile is created
+    device->fill(QRect(960, 10, 30, 30), KoColor(Qt::cyan, cs));
+
+    // a tile is removed
+    device->clear(QRect(0, 576, 64, 64));
+
+    incrementalPyramid.update(device, 64);
+
+    KisThumbnailPyramid fullPyramid;
+    fullPyramid.update(device, 64);
+
+    QVERIFY(compareLevels(incrementalPyramid, fullPyramid));
+
+    // the levels returned earlier are not affected by the updates
+    QRect levelRect;
+    KisPaintDeviceSP oldLevel = incrementalPyramid.levelDevice(QSize(100, 100), imageRect, &levelRect);
+
+    device->fill(imageRect, KoColor(Qt::black, cs));
+    incrementalPyramid.update(device, 64);
+
+    KoColor oldColor;
+    oldLevel->pixel(0, 0, &oldColor);
+    QCOMPARE(oldColor, KoColor(Qt::transparent, cs));
+}
+
+KISTEST_MAIN(KisThumbnailPyramidTest)
@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTHUMBNAILPYRAMIDTEST_H
+#define KISTHUMBNAILPYRAMIDTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisThumbnailPyramidTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testLevels();
+    void testUniformColor();
+    void testIncrementalUpdate();
+};
+
+#endif // KISTHUMBNAILPYRAMIDTEST_H
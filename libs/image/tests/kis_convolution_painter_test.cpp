@@ -581,4 +581,97 @@ void KisConvolutionPainterTest::testNormalMapFFTW()
     testNormalMap(true);
 }
 
+void KisConvolutionPainterTest::testSeparableMatchesSpatial()
+{
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    dev->convertFromQImage(referenceImage, 0, 0, 0);
+
+    KisDefaultBoundsBaseSP bounds = new TestUtil::TestingTimedDefaultBounds(dev->exactBounds());
+    dev->setDefaultBounds(bounds);
+
+    const QRect applyRect = dev->exactBounds();
+
+    KisConvolutionKernelSP kernel = KisGaussianKernel::createUniform2DKernel(10, 10);
+
+    // the kernel is symmetric, so convolution and correlation coincide
+    QVERIFY(!kernel->separableTerms(1).isEmpty());
+
+    auto applyKernel = [&] (KisConvolutionPainter::EnginePreference enginePreference) {
+        KisPaintDeviceSP result = new KisPaintDevice(dev->colorSpace());
+        result->setDefaultBounds(bounds);
+
+        KisConvolutionPainter painter(result, enginePreference);
+        painter.applyMatrix(kernel, dev,
+                            applyRect.topLeft(), applyRect.topLeft(),
+                            applyRect.size(), BORDER_REPEAT);
+
+        return result->convertToQImage(0, applyRect.x(), applyRect.y(), applyRect.width(), applyRect.height());
+    };
+
+    const QImage spatial = applyKernel(KisConvolutionPainter::SPATIAL);
+    const QImage separable = applyKernel(KisConvolutionPainter::SEPARABLE);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::compareQImages(errorPoint, spatial, separable, 1, 1));
+}
+
+void KisConvolutionPainterTest::testLineIntegral()
+{
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    dev->convertFromQImage(referenceImage, 0, 0, 0);
+
+    KisDefaultBoundsBaseSP bounds = new TestUtil::TestingTimedDefaultBounds(dev->exactBounds());
+    dev->setDefaultBounds(bounds);
+
+    using Matrix = Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>;
+
+    const int halfLength = 20;
+    const int length = 2 * halfLength + 1;
+
+    auto compareWithSpatial = [&] (const QPointF &halfLine, const Matrix &matrix, const QRect &applyRect) {
+        KisConvolutionKernelSP kernel =
+            KisConvolutionKernel::fromMatrix(matrix, 0.0, length);
+
+        KisPaintDeviceSP spatialDev = new KisPaintDevice(dev->colorSpace());
+        spatialDev->setDefaultBounds(bounds);
+
+        KisConvolutionPainter spatialPainter(spatialDev, KisConvolutionPainter::SPATIAL);
+        spatialPainter.applyMatrix(kernel, dev,
+                                   applyRect.topLeft(), applyRect.topLeft(),
+                                   applyRect.size(), BORDER_REPEAT);
+
+        KisPaintDeviceSP lineDev = new KisPaintDevice(dev->colorSpace());
+        lineDev->setDefaultBounds(bounds);
+
+        KisConvolutionPainter linePainter(lineDev);
+        linePainter.applyLineIntegral(halfLine, dev,
+                                      applyRect.topLeft(), applyRect.topLeft(),
+                                      applyRect.size(), BORDER_REPEAT);
+
+        const QImage spatial = spatialDev->convertToQImage(0, applyRect.x(), applyRect.y(), applyRect.width(), applyRect.height());
+        const QImage line = lineDev->convertToQImage(0, applyRect.x(), applyRect.y(), applyRect.width(), applyRect.height());
+
+        QPoint errorPoint;
+        return TestUtil::compareQImages(errorPoint, spatial, line, 1, 1);
+    };
+
+    const QRect fullRect = dev->exactBounds();
+
+    QVERIFY(compareWithSpatial(QPointF(halfLength, 0), Matrix::Ones(1, length), fullRect));
+    QVERIFY(compareWithSpatial(QPointF(0, halfLength), Matrix::Ones(length, 1), fullRect));
+
+    /**
+     * The diagonal kernels are square, so keep the area small enough
+     * for the spatial engine. The 45-degree digital lines are exact,
+     * so the results should coincide with the spatial ones as well.
+     */
+    const QRect diagonalRect(fullRect.center() - QPoint(64, 64), QSize(128, 128));
+
+    const Matrix diagonal = Matrix::Identity(length, length);
+    QVERIFY(compareWithSpatial(QPointF(halfLength, halfLength), diagonal, diagonalRect));
+    QVERIFY(compareWithSpatial(QPointF(halfLength, -halfLength), diagonal.colwise().reverse(), diagonalRect));
+}
+
 KISTEST_MAIN(KisConvolutionPainterTest)
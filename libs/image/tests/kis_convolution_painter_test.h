@@ -52,6 +52,9 @@ private Q_SLOTS:
 
     void testNormalMapSpatial();
     void testNormalMapFFTW();
+
+    void testSeparableMatchesSpatial();
+    void testLineIntegral();
 };
 
 #endif
@@ -20,6 +20,7 @@
 #include "kis_layer.h"
 #include "kis_paint_layer.h"
 #include "kis_selection.h"
+#include "kis_pixel_selection.h"
 #include "kis_datamanager.h"
 #include "kis_global.h"
 #include <testutil.h>
@@ -226,6 +227,59 @@ void KisFixedPaintDeviceTest::testBltFixedSmall()
     }
 }
 
+void KisFixedPaintDeviceTest::testBltFixedPooledAllocator()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace * alphaCs = KoColorSpaceRegistry::instance()->alpha8();
+
+    KisOptimizedByteArray::PooledMemoryAllocatorSP allocator(
+        new KisOptimizedByteArray::PooledMemoryAllocator());
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    // the selection makes the painter use all its intermediate buffers
+    KisSelectionSP selection = new KisSelection();
+    selection->pixelSelection()->select(QRect(0, 0, 1000, 1000));
+
+    KisPainter gc(dev, selection);
+    gc.setMemoryAllocator(allocator);
+    QCOMPARE(gc.memoryAllocator(), KisOptimizedByteArray::MemoryAllocatorSP(allocator));
+
+    const QRect dabRect(0, 0, 32, 32);
+    const KoColor red(Qt::red, cs);
+
+    for (int i = 0; i < 10; i++) {
+        if (i == 1) {
+            // the first dab fills in the pool
+            allocator->resetStatistics();
+        }
+
+        KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs, allocator);
+        dab->setRect(dabRect);
+        dab->initialize();
+        dab->fill(dabRect, red);
+
+        KisFixedPaintDeviceSP mask = new KisFixedPaintDevice(alphaCs, allocator);
+        mask->setRect(dabRect);
+        mask->initialize(OPACITY_OPAQUE_U8);
+
+        gc.bltFixed(QPoint(i * 40, 0), dab, dabRect);
+        gc.bltFixedWithFixedSelection(i * 40, 50, dab, mask, dabRect.width(), dabRect.height());
+    }
+
+    const KisOptimizedByteArray::PooledMemoryAllocator::Statistics stats =
+        allocator->statistics();
+
+    QVERIFY(stats.numAllocations > 0);
+    QCOMPARE(stats.numSystemAllocations, 0);
+
+    KoColor pixel(cs);
+    dev->pixel(9 * 40 + 10, 10, &pixel);
+    QCOMPARE(pixel, red);
+    dev->pixel(9 * 40 + 10, 60, &pixel);
+    QCOMPARE(pixel, red);
+}
+
 void KisFixedPaintDeviceTest::testBltPerformance()
 {
     QImage image(QString(FILES_DATA_DIR) + '/' + "hakonepa_transparent.png");
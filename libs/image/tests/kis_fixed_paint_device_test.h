@@ -23,6 +23,7 @@ private Q_SLOTS:
     void testBltFixed();
     void testBltFixedOpacity();
     void testBltFixedSmall();
+    void testBltFixedPooledAllocator();
     void testColorSpaceConversion();
     void testBltPerformance();
     void testMirroring_data();
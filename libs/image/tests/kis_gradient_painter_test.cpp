@@ -20,6 +20,7 @@
 #include <resources/KoStopGradient.h>
 
 #include "krita_utils.h"
+#include "KisGradientShapeEvaluatorFactory.h"
 #include <testutil.h>
 
 
@@ -318,4 +319,67 @@ void KisGradientPainterTest::testCachedStrategy()
     QVERIFY(maxError < 2 * maxRelError);
 }
 
+void KisGradientPainterTest::testShapeEvaluator_data()
+{
+    QTest::addColumn<int>("shape");
+    QTest::addColumn<QPointF>("point");
+    QTest::addColumn<qreal>("expectedValue");
+
+    // the gradient vector goes from (10, 20) to (110, 20)
+    QTest::newRow("linear") << int(KisGradientShapeParams::Linear) << QPointF(60, 47) << 0.5;
+    QTest::newRow("bilinear") << int(KisGradientShapeParams::BiLinear) << QPointF(-40, 47) << 0.5;
+    QTest::newRow("radial") << int(KisGradientShapeParams::Radial) << QPointF(10, 120) << 1.0;
+    QTest::newRow("square") << int(KisGradientShapeParams::Square) << QPointF(60, 70) << 0.5;
+    QTest::newRow("conical") << int(KisGradientShapeParams::Conical) << QPointF(10, 70) << 0.25;
+    QTest::newRow("conical-symetric") << int(KisGradientShapeParams::ConicalSymetric) << QPointF(10, -30) << 0.5;
+    QTest::newRow("spiral") << int(KisGradientShapeParams::Spiral) << QPointF(10, 70) << 0.75;
+    QTest::newRow("reverse-spiral") << int(KisGradientShapeParams::ReverseSpiral) << QPointF(10, 70) << 1.25;
+}
+
+void KisGradientPainterTest::testShapeEvaluator()
+{
+    QFETCH(int, shape);
+    QFETCH(QPointF, point);
+    QFETCH(qreal, expectedValue);
+
+    {
+        const KisGradientShapeParams params(KisGradientShapeParams::Shape(shape), QPointF(10, 20), QPointF(110, 20));
+        QScopedPointer<KisGradientShapeEvaluatorBase> scalar(
+            createScalarClass<KisGradientShapeEvaluatorFactory>(params));
+
+        double value = 0;
+        scalar->valuesAt(point.x(), point.y(), 1, &value);
+        QVERIFY(qAbs(value - expectedValue) < 1e-9);
+    }
+
+    /**
+     * Compare the vectorized evaluator with the scalar one over
+     * the rows of different width, so that both the vector body
+     * and the scalar tail are checked
+     */
+    const KisGradientShapeParams params(KisGradientShapeParams::Shape(shape), QPointF(10.3, 20.7), QPointF(131.1, 87.9));
+
+    QScopedPointer<KisGradientShapeEvaluatorBase> scalar(
+        createScalarClass<KisGradientShapeEvaluatorFactory>(params));
+    QScopedPointer<KisGradientShapeEvaluatorBase> optimized(
+        createOptimizedClass<KisGradientShapeEvaluatorFactory>(params));
+
+    for (int width = 1; width <= 67; width += 3) {
+        for (int y = -50; y <= 150; y += 25) {
+            std::vector<double> ref(width);
+            std::vector<double> result(width);
+
+            scalar->valuesAt(-30, y, width, ref.data());
+            optimized->valuesAt(-30, y, width, result.data());
+
+            for (int i = 0; i < width; i++) {
+                if (qAbs(ref[i] - result[i]) > 1e-9) {
+                    qDebug() << ppVar(width) << ppVar(i) << ppVar(y) << ppVar(ref[i]) << ppVar(result[i]);
+                    QFAIL("vectorized shape evaluator differs from the scalar one");
+                }
+            }
+        }
+    }
+}
+
 SIMPLE_TEST_MAIN(KisGradientPainterTest)
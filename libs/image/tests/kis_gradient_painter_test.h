@@ -25,6 +25,9 @@ private Q_SLOTS:
     void testSplitDisjointPaths();
 
     void testCachedStrategy();
+
+    void testShapeEvaluator_data();
+    void testShapeEvaluator();
 };
 
 #endif
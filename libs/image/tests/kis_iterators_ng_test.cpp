@@ -7,6 +7,7 @@
 
 #include "kis_iterators_ng_test.h"
 #include <QApplication>
+#include <QRegion>
 
 #include <simpletest.h>
 #include <KoColor.h>
@@ -19,6 +20,7 @@
 
 #include "kis_paint_device.h"
 #include <kis_iterator_ng.h>
+#include "KisTileSpanIterator.h"
 #include "kis_global.h"
 #include <testutil.h>
 #include <testimage.h>
@@ -246,6 +248,87 @@ void KisIteratorNGTest::sequentialIter(const KoColorSpace * colorSpace)
     }
 }
 
+void KisIteratorNGTest::tileSpanIter(const KoColorSpace * colorSpace)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(colorSpace);
+    dev->setX(10);
+    dev->setY(-15);
+
+    const int pixelSize = colorSpace->pixelSize();
+    const QRect rc(10, 10, 150, 130);
+
+    { // check const iterator with **empty** area! It should neither crash nor enter the loop
+        KisTileSpanConstIterator it(dev, QRect());
+
+        while (it.nextSpan()) {
+            QVERIFY(0 && "we should never enter the loop");
+        }
+    }
+
+    // Const does not extend the extent
+    {
+        KisTileSpanConstIterator it(dev, rc);
+        while (it.nextSpan());
+        QCOMPARE(dev->extent(), QRect());
+    }
+
+    // write with spans, every pixel should be visited exactly once
+    {
+        KisTileSpanIterator it(dev, rc);
+        QRegion visited;
+
+        while (it.nextSpan()) {
+            const QRect span(it.x(), it.y(), it.spanWidth(), it.spanHeight());
+
+            QVERIFY(rc.contains(span));
+            QVERIFY(!visited.intersects(span));
+            visited += span;
+
+            // spans never cross the tile borders
+            QCOMPARE((it.x() - dev->x()) / 64, (span.right() - dev->x()) / 64);
+            QCOMPARE((it.y() - dev->y()) / 64, (span.bottom() - dev->y()) / 64);
+
+            quint8 *row = it.rawData();
+            for (int y = span.top(); y <= span.bottom(); y++) {
+                for (int x = span.left(); x <= span.right(); x++) {
+                    KoColor c(QColor(x % 255, y % 255, 0), colorSpace);
+                    memcpy(row + (x - span.left()) * pixelSize, c.data(), pixelSize);
+                }
+                row += it.rowStride();
+            }
+        }
+
+        QCOMPARE(visited, QRegion(rc));
+        QCOMPARE(dev->exactBounds(), rc);
+    }
+
+    // read back with the sequential iterator
+    {
+        KisSequentialConstIterator it(dev, rc);
+
+        while (it.nextPixel()) {
+            KoColor c(QColor(it.x() % 255, it.y() % 255, 0), colorSpace);
+            QVERIFY(memcmp(it.rawDataConst(), c.data(), pixelSize) == 0);
+        }
+    }
+
+    // and with the const span iterator
+    {
+        KisTileSpanConstIterator it(dev, rc);
+
+        while (it.nextSpan()) {
+            const quint8 *row = it.rawDataConst();
+            for (int y = it.y(); y < it.y() + it.spanHeight(); y++) {
+                for (int x = it.x(); x < it.x() + it.spanWidth(); x++) {
+                    KoColor c(QColor(x % 255, y % 255, 0), colorSpace);
+                    QVERIFY(memcmp(row + (x - it.x()) * pixelSize, c.data(), pixelSize) == 0);
+                }
+                row += it.rowStride();
+            }
+        }
+    }
+}
+
 void KisIteratorNGTest::hLineIter(const KoColorSpace * colorSpace)
 {
     KisPaintDevice dev(colorSpace);
@@ -482,4 +565,9 @@ void KisIteratorNGTest::randomAccessor()
     allCsApplicator(&KisIteratorNGTest::randomAccessor);
 }
 
+void KisIteratorNGTest::tileSpanIter()
+{
+    allCsApplicator(&KisIteratorNGTest::tileSpanIter);
+}
+
 KISTEST_MAIN(KisIteratorNGTest)
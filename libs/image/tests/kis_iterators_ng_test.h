@@ -26,6 +26,7 @@ private:
     void sequentialIter(const KoColorSpace * colorSpace);
     void hLineIter(const KoColorSpace * cs);
     void randomAccessor(const KoColorSpace * cs);
+    void tileSpanIter(const KoColorSpace * cs);
 
 private Q_SLOTS:
     void justCreation();
@@ -37,6 +38,7 @@ private Q_SLOTS:
     void sequentialIteratorWithProgressIncomplete();
     void hLineIter();
     void randomAccessor();
+    void tileSpanIter();
 };
 
 #endif
@@ -658,4 +658,65 @@ void KisLayerStyleProjectionPlaneTest::testBlending()
     KIS_DUMP_DEVICE_2(originalBg, rc, "04_knockout", "dd");
 }
 
+void KisLayerStyleProjectionPlaneTest::testIncrementalUpdate()
+{
+    const QRect imageRect(0, 0, 300, 300);
+    const QRect fillRect(30, 30, 150, 150);
+    const QRect dabRect(200, 200, 20, 20);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "styles test");
+
+    KisPaintLayerSP layer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+    image->addNode(layer);
+
+    KisPSDLayerStyleSP style(new KisPSDLayerStyle());
+    style->dropShadow()->setSize(15);
+    style->dropShadow()->setDistance(15);
+    style->dropShadow()->setNoise(0);
+    style->dropShadow()->setEffectEnabled(true);
+    style->stroke()->setSize(5);
+    style->stroke()->setEffectEnabled(true);
+    style->bevelAndEmboss()->setSize(10);
+    style->bevelAndEmboss()->setEffectEnabled(true);
+
+    KisPainter gc(layer->paintDevice());
+    gc.setPaintColor(KoColor(Qt::red, cs));
+    gc.setFillStyle(KisPainter::FillStyleForegroundColor);
+    gc.paintEllipse(fillRect);
+
+    KisLayerStyleProjectionPlane incrementalPlane(layer.data(), style);
+    incrementalPlane.recalculate(imageRect, layer);
+
+    // a change of the color only should not affect the styles
+    layer->paintDevice()->fill(QRect(80, 80, 20, 20), KoColor(Qt::green, cs));
+    incrementalPlane.recalculate(imageRect, layer);
+
+    // the update rect is much bigger than the actually changed area
+    gc.paintEllipse(dabRect);
+    incrementalPlane.recalculate(imageRect, layer);
+
+    KisLayerStyleProjectionPlane referencePlane(layer.data(), style);
+    referencePlane.recalculate(imageRect, layer);
+
+    KisPaintDeviceSP incrementalResult = new KisPaintDevice(cs);
+    KisPaintDeviceSP referenceResult = new KisPaintDevice(cs);
+
+    {
+        KisPainter painter(incrementalResult);
+        incrementalPlane.apply(&painter, imageRect);
+    }
+
+    {
+        KisPainter painter(referenceResult);
+        referencePlane.apply(&painter, imageRect);
+    }
+
+    QImage incrementalImage = incrementalResult->convertToQImage(0, imageRect);
+    QImage referenceImage = referenceResult->convertToQImage(0, imageRect);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::compareQImages(errorPoint, referenceImage, incrementalImage));
+}
+
 KISTEST_MAIN(KisLayerStyleProjectionPlaneTest)
@@ -36,6 +36,8 @@ private Q_SLOTS:
 
     void testBlending();
 
+    void testIncrementalUpdate();
+
 private:
     void test(KisPSDLayerStyleSP style, const QString testName);
 
@@ -170,6 +170,19 @@ public:
         // KisMaskSimilarityTester::exhaustiveTest(bounds,type);
     }
 
+    template <typename MaskGenerator>
+    static void runSmallMaskGenTest(MaskGenerator& generator, MaskType type) {
+        // small dabs are supersampled, so keep the generator's own diameter
+        QRect bounds(0,0,12,12);
+        QVERIFY(generator.shouldSupersample());
+
+        MaskGenerator scalarGenerator(generator);
+
+        scalarGenerator
+            .setMaskScalarApplicator(); // Force usage of scalar backend
+        KisMaskSimilarityTester(scalarGenerator.applicator(), generator.applicator(), bounds, type);
+    }
+
 private:
     QString getTypeName(MaskType type) {
 
@@ -249,4 +262,64 @@ void KisMaskSimilarityTest::testSoftRectMask()
     KisMaskSimilarityTester::runMaskGenTest(generator,RECT_SOFT);
 }
 
+void KisMaskSimilarityTest::testSpikedMasks()
+{
+    const KisCubicCurve pointsCurve(QString("0,1;1,0"));
+
+    {
+        KisCircleMaskGenerator generator(499.5, 0.5, 0.5, 0.5, 5, true);
+        KisMaskSimilarityTester::runMaskGenTest(generator,DEFAULT);
+    }
+    {
+        KisGaussCircleMaskGenerator generator(499.5, 0.5, 1, 1, 3, true);
+        KisMaskSimilarityTester::runMaskGenTest(generator,CIRC_GAUSS);
+    }
+    {
+        KisCurveCircleMaskGenerator generator(499.5, 0.5, 0.5, 0.5, 7, pointsCurve, true);
+        KisMaskSimilarityTester::runMaskGenTest(generator,CIRC_SOFT);
+    }
+    {
+        KisRectangleMaskGenerator generator(499.5, 0.5, 0.5, 0.5, 5, true);
+        KisMaskSimilarityTester::runMaskGenTest(generator,RECT);
+    }
+    {
+        KisGaussRectangleMaskGenerator generator(499.5, 0.5, 0.5, 0.2, 3, true);
+        KisMaskSimilarityTester::runMaskGenTest(generator,RECT_GAUSS);
+    }
+    {
+        KisCurveRectangleMaskGenerator generator(499.5, 0.5, 0.5, 0.2, 4, pointsCurve, true);
+        KisMaskSimilarityTester::runMaskGenTest(generator,RECT_SOFT);
+    }
+}
+
+void KisMaskSimilarityTest::testSupersampledMasks()
+{
+    const KisCubicCurve pointsCurve(QString("0,1;1,0"));
+
+    {
+        KisCircleMaskGenerator generator(7.5, 0.8, 0.5, 0.5, 2, true);
+        KisMaskSimilarityTester::runSmallMaskGenTest(generator,DEFAULT);
+    }
+    {
+        KisGaussCircleMaskGenerator generator(7.5, 0.8, 1, 1, 2, true);
+        KisMaskSimilarityTester::runSmallMaskGenTest(generator,CIRC_GAUSS);
+    }
+    {
+        KisCurveCircleMaskGenerator generator(7.5, 0.8, 0.5, 0.5, 2, pointsCurve, true);
+        KisMaskSimilarityTester::runSmallMaskGenTest(generator,CIRC_SOFT);
+    }
+    {
+        KisRectangleMaskGenerator generator(7.5, 0.8, 0.5, 0.5, 2, true);
+        KisMaskSimilarityTester::runSmallMaskGenTest(generator,RECT);
+    }
+    {
+        KisGaussRectangleMaskGenerator generator(7.5, 0.8, 0.5, 0.2, 2, true);
+        KisMaskSimilarityTester::runSmallMaskGenTest(generator,RECT_GAUSS);
+    }
+    {
+        KisCurveRectangleMaskGenerator generator(7.5, 0.8, 0.5, 0.2, 2, pointsCurve, true);
+        KisMaskSimilarityTester::runSmallMaskGenTest(generator,RECT_SOFT);
+    }
+}
+
 SIMPLE_TEST_MAIN(KisMaskSimilarityTest)
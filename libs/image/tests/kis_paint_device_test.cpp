@@ -1537,6 +1537,64 @@ void KisPaintDeviceTest::testLodDevice()
                                   "lod", "lod1-offset-6-14"));
 }
 
+void syncLodCacheIncrementally(KisPaintDeviceSP dev, int levelOfDetail, KisRegion *dirtyRegion)
+{
+    QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createIncrementalLodDataStruct(levelOfDetail, dirtyRegion));
+
+    Q_FOREACH(QRect rect, KritaUtils::splitRegionIntoPatches(*dirtyRegion, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s.data(), rect);
+    }
+
+    dev->uploadLodDataStruct(s.data());
+}
+
+void KisPaintDeviceTest::testIncrementalLodSync()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(QRect(0,0,512,512));
+    dev->setDefaultBounds(bounds);
+
+    fillGradientDevice(dev, QRect(0,0,512,512));
+
+    KisRegion dirtyRegion;
+
+    // nothing is cached yet, so everything is regenerated
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncrementally(dev, 1, &dirtyRegion);
+    QCOMPARE(dirtyRegion.boundingRect(), QRect(0,0,512,512));
+
+    // nothing has changed
+    syncLodCacheIncrementally(dev, 1, &dirtyRegion);
+    QVERIFY(dirtyRegion.isEmpty());
+
+    bounds->testingSetLevelOfDetail(0);
+    dev->fill(QRect(100,100,10,10), KoColor(Qt::red, cs));
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncrementally(dev, 1, &dirtyRegion);
+    QCOMPARE(dirtyRegion.boundingRect(), QRect(64,64,64,64));
+
+    const QImage incrementalResult = dev->convertToQImage(0, 0, 0, 256, 256);
+
+    syncLodCache(dev, 1);
+    QCOMPARE(incrementalResult, dev->convertToQImage(0, 0, 0, 256, 256));
+
+    // a different level of detail invalidates the cache
+    bounds->testingSetLevelOfDetail(2);
+    syncLodCacheIncrementally(dev, 2, &dirtyRegion);
+    QCOMPARE(dirtyRegion.boundingRect(), QRect(0,0,512,512));
+
+    // moving the device invalidates the cache
+    bounds->testingSetLevelOfDetail(0);
+    dev->setX(64);
+
+    bounds->testingSetLevelOfDetail(2);
+    syncLodCacheIncrementally(dev, 2, &dirtyRegion);
+    QCOMPARE(dirtyRegion.boundingRect(), QRect(64,0,512,512));
+}
+
 void KisPaintDeviceTest::benchmarkLod1Generation()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
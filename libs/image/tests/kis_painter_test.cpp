@@ -10,6 +10,7 @@
 #include <kis_debug.h>
 #include <QRect>
 #include <QElapsedTimer>
+#include <cmath>
 #include <QtXml>
 
 #include <KoChannelInfo.h>
@@ -609,6 +610,99 @@ void KisPainterTest::testMassiveBltFixedCornerCases()
     QVERIFY(dst->extent().isEmpty());
 }
 
+void KisPainterTest::testMassiveBltFixedDenseStroke_data()
+{
+    QTest::addColumn<bool>("useSelection");
+    QTest::addColumn<QPoint>("dstOffset");
+    QTest::addColumn<QPoint>("selectionOffset");
+
+    QTest::newRow("aligned") << false << QPoint() << QPoint();
+    QTest::newRow("dst-offset") << false << QPoint(13, 7) << QPoint();
+    QTest::newRow("sel-aligned") << true << QPoint() << QPoint();
+    QTest::newRow("sel-misaligned") << true << QPoint(13, 7) << QPoint(-5, 29);
+}
+
+void KisPainterTest::testMassiveBltFixedDenseStroke()
+{
+    QFETCH(bool, useSelection);
+    QFETCH(QPoint, dstOffset);
+    QFETCH(QPoint, selectionOffset);
+
+    const KoColorSpace* cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QRect devicesRect;
+    QList<KisRenderedDab> devices;
+
+    // a dense stroke of small overlapping dabs crossing the tile borders
+    for (int i = 0; i < 60; i++) {
+        const QPoint center(20 + i * 3, 64 + qRound(20 * std::sin(i * 0.2)));
+        const QRect rc(center - QPoint(6, 6), QSize(13, 13));
+
+        KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+        dev->setRect(rc);
+        dev->initialize();
+        dev->fill(rc, KoColor(QColor(255 - i * 4, i * 4, 128, 160), cs));
+        dev->fill(kisGrowRect(rc, -3), KoColor(QColor(0, 0, 255 - i * 4, 220), cs));
+
+        KisRenderedDab dab;
+        dab.device = dev;
+        dab.offset = rc.topLeft();
+        dab.opacity = 0.3 + 0.7 * (i % 5) / 4.0;
+        dab.flow = 0.5 + 0.5 * (i % 3) / 2.0;
+
+        devices << dab;
+        devicesRect |= rc;
+    }
+
+    KisSelectionSP selection;
+    if (useSelection) {
+        selection = new KisSelection();
+        selection->pixelSelection()->moveTo(selectionOffset);
+        selection->pixelSelection()->select(kisGrowRect(devicesRect, -9), 200);
+    }
+
+    const QRect fullRect = kisGrowRect(devicesRect, 10);
+
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    dst->moveTo(dstOffset);
+    dst->fill(fullRect, KoColor(Qt::white, cs));
+
+    KisPaintDeviceSP expected = new KisPaintDevice(cs);
+    expected->makeCloneFrom(dst, dst->extent());
+
+    {
+        KisPainter painter(dst);
+        painter.setSelection(selection);
+
+        for (int x = fullRect.x(); x <= fullRect.right(); x += 48) {
+            const QRect rc(x, fullRect.y(), 48, fullRect.height());
+            painter.bltFixed(rc & fullRect, devices);
+        }
+
+        painter.end();
+    }
+
+    {
+        // the reference: the same dabs composited one-by-one
+        KisPainter painter(expected);
+        painter.setSelection(selection);
+
+        Q_FOREACH (const KisRenderedDab &dab, devices) {
+            painter.bltFixed(fullRect, QList<KisRenderedDab>() << dab);
+        }
+
+        painter.end();
+    }
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint,
+                                  expected->convertToQImage(0, fullRect),
+                                  dst->convertToQImage(0, fullRect), 1, 1)) {
+        QFAIL(QString("Tile-major compositing differs from the sequential one, first different pixel: %1,%2")
+              .arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
 
 #include "kis_lod_transform.h"
 
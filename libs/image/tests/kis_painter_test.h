@@ -49,6 +49,9 @@ private Q_SLOTS:
 
     void testMassiveBltFixedCornerCases();
 
+    void testMassiveBltFixedDenseStroke_data();
+    void testMassiveBltFixedDenseStroke();
+
 
     void testOptimizedCopying();
 };
@@ -0,0 +1,97 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTileRevisionTracker.h"
+
+#include "kis_datamanager.h"
+#include "kis_algebra_2d.h"
+
+
+namespace {
+
+inline quint64 tileKey(qint32 col, qint32 row)
+{
+    return (quint64(quint32(col)) << 32) | quint32(row);
+}
+
+}
+
+QVector<QRect> KisTileRevisionTracker::update(KisDataManagerSP dataManager, const QRect &limitRect)
+{
+    using KisAlgebra2D::divideFloor;
+
+    const int tileWidth = KisTileData::WIDTH;
+    const int tileHeight = KisTileData::HEIGHT;
+
+    QRect extent = dataManager->extent() | m_extent;
+    if (!limitRect.isEmpty()) {
+        extent &= limitRect;
+    }
+
+    QHash<quint64, Revision> newRevisions;
+    newRevisions.reserve(m_revisions.size());
+
+    QVector<QRect> changedRects;
+
+    if (!extent.isEmpty()) {
+        const int firstCol = divideFloor(extent.left(), tileWidth);
+        const int lastCol = divideFloor(extent.right(), tileWidth);
+        const int firstRow = divideFloor(extent.top(), tileHeight);
+        const int lastRow = divideFloor(extent.bottom(), tileHeight);
+
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int col = firstCol; col <= lastCol; col++) {
+                const quint64 key = tileKey(col, row);
+                auto it = m_revisions.constFind(key);
+
+                bool tileExists = false;
+                KisTileSP tile = dataManager->getReadOnlyTileLazy(col, row, tileExists);
+
+                bool changed = false;
+
+                if (tileExists) {
+                    Revision revision;
+                    revision.tileId = tile->uniqueId();
+                    revision.writeCount = tile->writeCount();
+                    newRevisions.insert(key, revision);
+
+                    changed = it == m_revisions.constEnd() ||
+                        it->tileId != revision.tileId ||
+                        it->writeCount != revision.writeCount;
+                } else {
+                    changed = it != m_revisions.constEnd();
+                }
+
+                if (changed) {
+                    changedRects << QRect(col * tileWidth, row * tileHeight,
+                                          tileWidth, tileHeight);
+                }
+            }
+        }
+    }
+
+    m_revisions.swap(newRevisions);
+
+    m_extent = QRect();
+    for (auto it = m_revisions.constBegin(); it != m_revisions.constEnd(); ++it) {
+        const qint32 col = qint32(quint32(it.key() >> 32));
+        const qint32 row = qint32(quint32(it.key()));
+        m_extent |= QRect(col * tileWidth, row * tileHeight, tileWidth, tileHeight);
+    }
+
+    return changedRects;
+}
+
+void KisTileRevisionTracker::clear()
+{
+    m_revisions.clear();
+    m_extent = QRect();
+}
+
+int KisTileRevisionTracker::numTiles() const
+{
+    return m_revisions.size();
+}
@@ -0,0 +1,68 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILEREVISIONTRACKER_H
+#define KISTILEREVISIONTRACKER_H
+
+#include <QHash>
+#include <QRect>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * Finds the tiles of a data manager changed since the previous check.
+ *
+ * The tracker remembers the unique id and the write counter of every tile
+ * (see KisTile::uniqueId() and KisTile::writeCount()), which is just a few
+ * bytes per tile. It doesn't keep any tile data alive, so, unlike a
+ * copy-on-write snapshot of the device, it doesn't make the following
+ * writes into the device detach their own copies of the tiles.
+ *
+ * The tracker is a value type, it can be copied to check the changes
+ * tentatively and be committed later by copying it back.
+ *
+ * The tracker itself is not thread-safe.
+ */
+class KRITAIMAGE_EXPORT KisTileRevisionTracker
+{
+public:
+    /**
+     * Compares the tiles of \p dataManager with the ones remembered by the
+     * previous call and remembers the current state of the tiles.
+     *
+     * \p limitRect, if not empty, restricts the tracking to the tiles
+     * intersecting it. The rect is in the coordinates of the data manager.
+     *
+     * @return the rects of the tiles that have been written into, created
+     * or removed since the previous call, in the coordinates of the data
+     * manager. The first call reports all the existing tiles.
+     */
+    QVector<QRect> update(KisDataManagerSP dataManager, const QRect &limitRect = QRect());
+
+    /**
+     * Forgets all the tiles, so the next update() will report all the
+     * existing tiles as changed
+     */
+    void clear();
+
+    /**
+     * @return the number of the remembered tiles
+     */
+    int numTiles() const;
+
+private:
+    struct Revision {
+        quint64 tileId = 0;
+        int writeCount = 0;
+    };
+
+    QHash<quint64, Revision> m_revisions;
+    QRect m_extent;
+};
+
+#endif // KISTILEREVISIONTRACKER_H
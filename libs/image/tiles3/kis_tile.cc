@@ -12,6 +12,12 @@
 #include "kis_memento_manager.h"
 #include "kis_debug.h"
 
+#include <atomic>
+
+namespace {
+std::atomic<quint64> s_lastTileId(0);
+}
+
 
 void KisTile::init(qint32 col, qint32 row,
                    KisTileData *defaultTileData, KisMementoManager* mm)
@@ -20,6 +26,8 @@ void KisTile::init(qint32 col, qint32 row,
     m_row = row;
     m_lockCounter = 0;
 
+    m_uniqueId = ++s_lastTileId;
+
     m_extent = QRect(m_col * KisTileData::WIDTH, m_row * KisTileData::HEIGHT,
                      KisTileData::WIDTH, KisTileData::HEIGHT);
 
@@ -262,6 +270,12 @@ void KisTile::lockForWrite()
 
 void KisTile::unlockForWrite()
 {
+    /**
+     * The counter is incremented after the data has been written, so
+     * the users who see the new value will also see the new data
+     */
+    m_writeCount.ref();
+
     unblockSwapping();
     DEBUG_LOG_ACTION("unlock [W]");
 
@@ -119,6 +119,23 @@ public:
         return m_tileData;
     }
 
+    /**
+     * The identifier of the tile, unique among all the tiles created
+     * during the session. Together with writeCount() it tells whether
+     * the content of a tile could have changed since some moment without
+     * keeping a copy of the tile (see KisTileRevisionTracker).
+     */
+    inline quint64 uniqueId() const {
+        return m_uniqueId;
+    }
+
+    /**
+     * The number of times the tile has been unlocked after writing
+     */
+    inline int writeCount() const {
+        return m_writeCount.loadAcquire();
+    }
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
@@ -136,6 +153,9 @@ private:
     qint32 m_col;
     qint32 m_row;
 
+    quint64 m_uniqueId;
+    QAtomicInt m_writeCount;
+
     /**
      * Added for faster retrieving by processors
      */
@@ -42,6 +42,7 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+        qint64 swapDeduplicatedSize;
     };
 
     MemoryStatistics memoryStatistics();
@@ -77,6 +78,15 @@ public:
         return m_memoryMetric.loadAcquire();
     }
 
+    /**
+     * The metric of the memento tiles kept in memory, as counted
+     * by the last cycle of the pooler
+     */
+    inline qint64 historicalMemoryMetric() const
+    {
+        return m_pooler.lastHistoricalMemoryMetric();
+    }
+
     KisTileDataStoreIterator* beginIteration();
     void endIteration(KisTileDataStoreIterator* iterator);
 
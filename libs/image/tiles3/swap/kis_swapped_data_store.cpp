@@ -10,11 +10,14 @@
 #include "kis_image_config.h"
 
 #include "kis_tile_compressor_2.h"
+#include "kis_assert.h"
 
 //#define COMPRESSOR_VERSION 2
 
 KisSwappedDataStore::KisSwappedDataStore()
-    : m_totalSwapMemoryUsed(0)
+    : m_totalSwapMemoryUsed(0),
+      m_totalDeduplicatedMemory(0),
+      m_numTiles(0)
 {
     KisImageConfig config(true);
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
@@ -37,10 +40,8 @@ KisSwappedDataStore::~KisSwappedDataStore()
 
 quint64 KisSwappedDataStore::numTiles() const
 {
-    // We are not acquiring the lock here...
-    // Hope QLinkedList will ensure atomic access to it's size...
-
-    return m_allocator->numChunks();
+    // the chunks are shared, so we cannot just count them
+    return m_numTiles.loadAcquire();
 }
 
 bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
@@ -61,22 +62,75 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
     qint32 bytesWritten;
     m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
 
-    KisChunk chunk = m_allocator->getChunk(bytesWritten);
-    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
-    if (!ptr) {
-        qWarning() << "swap out of tile failed";
-        return false;
+    const uint hash = qHashBits(m_buffer.constData(), bytesWritten);
+
+    KisChunk chunk;
+
+    if (findDuplicateChunk(hash, bytesWritten, chunk)) {
+        m_chunkRecords[chunk.begin()].refCount++;
+        m_totalDeduplicatedMemory += chunk.size();
+    } else {
+        chunk = m_allocator->getChunk(bytesWritten);
+        quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
+        if (!ptr) {
+            qWarning() << "swap out of tile failed";
+            return false;
+        }
+        memcpy(ptr, m_buffer.data(), bytesWritten);
+
+        m_chunksByHash.insert(hash, chunk);
+        m_chunkRecords.insert(chunk.begin(), {hash, 1});
+
+        m_totalSwapMemoryUsed += chunk.size();
     }
-    memcpy(ptr, m_buffer.data(), bytesWritten);
 
     td->releaseMemory();
     td->setSwapChunk(chunk);
 
-    m_totalSwapMemoryUsed += chunk.size();
+    m_numTiles.ref();
 
     return true;
 }
 
+bool KisSwappedDataStore::findDuplicateChunk(uint hash, qint32 size, KisChunk &chunk)
+{
+    auto it = m_chunksByHash.constFind(hash);
+    if (it == m_chunksByHash.constEnd()) return false;
+
+    KisChunk candidate = *it;
+    if (candidate.size() != quint64(size)) return false;
+
+    // the hashes may collide, so check the content as well
+    const quint8 *ptr = m_swapSpace->getReadChunkPtr(candidate);
+    if (!ptr || memcmp(ptr, m_buffer.constData(), size) != 0) return false;
+
+    chunk = candidate;
+    return true;
+}
+
+void KisSwappedDataStore::releaseChunk(KisChunk chunk)
+{
+    auto it = m_chunkRecords.find(chunk.begin());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(it != m_chunkRecords.end());
+
+    m_numTiles.deref();
+
+    if (--it->refCount > 0) {
+        m_totalDeduplicatedMemory -= chunk.size();
+        return;
+    }
+
+    auto hashIt = m_chunksByHash.find(it->hash);
+    if (hashIt != m_chunksByHash.end() && hashIt->begin() == chunk.begin()) {
+        m_chunksByHash.erase(hashIt);
+    }
+
+    m_chunkRecords.erase(it);
+
+    m_totalSwapMemoryUsed -= chunk.size();
+    m_allocator->freeChunk(chunk);
+}
+
 void KisSwappedDataStore::swapInTileData(KisTileData *td)
 {
     Q_ASSERT(!td->data());
@@ -85,7 +139,6 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
     // see comment in swapOutTileData()
 
     KisChunk chunk = td->swapChunk();
-    m_totalSwapMemoryUsed -= chunk.size();
 
     td->allocateMemory();
     td->setSwapChunk(KisChunk());
@@ -93,16 +146,14 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
     quint8 *ptr = m_swapSpace->getReadChunkPtr(chunk);
     Q_ASSERT(ptr);
     m_compressor->decompressTileData(ptr, chunk.size(), td);
-    m_allocator->freeChunk(chunk);
+    releaseChunk(chunk);
 }
 
 void KisSwappedDataStore::forgetTileData(KisTileData *td)
 {
     QMutexLocker locker(&m_lock);
 
-    m_totalSwapMemoryUsed -= td->swapChunk().size();
-
-    m_allocator->freeChunk(td->swapChunk());
+    releaseChunk(td->swapChunk());
     td->setSwapChunk(KisChunk());
 }
 
@@ -111,6 +162,11 @@ qint64 KisSwappedDataStore::totalSwapMemoryUsed() const
     return m_totalSwapMemoryUsed;
 }
 
+qint64 KisSwappedDataStore::totalDeduplicatedMemory() const
+{
+    return m_totalDeduplicatedMemory;
+}
+
 void KisSwappedDataStore::debugStatistics()
 {
     m_allocator->sanityCheck();
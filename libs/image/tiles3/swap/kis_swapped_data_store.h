@@ -11,14 +11,30 @@
 
 #include <QMutex>
 #include <QByteArray>
+#include <QHash>
+#include <QAtomicInt>
+
+#include "kis_chunk_allocator.h"
 
 
 class QMutex;
 class KisTileData;
 class KisAbstractTileCompressor;
-class KisChunkAllocator;
 class KisMemoryWindow;
 
+/**
+ * The store keeps the swapped out tile data in a swap file in
+ * compressed form.
+ *
+ * Most of the swapped out tile data belong to the undo history, and
+ * the history often contains several copies of the same tile, e.g.
+ * when a tile has been touched by a stroke without actually being
+ * changed, or when the same content has been restored several times.
+ * Therefore the chunks of the swap file are deduplicated: the
+ * compressed data is hashed and the tile data with identical content
+ * share the same chunk, which is freed only when the last of them is
+ * swapped in or forgotten.
+ */
 class KRITAIMAGE_EXPORT KisSwappedDataStore
 {
 public:
@@ -59,12 +75,27 @@ public:
      */
     qint64 totalSwapMemoryUsed() const;
 
+    /**
+     * Returns the size of the memory saved by sharing the
+     * chunks between the tile data with identical content
+     */
+    qint64 totalDeduplicatedMemory() const;
+
     /**
      * Some debugging output
      */
     void debugStatistics();
 
 private:
+    bool findDuplicateChunk(uint hash, qint32 size, KisChunk &chunk);
+    void releaseChunk(KisChunk chunk);
+
+private:
+    struct ChunkRecord {
+        uint hash = 0;
+        int refCount = 0;
+    };
+
     QByteArray m_buffer;
     KisAbstractTileCompressor *m_compressor;
 
@@ -74,6 +105,11 @@ private:
     QMutex m_lock;
 
     qint64 m_totalSwapMemoryUsed;
+    qint64 m_totalDeduplicatedMemory;
+
+    QHash<uint, KisChunk> m_chunksByHash;
+    QHash<quint64, ChunkRecord> m_chunkRecords;
+    QAtomicInt m_numTiles;
 };
 
 #endif /* __KIS_SWAPPED_DATA_STORE_H */
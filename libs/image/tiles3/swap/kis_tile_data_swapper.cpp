@@ -112,7 +112,27 @@ void KisTileDataSwapper::doJob()
 
     DEBUG_VALUE(m_d->limits.softLimitThreshold());
     DEBUG_VALUE(m_d->limits.hardLimitThreshold());
-
+    DEBUG_VALUE(m_d->limits.historyLimitThreshold());
+
+    if (m_d->limits.historyLimitThreshold() > 0) {
+        /**
+         * Walking through the whole store just to count the memento
+         * tiles would block the store on every cycle, so the value
+         * counted by the pooler during its own walk is used. The pooler
+         * is kicked together with the swapper and the swapper waits for
+         * DELAY before the cycle, so the value is rarely stale.
+         */
+        const qint64 historyMetric = m_d->store->historicalMemoryMetric();
+        DEBUG_VALUE(historyMetric);
+
+        if (historyMetric > m_d->limits.historyLimitThreshold()) {
+            qint64 historyFree = historyMetric - m_d->limits.historyLimit();
+            DEBUG_VALUE(historyFree);
+            DEBUG_ACTION("\t history pass");
+            memoryMetric -= pass<SoftSwapStrategy>(historyFree);
+            DEBUG_VALUE(memoryMetric);
+        }
+    }
 
     if(memoryMetric > m_d->limits.softLimitThreshold()) {
         qint32 softFree =  memoryMetric - m_d->limits.softLimit();
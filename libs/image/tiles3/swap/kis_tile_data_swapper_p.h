@@ -41,6 +41,16 @@
   |                        |
   +------------------------+  <-- 0 MiB
 
+  Independently from the total memory, the memento tiles kept
+  in memory are limited by their own budget:
+
+  |= historyLimitThreshold=|  <-- the swapper starts swapping out
+  |........................|      memento tiles, in the order of the
+  |........................|      store, the ones not accessed since
+  |........................|      the previous pass go first
+  |====  historyLimit  ====|  <-- the swapper stops swapping
+  |                        |      out memento tiles
+
  */
 
 
@@ -57,6 +67,9 @@ public:
 
         m_softLimitThreshold = qBound(0, MiB_TO_METRIC(config.tilesSoftLimit()), m_hardLimitThreshold);
         m_softLimit = m_softLimitThreshold - m_softLimitThreshold / 8;
+
+        m_historyLimitThreshold = qBound(0, MiB_TO_METRIC(config.historyLimit()), m_hardLimitThreshold);
+        m_historyLimit = m_historyLimitThreshold - m_historyLimitThreshold / 8;
     }
 
     /**
@@ -83,12 +96,25 @@ public:
         return m_softLimit;
     }
 
+    /**
+     * Zero means that the history is not limited
+     */
+    inline qint32 historyLimitThreshold() {
+        return m_historyLimitThreshold;
+    }
+
+    inline qint32 historyLimit() {
+        return m_historyLimit;
+    }
+
 private:
     qint32 m_emergencyThreshold;
     qint32 m_hardLimitThreshold;
     qint32 m_hardLimit;
     qint32 m_softLimitThreshold;
     qint32 m_softLimit;
+    qint32 m_historyLimitThreshold;
+    qint32 m_historyLimit;
 };
 
 
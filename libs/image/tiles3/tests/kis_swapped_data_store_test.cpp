@@ -119,5 +119,58 @@ void KisSwappedDataStoreTest::testRandomAccess()
         delete tileDataList[i];
 }
 
+void KisSwappedDataStoreTest::testDeduplication()
+{
+    const qint32 pixelSize = 1;
+    const quint8 defaultPixel = 128;
+    const qint32 NUM_TILES = 4;
+
+    KisImageConfig config(false);
+    config.setMaxSwapSize(4);
+    config.setSwapSlabSize(1);
+    config.setSwapWindowSize(1);
+
+    KisSwappedDataStore store;
+
+    QList<KisTileData*> tileDataList;
+    for(qint32 i = 0; i < NUM_TILES; i++)
+        tileDataList.append(new KisTileData(pixelSize, &defaultPixel, KisTileDataStore::instance()));
+
+    // the last tile data differs from the others
+    memset(tileDataList.last()->data(), 17, TILESIZE);
+
+    for(qint32 i = 0; i < NUM_TILES; i++) {
+        QVERIFY(store.trySwapOutTileData(tileDataList[i]));
+    }
+
+    QCOMPARE(store.numTiles(), quint64(NUM_TILES));
+
+    const qint64 chunkSize = tileDataList.first()->swapChunk().size();
+    QCOMPARE(tileDataList[1]->swapChunk().begin(), tileDataList[0]->swapChunk().begin());
+    QCOMPARE(tileDataList[2]->swapChunk().begin(), tileDataList[0]->swapChunk().begin());
+    QVERIFY(tileDataList[3]->swapChunk().begin() != tileDataList[0]->swapChunk().begin());
+    QCOMPARE(store.totalDeduplicatedMemory(), 2 * chunkSize);
+
+    // the shared chunk is kept until the last user is swapped in
+    store.swapInTileData(tileDataList[0]);
+    QVERIFY(memoryIsFilled(defaultPixel, tileDataList[0]->data(), TILESIZE));
+    QCOMPARE(store.totalDeduplicatedMemory(), chunkSize);
+
+    store.forgetTileData(tileDataList[1]);
+    QCOMPARE(store.totalDeduplicatedMemory(), qint64(0));
+
+    store.swapInTileData(tileDataList[2]);
+    QVERIFY(memoryIsFilled(defaultPixel, tileDataList[2]->data(), TILESIZE));
+
+    store.swapInTileData(tileDataList[3]);
+    QVERIFY(memoryIsFilled(17, tileDataList[3]->data(), TILESIZE));
+
+    QCOMPARE(store.numTiles(), quint64(0));
+    QCOMPARE(store.totalSwapMemoryUsed(), qint64(0));
+
+    for(qint32 i = 0; i < NUM_TILES; i++)
+        delete tileDataList[i];
+}
+
 SIMPLE_TEST_MAIN(KisSwappedDataStoreTest)
 
@@ -6,10 +6,16 @@
 
 #include "KoColorConversionCache.h"
 
+#include <algorithm>
+#include <array>
+
 #include <QHash>
-#include <QList>
-#include <QMutex>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QSharedPointer>
 #include <QThreadStorage>
+#include <QVector>
 
 #include <KoColorSpace.h>
 
@@ -26,8 +32,15 @@ struct KoColorConversionCacheKey {
     {
     }
 
+    /**
+     * The color spaces are compared by pointers, which is consistent
+     * with qHash() below. The registry keeps a single instance of a
+     * color space per profile, so the equal color spaces always have
+     * equal pointers. It also means that the cached transformation can
+     * be returned as it is, without resetting its color spaces.
+     */
     bool operator==(const KoColorConversionCacheKey& rhs) const {
-        return (*src == *(rhs.src)) && (*dst == *(rhs.dst))
+        return src == rhs.src && dst == rhs.dst
                 && (renderingIntent == rhs.renderingIntent)
                 && (conversionFlags == rhs.conversionFlags);
     }
@@ -61,13 +74,73 @@ struct KoColorConversionCache::CachedTransformation {
     QAtomicInt use;
 };
 
-typedef QPair<KoColorConversionCacheKey, KoCachedColorConversionTransformation> FastPathCacheItem;
+namespace {
+
+typedef QSharedPointer<KoColorConversionCache::CachedTransformation> CachedTransformationSP;
+
+/**
+ * The number of shards should be big enough for the threads
+ * converting different pairs of color spaces not to contend
+ */
+const int NumShards = 16;
+
+/**
+ * The number of transformations pinned by every thread. The
+ * conversions are usually done in pairs (e.g. to and from the
+ * composition color space), so a single entry is not enough.
+ */
+const int FastPathCacheSize = 4;
+
+struct Shard {
+    QReadWriteLock lock;
+    QHash<KoColorConversionCacheKey, CachedTransformationSP> cache;
+};
+
+/**
+ * The per-thread cache of the most recently used transformations.
+ *
+ * The items are kept in the most-recently-used order. The cache holds
+ * the transformations by shared pointers, so the thread can safely
+ * keep them even after they have been removed from the shared cache,
+ * the generation number guarantees they will never be used again.
+ */
+struct FastPathCache {
+    int generation {-1};
+    QVector<QPair<KoColorConversionCacheKey, CachedTransformationSP>> items;
+
+    CachedTransformationSP find(const KoColorConversionCacheKey &key) {
+        for (int i = 0; i < items.size(); i++) {
+            if (items[i].first == key) {
+                if (i > 0) {
+                    std::rotate(items.begin(), items.begin() + i, items.begin() + i + 1);
+                }
+                return items.first().second;
+            }
+        }
+
+        return CachedTransformationSP();
+    }
+
+    void add(const KoColorConversionCacheKey &key, CachedTransformationSP transformation) {
+        if (items.size() >= FastPathCacheSize) {
+            items.removeLast();
+        }
+        items.prepend(qMakePair(key, transformation));
+    }
+};
+
+}
 
 struct KoColorConversionCache::Private {
-    QMultiHash< KoColorConversionCacheKey, CachedTransformation*> cache;
-    QMutex cacheMutex;
+    std::array<Shard, NumShards> shards;
+    QAtomicInt generation {0};
+
+    QThreadStorage<FastPathCache*> fastStorage;
 
-    QThreadStorage<FastPathCacheItem*> fastStorage;
+    Shard& shardForKey(const KoColorConversionCacheKey &key) {
+        const uint hash = qHash(key);
+        return shards[(hash ^ (hash >> 16)) % NumShards];
+    }
 };
 
 
@@ -77,9 +150,6 @@ KoColorConversionCache::KoColorConversionCache() : d(new Private)
 
 KoColorConversionCache::~KoColorConversionCache()
 {
-    Q_FOREACH (CachedTransformation* transfo, d->cache) {
-        delete transfo;
-    }
     delete d;
 }
 
@@ -90,52 +160,62 @@ KoCachedColorConversionTransformation KoColorConversionCache::cachedConverter(co
 {
     KoColorConversionCacheKey key(src, dst, _renderingIntent, _conversionFlags);
 
-    FastPathCacheItem *cacheItem =
-        d->fastStorage.localData();
+    FastPathCache *fastCache = d->fastStorage.localData();
+    if (!fastCache) {
+        fastCache = new FastPathCache();
+        d->fastStorage.setLocalData(fastCache);
+    }
 
-    if (cacheItem) {
-        if (cacheItem->first == key) {
-            return cacheItem->second;
-        }
+    const int generation = d->generation.loadAcquire();
+    if (fastCache->generation != generation) {
+        fastCache->items.clear();
+        fastCache->generation = generation;
     }
 
-    cacheItem = 0;
+    CachedTransformationSP ct = fastCache->find(key);
+    if (ct) {
+        return KoCachedColorConversionTransformation(ct.data());
+    }
 
-    QMutexLocker lock(&d->cacheMutex);
-    QList< CachedTransformation* > cachedTransfos = d->cache.values(key);
-    if (cachedTransfos.size() != 0) {
-        Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
-            ct->transfo->setSrcColorSpace(src);
-            ct->transfo->setDstColorSpace(dst);
+    Shard &shard = d->shardForKey(key);
 
-            cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(ct));
-            break;
-        }
+    {
+        QReadLocker l(&shard.lock);
+        ct = shard.cache.value(key);
     }
-    if (!cacheItem) {
-        KoColorConversionTransformation* transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
-        CachedTransformation* ct = new CachedTransformation(transfo);
-        d->cache.insert(key, ct);
-        cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(ct));
+
+    if (!ct) {
+        QWriteLocker l(&shard.lock);
+
+        // some other thread might have created it while we were waiting
+        ct = shard.cache.value(key);
+
+        if (!ct) {
+            KoColorConversionTransformation* transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
+            ct = CachedTransformationSP(new CachedTransformation(transfo));
+            shard.cache.insert(key, ct);
+        }
     }
 
-    d->fastStorage.setLocalData(cacheItem);
-    return cacheItem->second;
+    fastCache->add(key, ct);
+    return KoCachedColorConversionTransformation(ct.data());
 }
 
 void KoColorConversionCache::colorSpaceIsDestroyed(const KoColorSpace* cs)
 {
-    d->fastStorage.setLocalData(0);
-
-    QMutexLocker lock(&d->cacheMutex);
-    QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator endIt = d->cache.end();
-    for (QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = d->cache.begin(); it != endIt;) {
-        if (it.key().src == cs || it.key().dst == cs) {
-            Q_ASSERT(it.value()->isNotInUse()); // That's terribly evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
-            delete it.value();
-            it = d->cache.erase(it);
-        } else {
-            ++it;
+    // invalidate the per-thread caches of all the threads
+    d->generation.ref();
+
+    for (Shard &shard : d->shards) {
+        QWriteLocker lock(&shard.lock);
+
+        for (auto it = shard.cache.begin(); it != shard.cache.end();) {
+            if (it.key().src == cs || it.key().dst == cs) {
+                Q_ASSERT(it.value()->isNotInUse()); // That's terribly evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
+                it = shard.cache.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
 }
@@ -165,4 +245,3 @@ const KoColorConversionTransformation* KoCachedColorConversionTransformation::tr
 {
     return m_transfo->transfo;
 }
-
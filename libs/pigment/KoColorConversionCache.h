@@ -15,6 +15,17 @@ class KoColorSpace;
 /**
  * This class holds a cache of KoColorConversionTransformations.
  *
+ * The cache is accessed by every conversion of pixels from all the worker
+ * threads, so the lookup is organized in two levels:
+ *
+ * 1) Every thread keeps a few most recently used transformations in its
+ *    thread-local storage. Most of the lookups are resolved here without
+ *    any locking.
+ *
+ * 2) The shared cache is split into several shards, each protected by its
+ *    own read-write lock. The lookups take the read lock only, the write
+ *    lock is taken only when a new transformation is created.
+ *
  * This class is not part of public API, and can be changed without notice.
  */
 class KoColorConversionCache
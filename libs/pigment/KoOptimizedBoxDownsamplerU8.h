@@ -0,0 +1,144 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoOptimizedBoxDownsamplerU8_H
+#define KoOptimizedBoxDownsamplerU8_H
+
+#include "KoOptimizedBoxDownsamplerU8Base.h"
+
+#include "KoMultiArchBuildSupport.h"
+
+#include <xsimd_extensions/xsimd.hpp>
+
+template<typename _impl = xsimd::current_arch>
+class KoOptimizedBoxDownsamplerU8 : public KoOptimizedBoxDownsamplerU8Base
+{
+public:
+    void downsampleRows(const quint8 *srcRow0, const quint8 *srcRow1, quint8 *dstRow, int numDstPixels) const override
+    {
+        static const int pixelSize = 4;
+
+#if defined(HAVE_XSIMD) && XSIMD_WITH_AVX2
+        const int pixelsPerAvx2Block = 8;
+        const int pixelsPerSse2Block = 4;
+        const int avx2Block = numDstPixels / pixelsPerAvx2Block;
+        const int rest = numDstPixels % pixelsPerAvx2Block;
+        const int sse2Block = rest / pixelsPerSse2Block;
+        const int scalarBlock = rest % pixelsPerSse2Block;
+#elif defined(HAVE_XSIMD) && XSIMD_WITH_SSE2
+        // SSE2 is a valid option even under generic
+        const int pixelsPerSse2Block = 4;
+        const int avx2Block = 0;
+        const int sse2Block = numDstPixels / pixelsPerSse2Block;
+        const int scalarBlock = numDstPixels % pixelsPerSse2Block;
+#elif defined(HAVE_XSIMD) && (XSIMD_WITH_NEON || XSIMD_WITH_NEON64)
+        const int pixelsPerNeonBlock = 8;
+        const int avx2Block = 0;
+        const int sse2Block = numDstPixels / pixelsPerNeonBlock;
+        const int scalarBlock = numDstPixels % pixelsPerNeonBlock;
+#else
+        const int avx2Block = 0;
+        const int sse2Block = 0;
+        const int scalarBlock = numDstPixels;
+#endif
+
+#if defined(HAVE_XSIMD) && XSIMD_WITH_AVX2
+        for (int i = 0; i < avx2Block; i++) {
+            const __m256i zero = _mm256_setzero_si256();
+
+            __m256i result[2];
+
+            for (int half = 0; half < 2; half++) {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcRow0) + half);
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcRow1) + half);
+
+                // vertical sums of the pixels, (0, 1 | 4, 5) and (2, 3 | 6, 7)
+                const __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+                const __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+
+                // horizontal sums of the neighbouring pixels
+                const __m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+                result[half] = _mm256_srli_epi16(sum, 2);
+            }
+
+            // packing works within 128-bit lanes, so the result
+            // should be permuted to restore the order of the pixels
+            __m256i packed = _mm256_packus_epi16(result[0], result[1]);
+            packed = _mm256_permute4x64_epi64(packed, 0xd8);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstRow), packed);
+
+            srcRow0 += 2 * pixelsPerAvx2Block * pixelSize;
+            srcRow1 += 2 * pixelsPerAvx2Block * pixelSize;
+            dstRow += pixelsPerAvx2Block * pixelSize;
+        }
+#else
+        Q_UNUSED(avx2Block);
+#endif
+
+#if defined(HAVE_XSIMD) && XSIMD_WITH_SSE2
+        for (int i = 0; i < sse2Block; i++) {
+            const __m128i zero = _mm_setzero_si128();
+
+            __m128i result[2];
+
+            for (int half = 0; half < 2; half++) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow0) + half);
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow1) + half);
+
+                // vertical sums of the pixels 0, 1 and 2, 3
+                const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+                // horizontal sums of the neighbouring pixels
+                const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+                result[half] = _mm_srli_epi16(sum, 2);
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow), _mm_packus_epi16(result[0], result[1]));
+
+            srcRow0 += 2 * pixelsPerSse2Block * pixelSize;
+            srcRow1 += 2 * pixelsPerSse2Block * pixelSize;
+            dstRow += pixelsPerSse2Block * pixelSize;
+        }
+#elif defined(HAVE_XSIMD) && (XSIMD_WITH_NEON || XSIMD_WITH_NEON64)
+        for (int i = 0; i < sse2Block; i++) {
+            // the loads deinterleave the channels
+            const uint8x16x4_t a = vld4q_u8(srcRow0);
+            const uint8x16x4_t b = vld4q_u8(srcRow1);
+
+            uint8x8x4_t result;
+            for (int channel = 0; channel < pixelSize; channel++) {
+                const uint16x8_t sum = vpadalq_u8(vpaddlq_u8(a.val[channel]), b.val[channel]);
+                result.val[channel] = vshrn_n_u16(sum, 2);
+            }
+
+            vst4_u8(dstRow, result);
+
+            srcRow0 += 2 * pixelsPerNeonBlock * pixelSize;
+            srcRow1 += 2 * pixelsPerNeonBlock * pixelSize;
+            dstRow += pixelsPerNeonBlock * pixelSize;
+        }
+#else
+        Q_UNUSED(sse2Block);
+#endif
+
+        for (int i = 0; i < scalarBlock; i++) {
+            for (int channel = 0; channel < pixelSize; channel++) {
+                const int sum = srcRow0[channel] + srcRow0[channel + pixelSize] +
+                    srcRow1[channel] + srcRow1[channel + pixelSize];
+
+                dstRow[channel] = static_cast<quint8>(sum >> 2);
+            }
+
+            srcRow0 += 2 * pixelSize;
+            srcRow1 += 2 * pixelSize;
+            dstRow += pixelSize;
+        }
+    }
+};
+
+#endif // KoOptimizedBoxDownsamplerU8_H
@@ -0,0 +1,15 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoOptimizedBoxDownsamplerU8Base.h"
+
+KoOptimizedBoxDownsamplerU8Base::KoOptimizedBoxDownsamplerU8Base()
+{
+}
+
+KoOptimizedBoxDownsamplerU8Base::~KoOptimizedBoxDownsamplerU8Base()
+{
+}
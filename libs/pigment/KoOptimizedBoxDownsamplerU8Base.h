@@ -0,0 +1,47 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoOptimizedBoxDownsamplerU8Base_H
+#define KoOptimizedBoxDownsamplerU8Base_H
+
+#include <QtGlobal>
+#include "kritapigment_export.h"
+
+/**
+ * @brief Downsamples 8-bit four-channel pixel data by the factor of 2
+ *
+ * Every destination pixel is the truncated average of a 2x2 block of the
+ * source pixels, computed for every channel separately. The alpha channel
+ * is averaged like the color channels, so the result is exact only for
+ * opaque pixels. It is good enough for the canvas previews, which is what
+ * the downsampler is used for.
+ *
+ * The actual implementation is placed in class
+ * `KoOptimizedBoxDownsamplerU8`.
+ *
+ * To create a downsampler, just call a factory. It will create a version
+ * of the downsampler optimized for your CPU architecture.
+ *
+ * \code{.cpp}
+ * QScopedPointer<KoOptimizedBoxDownsamplerU8Base> downsampler(
+ *     KoOptimizedBoxDownsamplerU8Factory::createRgbaDownsampler());
+ *
+ * // srcRow0 and srcRow1 hold 2 * numDstPixels pixels each
+ * downsampler->downsampleRows(srcRow0, srcRow1, dstRow, numDstPixels);
+ * \endcode
+ */
+class KRITAPIGMENT_EXPORT KoOptimizedBoxDownsamplerU8Base
+{
+public:
+    KoOptimizedBoxDownsamplerU8Base();
+
+    virtual ~KoOptimizedBoxDownsamplerU8Base();
+
+    virtual void downsampleRows(const quint8 *srcRow0, const quint8 *srcRow1,
+                                quint8 *dstRow, int numDstPixels) const = 0;
+};
+
+#endif // KoOptimizedBoxDownsamplerU8Base_H
@@ -0,0 +1,16 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoOptimizedBoxDownsamplerU8Factory.h"
+
+#include "KoOptimizedBoxDownsamplerU8FactoryImpl.h"
+
+
+KoOptimizedBoxDownsamplerU8Base *KoOptimizedBoxDownsamplerU8Factory::createRgbaDownsampler()
+{
+    return createOptimizedClass<
+            KoOptimizedBoxDownsamplerU8FactoryImpl>();
+}
@@ -0,0 +1,22 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoOptimizedBoxDownsamplerU8FACTORY_H
+#define KoOptimizedBoxDownsamplerU8FACTORY_H
+
+#include "KoOptimizedBoxDownsamplerU8Base.h"
+
+/**
+ * \see KoOptimizedBoxDownsamplerU8Base
+ */
+class KRITAPIGMENT_EXPORT KoOptimizedBoxDownsamplerU8Factory
+{
+public:
+    static KoOptimizedBoxDownsamplerU8Base* createRgbaDownsampler();
+};
+
+
+#endif // KoOptimizedBoxDownsamplerU8FACTORY_H
@@ -0,0 +1,19 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoOptimizedBoxDownsamplerU8FactoryImpl.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+#include "KoOptimizedBoxDownsamplerU8.h"
+
+template<>
+KoOptimizedBoxDownsamplerU8Base *
+KoOptimizedBoxDownsamplerU8FactoryImpl::create<xsimd::current_arch>()
+{
+    return new KoOptimizedBoxDownsamplerU8<xsimd::current_arch>();
+}
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoOptimizedBoxDownsamplerU8FACTORYIMPL_H
+#define KoOptimizedBoxDownsamplerU8FACTORYIMPL_H
+
+#include <KoOptimizedBoxDownsamplerU8Base.h>
+#include <KoMultiArchBuildSupport.h>
+
+class KRITAPIGMENT_EXPORT KoOptimizedBoxDownsamplerU8FactoryImpl
+{
+public:
+    template<typename _impl>
+    static KoOptimizedBoxDownsamplerU8Base* create();
+};
+
+#endif // KoOptimizedBoxDownsamplerU8FACTORYIMPL_H
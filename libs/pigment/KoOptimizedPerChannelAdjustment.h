@@ -0,0 +1,250 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoOptimizedPerChannelAdjustment_H
+#define KoOptimizedPerChannelAdjustment_H
+
+#include <QVector>
+
+#include "KoColorTransformation.h"
+#include "KoMultiArchBuildSupport.h"
+
+#include <xsimd_extensions/xsimd.hpp>
+
+/**
+ * The transfer curves of a per-channel adjustment, converted into a table
+ * of floats. Every channel has 256 samples of its curve followed by a copy
+ * of the last sample, so the linear interpolation may read the next sample
+ * without checking the bounds.
+ */
+struct KoPerChannelAdjustmentTable
+{
+    static constexpr int numChannels = 4;
+    static constexpr int numSamples = 256;
+    static constexpr int channelStride = numSamples + 1;
+
+    KoPerChannelAdjustmentTable(const quint16 *const *transferValues)
+        : values(numChannels * channelStride)
+    {
+        for (int channel = 0; channel < numChannels; channel++) {
+            float *table = values.data() + channel * channelStride;
+
+            for (int i = 0; i < numSamples; i++) {
+                table[i] = transferValues[channel] ?
+                    transferValues[channel][i] / 65535.0f :
+                    i / float(numSamples - 1);
+            }
+            table[numSamples] = table[numSamples - 1];
+        }
+    }
+
+    /**
+     * Evaluates the curve of \p channel at \p value in range [0, 1]. The
+     * values outside the range are clamped, the way LCMS does it for
+     * the tabulated curves.
+     */
+    inline float apply(int channel, float value) const
+    {
+        value = qBound(0.0f, value, 1.0f);
+
+        const float pos = value * (numSamples - 1);
+        const int index = static_cast<int>(pos);
+        const float fraction = pos - index;
+
+        const float *sample = values.constData() + channel * channelStride + index;
+        return sample[0] + (sample[1] - sample[0]) * fraction;
+    }
+
+    QVector<float> values;
+};
+
+/**
+ * A per-channel adjustment of a four-channel color space with the alpha
+ * channel stored last. The transfer curves are passed in the order the
+ * channels are stored in memory.
+ *
+ * The generic implementation is used for 16-bit and floating point
+ * channels, the vectorized one is below.
+ */
+template<typename channels_type, typename _impl, typename EnableDummyType = void>
+class KoOptimizedPerChannelAdjustment : public KoColorTransformation
+{
+public:
+    KoOptimizedPerChannelAdjustment(const quint16 *const *transferValues)
+        : m_table(transferValues)
+    {
+    }
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override
+    {
+        const channels_type *srcPtr = reinterpret_cast<const channels_type *>(src);
+        channels_type *dstPtr = reinterpret_cast<channels_type *>(dst);
+
+        const int numValues = nPixels * KoPerChannelAdjustmentTable::numChannels;
+
+        for (int i = 0; i < numValues; i++) {
+            const int channel = i % KoPerChannelAdjustmentTable::numChannels;
+            dstPtr[i] = fromFloat(m_table.apply(channel, toFloat(srcPtr[i])));
+        }
+    }
+
+protected:
+    static inline float toFloat(quint16 value) {
+        return value / 65535.0f;
+    }
+
+    static inline float toFloat(float value) {
+        return value;
+    }
+
+    static inline channels_type fromFloat(float value) {
+        return std::is_same<channels_type, quint16>::value ?
+            static_cast<channels_type>(value * 65535.0f + 0.5f) :
+            static_cast<channels_type>(value);
+    }
+
+protected:
+    KoPerChannelAdjustmentTable m_table;
+};
+
+/**
+ * 8-bit channels are adjusted with a lookup table on every architecture,
+ * it is faster than any vectorized interpolation.
+ */
+template<typename _impl>
+class KoOptimizedPerChannelAdjustment<quint8, _impl, void> : public KoColorTransformation
+{
+public:
+    KoOptimizedPerChannelAdjustment(const quint16 *const *transferValues)
+        : m_lut(KoPerChannelAdjustmentTable::numChannels * 256)
+    {
+        for (int channel = 0; channel < KoPerChannelAdjustmentTable::numChannels; channel++) {
+            for (int i = 0; i < 256; i++) {
+                const quint16 value = transferValues[channel] ? transferValues[channel][i] : quint16(i * 257);
+                m_lut[channel * 256 + i] = static_cast<quint8>((value * 255 + 32767) / 65535);
+            }
+        }
+    }
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override
+    {
+        const quint8 *lut0 = m_lut.constData();
+        const quint8 *lut1 = lut0 + 256;
+        const quint8 *lut2 = lut1 + 256;
+        const quint8 *lut3 = lut2 + 256;
+
+        for (int i = 0; i < nPixels; i++) {
+            dst[0] = lut0[src[0]];
+            dst[1] = lut1[src[1]];
+            dst[2] = lut2[src[2]];
+            dst[3] = lut3[src[3]];
+
+            src += 4;
+            dst += 4;
+        }
+    }
+
+private:
+    QVector<quint8> m_lut;
+};
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+
+#include "KoStreamedMath.h"
+
+template<typename channels_type, typename _impl>
+class KoOptimizedPerChannelAdjustment<
+        channels_type, _impl,
+        typename std::enable_if<!std::is_same<_impl, xsimd::generic>::value &&
+                                !std::is_same<channels_type, quint8>::value>::type>
+    : public KoOptimizedPerChannelAdjustment<channels_type, xsimd::generic>
+{
+    using base_class = KoOptimizedPerChannelAdjustment<channels_type, xsimd::generic>;
+
+    using int_v = typename KoStreamedMath<_impl>::int_v;
+    using float_v = typename KoStreamedMath<_impl>::float_v;
+
+    static constexpr int numChannels = KoPerChannelAdjustmentTable::numChannels;
+    static constexpr int vectorSize = static_cast<int>(float_v::size);
+
+    static_assert(vectorSize % numChannels == 0,
+                  "the vector should contain a whole number of pixels");
+
+public:
+    KoOptimizedPerChannelAdjustment(const quint16 *const *transferValues)
+        : base_class(transferValues)
+    {
+    }
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override
+    {
+        const channels_type *srcPtr = reinterpret_cast<const channels_type *>(src);
+        channels_type *dstPtr = reinterpret_cast<channels_type *>(dst);
+
+        const int numValues = nPixels * numChannels;
+        const int block = numValues / vectorSize;
+        const int tailPixels = (numValues % vectorSize) / numChannels;
+
+        // every lane of the vector reads the table of its own channel
+        alignas(_impl::alignment()) int offsets[vectorSize];
+        for (int i = 0; i < vectorSize; i++) {
+            offsets[i] = (i % numChannels) * KoPerChannelAdjustmentTable::channelStride;
+        }
+        const int_v channelOffsets = int_v::load_aligned(offsets);
+
+        const float *table = this->m_table.values.constData();
+
+        const float_v zero(0.0f);
+        const float_v one(1.0f);
+        const float_v maxPos(float(KoPerChannelAdjustmentTable::numSamples - 1));
+
+        for (int i = 0; i < block; i++) {
+            float_v value = loadValues(srcPtr);
+            value = xsimd::min(xsimd::max(value, zero), one);
+
+            const float_v pos = value * maxPos;
+            const int_v index = xsimd::to_int(pos);
+            const float_v fraction = pos - xsimd::to_float(index);
+
+            const int_v tableIndex = index + channelOffsets;
+            const float_v sample0 = float_v::gather(table, tableIndex);
+            const float_v sample1 = float_v::gather(table + 1, tableIndex);
+
+            storeValues(dstPtr, sample0 + (sample1 - sample0) * fraction);
+
+            srcPtr += vectorSize;
+            dstPtr += vectorSize;
+        }
+
+        if (tailPixels) {
+            base_class::transform(reinterpret_cast<const quint8 *>(srcPtr),
+                                  reinterpret_cast<quint8 *>(dstPtr),
+                                  tailPixels);
+        }
+    }
+
+private:
+    static inline float_v loadValues(const quint16 *src) {
+        return float_v::load_unaligned(src) * float_v(1.0f / 65535.0f);
+    }
+
+    static inline float_v loadValues(const float *src) {
+        return float_v::load_unaligned(src);
+    }
+
+    static inline void storeValues(quint16 *dst, const float_v &value) {
+        // the value is non-negative, so truncation rounds it
+        (value * float_v(65535.0f) + float_v(0.5f)).store_unaligned(dst);
+    }
+
+    static inline void storeValues(float *dst, const float_v &value) {
+        value.store_unaligned(dst);
+    }
+};
+
+#endif /* defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) */
+
+#endif // KoOptimizedPerChannelAdjustment_H
@@ -0,0 +1,51 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoOptimizedPerChannelAdjustmentFactory.h"
+
+#include <array>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoColorModelStandardIds.h>
+
+#include "KoOptimizedPerChannelAdjustmentFactoryImpl.h"
+
+
+KoColorTransformation *KoOptimizedPerChannelAdjustmentFactory::create(const KoColorSpace *cs, const quint16 *const *transferValues)
+{
+    if (cs->colorModelId() != RGBAColorModelID || cs->channelCount() != 4) {
+        return nullptr;
+    }
+
+    std::array<const quint16*, 4> memoryOrderTransfers;
+
+    Q_FOREACH (const KoChannelInfo *channel, cs->channels()) {
+        const int memoryIndex = channel->pos() / channel->size();
+        if (memoryIndex < 0 || memoryIndex >= 4 ||
+            (channel->channelType() == KoChannelInfo::ALPHA) != (memoryIndex == 3)) {
+
+            return nullptr;
+        }
+
+        memoryOrderTransfers[memoryIndex] = transferValues[channel->displayPosition()];
+    }
+
+    const KoID depthId = cs->colorDepthId();
+
+    if (depthId == Integer8BitsColorDepthID) {
+        return createOptimizedClass<
+                KoOptimizedPerChannelAdjustmentFactoryImpl<quint8>>(memoryOrderTransfers.data());
+    } else if (depthId == Integer16BitsColorDepthID) {
+        return createOptimizedClass<
+                KoOptimizedPerChannelAdjustmentFactoryImpl<quint16>>(memoryOrderTransfers.data());
+    } else if (depthId == Float32BitsColorDepthID) {
+        return createOptimizedClass<
+                KoOptimizedPerChannelAdjustmentFactoryImpl<float>>(memoryOrderTransfers.data());
+    }
+
+    return nullptr;
+}
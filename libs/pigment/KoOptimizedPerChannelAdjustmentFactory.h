@@ -0,0 +1,36 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoOptimizedPerChannelAdjustmentFACTORY_H
+#define KoOptimizedPerChannelAdjustmentFACTORY_H
+
+#include "kritapigment_export.h"
+
+class KoColorSpace;
+class KoColorTransformation;
+
+/**
+ * Creates per-channel adjustments (curves, levels) that process whole rows
+ * of pixels without virtual per-pixel calls, vectorized for the CPU
+ * architecture Krita runs on.
+ *
+ * Only RGBA color spaces with 8-bit, 16-bit or 32-bit float channels are
+ * supported, the color spaces are expected to fall back to their generic
+ * adjustment otherwise.
+ */
+class KRITAPIGMENT_EXPORT KoOptimizedPerChannelAdjustmentFactory
+{
+public:
+    /**
+     * @param transferValues the transfer curves in the format of
+     * KoColorSpace::createPerChannelAdjustment(): one 256-entry curve per
+     * channel in display order, the alpha curve being the last
+     * @return the adjustment or nullptr if \p cs is not supported
+     */
+    static KoColorTransformation* create(const KoColorSpace *cs, const quint16 *const *transferValues);
+};
+
+#endif // KoOptimizedPerChannelAdjustmentFACTORY_H
@@ -0,0 +1,24 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoOptimizedPerChannelAdjustmentFactoryImpl.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+#include "KoOptimizedPerChannelAdjustment.h"
+
+template<typename channels_type>
+template<typename _impl>
+KoColorTransformation *
+KoOptimizedPerChannelAdjustmentFactoryImpl<channels_type>::create(const quint16 *const *transferValues)
+{
+    return new KoOptimizedPerChannelAdjustment<channels_type, _impl>(transferValues);
+}
+
+template KoColorTransformation* KoOptimizedPerChannelAdjustmentFactoryImpl<quint8>::create<xsimd::current_arch>(const quint16 *const *);
+template KoColorTransformation* KoOptimizedPerChannelAdjustmentFactoryImpl<quint16>::create<xsimd::current_arch>(const quint16 *const *);
+template KoColorTransformation* KoOptimizedPerChannelAdjustmentFactoryImpl<float>::create<xsimd::current_arch>(const quint16 *const *);
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoOptimizedPerChannelAdjustmentFACTORYIMPL_H
+#define KoOptimizedPerChannelAdjustmentFACTORYIMPL_H
+
+#include <KoColorTransformation.h>
+#include <KoMultiArchBuildSupport.h>
+
+template<typename channels_type>
+class KRITAPIGMENT_EXPORT KoOptimizedPerChannelAdjustmentFactoryImpl
+{
+public:
+    /**
+     * @param transferValues the transfer curves of the four channels in
+     * the order they are stored in memory, a null curve means identity
+     */
+    template<typename _impl>
+    static KoColorTransformation* create(const quint16 *const *transferValues);
+};
+
+#endif // KoOptimizedPerChannelAdjustmentFACTORYIMPL_H
@@ -0,0 +1,89 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "KoColorConversionCacheBenchmark.h"
+
+#include <thread>
+#include <vector>
+
+#include <simpletest.h>
+#include <QThread>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpace.h>
+
+/**
+ * The number of conversions done by every thread
+ */
+#define NB_CONVERSIONS 200000
+
+/**
+ * Every conversion is short, so that the benchmark
+ * measures the lookup of the transformation mostly
+ */
+#define NB_PIXELS 16
+
+void KoColorConversionCacheBenchmark::benchmarkConversion_data()
+{
+    QTest::addColumn<int>("numThreads");
+    QTest::addColumn<int>("numPairs");
+
+    const int idealThreadCount = QThread::idealThreadCount();
+
+    for (int numPairs : {1, 2, 4, 6}) {
+        for (int numThreads : {1, idealThreadCount}) {
+            QTest::newRow(QString("%1 pairs, %2 threads").arg(numPairs).arg(numThreads).toLatin1().data())
+                << numThreads << numPairs;
+        }
+    }
+}
+
+void KoColorConversionCacheBenchmark::benchmarkConversion()
+{
+    QFETCH(int, numThreads);
+    QFETCH(int, numPairs);
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+
+    const QVector<QPair<const KoColorSpace*, const KoColorSpace*>> allPairs = {
+        {registry->rgb8(), registry->rgb16()},
+        {registry->rgb16(), registry->rgb8()},
+        {registry->rgb8(), registry->lab16()},
+        {registry->lab16(), registry->rgb8()},
+        {registry->rgb16(), registry->lab16()},
+        {registry->lab16(), registry->rgb16()}
+    };
+
+    const QVector<QPair<const KoColorSpace*, const KoColorSpace*>> pairs = allPairs.mid(0, numPairs);
+
+    auto threadFunc = [&pairs] () {
+        std::vector<quint8> src(NB_PIXELS * 8, 0);
+        std::vector<quint8> dst(NB_PIXELS * 8, 0);
+
+        for (int i = 0; i < NB_CONVERSIONS; i++) {
+            const auto &pair = pairs[i % pairs.size()];
+            pair.first->convertPixelsTo(src.data(), dst.data(), pair.second, NB_PIXELS,
+                                        KoColorConversionTransformation::internalRenderingIntent(),
+                                        KoColorConversionTransformation::internalConversionFlags());
+        }
+    };
+
+    // warm up the cache
+    threadFunc();
+
+    QBENCHMARK_ONCE {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; i++) {
+            threads.emplace_back(threadFunc);
+        }
+
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KoColorConversionCacheBenchmark)
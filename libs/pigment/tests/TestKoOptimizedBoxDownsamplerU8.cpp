@@ -0,0 +1,86 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "TestKoOptimizedBoxDownsamplerU8.h"
+
+#include <QRandomGenerator>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <simpletest.h>
+
+#include "KoOptimizedBoxDownsamplerU8Factory.h"
+#include "KoOptimizedBoxDownsamplerU8FactoryImpl.h"
+
+void TestKoOptimizedBoxDownsamplerU8::testUniform()
+{
+    QScopedPointer<KoOptimizedBoxDownsamplerU8Base> downsampler(
+        KoOptimizedBoxDownsamplerU8Factory::createRgbaDownsampler());
+
+    const int numDstPixels = 37;
+
+    QVector<quint8> row0(2 * numDstPixels * 4);
+    QVector<quint8> row1(2 * numDstPixels * 4);
+
+    for (int i = 0; i < row0.size(); i += 4) {
+        row0[i] = 10; row0[i + 1] = 20; row0[i + 2] = 30; row0[i + 3] = 255;
+        row1[i] = 13; row1[i + 1] = 20; row1[i + 2] = 31; row1[i + 3] = 255;
+    }
+
+    QVector<quint8> dst(numDstPixels * 4);
+    downsampler->downsampleRows(row0.constData(), row1.constData(), dst.data(), numDstPixels);
+
+    for (int i = 0; i < dst.size(); i += 4) {
+        // the averages are truncated
+        QCOMPARE(int(dst[i]), 11);
+        QCOMPARE(int(dst[i + 1]), 20);
+        QCOMPARE(int(dst[i + 2]), 30);
+        QCOMPARE(int(dst[i + 3]), 255);
+    }
+}
+
+void TestKoOptimizedBoxDownsamplerU8::testOptimizedMatchesScalar_data()
+{
+    QTest::addColumn<int>("numDstPixels");
+
+    // covers all the combinations of the vector and scalar blocks
+    for (int i = 1; i <= 33; i++) {
+        QTest::addRow("%d", i) << i;
+    }
+    QTest::addRow("%d", 1027) << 1027;
+}
+
+void TestKoOptimizedBoxDownsamplerU8::testOptimizedMatchesScalar()
+{
+    QFETCH(int, numDstPixels);
+
+    QScopedPointer<KoOptimizedBoxDownsamplerU8Base> optimized(
+        KoOptimizedBoxDownsamplerU8Factory::createRgbaDownsampler());
+    QScopedPointer<KoOptimizedBoxDownsamplerU8Base> scalar(
+        createScalarClass<KoOptimizedBoxDownsamplerU8FactoryImpl>());
+
+    QRandomGenerator random(numDstPixels);
+
+    QVector<quint8> row0(2 * numDstPixels * 4);
+    QVector<quint8> row1(2 * numDstPixels * 4);
+
+    for (int i = 0; i < row0.size(); i++) {
+        row0[i] = quint8(random.bounded(256));
+        row1[i] = quint8(random.bounded(256));
+    }
+
+    // one more pixel to check that nothing is written past the end
+    QVector<quint8> optimizedDst((numDstPixels + 1) * 4, 7);
+    QVector<quint8> scalarDst((numDstPixels + 1) * 4, 7);
+
+    optimized->downsampleRows(row0.constData(), row1.constData(), optimizedDst.data(), numDstPixels);
+    scalar->downsampleRows(row0.constData(), row1.constData(), scalarDst.data(), numDstPixels);
+
+    QCOMPARE(optimizedDst, scalarDst);
+    QCOMPARE(int(optimizedDst.last()), 7);
+}
+
+QTEST_GUILESS_MAIN(TestKoOptimizedBoxDownsamplerU8)
@@ -0,0 +1,22 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TESTKOOPTIMIZEDBOXDOWNSAMPLERU8_H
+#define TESTKOOPTIMIZEDBOXDOWNSAMPLERU8_H
+
+#include <QObject>
+
+class TestKoOptimizedBoxDownsamplerU8 : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testUniform();
+    void testOptimizedMatchesScalar_data();
+    void testOptimizedMatchesScalar();
+};
+
+#endif // TESTKOOPTIMIZEDBOXDOWNSAMPLERU8_H
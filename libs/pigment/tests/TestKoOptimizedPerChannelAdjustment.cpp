@@ -0,0 +1,192 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "TestKoOptimizedPerChannelAdjustment.h"
+
+#include <QRandomGenerator>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <simpletest.h>
+
+#include "KoOptimizedPerChannelAdjustmentFactoryImpl.h"
+
+namespace {
+
+QVector<quint16> invertedCurve()
+{
+    QVector<quint16> curve(256);
+    for (int i = 0; i < 256; i++) {
+        curve[i] = quint16((255 - i) * 257);
+    }
+    return curve;
+}
+
+QVector<quint16> randomCurve(QRandomGenerator &random)
+{
+    QVector<quint16> curve(256);
+    for (int i = 0; i < 256; i++) {
+        curve[i] = quint16(random.bounded(65536));
+    }
+    return curve;
+}
+
+}
+
+void TestKoOptimizedPerChannelAdjustment::testIdentity()
+{
+    const quint16 *transfers[4] = {nullptr, nullptr, nullptr, nullptr};
+
+    const int numPixels = 67;
+
+    {
+        QScopedPointer<KoColorTransformation> adj(
+            createOptimizedClass<KoOptimizedPerChannelAdjustmentFactoryImpl<quint8>>(transfers));
+
+        QVector<quint8> src(numPixels * 4);
+        for (int i = 0; i < src.size(); i++) {
+            src[i] = quint8(i);
+        }
+
+        QVector<quint8> dst(src.size());
+        adj->transform(src.constData(), dst.data(), numPixels);
+        QCOMPARE(dst, src);
+    }
+
+    {
+        QScopedPointer<KoColorTransformation> adj(
+            createOptimizedClass<KoOptimizedPerChannelAdjustmentFactoryImpl<quint16>>(transfers));
+
+        QVector<quint16> src(numPixels * 4);
+        for (int i = 0; i < src.size(); i++) {
+            // the samples of the curve are reproduced exactly
+            src[i] = quint16((i % 256) * 257);
+        }
+
+        QVector<quint16> dst(src.size());
+        adj->transform(reinterpret_cast<const quint8*>(src.constData()),
+                       reinterpret_cast<quint8*>(dst.data()), numPixels);
+        QCOMPARE(dst, src);
+    }
+}
+
+void TestKoOptimizedPerChannelAdjustment::testInvert()
+{
+    const QVector<quint16> inverted = invertedCurve();
+
+    // the alpha channel is not touched
+    const quint16 *transfers[4] = {inverted.constData(), inverted.constData(), inverted.constData(), nullptr};
+
+    const int numPixels = 33;
+
+    QScopedPointer<KoColorTransformation> adj(
+        createOptimizedClass<KoOptimizedPerChannelAdjustmentFactoryImpl<float>>(transfers));
+
+    QVector<float> src(numPixels * 4);
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = (i % 256) / 255.0f;
+    }
+
+    QVector<float> dst(src.size());
+    adj->transform(reinterpret_cast<const quint8*>(src.constData()),
+                   reinterpret_cast<quint8*>(dst.data()), numPixels);
+
+    for (int i = 0; i < src.size(); i++) {
+        const float expected = i % 4 == 3 ? src[i] : 1.0f - src[i];
+        QVERIFY2(qAbs(dst[i] - expected) < 1e-5f, QString("%1: %2 != %3").arg(i).arg(dst[i]).arg(expected).toLatin1());
+    }
+}
+
+void TestKoOptimizedPerChannelAdjustment::testFloatClamping()
+{
+    const QVector<quint16> inverted = invertedCurve();
+    const quint16 *transfers[4] = {inverted.constData(), inverted.constData(), inverted.constData(), inverted.constData()};
+
+    QScopedPointer<KoColorTransformation> adj(
+        createOptimizedClass<KoOptimizedPerChannelAdjustmentFactoryImpl<float>>(transfers));
+
+    const int numPixels = 16;
+
+    QVector<float> src(numPixels * 4);
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = i % 2 ? -3.0f : 5.0f;
+    }
+
+    QVector<float> dst(src.size());
+    adj->transform(reinterpret_cast<const quint8*>(src.constData()),
+                   reinterpret_cast<quint8*>(dst.data()), numPixels);
+
+    for (int i = 0; i < src.size(); i++) {
+        QCOMPARE(dst[i], i % 2 ? 1.0f : 0.0f);
+    }
+}
+
+void TestKoOptimizedPerChannelAdjustment::testOptimizedMatchesScalar_data()
+{
+    QTest::addColumn<bool>("isFloat");
+    QTest::addColumn<int>("numPixels");
+
+    // covers all the combinations of the vector and scalar blocks
+    for (int i = 1; i <= 17; i++) {
+        QTest::addRow("u16-%d", i) << false << i;
+        QTest::addRow("f32-%d", i) << true << i;
+    }
+    QTest::addRow("u16-%d", 1027) << false << 1027;
+    QTest::addRow("f32-%d", 1027) << true << 1027;
+}
+
+template<typename channels_type>
+void compareWithScalar(int numPixels, channels_type maxValue, channels_type tolerance)
+{
+    QRandomGenerator random(numPixels);
+
+    QVector<QVector<quint16>> curves;
+    for (int i = 0; i < 4; i++) {
+        curves << randomCurve(random);
+    }
+    const quint16 *transfers[4] = {curves[0].constData(), curves[1].constData(), nullptr, curves[3].constData()};
+
+    QScopedPointer<KoColorTransformation> optimized(
+        createOptimizedClass<KoOptimizedPerChannelAdjustmentFactoryImpl<channels_type>>(transfers));
+    QScopedPointer<KoColorTransformation> scalar(
+        createScalarClass<KoOptimizedPerChannelAdjustmentFactoryImpl<channels_type>>(transfers));
+
+    QVector<channels_type> src(numPixels * 4);
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = channels_type(random.bounded(1.0) * maxValue);
+    }
+
+    // one more pixel to check that nothing is written past the end
+    QVector<channels_type> optimizedDst((numPixels + 1) * 4, channels_type(7));
+    QVector<channels_type> scalarDst((numPixels + 1) * 4, channels_type(7));
+
+    optimized->transform(reinterpret_cast<const quint8*>(src.constData()),
+                         reinterpret_cast<quint8*>(optimizedDst.data()), numPixels);
+    scalar->transform(reinterpret_cast<const quint8*>(src.constData()),
+                      reinterpret_cast<quint8*>(scalarDst.data()), numPixels);
+
+    for (int i = 0; i < optimizedDst.size(); i++) {
+        const channels_type diff = qMax(optimizedDst[i], scalarDst[i]) - qMin(optimizedDst[i], scalarDst[i]);
+        QVERIFY2(diff <= tolerance, QString("%1: %2 != %3").arg(i).arg(optimizedDst[i]).arg(scalarDst[i]).toLatin1());
+    }
+
+    QCOMPARE(optimizedDst.last(), channels_type(7));
+}
+
+void TestKoOptimizedPerChannelAdjustment::testOptimizedMatchesScalar()
+{
+    QFETCH(bool, isFloat);
+    QFETCH(int, numPixels);
+
+    if (isFloat) {
+        compareWithScalar<float>(numPixels, 1.0f, 1e-5f);
+    } else {
+        // the vector code may use FMA, so the rounding may differ
+        compareWithScalar<quint16>(numPixels, 65535, 1);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestKoOptimizedPerChannelAdjustment)
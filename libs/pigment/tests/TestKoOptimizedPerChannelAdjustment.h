@@ -0,0 +1,24 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TESTKOOPTIMIZEDPERCHANNELADJUSTMENT_H
+#define TESTKOOPTIMIZEDPERCHANNELADJUSTMENT_H
+
+#include <QObject>
+
+class TestKoOptimizedPerChannelAdjustment : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testIdentity();
+    void testInvert();
+    void testFloatClamping();
+    void testOptimizedMatchesScalar_data();
+    void testOptimizedMatchesScalar();
+};
+
+#endif // TESTKOOPTIMIZEDPERCHANNELADJUSTMENT_H
@@ -9,6 +9,7 @@
 
 #include <QIODevice>
 #include <QMap>
+#include <QtConcurrentMap>
 #include <QtEndian>
 #include <QtGlobal>
 
@@ -16,6 +17,7 @@
 #include <KoColorSpaceMaths.h>
 #include <KoColorSpaceTraits.h>
 #include <colorspaces/KoAlphaColorSpace.h>
+#include <kis_algebra_2d.h>
 #include <kis_global.h>
 #include <kis_iterator_ng.h>
 
@@ -148,6 +150,11 @@ void readAlphaMaskPixel(const QMap<quint16, QByteArray> &channelBytes, int col,
 {
     using channels_type = typename Traits::channels_type;
 
+    if (channelBytes.isEmpty() || (col + 1) * int(sizeof(channels_type)) > channelBytes.first().size()) {
+        // the row has failed to decode, keep the default pixel
+        return;
+    }
+
     const channels_type data = reinterpret_cast<const channels_type *>(channelBytes.first().constData())[col];
     if (byteOrder == psd_byte_order::psdBigEndian) {
         *dstPtr = truncateToOpacity<Traits>(convertByteOrder<Traits>(data));
@@ -298,40 +305,216 @@ void readAlphaMaskPixelCommon(int channelSize, const QMap<quint16, QByteArray> &
     }
 }
 
-QMap<quint16, QByteArray> fetchChannelsBytes(QIODevice &io, QVector<ChannelInfo *> channelInfoRecords, int row, int width, int channelSize, bool processMasks)
+using PixelFunc = std::function<void(int, const QMap<quint16, QByteArray> &, int, quint8 *)>;
+
+/**
+ * The layers are decoded in horizontal bands aligned to the tiles of the
+ * destination device, so the bands can be decoded and written into the
+ * device in parallel without touching the same tiles.
+ */
+const int DecodingBandHeight = 64;
+
+/**
+ * The data of a single channel read from the file. For the row-wise
+ * compressions (RLE and no compression) it is the raw data of the file,
+ * which is decoded by the band jobs. ZIP streams cannot be split, so the
+ * ZIP channels are inflated as a whole beforehand.
+ */
+struct ChannelData {
+    quint16 channelId = 0;
+    psd_compression_type compressionType = psd_compression_type::Uncompressed;
+    QByteArray bytes;
+
+    /// the offsets of the rows in bytes, has height + 1 entries
+    QVector<int> rowOffsets;
+};
+
+QVector<QRect> splitIntoBands(KisPaintDeviceSP dev, const QRect &rc)
+{
+    QVector<QRect> bands;
+
+    int y = rc.top();
+    while (y <= rc.bottom()) {
+        const int bandIndex = KisAlgebra2D::divideFloor(y - dev->y(), DecodingBandHeight);
+        const int nextBandTop = (bandIndex + 1) * DecodingBandHeight + dev->y();
+        const int bottom = qMin(nextBandTop, rc.bottom() + 1);
+
+        bands << QRect(rc.left(), y, rc.width(), bottom - y);
+        y = bottom;
+    }
+
+    return bands;
+}
+
+QVector<ChannelData> fetchChannelsData(QIODevice &io, QVector<ChannelInfo *> channelInfoRecords, int height, int width, int channelSize, bool processMasks)
 {
     const int uncompressedLength = width * channelSize;
 
-    QMap<quint16, QByteArray> channelBytes;
+    QVector<ChannelData> channels;
 
     Q_FOREACH (ChannelInfo *channelInfo, channelInfoRecords) {
         // user supplied masks are ignored here
         if (!processMasks && channelInfo->channelId < -1)
             continue;
 
-        io.seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+        ChannelData channel;
+        channel.channelId = channelInfo->channelId;
+        channel.compressionType = channelInfo->compressionType;
+        channel.rowOffsets.reserve(height + 1);
+
+        int offset = 0;
 
         if (channelInfo->compressionType == psd_compression_type::Uncompressed) {
-            channelBytes[channelInfo->channelId] = io.read(uncompressedLength);
-            channelInfo->channelOffset += uncompressedLength;
+            for (int row = 0; row < height; row++) {
+                channel.rowOffsets << offset;
+                offset += uncompressedLength;
+            }
         } else if (channelInfo->compressionType == psd_compression_type::RLE) {
-            int rleLength = channelInfo->rleRowLengths[row];
-            QByteArray compressedBytes = io.read(rleLength);
-            QByteArray uncompressedBytes = Compression::uncompress(uncompressedLength, compressedBytes, channelInfo->compressionType);
-            channelBytes.insert(channelInfo->channelId, uncompressedBytes);
-            channelInfo->channelOffset += rleLength;
+            for (int row = 0; row < height; row++) {
+                channel.rowOffsets << offset;
+                offset += channelInfo->rleRowLengths.value(row);
+            }
         } else {
             QString error = QString("Unsupported Compression mode: %1")
                                 .arg(static_cast<std::uint16_t>(channelInfo->compressionType));
-            dbgFile << "ERROR: fetchChannelsBytes:" << error;
+            dbgFile << "ERROR: fetchChannelsData:" << error;
             throw KisAslReaderUtils::ASLParseException(error);
         }
+
+        channel.rowOffsets << offset;
+
+        io.seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+        channel.bytes = io.read(offset);
+        channelInfo->channelOffset += offset;
+
+        channels << channel;
     }
 
-    return channelBytes;
+    return channels;
 }
 
-using PixelFunc = std::function<void(int, const QMap<quint16, QByteArray> &, int, quint8 *)>;
+QVector<ChannelData> fetchZipChannelsData(QIODevice &io, QVector<ChannelInfo *> infoRecords, const QRect &layerRect, int channelSize)
+{
+    const int numPixels = channelSize * layerRect.width() * layerRect.height();
+    const int rowLength = channelSize * layerRect.width();
+    const psd_compression_type compressionType = infoRecords.first()->compressionType;
+
+    QVector<ChannelData> channels;
+    QVector<QByteArray> compressedBytes;
+
+    Q_FOREACH (ChannelInfo *info, infoRecords) {
+        io.seek(info->channelDataStart);
+        compressedBytes << io.read(info->channelDataLength);
+
+        ChannelData channel;
+        channel.channelId = info->channelId;
+        channel.compressionType = compressionType;
+        for (int row = 0; row <= layerRect.height(); row++) {
+            channel.rowOffsets << row * rowLength;
+        }
+        channels << channel;
+    }
+
+    QVector<int> jobs;
+    for (int i = 0; i < channels.size(); i++) {
+        jobs << i;
+    }
+
+    QVector<bool> succeeded(channels.size(), false);
+
+    // access the elements via raw pointers to avoid detaching the vectors in the jobs
+    ChannelData *channelsPtr = channels.data();
+    QByteArray *compressedBytesPtr = compressedBytes.data();
+    bool *succeededPtr = succeeded.data();
+
+    QtConcurrent::blockingMap(jobs,
+        [&] (int i) {
+            QByteArray uncompressedBytes(numPixels, '\0');
+
+            succeededPtr[i] = Compression::uncompress(compressedBytesPtr[i].constData(),
+                                                      compressedBytesPtr[i].size(),
+                                                      uncompressedBytes.data(),
+                                                      numPixels,
+                                                      compressionType,
+                                                      layerRect.width(),
+                                                      channelSize * 8);
+
+            compressedBytesPtr[i].clear();
+            channelsPtr[i].bytes = uncompressedBytes;
+        });
+
+    for (int i = 0; i < channels.size(); i++) {
+        if (!succeeded[i]) {
+            ChannelInfo *info = infoRecords[i];
+
+            QString error = QString("Failed to unzip channel data: id = %1, compression = %2")
+                                .arg(info->channelId)
+                                .arg(static_cast<std::uint16_t>(info->compressionType));
+            dbgFile << "ERROR:" << error;
+            dbgFile << "      " << ppVar(info->channelId);
+            dbgFile << "      " << ppVar(info->channelDataStart);
+            dbgFile << "      " << ppVar(info->channelDataLength);
+            dbgFile << "      " << ppVar(info->compressionType);
+            throw KisAslReaderUtils::ASLParseException(error);
+        }
+    }
+
+    return channels;
+}
+
+void readBand(KisPaintDeviceSP dev,
+              const QRect &layerRect,
+              const QRect &bandRect,
+              const QVector<ChannelData> &channels,
+              int channelSize,
+              PixelFunc pixelFunc)
+{
+    const int rowLength = layerRect.width() * channelSize;
+
+    // the decoded rows of all the channels of the band
+    QByteArray buffer(channels.size() * bandRect.height() * rowLength, '\0');
+
+    KisHLineIteratorSP it = dev->createHLineIteratorNG(bandRect.left(), bandRect.top(), bandRect.width());
+
+    for (int i = 0; i < bandRect.height(); i++) {
+        const int row = bandRect.top() - layerRect.top() + i;
+
+        QMap<quint16, QByteArray> channelBytes;
+
+        for (int c = 0; c < channels.size(); c++) {
+            const ChannelData &channel = channels[c];
+
+            const int offset = channel.rowOffsets[row];
+            const int length = channel.rowOffsets[row + 1] - offset;
+
+            if (offset + length > channel.bytes.size()) {
+                // the file is truncated, keep the default values
+                continue;
+            }
+
+            if (channel.compressionType == psd_compression_type::RLE) {
+                char *dst = buffer.data() + (c * bandRect.height() + i) * rowLength;
+
+                if (Compression::uncompress(channel.bytes.constData() + offset, length, dst, rowLength, channel.compressionType)) {
+                    channelBytes.insert(channel.channelId, QByteArray::fromRawData(dst, rowLength));
+                }
+            } else {
+                channelBytes.insert(channel.channelId, QByteArray::fromRawData(channel.bytes.constData() + offset, qMin(length, rowLength)));
+            }
+        }
+
+        for (int col = 0; col < layerRect.width(); col++) {
+            pixelFunc(channelSize, channelBytes, col, it->rawData());
+            it->nextPixel();
+        }
+
+        /// don't write-access the row right after the
+        /// the end of the band, it belongs to the other job
+        if (i < bandRect.height() - 1) {
+            it->nextRow();
+        }
+    }
+}
 
 void readCommon(KisPaintDeviceSP dev,
                 QIODevice &io,
@@ -348,59 +531,25 @@ void readCommon(KisPaintDeviceSP dev,
         return;
     }
 
-    if (infoRecords.first()->compressionType == psd_compression_type::ZIP || infoRecords.first()->compressionType == psd_compression_type::ZIPWithPrediction) {
-        const int numPixels = channelSize * layerRect.width() * layerRect.height();
-
-        QMap<quint16, QByteArray> channelBytes;
-
-        Q_FOREACH (ChannelInfo *info, infoRecords) {
-            io.seek(info->channelDataStart);
-            QByteArray compressedBytes = io.read(info->channelDataLength);
-            QByteArray uncompressedBytes;
-
-            uncompressedBytes = Compression::uncompress(numPixels, compressedBytes, infoRecords.first()->compressionType, layerRect.width(), channelSize * 8);
-
-            if (uncompressedBytes.size() != numPixels) {
-                QString error = QString("Failed to unzip channel data: id = %1, compression = %2")
-                                    .arg(info->channelId)
-                                    .arg(static_cast<std::uint16_t>(info->compressionType));
-                dbgFile << "ERROR:" << error;
-                dbgFile << "      " << ppVar(info->channelId);
-                dbgFile << "      " << ppVar(info->channelDataStart);
-                dbgFile << "      " << ppVar(info->channelDataLength);
-                dbgFile << "      " << ppVar(info->compressionType);
-                throw KisAslReaderUtils::ASLParseException(error);
-            }
-
-            channelBytes.insert(info->channelId, uncompressedBytes);
-        }
-
-        KisSequentialIterator it(dev, layerRect);
-        int col = 0;
-        while (it.nextPixel()) {
-            pixelFunc(channelSize, channelBytes, col, it.rawData());
-            col++;
-        }
+    /**
+     * Reading the file is sequential, so the compressed data of the
+     * whole layer is read first, and only then it is decoded and
+     * converted into the device pixels in parallel.
+     */
+    QVector<ChannelData> channels;
 
+    if (infoRecords.first()->compressionType == psd_compression_type::ZIP || infoRecords.first()->compressionType == psd_compression_type::ZIPWithPrediction) {
+        channels = fetchZipChannelsData(io, infoRecords, layerRect, channelSize);
     } else {
-        KisHLineIteratorSP it = dev->createHLineIteratorNG(layerRect.left(), layerRect.top(), layerRect.width());
-        for (int i = 0; i < layerRect.height(); i++) {
-            QMap<quint16, QByteArray> channelBytes;
-
-            channelBytes = fetchChannelsBytes(io, infoRecords, i, layerRect.width(), channelSize, processMasks);
+        channels = fetchChannelsData(io, infoRecords, layerRect.height(), layerRect.width(), channelSize, processMasks);
+    }
 
-            for (int col = 0; col < layerRect.width(); col++) {
-                pixelFunc(channelSize, channelBytes, col, it->rawData());
-                it->nextPixel();
-            }
+    QVector<QRect> bands = splitIntoBands(dev, layerRect);
 
-            /// don't write-access the row right after the
-            /// the end of the read area
-            if (i < layerRect.height() - 1) {
-                it->nextRow();
-            }
-        }
-    }
+    QtConcurrent::blockingMap(bands,
+        [&] (const QRect &bandRect) {
+            readBand(dev, layerRect, bandRect, channels, channelSize, pixelFunc);
+        });
 }
 
 template<psd_byte_order byteOrder>
@@ -474,13 +623,12 @@ void readAlphaMaskChannels(QIODevice &io,
 }
 
 template<psd_byte_order byteOrder = psd_byte_order::psdBigEndian>
-void writeChannelDataRLEImpl(QIODevice &io,
-                             const quint8 *plane,
-                             const int channelSize,
-                             const QRect &rc,
-                             const qint64 sizeFieldOffset,
-                             const qint64 rleBlockOffset,
-                             const bool writeCompressionType)
+void writeCompressedChannelDataRLEImpl(QIODevice &io,
+                                       const QVector<QByteArray> &compressedRows,
+                                       const QRect &rc,
+                                       const qint64 sizeFieldOffset,
+                                       const qint64 rleBlockOffset,
+                                       const bool writeCompressionType)
 {
     using Pusher = KisAslWriterUtils::OffsetStreamPusher<quint32, byteOrder>;
     QScopedPointer<Pusher> channelBlockSizeExternalTag;
@@ -513,10 +661,8 @@ void writeChannelDataRLEImpl(QIODevice &io,
         }
     }
 
-    const int stride = channelSize * rc.width();
     for (qint32 row = 0; row < rc.height(); ++row) {
-        QByteArray uncompressed = QByteArray::fromRawData((const char *)plane + row * stride, stride);
-        QByteArray compressed = Compression::compress(uncompressed, psd_compression_type::RLE);
+        const QByteArray &compressed = compressedRows[row];
 
         KisAslWriterUtils::OffsetStreamPusher<quint16, byteOrder> rleExternalTag(io, 0, channelRLESizePos + row * static_cast<qint64>(sizeof(quint16)));
 
@@ -526,13 +672,35 @@ void writeChannelDataRLEImpl(QIODevice &io,
     }
 }
 
+void compressRowsRLE(const quint8 *plane, const int channelSize, const QRect &rc, int firstRow, int numRows, QByteArray *compressedRows)
+{
+    const int stride = channelSize * rc.width();
+    for (qint32 row = firstRow; row < firstRow + numRows; ++row) {
+        QByteArray uncompressed = QByteArray::fromRawData((const char *)plane + row * stride, stride);
+        compressedRows[row] = Compression::compress(uncompressed, psd_compression_type::RLE);
+    }
+}
+
 template<psd_byte_order byteOrder = psd_byte_order::psdBigEndian>
-void writeChannelDataZIPImpl(QIODevice &io,
+void writeChannelDataRLEImpl(QIODevice &io,
                              const quint8 *plane,
                              const int channelSize,
                              const QRect &rc,
                              const qint64 sizeFieldOffset,
+                             const qint64 rleBlockOffset,
                              const bool writeCompressionType)
+{
+    QVector<QByteArray> compressedRows(rc.height());
+    compressRowsRLE(plane, channelSize, rc, 0, rc.height(), compressedRows.data());
+
+    writeCompressedChannelDataRLEImpl<byteOrder>(io, compressedRows, rc, sizeFieldOffset, rleBlockOffset, writeCompressionType);
+}
+
+template<psd_byte_order byteOrder = psd_byte_order::psdBigEndian>
+void writeCompressedChannelDataZIPImpl(QIODevice &io,
+                                       const QByteArray &compressed,
+                                       const qint64 sizeFieldOffset,
+                                       const bool writeCompressionType)
 {
     using Pusher = KisAslWriterUtils::OffsetStreamPusher<quint32, byteOrder>;
     QScopedPointer<Pusher> channelBlockSizeExternalTag;
@@ -544,9 +712,6 @@ void writeChannelDataZIPImpl(QIODevice &io,
         SAFE_WRITE_EX(byteOrder, io, static_cast<quint16>(psd_compression_type::ZIP));
     }
 
-    QByteArray uncompressed(reinterpret_cast<const char *>(plane), rc.width() * rc.height() * channelSize);
-    QByteArray compressed(Compression::compress(uncompressed, psd_compression_type::ZIP));
-
     if (compressed.size() == 0 || io.write(compressed) != compressed.size()) {
         throw KisAslWriterUtils::ASLWriteException("Failed to write image data");
     }
@@ -663,6 +828,66 @@ void writePixelDataCommonImpl(QIODevice &io,
     KIS_ASSERT_RECOVER_RETURN(planes.size() >= writingInfoList.size());
 
     const int numPixels = rc.width() * rc.height();
+    const bool isZip = compressionType == psd_compression_type::ZIP || compressionType == psd_compression_type::ZIPWithPrediction;
+
+    /**
+     * Compress the planes in parallel. RLE compresses every row separately,
+     * so the channels are split into bands of rows, while ZIP compresses the
+     * whole channel in a single stream. The compressed data is written into
+     * the file in the channel order afterwards.
+     */
+    struct EncodingJob {
+        int channel;
+        int firstRow;
+        int numRows;
+    };
+
+    QVector<EncodingJob> jobs;
+    QVector<QVector<QByteArray>> compressedRows(writingInfoList.size());
+    QVector<QByteArray> compressedChannels(writingInfoList.size());
+
+    for (int i = 0; i < writingInfoList.size(); i++) {
+        if (isZip) {
+            jobs.append({i, 0, rc.height()});
+        } else {
+            compressedRows[i].resize(rc.height());
+
+            const int rowsPerJob = 64;
+            for (int row = 0; row < rc.height(); row += rowsPerJob) {
+                jobs.append({i, row, qMin(rowsPerJob, rc.height() - row)});
+            }
+        }
+    }
+
+    // access the elements via raw pointers to avoid detaching the vectors in the jobs
+    QVector<QByteArray *> compressedRowsPtrs;
+    for (int i = 0; i < compressedRows.size(); i++) {
+        compressedRowsPtrs << compressedRows[i].data();
+    }
+    QByteArray *const *compressedRowsPtr = compressedRowsPtrs.constData();
+    QByteArray *compressedChannelsPtr = compressedChannels.data();
+    quint8 *const *planesPtr = planes.constData();
+    const ChannelWritingInfo *writingInfoPtr = writingInfoList.constData();
+
+    QtConcurrent::blockingMap(jobs,
+        [&] (const EncodingJob &job) {
+            const int rowPixels = rc.width();
+            quint8 *plane = planesPtr[job.channel];
+
+            // WARNING: Pixel data is ALWAYS in big endian!!!
+            preparePixelForWrite<psd_byte_order::psdBigEndian>(plane + job.firstRow * rowPixels * channelSize,
+                                                               job.numRows * rowPixels,
+                                                               channelSize,
+                                                               writingInfoPtr[job.channel].channelId,
+                                                               colorMode);
+
+            if (isZip) {
+                QByteArray uncompressed = QByteArray::fromRawData(reinterpret_cast<const char *>(plane), numPixels * channelSize);
+                compressedChannelsPtr[job.channel] = Compression::compress(uncompressed, psd_compression_type::ZIP);
+            } else {
+                compressRowsRLE(plane, channelSize, rc, job.firstRow, job.numRows, compressedRowsPtr[job.channel]);
+            }
+        });
 
     // write down the planes
 
@@ -671,23 +896,12 @@ void writePixelDataCommonImpl(QIODevice &io,
             const ChannelWritingInfo &info = writingInfoList[i];
 
             dbgFile << "\tWriting channel" << i << "psd channel id" << info.channelId;
-
-            // WARNING: Pixel data is ALWAYS in big endian!!!
-            preparePixelForWrite<psd_byte_order::psdBigEndian>(planes[i], numPixels, channelSize, info.channelId, colorMode);
-
             dbgFile << "\t\tchannel start" << ppVar(io.pos()) << ", compression type" << compressionType;
 
-            switch (compressionType) {
-            case psd_compression_type::ZIP:
-            case psd_compression_type::ZIPWithPrediction: {
-                writeChannelDataZIPImpl<byteOrder>(io, planes[i], channelSize, rc, info.sizeFieldOffset, writeCompressionType);
-                break;
-            }
-            case psd_compression_type::RLE:
-            default: {
-                writeChannelDataRLEImpl<byteOrder>(io, planes[i], channelSize, rc, info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
-                break;
-            }
+            if (isZip) {
+                writeCompressedChannelDataZIPImpl<byteOrder>(io, compressedChannels[i], info.sizeFieldOffset, writeCompressionType);
+            } else {
+                writeCompressedChannelDataRLEImpl<byteOrder>(io, compressedRows[i], rc, info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
             }
         }
 
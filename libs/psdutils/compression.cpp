@@ -84,41 +84,40 @@ QByteArray compress(const QByteArray &data)
         return output;
 }
 
-QByteArray decompress(const QByteArray &input, int unpacked_len)
+bool decompress(const char *input, int packed_len, char *output, int unpacked_len)
 {
-    QByteArray output;
-    output.resize(unpacked_len);
+    const char *src = input;
+    const char *const srcEnd = input + packed_len;
+    char *dst = output;
+    char *const dstEnd = output + unpacked_len;
 
-    const auto *src = input.cbegin();
-    auto *dst = output.begin();
-
-    while (src < input.end() && dst < output.end()) {
+    while (src < srcEnd && dst < dstEnd) {
         // NOLINTNEXTLINE(*-reinterpret-cast,readability-identifier-length)
         const int8_t n = *reinterpret_cast<const int8_t *>(src);
         src += 1;
 
         if (n >= 0) { // copy next n+1 chars
             const int bytes = 1 + n;
-            if (src + bytes > input.cend()) {
-                errFile << "Input buffer exhausted in replicate of" << bytes << "chars, left" << (input.cend() - src);
-                return {};
+            if (src + bytes > srcEnd) {
+                errFile << "Input buffer exhausted in replicate of" << bytes << "chars, left" << (srcEnd - src);
+                return false;
             }
-            if (dst + bytes > output.end()) {
-                errFile << "Overrun in packbits replicate of" << bytes << "chars, left" << (output.end() - dst);
-                return {};
+            if (dst + bytes > dstEnd) {
+                errFile << "Overrun in packbits replicate of" << bytes << "chars, left" << (dstEnd - dst);
+                return false;
             }
             std::copy_n(src, bytes, dst);
             src += bytes;
             dst += bytes;
         } else if (n >= -127 && n <= -1) { // replicate next char -n+1 times
             const int bytes = 1 - n;
-            if (src >= input.cend()) {
+            if (src >= srcEnd) {
                 errFile << "Input buffer exhausted in copy";
-                return {};
+                return false;
             }
-            if (dst + bytes > output.end()) {
-                errFile << "Output buffer exhausted in copy of" << bytes << "chars, left" << (output.end() - dst);
-                return {};
+            if (dst + bytes > dstEnd) {
+                errFile << "Output buffer exhausted in copy of" << bytes << "chars, left" << (dstEnd - dst);
+                return false;
             }
             const auto byte = *src;
             std::fill_n(dst, bytes, byte);
@@ -129,19 +128,29 @@ QByteArray decompress(const QByteArray &input, int unpacked_len)
         }
     }
 
-    if (dst < output.end()) {
-        errFile << "Packbits decode - unpack left" << (output.end() - dst);
-        std::fill(dst, output.end(), 0);
+    if (dst < dstEnd) {
+        errFile << "Packbits decode - unpack left" << (dstEnd - dst);
+        std::fill(dst, dstEnd, 0);
     }
 
     // If the input line was odd width, there's a padding byte
-    if (src + 1 < input.cend()) {
-        QByteArray leftovers;
-        leftovers.resize(static_cast<int>(input.cend() - src));
-        std::copy(src, input.cend(), leftovers.begin());
+    if (src + 1 < srcEnd) {
+        const QByteArray leftovers(src, static_cast<int>(srcEnd - src));
         errFile << "Packbits decode - pack left" << leftovers.size() << leftovers.toHex();
     }
 
+    return true;
+}
+
+QByteArray decompress(const QByteArray &input, int unpacked_len)
+{
+    QByteArray output;
+    output.resize(unpacked_len);
+
+    if (!decompress(input.constData(), input.size(), output.data(), unpacked_len)) {
+        return {};
+    }
+
     return output;
 }
 } // namespace KisRLE
@@ -243,14 +252,13 @@ int psd_unzip_without_prediction(const char *src, int packed_len, char *dst, int
 }
 
 template<typename T>
-inline void psd_unzip_with_prediction(QByteArray &dst_buf, int row_size);
+inline void psd_unzip_with_prediction(char *dst_buf, int dst_len, int row_size);
 
 template<>
-inline void psd_unzip_with_prediction<uint8_t>(QByteArray &dst_buf, const int row_size)
+inline void psd_unzip_with_prediction<uint8_t>(char *dst_buf, int dst_len, const int row_size)
 {
-    auto *buf = reinterpret_cast<uint8_t *>(dst_buf.data());
+    auto *buf = reinterpret_cast<uint8_t *>(dst_buf);
     int len = 0;
-    int dst_len = dst_buf.size();
 
     while (dst_len > 0) {
         len = row_size;
@@ -264,11 +272,10 @@ inline void psd_unzip_with_prediction<uint8_t>(QByteArray &dst_buf, const int ro
 }
 
 template<>
-inline void psd_unzip_with_prediction<uint16_t>(QByteArray &dst_buf, const int row_size)
+inline void psd_unzip_with_prediction<uint16_t>(char *dst_buf, int dst_len, const int row_size)
 {
-    auto *buf = reinterpret_cast<uint8_t *>(dst_buf.data());
+    auto *buf = reinterpret_cast<uint8_t *>(dst_buf);
     int len = 0;
-    int dst_len = dst_buf.size();
 
     while (dst_len > 0) {
         len = row_size;
@@ -282,23 +289,33 @@ inline void psd_unzip_with_prediction<uint16_t>(QByteArray &dst_buf, const int r
     }
 }
 
-QByteArray psd_unzip_with_prediction(const QByteArray &src, int dst_len, int row_size, int color_depth)
+bool psd_unzip_with_prediction(const char *src, int packed_len, char *dst, int dst_len, int row_size, int color_depth)
 {
-    QByteArray dst_buf = Compression::uncompress(dst_len, src, psd_compression_type::ZIP);
-
-    if (dst_buf.size() == 0)
-        return {};
-
     if (color_depth == 32) {
         // Placeholded for future implementation.
         errKrita << "Unsupported bit depth for prediction";
-        return {};
-    } else if (color_depth == 16) {
-        psd_unzip_with_prediction<quint16>(dst_buf, row_size);
+        return false;
+    }
+
+    if (psd_unzip_without_prediction(src, packed_len, dst, dst_len) == 0)
+        return false;
+
+    if (color_depth == 16) {
+        psd_unzip_with_prediction<quint16>(dst, dst_len, row_size);
     } else {
-        psd_unzip_with_prediction<quint8>(dst_buf, row_size);
+        psd_unzip_with_prediction<quint8>(dst, dst_len, row_size);
     }
 
+    return true;
+}
+
+QByteArray psd_unzip_with_prediction(const QByteArray &src, int dst_len, int row_size, int color_depth)
+{
+    QByteArray dst_buf(dst_len, '\0');
+
+    if (!psd_unzip_with_prediction(src.constData(), src.size(), dst_buf.data(), dst_len, row_size, color_depth))
+        return {};
+
     return dst_buf;
 }
 
@@ -394,6 +411,36 @@ QByteArray Compression::uncompress(int unpacked_len, QByteArray bytes, psd_compr
     return QByteArray();
 }
 
+bool Compression::uncompress(const char *input,
+                             int packed_len,
+                             char *output,
+                             int unpacked_len,
+                             psd_compression_type compressionType,
+                             int row_size,
+                             int color_depth)
+{
+    if (packed_len < 1 || unpacked_len < 1)
+        return false;
+
+    switch (compressionType) {
+    case Uncompressed:
+        if (packed_len < unpacked_len)
+            return false;
+        std::copy_n(input, unpacked_len, output);
+        return true;
+    case RLE:
+        return KisRLE::decompress(input, packed_len, output, unpacked_len);
+    case ZIP:
+        return KisZip::psd_unzip_without_prediction(input, packed_len, output, unpacked_len) != 0;
+    case ZIPWithPrediction:
+        return KisZip::psd_unzip_with_prediction(input, packed_len, output, unpacked_len, row_size, color_depth);
+    default:
+        qFatal("Cannot uncompress layer data: invalid compression type");
+    }
+
+    return false;
+}
+
 QByteArray Compression::compress(QByteArray bytes, psd_compression_type compressionType, int row_size, int color_depth)
 {
     if (bytes.size() < 1)
@@ -16,6 +16,21 @@ class KRITAPSDUTILS_EXPORT Compression
 {
 public:
     static QByteArray uncompress(int unpacked_len, QByteArray bytes, psd_compression_type compressionType, int row_size = 0, int color_depth = 0);
+
+    /**
+     * Decompresses \p input right into a buffer owned by the caller, so the
+     * decoders can fill the rows of a bigger buffer without allocating
+     * intermediate arrays. Safe to call from several threads at once.
+     *
+     * @return false if the data is corrupted or too short
+     */
+    static bool uncompress(const char *input,
+                           int packed_len,
+                           char *output,
+                           int unpacked_len,
+                           psd_compression_type compressionType,
+                           int row_size = 0,
+                           int color_depth = 0);
     static QByteArray compress(QByteArray bytes, psd_compression_type compressionType, int row_size = 0, int color_depth = 0);
 };
 
@@ -10,7 +10,6 @@
 #include <QByteArray>
 #include <QCoreApplication>
 #include <QDataStream>
-#include <cmath>
 #include <klocalizedstring.h>
 
 #include <compression.h>
@@ -89,4 +88,59 @@ void CompressionTest::testCompressionUncompressed()
     QVERIFY(qstrcmp(ba, uncompressed) == 0);
 }
 
+namespace
+{
+/**
+ * A plane that looks like a layer channel: smooth gradients with
+ * some noise and a few flat areas
+ */
+QByteArray generatePlane(int width, int height)
+{
+    QByteArray plane(width * height, '\0');
+
+    for (int y = 0; y < height; y++) {
+        char *row = plane.data() + y * width;
+        for (int x = 0; x < width; x++) {
+            if ((x / 256 + y / 256) % 3 == 0) {
+                row[x] = 0;
+            } else {
+                row[x] = static_cast<char>((x + y) / 8 + (rand() & 0x3));
+            }
+        }
+    }
+
+    return plane;
+}
+} // namespace
+
+void CompressionTest::testUncompressIntoBuffer_data()
+{
+    QTest::addColumn<int>("compressionType");
+
+    QTest::newRow("uncompressed") << int(psd_compression_type::Uncompressed);
+    QTest::newRow("rle") << int(psd_compression_type::RLE);
+    QTest::newRow("zip") << int(psd_compression_type::ZIP);
+    QTest::newRow("zip-prediction") << int(psd_compression_type::ZIPWithPrediction);
+}
+
+void CompressionTest::testUncompressIntoBuffer()
+{
+    QFETCH(int, compressionType);
+    const psd_compression_type type = static_cast<psd_compression_type>(compressionType);
+
+    const int width = 300;
+    const int height = 20;
+    const QByteArray plane = generatePlane(width, height);
+
+    const QByteArray compressed = Compression::compress(plane, type, width, 8);
+    QVERIFY(compressed.size() > 0);
+
+    // decode into the middle of a bigger buffer, the surrounding bytes should stay intact
+    QByteArray buffer(plane.size() + 2, 'x');
+    QVERIFY(Compression::uncompress(compressed.constData(), compressed.size(), buffer.data() + 1, plane.size(), type, width, 8));
+    QCOMPARE(buffer.mid(1, plane.size()), plane);
+    QCOMPARE(buffer.at(0), 'x');
+    QCOMPARE(buffer.at(buffer.size() - 1), 'x');
+}
+
 SIMPLE_TEST_MAIN(CompressionTest)
@@ -17,6 +17,8 @@ private Q_SLOTS:
     void testCompressionRLE();
     void testCompressionZIP();
     void testCompressionUncompressed();
+    void testUncompressIntoBuffer_data();
+    void testUncompressIntoBuffer();
 };
 
 #endif
@@ -54,6 +54,7 @@
 #include "KisMainWindow.h"
 #include "KisAutoSaveRecoveryDialog.h"
 #include "KisPart.h"
+#include "KisBatchConversionService.h"
 #include <kis_icon.h>
 #include "kis_splash_screen.h"
 #include "kis_config.h"
@@ -436,11 +437,12 @@ bool KisApplication::start(const KisApplicationArguments &args)
     const bool exportAs = args.exportAs();
     const bool exportSequence = args.exportSequence();
     const QString exportFileName = args.exportFileName();
+    const bool batchService = args.batchService();
 
-    d->batchRun = (exportAs || exportSequence || !exportFileName.isEmpty());
-    const bool needsMainWindow = (!exportAs && !exportSequence);
+    d->batchRun = (exportAs || exportSequence || batchService || !exportFileName.isEmpty());
+    const bool needsMainWindow = (!exportAs && !exportSequence && !batchService);
     // only show the mainWindow when no command-line mode option is passed
-    bool showmainWindow = (!exportAs && !exportSequence); // would be !batchRun;
+    bool showmainWindow = (!exportAs && !exportSequence && !batchService); // would be !batchRun;
 
     const bool showSplashScreen = !d->batchRun && qEnvironmentVariableIsEmpty("NOSPLASH");
     if (showSplashScreen && d->splashScreen) {
@@ -474,6 +476,21 @@ bool KisApplication::start(const KisApplicationArguments &args)
         return false;
     }
 
+    if (batchService) {
+        // the service keeps the application running until it is asked to quit
+        KisBatchConversionService *service =
+            new KisBatchConversionService(args.batchServiceSocket(),
+                                          args.batchServiceJobs(),
+                                          args.batchServiceMemoryLimit(),
+                                          this);
+        if (!service->start()) {
+            return false;
+        }
+
+        connect(service, SIGNAL(sigFinished()), this, SLOT(quit()));
+        return true;
+    }
+
     KisPart *kisPart = KisPart::instance();
     if (needsMainWindow) {
         // show a mainWindow asap, if we want that
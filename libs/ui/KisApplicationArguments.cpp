@@ -33,6 +33,10 @@ struct Q_DECL_HIDDEN KisApplicationArguments::Private
     bool exportAs {false};
     bool exportSequence {false};
     QString exportFileName;
+    bool batchService {false};
+    QString batchServiceSocket;
+    int batchServiceJobs {0};
+    int batchServiceMemoryLimit {0};
     QString workspace;
     QString windowLayout;
     QString session;
@@ -95,6 +99,10 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export"), i18n("Export to the given filename and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-sequence"), i18n("Export animation to the given filename and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-filename"), i18n("Filename for export"), QLatin1String("filename")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-service"), i18n("Run as a headless service converting the documents described by the JSON jobs read from stdin or from the local socket")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-socket"), i18n("The name of the local socket the batch service takes the jobs from"), QLatin1String("name")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-jobs"), i18n("The number of the jobs the batch service processes concurrently"), QLatin1String("count")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-memory-limit"), i18n("The memory in MiB the batch service may use before it stops starting new jobs"), QLatin1String("MiB")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("file-layer"), i18n("File layer to be added to existing or new file"), QLatin1String("file-layer")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("resource-location"), i18n("A location that overrides the configured location for Krita's resources"), QLatin1String("file-layer")));
     parser.addPositionalArgument(QLatin1String("[file(s)]"), i18n("File(s) or URL(s) to open"));
@@ -182,6 +190,10 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
     d->doTemplate = parser.isSet("template");
     d->exportAs = parser.isSet("export");
     d->exportSequence = parser.isSet("export-sequence");
+    d->batchService = parser.isSet("batch-service");
+    d->batchServiceSocket = parser.value("batch-socket");
+    d->batchServiceJobs = parser.value("batch-jobs").toInt();
+    d->batchServiceMemoryLimit = parser.value("batch-memory-limit").toInt();
     d->canvasOnly = parser.isSet("canvasonly");
     d->noSplash = parser.isSet("nosplash");
     d->fullScreen = parser.isSet("fullscreen");
@@ -203,6 +215,10 @@ KisApplicationArguments::KisApplicationArguments(const KisApplicationArguments &
     d->doTemplate = rhs.doTemplate();
     d->exportAs = rhs.exportAs();
     d->exportFileName = rhs.exportFileName();
+    d->batchService = rhs.batchService();
+    d->batchServiceSocket = rhs.batchServiceSocket();
+    d->batchServiceJobs = rhs.batchServiceJobs();
+    d->batchServiceMemoryLimit = rhs.batchServiceMemoryLimit();
     d->canvasOnly = rhs.canvasOnly();
     d->workspace = rhs.workspace();
     d->windowLayout = rhs.windowLayout();
@@ -220,6 +236,10 @@ void KisApplicationArguments::operator=(const KisApplicationArguments &rhs)
     d->doTemplate = rhs.doTemplate();
     d->exportAs = rhs.exportAs();
     d->exportFileName = rhs.exportFileName();
+    d->batchService = rhs.batchService();
+    d->batchServiceSocket = rhs.batchServiceSocket();
+    d->batchServiceJobs = rhs.batchServiceJobs();
+    d->batchServiceMemoryLimit = rhs.batchServiceMemoryLimit();
     d->canvasOnly = rhs.canvasOnly();
     d->workspace = rhs.workspace();
     d->windowLayout = rhs.windowLayout();
@@ -326,6 +346,26 @@ QString KisApplicationArguments::exportFileName() const
     return d->exportFileName;
 }
 
+bool KisApplicationArguments::batchService() const
+{
+    return d->batchService;
+}
+
+QString KisApplicationArguments::batchServiceSocket() const
+{
+    return d->batchServiceSocket;
+}
+
+int KisApplicationArguments::batchServiceJobs() const
+{
+    return d->batchServiceJobs;
+}
+
+int KisApplicationArguments::batchServiceMemoryLimit() const
+{
+    return d->batchServiceMemoryLimit;
+}
+
 QString KisApplicationArguments::workspace() const
 {
     return d->workspace;
@@ -33,6 +33,10 @@ public:
     bool exportAs() const;
     bool exportSequence() const;
     QString exportFileName() const;
+    bool batchService() const;
+    QString batchServiceSocket() const;
+    int batchServiceJobs() const;
+    int batchServiceMemoryLimit() const;
     QString workspace() const;
     QString windowLayout() const;
     QString session() const;
@@ -0,0 +1,575 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBatchConversionService.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QThread>
+#include <QTimer>
+
+#include <klocalizedstring.h>
+
+#include <KisLockFrameGenerationLock.h>
+#include <KisMimeDatabase.h>
+#include <KisUsageLogger.h>
+#include <kis_debug.h>
+#include <kis_image.h>
+#include <kis_image_animation_interface.h>
+#include <kis_memory_statistics_server.h>
+#include <kis_time_span.h>
+#include <dialogs/KisAsyncAnimationFramesSaveDialog.h>
+
+#include "KisAsyncAnimationFramesSavingRenderer.h"
+#include "KisDocument.h"
+#include "KisImportExportManager.h"
+#include "KisPart.h"
+
+
+namespace {
+
+const QString ExportCommand = QStringLiteral("export");
+const QString ExportSequenceCommand = QStringLiteral("export-sequence");
+const QString QuitCommand = QStringLiteral("quit");
+
+const qint64 MiB = 1 << 20;
+
+bool isQuitCommand(const QByteArray &line)
+{
+    return QJsonDocument::fromJson(line).object().value("command").toString() == QuitCommand;
+}
+
+/**
+ * Reads the jobs from stdin. Reading from stdin blocks, so it cannot
+ * happen in the GUI thread. The reader stops on the "quit" command
+ * or when stdin is closed.
+ */
+class StdinReader : public QThread
+{
+public:
+    StdinReader(KisBatchConversionService *service)
+        : m_service(service)
+    {
+    }
+
+protected:
+    void run() override {
+        QFile input;
+
+        if (input.open(stdin, QIODevice::ReadOnly)) {
+            while (true) {
+                const QByteArray line = input.readLine().trimmed();
+                if (line.isEmpty() && input.atEnd()) break;
+                if (line.isEmpty()) continue;
+
+                QMetaObject::invokeMethod(m_service, "slotStdinLine",
+                                          Qt::QueuedConnection, Q_ARG(QByteArray, line));
+
+                // the quit command finishes the service on its own
+                if (isQuitCommand(line)) return;
+            }
+        }
+
+        QMetaObject::invokeMethod(m_service, "slotStdinClosed", Qt::QueuedConnection);
+    }
+
+private:
+    KisBatchConversionService *m_service;
+};
+
+}
+
+struct KisBatchConversionService::Private
+{
+    struct Job
+    {
+        quint64 number {0};
+        Request request;
+        QPointer<QIODevice> replyDevice;
+
+        QElapsedTimer timer;
+        QElapsedTimer exportTimer;
+        qint64 queuedTime {0};
+        qint64 loadTime {0};
+        qint64 exportTime {0};
+        qint64 memorySize {0};
+
+        KisDocument *document {0};
+
+        // the state of an exported sequence
+        KisAsyncAnimationFramesSavingRenderer *renderer {0};
+        QList<int> framesLeft;
+        QDir framesDir;
+        QStringList frameFiles;
+    };
+    typedef QSharedPointer<Job> JobSP;
+
+    Private(KisBatchConversionService *_q) : q(_q) {}
+
+    KisBatchConversionService *q;
+
+    QString socketName;
+    int maxParallelJobs {1};
+    int memoryLimit {0};
+
+    QLocalServer *server {0};
+    QScopedPointer<StdinReader> stdinReader;
+    QFile output;
+
+    quint64 lastJobNumber {0};
+    QQueue<JobSP> queue;
+    QList<JobSP> runningJobs;
+
+    bool isProcessing {false};
+    bool quitRequested {false};
+    bool finished {false};
+
+    JobSP runningJob(quint64 number) const;
+    bool memoryLimitExceeded() const;
+    void exportDocument(JobSP job, const QByteArray &mimeType);
+    void exportSequence(JobSP job, const QByteArray &mimeType);
+    void renderNextFrame(JobSP job);
+    void cancelSequence(JobSP job, int frame);
+    void releaseDocument(JobSP job);
+    void respond(JobSP job, const QString &errorMessage = QString());
+};
+
+KisBatchConversionService::Private::JobSP KisBatchConversionService::Private::runningJob(quint64 number) const
+{
+    Q_FOREACH (JobSP job, runningJobs) {
+        if (job->number == number) {
+            return job;
+        }
+    }
+    return JobSP();
+}
+
+bool KisBatchConversionService::Private::memoryLimitExceeded() const
+{
+    const qint64 limit = memoryLimit > 0 ? memoryLimit * MiB :
+        KisMemoryStatisticsServer::instance()->fetchMemoryStatistics(0).tilesSoftLimit;
+
+    return q->usedMemory() > limit;
+}
+
+void KisBatchConversionService::Private::exportDocument(JobSP job, const QByteArray &mimeType)
+{
+    const quint64 number = job->number;
+
+    QObject::connect(job->document, &KisDocument::sigCompleteBackgroundSaving, q,
+                     [this, job] (const KritaUtils::ExportFileJob &, KisImportExportErrorCode status, const QString &errorMessage, const QString &) {
+                         q->finishJob(job->number, status.isOk() ? QString() :
+                                      i18n("Could not export %1 to %2: %3", job->request.input, job->request.output,
+                                           !errorMessage.isEmpty() ? errorMessage : status.errorMessage()));
+                     });
+
+    if (!job->document->exportDocument(job->request.output, mimeType, false, false, job->request.configuration)) {
+        // the completion signal may have already finished the failed job
+        if (runningJob(number)) {
+            q->finishJob(number, i18n("Could not export %1 to %2: %3", job->request.input, job->request.output,
+                                      job->document->errorMessage()));
+        }
+    }
+}
+
+void KisBatchConversionService::Private::exportSequence(JobSP job, const QByteArray &mimeType)
+{
+    KisImageSP image = job->document->image();
+
+    if (!image->animationInterface()->hasAnimation()) {
+        q->finishJob(job->number, i18n("%1 has no animation", job->request.input));
+        return;
+    }
+
+    const KisTimeSpan range = image->animationInterface()->documentPlaybackRange();
+    const QString &baseFileName = job->request.output;
+
+    // the dialog is not shown, it only knows the naming scheme and the frames to render
+    KisAsyncAnimationFramesSaveDialog sequence(image, range, baseFileName, 0, false, job->request.configuration);
+
+    const QFileInfo maskInfo(sequence.savedFilesMaskWildcard());
+    job->framesDir = QDir(maskInfo.absolutePath());
+
+    if (!job->framesDir.exists() && !job->framesDir.mkpath(maskInfo.absolutePath())) {
+        q->finishJob(job->number, i18n("Could not create the directory %1", maskInfo.absolutePath()));
+        return;
+    }
+
+    if (!job->framesDir.entryList({maskInfo.fileName()}).isEmpty()) {
+        q->finishJob(job->number, i18n("Frames with the same naming scheme as %1 already exist", baseFileName));
+        return;
+    }
+
+    const int suffixPos = baseFileName.lastIndexOf('.');
+    const QString prefix = suffixPos >= 0 ? baseFileName.left(suffixPos) : baseFileName;
+    const QString suffix = suffixPos >= 0 ? baseFileName.mid(suffixPos) : QString();
+
+    job->framesLeft = sequence.getUniqueFrames();
+    job->frameFiles = sequence.savedFiles();
+    job->renderer = new KisAsyncAnimationFramesSavingRenderer(image, prefix, suffix, mimeType, range,
+                                                              -range.start(), false,
+                                                              job->request.configuration);
+
+    QObject::connect(job->renderer, &KisAsyncAnimationRendererBase::sigFrameCompleted, q,
+                     [this, job] (int) { renderNextFrame(job); });
+    QObject::connect(job->renderer, &KisAsyncAnimationRendererBase::sigFrameCancelled, q,
+                     [this, job] (int frame, KisAsyncAnimationRendererBase::CancelReason) { cancelSequence(job, frame); });
+
+    renderNextFrame(job);
+}
+
+void KisBatchConversionService::Private::renderNextFrame(JobSP job)
+{
+    if (job->framesLeft.isEmpty()) {
+        q->finishJob(job->number);
+        return;
+    }
+
+    KisImageSP image = job->document->image();
+    const int frame = job->framesLeft.takeFirst();
+
+    KisLockFrameGenerationLock lock(image->animationInterface());
+    job->renderer->startFrameRegeneration(image, frame, KisAsyncAnimationRendererBase::None, std::move(lock));
+}
+
+void KisBatchConversionService::Private::cancelSequence(JobSP job, int frame)
+{
+    job->framesLeft.clear();
+
+    // don't leave a partial sequence, it would block the next attempt
+    Q_FOREACH (const QString &file, job->frameFiles) {
+        if (job->framesDir.exists(file)) {
+            job->framesDir.remove(file);
+        }
+    }
+
+    q->finishJob(job->number, i18n("Failed to render frame %1 of %2", frame, job->request.input));
+}
+
+void KisBatchConversionService::Private::releaseDocument(JobSP job)
+{
+    // we may be called from the signals of the document or the renderer,
+    // so they cannot be deleted right now
+    if (job->renderer) {
+        job->renderer->deleteLater();
+        job->renderer = 0;
+    }
+
+    if (job->document) {
+        job->document->deleteLater();
+        job->document = 0;
+    }
+}
+
+void KisBatchConversionService::Private::respond(JobSP job, const QString &errorMessage)
+{
+    const Request &request = job->request;
+
+    QJsonObject response;
+    response["id"] = request.id;
+    response["status"] = errorMessage.isEmpty() ? "ok" : "error";
+
+    if (!errorMessage.isEmpty()) {
+        response["message"] = errorMessage;
+    }
+
+    if (job->timer.isValid()) {
+        QJsonObject timing;
+        timing["queued"] = job->queuedTime;
+        timing["load"] = job->loadTime;
+        timing["export"] = job->exportTime;
+        timing["total"] = job->timer.elapsed();
+        response["timing"] = timing;
+        response["memory"] = job->memorySize;
+    }
+
+    KisUsageLogger::log(QString("Batch job %1 (%2 -> %3): %4. Queued: %5 ms, loading: %6 ms, exporting: %7 ms")
+                            .arg(request.id, request.input, request.output,
+                                 errorMessage.isEmpty() ? "OK" : errorMessage)
+                            .arg(job->queuedTime)
+                            .arg(job->loadTime)
+                            .arg(job->exportTime));
+
+    if (!job->replyDevice) return;
+
+    job->replyDevice->write(QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n');
+
+    if (QLocalSocket *socket = qobject_cast<QLocalSocket*>(job->replyDevice)) {
+        socket->flush();
+    } else if (QFileDevice *file = qobject_cast<QFileDevice*>(job->replyDevice)) {
+        file->flush();
+    }
+}
+
+KisBatchConversionService::KisBatchConversionService(const QString &socketName, int maxParallelJobs, int memoryLimit, QObject *parent)
+    : QObject(parent),
+      m_d(new Private(this))
+{
+    m_d->socketName = socketName;
+    m_d->maxParallelJobs = maxParallelJobs > 0 ? maxParallelJobs : qMax(1, QThread::idealThreadCount() / 2);
+    m_d->memoryLimit = memoryLimit;
+}
+
+KisBatchConversionService::~KisBatchConversionService()
+{
+    if (m_d->stdinReader) {
+        m_d->stdinReader->wait();
+    }
+
+    Q_FOREACH (Private::JobSP job, m_d->runningJobs) {
+        delete job->renderer;
+        delete job->document;
+    }
+}
+
+bool KisBatchConversionService::start()
+{
+    if (!m_d->socketName.isEmpty()) {
+        m_d->server = new QLocalServer(this);
+        connect(m_d->server, SIGNAL(newConnection()), SLOT(slotNewConnection()));
+
+        if (!m_d->server->listen(m_d->socketName)) {
+            errKrita << "Could not listen on" << m_d->socketName << ":" << m_d->server->errorString();
+            return false;
+        }
+    } else {
+        m_d->output.open(stdout, QIODevice::WriteOnly);
+
+        m_d->stdinReader.reset(new StdinReader(this));
+        m_d->stdinReader->start();
+    }
+
+    KisUsageLogger::log(QString("Started batch conversion service. Parallel jobs: %1, memory limit: %2 MiB")
+                            .arg(m_d->maxParallelJobs)
+                            .arg(m_d->memoryLimit > 0 ? QString::number(m_d->memoryLimit) : "default"));
+
+    return true;
+}
+
+int KisBatchConversionService::pendingJobs() const
+{
+    return m_d->queue.size() + m_d->runningJobs.size();
+}
+
+bool KisBatchConversionService::parseRequest(const QByteArray &line, Request *request, QString *errorMessage)
+{
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+
+    if (error.error != QJsonParseError::NoError) {
+        *errorMessage = i18n("Could not parse the job: %1", error.errorString());
+        return false;
+    }
+
+    if (!document.isObject()) {
+        *errorMessage = i18n("The job should be a JSON object");
+        return false;
+    }
+
+    const QJsonObject object = document.object();
+
+    request->id = object.value("id").toString();
+    request->command = object.value("command").toString(ExportCommand);
+
+    if (request->command == QuitCommand) {
+        return true;
+    }
+
+    if (request->command != ExportCommand && request->command != ExportSequenceCommand) {
+        *errorMessage = i18n("Unknown command: %1", request->command);
+        return false;
+    }
+
+    // the fields of a wrong type would be silently ignored otherwise
+    Q_FOREACH (const QString &field, QStringList({"id", "input", "output", "mimetype", "configuration"})) {
+        if (object.contains(field) && !object.value(field).isString()) {
+            *errorMessage = i18n("The \"%1\" field should be a string", field);
+            return false;
+        }
+    }
+
+    request->input = object.value("input").toString();
+    request->output = object.value("output").toString();
+    request->mimeType = object.value("mimetype").toString().toLatin1();
+
+    if (request->input.isEmpty() || request->output.isEmpty()) {
+        *errorMessage = i18n("The job should have both \"input\" and \"output\" fields");
+        return false;
+    }
+
+    const QString configuration = object.value("configuration").toString();
+    if (!configuration.isEmpty()) {
+        request->configuration = new KisPropertiesConfiguration();
+        if (!request->configuration->fromXML(configuration)) {
+            *errorMessage = i18n("Could not parse the export configuration");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void KisBatchConversionService::addJob(const QByteArray &line, QIODevice *replyDevice)
+{
+    Private::JobSP job(new Private::Job());
+    job->number = ++m_d->lastJobNumber;
+    job->replyDevice = replyDevice;
+
+    QString errorMessage;
+    if (!parseRequest(line, &job->request, &errorMessage)) {
+        m_d->respond(job, errorMessage);
+        return;
+    }
+
+    if (job->request.command == QuitCommand) {
+        requestQuit();
+        return;
+    }
+
+    job->timer.start();
+    m_d->queue.enqueue(job);
+
+    QTimer::singleShot(0, this, SLOT(slotProcessQueue()));
+}
+
+void KisBatchConversionService::startJob(quint64 jobNumber, const Request &request)
+{
+    Private::JobSP job = m_d->runningJob(jobNumber);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(job);
+
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+
+    KisDocument *doc = KisPart::instance()->createDocument();
+    doc->setFileBatchMode(true);
+    job->document = doc;
+
+    if (!doc->openPath(request.input)) {
+        finishJob(jobNumber, i18n("Could not load %1: %2", request.input, doc->errorMessage()));
+        return;
+    }
+
+    qApp->processEvents(); // For vector layers to be updated
+    doc->image()->waitForDone();
+
+    job->loadTime = loadTimer.elapsed();
+    job->memorySize = KisMemoryStatisticsServer::instance()->fetchMemoryStatistics(doc->image()).imageSize;
+
+    const QByteArray mimeType = !request.mimeType.isEmpty() ? request.mimeType :
+        KisMimeDatabase::mimeTypeForFile(request.output, false).toLatin1();
+
+    if (mimeType.isEmpty()) {
+        finishJob(jobNumber, i18n("Unknown file type of %1, specify it with the \"mimetype\" field", request.output));
+        return;
+    }
+
+    if (!KisImportExportManager::supportedMimeTypes(KisImportExportManager::Export).contains(QString::fromLatin1(mimeType))) {
+        finishJob(jobNumber, i18n("Krita cannot export files of type %1", QString::fromLatin1(mimeType)));
+        return;
+    }
+
+    job->exportTimer.start();
+
+    if (request.command == ExportSequenceCommand) {
+        m_d->exportSequence(job, mimeType);
+    } else {
+        m_d->exportDocument(job, mimeType);
+    }
+}
+
+void KisBatchConversionService::finishJob(quint64 jobNumber, const QString &errorMessage)
+{
+    Private::JobSP job = m_d->runningJob(jobNumber);
+    if (!job) return;
+
+    m_d->runningJobs.removeOne(job);
+
+    if (job->exportTimer.isValid()) {
+        job->exportTime = job->exportTimer.elapsed();
+    }
+
+    m_d->releaseDocument(job);
+    m_d->respond(job, errorMessage);
+
+    QTimer::singleShot(0, this, SLOT(slotProcessQueue()));
+}
+
+qint64 KisBatchConversionService::usedMemory() const
+{
+    return KisMemoryStatisticsServer::instance()->fetchMemoryStatistics(0).totalMemorySize;
+}
+
+void KisBatchConversionService::slotNewConnection()
+{
+    while (QLocalSocket *client = m_d->server->nextPendingConnection()) {
+        connect(client, &QLocalSocket::readyRead, this, [this, client] () {
+            while (client->canReadLine()) {
+                const QByteArray line = client->readLine().trimmed();
+                if (!line.isEmpty()) {
+                    addJob(line, client);
+                }
+            }
+        });
+        connect(client, SIGNAL(disconnected()), client, SLOT(deleteLater()));
+    }
+}
+
+void KisBatchConversionService::slotStdinLine(const QByteArray &line)
+{
+    addJob(line, &m_d->output);
+}
+
+void KisBatchConversionService::slotStdinClosed()
+{
+    requestQuit();
+}
+
+void KisBatchConversionService::requestQuit()
+{
+    m_d->quitRequested = true;
+    QTimer::singleShot(0, this, SLOT(slotProcessQueue()));
+}
+
+void KisBatchConversionService::slotProcessQueue()
+{
+    /**
+     * Loading the documents processes the events, so we can be
+     * called recursively. The outer call will take the new jobs
+     * on the next iteration.
+     */
+    if (m_d->isProcessing) return;
+    m_d->isProcessing = true;
+
+    while (!m_d->queue.isEmpty() &&
+           m_d->runningJobs.size() < m_d->maxParallelJobs &&
+           (m_d->runningJobs.isEmpty() || !m_d->memoryLimitExceeded())) {
+
+        Private::JobSP job = m_d->queue.dequeue();
+        job->queuedTime = job->timer.elapsed();
+        m_d->runningJobs << job;
+
+        startJob(job->number, job->request);
+    }
+
+    m_d->isProcessing = false;
+
+    if (m_d->quitRequested && !m_d->finished &&
+        m_d->queue.isEmpty() && m_d->runningJobs.isEmpty()) {
+
+        m_d->finished = true;
+        emit sigFinished();
+    }
+}
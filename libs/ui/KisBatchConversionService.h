@@ -0,0 +1,166 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBATCHCONVERSIONSERVICE_H
+#define KISBATCHCONVERSIONSERVICE_H
+
+#include <QObject>
+#include <QScopedPointer>
+
+#include "kritaui_export.h"
+#include "kis_properties_configuration.h"
+
+class QIODevice;
+
+/**
+ * A long-running headless service converting documents, started with
+ * the --batch-service command line option.
+ *
+ * In the command line --export mode every conversion pays the full
+ * startup cost: loading the plugins, initializing the resource database
+ * and the color space registry. The service pays it once and then takes
+ * the jobs from stdin or, if a socket name is given, from the clients
+ * of a local socket.
+ *
+ * Every job is a single line of JSON:
+ *
+ * \code
+ * {"id": "1", "command": "export", "input": "in.kra", "output": "out.png"}
+ * {"id": "2", "command": "export-sequence", "input": "in.kra", "output": "frames/out.png"}
+ * {"command": "quit"}
+ * \endcode
+ *
+ * "mimetype" may override the type guessed from the output file name and
+ * "configuration" may pass the XML export configuration of the filter.
+ * Both are used for the single images and for the frames of a sequence.
+ * The job fails if there is no export filter for the type. A sequence is
+ * not exported over the existing frames with the same naming scheme.
+ *
+ * Every job is answered with a single line of JSON written to stdout or
+ * to the socket the job came from:
+ *
+ * \code
+ * {"id": "1", "status": "ok", "timing": {"queued": 0, "load": 812, "export": 230, "total": 1042}, "memory": 134217728}
+ * {"id": "3", "status": "error", "message": "Could not load in.kra: ..."}
+ * \endcode
+ *
+ * The timings are in milliseconds, "memory" is the estimated memory
+ * footprint of the loaded image in bytes.
+ *
+ * The documents are loaded one by one in the GUI thread, but their export
+ * happens in background, the frames of a sequence are rendered one by one
+ * asynchronously, so several jobs are processed concurrently. The
+ * number of concurrent jobs is limited by maxParallelJobs and by the
+ * memory limit: a new job is not started while the memory used by the
+ * tiles exceeds the limit, unless no other jobs are running.
+ *
+ * The service quits the application when it receives the "quit" command
+ * or stdin is closed, after all the pending jobs have been finished.
+ */
+class KRITAUI_EXPORT KisBatchConversionService : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * A parsed line of the protocol
+     */
+    struct Request
+    {
+        QString id;
+        QString command;
+        QString input;
+        QString output;
+        QByteArray mimeType;
+        KisPropertiesConfigurationSP configuration;
+    };
+
+    /**
+     * @param socketName the name of the local socket to listen on, if
+     * empty, the jobs are read from stdin
+     * @param maxParallelJobs the number of jobs processed concurrently,
+     * if zero, half of the ideal thread count is used
+     * @param memoryLimit the limit of the memory used by the tiles in
+     * MiB, if zero, the soft limit of the tiles memory from the image
+     * configuration is used
+     */
+    KisBatchConversionService(const QString &socketName, int maxParallelJobs, int memoryLimit, QObject *parent = 0);
+    ~KisBatchConversionService() override;
+
+    /**
+     * Starts listening for the jobs
+     *
+     * @return false if the local socket could not be created
+     */
+    bool start();
+
+    /**
+     * @return the number of the jobs that have been queued and not
+     * finished yet
+     */
+    int pendingJobs() const;
+
+    /**
+     * Parses a single line of the protocol. The commands other than
+     * "quit" are checked to have all the fields needed to run them.
+     *
+     * @return false and the message to report in \p errorMessage if
+     * the line cannot be run
+     */
+    static bool parseRequest(const QByteArray &line, Request *request, QString *errorMessage);
+
+    /**
+     * Parses \p line and queues the job. The response is written to
+     * \p replyDevice, the device may be destroyed before the job
+     * is finished, then the response is dropped.
+     */
+    void addJob(const QByteArray &line, QIODevice *replyDevice);
+
+Q_SIGNALS:
+    /**
+     * Emitted when the service has been asked to quit and all
+     * the pending jobs have been finished
+     */
+    void sigFinished();
+
+private Q_SLOTS:
+    void slotNewConnection();
+    void slotProcessQueue();
+    void slotStdinLine(const QByteArray &line);
+    void slotStdinClosed();
+
+protected:
+    /**
+     * Runs the job, the job is already counted as running. The
+     * implementation should call finishJob() when the job is done,
+     * the call may happen right from this method.
+     *
+     * The default implementation loads the document and exports it
+     * according to the command.
+     */
+    virtual void startJob(quint64 jobNumber, const Request &request);
+
+    /**
+     * Responds to the job, an empty \p errorMessage means success,
+     * and lets the queue start the next one
+     */
+    void finishJob(quint64 jobNumber, const QString &errorMessage = QString());
+
+    /**
+     * @return the memory the new job is checked against the limit with,
+     * the default implementation returns the total memory used by Krita
+     * as reported by the memory statistics server
+     */
+    virtual qint64 usedMemory() const;
+
+private:
+    void requestQuit();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISBATCHCONVERSIONSERVICE_H
@@ -16,6 +16,7 @@ namespace {
 struct TaskStruct {
     int id = 0;
     KisIdleTaskStrokeStrategyFactory factory;
+    KisIdleTasksManager::Priority priority = KisIdleTasksManager::NormalPriority;
 };
 }
 
@@ -49,7 +50,7 @@ void KisIdleTasksManager::setImage(KisImageSP image)
     }
 }
 
-int KisIdleTasksManager::addIdleTask(KisIdleTaskStrokeStrategyFactory factory)
+int KisIdleTasksManager::addIdleTask(KisIdleTaskStrokeStrategyFactory factory, Priority priority)
 {
     /**
      * TODO: don't restart the whole queue on the the task change, just
@@ -60,7 +61,7 @@ int KisIdleTasksManager::addIdleTask(KisIdleTaskStrokeStrategyFactory factory)
         !m_d->tasks.isEmpty() ?
         m_d->tasks.last().id + 1 : 0;
 
-    m_d->tasks.append({newId, factory});
+    m_d->tasks.append({newId, factory, priority});
     triggerIdleTask(newId);
 
     return newId;
@@ -92,23 +93,48 @@ void KisIdleTasksManager::triggerIdleTask(int id)
 
     auto it = std::find(m_d->queue.begin(), m_d->queue.end(), id);
     if (it == m_d->queue.end()) {
-        m_d->queue.enqueue(id);
+        enqueueTask(id);
     }
 
     m_d->idleWatcher.triggerCountdownNoDelay();
 }
 
+void KisIdleTasksManager::enqueueTask(int id)
+{
+    auto priorityOf = [this] (int taskId) {
+        auto it = std::find_if(m_d->tasks.begin(), m_d->tasks.end(),
+                               kismpl::mem_equal_to(&TaskStruct::id, taskId));
+        return it != m_d->tasks.end() ? it->priority : NormalPriority;
+    };
+
+    const Priority priority = priorityOf(id);
+
+    // keep the queue sorted by priority, FIFO inside the same priority
+    auto it = std::find_if(m_d->queue.begin(), m_d->queue.end(),
+                           [&] (int queuedId) {
+                               return priorityOf(queuedId) < priority;
+                           });
+
+    m_d->queue.insert(it, id);
+}
+
 KisIdleTasksManager::TaskGuard
-KisIdleTasksManager::addIdleTaskWithGuard(KisIdleTaskStrokeStrategyFactory factory)
+KisIdleTasksManager::addIdleTaskWithGuard(KisIdleTaskStrokeStrategyFactory factory, Priority priority)
 {
-    return {addIdleTask(factory), this};
+    return {addIdleTask(factory, priority), this};
 }
 
 void KisIdleTasksManager::slotImageIsModified()
 {
+    QVector<TaskStruct> sortedTasks = m_d->tasks;
+    std::stable_sort(sortedTasks.begin(), sortedTasks.end(),
+                     [] (const TaskStruct &lhs, const TaskStruct &rhs) {
+                         return lhs.priority > rhs.priority;
+                     });
+
     m_d->queue.clear();
-    m_d->queue.reserve(m_d->tasks.size());
-    std::transform(m_d->tasks.begin(), m_d->tasks.end(),
+    m_d->queue.reserve(sortedTasks.size());
+    std::transform(sortedTasks.begin(), sortedTasks.end(),
                    std::back_inserter(m_d->queue),
                    std::mem_fn(&TaskStruct::id));
 }
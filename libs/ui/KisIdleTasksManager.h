@@ -35,6 +35,13 @@
  * that will automatically de-register the idle task on
  * destruction.
  *
+ * Every task has a priority. When the image becomes idle, the
+ * tasks with higher priority are started first, e.g. the thumbnails
+ * of the layers docker, which are visible to the user right away,
+ * are regenerated before the overview image and the histogram.
+ * The tasks of the same priority are started in the order of
+ * their registration.
+ *
  * If your idle-task-factory is a lambda object, make sure
  * that the lifetime of the objects you capture into the
  * lambda's closure is longer than the lifetime of the
@@ -102,6 +109,12 @@ public:
         QPointer<KisIdleTasksManager> manager;
     };
 
+    enum Priority {
+        LowPriority = -1,
+        NormalPriority = 0,
+        HighPriority = 1
+    };
+
 public:
     KisIdleTasksManager();
     ~KisIdleTasksManager();
@@ -116,13 +129,17 @@ public:
      *
      * @param factory is a functor creating a KisIdleTaskStrokeStrategy
      *                that will actually execute the task
+     * @param priority defines the order in which the pending tasks
+     *                 are started
      * @return a TaskGuard object that can be used for task manipulations
      */
     [[nodiscard]]
-    TaskGuard addIdleTaskWithGuard(KisIdleTaskStrokeStrategyFactory factory);
+    TaskGuard addIdleTaskWithGuard(KisIdleTaskStrokeStrategyFactory factory,
+                                   Priority priority = NormalPriority);
 
 private:
-    int addIdleTask(KisIdleTaskStrokeStrategyFactory factory);
+    int addIdleTask(KisIdleTaskStrokeStrategyFactory factory, Priority priority);
+    void enqueueTask(int id);
     void removeIdleTask(int id);
     void triggerIdleTask(int id);
 
@@ -8,17 +8,16 @@
 #include "KisImageThumbnailStrokeStrategy.h"
 
 #include <kis_paint_device.h>
-#include <kis_painter.h>
-#include "krita_utils.h"
+#include "KisThumbnailPyramid.h"
 #include "kis_transform_worker.h"
 #include "kis_filter_strategy.h"
+#include "kis_assert.h"
 #include <KoColorSpaceRegistry.h>
 #include <KoUpdater.h>
 #include "KisRunnableStrokeJobUtils.h"
 #include "KisRunnableStrokeJobsInterface.h"
 
 const qreal oversample = 2.;
-const int thumbnailTileDim = 128;
 
 
 KisImageThumbnailStrokeStrategyBase::
@@ -46,7 +45,6 @@ KisImageThumbnailStrokeStrategyBase::~KisImageThumbnailStrokeStrategyBase()
 
 void KisImageThumbnailStrokeStrategyBase::initStrokeCallback()
 {
-    using KritaUtils::addJobConcurrent;
     using KritaUtils::addJobSequential;
     KisIdleTaskStrokeStrategy::initStrokeCallback();
 
@@ -58,21 +56,30 @@ void KisImageThumbnailStrokeStrategyBase::initStrokeCallback()
         m_thumbnailOversampledSize.scale(imageRect.size(), Qt::KeepAspectRatio);
     }
 
-    m_thumbnailDevice = new KisPaintDevice(m_device->colorSpace());
-
     QVector<KisRunnableStrokeJobData*> jobs;
 
-    QVector<QRect> tileRects = KritaUtils::splitRectIntoPatches(QRect(QPoint(0, 0), m_thumbnailOversampledSize), QSize(thumbnailTileDim, thumbnailTileDim));
-    Q_FOREACH (const QRect &rc, tileRects) {
-        addJobConcurrent(jobs, [this, tileRect = rc] () {
-            //we aren't going to use oversample capability of createThumbnailDevice because it recomputes exact bounds for each small patch, which is
-            //slow. We'll handle scaling separately.
-            KisPaintDeviceSP thumbnailTile = m_device->createThumbnailDeviceOversampled(m_thumbnailOversampledSize.width(), m_thumbnailOversampledSize.height(), 1, m_device->defaultBounds()->bounds(), tileRect);
-            KisPainter::copyAreaOptimized(tileRect.topLeft(), thumbnailTile, m_thumbnailDevice, tileRect);
-        });
-    }
+    addJobSequential(jobs, [this] () {
+        /**
+         * The pyramid belongs to the device, so only the tiles changed
+         * since the previous update of the thumbnail are downsampled
+         * again. The update itself is parallelized by the pyramid.
+         */
+        KisThumbnailPyramid *pyramid = m_device->thumbnailPyramid();
+        pyramid->update(m_device, qMax(m_thumbnailOversampledSize.width(),
+                                       m_thumbnailOversampledSize.height()));
+
+        QRect levelRect;
+        m_thumbnailDevice = pyramid->levelDevice(m_thumbnailOversampledSize, m_rect, &levelRect);
+        KIS_SAFE_ASSERT_RECOVER_RETURN(m_thumbnailDevice);
+
+        // the level device is a copy, so it is safe to move it
+        m_thumbnailDevice->moveTo(-levelRect.topLeft());
+        m_thumbnailOversampledSize = levelRect.size();
+    });
 
     addJobSequential(jobs, [this] () {
+        if (!m_thumbnailDevice) return;
+
         KoDummyUpdaterHolder updaterHolder;
         qreal xscale = m_thumbnailSize.width() / (qreal)m_thumbnailOversampledSize.width();
         qreal yscale = m_thumbnailSize.height() / (qreal)m_thumbnailOversampledSize.height();
@@ -8,6 +8,10 @@
 #include "kis_image.h"
 #include "KisIdleTasksManager.h"
 #include "kis_layer_utils.h"
+#include "kis_paint_device.h"
+#include "KisThumbnailPyramid.h"
+
+#include <KoColorSpaceRegistry.h>
 
 #include "KisRunnableStrokeJobUtils.h"
 #include "KisRunnableStrokeJobsInterface.h"
@@ -26,14 +30,18 @@ struct ThumbnailsStroke : KisIdleTaskStrokeStrategy
     Q_OBJECT
 public:
 
-    ThumbnailsStroke(KisImageSP image, int maxSize, const QMap<KisNodeWSP, ThumbnailRecord> &cache)
+    ThumbnailsStroke(KisImageSP image, int maxSize,
+                     const QMap<KisNodeWSP, ThumbnailRecord> &cache,
+                     const QVector<KisNodeWSP> &requestedNodes)
         : KisIdleTaskStrokeStrategy(QLatin1String("layer-thumbnails-stroke"), kundo2_i18n("Update layer thumbnails"))
         , m_root(image->root())
         , m_maxSize(maxSize)
         , m_cache(cache)
+        , m_requestedNodes(requestedNodes)
     {
         // thread-safety!
         m_cache.detach();
+        m_requestedNodes.detach();
     }
 
     void initStrokeCallback() override
@@ -43,10 +51,8 @@ public:
         using KisLayerUtils::recursiveApplyNodes;
         using KritaUtils::addJobConcurrent;
 
-        QVector<KisRunnableStrokeJobData*> jobs;
-        recursiveApplyNodes(m_root, [&jobs, this] (KisNodeSP node) {
-
-
+        QVector<KisNodeSP> nodes;
+        recursiveApplyNodes(m_root, [&nodes, this] (KisNodeSP node) {
             if (!node->parent()) return;
             if (node->isFakeNode()) return;
 
@@ -67,16 +73,58 @@ public:
             }
 
             if (shouldRegenerateThumbnail) {
-                addJobConcurrent(jobs, [node, this] () mutable {
-                    QImage image = node->createThumbnail(m_maxSize, m_maxSize, Qt::KeepAspectRatio);
-                    this->sigThumbnailGenerated(node, node->thumbnailSeqNo(), m_maxSize, image);
-                });
+                nodes << node;
             }
         });
 
+        /**
+         * The thumbnails requested by the layers docker belong to the
+         * visible rows, so they are regenerated first
+         */
+        std::stable_partition(nodes.begin(), nodes.end(),
+                              [this] (KisNodeSP node) {
+                                  return m_requestedNodes.contains(node);
+                              });
+
+        QVector<KisRunnableStrokeJobData*> jobs;
+        for (KisNodeSP node : nodes) {
+            addJobConcurrent(jobs, [node, this] () mutable {
+                QImage image = createThumbnail(node);
+                this->sigThumbnailGenerated(node, node->thumbnailSeqNo(), m_maxSize, image);
+            });
+        }
+
         runnableJobsInterface()->addRunnableJobs(jobs);
     }
 
+private:
+    QImage createThumbnail(KisNodeSP node) const
+    {
+        QImage image;
+
+        KisPaintDeviceSP device = node->thumbnailDevice();
+
+        if (device) {
+            /**
+             * The pyramid is updated incrementally, so only the tiles
+             * changed since the previous update are downsampled again
+             */
+            KisThumbnailPyramid *pyramid = device->thumbnailPyramid();
+            pyramid->update(device, 2 * m_maxSize);
+
+            image = pyramid->createThumbnail(m_maxSize, m_maxSize, device->exactBounds(),
+                                             KoColorSpaceRegistry::instance()->rgb8()->profile(),
+                                             KoColorConversionTransformation::internalRenderingIntent(),
+                                             KoColorConversionTransformation::internalConversionFlags());
+        }
+
+        if (image.isNull()) {
+            image = node->createThumbnail(m_maxSize, m_maxSize, Qt::KeepAspectRatio);
+        }
+
+        return image;
+    }
+
 Q_SIGNALS:
     void sigThumbnailGenerated(KisNodeSP node, int maxSize, int seqNo, const QImage &thumb);
 private:
@@ -84,6 +132,7 @@ private:
     KisNodeSP m_root;
     int m_maxSize;
     QMap<KisNodeWSP, ThumbnailRecord> m_cache;
+    QVector<KisNodeWSP> m_requestedNodes;
 
 };
 
@@ -95,6 +144,12 @@ struct KisLayerThumbnailCache::Private
     int maxSize = 32;
     QMap<KisNodeWSP, ThumbnailRecord> cache;
 
+    /**
+     * The nodes whose thumbnails have been requested while being
+     * outdated, i.e. the ones currently visible in the layers docker
+     */
+    mutable QVector<KisNodeWSP> requestedNodes;
+
     void cleanupDeletedNodes();
 };
 
@@ -110,10 +165,10 @@ void KisLayerThumbnailCache::setIdleTaskManagerImpl(KisIdleTasksManager *manager
 {
     if (manager) {
         m_d->taskGuard = manager->addIdleTaskWithGuard([this] (KisImageSP image) {
-            ThumbnailsStroke *stroke = new ThumbnailsStroke(image, m_d->maxSize, m_d->cache);
+            ThumbnailsStroke *stroke = new ThumbnailsStroke(image, m_d->maxSize, m_d->cache, m_d->requestedNodes);
             connect(stroke, SIGNAL(sigThumbnailGenerated(KisNodeSP, int, int, QImage)), this, SLOT(slotThumbnailGenerated(KisNodeSP, int, int, QImage)));
             return stroke;
-        });
+        }, KisIdleTasksManager::HighPriority);
     } else {
         m_d->taskGuard = KisIdleTasksManager::TaskGuard();
     }
@@ -123,6 +178,7 @@ void KisLayerThumbnailCache::setImage(KisImageSP image)
 {
     m_d->image = image;
     m_d->cache.clear();
+    m_d->requestedNodes.clear();
 
     if (m_d->image && m_d->taskGuard.isValid()) {
         m_d->taskGuard.trigger();
@@ -173,6 +229,14 @@ QImage KisLayerThumbnailCache::thumbnail(KisNodeSP node) const
         image.fill(0);
     }
 
+    if ((it == m_d->cache.end() ||
+         it->seqNo != node->thumbnailSeqNo() ||
+         it->maxSize != m_d->maxSize) &&
+        !m_d->requestedNodes.contains(node)) {
+
+        m_d->requestedNodes.append(node);
+    }
+
     return image;
 }
 
@@ -185,6 +249,10 @@ void KisLayerThumbnailCache::Private::cleanupDeletedNodes()
             ++it;
         }
     }
+
+    requestedNodes.erase(std::remove_if(requestedNodes.begin(), requestedNodes.end(),
+                                        [] (const KisNodeWSP &node) { return !node; }),
+                         requestedNodes.end());
 }
 
 void KisLayerThumbnailCache::notifyNodeRemoved(KisNodeSP node)
@@ -206,6 +274,7 @@ void KisLayerThumbnailCache::notifyNodeAdded(KisNodeSP node)
 void KisLayerThumbnailCache::clear()
 {
     m_d->cache.clear();
+    m_d->requestedNodes.clear();
 }
 
 void KisLayerThumbnailCache::slotThumbnailGenerated(KisNodeSP node, int seqNo, int maxSize, const QImage &thumb)
@@ -216,6 +285,7 @@ void KisLayerThumbnailCache::slotThumbnailGenerated(KisNodeSP node, int seqNo, i
     }
 
     m_d->cache[node] = {thumb, seqNo, maxSize};
+    m_d->requestedNodes.removeAll(node);
     emit sigLayerThumbnailUpdated(node);
 }
 
@@ -215,9 +215,13 @@ void KisReferenceImage::paint(QPainter &gc) const
     // scale and rotation done by the user (excluding zoom)
     QTransform transform = QTransform::fromScale(shapeSize.width() / d->image.width(), shapeSize.height() / d->image.height());
 
-    if (d->cachedImage.isNull()) {
-        // detach the data
-        const_cast<KisReferenceImage*>(this)->d->updateCache();
+    {
+        QMutexLocker l(&m_cacheMutex);
+
+        if (d->cachedImage.isNull()) {
+            // detach the data
+            const_cast<KisReferenceImage*>(this)->d->updateCache();
+        }
     }
 
     qreal scale;
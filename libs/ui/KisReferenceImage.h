@@ -7,6 +7,7 @@
 #ifndef KISREFERENCEIMAGE_H
 #define KISREFERENCEIMAGE_H
 
+#include <QMutex>
 #include <QSharedDataPointer>
 
 #include <KoColor.h>
@@ -86,6 +87,12 @@ public:
 private:
     struct Private;
     QSharedDataPointer<Private> d;
+
+    /**
+     * The reference images layer renders its tiles in parallel, so
+     * the lazy update of the cache should be serialized
+     */
+    mutable QMutex m_cacheMutex;
 };
 
 #endif // KISREFERENCEIMAGE_H
@@ -6,11 +6,13 @@
 #include "kis_image_pyramid.h"
 
 #include <QBitArray>
+#include <QtConcurrentMap>
 #include <KoChannelInfo.h>
 #include <KoCompositeOp.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColorSpaceMaths.h>
+#include <KoOptimizedBoxDownsamplerU8Factory.h>
 
 #include "kis_display_filter.h"
 #include "kis_painter.h"
@@ -20,6 +22,8 @@
 #include "kis_debug.h"
 #include "kis_config.h"
 #include "kis_image_config.h"
+#include "kis_algebra_2d.h"
+#include "krita_utils.h"
 
 //#define DEBUG_PYRAMID
 
@@ -29,6 +33,13 @@
 #define FIRST_NOT_ORIGINAL_INDEX 1
 #define SCALE_FROM_INDEX(idx) (1./qreal(1<<(idx)))
 
+/**
+ * The size of the patches processed by a single thread. The patches
+ * are aligned to the tiles of the planes, so no tile is written by
+ * two threads at the same time.
+ */
+#define PATCH_SIZE 128
+
 
 /************* AUXILIARY FUNCTIONS **********************************/
 
@@ -71,6 +82,21 @@ inline void alignByPow2Lo(qint32 &value, qint32 alignment)
     value &= ~mask;
 }
 
+/**
+ * Grows @p rect so that its edges are aligned to @p alignment
+ */
+inline QRect alignRectOut(const QRect &rect, qint32 alignment)
+{
+    using KisAlgebra2D::divideFloor;
+
+    const qint32 x1 = divideFloor(rect.left(), alignment) * alignment;
+    const qint32 y1 = divideFloor(rect.top(), alignment) * alignment;
+    const qint32 x2 = (divideFloor(rect.right(), alignment) + 1) * alignment;
+    const qint32 y2 = (divideFloor(rect.bottom(), alignment) + 1) * alignment;
+
+    return QRect(x1, y1, x2 - x1, y2 - y1);
+}
+
 inline void alignRectBy2(qint32 &x, qint32 &y, qint32 &w, qint32 &h)
 {
     x -= isOdd(x);
@@ -88,6 +114,7 @@ KisImagePyramid::KisImagePyramid(qint32 pyramidHeight)
         : m_monitorProfile(0)
         , m_monitorColorSpace(0)
         , m_pyramidHeight(pyramidHeight)
+        , m_downsampler(KoOptimizedBoxDownsamplerU8Factory::createRgbaDownsampler())
 {
     configChanged();
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), this, SLOT(configChanged()));
@@ -104,8 +131,8 @@ void KisImagePyramid::setMonitorProfile(const KoColorProfile* monitorProfile,
 {
     m_monitorProfile = monitorProfile;
     /**
-     * If you change pixel size here, don't forget to change it
-     * in optimized function downsamplePixels()
+     * If you change pixel size here, don't forget to change
+     * the downsampler created in the constructor
      */
     m_monitorColorSpace = KoColorSpaceRegistry::instance()->rgb8(monitorProfile);
     m_renderingIntent = renderingIntent;
@@ -146,6 +173,9 @@ void KisImagePyramid::rebuildPyramid()
     for (qint32 i = 0; i < m_pyramidHeight; i++) {
         m_pyramid.append(new KisPaintDevice(m_monitorColorSpace));
     }
+
+    m_dirtyRegions.clear();
+    m_dirtyRegions.resize(m_pyramidHeight);
 }
 
 void KisImagePyramid::clearPyramid()
@@ -153,6 +183,9 @@ void KisImagePyramid::clearPyramid()
     for (qint32 i = 0; i < m_pyramidHeight; i++) {
         m_pyramid[i]->clear();
     }
+
+    m_dirtyRegions.clear();
+    m_dirtyRegions.resize(m_pyramidHeight);
 }
 
 void KisImagePyramid::setImage(KisImageWSP newImage)
@@ -166,33 +199,15 @@ void KisImagePyramid::setImage(KisImageWSP newImage)
         // Get the full image size
         QRect rc = m_originalImage->projection()->exactBounds();
 
-        KisImageConfig config(true);
-
-        int patchWidth = config.updatePatchWidth();
-        int patchHeight = config.updatePatchHeight();
+        retrieveImageData(rc);
 
-        if (rc.width() * rc.height() <= patchWidth * patchHeight) {
-            retrieveImageData(rc);
+        /**
+         * The downsampled planes are regenerated lazily, when they are
+         * requested for painting, see getNearestPatch()
+         */
+        for (qint32 i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
+            m_dirtyRegions[i] += rc;
         }
-        else {
-            qint32 firstCol = rc.x() / patchWidth;
-            qint32 firstRow = rc.y() / patchHeight;
-
-            qint32 lastCol = (rc.x() + rc.width()) / patchWidth;
-            qint32 lastRow = (rc.y() + rc.height()) / patchHeight;
-
-            for(qint32 i = firstRow; i <= lastRow; i++) {
-                for(qint32 j = firstCol; j <= lastCol; j++) {
-                    QRect maxPatchRect(j * patchWidth,
-                                       i * patchHeight,
-                                       patchWidth, patchHeight);
-                    QRect patchRect = rc & maxPatchRect;
-                    retrieveImageData(patchRect);
-                }
-            }
-
-        }
-        //TODO: check whether there is needed recalculateCache()
     }
 }
 
@@ -210,9 +225,32 @@ void KisImagePyramid::updateCache(const QRect &dirtyImageRect)
 
 void KisImagePyramid::retrieveImageData(const QRect &rect)
 {
-    // XXX: use QThreadStorage to cache the two patches (512x512) of pixels. Note
-    // that when we do that, we need to reset that cache when the projection's
-    // colorspace changes.
+    if (rect.isEmpty()) return;
+
+    const KoColorSpace *projectionCs = m_originalImage->projection()->colorSpace();
+
+    if (m_channelFlags.size() != projectionCs->channelCount()) {
+        setChannelFlags(QBitArray());
+    }
+
+    KisConfig cfg(true);
+    const bool showSingleChannelAsColor = cfg.showSingleChannelAsColor();
+
+    /**
+     * The conversion into the monitor profile is done in parallel. Every
+     * patch is read, converted and written into the original plane
+     * independently.
+     */
+    QVector<QRect> patches = KritaUtils::splitRectIntoPatches(rect, QSize(PATCH_SIZE, PATCH_SIZE));
+
+    QtConcurrent::blockingMap(patches,
+        [this, showSingleChannelAsColor] (const QRect &patch) {
+            convertPatch(patch, showSingleChannelAsColor);
+        });
+}
+
+void KisImagePyramid::convertPatch(const QRect &rect, bool showSingleChannelAsColor)
+{
     const KoColorSpace *projectionCs = m_originalImage->projection()->colorSpace();
     KisPaintDeviceSP originalProjection = m_originalImage->projection();
     quint32 numPixels = rect.width() * rect.height();
@@ -260,15 +298,10 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
 #endif
     }
     else {
-        if (m_channelFlags.size() != projectionCs->channelCount()) {
-            setChannelFlags(QBitArray());
-        }
         if (!m_channelFlags.isEmpty() && !m_allChannelsSelected) {
             QScopedArrayPointer<quint8> dst(new quint8[projectionCs->pixelSize() * numPixels]);
 
-            KisConfig cfg(true);
-
-            if (m_onlyOneChannelSelected && !cfg.showSingleChannelAsColor()) {
+            if (m_onlyOneChannelSelected && !showSingleChannelAsColor) {
                 projectionCs->convertChannelToVisualRepresentation(originalBytes.data(), dst.data(), numPixels, m_selectedChannelIndex);
             }
             else {
@@ -287,16 +320,39 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
 
 void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 {
-    KisPaintDevice *src;
-    KisPaintDevice *dst;
-    QRect currentSrcRect = info->dirtyImageRectVar;
-
+    /**
+     * The downsampled planes are not updated right away. Only the parts
+     * of them requested for painting are regenerated, see getNearestPatch(),
+     * so the updates outside the viewport cost nothing until the view
+     * is moved there.
+     */
     for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
-        src = m_pyramid[i-1].data();
-        dst = m_pyramid[i].data();
-        if (!currentSrcRect.isEmpty()) {
-            currentSrcRect = downsampleByFactor2(currentSrcRect, src, dst);
+        m_dirtyRegions[i] += info->dirtyImageRectVar;
+    }
+}
+
+void KisImagePyramid::updatePlanes(const QRect &rect, int index)
+{
+    for (int i = FIRST_NOT_ORIGINAL_INDEX; i <= index; i++) {
+        const QRegion dirtyRegion = m_dirtyRegions[i] & rect;
+        if (dirtyRegion.isEmpty()) continue;
+
+        /**
+         * The dirty regions are stored in the coordinates of the original
+         * plane, and the rect is aligned to the pixels of the plane
+         * \p index, so all the pixels of the plane i - 1 needed for the
+         * downsampling have been updated on the previous step
+         */
+        for (const QRect &rc : dirtyRegion) {
+            const QRect srcRect = alignRectOut(rc, 1 << i);
+            const int srcScale = 1 << (i - 1);
+
+            downsampleByFactor2(QRect(srcRect.x() / srcScale, srcRect.y() / srcScale,
+                                      srcRect.width() / srcScale, srcRect.height() / srcScale),
+                                m_pyramid[i - 1].data(), m_pyramid[i].data());
         }
+
+        m_dirtyRegions[i] -= dirtyRegion;
     }
 
 #ifdef DEBUG_PYRAMID
@@ -325,71 +381,41 @@ QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
     if (srcWidth < 1) return QRect();
     if (srcHeight < 1) return QRect();
 
-    qint32 dstX = srcX / 2;
-    qint32 dstY = srcY / 2;
-    qint32 dstWidth = srcWidth / 2;
-    qint32 dstHeight = srcHeight / 2;
+    const QRect dstRect(srcX / 2, srcY / 2, srcWidth / 2, srcHeight / 2);
 
-    KisHLineConstIteratorSP srcIt0 = src->createHLineConstIteratorNG(srcX, srcY, srcWidth);
-    KisHLineConstIteratorSP srcIt1 = src->createHLineConstIteratorNG(srcX, srcY + 1, srcWidth);
-    KisHLineIteratorSP dstIt = dst->createHLineIteratorNG(dstX, dstY, dstWidth);
+    /**
+     * Every patch of the destination plane is processed by its own thread.
+     * The patches are aligned to the tiles, so the writes never overlap.
+     */
+    QVector<QRect> patches = KritaUtils::splitRectIntoPatches(dstRect, QSize(PATCH_SIZE, PATCH_SIZE));
 
-    int conseqPixels = 0;
-    for (int row = 0; row < dstHeight; ++row) {
-        do {
-            int srcItConseq = srcIt0->nConseqPixels();
-            int dstItConseq = dstIt->nConseqPixels();
-            conseqPixels = qMin(srcItConseq, dstItConseq * 2);
+    const int pixelSize = m_monitorColorSpace->pixelSize();
 
-            Q_ASSERT(!isOdd(conseqPixels));
+    QtConcurrent::blockingMap(patches,
+        [this, src, dst, pixelSize] (const QRect &dstPatch) {
+            const QRect srcPatch(2 * dstPatch.x(), 2 * dstPatch.y(),
+                                 2 * dstPatch.width(), 2 * dstPatch.height());
 
-            downsamplePixels(srcIt0->oldRawData(), srcIt1->oldRawData(),
-                             dstIt->rawData(), conseqPixels);
+            QScopedArrayPointer<quint8> srcBytes(new quint8[srcPatch.width() * srcPatch.height() * pixelSize]);
+            QScopedArrayPointer<quint8> dstBytes(new quint8[dstPatch.width() * dstPatch.height() * pixelSize]);
 
+            src->readBytes(srcBytes.data(), srcPatch);
 
-            srcIt1->nextPixels(conseqPixels);
-            dstIt->nextPixels(conseqPixels / 2);
-        } while (srcIt0->nextPixels(conseqPixels));
-        srcIt0->nextRow();
-        srcIt0->nextRow();
-        srcIt1->nextRow();
-        srcIt1->nextRow();
-        dstIt->nextRow();
-    }
-    return QRect(dstX, dstY, dstWidth, dstHeight);
-}
+            const int srcRowStride = srcPatch.width() * pixelSize;
+            const int dstRowStride = dstPatch.width() * pixelSize;
 
-void  KisImagePyramid::downsamplePixels(const quint8 *srcRow0,
-                                        const quint8 *srcRow1,
-                                        quint8 *dstRow,
-                                        qint32 numSrcPixels)
-{
-    /**
-     * FIXME (mandatory): Use SSE and friends here.
-     */
+            for (int row = 0; row < dstPatch.height(); row++) {
+                const quint8 *srcRow0 = srcBytes.data() + 2 * row * srcRowStride;
 
-    qint16 b = 0;
-    qint16 g = 0;
-    qint16 r = 0;
-    qint16 a = 0;
-
-    static const qint32 pixelSize = 4; // This is preview argb8 mode
-
-    for (qint32 i = 0; i < numSrcPixels / 2; i++) {
-        b = srcRow0[0] + srcRow1[0] + srcRow0[4] + srcRow1[4];
-        g = srcRow0[1] + srcRow1[1] + srcRow0[5] + srcRow1[5];
-        r = srcRow0[2] + srcRow1[2] + srcRow0[6] + srcRow1[6];
-        a = srcRow0[3] + srcRow1[3] + srcRow0[7] + srcRow1[7];
+                m_downsampler->downsampleRows(srcRow0, srcRow0 + srcRowStride,
+                                              dstBytes.data() + row * dstRowStride,
+                                              dstPatch.width());
+            }
 
-        dstRow[0] = b / 4;
-        dstRow[1] = g / 4;
-        dstRow[2] = r / 4;
-        dstRow[3] = a / 4;
+            dst->writeBytes(dstBytes.data(), dstPatch);
+        });
 
-        dstRow += pixelSize;
-        srcRow0 += 2 * pixelSize;
-        srcRow1 += 2 * pixelSize;
-    }
+    return dstRect;
 }
 
 int KisImagePyramid::findFirstGoodPlaneIndex(qreal scale,
@@ -455,6 +481,13 @@ KisImagePatch KisImagePyramid::getNearestPatch(KisPPUpdateInfoSP info)
 
     alignByPow2Hi(info->borderWidth, alignment);
 
+    if (index > ORIGINAL_INDEX) {
+        updatePlanes(alignRectOut(info->imageRect.adjusted(-info->borderWidth, -info->borderWidth,
+                                                           info->borderWidth, info->borderWidth),
+                                  alignment),
+                     index);
+    }
+
     KisImagePatch patch(info->imageRect, info->borderWidth,
                         planeScale, planeScale);
 
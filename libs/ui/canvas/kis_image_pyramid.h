@@ -8,6 +8,8 @@
 #define __KIS_IMAGE_PYRAMID
 
 #include <QImage>
+#include <QRegion>
+#include <QScopedPointer>
 #include <QVector>
 #include <QThreadStorage>
 
@@ -16,6 +18,7 @@
 #include <kis_paint_device.h>
 #include "kis_projection_backend.h"
 
+class KoOptimizedBoxDownsamplerU8Base;
 
 class KisImagePyramid : QObject, public KisProjectionBackend
 {
@@ -64,6 +67,7 @@ public:
 private:
 
     void retrieveImageData(const QRect &rect);
+    void convertPatch(const QRect &rect, bool showSingleChannelAsColor);
     void rebuildPyramid();
     void clearPyramid();
 
@@ -76,12 +80,11 @@ private:
                               KisPaintDevice* src, KisPaintDevice* dst);
 
     /**
-     * Auxiliary function. Downsamples two lines in @srcRow0
-     * and @srcRow1 into one line @dstRow
-     * Note: @numSrcPixels must be EVEN
+     * Regenerates the dirty parts of the planes up to @index
+     * that intersect @rect. @rect is in the coordinates of
+     * the original plane.
      */
-    void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
-                          quint8 *dstRow, qint32 numSrcPixels);
+    void updatePlanes(const QRect &rect, int index);
 
     /**
      * Searches for the last pyramid plane that can cover
@@ -120,6 +123,15 @@ private:
      */
     qint32 m_pyramidHeight {0};
 
+    /**
+     * The areas of every plane that should be regenerated from
+     * the previous plane before use, in the coordinates of the
+     * original plane
+     */
+    QVector<QRegion> m_dirtyRegions;
+
+    QScopedPointer<KoOptimizedBoxDownsamplerU8Base> m_downsampler;
+
     bool m_useOcio {false};
 
     QBitArray m_channelFlags;
@@ -83,9 +83,9 @@ KisPrescaledProjection::KisPrescaledProjection()
 {
     updateSettings();
 
-    // we disable building the pyramid with setting its height to 1
-    // XXX: setting it higher than 1 is broken because it's not updated until you show/hide the layer
-    m_d->projectionBackend = new KisImagePyramid(1);
+    // the downsampled planes are regenerated lazily, only for
+    // the patches that are actually painted
+    m_d->projectionBackend = new KisImagePyramid(4);
 
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(updateSettings()));
 }
@@ -90,13 +90,18 @@ public:
         : KisShapeLayerCanvasBase(parent)
         , m_layer(parent)
         , m_fallbackProjection(new KisPaintDevice(parent, cs, defaultBounds))
-    {}
+    {
+        // the references are painted on every update of the decoration
+        m_shapeManager->setRasterCacheEnabled(true);
+    }
 
     ReferenceImagesCanvas(const ReferenceImagesCanvas &rhs, KisReferenceImagesLayer *parent)
         : KisShapeLayerCanvasBase(rhs, parent)
         , m_layer(parent)
         , m_fallbackProjection(new KisPaintDevice(*rhs.m_fallbackProjection))
-    {}
+    {
+        m_shapeManager->setRasterCacheEnabled(true);
+    }
 
     void updateCanvas(const QRectF &rect) override
     {
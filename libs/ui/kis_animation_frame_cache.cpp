@@ -299,7 +299,13 @@ KisOpenGLUpdateInfoSP KisAnimationFrameCache::Private::fetchFrameDataImpl(KisIma
         const QRect fetchRect = KisLodTransform::alignedRect(requestedRect, lod);
         return textures->updateInfoBuilder().buildUpdateInfo(fetchRect, tempDevice, image->bounds(), lod, true);
     } else {
-        return textures->updateCache(requestedRect, image);
+        /**
+         * Don't use updateCache() here, it would pack the tiles into the
+         * staging ring of the textures, and the cached frames keep their
+         * infos, with the staging buffers, until they are shown. A few
+         * cached frames would exhaust the ring for the canvas updates.
+         */
+        return textures->updateInfoBuilder().buildUpdateInfo(requestedRect, image, true);
     }
 }
 
@@ -25,6 +25,11 @@
 #include <QBuffer>
 #include <QFile>
 #include <QApplication>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <QtEndian>
+
+#include <functional>
 
 #include <klocalizedstring.h>
 #include <QUrl>
@@ -899,6 +904,261 @@ bool KisPNGConverter::saveDeviceToStore(const QString &filename, const QRect &im
 }
 
 
+namespace {
+
+/**
+ * The rows of the image are encoded in bands, every band is
+ * filtered and deflated independently by a separate job. The bands
+ * are aligned to the tiles of the paint device and are big enough to
+ * keep the overhead of the sync flush markers negligible.
+ */
+const int PngBandAlignment = 64;
+const int PngBandTargetBytes = 1 << 20;
+
+/**
+ * The deflate window, the end of the previous band is used as the
+ * preset dictionary of the next one, so the bands are compressed
+ * almost as well as a single stream
+ */
+const int PngDictionarySize = 32768;
+
+typedef std::function<bool(int, quint8*)> PngRowConverter;
+
+struct PngBandJob
+{
+    int firstRow {0};
+    int numRows {0};
+    bool isLast {false};
+
+    QByteArray compressed;
+    uLong adler {0};
+    uLong length {0};
+    bool success {false};
+};
+
+inline int pngFilterCost(quint8 value)
+{
+    return value < 128 ? value : 256 - value;
+}
+
+inline quint8 pngPaethPredictor(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = qAbs(p - a);
+    const int pb = qAbs(p - b);
+    const int pc = qAbs(p - c);
+
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+/**
+ * Filters a single row of the image choosing the filter with the minimal
+ * sum of absolute differences, which is the heuristic libpng uses
+ *
+ * @param prevRow the previous unfiltered row, null for the first row
+ * @param dst the filtered row, rowBytes + 1 bytes long
+ */
+void pngFilterRow(const quint8 *row, const quint8 *prevRow, int rowBytes, int bpp,
+                  bool adaptiveFiltering, quint8 *dst, QVector<quint8> &scratch)
+{
+    if (!adaptiveFiltering) {
+        dst[0] = PNG_FILTER_VALUE_NONE;
+        memcpy(dst + 1, row, rowBytes);
+        return;
+    }
+
+    scratch.resize(4 * rowBytes);
+    quint8 *candidates[5] = {
+        const_cast<quint8*>(row),
+        scratch.data(),
+        scratch.data() + rowBytes,
+        scratch.data() + 2 * rowBytes,
+        scratch.data() + 3 * rowBytes
+    };
+
+    int costs[5] = {0, 0, 0, 0, 0};
+
+    for (int i = 0; i < rowBytes; i++) {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = prevRow ? prevRow[i] : 0;
+        const int c = prevRow && i >= bpp ? prevRow[i - bpp] : 0;
+        const int x = row[i];
+
+        candidates[1][i] = quint8(x - a);
+        candidates[2][i] = quint8(x - b);
+        candidates[3][i] = quint8(x - ((a + b) >> 1));
+        candidates[4][i] = quint8(x - pngPaethPredictor(a, b, c));
+
+        for (int f = 0; f < 5; f++) {
+            costs[f] += pngFilterCost(candidates[f][i]);
+        }
+    }
+
+    int best = 0;
+    for (int f = 1; f < 5; f++) {
+        if (costs[f] < costs[best]) {
+            best = f;
+        }
+    }
+
+    dst[0] = quint8(best);
+    memcpy(dst + 1, candidates[best], rowBytes);
+}
+
+/**
+ * Converts, filters and deflates a band of rows into a raw deflate
+ * stream. All the bands but the last one end with a sync flush, so
+ * their concatenation is a valid deflate stream.
+ */
+void pngEncodeBand(PngBandJob &job, const PngRowConverter &convertRow,
+                   int rowBytes, int bpp, bool adaptiveFiltering,
+                   bool swapBytes, int compressionLevel)
+{
+    const int filteredRowBytes = rowBytes + 1;
+
+    /**
+     * The dictionary should match the previous band exactly, so the
+     * rows it is made of are filtered again here. Filtering the first
+     * of them needs one more unfiltered row.
+     */
+    const int dictionaryRows = qMin(job.firstRow, (PngDictionarySize + filteredRowBytes - 1) / filteredRowBytes);
+    const int firstConvertedRow = qMax(0, job.firstRow - dictionaryRows - 1);
+    const int numConvertedRows = job.firstRow + job.numRows - firstConvertedRow;
+    const int numFilteredRows = dictionaryRows + job.numRows;
+
+    QVector<quint8> rows(numConvertedRows * rowBytes);
+    for (int i = 0; i < numConvertedRows; i++) {
+        quint8 *row = rows.data() + i * rowBytes;
+        if (!convertRow(firstConvertedRow + i, row)) return;
+
+        if (swapBytes) {
+            quint16 *values = reinterpret_cast<quint16*>(row);
+            for (int j = 0; j < rowBytes / 2; j++) {
+                values[j] = qToBigEndian(values[j]);
+            }
+        }
+    }
+
+    QVector<quint8> filtered(numFilteredRows * filteredRowBytes);
+    QVector<quint8> scratch;
+
+    for (int i = 0; i < numFilteredRows; i++) {
+        const int row = job.firstRow - dictionaryRows + i;
+        const int rowIndex = row - firstConvertedRow;
+
+        pngFilterRow(rows.constData() + rowIndex * rowBytes,
+                     row > 0 ? rows.constData() + (rowIndex - 1) * rowBytes : nullptr,
+                     rowBytes, bpp, adaptiveFiltering,
+                     filtered.data() + i * filteredRowBytes, scratch);
+    }
+
+    rows.clear();
+
+    const quint8 *data = filtered.constData() + dictionaryRows * filteredRowBytes;
+    job.length = uLong(job.numRows) * filteredRowBytes;
+    job.adler = adler32(adler32(0L, Z_NULL, 0), data, job.length);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return;
+    }
+
+    if (dictionaryRows > 0) {
+        const int dictionarySize = qMin(PngDictionarySize, dictionaryRows * filteredRowBytes);
+        deflateSetDictionary(&stream, data - dictionarySize, dictionarySize);
+    }
+
+    // the sync flush marker and the final empty block need a few extra bytes
+    job.compressed.resize(int(deflateBound(&stream, job.length)) + 16);
+
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = job.length;
+    stream.next_out = reinterpret_cast<Bytef*>(job.compressed.data());
+    stream.avail_out = job.compressed.size();
+
+    const int result = deflate(&stream, job.isLast ? Z_FINISH : Z_SYNC_FLUSH);
+    const bool isComplete = job.isLast ? result == Z_STREAM_END : (result == Z_OK && stream.avail_in == 0);
+
+    job.compressed.resize(job.compressed.size() - int(stream.avail_out));
+    deflateEnd(&stream);
+
+    job.success = isComplete;
+}
+
+/**
+ * Writes the image data as a single zlib stream split into IDAT chunks,
+ * one chunk per band. The bands are encoded in parallel in groups of
+ * a few bands, so only the group being encoded is kept in memory.
+ */
+bool pngWriteImageDataParallel(png_structp png_ptr, const QSize &size,
+                               const PngRowConverter &convertRow,
+                               int rowBytes, int bpp, bool adaptiveFiltering,
+                               bool swapBytes, int compressionLevel)
+{
+    const int bandRows = qMax(PngBandAlignment,
+                              (PngBandTargetBytes / qMax(1, rowBytes) + PngBandAlignment - 1)
+                              / PngBandAlignment * PngBandAlignment);
+
+    const int groupSize = qMax(2, QThread::idealThreadCount());
+    const png_byte idat[5] = { 'I', 'D', 'A', 'T', '\0' };
+
+    // zlib header, the level flags are informational only
+    const int levelFlags = compressionLevel < 2 ? 0 : compressionLevel < 6 ? 1 : compressionLevel == 6 ? 2 : 3;
+    const quint8 cmf = 0x78;
+    quint8 flg = quint8(levelFlags << 6);
+    flg += 31 - (cmf * 256 + flg) % 31;
+
+    uLong adler = adler32(0L, Z_NULL, 0);
+
+    for (int groupStart = 0; groupStart < size.height(); groupStart += groupSize * bandRows) {
+        QVector<PngBandJob> jobs;
+
+        for (int row = groupStart;
+             row < size.height() && row < groupStart + groupSize * bandRows;
+             row += bandRows) {
+
+            PngBandJob job;
+            job.firstRow = row;
+            job.numRows = qMin(bandRows, size.height() - row);
+            job.isLast = row + job.numRows >= size.height();
+            jobs << job;
+        }
+
+        QtConcurrent::blockingMap(jobs,
+            [&] (PngBandJob &job) {
+                pngEncodeBand(job, convertRow, rowBytes, bpp, adaptiveFiltering,
+                              swapBytes, compressionLevel);
+            });
+
+        for (const PngBandJob &job : jobs) {
+            if (!job.success) return false;
+
+            QByteArray chunk;
+
+            if (job.firstRow == 0) {
+                chunk.append(char(cmf));
+                chunk.append(char(flg));
+            }
+
+            chunk.append(job.compressed);
+            adler = adler32_combine(adler, job.adler, job.length);
+
+            if (job.isLast) {
+                const quint32 adlerBE = qToBigEndian(quint32(adler));
+                chunk.append(reinterpret_cast<const char*>(&adlerBE), sizeof(adlerBE));
+            }
+
+            png_write_chunk(png_ptr, idat, reinterpret_cast<png_const_bytep>(chunk.constData()), chunk.size());
+        }
+    }
+
+    return true;
+}
+
+}
+
 KisImportExportErrorCode KisPNGConverter::buildFile(const QString &filename, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP device, vKisAnnotationSP_it annotationsStart, vKisAnnotationSP_it annotationsEnd, KisPNGOptions options, KisMetaData::Store* metaData)
 {
     dbgFile << "Start writing PNG File " << filename;
@@ -1307,48 +1567,20 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
     // Write the PNG
     //     png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, 0);
 
-    struct RowPointersStruct {
-        RowPointersStruct(const QSize &size, int pixelSize)
-            : numRows(size.height())
-        {
-            rows = new png_byte*[numRows];
-
-            for (int i = 0; i < numRows; i++) {
-                rows[i] = new png_byte[size.width() * pixelSize];
-            }
-        }
-
-        ~RowPointersStruct() {
-            for (int i = 0; i < numRows; i++) {
-                delete[] rows[i];
-            }
-            delete[] rows;
-        }
-
-        const int numRows = 0;
-        png_byte** rows = 0;
-    };
-
-
-    // Fill the data structure
-    RowPointersStruct rowPointers(imageRect.size(), device->pixelSize());
-
-    int row = 0;
-    for (int y = imageRect.y(); y < imageRect.y() + imageRect.height(); y++, row++) {
-        KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(imageRect.x(), y, imageRect.width());
+    auto convertRow = [&] (int row, quint8 *dst) {
+        KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(imageRect.x(), imageRect.y() + row, imageRect.width());
 
         switch (color_type) {
         case PNG_COLOR_TYPE_GRAY:
         case PNG_COLOR_TYPE_GRAY_ALPHA:
             if (color_nb_bits == 16) {
-                quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
+                quint16 *dst16 = reinterpret_cast<quint16 *>(dst);
                 do {
                     const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
-                    *(dst++) = d[0];
-                    if (options.alpha) *(dst++) = d[1];
+                    *(dst16++) = d[0];
+                    if (options.alpha) *(dst16++) = d[1];
                 } while (it->nextPixel());
             } else {
-                quint8 *dst = rowPointers.rows[row];
                 do {
                     const quint8 *d = it->oldRawData();
                     *(dst++) = d[0];
@@ -1359,16 +1591,15 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
         case PNG_COLOR_TYPE_RGB:
         case PNG_COLOR_TYPE_RGB_ALPHA:
             if (color_nb_bits == 16) {
-                quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
+                quint16 *dst16 = reinterpret_cast<quint16 *>(dst);
                 do {
                     const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
-                    *(dst++) = d[2];
-                    *(dst++) = d[1];
-                    *(dst++) = d[0];
-                    if (options.alpha) *(dst++) = d[3];
+                    *(dst16++) = d[2];
+                    *(dst16++) = d[1];
+                    *(dst16++) = d[0];
+                    if (options.alpha) *(dst16++) = d[3];
                 } while (it->nextPixel());
             } else {
-                quint8 *dst = rowPointers.rows[row];
                 do {
                     const quint8 *d = it->oldRawData();
                     *(dst++) = d[2];
@@ -1379,7 +1610,6 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
             }
             break;
         case PNG_COLOR_TYPE_PALETTE: {
-            quint8 *dst = rowPointers.rows[row];
             KisPNGWriteStream writestream(dst, color_nb_bits);
             do {
                 const quint8 *d = it->oldRawData();
@@ -1396,6 +1626,73 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
         }
             break;
         default:
+            return false;
+        }
+
+        return true;
+    };
+
+    /**
+     * Adam7 interlacing reorders the pixels, so the interlaced images
+     * are still written by libpng from a buffer holding the whole image
+     */
+    if (options.parallelEncoding && interlace_type == PNG_INTERLACE_NONE) {
+        const int numChannels = png_get_channels(png_ptr, info_ptr);
+        const int rowBytes = int(png_get_rowbytes(png_ptr, info_ptr));
+        const int bpp = qMax(1, numChannels * color_nb_bits / 8);
+
+        // libpng doesn't filter the indexed and low bit depth images either
+        const bool adaptiveFiltering = color_type != PNG_COLOR_TYPE_PALETTE && color_nb_bits >= 8;
+
+#ifndef WORDS_BIGENDIAN
+        const bool swapBytes = color_nb_bits > 8;
+#else
+        const bool swapBytes = false;
+#endif
+
+        if (!pngWriteImageDataParallel(png_ptr, imageRect.size(), convertRow,
+                                       rowBytes, bpp, adaptiveFiltering,
+                                       swapBytes, options.compression)) {
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return ImportExportCodes::Failure;
+        }
+
+        // png_write_end() refuses to work without the IDAT chunks written by libpng itself
+        const png_byte iend[5] = { 'I', 'E', 'N', 'D', '\0' };
+        png_write_chunk(png_ptr, iend, nullptr, 0);
+
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return ImportExportCodes::OK;
+    }
+
+    struct RowPointersStruct {
+        RowPointersStruct(const QSize &size, int pixelSize)
+            : numRows(size.height())
+        {
+            rows = new png_byte*[numRows];
+
+            for (int i = 0; i < numRows; i++) {
+                rows[i] = new png_byte[size.width() * pixelSize];
+            }
+        }
+
+        ~RowPointersStruct() {
+            for (int i = 0; i < numRows; i++) {
+                delete[] rows[i];
+            }
+            delete[] rows;
+        }
+
+        const int numRows = 0;
+        png_byte** rows = 0;
+    };
+
+
+    // Fill the data structure
+    RowPointersStruct rowPointers(imageRect.size(), device->pixelSize());
+
+    for (int row = 0; row < imageRect.height(); row++) {
+        if (!convertRow(row, rowPointers.rows[row])) {
             return ImportExportCodes::FormatColorSpaceUnsupported;
         }
     }
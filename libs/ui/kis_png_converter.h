@@ -45,6 +45,7 @@ struct KisPNGOptions {
         , saveAsHDR(false)
         , transparencyFillColor(Qt::white)
         , downsample(false)
+        , parallelEncoding(true)
     {}
 
     int compression;
@@ -62,6 +63,7 @@ struct KisPNGOptions {
     QList<const KisMetaData::Filter*> filters;
     QColor transparencyFillColor;
     bool downsample; // Converts to 8 bit on export
+    bool parallelEncoding; // Filters and deflates the rows in parallel, ignored for interlaced images
 };
 
 /**
@@ -288,9 +288,10 @@ void KisStatusBar::updateMemoryStatus()
                   "Memory used:\t %1 / %2\n"
                   "  image data:\t %3 / %4\n"
                   "  pool:\t\t %5 / %6\n"
-                  "  undo data:\t %7\n"
+                  "  undo data:\t %7 / %8\n"
                   "\n"
-                  "Swap used:\t %8",
+                  "Swap used:\t %9\n"
+                  "  shared undo data:\t %10",
                   format.formatByteSize(stats.totalMemorySize),
                   format.formatByteSize(stats.totalMemoryLimit),
 
@@ -301,7 +302,9 @@ void KisStatusBar::updateMemoryStatus()
                   format.formatByteSize(stats.tilesPoolLimit),
 
                   format.formatByteSize(stats.historicalMemorySize),
-                  format.formatByteSize(stats.swapSize));
+                  format.formatByteSize(stats.historyLimit),
+                  format.formatByteSize(stats.swapSize),
+                  format.formatByteSize(stats.swapDeduplicatedSize));
 
     QString longStats = imageStatsMsg + "\n" + memoryStatsMsg;
 
@@ -0,0 +1,192 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisOpenGLTextureUploadBackend.h"
+
+#include <QHash>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+#include "kis_assert.h"
+#include "kis_debug.h"
+#include "kis_opengl.h"
+#include "kis_texture_tile.h"
+#include "KisOpenGLSync.h"
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace {
+typedef void (QOPENGLF_APIENTRYP kis_glBufferStorage)(GLenum, GLsizeiptr, const void*, GLbitfield);
+typedef void* (QOPENGLF_APIENTRYP kis_glMapBufferRange)(GLenum, GLintptr, GLsizeiptr, GLbitfield);
+typedef GLboolean (QOPENGLF_APIENTRYP kis_glUnmapBuffer)(GLenum);
+}
+
+struct Q_DECL_HIDDEN KisOpenGLTextureUploadBackend::Private
+{
+    QOpenGLFunctions *f = nullptr;
+    const KisGLTexturesInfo *texturesInfo = nullptr;
+
+    kis_glBufferStorage glBufferStorage = nullptr;
+    kis_glMapBufferRange glMapBufferRange = nullptr;
+    kis_glUnmapBuffer glUnmapBuffer = nullptr;
+
+    QVector<GLuint> buffers;
+
+    int nextFence = 0;
+    QHash<int, QSharedPointer<KisOpenGLSync>> fences;
+};
+
+KisOpenGLTextureUploadBackend::KisOpenGLTextureUploadBackend(QOpenGLContext *ctx, const KisGLTexturesInfo *texturesInfo)
+    : m_d(new Private)
+{
+    m_d->f = ctx->functions();
+    m_d->texturesInfo = texturesInfo;
+
+    m_d->glBufferStorage = (kis_glBufferStorage)ctx->getProcAddress("glBufferStorage");
+    if (!m_d->glBufferStorage) {
+        m_d->glBufferStorage = (kis_glBufferStorage)ctx->getProcAddress("glBufferStorageEXT");
+    }
+
+    m_d->glMapBufferRange = (kis_glMapBufferRange)ctx->getProcAddress("glMapBufferRange");
+    if (!m_d->glMapBufferRange) {
+        m_d->glMapBufferRange = (kis_glMapBufferRange)ctx->getProcAddress("glMapBufferRangeEXT");
+    }
+
+    m_d->glUnmapBuffer = (kis_glUnmapBuffer)ctx->getProcAddress("glUnmapBuffer");
+    if (!m_d->glUnmapBuffer) {
+        m_d->glUnmapBuffer = (kis_glUnmapBuffer)ctx->getProcAddress("glUnmapBufferOES");
+    }
+}
+
+KisOpenGLTextureUploadBackend::~KisOpenGLTextureUploadBackend()
+{
+    releaseBuffers();
+}
+
+bool KisOpenGLTextureUploadBackend::isSupported(QOpenGLContext *ctx)
+{
+    if (!ctx || !KisOpenGL::supportsFenceSync() || !KisOpenGL::supportsBufferMapping()) {
+        return false;
+    }
+
+    const QSurfaceFormat format = ctx->format();
+
+    return ctx->hasExtension("GL_ARB_buffer_storage") ||
+        ctx->hasExtension("GL_EXT_buffer_storage") ||
+        (!ctx->isOpenGLES() && format.version() >= qMakePair(4, 4));
+}
+
+QVector<quint8*> KisOpenGLTextureUploadBackend::allocateBuffers(int numBuffers, int bufferSize)
+{
+    QVector<quint8*> result;
+
+    if (!m_d->glBufferStorage || !m_d->glMapBufferRange || !m_d->glUnmapBuffer) {
+        return result;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    m_d->buffers.resize(numBuffers);
+    m_d->f->glGenBuffers(numBuffers, m_d->buffers.data());
+
+    for (int i = 0; i < numBuffers; i++) {
+        m_d->f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_d->buffers[i]);
+        m_d->glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, flags);
+
+        void *ptr = m_d->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags);
+        if (!ptr) {
+            warnUI << "Failed to map a texture staging buffer persistently, falling back to synchronous uploads";
+            break;
+        }
+
+        result << reinterpret_cast<quint8*>(ptr);
+    }
+
+    m_d->f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (result.size() != numBuffers) {
+        releaseBuffers();
+        result.clear();
+    }
+
+    return result;
+}
+
+void KisOpenGLTextureUploadBackend::releaseBuffers()
+{
+    m_d->fences.clear();
+
+    if (m_d->buffers.isEmpty()) return;
+
+    // the buffers die together with the context otherwise
+    if (QOpenGLContext::currentContext()) {
+        for (int i = 0; i < m_d->buffers.size(); i++) {
+            m_d->f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_d->buffers[i]);
+            m_d->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        m_d->f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        m_d->f->glDeleteBuffers(m_d->buffers.size(), m_d->buffers.constData());
+    }
+
+    m_d->buffers.clear();
+}
+
+void KisOpenGLTextureUploadBackend::copyToTexture(int bufferIndex, const KisTextureUploadCommand &command)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(bufferIndex >= 0 && bufferIndex < m_d->buffers.size());
+
+    const GLvoid *fd = reinterpret_cast<const GLvoid*>(static_cast<quintptr>(command.offset));
+
+    m_d->f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_d->buffers[bufferIndex]);
+
+    if (command.allocateLevel) {
+        m_d->f->glTexImage2D(GL_TEXTURE_2D, command.levelOfDetail,
+                             m_d->texturesInfo->internalFormat,
+                             command.rect.width(),
+                             command.rect.height(), 0,
+                             m_d->texturesInfo->format,
+                             m_d->texturesInfo->type,
+                             fd);
+    } else {
+        m_d->f->glTexSubImage2D(GL_TEXTURE_2D, command.levelOfDetail,
+                                command.rect.x(), command.rect.y(),
+                                command.rect.width(), command.rect.height(),
+                                m_d->texturesInfo->format,
+                                m_d->texturesInfo->type,
+                                fd);
+    }
+
+    m_d->f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+int KisOpenGLTextureUploadBackend::insertFence()
+{
+    const int fence = m_d->nextFence++;
+    m_d->fences.insert(fence, QSharedPointer<KisOpenGLSync>(new KisOpenGLSync()));
+    return fence;
+}
+
+bool KisOpenGLTextureUploadBackend::isFenceSignaled(int fence)
+{
+    QSharedPointer<KisOpenGLSync> sync = m_d->fences.value(fence);
+    return !sync || sync->isSignaled();
+}
+
+void KisOpenGLTextureUploadBackend::releaseFence(int fence)
+{
+    m_d->fences.remove(fence);
+}
@@ -0,0 +1,53 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISOPENGLTEXTUREUPLOADBACKEND_H
+#define KISOPENGLTEXTUREUPLOADBACKEND_H
+
+#include <QScopedPointer>
+
+#include "KisTextureUploadStagingRing.h"
+
+class QOpenGLContext;
+struct KisGLTexturesInfo;
+
+
+/**
+ * The staging buffers of KisTextureUploadStagingRing implemented as
+ * pixel unpack buffers, persistently mapped with glBufferStorage(), so the
+ * worker threads may write into them while the GPU is reading the buffers
+ * uploaded before. The buffers are mapped coherently, so no explicit flush
+ * is needed.
+ */
+class KisOpenGLTextureUploadBackend : public KisTextureUploadBackend
+{
+public:
+    /**
+     * @param texturesInfo the format of the textures the data is copied
+     * into, the pointer should stay valid during the lifetime of the backend
+     */
+    KisOpenGLTextureUploadBackend(QOpenGLContext *ctx, const KisGLTexturesInfo *texturesInfo);
+    ~KisOpenGLTextureUploadBackend() override;
+
+    /**
+     * @return true if \p ctx can map the buffers persistently and has
+     * fence sync objects to know when the buffers can be reused
+     */
+    static bool isSupported(QOpenGLContext *ctx);
+
+    QVector<quint8*> allocateBuffers(int numBuffers, int bufferSize) override;
+    void releaseBuffers() override;
+    void copyToTexture(int bufferIndex, const KisTextureUploadCommand &command) override;
+    int insertFence() override;
+    bool isFenceSignaled(int fence) override;
+    void releaseFence(int fence) override;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISOPENGLTEXTUREUPLOADBACKEND_H
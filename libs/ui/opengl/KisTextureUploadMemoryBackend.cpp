@@ -0,0 +1,163 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTextureUploadMemoryBackend.h"
+
+#include "kis_assert.h"
+
+
+KisTextureUploadMemoryBackend::Texture::Texture(const QSize &_size, int _pixelSize)
+    : size(_size),
+      pixelSize(_pixelSize)
+{
+}
+
+QByteArray& KisTextureUploadMemoryBackend::Texture::level(int levelOfDetail)
+{
+    if (levels.size() <= levelOfDetail) {
+        levels.resize(levelOfDetail + 1);
+    }
+
+    QByteArray &result = levels[levelOfDetail];
+    const QSize levelSize = this->levelSize(levelOfDetail);
+    const int numBytes = levelSize.width() * levelSize.height() * pixelSize;
+
+    if (result.size() != numBytes) {
+        result.fill(0, numBytes);
+    }
+
+    return result;
+}
+
+QSize KisTextureUploadMemoryBackend::Texture::levelSize(int levelOfDetail) const
+{
+    return QSize(qMax(1, size.width() >> levelOfDetail),
+                 qMax(1, size.height() >> levelOfDetail));
+}
+
+const quint8* KisTextureUploadMemoryBackend::Texture::pixel(int x, int y, int levelOfDetail) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(levelOfDetail < levels.size(), nullptr);
+
+    const int width = levelSize(levelOfDetail).width();
+    return reinterpret_cast<const quint8*>(levels[levelOfDetail].constData()) +
+        (y * width + x) * pixelSize;
+}
+
+
+KisTextureUploadMemoryBackend::KisTextureUploadMemoryBackend(int pixelSize)
+    : m_pixelSize(pixelSize)
+{
+}
+
+KisTextureUploadMemoryBackend::~KisTextureUploadMemoryBackend()
+{
+}
+
+void KisTextureUploadMemoryBackend::bindTexture(Texture *texture)
+{
+    m_texture = texture;
+}
+
+void KisTextureUploadMemoryBackend::setAutoSignalFences(bool value)
+{
+    m_autoSignalFences = value;
+}
+
+void KisTextureUploadMemoryBackend::signalFences()
+{
+    m_signaledFences += m_pendingFences;
+    m_pendingFences.clear();
+}
+
+int KisTextureUploadMemoryBackend::numCopies() const
+{
+    return m_numCopies;
+}
+
+qint64 KisTextureUploadMemoryBackend::numCopiedBytes() const
+{
+    return m_numCopiedBytes;
+}
+
+int KisTextureUploadMemoryBackend::numPendingFences() const
+{
+    return m_pendingFences.size();
+}
+
+QVector<quint8*> KisTextureUploadMemoryBackend::allocateBuffers(int numBuffers, int bufferSize)
+{
+    QVector<quint8*> result;
+
+    m_buffers.resize(numBuffers);
+    for (int i = 0; i < numBuffers; i++) {
+        m_buffers[i].resize(bufferSize);
+        result << reinterpret_cast<quint8*>(m_buffers[i].data());
+    }
+
+    return result;
+}
+
+void KisTextureUploadMemoryBackend::releaseBuffers()
+{
+    m_buffers.clear();
+    m_pendingFences.clear();
+    m_signaledFences.clear();
+}
+
+void KisTextureUploadMemoryBackend::copyToTexture(int bufferIndex, const KisTextureUploadCommand &command)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(bufferIndex >= 0 && bufferIndex < m_buffers.size());
+
+    const int rowSize = command.rect.width() * m_pixelSize;
+
+    m_numCopies++;
+    m_numCopiedBytes += rowSize * command.rect.height();
+
+    if (!m_texture) return;
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_texture->pixelSize == m_pixelSize);
+
+    QByteArray &level = m_texture->level(command.levelOfDetail);
+    const QSize levelSize = m_texture->levelSize(command.levelOfDetail);
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(QRect(QPoint(), levelSize).contains(command.rect));
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!command.allocateLevel || command.rect.topLeft().isNull());
+
+    const quint8 *src = reinterpret_cast<const quint8*>(m_buffers[bufferIndex].constData()) + command.offset;
+    quint8 *dst = reinterpret_cast<quint8*>(level.data()) +
+        (command.rect.y() * levelSize.width() + command.rect.x()) * m_pixelSize;
+
+    for (int row = 0; row < command.rect.height(); row++) {
+        memcpy(dst, src, rowSize);
+        src += rowSize;
+        dst += levelSize.width() * m_pixelSize;
+    }
+}
+
+int KisTextureUploadMemoryBackend::insertFence()
+{
+    const int fence = m_nextFence++;
+
+    if (m_autoSignalFences) {
+        m_signaledFences << fence;
+    } else {
+        m_pendingFences << fence;
+    }
+
+    return fence;
+}
+
+bool KisTextureUploadMemoryBackend::isFenceSignaled(int fence)
+{
+    return m_signaledFences.contains(fence);
+}
+
+void KisTextureUploadMemoryBackend::releaseFence(int fence)
+{
+    m_signaledFences.removeAll(fence);
+    m_pendingFences.removeAll(fence);
+}
@@ -0,0 +1,85 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTEXTUREUPLOADMEMORYBACKEND_H
+#define KISTEXTUREUPLOADMEMORYBACKEND_H
+
+#include <QByteArray>
+#include <QSize>
+#include <QVector>
+
+#include "KisTextureUploadStagingRing.h"
+#include "kritaui_export.h"
+
+
+/**
+ * A texture upload backend keeping the staging buffers and the textures in
+ * the main memory. It lets the unit tests and the benchmarks exercise the
+ * CPU side of the texture uploads on the machines without a GPU.
+ *
+ * The fences are signaled immediately, unless setAutoSignalFences(false)
+ * is called. Then they are signaled by signalFences() only, which emulates
+ * a busy GPU.
+ */
+class KRITAUI_EXPORT KisTextureUploadMemoryBackend : public KisTextureUploadBackend
+{
+public:
+    /**
+     * The emulation of a texture, every level of detail is stored
+     * as a tightly packed array of pixels
+     */
+    struct Texture
+    {
+        Texture(const QSize &size, int pixelSize);
+
+        QByteArray& level(int levelOfDetail);
+        QSize levelSize(int levelOfDetail) const;
+
+        const quint8* pixel(int x, int y, int levelOfDetail = 0) const;
+
+        QSize size;
+        int pixelSize = 0;
+        QVector<QByteArray> levels;
+    };
+
+    KisTextureUploadMemoryBackend(int pixelSize);
+    ~KisTextureUploadMemoryBackend() override;
+
+    /**
+     * Emulates binding of \p texture to GL_TEXTURE_2D. If no texture is
+     * bound, the copies are only counted.
+     */
+    void bindTexture(Texture *texture);
+
+    void setAutoSignalFences(bool value);
+    void signalFences();
+
+    int numCopies() const;
+    qint64 numCopiedBytes() const;
+    int numPendingFences() const;
+
+    QVector<quint8*> allocateBuffers(int numBuffers, int bufferSize) override;
+    void releaseBuffers() override;
+    void copyToTexture(int bufferIndex, const KisTextureUploadCommand &command) override;
+    int insertFence() override;
+    bool isFenceSignaled(int fence) override;
+    void releaseFence(int fence) override;
+
+private:
+    int m_pixelSize = 0;
+    QVector<QByteArray> m_buffers;
+    Texture *m_texture = nullptr;
+
+    bool m_autoSignalFences = true;
+    int m_nextFence = 0;
+    QVector<int> m_pendingFences;
+    QVector<int> m_signaledFences;
+
+    int m_numCopies = 0;
+    qint64 m_numCopiedBytes = 0;
+};
+
+#endif // KISTEXTUREUPLOADMEMORYBACKEND_H
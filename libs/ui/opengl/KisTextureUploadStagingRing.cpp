@@ -0,0 +1,444 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTextureUploadStagingRing.h"
+
+#include <algorithm>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include "kis_assert.h"
+#include "kis_texture_tile_update_info.h"
+
+
+namespace {
+
+/**
+ * The border stripes of a tile lying on the edge of the image. The pixels
+ * of the stripes repeat the edge pixels of the patch, so that the bilinear
+ * interpolation would not fetch garbage from the outside of the image.
+ *
+ * The stripes cover exactly the same texels as the ones filled by
+ * KisTextureTile::update() when no staging buffer is used.
+ */
+struct BorderStripes
+{
+    QRect top;
+    QRect bottom;
+    QRect left;
+    QRect right;
+};
+
+BorderStripes borderStripes(const KisTextureTileUpdateInfo &info)
+{
+    const QSize patchSize = info.realPatchSize();
+    const QPoint patchOffset = info.realPatchOffset();
+    const QSize tileSize = info.realTileSize();
+
+    BorderStripes stripes;
+
+    if (info.isTopmost()) {
+        stripes.top = QRect(patchOffset.x(), 0,
+                            patchSize.width(), patchOffset.y());
+    }
+
+    if (info.isBottommost()) {
+        const int start = patchOffset.y() + patchSize.height();
+        stripes.bottom = QRect(patchOffset.x(), start,
+                               patchSize.width(), tileSize.height() - 1 - start);
+    }
+
+    if (info.isLeftmost()) {
+        stripes.left = QRect(0, patchOffset.y(),
+                             patchOffset.x(), patchSize.height());
+    }
+
+    if (info.isRightmost()) {
+        const int start = patchOffset.x() + patchSize.width();
+        stripes.right = QRect(start, patchOffset.y(),
+                              tileSize.width() - start, patchSize.height());
+    }
+
+    return stripes;
+}
+
+inline int rectBytes(const QRect &rc, int pixelSize)
+{
+    return rc.isEmpty() ? 0 : rc.width() * rc.height() * pixelSize;
+}
+
+/**
+ * Fills a stripe whose every row is a copy of \p srcRow
+ */
+quint8* fillRows(quint8 *dst, const quint8 *srcRow, int numRows, int rowSize)
+{
+    for (int i = 0; i < numRows; i++) {
+        memcpy(dst, srcRow, rowSize);
+        dst += rowSize;
+    }
+    return dst;
+}
+
+/**
+ * Fills a stripe whose every row is filled with the pixel of the
+ * corresponding row of the patch, taken from \p srcColumn
+ */
+quint8* fillColumns(quint8 *dst, const quint8 *srcColumn, int srcStride,
+                    int numRows, int stripeWidth, int pixelSize)
+{
+    for (int row = 0; row < numRows; row++) {
+        for (int i = 0; i < stripeWidth; i++) {
+            memcpy(dst, srcColumn, pixelSize);
+            dst += pixelSize;
+        }
+        srcColumn += srcStride;
+    }
+    return dst;
+}
+
+}
+
+KisTextureUploadBackend::~KisTextureUploadBackend()
+{
+}
+
+struct Q_DECL_HIDDEN KisTextureUploadStagingRing::Private
+{
+    enum BufferState {
+        Free,
+        Staged,
+        Uploaded,
+        InFlight
+    };
+
+    /**
+     * The mapping lock is held for reading while a worker packs the pixels
+     * into a buffer and for writing while the buffers are (re)allocated,
+     * so the memory is never unmapped under the feet of a worker.
+     */
+    QReadWriteLock mappingLock;
+
+    /**
+     * Guards the states of the buffers
+     */
+    QMutex mutex;
+
+    QScopedPointer<KisTextureUploadBackend> backend;
+    QVector<quint8*> buffers;
+    QVector<BufferState> states;
+    QVector<int> fences;
+    int bufferSize = 0;
+    int nextBuffer = 0;
+
+    /**
+     * Incremented on every reallocation, so the buffers staged before
+     * it are known to be stale
+     */
+    int generation = 0;
+
+    void resetImpl();
+    void releaseBuffer(int index, int bufferGeneration);
+    bool uploadBuffer(int index, int bufferGeneration, const QVector<KisTextureUploadCommand> &commands);
+};
+
+void KisTextureUploadStagingRing::Private::resetImpl()
+{
+    if (backend) {
+        backend->releaseBuffers();
+        backend.reset();
+    }
+
+    buffers.clear();
+    states.clear();
+    fences.clear();
+    bufferSize = 0;
+    nextBuffer = 0;
+    generation++;
+}
+
+void KisTextureUploadStagingRing::Private::releaseBuffer(int index, int bufferGeneration)
+{
+    QMutexLocker l(&mutex);
+
+    if (bufferGeneration == generation && states[index] == Staged) {
+        states[index] = Free;
+    }
+}
+
+bool KisTextureUploadStagingRing::Private::uploadBuffer(int index, int bufferGeneration, const QVector<KisTextureUploadCommand> &commands)
+{
+    {
+        QMutexLocker l(&mutex);
+
+        if (bufferGeneration != generation || states[index] != Staged) {
+            return false;
+        }
+
+        states[index] = Uploaded;
+    }
+
+    // the backend is reset in the GUI thread only, so it
+    // cannot disappear while the commands are issued
+    Q_FOREACH (const KisTextureUploadCommand &command, commands) {
+        backend->copyToTexture(index, command);
+    }
+
+    return true;
+}
+
+
+KisTextureUploadStagingRing::KisTextureUploadStagingRing()
+    : m_d(new Private)
+{
+}
+
+KisTextureUploadStagingRing::~KisTextureUploadStagingRing()
+{
+    reset();
+}
+
+bool KisTextureUploadStagingRing::allocate(KisTextureUploadBackend *backend, int numBuffers, int bufferSize)
+{
+    KIS_ASSERT(numBuffers > 0);
+    KIS_ASSERT(bufferSize > 0);
+
+    QScopedPointer<KisTextureUploadBackend> newBackend(backend);
+
+    QWriteLocker mappingLocker(&m_d->mappingLock);
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->resetImpl();
+
+    const QVector<quint8*> buffers = newBackend->allocateBuffers(numBuffers, bufferSize);
+    if (buffers.size() != numBuffers) {
+        if (!buffers.isEmpty()) {
+            newBackend->releaseBuffers();
+        }
+        return false;
+    }
+
+    m_d->backend.swap(newBackend);
+    m_d->buffers = buffers;
+    m_d->states.fill(Private::Free, numBuffers);
+    m_d->fences.fill(-1, numBuffers);
+    m_d->bufferSize = bufferSize;
+
+    return true;
+}
+
+void KisTextureUploadStagingRing::reset()
+{
+    QWriteLocker mappingLocker(&m_d->mappingLock);
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->resetImpl();
+}
+
+bool KisTextureUploadStagingRing::isValid() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return !m_d->buffers.isEmpty();
+}
+
+int KisTextureUploadStagingRing::size() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->buffers.size();
+}
+
+int KisTextureUploadStagingRing::bufferSize() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->bufferSize;
+}
+
+int KisTextureUploadStagingRing::numFreeBuffers() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return static_cast<int>(std::count(m_d->states.begin(), m_d->states.end(), Private::Free));
+}
+
+KisTextureUploadStagingBufferSP KisTextureUploadStagingRing::stage(const KisTextureTileUpdateInfo &info)
+{
+    if (!info.valid() || !info.data()) return KisTextureUploadStagingBufferSP();
+
+    QReadLocker mappingLocker(&m_d->mappingLock);
+
+    int index = -1;
+    int generation = 0;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        if (m_d->buffers.isEmpty() || packedSize(info) > m_d->bufferSize) {
+            return KisTextureUploadStagingBufferSP();
+        }
+
+        const int numBuffers = m_d->buffers.size();
+        for (int i = 0; i < numBuffers; i++) {
+            const int candidate = (m_d->nextBuffer + i) % numBuffers;
+            if (m_d->states[candidate] == Private::Free) {
+                index = candidate;
+                break;
+            }
+        }
+
+        if (index < 0) {
+            return KisTextureUploadStagingBufferSP();
+        }
+
+        m_d->states[index] = Private::Staged;
+        m_d->nextBuffer = (index + 1) % numBuffers;
+        generation = m_d->generation;
+    }
+
+    // the buffer is owned by us now, so it is packed without holding the mutex
+    const QVector<KisTextureUploadCommand> commands = pack(info, m_d->buffers[index]);
+
+    return KisTextureUploadStagingBufferSP(
+        new KisTextureUploadStagingBuffer(m_d, index, generation, commands));
+}
+
+void KisTextureUploadStagingRing::fenceUploadedBuffers()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (!m_d->states.contains(Private::Uploaded)) return;
+
+    const int fence = m_d->backend->insertFence();
+
+    for (int i = 0; i < m_d->states.size(); i++) {
+        if (m_d->states[i] == Private::Uploaded) {
+            m_d->states[i] = Private::InFlight;
+            m_d->fences[i] = fence;
+        }
+    }
+}
+
+void KisTextureUploadStagingRing::recycleSignaledBuffers()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    QVector<int> checkedFences;
+
+    for (int i = 0; i < m_d->states.size(); i++) {
+        if (m_d->states[i] != Private::InFlight) continue;
+
+        const int fence = m_d->fences[i];
+        if (checkedFences.contains(fence)) continue;
+        checkedFences << fence;
+
+        if (m_d->backend->isFenceSignaled(fence)) {
+            for (int j = i; j < m_d->states.size(); j++) {
+                if (m_d->states[j] == Private::InFlight && m_d->fences[j] == fence) {
+                    m_d->states[j] = Private::Free;
+                    m_d->fences[j] = -1;
+                }
+            }
+            m_d->backend->releaseFence(fence);
+        }
+    }
+}
+
+int KisTextureUploadStagingRing::packedSize(const KisTextureTileUpdateInfo &info)
+{
+    const int pixelSize = info.pixelSize();
+    const BorderStripes stripes = borderStripes(info);
+
+    return rectBytes(QRect(info.realPatchOffset(), info.realPatchSize()), pixelSize) +
+        rectBytes(stripes.top, pixelSize) +
+        rectBytes(stripes.bottom, pixelSize) +
+        rectBytes(stripes.left, pixelSize) +
+        rectBytes(stripes.right, pixelSize);
+}
+
+QVector<KisTextureUploadCommand> KisTextureUploadStagingRing::pack(const KisTextureTileUpdateInfo &info, quint8 *dst)
+{
+    QVector<KisTextureUploadCommand> commands;
+
+    const int levelOfDetail = info.patchLevelOfDetail();
+    const int pixelSize = info.pixelSize();
+    const QRect patchRect(info.realPatchOffset(), info.realPatchSize());
+    const int patchRowSize = patchRect.width() * pixelSize;
+    const quint8 *patch = info.data();
+
+    quint8 *const begin = dst;
+
+    auto addCommand = [&] (const QRect &rc, quint8 *start, bool allocateLevel) {
+        KisTextureUploadCommand command;
+        command.levelOfDetail = levelOfDetail;
+        command.rect = rc;
+        command.offset = static_cast<int>(start - begin);
+        command.allocateLevel = allocateLevel;
+        commands << command;
+    };
+
+    addCommand(patchRect, dst, info.isEntireTileUpdated());
+    memcpy(dst, patch, patchRowSize * patchRect.height());
+    dst += patchRowSize * patchRect.height();
+
+    const BorderStripes stripes = borderStripes(info);
+
+    if (!stripes.top.isEmpty()) {
+        addCommand(stripes.top, dst, false);
+        dst = fillRows(dst, patch, stripes.top.height(), patchRowSize);
+    }
+
+    if (!stripes.bottom.isEmpty()) {
+        addCommand(stripes.bottom, dst, false);
+        dst = fillRows(dst, patch + (patchRect.height() - 1) * patchRowSize,
+                       stripes.bottom.height(), patchRowSize);
+    }
+
+    if (!stripes.left.isEmpty()) {
+        addCommand(stripes.left, dst, false);
+        dst = fillColumns(dst, patch, patchRowSize,
+                          patchRect.height(), stripes.left.width(), pixelSize);
+    }
+
+    if (!stripes.right.isEmpty()) {
+        addCommand(stripes.right, dst, false);
+        dst = fillColumns(dst, patch + patchRowSize - pixelSize, patchRowSize,
+                          patchRect.height(), stripes.right.width(), pixelSize);
+    }
+
+    return commands;
+}
+
+
+KisTextureUploadStagingBuffer::KisTextureUploadStagingBuffer(QSharedPointer<KisTextureUploadStagingRing::Private> ring,
+                                                             int bufferIndex, int generation,
+                                                             const QVector<KisTextureUploadCommand> &commands)
+    : m_ring(ring),
+      m_bufferIndex(bufferIndex),
+      m_generation(generation),
+      m_commands(commands)
+{
+}
+
+KisTextureUploadStagingBuffer::~KisTextureUploadStagingBuffer()
+{
+    m_ring->releaseBuffer(m_bufferIndex, m_generation);
+}
+
+bool KisTextureUploadStagingBuffer::upload()
+{
+    return m_ring->uploadBuffer(m_bufferIndex, m_generation, m_commands);
+}
+
+const QVector<KisTextureUploadCommand>& KisTextureUploadStagingBuffer::commands() const
+{
+    return m_commands;
+}
+
+int KisTextureUploadStagingBuffer::bufferIndex() const
+{
+    return m_bufferIndex;
+}
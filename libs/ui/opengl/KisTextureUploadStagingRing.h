@@ -0,0 +1,232 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTEXTUREUPLOADSTAGINGRING_H
+#define KISTEXTUREUPLOADSTAGINGRING_H
+
+#include <QRect>
+#include <QVector>
+#include <QSharedPointer>
+#include <QScopedPointer>
+
+#include "kritaui_export.h"
+
+class KisTextureTileUpdateInfo;
+
+
+/**
+ * A single copy from a staging buffer into the texture of a tile
+ */
+struct KisTextureUploadCommand
+{
+    int levelOfDetail = 0;
+
+    /// the rect in the texture pixels of the level
+    QRect rect;
+
+    /// the offset of the pixels in the staging buffer in bytes
+    int offset = 0;
+
+    /// when true, the level is (re)allocated with glTexImage2D,
+    /// otherwise the rect is updated with glTexSubImage2D
+    bool allocateLevel = false;
+};
+
+inline bool operator==(const KisTextureUploadCommand &lhs, const KisTextureUploadCommand &rhs)
+{
+    return lhs.levelOfDetail == rhs.levelOfDetail &&
+        lhs.rect == rhs.rect &&
+        lhs.offset == rhs.offset &&
+        lhs.allocateLevel == rhs.allocateLevel;
+}
+
+/**
+ * The graphics API side of KisTextureUploadStagingRing. The real
+ * implementation is KisOpenGLTextureUploadBackend, the unit tests and the
+ * benchmarks use KisTextureUploadMemoryBackend, which needs no GPU.
+ *
+ * All the methods are called from the GUI thread only, the memory of the
+ * buffers is written by the worker threads though.
+ */
+class KRITAUI_EXPORT KisTextureUploadBackend
+{
+public:
+    virtual ~KisTextureUploadBackend();
+
+    /**
+     * Allocates \p numBuffers staging buffers of \p bufferSize bytes each
+     * and maps them persistently
+     *
+     * @return the pointers to the mapped memory of the buffers, or an empty
+     * vector if the buffers could not be allocated
+     */
+    virtual QVector<quint8*> allocateBuffers(int numBuffers, int bufferSize) = 0;
+
+    /**
+     * Unmaps and destroys all the buffers and pending fences
+     */
+    virtual void releaseBuffers() = 0;
+
+    /**
+     * Copies the pixels of \p command from buffer \p bufferIndex into the
+     * texture currently bound to GL_TEXTURE_2D
+     */
+    virtual void copyToTexture(int bufferIndex, const KisTextureUploadCommand &command) = 0;
+
+    /**
+     * Inserts a fence after all the copies issued so far
+     *
+     * @return the id of the fence
+     */
+    virtual int insertFence() = 0;
+
+    /**
+     * @return true if all the copies issued before the fence has been
+     * completed, so the buffers they read from can be reused
+     */
+    virtual bool isFenceSignaled(int fence) = 0;
+
+    virtual void releaseFence(int fence) = 0;
+};
+
+
+class KisTextureUploadStagingBuffer;
+typedef QSharedPointer<KisTextureUploadStagingBuffer> KisTextureUploadStagingBufferSP;
+
+/**
+ * A producer/consumer ring of persistently mapped staging buffers for
+ * the texture tiles.
+ *
+ * The worker thread that builds a tile update (see
+ * KisOpenGLImageTextures::updateCache()) packs its pixels right into a free
+ * staging buffer with stage(). The packed data includes the border stripes
+ * of the tiles lying on the image edges, the stripes are expanded to their
+ * final size, so every stripe is copied with a single command instead of
+ * a command per row/column of pixels.
+ *
+ * The GUI thread then only issues the copy commands of the staged buffer,
+ * see KisTextureUploadStagingBuffer::upload(), and fences the uploaded
+ * buffers with fenceUploadedBuffers(). The buffers return to the ring when
+ * their fence is signaled, see recycleSignaledBuffers().
+ *
+ * If the ring is full, stage() returns null and the tile is uploaded the
+ * old way, through KisOpenGLBufferCircularStorage.
+ */
+class KRITAUI_EXPORT KisTextureUploadStagingRing
+{
+public:
+    KisTextureUploadStagingRing();
+    ~KisTextureUploadStagingRing();
+
+    KisTextureUploadStagingRing(const KisTextureUploadStagingRing &) = delete;
+    KisTextureUploadStagingRing &operator=(const KisTextureUploadStagingRing &) = delete;
+
+    /**
+     * Allocates \p numBuffers buffers of \p bufferSize bytes with \p backend.
+     * The ring takes ownership of the backend. All the buffers staged before
+     * become stale.
+     *
+     * @return false if the backend could not allocate the buffers, in such
+     * a case the ring stays invalid
+     */
+    bool allocate(KisTextureUploadBackend *backend, int numBuffers, int bufferSize);
+
+    /**
+     * Releases the buffers and the backend. All the staged buffers become
+     * stale.
+     */
+    void reset();
+
+    bool isValid() const;
+    int size() const;
+    int bufferSize() const;
+
+    /**
+     * @return the number of buffers that are neither staged nor in flight
+     */
+    int numFreeBuffers() const;
+
+    /**
+     * Packs \p info into a free buffer. Can be called from any thread.
+     *
+     * @return the staged buffer or null if the ring is invalid, has no free
+     * buffers or the tile doesn't fit into a buffer
+     */
+    KisTextureUploadStagingBufferSP stage(const KisTextureTileUpdateInfo &info);
+
+    /**
+     * Inserts a fence after all the buffers uploaded since the previous
+     * call. Must be called in the GUI thread after a batch of uploads.
+     */
+    void fenceUploadedBuffers();
+
+    /**
+     * Returns the buffers whose fence is signaled to the ring. Must be
+     * called in the GUI thread.
+     */
+    void recycleSignaledBuffers();
+
+    /**
+     * @return the size of the packed representation of \p info in bytes
+     */
+    static int packedSize(const KisTextureTileUpdateInfo &info);
+
+    /**
+     * Packs the pixels of \p info into \p dst, which must be at least
+     * packedSize() bytes long.
+     *
+     * @return the commands copying the packed pixels into the texture of the
+     * tile, including the border stripes
+     */
+    static QVector<KisTextureUploadCommand> pack(const KisTextureTileUpdateInfo &info, quint8 *dst);
+
+private:
+    friend class KisTextureUploadStagingBuffer;
+
+    struct Private;
+    QSharedPointer<Private> m_d;
+};
+
+/**
+ * A staging buffer holding the packed pixels of a single tile update.
+ * If the buffer is destroyed without being uploaded, it returns to the
+ * ring immediately.
+ */
+class KRITAUI_EXPORT KisTextureUploadStagingBuffer
+{
+public:
+    ~KisTextureUploadStagingBuffer();
+
+    KisTextureUploadStagingBuffer(const KisTextureUploadStagingBuffer &) = delete;
+    KisTextureUploadStagingBuffer &operator=(const KisTextureUploadStagingBuffer &) = delete;
+
+    /**
+     * Issues the copy commands into the texture currently bound to
+     * GL_TEXTURE_2D. Must be called in the GUI thread.
+     *
+     * @return false if the buffer has become stale, because the ring has
+     * been reallocated since the buffer was staged, or has already been
+     * uploaded. The tile should be uploaded the old way then.
+     */
+    bool upload();
+
+    const QVector<KisTextureUploadCommand>& commands() const;
+    int bufferIndex() const;
+
+private:
+    friend class KisTextureUploadStagingRing;
+
+    KisTextureUploadStagingBuffer(QSharedPointer<KisTextureUploadStagingRing::Private> ring,
+                                  int bufferIndex, int generation,
+                                  const QVector<KisTextureUploadCommand> &commands);
+
+    QSharedPointer<KisTextureUploadStagingRing::Private> m_ring;
+    int m_bufferIndex = -1;
+    int m_generation = 0;
+    QVector<KisTextureUploadCommand> m_commands;
+};
+
+#endif // KISTEXTUREUPLOADSTAGINGRING_H
@@ -32,6 +32,7 @@
 #include <QVector3D>
 #include "kis_painting_tweaks.h"
 #include "KisOpenGLBufferCreationGuard.h"
+#include "KisOpenGLTextureUploadBackend.h"
 
 #ifdef HAVE_OPENEXR
 #include <half.h>
@@ -167,8 +168,23 @@ void KisOpenGLImageTextures::initBufferStorage(bool useBuffer)
         const int tileSize = m_texturesInfo.width * m_texturesInfo.height * pixelSize;
 
         m_bufferStorage.allocate(numTextureBuffers, tileSize);
+
+        /**
+         * The staging ring should be large enough to keep the tiles
+         * of a few consecutive updates while the GPU is busy
+         */
+        const int numStagingBuffers = 32;
+
+        QOpenGLContext *ctx = QOpenGLContext::currentContext();
+        if (KisOpenGLTextureUploadBackend::isSupported(ctx)) {
+            m_stagingRing.allocate(new KisOpenGLTextureUploadBackend(ctx, &m_texturesInfo),
+                                   numStagingBuffers, tileSize);
+        } else {
+            m_stagingRing.reset();
+        }
     } else {
         m_bufferStorage.reset();
+        m_stagingRing.reset();
     }
 }
 
@@ -320,7 +336,17 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheNoConversion(const QRec
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect, KisImageSP srcImage, bool convertColorSpace)
 {
     if (!m_initialized) return new KisOpenGLUpdateInfo();
-    return m_updateInfoBuilder.buildUpdateInfo(rect, srcImage, convertColorSpace);
+    KisOpenGLUpdateInfoSP info = m_updateInfoBuilder.buildUpdateInfo(rect, srcImage, convertColorSpace);
+
+    // if the ring is full, the rest of the tiles are uploaded by the GUI thread
+    Q_FOREACH (KisTextureTileUpdateInfoSP tileInfo, info->tileList) {
+        KisTextureUploadStagingBufferSP buffer = m_stagingRing.stage(*tileInfo);
+        if (!buffer) break;
+
+        tileInfo->setStagingBuffer(buffer);
+    }
+
+    return info;
 }
 
 void KisOpenGLImageTextures::recalculateCache(KisUpdateInfoSP info, bool blockMipmapRegeneration)
@@ -333,6 +359,8 @@ void KisOpenGLImageTextures::recalculateCache(KisUpdateInfoSP info, bool blockMi
     KisOpenGLUpdateInfoSP glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
     if(!glInfo) return;
 
+    m_stagingRing.recycleSignaledBuffers();
+
     QScopedPointer<KisOpenGLSync> sync;
     int numProcessedTiles = 0;
 
@@ -368,6 +396,8 @@ void KisOpenGLImageTextures::recalculateCache(KisUpdateInfoSP info, bool blockMi
             numProcessedTiles++;
         }
     }
+
+    m_stagingRing.fenceUploadedBuffers();
 }
 
 void KisOpenGLImageTextures::generateCheckerTexture(const QImage &checkImage)
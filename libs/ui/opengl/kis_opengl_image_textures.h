@@ -18,6 +18,7 @@
 #include "opengl/kis_texture_tile.h"
 #include "KisOpenGLUpdateInfoBuilder.h"
 #include "KisOpenGLBufferCircularStorage.h"
+#include "KisTextureUploadStagingRing.h"
 
 class KisOpenGLImageTextures;
 typedef KisSharedPtr<KisOpenGLImageTextures> KisOpenGLImageTexturesSP;
@@ -152,6 +153,12 @@ public:
         return 1.0 / m_texturesInfo.width;
     }
 
+    /**
+     * Builds the update info for \p rect and packs its tiles into the
+     * staging ring. Should be used only for the updates that are going
+     * to be uploaded soon, the staging buffers are not returned into
+     * the ring until the info is uploaded or destroyed.
+     */
     KisOpenGLUpdateInfoSP updateCache(const QRect& rect, KisImageSP srcImage);
     KisOpenGLUpdateInfoSP updateCacheNoConversion(const QRect& rect);
 
@@ -208,6 +215,12 @@ private:
 
     // buffers are used by texture tiles, so they must come first
     KisOpenGLBufferCircularStorage m_bufferStorage;
+
+    /**
+     * The worker threads pack the tile updates into the ring in
+     * updateCache(), the GUI thread only issues the copies from it
+     */
+    KisTextureUploadStagingRing m_stagingRing;
     QVector<KisTextureTile*> m_textureTiles;
     QOpenGLBuffer m_tileVertexBuffer;
     QOpenGLBuffer m_tileTexCoordBuffer;
@@ -8,6 +8,7 @@
 #include "kis_texture_tile.h"
 #include "kis_texture_tile_update_info.h"
 #include "KisOpenGLBufferCircularStorage.h"
+#include "KisTextureUploadStagingRing.h"
 
 #include <kis_debug.h>
 #if !defined(QT_OPENGL_ES)
@@ -152,10 +153,6 @@ void KisTextureTile::update(const KisTextureTileUpdateInfo &updateInfo, bool blo
     setTextureParameters();
 
     const int patchLevelOfDetail = updateInfo.patchLevelOfDetail();
-    const QSize patchSize = updateInfo.realPatchSize();
-    const QPoint patchOffset = updateInfo.realPatchOffset();
-
-    const GLvoid *fd = updateInfo.data();
 
     /**
      * In some special case, when the Lod0 stroke is cancelled the
@@ -187,6 +184,44 @@ void KisTextureTile::update(const KisTextureTileUpdateInfo &updateInfo, bool blo
     }
 
 
+    KisTextureUploadStagingBufferSP stagingBuffer = updateInfo.stagingBuffer();
+
+    /**
+     * The staged buffer has been packed by a worker thread together with
+     * the border stripes, so we only need to issue the copy commands. If
+     * the ring has been reallocated since then, we upload the pixels the
+     * old way.
+     */
+    if (!stagingBuffer || !stagingBuffer->upload()) {
+        uploadPatchPixels(updateInfo);
+    }
+
+    //// Uncomment this warning if you see any weird flickering when
+    //// Instant Preview updates
+    // if (!updateInfo.isEntireTileUpdated() &&
+    //     !(!patchLevelOfDetail || !m_preparedLodPlane || patchLevelOfDetail == m_preparedLodPlane)) {
+    //     qDebug() << "WARNING: LodN switch is requested for the partial tile update!. Flickering is possible..." << ppVar(updateInfo.realPatchSize());
+    //     qDebug() << "    " << ppVar(m_preparedLodPlane);
+    //     qDebug() << "    " << ppVar(patchLevelOfDetail);
+    // }
+
+    restoreTextureParameters();
+
+    if (!patchLevelOfDetail) {
+        setNeedsMipmapRegeneration();
+    } else {
+        setPreparedLodPlane(patchLevelOfDetail);
+    }
+}
+
+void KisTextureTile::uploadPatchPixels(const KisTextureTileUpdateInfo &updateInfo)
+{
+    const int patchLevelOfDetail = updateInfo.patchLevelOfDetail();
+    const QSize patchSize = updateInfo.realPatchSize();
+    const QPoint patchOffset = updateInfo.realPatchOffset();
+
+    const GLvoid *fd = updateInfo.data();
+
     if (updateInfo.isEntireTileUpdated()) {
         KisOpenGLBufferCircularStorage::BufferBinder b(
             m_bufferStorage, &fd, updateInfo.patchPixelsLength());
@@ -329,23 +364,6 @@ void KisTextureTile::update(const KisTextureTileUpdateInfo &updateInfo, bool blo
                             fd);
         }
     }
-
-    //// Uncomment this warning if you see any weird flickering when
-    //// Instant Preview updates
-    // if (!updateInfo.isEntireTileUpdated() &&
-    //     !(!patchLevelOfDetail || !m_preparedLodPlane || patchLevelOfDetail == m_preparedLodPlane)) {
-    //     qDebug() << "WARNING: LodN switch is requested for the partial tile update!. Flickering is possible..." << ppVar(patchSize);
-    //     qDebug() << "    " << ppVar(m_preparedLodPlane);
-    //     qDebug() << "    " << ppVar(patchLevelOfDetail);
-    // }
-
-    restoreTextureParameters();
-
-    if (!patchLevelOfDetail) {
-        setNeedsMipmapRegeneration();
-    } else {
-        setPreparedLodPlane(patchLevelOfDetail);
-    }
 }
 
 QRectF KisTextureTile::imageRectInTexturePixels(const QRect &imageRect) const
@@ -83,6 +83,13 @@ private:
     void setNeedsMipmapRegeneration();
     void setPreparedLodPlane(int lod);
 
+    /**
+     * Uploads the patch of \p updateInfo and its border stripes through
+     * the circular buffer storage, used when the patch has not been staged
+     * by a worker thread
+     */
+    void uploadPatchPixels(const KisTextureTileUpdateInfo &updateInfo);
+
     GLuint m_textureId;
 
     QRect m_tileRectInImagePixels;
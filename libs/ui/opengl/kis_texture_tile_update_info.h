@@ -14,6 +14,7 @@
 #include "kis_image.h"
 #include "kis_paint_device.h"
 #include "kis_texture_tile_info_pool.h"
+#include "KisTextureUploadStagingRing.h"
 #include <KoChannelInfo.h>
 #include <KoColorConversionTransformation.h>
 #include <KoColorModelStandardIds.h>
@@ -304,6 +305,19 @@ public:
         m_patchColorSpace = colorSpace;
     }
 
+    /**
+     * The pixels of the patch packed into a staging buffer by the worker
+     * thread, see KisTextureUploadStagingRing. If null, the tile is
+     * uploaded from data().
+     */
+    inline KisTextureUploadStagingBufferSP stagingBuffer() const {
+        return m_stagingBuffer;
+    }
+
+    inline void setStagingBuffer(KisTextureUploadStagingBufferSP buffer) {
+        m_stagingBuffer = buffer;
+    }
+
 private:
     Q_DISABLE_COPY(KisTextureTileUpdateInfo)
 
@@ -325,6 +339,7 @@ private:
 
     DataBuffer m_patchPixels;
     KisTextureTileInfoPoolSP m_pool;
+    KisTextureUploadStagingBufferSP m_stagingBuffer;
 };
 
 
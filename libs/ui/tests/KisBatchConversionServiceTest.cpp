@@ -0,0 +1,433 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBatchConversionServiceTest.h"
+
+#include <QBuffer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <testui.h>
+#include <testutil.h>
+
+#include <KoColor.h>
+#include <kis_image.h>
+#include <kis_image_animation_interface.h>
+#include <kis_keyframe_channel.h>
+#include <kis_time_span.h>
+
+#include "KisBatchConversionService.h"
+#include "KisDocument.h"
+#include "KisPart.h"
+
+namespace {
+
+/**
+ * Doesn't load anything, the test decides when the jobs finish
+ * and how much memory is used
+ */
+class FakeService : public KisBatchConversionService
+{
+public:
+    FakeService(int maxParallelJobs, int memoryLimit)
+        : KisBatchConversionService(QString(), maxParallelJobs, memoryLimit)
+    {
+    }
+
+    void finish(quint64 jobNumber, const QString &errorMessage = QString()) {
+        startedJobs.removeOne(jobNumber);
+        finishJob(jobNumber, errorMessage);
+    }
+
+    QList<quint64> startedJobs;
+    QStringList startedInputs;
+    qint64 memory {0};
+
+protected:
+    void startJob(quint64 jobNumber, const Request &request) override {
+        startedJobs << jobNumber;
+        startedInputs << request.input;
+    }
+
+    qint64 usedMemory() const override {
+        return memory;
+    }
+};
+
+const qint64 MiB = 1 << 20;
+
+QByteArray exportLine(const QString &id, const QString &input, const QString &output, const QString &command = "export")
+{
+    QJsonObject object;
+    object["id"] = id;
+    object["command"] = command;
+    object["input"] = input;
+    object["output"] = output;
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+QList<QJsonObject> replies(const QBuffer &buffer)
+{
+    QList<QJsonObject> result;
+
+    Q_FOREACH (const QByteArray &line, buffer.data().split('\n')) {
+        if (!line.isEmpty()) {
+            result << QJsonDocument::fromJson(line).object();
+        }
+    }
+
+    return result;
+}
+
+void saveDocument(KisImageSP image, const QString &fileName)
+{
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setFileBatchMode(true);
+    doc->setCurrentImage(image);
+    QVERIFY(doc->exportDocumentSync(fileName, "application/x-krita"));
+}
+
+}
+
+void KisBatchConversionServiceTest::testParseRequest()
+{
+    KisBatchConversionService::Request request;
+    QString errorMessage;
+
+    QVERIFY(KisBatchConversionService::parseRequest(
+                "{\"id\": \"1\", \"command\": \"export-sequence\", \"input\": \"in.kra\", \"output\": \"out.png\","
+                " \"mimetype\": \"image/png\","
+                " \"configuration\": \"<!DOCTYPE params><params version=\\\"1\\\"><param name=\\\"compression\\\" type=\\\"string\\\"><![CDATA[3]]></param></params>\"}",
+                &request, &errorMessage));
+
+    QCOMPARE(request.id, QString("1"));
+    QCOMPARE(request.command, QString("export-sequence"));
+    QCOMPARE(request.input, QString("in.kra"));
+    QCOMPARE(request.output, QString("out.png"));
+    QCOMPARE(request.mimeType, QByteArray("image/png"));
+    QVERIFY(request.configuration);
+    QCOMPARE(request.configuration->getInt("compression"), 3);
+
+    // the command defaults to a single export
+    request = KisBatchConversionService::Request();
+    QVERIFY(KisBatchConversionService::parseRequest("{\"input\": \"in.kra\", \"output\": \"out.png\"}",
+                                                    &request, &errorMessage));
+    QCOMPARE(request.command, QString("export"));
+    QVERIFY(request.mimeType.isEmpty());
+    QVERIFY(!request.configuration);
+
+    // quit doesn't need anything else
+    request = KisBatchConversionService::Request();
+    QVERIFY(KisBatchConversionService::parseRequest("{\"command\": \"quit\"}", &request, &errorMessage));
+    QCOMPARE(request.command, QString("quit"));
+}
+
+void KisBatchConversionServiceTest::testParseErrors_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<QString>("expectedMessage");
+
+    QTest::newRow("not-json") << QByteArray("{\"input\": ") << "Could not parse the job";
+    QTest::newRow("not-object") << QByteArray("[\"in.kra\", \"out.png\"]") << "should be a JSON object";
+    QTest::newRow("unknown-command") << QByteArray("{\"command\": \"print\", \"input\": \"in.kra\", \"output\": \"out.png\"}") << "Unknown command: print";
+    QTest::newRow("no-input") << QByteArray("{\"output\": \"out.png\"}") << "\"input\" and \"output\"";
+    QTest::newRow("no-output") << QByteArray("{\"command\": \"export-sequence\", \"input\": \"in.kra\"}") << "\"input\" and \"output\"";
+    QTest::newRow("mimetype-type") << QByteArray("{\"input\": \"in.kra\", \"output\": \"out.png\", \"mimetype\": 1}") << "\"mimetype\" field";
+    QTest::newRow("configuration-type") << QByteArray("{\"input\": \"in.kra\", \"output\": \"out.png\", \"configuration\": {\"compression\": 3}}") << "\"configuration\" field";
+    QTest::newRow("configuration-xml") << QByteArray("{\"input\": \"in.kra\", \"output\": \"out.png\", \"configuration\": \"<params\"}") << "export configuration";
+}
+
+void KisBatchConversionServiceTest::testParseErrors()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(QString, expectedMessage);
+
+    KisBatchConversionService::Request request;
+    QString errorMessage;
+
+    QVERIFY(!KisBatchConversionService::parseRequest(line, &request, &errorMessage));
+    QVERIFY2(errorMessage.contains(expectedMessage), qPrintable(errorMessage));
+}
+
+void KisBatchConversionServiceTest::testErrorReply()
+{
+    FakeService service(1, 0);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    service.addJob("{\"id\": \"7\", \"command\": \"print\", \"input\": \"in.kra\", \"output\": \"out.png\"}", &buffer);
+    QTest::qWait(50);
+
+    // the malformed jobs are answered right away and never queued
+    QCOMPARE(service.pendingJobs(), 0);
+    QVERIFY(service.startedJobs.isEmpty());
+
+    const QList<QJsonObject> result = replies(buffer);
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result[0]["id"].toString(), QString("7"));
+    QCOMPARE(result[0]["status"].toString(), QString("error"));
+    QVERIFY(!result[0].contains("timing"));
+}
+
+void KisBatchConversionServiceTest::testQueue()
+{
+    FakeService service(2, 0);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    for (int i = 0; i < 5; i++) {
+        service.addJob(exportLine(QString::number(i), QString("in%1.kra").arg(i), "out.png"), &buffer);
+    }
+
+    QCOMPARE(service.pendingJobs(), 5);
+
+    QTRY_COMPARE(service.startedJobs.size(), 2);
+    QCOMPARE(service.startedInputs, QStringList({"in0.kra", "in1.kra"}));
+
+    service.finish(service.startedJobs.first());
+    QTRY_COMPARE(service.startedJobs.size(), 2);
+    QCOMPARE(service.startedInputs.last(), QString("in2.kra"));
+    QCOMPARE(service.pendingJobs(), 4);
+
+    service.finish(service.startedJobs.first(), "failed");
+
+    while (!service.startedJobs.isEmpty()) {
+        service.finish(service.startedJobs.first());
+        QTest::qWait(10);
+    }
+
+    QCOMPARE(service.pendingJobs(), 0);
+    QCOMPARE(service.startedInputs.size(), 5);
+
+    const QList<QJsonObject> result = replies(buffer);
+    QCOMPARE(result.size(), 5);
+
+    int numErrors = 0;
+    Q_FOREACH (const QJsonObject &reply, result) {
+        QVERIFY(reply.contains("timing"));
+        if (reply["status"].toString() == "error") {
+            QCOMPARE(reply["message"].toString(), QString("failed"));
+            numErrors++;
+        }
+    }
+    QCOMPARE(numErrors, 1);
+}
+
+void KisBatchConversionServiceTest::testMemoryLimit()
+{
+    FakeService service(4, 100);
+    service.memory = 200 * MiB;
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    service.addJob(exportLine("1", "in1.kra", "out1.png"), &buffer);
+    service.addJob(exportLine("2", "in2.kra", "out2.png"), &buffer);
+
+    // the first job is started even over the limit, otherwise nothing would ever run
+    QTRY_COMPARE(service.startedJobs.size(), 1);
+    QTest::qWait(50);
+    QCOMPARE(service.startedJobs.size(), 1);
+
+    // the second one waits for the memory to be released
+    service.memory = 50 * MiB;
+    service.addJob(exportLine("3", "in3.kra", "out3.png"), &buffer);
+    QTRY_COMPARE(service.startedJobs.size(), 3);
+
+    // over the limit again, the new job waits for the running ones
+    service.memory = 200 * MiB;
+    service.addJob(exportLine("4", "in4.kra", "out4.png"), &buffer);
+    QTest::qWait(50);
+    QCOMPARE(service.startedJobs.size(), 3);
+
+    while (!service.startedJobs.isEmpty()) {
+        service.finish(service.startedJobs.first());
+        QTest::qWait(10);
+    }
+
+    QCOMPARE(service.startedInputs, QStringList({"in1.kra", "in2.kra", "in3.kra", "in4.kra"}));
+    QCOMPARE(service.pendingJobs(), 0);
+}
+
+void KisBatchConversionServiceTest::testQuit()
+{
+    FakeService service(1, 0);
+    QSignalSpy spy(&service, &KisBatchConversionService::sigFinished);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    service.addJob(exportLine("1", "in1.kra", "out1.png"), &buffer);
+    service.addJob("{\"command\": \"quit\"}", &buffer);
+    QTRY_COMPARE(service.startedJobs.size(), 1);
+
+    // the pending jobs are finished before quitting
+    QTest::qWait(50);
+    QCOMPARE(spy.size(), 0);
+
+    service.finish(service.startedJobs.first());
+    QTRY_COMPARE(spy.size(), 1);
+
+    // quit is not answered
+    QCOMPARE(replies(buffer).size(), 1);
+}
+
+void KisBatchConversionServiceTest::testExport()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QRect rect(0, 0, 64, 64);
+    TestUtil::MaskParent p(rect);
+    p.layer->paintDevice()->fill(rect, KoColor(Qt::red, p.image->colorSpace()));
+    p.image->initialRefreshGraph();
+
+    const QString input = dir.filePath("input.kra");
+    saveDocument(p.image, input);
+
+    KisBatchConversionService service(QString(), 2, 0);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    service.addJob(exportLine("png", input, dir.filePath("output.png")), &buffer);
+
+    // the mimetype overrides the extension of the output
+    QJsonObject object;
+    object["id"] = "mimetype";
+    object["input"] = input;
+    object["output"] = dir.filePath("output.image");
+    object["mimetype"] = "image/png";
+    service.addJob(QJsonDocument(object).toJson(QJsonDocument::Compact), &buffer);
+
+    QTRY_COMPARE_WITH_TIMEOUT(service.pendingJobs(), 0, 10000);
+
+    const QList<QJsonObject> result = replies(buffer);
+    QCOMPARE(result.size(), 2);
+
+    Q_FOREACH (const QJsonObject &reply, result) {
+        QVERIFY2(reply["status"].toString() == "ok", qPrintable(reply["message"].toString()));
+    }
+
+    QImage image;
+    QVERIFY(image.load(dir.filePath("output.png"), "PNG"));
+    QCOMPARE(image.size(), rect.size());
+    QVERIFY(image.load(dir.filePath("output.image"), "PNG"));
+    QCOMPARE(image.size(), rect.size());
+}
+
+void KisBatchConversionServiceTest::testExportErrors()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QRect rect(0, 0, 64, 64);
+    TestUtil::MaskParent p(rect);
+
+    const QString input = dir.filePath("input.kra");
+    saveDocument(p.image, input);
+
+    KisBatchConversionService service(QString(), 1, 0);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    service.addJob(exportLine("missing", dir.filePath("missing.kra"), dir.filePath("out.png")), &buffer);
+    service.addJob(exportLine("unknown-type", input, dir.filePath("out.unknown-extension")), &buffer);
+
+    QJsonObject object;
+    object["id"] = "no-filter";
+    object["input"] = input;
+    object["output"] = dir.filePath("out.png");
+    object["mimetype"] = "application/x-no-such-type";
+    service.addJob(QJsonDocument(object).toJson(QJsonDocument::Compact), &buffer);
+
+    // the image has no animation
+    service.addJob(exportLine("no-animation", input, dir.filePath("frame.png"), "export-sequence"), &buffer);
+
+    QTRY_COMPARE_WITH_TIMEOUT(service.pendingJobs(), 0, 10000);
+
+    const QList<QJsonObject> result = replies(buffer);
+    QCOMPARE(result.size(), 4);
+
+    Q_FOREACH (const QJsonObject &reply, result) {
+        QCOMPARE(reply["status"].toString(), QString("error"));
+    }
+
+    QVERIFY(result[0]["message"].toString().contains("Could not load"));
+    QVERIFY(result[1]["message"].toString().contains("Unknown file type"));
+    QVERIFY(result[2]["message"].toString().contains("application/x-no-such-type"));
+    QVERIFY(result[3]["message"].toString().contains("has no animation"));
+
+    QVERIFY(!QFileInfo(dir.filePath("out.png")).exists());
+    QVERIFY(!QFileInfo(dir.filePath("frame0000.png")).exists());
+}
+
+void KisBatchConversionServiceTest::testExportSequence()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QRect rect(0, 0, 64, 64);
+    TestUtil::MaskParent p(rect);
+    const KoColorSpace *cs = p.image->colorSpace();
+
+    KUndo2Command parentCommand;
+
+    p.layer->enableAnimation();
+    KisKeyframeChannel *rasterChannel = p.layer->getKeyframeChannel(KisKeyframeChannel::Raster.id(), true);
+    rasterChannel->addKeyframe(2, &parentCommand);
+    p.image->animationInterface()->setDocumentRange(KisTimeSpan::fromTimeToTime(0, 3));
+
+    p.layer->paintDevice()->fill(rect, KoColor(Qt::red, cs));
+
+    p.image->animationInterface()->switchCurrentTimeAsync(2);
+    p.image->waitForDone();
+    p.layer->paintDevice()->fill(rect, KoColor(Qt::blue, cs));
+
+    const QString input = dir.filePath("input.kra");
+    saveDocument(p.image, input);
+
+    KisBatchConversionService service(QString(), 1, 0);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    const QString output = dir.filePath("frames/frame.png");
+    service.addJob(exportLine("1", input, output, "export-sequence"), &buffer);
+
+    // the service stays responsive while the frames are rendered
+    QTRY_COMPARE_WITH_TIMEOUT(service.pendingJobs(), 0, 20000);
+
+    QList<QJsonObject> result = replies(buffer);
+    QCOMPARE(result.size(), 1);
+    QVERIFY2(result[0]["status"].toString() == "ok", qPrintable(result[0]["message"].toString()));
+
+    // the held frames are copied
+    const QList<QColor> expectedColors({Qt::red, Qt::red, Qt::blue, Qt::blue});
+    for (int i = 0; i < expectedColors.size(); i++) {
+        QImage image;
+        QVERIFY(image.load(dir.filePath(QString("frames/frame%1.png").arg(i, 4, 10, QChar('0'))), "PNG"));
+        QCOMPARE(image.pixelColor(10, 10), expectedColors[i]);
+    }
+
+    // the existing frames are not overwritten
+    buffer.buffer().clear();
+    buffer.seek(0);
+
+    service.addJob(exportLine("2", input, output, "export-sequence"), &buffer);
+    QTRY_COMPARE_WITH_TIMEOUT(service.pendingJobs(), 0, 20000);
+
+    result = replies(buffer);
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result[0]["status"].toString(), QString("error"));
+    QVERIFY(result[0]["message"].toString().contains("already exist"));
+}
+
+KISTEST_MAIN(KisBatchConversionServiceTest)
@@ -0,0 +1,31 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBATCHCONVERSIONSERVICETEST_H
+#define KISBATCHCONVERSIONSERVICETEST_H
+
+#include <QObject>
+
+class KisBatchConversionServiceTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testParseRequest();
+    void testParseErrors_data();
+    void testParseErrors();
+    void testErrorReply();
+
+    void testQueue();
+    void testMemoryLimit();
+    void testQuit();
+
+    void testExport();
+    void testExportErrors();
+    void testExportSequence();
+};
+
+#endif // KISBATCHCONVERSIONSERVICETEST_H
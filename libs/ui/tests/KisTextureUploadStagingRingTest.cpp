@@ -0,0 +1,339 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTextureUploadStagingRingTest.h"
+
+#include <simpletest.h>
+
+#include <QSet>
+#include <QtConcurrentMap>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_debug.h"
+#include "kis_paint_device.h"
+
+// TODO: conversion options into a separate file!
+#include "kis_update_info.h"
+
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+#include "opengl/KisTextureUploadMemoryBackend.h"
+#include "opengl/KisTextureUploadStagingRing.h"
+#include "opengl/kis_texture_tile_update_info.h"
+
+namespace {
+
+const int textureSize = 256;
+const int textureBorder = 4;
+const int pixelSize = 4;
+
+void patternPixel(int x, int y, quint8 *dst)
+{
+    dst[0] = quint8(x & 0xff);
+    dst[1] = quint8(y & 0xff);
+    dst[2] = quint8(((x >> 8) & 0xf) | ((y >> 8) << 4));
+    dst[3] = 255;
+}
+
+KisPaintDeviceSP createPatternDevice(const QRect &bounds)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+
+    QVector<quint8> pixels(bounds.width() * bounds.height() * pixelSize);
+    quint8 *ptr = pixels.data();
+
+    for (int y = bounds.top(); y <= bounds.bottom(); y++) {
+        for (int x = bounds.left(); x <= bounds.right(); x++) {
+            patternPixel(x, y, ptr);
+            ptr += pixelSize;
+        }
+    }
+
+    dev->writeBytes(pixels.data(), bounds);
+    return dev;
+}
+
+struct UpdateInfoBuilder
+{
+    UpdateInfoBuilder()
+    {
+        builder.setTextureInfoPool(poolRegistry.getPool(textureSize, textureSize));
+        builder.setConversionOptions(
+            ConversionOptions(KoColorSpaceRegistry::instance()->rgb8(),
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags()));
+        builder.setTextureBorder(textureBorder);
+        builder.setEffectiveTextureSize(QSize(textureSize - 2 * textureBorder,
+                                              textureSize - 2 * textureBorder));
+    }
+
+    KisOpenGLUpdateInfoSP build(const QRect &rect, KisPaintDeviceSP dev, const QRect &bounds)
+    {
+        return builder.buildUpdateInfo(rect, dev, bounds, 0, false);
+    }
+
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisOpenGLUpdateInfoBuilder builder;
+};
+
+int commandBytes(const KisTextureUploadCommand &command)
+{
+    return command.rect.width() * command.rect.height() * pixelSize;
+}
+
+}
+
+void KisTextureUploadStagingRingTest::testUploadMatchesImage_data()
+{
+    QTest::addColumn<QRect>("updateRect");
+
+    QTest::newRow("entire") << QRect(0, 0, 300, 200);
+    QTest::newRow("interior") << QRect(100, 50, 60, 40);
+    QTest::newRow("left-bottom") << QRect(0, 150, 80, 50);
+    QTest::newRow("right-top") << QRect(250, 0, 50, 30);
+}
+
+void KisTextureUploadStagingRingTest::testUploadMatchesImage()
+{
+    QFETCH(QRect, updateRect);
+
+    const QRect bounds(0, 0, 300, 200);
+    KisPaintDeviceSP dev = createPatternDevice(bounds);
+
+    UpdateInfoBuilder builder;
+    KisOpenGLUpdateInfoSP info = builder.build(updateRect, dev, bounds);
+    QVERIFY(!info->tileList.isEmpty());
+
+    KisTextureUploadMemoryBackend *backend = new KisTextureUploadMemoryBackend(pixelSize);
+
+    KisTextureUploadStagingRing ring;
+    QVERIFY(ring.allocate(backend, 4, textureSize * textureSize * pixelSize));
+
+    Q_FOREACH (KisTextureTileUpdateInfoSP tileInfo, info->tileList) {
+        KisTextureUploadStagingBufferSP buffer = ring.stage(*tileInfo);
+        QVERIFY(buffer);
+
+        KisTextureUploadMemoryBackend::Texture texture(tileInfo->realTileSize(), pixelSize);
+        backend->bindTexture(&texture);
+        QVERIFY(buffer->upload());
+        backend->bindTexture(nullptr);
+
+        const QRect tileRect(tileInfo->realPatchRect().topLeft() - tileInfo->realPatchOffset(),
+                             tileInfo->realTileSize());
+
+        // every texel written by the commands should repeat the nearest pixel of the image
+        Q_FOREACH (const KisTextureUploadCommand &command, buffer->commands()) {
+            for (int y = command.rect.top(); y <= command.rect.bottom(); y++) {
+                for (int x = command.rect.left(); x <= command.rect.right(); x++) {
+                    const int imageX = qBound(bounds.left(), tileRect.x() + x, bounds.right());
+                    const int imageY = qBound(bounds.top(), tileRect.y() + y, bounds.bottom());
+
+                    quint8 expected[pixelSize];
+                    patternPixel(imageX, imageY, expected);
+
+                    if (memcmp(texture.pixel(x, y), expected, pixelSize) != 0) {
+                        qDebug() << ppVar(tileInfo->tileCol()) << ppVar(tileInfo->tileRow())
+                                 << ppVar(command.rect) << ppVar(x) << ppVar(y);
+                        QFAIL("texel differs from the image");
+                    }
+                }
+            }
+        }
+
+        ring.fenceUploadedBuffers();
+        ring.recycleSignaledBuffers();
+    }
+
+    QCOMPARE(ring.numFreeBuffers(), ring.size());
+}
+
+void KisTextureUploadStagingRingTest::testStripesAreSingleCommands()
+{
+    const QRect bounds(0, 0, 300, 200);
+    KisPaintDeviceSP dev = createPatternDevice(bounds);
+
+    UpdateInfoBuilder builder;
+    KisOpenGLUpdateInfoSP info = builder.build(bounds, dev, bounds);
+    QCOMPARE(info->tileList.size(), 2);
+
+    KisTextureTileUpdateInfoSP leftTile = info->tileList[0];
+    KisTextureTileUpdateInfoSP rightTile = info->tileList[1];
+
+    QVector<quint8> buffer(textureSize * textureSize * pixelSize);
+
+    {
+        const QVector<KisTextureUploadCommand> commands =
+            KisTextureUploadStagingRing::pack(*leftTile, buffer.data());
+
+        QCOMPARE(commands.size(), 4);
+        QCOMPARE(commands[0].rect, QRect(4, 4, 252, 200));
+        QCOMPARE(commands[1].rect, QRect(4, 0, 252, 4));
+        QCOMPARE(commands[2].rect, QRect(4, 204, 252, 3));
+        QCOMPARE(commands[3].rect, QRect(0, 4, 4, 200));
+    }
+
+    {
+        const QVector<KisTextureUploadCommand> commands =
+            KisTextureUploadStagingRing::pack(*rightTile, buffer.data());
+
+        QCOMPARE(commands.size(), 4);
+        QCOMPARE(commands[0].rect, QRect(0, 4, 56, 200));
+        QCOMPARE(commands[1].rect, QRect(0, 0, 56, 4));
+        QCOMPARE(commands[2].rect, QRect(0, 204, 56, 3));
+        QCOMPARE(commands[3].rect, QRect(56, 4, 4, 200));
+
+        // the packed pixels are laid out back to back
+        int offset = 0;
+        Q_FOREACH (const KisTextureUploadCommand &command, commands) {
+            QCOMPARE(command.offset, offset);
+            QVERIFY(!command.allocateLevel);
+            offset += commandBytes(command);
+        }
+        QCOMPARE(KisTextureUploadStagingRing::packedSize(*rightTile), offset);
+    }
+}
+
+void KisTextureUploadStagingRingTest::testRingFull()
+{
+    const QRect bounds(0, 0, 600, 200);
+    KisPaintDeviceSP dev = createPatternDevice(bounds);
+
+    UpdateInfoBuilder builder;
+    KisOpenGLUpdateInfoSP info = builder.build(bounds, dev, bounds);
+    QCOMPARE(info->tileList.size(), 3);
+
+    KisTextureUploadStagingRing ring;
+    QVERIFY(ring.allocate(new KisTextureUploadMemoryBackend(pixelSize), 2, textureSize * textureSize * pixelSize));
+
+    KisTextureUploadStagingBufferSP buffer0 = ring.stage(*info->tileList[0]);
+    KisTextureUploadStagingBufferSP buffer1 = ring.stage(*info->tileList[1]);
+    KisTextureUploadStagingBufferSP buffer2 = ring.stage(*info->tileList[2]);
+
+    QVERIFY(buffer0);
+    QVERIFY(buffer1);
+    QVERIFY(!buffer2);
+    QCOMPARE(ring.numFreeBuffers(), 0);
+
+    // the buffer that has never been uploaded returns to the ring immediately
+    buffer0.clear();
+    QCOMPARE(ring.numFreeBuffers(), 1);
+
+    buffer2 = ring.stage(*info->tileList[2]);
+    QVERIFY(buffer2);
+    QCOMPARE(ring.numFreeBuffers(), 0);
+}
+
+void KisTextureUploadStagingRingTest::testBuffersRecycledAfterFence()
+{
+    const QRect bounds(0, 0, 300, 200);
+    KisPaintDeviceSP dev = createPatternDevice(bounds);
+
+    UpdateInfoBuilder builder;
+    KisOpenGLUpdateInfoSP info = builder.build(bounds, dev, bounds);
+
+    KisTextureUploadMemoryBackend *backend = new KisTextureUploadMemoryBackend(pixelSize);
+    backend->setAutoSignalFences(false);
+
+    KisTextureUploadStagingRing ring;
+    QVERIFY(ring.allocate(backend, 2, textureSize * textureSize * pixelSize));
+
+    KisTextureUploadStagingBufferSP buffer0 = ring.stage(*info->tileList[0]);
+    KisTextureUploadStagingBufferSP buffer1 = ring.stage(*info->tileList[1]);
+
+    QVERIFY(buffer0->upload());
+    QVERIFY(buffer1->upload());
+    QCOMPARE(backend->numCopies(), buffer0->commands().size() + buffer1->commands().size());
+
+    // the second upload of the same buffer is refused
+    QVERIFY(!buffer0->upload());
+
+    ring.fenceUploadedBuffers();
+    QCOMPARE(backend->numPendingFences(), 1);
+
+    // the buffers are still read by the GPU
+    buffer0.clear();
+    buffer1.clear();
+    ring.recycleSignaledBuffers();
+    QCOMPARE(ring.numFreeBuffers(), 0);
+    QVERIFY(!ring.stage(*info->tileList[0]));
+
+    backend->signalFences();
+    ring.recycleSignaledBuffers();
+    QCOMPARE(ring.numFreeBuffers(), 2);
+}
+
+void KisTextureUploadStagingRingTest::testStaleBufferAfterReallocation()
+{
+    const QRect bounds(0, 0, 300, 200);
+    KisPaintDeviceSP dev = createPatternDevice(bounds);
+
+    UpdateInfoBuilder builder;
+    KisOpenGLUpdateInfoSP info = builder.build(bounds, dev, bounds);
+
+    KisTextureUploadStagingRing ring;
+    QVERIFY(ring.allocate(new KisTextureUploadMemoryBackend(pixelSize), 2, textureSize * textureSize * pixelSize));
+
+    KisTextureUploadStagingBufferSP buffer = ring.stage(*info->tileList[0]);
+    QVERIFY(buffer);
+
+    KisTextureUploadMemoryBackend *backend = new KisTextureUploadMemoryBackend(pixelSize);
+    QVERIFY(ring.allocate(backend, 2, textureSize * textureSize * pixelSize));
+
+    QVERIFY(!buffer->upload());
+    QCOMPARE(backend->numCopies(), 0);
+
+    buffer.clear();
+    QCOMPARE(ring.numFreeBuffers(), 2);
+
+    ring.reset();
+    QVERIFY(!ring.isValid());
+    QVERIFY(!ring.stage(*info->tileList[0]));
+}
+
+void KisTextureUploadStagingRingTest::testConcurrentStaging()
+{
+    const QRect bounds(0, 0, 1200, 1000);
+    KisPaintDeviceSP dev = createPatternDevice(bounds);
+
+    UpdateInfoBuilder builder;
+    KisOpenGLUpdateInfoSP info = builder.build(bounds, dev, bounds);
+    QCOMPARE(info->tileList.size(), 25);
+
+    KisTextureUploadStagingRing ring;
+    QVERIFY(ring.allocate(new KisTextureUploadMemoryBackend(pixelSize), 32, textureSize * textureSize * pixelSize));
+
+    struct StagingJob {
+        KisTextureTileUpdateInfoSP tileInfo;
+        KisTextureUploadStagingBufferSP buffer;
+    };
+
+    QVector<StagingJob> jobs;
+    Q_FOREACH (KisTextureTileUpdateInfoSP tileInfo, info->tileList) {
+        jobs << StagingJob{tileInfo, KisTextureUploadStagingBufferSP()};
+    }
+
+    QtConcurrent::blockingMap(jobs,
+        [&ring] (StagingJob &job) {
+            job.buffer = ring.stage(*job.tileInfo);
+        });
+
+    QSet<int> usedIndexes;
+    QVector<quint8> reference(textureSize * textureSize * pixelSize);
+
+    Q_FOREACH (const StagingJob &job, jobs) {
+        QVERIFY(job.buffer);
+        usedIndexes.insert(job.buffer->bufferIndex());
+
+        QCOMPARE(job.buffer->commands(),
+                 KisTextureUploadStagingRing::pack(*job.tileInfo, reference.data()));
+    }
+
+    QCOMPARE(usedIndexes.size(), jobs.size());
+    QCOMPARE(ring.numFreeBuffers(), ring.size() - jobs.size());
+}
+
+SIMPLE_TEST_MAIN(KisTextureUploadStagingRingTest)
@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTEXTUREUPLOADSTAGINGRINGTEST_H
+#define KISTEXTUREUPLOADSTAGINGRINGTEST_H
+
+#include <QObject>
+
+class KisTextureUploadStagingRingTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testUploadMatchesImage_data();
+    void testUploadMatchesImage();
+    void testStripesAreSingleCommands();
+    void testRingFull();
+    void testBuffersRecycledAfterFence();
+    void testStaleBufferAfterReallocation();
+    void testConcurrentStaging();
+};
+
+#endif // KISTEXTUREUPLOADSTAGINGRINGTEST_H
@@ -48,7 +48,8 @@ KisPainterBasedStrokeStrategy::KisPainterBasedStrokeStrategy(const QLatin1String
       m_transaction(0),
       m_useMergeID(false),
       m_supportsMaskingBrush(false),
-      m_supportsIndirectPainting(false)
+      m_supportsIndirectPainting(false),
+      m_memoryAllocator(new KisOptimizedByteArray::PooledMemoryAllocator())
 {
     init();
 }
@@ -63,7 +64,8 @@ KisPainterBasedStrokeStrategy::KisPainterBasedStrokeStrategy(const QLatin1String
       m_transaction(0),
       m_useMergeID(false),
       m_supportsMaskingBrush(false),
-      m_supportsIndirectPainting(false)
+      m_supportsIndirectPainting(false),
+      m_memoryAllocator(new KisOptimizedByteArray::PooledMemoryAllocator())
 {
     init();
 }
@@ -88,7 +90,8 @@ KisPainterBasedStrokeStrategy::KisPainterBasedStrokeStrategy(const KisPainterBas
       m_useMergeID(rhs.m_useMergeID),
       m_supportsMaskingBrush(rhs.m_supportsMaskingBrush),
       m_supportsIndirectPainting(rhs.m_supportsIndirectPainting),
-      m_supportsContinuedInterstrokeData(rhs.m_supportsContinuedInterstrokeData)
+      m_supportsContinuedInterstrokeData(rhs.m_supportsContinuedInterstrokeData),
+      m_memoryAllocator(new KisOptimizedByteArray::PooledMemoryAllocator())
 {
     Q_FOREACH (KisFreehandStrokeInfo *info, rhs.m_strokeInfos) {
         m_strokeInfos.append(new KisFreehandStrokeInfo(info, levelOfDetail));
@@ -122,6 +125,12 @@ int KisPainterBasedStrokeStrategy::numMaskedPainters() const
     return m_maskedPainters.size();
 }
 
+KisOptimizedByteArray::PooledMemoryAllocator::Statistics
+KisPainterBasedStrokeStrategy::memoryAllocationStatistics() const
+{
+    return m_memoryAllocator->statistics();
+}
+
 bool KisPainterBasedStrokeStrategy::needsMaskingUpdates() const
 {
     return m_maskingBrushRenderer;
@@ -194,6 +203,7 @@ void KisPainterBasedStrokeStrategy::initPainters(KisPaintDeviceSP targetDevice,
 
         painter->begin(targetDevice, !hasIndirectPainting ? selection : nullptr);
         painter->setRunnableStrokeJobsInterface(runnableJobsInterface());
+        painter->setMemoryAllocator(m_memoryAllocator);
         m_resources->setupPainter(painter);
 
         if(hasIndirectPainting) {
@@ -211,6 +221,7 @@ void KisPainterBasedStrokeStrategy::initPainters(KisPaintDeviceSP targetDevice,
             KisPainter *painter = maskingInfo->painter;
 
             painter->begin(maskingDevice, nullptr);
+            painter->setMemoryAllocator(m_memoryAllocator);
             m_resources->setupMaskingBrushPainter(painter);
 
             KIS_SAFE_ASSERT_RECOVER_NOOP(hasIndirectPainting);
@@ -13,6 +13,7 @@
 #include "kis_resources_snapshot.h"
 #include "kis_selection.h"
 #include "kis_indirect_painting_support.h"
+#include "KisOptimizedByteArray.h"
 
 class KisPainter;
 class KisDistanceInformation;
@@ -45,6 +46,15 @@ public:
     void suspendStrokeCallback() override;
     void resumeStrokeCallback() override;
 
+    /**
+     * All the painters of the stroke allocate their dabs and temporary
+     * buffers from a single pool owned by the stroke, so the buffers
+     * are recycled between the dabs. The returned statistics tell how
+     * many of the allocations could not be served by the pool and had
+     * to go to the system heap.
+     */
+    KisOptimizedByteArray::PooledMemoryAllocator::Statistics memoryAllocationStatistics() const;
+
 protected:
     KisNodeSP targetNode() const;
     KisPaintDeviceSP targetDevice() const;
@@ -135,6 +145,8 @@ private:
     bool m_supportsIndirectPainting {false};
     bool m_supportsContinuedInterstrokeData {false};
 
+    KisOptimizedByteArray::PooledMemoryAllocatorSP m_memoryAllocator;
+
     KisIndirectPaintingSupport::FinalMergeSuspenderSP m_finalMergeSuspender;
 
     struct FakeUndoData {
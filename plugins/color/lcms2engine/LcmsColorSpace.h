@@ -13,6 +13,8 @@
 #include <array>
 #include <kis_lockless_stack.h>
 #include <KoColorSpaceAbstract.h>
+#include <KoOptimizedPerChannelAdjustmentFactory.h>
+#include <QVarLengthArray>
 
 #include "colorprofiles/LcmsColorProfileContainer.h"
 #include "kis_assert.h"
@@ -105,35 +107,31 @@ class LcmsColorSpace : public KoColorSpaceAbstract<_CSTraits>, public KoLcmsInfo
         {
             cmsDoTransform(cmstransform, const_cast<quint8 *>(src), dst, nPixels);
 
-            qint32 numPixels = nPixels;
-            qint32 pixelSize = m_colorSpace->pixelSize();
-            int index = 0;
+            if (_CSTraits::alpha_pos < 0) return;
+
+            // the alpha channel is accessed through the traits of the color
+            // space directly, the virtual per-pixel calls are too slow here
+            typedef typename _CSTraits::channels_type channels_type;
+            const qint32 pixelSize = _CSTraits::pixelSize;
 
             if (cmsAlphaTransform) {
-                float *alpha = new float[nPixels];
-                float *dstalpha = new float[nPixels];
+                QVarLengthArray<float, 1024> alpha(nPixels);
 
-                while (index < nPixels) {
-                    alpha[index] = m_colorSpace->opacityF(src);
-                    src += pixelSize;
-                    index++;
+                const quint8 *srcPixel = src;
+                for (int i = 0; i < nPixels; i++, srcPixel += pixelSize) {
+                    alpha[i] = _CSTraits::opacityF(srcPixel);
                 }
 
-                cmsDoTransform(cmsAlphaTransform, const_cast<float *>(alpha), static_cast<float *>(dstalpha), nPixels);
-                for (int i = 0; i < numPixels; i++) {
-                    m_colorSpace->setOpacity(dst, dstalpha[i], 1);
-                    dst += pixelSize;
-                }
+                cmsDoTransform(cmsAlphaTransform, alpha.data(), alpha.data(), nPixels);
 
-                delete [] alpha;
-                delete [] dstalpha;
+                for (int i = 0; i < nPixels; i++, dst += pixelSize) {
+                    _CSTraits::nativeArray(dst)[_CSTraits::alpha_pos] =
+                        KoColorSpaceMaths<qreal, channels_type>::scaleToA(alpha[i]);
+                }
             } else {
-                while (numPixels > 0) {
-                    qreal alpha = m_colorSpace->opacityF(src);
-                    m_colorSpace->setOpacity(dst, alpha, 1);
-                    src += pixelSize;
-                    dst += pixelSize;
-                    numPixels--;
+                for (int i = 0; i < nPixels; i++, src += pixelSize, dst += pixelSize) {
+                    _CSTraits::nativeArray(dst)[_CSTraits::alpha_pos] =
+                        _CSTraits::nativeArray(src)[_CSTraits::alpha_pos];
                 }
             }
         }
@@ -328,6 +326,13 @@ public:
             return 0;
         }
 
+        KoColorTransformation *optimizedAdjustment =
+            KoOptimizedPerChannelAdjustmentFactory::create(this, transferValues);
+
+        if (optimizedAdjustment) {
+            return optimizedAdjustment;
+        }
+
         cmsToneCurve **transferFunctions = new cmsToneCurve*[ this->colorChannelCount()];
 
         for (uint ch = 0; ch < this->colorChannelCount(); ch++) {
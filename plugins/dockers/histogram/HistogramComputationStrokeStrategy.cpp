@@ -6,30 +6,20 @@
  */
 #include "HistogramComputationStrokeStrategy.h"
 
+#include <QThread>
+
 #include "KoColorSpace.h"
 
-#include "krita_utils.h"
 #include "kis_image.h"
-#include "kis_sequential_iterator.h"
+#include "kis_paint_device.h"
+#include "KisHistogramIndex.h"
+#include "KisRunnableStrokeJobUtils.h"
+#include "KisRunnableStrokeJobsInterface.h"
 
 struct HistogramComputationStrokeStrategy::Private
 {
-
-    class ProcessData : public KisStrokeJobData
-    {
-    public:
-        ProcessData(QRect rect, int _jobId)
-            : KisStrokeJobData(CONCURRENT)
-            , rectToCalculate(rect)
-            , jobId(_jobId)
-        {}
-
-        QRect rectToCalculate;
-        int jobId; // id in the list of results
-    };
-
     KisImageSP image;
-    std::vector<HistVector> results;
+    HistogramData result;
 };
 
 
@@ -46,102 +36,46 @@ HistogramComputationStrokeStrategy::~HistogramComputationStrokeStrategy()
 
 void HistogramComputationStrokeStrategy::initStrokeCallback()
 {
+    using KritaUtils::addJobConcurrent;
+    using KritaUtils::addJobSequential;
     KisIdleTaskStrokeStrategy::initStrokeCallback();
 
-    QVector<KisStrokeJobData*> jobsData;
-    int i = 0;
-    QVector<QRect> tileRects = KritaUtils::splitRectIntoPatches(m_d->image->bounds(), KritaUtils::optimalPatchSize());
-    m_d->results.resize(tileRects.size());
+    /**
+     * The index belongs to the projection, so only the tiles changed
+     * since the previous update of the histogram are binned again
+     */
+    KisPaintDeviceSP projection = m_d->image->projection();
+    KisHistogramIndex *index = projection->histogramIndex();
 
-    Q_FOREACH (const QRect &tileRectangle, tileRects) {
-        jobsData << new HistogramComputationStrokeStrategy::Private::ProcessData(tileRectangle, i);
-        i++;
-    }
-    addMutatedJobs(jobsData);
-}
+    const QVector<QRect> tileRects = index->beginUpdate(projection);
 
-void HistogramComputationStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
-{
-    Private::ProcessData *d_pd = dynamic_cast<Private::ProcessData*>(data);
-
-    if (!d_pd) {
-        KisIdleTaskStrokeStrategy::doStrokeCallback(data);
-        return;
+    const int numJobs = qMin(tileRects.size(), qMax(1, QThread::idealThreadCount()) * 2);
+    QVector<QVector<QRect>> jobRects(numJobs);
+    for (int i = 0; i < tileRects.size(); i++) {
+        jobRects[i % numJobs] << tileRects[i];
     }
 
-    QRect calculate = d_pd->rectToCalculate;
-
-    KisPaintDeviceSP m_dev = m_d->image->projection();
-    QRect imageBounds = m_d->image->bounds();
-
-    const KoColorSpace *cs = m_dev->colorSpace();
-    quint32 channelCount = m_dev->channelCount();
-    quint32 pixelSize = m_dev->pixelSize();
-
-    int imageSize = imageBounds.width() * imageBounds.height();
-    int nSkip = 1 + (imageSize >> 20); //for speed use about 1M pixels for computing histograms
-
-    if (calculate.isEmpty())
-        return;
-
-    initiateVector(m_d->results[d_pd->jobId], cs);
+    QVector<KisRunnableStrokeJobData*> jobs;
 
-    quint32 toSkip = nSkip;
-
-    KisSequentialConstIterator it(m_dev, calculate);
+    for (const QVector<QRect> &rects : jobRects) {
+        addJobConcurrent(jobs, [index, projection, rects] () {
+            index->updateTiles(projection, rects);
+        });
+    }
 
-    int numConseqPixels = it.nConseqPixels();
-    while (it.nextPixels(numConseqPixels)) {
+    addJobSequential(jobs, [this, index] () {
+        m_d->result.bins = index->bins();
+        m_d->result.colorSpace = index->colorSpace();
+    });
 
-        numConseqPixels = it.nConseqPixels();
-        const quint8* pixel = it.rawDataConst();
-        for (int k = 0; k < numConseqPixels; ++k) {
-            if (--toSkip == 0) {
-                for (int chan = 0; chan < (int)channelCount; ++chan) {
-                    m_d->results[d_pd->jobId][chan][cs->scaleToU8(pixel, chan)]++;
-                }
-                toSkip = nSkip;
-            }
-            pixel += pixelSize;
-        }
-    }
+    runnableJobsInterface()->addRunnableJobs(jobs);
 }
 
 void HistogramComputationStrokeStrategy::finishStrokeCallback()
 {
-    HistogramData hisData;
-    hisData.colorSpace = m_d->image->projection()->colorSpace();
-
-    if (m_d->results.size() == 1) {
-        hisData.bins = m_d->results[0];
-        emit computationResultReady(hisData);
-    } else {
-
-        quint32 channelCount = m_d->image->projection()->channelCount();
-
-        initiateVector(hisData.bins, hisData.colorSpace);
-
-        for (int chan = 0; chan < (int)channelCount; chan++) {
-            int bsize = hisData.bins[chan].size();
-
-            for (int bi = 0; bi < bsize; bi++) {
-                hisData.bins[chan][bi] = 0;
-                for (int i = 0; i < (int)m_d->results.size(); i++) {
-                    hisData.bins[chan][bi] += m_d->results[i][chan][bi];
-                }
-            }
-        }
-
-        emit computationResultReady(hisData);
+    if (m_d->result.colorSpace) {
+        emit computationResultReady(m_d->result);
     }
 
     KisIdleTaskStrokeStrategy::finishStrokeCallback();
 }
-
-void HistogramComputationStrokeStrategy::initiateVector(HistVector &vec, const KoColorSpace *colorSpace)
-{
-    vec.resize(colorSpace->channelCount());
-    for (auto &bin : vec) {
-        bin.resize(std::numeric_limits<quint8>::max() + 1);
-    }
-}
@@ -32,11 +32,8 @@ public:
 
 private:
     void initStrokeCallback() override;
-    void doStrokeCallback(KisStrokeJobData *data) override;
     void finishStrokeCallback() override;
 
-    void initiateVector(HistVector &vec, const KoColorSpace* colorSpace);
-
 Q_SIGNALS:
     //Emitted when thumbnail is updated and overviewImage is fully generated.
     void computationResultReady(HistogramData data);
@@ -52,7 +52,7 @@ KisIdleTasksManager::TaskGuard HistogramDockerWidget::registerIdleTask(KisCanvas
             connect(strategy, SIGNAL(computationResultReady(HistogramData)), this, SLOT(receiveNewHistogram(HistogramData)));
 
             return strategy;
-        });
+        }, KisIdleTasksManager::LowPriority);
 }
 
 void HistogramDockerWidget::clearCachedState()
@@ -158,7 +158,11 @@ void KisLensBlurFilter::processImpl(KisPaintDeviceSP device,
         }
     }
 
-    // apply convolution
+    /**
+     * The painter chooses the engine itself: square irises decompose into
+     * a single separable term, while the round ones have too high rank and
+     * are processed with FFT
+     */
     KisConvolutionPainter painter(device);
     painter.setChannelFlags(channelFlags);
     painter.setProgress(progressUpdater);
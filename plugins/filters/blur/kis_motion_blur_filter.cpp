@@ -76,12 +76,33 @@ struct MotionBlurProperties
         QPointF p1(0.5 * kernelSize.width(), 0.5 * kernelSize.height());
         QPointF p2(halfWidth, halfHeight);
         motionLine = QLineF(p1 - p2, p1 + p2);
+        halfLine = p2;
+    }
+
+    /**
+     * Long blurs are calculated with running sums along the line,
+     * which costs the same for any length of the blur. Short ones go
+     * through the convolution painter, which renders the antialiased
+     * line more precisely.
+     */
+    bool useLineIntegral() const {
+        const int LineIntegralThreshold = 32;
+        return qMax(kernelSize.width(), kernelSize.height()) > LineIntegralThreshold;
+    }
+
+    /**
+     * The line integral reads one extra pixel in the direction
+     * orthogonal to the line
+     */
+    QSize neededHalfSize() const {
+        return useLineIntegral() ? kernelHalfSize + QSize(1, 1) : kernelHalfSize;
     }
 
     int blurLength;
     QSize kernelSize;
     QSize kernelHalfSize;
     QLineF motionLine;
+    QPointF halfLine;
 };
 }
 
@@ -113,6 +134,14 @@ void KisMotionBlurFilter::processImpl(KisPaintDeviceSP device,
         channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
     }
 
+    if (props.useLineIntegral()) {
+        KisConvolutionPainter painter(device);
+        painter.setChannelFlags(channelFlags);
+        painter.setProgress(progressUpdater);
+        painter.applyLineIntegral(props.halfLine, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+        return;
+    }
+
     QImage kernelRepresentation(props.kernelSize, QImage::Format_RGB32);
     kernelRepresentation.fill(0);
 
@@ -142,7 +171,8 @@ QRect KisMotionBlurFilter::neededRect(const QRect & rect, const KisFilterConfigu
 {
     KisLodTransformScalar t(lod);
     MotionBlurProperties props(_config, t);
-    return rect.adjusted(-props.kernelHalfSize.width(), -props.kernelHalfSize.height(), props.kernelHalfSize.width(), props.kernelHalfSize.height());
+    const QSize halfSize = props.neededHalfSize();
+    return rect.adjusted(-halfSize.width(), -halfSize.height(), halfSize.width(), halfSize.height());
 }
 
 QRect KisMotionBlurFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
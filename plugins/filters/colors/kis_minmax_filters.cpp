@@ -14,7 +14,7 @@
 #include <kis_selection.h>
 #include <kis_paint_device.h>
 #include <kis_processing_information.h>
-#include <KisSequentialIteratorProgress.h>
+#include <KisTileSpanIterator.h>
 
 
 typedef void (*funcMaxMin)(const quint8* , quint8* , uint);
@@ -87,9 +87,20 @@ void KisFilterMax::processImpl(KisPaintDeviceSP device,
         return;
     }
 
-    KisSequentialIteratorProgress it(device, rect, progressUpdater);
-    while (it.nextPixel()) {
-        F(it.oldRawData(), it.rawData(), nC);
+    const int pixelSize = cs->pixelSize();
+
+    KisTileSpanIteratorProgress it(device, rect, progressUpdater);
+    while (it.nextSpan()) {
+        const quint8 *srcRow = it.oldRawData();
+        quint8 *dstRow = it.rawData();
+
+        for (int y = 0; y < it.spanHeight(); y++) {
+            for (int x = 0; x < it.spanWidth(); x++) {
+                F(srcRow + x * pixelSize, dstRow + x * pixelSize, nC);
+            }
+            srcRow += it.rowStride();
+            dstRow += it.rowStride();
+        }
     }
 }
 
@@ -124,9 +135,20 @@ void KisFilterMin::processImpl(KisPaintDeviceSP device,
         return;
     }
 
-    KisSequentialIteratorProgress it(device, rect, progressUpdater);
-    while (it.nextPixel()) {
-        F(it.oldRawData(), it.rawData(), nC);
+    const int pixelSize = cs->pixelSize();
+
+    KisTileSpanIteratorProgress it(device, rect, progressUpdater);
+    while (it.nextSpan()) {
+        const quint8 *srcRow = it.oldRawData();
+        quint8 *dstRow = it.rawData();
+
+        for (int y = 0; y < it.spanHeight(); y++) {
+            for (int x = 0; x < it.spanWidth(); x++) {
+                F(srcRow + x * pixelSize, dstRow + x * pixelSize, nC);
+            }
+            srcRow += it.rowStride();
+            dstRow += it.rowStride();
+        }
     }
 }
 
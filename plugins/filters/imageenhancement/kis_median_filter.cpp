@@ -0,0 +1,122 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_median_filter.h"
+
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include <kis_global.h>
+#include <widgets/kis_multi_integer_filter_widget.h>
+#include <filter/kis_filter_category_ids.h>
+#include <filter/kis_filter_configuration.h>
+#include <kis_paint_device.h>
+#include <KisSlidingWindowHistogram.h>
+#include <KisGlobalResourcesInterface.h>
+#include "kis_lod_transform.h"
+
+
+KisMedianFilter::KisMedianFilter()
+    : KisFilter(id(), FiltersCategoryEnhanceId, i18n("&Median..."))
+{
+    setSupportsPainting(true);
+    setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
+
+    // the sliding window histogram distributes the work itself
+    setSupportsThreading(false);
+}
+
+KisMedianFilter::~KisMedianFilter()
+{
+}
+
+KisConfigWidget * KisMedianFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool) const
+{
+    Q_UNUSED(dev);
+    vKisIntegerWidgetParam param;
+    param.push_back(KisIntegerWidgetParam(1, 100, 2, i18n("Radius"), "radius"));
+    param.push_back(KisIntegerWidgetParam(0, 100, 50, i18nc("rank of the picked value, 50% is the median", "Percentile"), "percentile"));
+    KisMultiIntegerFilterWidget *w = new KisMultiIntegerFilterWidget(id().id(), parent, id().id(), param);
+    w->setConfiguration(defaultConfiguration(KisGlobalResourcesInterface::instance()));
+    return w;
+}
+
+KisFilterConfigurationSP KisMedianFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
+{
+    KisFilterConfigurationSP config = factoryConfiguration(resourcesInterface);
+    config->setProperty("radius", 2);
+    config->setProperty("percentile", 50);
+    return config;
+}
+
+void KisMedianFilter::processImpl(KisPaintDeviceSP device,
+                                  const QRect& applyRect,
+                                  const KisFilterConfigurationSP config,
+                                  KoUpdater* progressUpdater
+                                  ) const
+{
+    Q_ASSERT(device);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(config);
+
+    KisLodTransformScalar t(device);
+    const int radius = qMax(0, qRound(t.scale(qreal(config->getInt("radius", 2)))));
+    const qreal rank = qBound(0, config->getInt("percentile", 50), 100) / 100.0;
+
+    const KoColorSpace *cs = device->colorSpace();
+    const int channelCount = cs->channelCount();
+    const int pixelSize = cs->pixelSize();
+
+    KisSlidingWindowHistogram histogram(256, channelCount);
+
+    auto sampleFunc = [cs] (const quint8 *pixel, float *accumulators, QVector<float> &channels) {
+        if (cs->opacityU8(pixel) == 0) {
+            return -1;
+        }
+
+        cs->normalisedChannelsValue(pixel, channels);
+        std::copy(channels.begin(), channels.end(), accumulators);
+
+        return int(cs->intensity8(pixel));
+    };
+
+    auto resultFunc = [cs, channelCount, pixelSize, rank] (const KisSlidingWindowHistogram::Window &window,
+                                                           const quint8 *centerPixel,
+                                                           quint8 *dst,
+                                                           QVector<float> &channels) {
+        Q_UNUSED(centerPixel);
+
+        const int bin = KisSlidingWindowHistogram::findRank(window, rank);
+
+        if (bin >= 0) {
+            const quint32 count = window.counts[bin];
+            const float *sums = window.binSums(bin);
+
+            for (int i = 0; i < channelCount; i++) {
+                channels[i] = sums[i] / count;
+            }
+            cs->fromNormalisedChannelsValue(dst, channels);
+        } else {
+            memset(dst, 0, pixelSize);
+        }
+    };
+
+    histogram.process(device, device, applyRect, radius, sampleFunc, resultFunc, progressUpdater);
+}
+
+QRect KisMedianFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    const int radius = _config->getInt("radius", 2);
+    const int margin = qCeil(t.scale(qreal(radius)));
+    return kisGrowRect(rect, margin);
+}
+
+QRect KisMedianFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    return neededRect(rect, _config, lod);
+}
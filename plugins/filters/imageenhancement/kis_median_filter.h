@@ -0,0 +1,47 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_MEDIAN_FILTER_H
+#define KIS_MEDIAN_FILTER_H
+
+#include <filter/kis_filter.h>
+#include "kis_config_widget.h"
+
+/**
+ * A rank filter over the intensity of the pixels. For every pixel it
+ * finds the intensity level of the given rank (the median by default) in
+ * the window around the pixel and writes the average color of the pixels
+ * having this level. Ranking by intensity instead of per-channel avoids
+ * introducing colors that don't exist in the image.
+ *
+ * The window histograms are maintained by KisSlidingWindowHistogram, so
+ * the filter runs in constant time per pixel regardless of the radius.
+ */
+class KisMedianFilter : public KisFilter
+{
+public:
+    KisMedianFilter();
+    ~KisMedianFilter() override;
+public:
+
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect& applyRect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater
+                     ) const override;
+    KisConfigWidget * createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool useForMasks) const override;
+
+    static inline KoID id() {
+        return KoID("median", i18n("Median"));
+    }
+
+    QRect changedRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+    QRect neededRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+
+    KisFilterConfigurationSP defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const override;
+};
+
+#endif
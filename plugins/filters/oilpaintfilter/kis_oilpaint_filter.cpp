@@ -37,6 +37,7 @@
 #include <filter/kis_filter_configuration.h>
 #include <kis_processing_information.h>
 #include <kis_paint_device.h>
+#include <KisSlidingWindowHistogram.h>
 #include "widgets/kis_multi_integer_filter_widget.h"
 #include <KisGlobalResourcesInterface.h>
 
@@ -67,122 +68,73 @@ void KisOilPaintFilter::processImpl(KisPaintDeviceSP device,
 
 /* Function to apply the OilPaint effect.
  *
- * data             => The image data in RGBA mode.
- * w                => Width of image.
- * h                => Height of image.
+ * src              => The source paint device.
+ * dst              => The destination paint device.
  * BrushSize        => Brush size.
  * Smoothness       => Smooth value.
  *
- * Theory           => Using MostFrequentColor function we take the main color in
- *                     a matrix and simply write at the original position.
+ * Theory           => For every pixel we take the most frequent intensity level in
+ *                     a matrix around it and write the average color of the pixels
+ *                     of this level at the original position. The histograms of the
+ *                     matrices are maintained by KisSlidingWindowHistogram, so the
+ *                     cost per pixel does not depend on the brush size.
  */
 
 void KisOilPaintFilter::OilPaint(const KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &applyRect,
                                  int BrushSize, int Smoothness, KoUpdater* progressUpdater) const
 {
-    KisSequentialConstIteratorProgress it(src, applyRect, progressUpdater);
-    KisSequentialIterator dstIt(dst, applyRect);
-
-    while (it.nextPixel() && dstIt.nextPixel()) {
-        MostFrequentColor(src, dstIt.rawData(), applyRect, it.x(), it.y(), BrushSize, Smoothness);
-    }
-}
-
-// This method has been ported from Pieter Z. Voloshyn's algorithm code in Digikam.
-
-/* Function to determine the most frequent color in a matrix
- *
- * Bits             => Bits array
- * Width            => Image width
- * Height           => Image height
- * X                => Position horizontal
- * Y                => Position vertical
- * Radius           => Is the radius of the matrix to be analyzed
- * Intensity        => Intensity to calculate
- *
- * Theory           => This function creates a matrix with the analyzed pixel in
- *                     the center of this matrix and find the most frequent color
- */
-
-void KisOilPaintFilter::MostFrequentColor(KisPaintDeviceSP src, quint8* dst, const QRect& /*bounds*/, int X, int Y, int Radius, int Intensity) const
-{
-    uint I;
-
-    double Scale = Intensity / 255.0;
-
-    // Alloc some arrays to be used
-    uchar *IntensityCount = new uchar[(Intensity + 1)];
-
     const KoColorSpace* cs = src->colorSpace();
+    const int channelCount = cs->channelCount();
+    const int pixelSize = cs->pixelSize();
 
-    QVector<float> channel(cs->channelCount());
-    QVector<float>* AverageChannels = new QVector<float>[(Intensity + 1)];
-
-    // Erase the array
-    memset(IntensityCount, 0, (Intensity + 1) * sizeof(uchar));
+    const double Scale = Smoothness / 255.0;
 
-    int startx = X - Radius;
-    int starty = Y - Radius;
-    int width = (2 * Radius) + 1;
-    int height = (2 * Radius) + 1;
+    /**
+     * Every intensity level is a bin of the histogram, and the
+     * normalized channels of the pixels are accumulated per-bin
+     * to calculate the average color of the most frequent level.
+     */
+    KisSlidingWindowHistogram histogram(Smoothness + 1, channelCount);
 
-    qreal middlePointAlpha = 1;
-    {
-        // if the current pixel is transparent, the result must be transparent, too.
-        KisSequentialConstIterator middlePointIt(src, QRect(X, Y, 1, 1));
-        middlePointIt.nextPixel();
-        middlePointAlpha = cs->opacityF(middlePointIt.oldRawData());
-    }
-
-
-    KisSequentialConstIterator srcIt(src, QRect(startx, starty, width, height));
-    while (middlePointAlpha > 0 && srcIt.nextPixel()) {
-
-        cs->normalisedChannelsValue(srcIt.oldRawData(), channel);
-
-        if (cs->opacityU8(srcIt.oldRawData()) == 0) {
+    auto sampleFunc = [cs, Scale] (const quint8 *pixel, float *accumulators, QVector<float> &channel) {
+        if (cs->opacityU8(pixel) == 0) {
             // if the pixel is transparent, it's not going to provide any useful information
-            continue;
+            return -1;
         }
 
-        I = (uint)(cs->intensity8(srcIt.oldRawData()) * Scale);
+        cs->normalisedChannelsValue(pixel, channel);
+        std::copy(channel.begin(), channel.end(), accumulators);
 
-        IntensityCount[I]++;
+        return int(cs->intensity8(pixel) * Scale);
+    };
 
-        if (IntensityCount[I] == 1) {
-            AverageChannels[I] = channel;
-        } else {
-            for (int i = 0; i < channel.size(); i++) {
-                AverageChannels[I][i] += channel[i];
-            }
-        }
-    }
+    auto resultFunc = [cs, channelCount, pixelSize] (const KisSlidingWindowHistogram::Window &window,
+                                                     const quint8 *centerPixel,
+                                                     quint8 *dst,
+                                                     QVector<float> &channel) {
+        // if the current pixel is transparent, the result must be transparent, too.
+        const qreal middlePointAlpha = cs->opacityF(centerPixel);
+        const int I = middlePointAlpha > 0 ? KisSlidingWindowHistogram::findMode(window) : -1;
 
-    I = 0;
-    int MaxInstance = 0;
+        if (I >= 0) {
+            const quint32 MaxInstance = window.counts[I];
+            const float *sums = window.binSums(I);
 
-    for (int i = 0 ; i <= Intensity ; ++i) {
-        if (IntensityCount[i] > MaxInstance) {
-            I = i;
-            MaxInstance = IntensityCount[i];
+            for (int i = 0; i < channelCount; i++) {
+                channel[i] = sums[i] / MaxInstance;
+            }
+            cs->fromNormalisedChannelsValue(dst, channel);
+        } else {
+            memset(dst, 0, pixelSize);
         }
-    }
 
-    if (MaxInstance != 0) {
-        channel = AverageChannels[I];
-        for (int i = 0; i < channel.size(); i++) {
-            channel[i] /= MaxInstance;
+        // fully opaque source pixels keep producing fully opaque results
+        if (middlePointAlpha == OPACITY_OPAQUE_F) {
+            cs->setOpacity(dst, OPACITY_OPAQUE_U8, 1);
         }
-        cs->fromNormalisedChannelsValue(dst, channel);
-        cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
-    } else {
-        memset(dst, 0, cs->pixelSize());
-        cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
-    }
-
+    };
 
-    delete [] IntensityCount;        // free all the arrays
-    delete [] AverageChannels;
+    histogram.process(src, dst, applyRect, BrushSize, sampleFunc, resultFunc, progressUpdater);
 }
 
 QRect KisOilPaintFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int /*lod*/) const
@@ -29,7 +29,7 @@
 #include <kis_processing_information.h>
 #include <kis_selection.h>
 #include <kis_types.h>
-#include <KisSequentialIteratorProgress.h>
+#include <KisTileSpanIterator.h>
 #include <kis_signals_blocker.h>
 
 #include <KoBasicHistogramProducers.h>
@@ -75,17 +75,33 @@ void KisFilterThreshold::processImpl(KisPaintDeviceSP device,
     KoColor white(Qt::white, device->colorSpace());
     KoColor black(Qt::black, device->colorSpace());
 
-    KisSequentialIteratorProgress it(device, applyRect, progressUpdater);
-    const int pixelSize = device->colorSpace()->pixelSize();
-
-    while (it.nextPixel()) {
-        if (device->colorSpace()->intensity8(it.oldRawData()) > threshold) {
-            white.setOpacity(device->colorSpace()->opacityU8(it.oldRawData()));
-            memcpy(it.rawData(), white.data(), pixelSize);
-        }
-        else {
-            black.setOpacity(device->colorSpace()->opacityU8(it.oldRawData()));
-            memcpy(it.rawData(), black.data(), pixelSize);
+    const KoColorSpace *cs = device->colorSpace();
+    const int pixelSize = cs->pixelSize();
+
+    KisTileSpanIteratorProgress it(device, applyRect, progressUpdater);
+
+    while (it.nextSpan()) {
+        const quint8 *srcRow = it.oldRawData();
+        quint8 *dstRow = it.rawData();
+
+        for (int y = 0; y < it.spanHeight(); y++) {
+            const quint8 *src = srcRow;
+            quint8 *dst = dstRow;
+
+            for (int x = 0; x < it.spanWidth(); x++) {
+                if (cs->intensity8(src) > threshold) {
+                    white.setOpacity(cs->opacityU8(src));
+                    memcpy(dst, white.data(), pixelSize);
+                }
+                else {
+                    black.setOpacity(cs->opacityU8(src));
+                    memcpy(dst, black.data(), pixelSize);
+                }
+                src += pixelSize;
+                dst += pixelSize;
+            }
+            srcRow += it.rowStride();
+            dstRow += it.rowStride();
         }
     }
 
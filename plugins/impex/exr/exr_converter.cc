@@ -15,6 +15,7 @@
 #include <ImfHeader.h>
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
 
 #include <ImfStringAttribute.h>
 #include "exr_extra_tags.h"
@@ -23,6 +24,9 @@
 #include <QMessageBox>
 #include <QDomDocument>
 #include <QThread>
+#include <QtConcurrentMap>
+
+#include <atomic>
 
 #include <QFileInfo>
 
@@ -40,6 +44,7 @@
 #include <kis_paint_layer.h>
 #include <kis_transaction.h>
 #include "kis_iterator_ng.h"
+#include <kis_algebra_2d.h>
 #include <kis_exr_layers_sorter.h>
 
 #include <kis_meta_data_entry.h>
@@ -55,6 +60,43 @@
 // Do not translate!
 #define HDR_LAYER "HDR Layer"
 
+/**
+ * The layers are decoded and encoded in bands of rows aligned to the tiles
+ * of the paint devices. OpenEXR processes the line blocks (1 to 32 lines
+ * depending on the compression) of a single readPixels()/writePixels()
+ * call in parallel, so a band should cover several blocks, but still be
+ * small enough not to duplicate the layer in memory.
+ */
+const int ExrBandHeight = 256;
+
+/**
+ * The size of the tiles of the tiled EXR files written by Krita, matches
+ * the tiles of the paint devices
+ */
+const int ExrTileSize = 64;
+
+namespace {
+
+/**
+ * Splits the rows [top, top + height) into bands aligned to \p bandHeight
+ */
+QVector<QPair<int, int>> splitIntoBands(int top, int height, int bandHeight)
+{
+    QVector<QPair<int, int>> bands;
+
+    int y = top;
+    while (y < top + height) {
+        const int nextBandTop = (KisAlgebra2D::divideFloor(y, bandHeight) + 1) * bandHeight;
+        const int bottom = qMin(nextBandTop, top + height);
+        bands << qMakePair(y, bottom - y);
+        y = bottom;
+    }
+
+    return bands;
+}
+
+}
+
 template<typename _T_>
 struct Rgba {
     _T_ r;
@@ -133,7 +175,7 @@ struct EXRConverter::Private {
     KisImageSP image;
     KisDocument *doc;
 
-    bool alphaWasModified;
+    std::atomic<bool> alphaWasModified;
     bool showNotifications;
 
     QString errorMessage;
@@ -147,6 +189,10 @@ struct EXRConverter::Private {
     template<typename _T_>
     void decodeData1(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
 
+    template<typename Pixel, typename PrepareFunc, typename ConvertFunc>
+    void decodeBands(Imf::InputFile& file, KisPaintLayerSP layer, int width, int xstart, int ystart, int height,
+                     PrepareFunc prepareFrameBuffer, ConvertFunc convertPixel);
+
 
     QDomDocument loadExtraLayersInfo(const Imf::Header &header);
     bool checkExtraLayersInfoConsistent(const QDomDocument &doc, std::set<std::string> exrLayerNames);
@@ -361,48 +407,91 @@ void multiplyAlpha(Pixel *pixel)
     }
 }
 
+/**
+ * Reads the layer band by band into a buffer covering a single band, and
+ * converts the pixels of the band into the paint device in parallel. The
+ * conversion jobs work on the rows of different device tiles, so they never
+ * access the same tile.
+ */
+template<typename Pixel, typename PrepareFunc, typename ConvertFunc>
+void EXRConverter::Private::decodeBands(Imf::InputFile& file, KisPaintLayerSP layer, int width, int xstart, int ystart, int height,
+                                        PrepareFunc prepareFrameBuffer, ConvertFunc convertPixel)
+{
+    int bandHeight = ExrBandHeight;
+
+    // read the tiled files by whole rows of tiles
+    if (file.header().hasTileDescription()) {
+        const int tileHeight = file.header().tileDescription().ySize;
+        bandHeight = qMax(1, (bandHeight / tileHeight)) * tileHeight;
+    }
+
+    QVector<Pixel> pixels(width * qMin(bandHeight, height));
+
+    KisPaintDeviceSP dev = layer->paintDevice();
+
+    const QVector<QPair<int, int>> bands = splitIntoBands(ystart, height, bandHeight);
+
+    for (const QPair<int, int> &band : bands) {
+        const int bandTop = band.first;
+        const int bandRows = band.second;
+
+        Imf::FrameBuffer frameBuffer;
+        prepareFrameBuffer(&frameBuffer, pixels.data() - xstart - bandTop * width);
+
+        file.setFrameBuffer(frameBuffer);
+        file.readPixels(bandTop, bandTop + bandRows - 1);
+
+        Pixel *bandPixels = pixels.data();
+
+        QVector<QPair<int, int>> jobs = splitIntoBands(bandTop, bandRows, ExrTileSize);
+
+        QtConcurrent::blockingMap(jobs,
+            [&] (const QPair<int, int> &job) {
+                Pixel *src = bandPixels + (job.first - bandTop) * width;
+
+                KisSequentialIterator it(dev, QRect(xstart, job.first, width, job.second));
+                while (it.nextPixel()) {
+                    convertPixel(src, it.rawData());
+                    ++src;
+                }
+            });
+    }
+}
+
 template<typename _T_>
 void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
 {
     typedef Rgba<_T_> Rgba;
 
-    QVector<Rgba> pixels(width * height);
-
     bool hasAlpha = info.channelMap.contains("A");
 
-    Imf::FrameBuffer frameBuffer;
-    Rgba* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(info.channelMap["R"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->r,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->g,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["B"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->b,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->a,
+    auto prepareFrameBuffer = [&] (Imf::FrameBuffer *frameBuffer, Rgba *frameBufferData) {
+        frameBuffer->insert(info.channelMap["R"].toLatin1().constData(),
+                Imf::Slice(ptype, (char *) &frameBufferData->r,
                            sizeof(Rgba) * 1,
                            sizeof(Rgba) * width));
-    }
-
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
-    Rgba *rgba = pixels.data();
+        frameBuffer->insert(info.channelMap["G"].toLatin1().constData(),
+                Imf::Slice(ptype, (char *) &frameBufferData->g,
+                           sizeof(Rgba) * 1,
+                           sizeof(Rgba) * width));
+        frameBuffer->insert(info.channelMap["B"].toLatin1().constData(),
+                Imf::Slice(ptype, (char *) &frameBufferData->b,
+                           sizeof(Rgba) * 1,
+                           sizeof(Rgba) * width));
+        if (hasAlpha) {
+            frameBuffer->insert(info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(ptype, (char *) &frameBufferData->a,
+                               sizeof(Rgba) * 1,
+                               sizeof(Rgba) * width));
+        }
+    };
 
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
+    auto convertPixel = [&] (Rgba *rgba, quint8 *rawData) {
         if (hasAlpha) {
             unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
         }
 
-        typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it.rawData());
+        typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(rawData);
 
         dst->red = rgba->r;
         dst->green = rgba->g;
@@ -412,9 +501,9 @@ void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo&
         } else {
             dst->alpha = 1.0;
         }
+    };
 
-        ++rgba;
-    }
+    decodeBands<Rgba>(file, layer, width, xstart, ystart, height, prepareFrameBuffer, convertPixel);
 }
 
 template<typename _T_>
@@ -426,47 +515,37 @@ void EXRConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo&
     KIS_ASSERT_RECOVER_RETURN(
                 layer->paintDevice()->colorSpace()->colorModelId() == GrayAColorModelID);
 
-    QVector<pixel_type> pixels(width * height);
-
     Q_ASSERT(info.channelMap.contains("Y"));
     dbgFile << "Gray -> " << info.channelMap["Y"];
 
     bool hasAlpha = info.channelMap.contains("A");
     dbgFile << "Has Alpha:" << hasAlpha;
 
+    auto prepareFrameBuffer = [&] (Imf::FrameBuffer *frameBuffer, pixel_type *frameBufferData) {
+        frameBuffer->insert(
+            info.channelMap["Y"].toLatin1().constData(),
+            Imf::Slice(ptype, (char *)&frameBufferData->gray, sizeof(pixel_type) * 1, sizeof(pixel_type) * width));
 
-    Imf::FrameBuffer frameBuffer;
-    pixel_type* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(
-        info.channelMap["Y"].toLatin1().constData(),
-        Imf::Slice(ptype, (char *)&frameBufferData->gray, sizeof(pixel_type) * 1, sizeof(pixel_type) * width));
-
-    if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->alpha,
-                           sizeof(pixel_type) * 1,
-                           sizeof(pixel_type) * width));
-    }
-
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
-
-    pixel_type *srcPtr = pixels.data();
+        if (hasAlpha) {
+            frameBuffer->insert(info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(ptype, (char *) &frameBufferData->alpha,
+                               sizeof(pixel_type) * 1,
+                               sizeof(pixel_type) * width));
+        }
+    };
 
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
+    auto convertPixel = [&] (pixel_type *srcPtr, quint8 *rawData) {
         if (hasAlpha) {
             unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
         }
 
-        pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it.rawData());
+        pixel_type* dstPtr = reinterpret_cast<pixel_type*>(rawData);
 
         dstPtr->gray = srcPtr->gray;
         dstPtr->alpha = hasAlpha ? srcPtr->alpha : channel_type(1.0);
+    };
 
-        ++srcPtr;
-    } ;
+    decodeBands<pixel_type>(file, layer, width, xstart, ystart, height, prepareFrameBuffer, convertPixel);
 }
 
 bool recCheckGroup(const ExrGroupLayerInfo& group, QStringList list, int idx1, int idx2)
@@ -959,7 +1038,7 @@ class Encoder
 public:
     virtual ~Encoder() {}
     virtual void prepareFrameBuffer(Imf::FrameBuffer*, int line) = 0;
-    virtual void encodeData(int line) = 0;
+    virtual void encodeData(int line, int numLines) = 0;
 
 };
 
@@ -967,13 +1046,12 @@ template<typename _T_, int size, int alphaPos>
 class EncoderImpl : public Encoder
 {
 public:
-    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), pixels(width), m_width(width) {}
+    EncoderImpl(const ExrPaintLayerSaveInfo* _info, int width, int bandHeight) : info(_info), pixels(width * bandHeight), m_width(width) {}
     ~EncoderImpl() override {}
     void prepareFrameBuffer(Imf::FrameBuffer*, int line) override;
-    void encodeData(int line) override;
+    void encodeData(int line, int numLines) override;
 private:
     typedef ExrPixel_<_T_, size> ExrPixel;
-    Imf::OutputFile* file;
     const ExrPaintLayerSaveInfo* info;
     QVector<ExrPixel> pixels;
     int m_width;
@@ -994,12 +1072,12 @@ void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* fram
 }
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
+void EncoderImpl<_T_, size, alphaPos>::encodeData(int line, int numLines)
 {
     ExrPixel *rgba = pixels.data();
-    KisHLineConstIteratorSP it = info->layerDevice->createHLineConstIteratorNG(0, line, m_width);
-    do {
-        const _T_* dst = reinterpret_cast < const _T_* >(it->oldRawData());
+    KisSequentialConstIterator it(info->layerDevice, QRect(0, line, m_width, numLines));
+    while (it.nextPixel()) {
+        const _T_* dst = reinterpret_cast < const _T_* >(it.oldRawData());
 
         for (int i = 0; i < size; ++i) {
             rgba->data[i] = dst[i];
@@ -1010,40 +1088,40 @@ void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
         }
 
         ++rgba;
-    } while (it->nextPixel());
+    }
 }
 
-Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int width)
+Encoder* encoder(const ExrPaintLayerSaveInfo& info, int width, int bandHeight)
 {
     dbgFile << "Create encoder for" << info.name << info.channels << info.layerDevice->colorSpace()->channelCount();
     switch (info.layerDevice->colorSpace()->channelCount()) {
     case 1: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl < half, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < half, 1, -1 > (&info, width, bandHeight);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl < float, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < float, 1, -1 > (&info, width, bandHeight);
         }
         break;
     }
     case 2: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 2, 1>(&file, &info, width);
+            return new EncoderImpl<half, 2, 1>(&info, width, bandHeight);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 2, 1>(&file, &info, width);
+            return new EncoderImpl<float, 2, 1>(&info, width, bandHeight);
         }
         break;
     }
     case 4: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 4, 3>(&file, &info, width);
+            return new EncoderImpl<half, 4, 3>(&info, width, bandHeight);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 4, 3>(&file, &info, width);
+            return new EncoderImpl<float, 4, 3>(&info, width, bandHeight);
         }
         break;
     }
@@ -1053,27 +1131,62 @@ Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int w
     return 0;
 }
 
-void encodeData(Imf::OutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
+/**
+ * Writes the layers band by band. The pixels of all the layers of a band are
+ * fetched from the paint devices in parallel, then OpenEXR compresses the
+ * line blocks (or the tiles) of the band on its own thread pool.
+ */
+template<class File>
+void encodeData(File& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height, int bandHeight,
+                std::function<void(File&, int, int)> writeBand)
 {
     QList<Encoder*> encoders;
     Q_FOREACH (const ExrPaintLayerSaveInfo& info, informationObjects) {
-        encoders.push_back(encoder(file, info, width));
+        encoders.push_back(encoder(info, width, bandHeight));
     }
 
-    for (int y = 0; y < height; ++y) {
+    for (int y = 0; y < height; y += bandHeight) {
+        const int numLines = qMin(bandHeight, height - y);
+
         Imf::FrameBuffer frameBuffer;
         Q_FOREACH (Encoder* encoder, encoders) {
             encoder->prepareFrameBuffer(&frameBuffer, y);
         }
         file.setFrameBuffer(frameBuffer);
-        Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->encodeData(y);
-        }
-        file.writePixels(1);
+
+        QtConcurrent::blockingMap(encoders,
+            [y, numLines] (Encoder *encoder) {
+                encoder->encodeData(y, numLines);
+            });
+
+        writeBand(file, y, numLines);
     }
     qDeleteAll(encoders);
 }
 
+void encodeData(const QString &filename, const Imf::Header &header, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height, bool tiled)
+{
+    if (tiled) {
+        Imf::Header tiledHeader(header);
+        tiledHeader.setTileDescription(Imf::TileDescription(ExrTileSize, ExrTileSize, Imf::ONE_LEVEL));
+
+        Imf::TiledOutputFile file(filename.toUtf8(), tiledHeader);
+
+        encodeData<Imf::TiledOutputFile>(file, informationObjects, width, height, ExrBandHeight,
+            [] (Imf::TiledOutputFile &file, int y, int numLines) {
+                file.writeTiles(0, file.numXTiles() - 1,
+                                y / ExrTileSize, (y + numLines - 1) / ExrTileSize);
+            });
+    } else {
+        Imf::OutputFile file(filename.toUtf8(), header);
+
+        encodeData<Imf::OutputFile>(file, informationObjects, width, height, ExrBandHeight,
+            [] (Imf::OutputFile &file, int /*y*/, int numLines) {
+                file.writePixels(numLines);
+            });
+    }
+}
+
 KisPaintDeviceSP wrapLayerDevice(KisPaintDeviceSP device)
 {
     const KoColorSpace *cs = device->colorSpace();
@@ -1098,7 +1211,7 @@ KisPaintDeviceSP wrapLayerDevice(KisPaintDeviceSP device)
     return device;
 }
 
-KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPaintLayerSP layer)
+KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPaintLayerSP layer, bool tiled)
 {
     KIS_ASSERT_RECOVER_RETURN_VALUE(layer, ImportExportCodes::InternalError);
 
@@ -1154,11 +1267,9 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPai
 
     // Open file for writing
     try {
-        Imf::OutputFile file(filename.toUtf8(), header);
-
         QList<ExrPaintLayerSaveInfo> informationObjects;
         informationObjects.push_back(info);
-        encodeData(file, informationObjects, width, height);
+        encodeData(filename, header, informationObjects, width, height, tiled);
         return ImportExportCodes::OK;
 
     } catch(std::exception &e) {
@@ -1360,7 +1471,7 @@ QString EXRConverter::Private::fetchExtraLayersInfo(QList<ExrPaintLayerSaveInfo>
     return doc.toString();
 }
 
-KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten)
+KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten, bool tiled)
 {
     KIS_ASSERT_RECOVER_RETURN_VALUE(layer, ImportExportCodes::InternalError);
 
@@ -1374,7 +1485,7 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGro
     if (flatten) {
         KisPaintDeviceSP pd = new KisPaintDevice(*image->projection());
         KisPaintLayerSP l = new KisPaintLayer(image, "projection", OPACITY_OPAQUE_U8, pd);
-        return buildFile(filename, l);
+        return buildFile(filename, l, tiled);
     }
     else {
         QList<ExrPaintLayerSaveInfo> informationObjects;
@@ -1401,8 +1512,7 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGro
 
         // Open file for writing
         try {
-            Imf::OutputFile file(filename.toUtf8(), header);
-            encodeData(file, informationObjects, width, height);
+            encodeData(filename, header, informationObjects, width, height, tiled);
             return ImportExportCodes::OK;
         } catch(std::exception &e) {
             dbgFile << "Exception while writing to exr file: " << e.what();
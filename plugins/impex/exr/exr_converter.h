@@ -24,8 +24,13 @@ public:
     ~EXRConverter() override;
 public:
     KisImportExportErrorCode buildImage(const QString &filename);
-    KisImportExportErrorCode buildFile(const QString &filename, KisPaintLayerSP layer);
-    KisImportExportErrorCode buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten=false);
+    /**
+     * Saves the layer into \p filename. If \p tiled is true, the pixels are
+     * stored in 64x64 tiles instead of scanlines, which allows the readers
+     * to load only the needed part of the image.
+     */
+    KisImportExportErrorCode buildFile(const QString &filename, KisPaintLayerSP layer, bool tiled = false);
+    KisImportExportErrorCode buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten = false, bool tiled = false);
     /**
      * Retrieve the constructed image
      */
@@ -13,6 +13,12 @@
 
 #include <half.h>
 #include <KisMimeDatabase.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoRgbColorSpaceTraits.h>
+#include <kis_sequential_iterator.h>
+#include <kis_paint_layer.h>
+#include <kis_group_layer.h>
 #include "filestest.h"
 
 #ifndef FILES_DATA_DIR
@@ -93,6 +99,87 @@ void KisExrTest::testRoundTrip()
 
 }
 
+namespace {
+
+/**
+ * Creates an image with \p numLayers layers filled with smooth gradients
+ * in RGBA F16, which is how renders usually look
+ */
+KisImageSP createMultiLayerImage(int width, int height, int numLayers)
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float16BitsColorDepthID.id(), QString());
+
+    KisImageSP image = new KisImage(0, width, height, cs, "exr test");
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer%1").arg(i), OPACITY_OPAQUE_U8);
+
+        KisSequentialIterator it(layer->paintDevice(), QRect(0, 0, width, height));
+        while (it.nextPixel()) {
+            KoRgbF16Traits::Pixel *pixel = reinterpret_cast<KoRgbF16Traits::Pixel*>(it.rawData());
+            pixel->red = half(float(it.x()) / width * (i + 1));
+            pixel->green = half(float(it.y()) / height);
+            pixel->blue = half(float((it.x() + it.y()) % 256) / 256.0f);
+            pixel->alpha = half(1.0f);
+        }
+
+        image->addNode(layer, image->root());
+    }
+
+    image->waitForDone();
+
+    return image;
+}
+
+}
+
+void KisExrTest::testRoundTripMultiLayer_data()
+{
+    QTest::addColumn<bool>("tiled");
+
+    QTest::newRow("scanlines") << false;
+    QTest::newRow("tiled") << true;
+}
+
+void KisExrTest::testRoundTripMultiLayer()
+{
+    QFETCH(bool, tiled);
+
+    // the size is not a multiple of the tile size to test the border tiles
+    KisImageSP image = createMultiLayerImage(300, 200, 3);
+
+    QScopedPointer<KisDocument> doc1(KisPart::instance()->createDocument());
+    doc1->setFileBatchMode(true);
+    doc1->setCurrentImage(image);
+
+    QTemporaryFile savedFile(QDir::tempPath() + QLatin1String("/krita_XXXXXX") + QLatin1String(".exr"));
+    savedFile.setAutoRemove(true);
+    savedFile.open();
+
+    const QString savedFileName(savedFile.fileName());
+
+    KisPropertiesConfigurationSP configuration = new KisPropertiesConfiguration();
+    configuration->setProperty("flatten", false);
+    configuration->setProperty("tiled", tiled);
+
+    QVERIFY(doc1->exportDocumentSync(savedFileName, ExrMimetype.toLatin1(), configuration));
+
+    QScopedPointer<KisDocument> doc2(KisPart::instance()->createDocument());
+    doc2->setFileBatchMode(true);
+    QVERIFY(doc2->importDocument(savedFileName));
+    QVERIFY(doc2->image());
+
+    QCOMPARE(doc2->image()->root()->childCount(), image->root()->childCount());
+
+    for (quint32 i = 0; i < image->root()->childCount(); i++) {
+        QVERIFY(TestUtil::comparePaintDevicesClever<half>(
+                    image->root()->at(i)->paintDevice(),
+                    doc2->image()->root()->at(i)->paintDevice(),
+                    0.01 /* meaningless alpha */));
+    }
+}
+
 KISTEST_MAIN(KisExrTest)
 
 
@@ -18,6 +18,8 @@ private Q_SLOTS:
     void testExportToReadonly();
     void testImportIncorrectFormat();
     void testRoundTrip();
+    void testRoundTripMultiLayer_data();
+    void testRoundTripMultiLayer();
 };
 
 #endif
@@ -13,13 +13,20 @@
 #include <jxl/color_encoding.h>
 #include <jxl/encode_cxx.h>
 #include <jxl/resizable_parallel_runner_cxx.h>
+#if __has_include(<jxl/version.h>)
+#include <jxl/version.h>
+#endif
 #include <kpluginfactory.h>
 
 #include <QBuffer>
+#include <QHash>
+#include <QMutex>
 #include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <memory>
 
 #include <KisDocument.h>
 #include <KisExportCheckRegistry.h>
@@ -54,6 +61,11 @@
 
 #include "kis_wdg_options_jpegxl.h"
 
+// The chunked frame input and the output processor appeared in libjxl 0.10
+#if defined(JPEGXL_NUMERIC_VERSION) && JPEGXL_NUMERIC_VERSION >= JPEGXL_COMPUTE_NUMERIC_VERSION(0, 10, 0)
+#define JPEGXL_HAS_STREAMING_API
+#endif
+
 K_PLUGIN_FACTORY_WITH_JSON(ExportFactory, "krita_jxl_export.json", registerPlugin<JPEGXLExport>();)
 
 namespace JXLCMYK
@@ -347,6 +359,206 @@ inline auto writeLayer(const KoID &id, Args &&...args)
 }
 } // namespace HDR
 
+#ifdef JPEGXL_HAS_STREAMING_API
+namespace JXLStreaming
+{
+/**
+ * Writes the encoded data straight into the target device instead of
+ * collecting the whole file in memory
+ */
+class OutputDevice
+{
+public:
+    OutputDevice(QIODevice *io)
+        : m_io(io)
+        , m_basePosition(io->pos())
+    {
+    }
+
+    JxlEncoderOutputProcessor processor()
+    {
+        JxlEncoderOutputProcessor processor{};
+        processor.opaque = this;
+        processor.get_buffer = &OutputDevice::getBuffer;
+        processor.release_buffer = &OutputDevice::releaseBuffer;
+        // without seeking libjxl keeps the sections to be patched in memory
+        processor.seek = m_io->isSequential() ? nullptr : &OutputDevice::seek;
+        processor.set_finalized_position = &OutputDevice::setFinalizedPosition;
+        return processor;
+    }
+
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+private:
+    static void *getBuffer(void *opaque, size_t *size)
+    {
+        auto *d = static_cast<OutputDevice *>(opaque);
+        const size_t bufferSize = std::max<size_t>(*size, 1 << 16);
+        d->m_buffer.resize(static_cast<int>(bufferSize));
+        *size = bufferSize;
+        return d->m_buffer.data();
+    }
+
+    static void releaseBuffer(void *opaque, size_t writtenBytes)
+    {
+        auto *d = static_cast<OutputDevice *>(opaque);
+        if (d->m_io->write(d->m_buffer.constData(), static_cast<qint64>(writtenBytes))
+            != static_cast<qint64>(writtenBytes)) {
+            d->m_failed = true;
+        }
+    }
+
+    static void seek(void *opaque, uint64_t position)
+    {
+        auto *d = static_cast<OutputDevice *>(opaque);
+        if (!d->m_io->seek(d->m_basePosition + static_cast<qint64>(position))) {
+            d->m_failed = true;
+        }
+    }
+
+    static void setFinalizedPosition(void *, uint64_t)
+    {
+        // everything is written into the device immediately
+    }
+
+    QIODevice *m_io;
+    qint64 m_basePosition;
+    QByteArray m_buffer;
+    bool m_failed = false;
+};
+
+/**
+ * Feeds a frame into the encoder by chunks: libjxl requests the
+ * rects it is about to encode and they are read from the paint
+ * device on demand, possibly from several threads at once
+ */
+class ChunkedFrameSource
+{
+public:
+    using Fetcher = std::function<QByteArray(const QRect &)>;
+
+    ChunkedFrameSource(const JxlPixelFormat &format, const QPoint &origin, Fetcher fetch)
+        : m_format(format)
+        , m_origin(origin)
+        , m_fetch(std::move(fetch))
+    {
+    }
+
+    JxlChunkedFrameInputSource source()
+    {
+        JxlChunkedFrameInputSource source{};
+        source.opaque = this;
+        source.get_color_channels_pixel_format = &ChunkedFrameSource::getColorChannelsPixelFormat;
+        source.get_color_channel_data_at = &ChunkedFrameSource::getColorChannelDataAt;
+        source.get_extra_channel_pixel_format = &ChunkedFrameSource::getExtraChannelPixelFormat;
+        source.get_extra_channel_data_at = &ChunkedFrameSource::getExtraChannelDataAt;
+        source.release_buffer = &ChunkedFrameSource::releaseBuffer;
+        return source;
+    }
+
+private:
+    size_t channelSize() const
+    {
+        switch (m_format.data_type) {
+        case JXL_TYPE_UINT8:
+            return 1;
+        case JXL_TYPE_UINT16:
+        case JXL_TYPE_FLOAT16:
+            return 2;
+        default:
+            return 4;
+        }
+    }
+
+    const void *storeBuffer(QByteArray &&buffer)
+    {
+        const void *ptr = buffer.constData();
+        QMutexLocker l(&m_mutex);
+        m_buffers.insert(ptr, std::move(buffer));
+        return ptr;
+    }
+
+    static void getColorChannelsPixelFormat(void *opaque, JxlPixelFormat *format)
+    {
+        *format = static_cast<ChunkedFrameSource *>(opaque)->m_format;
+    }
+
+    static const void *
+    getColorChannelDataAt(void *opaque, size_t xpos, size_t ypos, size_t xsize, size_t ysize, size_t *rowOffset)
+    {
+        auto *d = static_cast<ChunkedFrameSource *>(opaque);
+        const QRect rc(d->m_origin.x() + static_cast<int>(xpos),
+                       d->m_origin.y() + static_cast<int>(ypos),
+                       static_cast<int>(xsize),
+                       static_cast<int>(ysize));
+
+        *rowOffset = xsize * d->m_format.num_channels * d->channelSize();
+        return d->storeBuffer(d->m_fetch(rc));
+    }
+
+    static void getExtraChannelPixelFormat(void *opaque, size_t /*ecIndex*/, JxlPixelFormat *format)
+    {
+        *format = static_cast<ChunkedFrameSource *>(opaque)->m_format;
+        format->num_channels = 1;
+    }
+
+    /**
+     * The only extra channel is alpha, which is the last one of the
+     * interleaved color channels
+     */
+    static const void *getExtraChannelDataAt(void *opaque,
+                                             size_t /*ecIndex*/,
+                                             size_t xpos,
+                                             size_t ypos,
+                                             size_t xsize,
+                                             size_t ysize,
+                                             size_t *rowOffset)
+    {
+        auto *d = static_cast<ChunkedFrameSource *>(opaque);
+        const QRect rc(d->m_origin.x() + static_cast<int>(xpos),
+                       d->m_origin.y() + static_cast<int>(ypos),
+                       static_cast<int>(xsize),
+                       static_cast<int>(ysize));
+
+        const QByteArray pixels = d->m_fetch(rc);
+        const size_t chSize = d->channelSize();
+        const size_t pxSize = chSize * d->m_format.num_channels;
+        const size_t numPixels = xsize * ysize;
+
+        QByteArray alpha;
+        alpha.resize(static_cast<int>(numPixels * chSize));
+
+        const char *src = pixels.constData() + pxSize - chSize;
+        char *dst = alpha.data();
+        for (size_t i = 0; i < numPixels; i++) {
+            std::memcpy(dst, src, chSize);
+            src += pxSize;
+            dst += chSize;
+        }
+
+        *rowOffset = xsize * chSize;
+        return d->storeBuffer(std::move(alpha));
+    }
+
+    static void releaseBuffer(void *opaque, const void *buf)
+    {
+        auto *d = static_cast<ChunkedFrameSource *>(opaque);
+        QMutexLocker l(&d->m_mutex);
+        d->m_buffers.remove(buf);
+    }
+
+    JxlPixelFormat m_format;
+    QPoint m_origin;
+    Fetcher m_fetch;
+    QMutex m_mutex;
+    QHash<const void *, QByteArray> m_buffers;
+};
+} // namespace JXLStreaming
+#endif
+
 JPEGXLExport::JPEGXLExport(QObject *parent, const QVariantList &)
     : KisImportExportFilter(parent)
 {
@@ -369,6 +581,17 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
     JxlResizableParallelRunnerSetThreads(runner.get(),
                                          JxlResizableParallelRunnerSuggestThreads(static_cast<uint64_t>(bounds.width()), static_cast<uint64_t>(bounds.height())));
 
+#ifdef JPEGXL_HAS_STREAMING_API
+    JXLStreaming::OutputDevice outputDevice(io);
+    if (JXL_ENC_SUCCESS != JxlEncoderSetOutputProcessor(enc.get(), outputDevice.processor())) {
+        errFile << "JxlEncoderSetOutputProcessor failed";
+        return ImportExportCodes::InternalError;
+    }
+
+    // frames are read from the paint devices in chunks while they are encoded
+    std::vector<std::unique_ptr<JXLStreaming::ChunkedFrameSource>> frameSources;
+#endif
+
     const KoColorSpace *cs = image->colorSpace();
     ConversionPolicy conversionPolicy = ConversionPolicy::KeepTheSame;
     bool convertToRec2020 = false;
@@ -889,6 +1112,58 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
         }
     }
 
+    // Reads the pixels of a rect of the device in the layout of pixelFormat (except CMYK)
+    const auto fetchPixels = [&](KisPaintDeviceSP dev, const QRect &rc) {
+        const KoID colorModel = cs->colorModelId();
+        const KoID colorDepth = cs->colorDepthId();
+
+        if (colorModel != RGBAColorModelID
+            || (colorDepth != Integer8BitsColorDepthID && colorDepth != Integer16BitsColorDepthID
+                && conversionPolicy == ConversionPolicy::KeepTheSame)) {
+            // blast it wholesale
+            QByteArray p;
+            p.resize(rc.width() * rc.height() * static_cast<int>(cs->pixelSize()));
+            dev->readBytes(reinterpret_cast<quint8 *>(p.data()), rc);
+            return p;
+        } else {
+            KisHLineConstIteratorSP it = dev->createHLineConstIteratorNG(rc.x(), rc.y(), rc.width());
+
+            // detect traits based on depth
+            // if u8 or u16, also trigger swap
+            return HDR::writeLayer(cs->colorDepthId(),
+                                   convertToRec2020,
+                                   cs->profile()->isLinear(),
+                                   conversionPolicy,
+                                   removeHGLOOTF,
+                                   rc.width(),
+                                   rc.height(),
+                                   it,
+                                   hlgGamma,
+                                   hlgNominalPeak,
+                                   cs);
+        }
+    };
+
+    const auto addImageFrame = [&](KisPaintDeviceSP dev, const QRect &rc, bool isLastFrame) {
+#ifdef JPEGXL_HAS_STREAMING_API
+        if (cs->colorModelId() != CMYKAColorModelID) {
+            frameSources.emplace_back(
+                std::make_unique<JXLStreaming::ChunkedFrameSource>(pixelFormat, rc.topLeft(), [=](const QRect &chunk) {
+                    return fetchPixels(dev, chunk);
+                }));
+
+            return JxlEncoderAddChunkedFrame(frameSettings,
+                                             isLastFrame ? JXL_TRUE : JXL_FALSE,
+                                             frameSources.back()->source())
+                == JXL_ENC_SUCCESS;
+        }
+#endif
+        Q_UNUSED(isLastFrame);
+        const QByteArray pixels = fetchPixels(dev, rc);
+        return JxlEncoderAddImageFrame(frameSettings, &pixelFormat, pixels.data(), static_cast<size_t>(pixels.size()))
+            == JXL_ENC_SUCCESS;
+    };
+
     {
         if (image->animationInterface()->hasAnimation()
             && cfg->getBool("haveAnimation", true)) {
@@ -937,44 +1212,12 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
                     return ImportExportCodes::InternalError;
                 }
 
-                const QByteArray pixels = [&]() {
-                    const auto frameData = frames->keyframeAt<KisRasterKeyframe>(i);
-                    KisPaintDeviceSP dev =
-                        new KisPaintDevice(*image->projection(), KritaUtils::DeviceCopyMode::CopySnapshot);
-                    frameData->writeFrameToDevice(dev);
+                const auto frameData = frames->keyframeAt<KisRasterKeyframe>(i);
+                KisPaintDeviceSP dev =
+                    new KisPaintDevice(*image->projection(), KritaUtils::DeviceCopyMode::CopySnapshot);
+                frameData->writeFrameToDevice(dev);
 
-                    const KoID colorModel = cs->colorModelId();
-
-                    if (colorModel != RGBAColorModelID) {
-                        // blast it wholesale
-                        QByteArray p;
-                        p.resize(bounds.width() * bounds.height() * static_cast<int>(cs->pixelSize()));
-                        dev->readBytes(reinterpret_cast<quint8 *>(p.data()), bounds);
-                        return p;
-                    } else {
-                        KisHLineConstIteratorSP it = dev->createHLineConstIteratorNG(0, 0, bounds.width());
-
-                        // detect traits based on depth
-                        // if u8 or u16, also trigger swap
-                        return HDR::writeLayer(cs->colorDepthId(),
-                                               convertToRec2020,
-                                               cs->profile()->isLinear(),
-                                               conversionPolicy,
-                                               removeHGLOOTF,
-                                               bounds.width(),
-                                               bounds.height(),
-                                               it,
-                                               hlgGamma,
-                                               hlgNominalPeak,
-                                               cs);
-                    }
-                }();
-
-                if (JxlEncoderAddImageFrame(frameSettings,
-                                            &pixelFormat,
-                                            pixels.data(),
-                                            static_cast<size_t>(pixels.size()))
-                    != JXL_ENC_SUCCESS) {
+                if (!addImageFrame(dev, bounds, i == times.last())) {
                     errFile << "JxlEncoderAddImageFrame @" << i << "failed";
                     return ImportExportCodes::InternalError;
                 }
@@ -998,6 +1241,17 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
                 image->waitForDone();
             }
 
+            // The encoder needs to know which frame is the last one up front
+            quint32 lastExportedPos = 0;
+            if (!flattenLayers) {
+                for (quint32 pos = 0; pos < image->root()->childCount(); pos++) {
+                    KisNodeSP node = image->root()->at(pos);
+                    if (node && node->visible() && !node->isFakeNode()) {
+                        lastExportedPos = pos;
+                    }
+                }
+            }
+
             // Iterate through the layers (non-recursively)
             for (quint32 pos = 0; pos < image->root()->childCount(); pos++) {
                 KisNodeSP node = image->root()->at(pos);
@@ -1049,50 +1303,6 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
                     f->process(dev, layerBounds, kfc->cloneWithResourcesSnapshot());
                 }
 
-                const QByteArray pixels = [&]() {
-                    const KoID colorModel = cs->colorModelId();
-                    const KoID colorDepth = cs->colorDepthId();
-
-                    if (colorModel != RGBAColorModelID
-                        || (colorDepth != Integer8BitsColorDepthID && colorDepth != Integer16BitsColorDepthID
-                            && conversionPolicy == ConversionPolicy::KeepTheSame)) {
-                        // CMYK
-                        if (colorModel == CMYKAColorModelID) {
-                            KisHLineConstIteratorSP it =
-                                dev->createHLineConstIteratorNG(layerBounds.x(), layerBounds.y(), layerBounds.width());
-
-                            // interleaved CMY buffer
-                            return JXLCMYK::writeCMYKLayer(cs->colorDepthId(),
-                                                           true,
-                                                           0,
-                                                           layerBounds.width(),
-                                                           layerBounds.height(),
-                                                           it);
-                        }
-                        // blast it wholesale
-                        QByteArray p;
-                        p.resize(layerBounds.width() * layerBounds.height() * static_cast<int>(cs->pixelSize()));
-                        dev->readBytes(reinterpret_cast<quint8 *>(p.data()), layerBounds);
-                        return p;
-                    } else {
-                        KisHLineConstIteratorSP it =
-                            dev->createHLineConstIteratorNG(layerBounds.x(), layerBounds.y(), layerBounds.width());
-
-                        // detect traits based on depth
-                        // if u8 or u16, also trigger swap
-                        return HDR::writeLayer(cs->colorDepthId(),
-                                               convertToRec2020,
-                                               cs->profile()->isLinear(),
-                                               conversionPolicy,
-                                               removeHGLOOTF,
-                                               layerBounds.width(),
-                                               layerBounds.height(),
-                                               it,
-                                               hlgGamma,
-                                               hlgNominalPeak,
-                                               cs);
-                    }
-                }();
 
                 if (!flattenLayers) {
                     JxlEncoderInitFrameHeader(frameHeader.get());
@@ -1139,20 +1349,35 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
                     }
                 }
 
-                if (JxlEncoderAddImageFrame(frameSettings,
-                                            &pixelFormat,
-                                            pixels.data(),
-                                            static_cast<size_t>(pixels.size()))
-                    != JXL_ENC_SUCCESS) {
-                    errFile << "JxlEncoderAddImageFrame failed";
-                    return ImportExportCodes::InternalError;
-                }
-
-                // CMYKA separate planar buffer for Key and Alpha
-                if (cs->colorModelId() == CMYKAColorModelID) {
+                if (cs->colorModelId() != CMYKAColorModelID) {
+                    if (!addImageFrame(dev, layerBounds, flattenLayers || pos == lastExportedPos)) {
+                        errFile << "JxlEncoderAddImageFrame failed";
+                        return ImportExportCodes::InternalError;
+                    }
+                } else {
+                    // CMYK is encoded from the buffers, since the Key and Alpha
+                    // are stored in separate planar extra channels
                     KisHLineConstIteratorSP it =
                         dev->createHLineConstIteratorNG(layerBounds.x(), layerBounds.y(), layerBounds.width());
 
+                    // interleaved CMY buffer
+                    const QByteArray pixels = JXLCMYK::writeCMYKLayer(cs->colorDepthId(),
+                                                                      true,
+                                                                      0,
+                                                                      layerBounds.width(),
+                                                                      layerBounds.height(),
+                                                                      it);
+                    it->resetRowPos();
+
+                    if (JxlEncoderAddImageFrame(frameSettings,
+                                                &pixelFormat,
+                                                pixels.data(),
+                                                static_cast<size_t>(pixels.size()))
+                        != JXL_ENC_SUCCESS) {
+                        errFile << "JxlEncoderAddImageFrame failed";
+                        return ImportExportCodes::InternalError;
+                    }
+
                     const QByteArray chaK = JXLCMYK::writeCMYKLayer(cs->colorDepthId(),
                                                                     false,
                                                                     3,
@@ -1195,6 +1420,12 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
         }
         JxlEncoderCloseInput(enc.get());
 
+#ifdef JPEGXL_HAS_STREAMING_API
+        if (JxlEncoderFlushInput(enc.get()) != JXL_ENC_SUCCESS || outputDevice.failed()) {
+            errFile << "JxlEncoderFlushInput failed";
+            return ImportExportCodes::ErrorWhileWriting;
+        }
+#else
         QByteArray compressed(16384, 0x0);
         auto *nextOut = reinterpret_cast<uint8_t *>(compressed.data());
         auto availOut = static_cast<size_t>(compressed.size());
@@ -1214,6 +1445,7 @@ KisImportExportErrorCode JPEGXLExport::convert(KisDocument *document, QIODevice
             errFile << "JxlEncoderProcessOutput failed";
             return ImportExportCodes::ErrorWhileWriting;
         }
+#endif
     }
 
     return ImportExportCodes::OK;
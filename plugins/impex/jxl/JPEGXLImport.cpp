@@ -16,10 +16,13 @@
 #include <kpluginfactory.h>
 
 #include <QBuffer>
+#include <QMutex>
 #include <algorithm>
 #include <array>
 #include <cstring>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <KisDocument.h>
 #include <KisImportExportErrorCode.h>
@@ -105,17 +108,18 @@ inline float value(const T *src, size_t ch)
     return linearizeValueAsNeeded<policy>(v);
 }
 
+/**
+ * Converts a run of pixels decoded by libjxl into the pixels of the
+ * target paint device. \p dst is expected to be zero-initialized.
+ */
+using PixelConverter = void (*)(const JPEGXLImportData &d, const void *src, quint8 *dst, size_t numPixels);
+
 template<typename channelsType, bool swap, LinearizePolicy policy, bool applyOOTF>
-inline void imageOutCallback(JPEGXLImportData &d)
+inline void convertPixels(const JPEGXLImportData &d, const void *pixels, quint8 *dst, size_t numPixels)
 {
-    const uint32_t xPos = d.m_header.layer_info.crop_x0;
-    const uint32_t yPos = d.m_header.layer_info.crop_y0;
-    const uint32_t width = d.m_header.layer_info.xsize;
-    const uint32_t height = d.m_header.layer_info.ysize;
-    KisHLineIteratorSP it = d.m_currentFrame->createHLineIteratorNG(xPos, yPos, width);
-
-    const auto *src = reinterpret_cast<const channelsType *>(d.m_rawData.data());
+    const auto *src = reinterpret_cast<const channelsType *>(pixels);
     const uint32_t channels = d.m_pixelFormat.num_channels;
+    const size_t pixelSize = d.m_currentFrame->pixelSize();
 
     if (policy != LinearizePolicy::KeepTheSame) {
         const KoColorSpace *cs = d.cs;
@@ -124,102 +128,90 @@ inline void imageOutCallback(JPEGXLImportData &d)
         float *tmp = pixelValues.data();
         const quint32 alphaPos = cs->alphaPos();
 
-        for (size_t j = 0; j < height; j++) {
-            for (size_t i = 0; i < width; i++) {
-                for (size_t i = 0; i < channels; i++) {
-                    tmp[i] = 1.0;
-                }
-
-                for (size_t ch = 0; ch < channels; ch++) {
-                    if (ch == alphaPos) {
-                        tmp[ch] = value<LinearizePolicy::KeepTheSame, channelsType>(src, ch);
-                    } else {
-                        tmp[ch] = value<policy, channelsType>(src, ch);
-                    }
-                }
+        for (size_t i = 0; i < numPixels; i++) {
+            for (size_t i = 0; i < channels; i++) {
+                tmp[i] = 1.0;
+            }
 
-                if (swap) {
-                    std::swap(tmp[0], tmp[2]);
+            for (size_t ch = 0; ch < channels; ch++) {
+                if (ch == alphaPos) {
+                    tmp[ch] = value<LinearizePolicy::KeepTheSame, channelsType>(src, ch);
+                } else {
+                    tmp[ch] = value<policy, channelsType>(src, ch);
                 }
+            }
 
-                if (policy == LinearizePolicy::LinearFromHLG && applyOOTF) {
-                    applyHLGOOTF(tmp, lCoef, d.displayGamma, d.displayNits);
-                }
+            if (swap) {
+                std::swap(tmp[0], tmp[2]);
+            }
 
-                cs->fromNormalisedChannelsValue(it->rawData(), pixelValues);
+            if (policy == LinearizePolicy::LinearFromHLG && applyOOTF) {
+                applyHLGOOTF(tmp, lCoef, d.displayGamma, d.displayNits);
+            }
 
-                src += d.m_pixelFormat.num_channels;
+            cs->fromNormalisedChannelsValue(dst, pixelValues);
 
-                it->nextPixel();
-            }
-            it->nextRow();
+            src += d.m_pixelFormat.num_channels;
+            dst += pixelSize;
         }
     } else {
-        for (size_t j = 0; j < height; j++) {
-            for (size_t i = 0; i < width; i++) {
-                auto *dst = reinterpret_cast<channelsType *>(it->rawData());
-
-                std::memcpy(dst, src, channels * sizeof(channelsType));
-
-                if (swap) {
-                    std::swap(dst[0], dst[2]);
-                } else if (d.isCMYK && d.m_info.uses_original_profile) {
-                    // Swap alpha and key channel for CMYK
-                    std::swap(dst[3], dst[4]);
-                }
+        for (size_t i = 0; i < numPixels; i++) {
+            auto *dstPixel = reinterpret_cast<channelsType *>(dst);
 
-                src += d.m_pixelFormat.num_channels;
+            std::memcpy(dstPixel, src, channels * sizeof(channelsType));
 
-                it->nextPixel();
+            if (swap) {
+                std::swap(dstPixel[0], dstPixel[2]);
+            } else if (d.isCMYK && d.m_info.uses_original_profile) {
+                // Swap alpha and key channel for CMYK
+                std::swap(dstPixel[3], dstPixel[4]);
             }
-            it->nextRow();
+
+            src += d.m_pixelFormat.num_channels;
+            dst += pixelSize;
         }
     }
 }
 
 template<typename channelsType, bool swap, LinearizePolicy policy>
-inline void generateCallbackWithPolicy(JPEGXLImportData &d)
+inline PixelConverter generateCallbackWithPolicy(const JPEGXLImportData &d)
 {
     if (d.applyOOTF) {
-        imageOutCallback<channelsType, swap, policy, true>(d);
+        return &convertPixels<channelsType, swap, policy, true>;
     } else {
-        imageOutCallback<channelsType, swap, policy, false>(d);
+        return &convertPixels<channelsType, swap, policy, false>;
     }
 }
 
 template<typename channelsType, bool swap>
-inline void generateCallbackWithSwap(JPEGXLImportData &d)
+inline PixelConverter generateCallbackWithSwap(const JPEGXLImportData &d)
 {
     switch (d.linearizePolicy) {
     case LinearizePolicy::LinearFromPQ:
-        generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::LinearFromPQ>(d);
-        break;
+        return generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::LinearFromPQ>(d);
     case LinearizePolicy::LinearFromHLG:
-        generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::LinearFromHLG>(d);
-        break;
+        return generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::LinearFromHLG>(d);
     case LinearizePolicy::LinearFromSMPTE428:
-        generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::LinearFromSMPTE428>(d);
-        break;
+        return generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::LinearFromSMPTE428>(d);
     case LinearizePolicy::KeepTheSame:
     default:
-        generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::KeepTheSame>(d);
-        break;
+        return generateCallbackWithPolicy<channelsType, swap, LinearizePolicy::KeepTheSame>(d);
     };
 }
 
 template<typename channelsType>
-inline void generateCallbackWithType(JPEGXLImportData &d)
+inline PixelConverter generateCallbackWithType(const JPEGXLImportData &d)
 {
     if (d.m_colorID == RGBAColorModelID
         && (d.m_depthID == Integer8BitsColorDepthID || d.m_depthID == Integer16BitsColorDepthID)
         && d.linearizePolicy == LinearizePolicy::KeepTheSame) {
-        generateCallbackWithSwap<channelsType, true>(d);
+        return generateCallbackWithSwap<channelsType, true>(d);
     } else {
-        generateCallbackWithSwap<channelsType, false>(d);
+        return generateCallbackWithSwap<channelsType, false>(d);
     }
 }
 
-inline void generateCallback(JPEGXLImportData &d)
+inline PixelConverter generateCallback(const JPEGXLImportData &d)
 {
     switch (d.m_pixelFormat.data_type) {
     case JXL_TYPE_FLOAT:
@@ -231,13 +223,90 @@ inline void generateCallback(JPEGXLImportData &d)
 #ifdef HAVE_OPENEXR
     case JXL_TYPE_FLOAT16:
         return generateCallbackWithType<half>(d);
-        break;
 #endif
     default:
         KIS_ASSERT_X(false, "JPEGXL::generateCallback", "Unknown image format!");
     }
+    return nullptr;
 }
 
+/**
+ * Converts the frame decoded into the raw buffer (used for CMYK, whose
+ * key channel comes in a separate planar buffer)
+ */
+inline void imageOutFromBuffer(JPEGXLImportData &d)
+{
+    const PixelConverter convert = generateCallback(d);
+
+    const int xPos = static_cast<int>(d.m_header.layer_info.crop_x0);
+    const int yPos = static_cast<int>(d.m_header.layer_info.crop_y0);
+    const size_t width = d.m_header.layer_info.xsize;
+    const size_t height = d.m_header.layer_info.ysize;
+
+    // the rows are not aligned, see m_pixelFormat
+    const size_t srcRowSize = d.m_rawData.size() / height;
+    std::vector<quint8> row(width * d.m_currentFrame->pixelSize());
+
+    for (size_t j = 0; j < height; j++) {
+        std::fill(row.begin(), row.end(), 0);
+        convert(d, d.m_rawData.data() + j * srcRowSize, row.data(), width);
+        d.m_currentFrame->writeBytes(row.data(), xPos, yPos + static_cast<int>(j), static_cast<int>(width), 1);
+    }
+}
+
+/**
+ * Receives the pixels from the decoding threads of libjxl and writes them
+ * into the frame device directly, so the decoded frame is never stored in
+ * full in the intermediate format
+ */
+class ImageOutContext
+{
+public:
+    ImageOutContext(JPEGXLImportData &d)
+        : m_d(d)
+        , m_convert(generateCallback(d))
+        , m_origin(static_cast<int>(d.m_header.layer_info.crop_x0), static_cast<int>(d.m_header.layer_info.crop_y0))
+        , m_pixelSize(d.m_currentFrame->pixelSize())
+    {
+    }
+
+    static void *init(void *opaque, size_t numThreads, size_t numPixelsPerThread)
+    {
+        auto *ctx = static_cast<ImageOutContext *>(opaque);
+        ctx->m_scratch.assign(numThreads, std::vector<quint8>(numPixelsPerThread * ctx->m_pixelSize));
+        return ctx;
+    }
+
+    static void run(void *opaque, size_t threadId, size_t x, size_t y, size_t numPixels, const void *pixels)
+    {
+        auto *ctx = static_cast<ImageOutContext *>(opaque);
+        std::vector<quint8> &buffer = ctx->m_scratch[threadId];
+
+        std::fill_n(buffer.begin(), numPixels * ctx->m_pixelSize, 0);
+        ctx->m_convert(ctx->m_d, pixels, buffer.data(), numPixels);
+
+        QMutexLocker l(&ctx->m_mutex);
+        ctx->m_d.m_currentFrame->writeBytes(buffer.data(),
+                                            ctx->m_origin.x() + static_cast<int>(x),
+                                            ctx->m_origin.y() + static_cast<int>(y),
+                                            static_cast<int>(numPixels),
+                                            1);
+    }
+
+    static void destroy(void *opaque)
+    {
+        static_cast<ImageOutContext *>(opaque)->m_scratch.clear();
+    }
+
+private:
+    JPEGXLImportData &m_d;
+    const PixelConverter m_convert;
+    const QPoint m_origin;
+    const size_t m_pixelSize;
+    QMutex m_mutex;
+    std::vector<std::vector<quint8>> m_scratch;
+};
+
 JPEGXLImport::JPEGXLImport(QObject *parent, const QVariantList &)
     : KisImportExportFilter(parent)
 {
@@ -252,6 +321,8 @@ JPEGXLImport::convert(KisDocument *document, QIODevice *io, KisPropertiesConfigu
     }
 
     JPEGXLImportData d{};
+    // must outlive the decoding of the frame it has been set up for
+    std::unique_ptr<ImageOutContext> imageOutContext;
 
     // Multi-threaded parallel runner.
     auto runner = JxlResizableParallelRunnerMake(nullptr);
@@ -763,7 +834,23 @@ JPEGXLImport::convert(KisDocument *document, QIODevice *io, KisPropertiesConfigu
         } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
             d.m_currentFrame = new KisPaintDevice(image->colorSpace());
 
-            // Use raw byte buffer instead of image callback
+            if (!d.isCMYK) {
+                // Convert the pixels on the decoding threads as soon as they are ready
+                imageOutContext.reset(new ImageOutContext(d));
+                if (JXL_DEC_SUCCESS
+                    != JxlDecoderSetMultithreadedImageOutCallback(dec.get(),
+                                                                  &d.m_pixelFormat,
+                                                                  &ImageOutContext::init,
+                                                                  &ImageOutContext::run,
+                                                                  &ImageOutContext::destroy,
+                                                                  imageOutContext.get())) {
+                    qWarning() << "JxlDecoderSetMultithreadedImageOutCallback failed";
+                    return ImportExportCodes::InternalError;
+                }
+                continue;
+            }
+
+            // CMYK uses raw byte buffer instead of image callback
             size_t rawSize = 0;
             if (JXL_DEC_SUCCESS != JxlDecoderImageOutBufferSize(dec.get(), &d.m_pixelFormat, &rawSize)) {
                 qWarning() << "JxlDecoderImageOutBufferSize failed";
@@ -779,7 +866,7 @@ JPEGXLImport::convert(KisDocument *document, QIODevice *io, KisPropertiesConfigu
                 return ImportExportCodes::InternalError;
             }
 
-            if (d.isCMYK) {
+            {
                 // Prepare planar buffer for key channel
                 size_t bufferSize = 0;
                 if (JXL_DEC_SUCCESS
@@ -859,8 +946,10 @@ JPEGXLImport::convert(KisDocument *document, QIODevice *io, KisPropertiesConfigu
                 }
             }
         } else if (status == JXL_DEC_FULL_IMAGE) {
-            // Parse raw data using existing callback function
-            generateCallback(d);
+            if (d.isCMYK) {
+                // Parse raw data using existing callback function
+                imageOutFromBuffer(d);
+            }
             const JxlLayerInfo layerInfo = d.m_header.layer_info;
             const QRect layerBounds = QRect(static_cast<int>(layerInfo.crop_x0),
                                             static_cast<int>(layerInfo.crop_y0),
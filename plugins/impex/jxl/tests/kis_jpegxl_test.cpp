@@ -14,6 +14,7 @@
 
 #include <filestest.h>
 #include <kis_meta_data_backend_registry.h>
+#include <kis_sequential_iterator.h>
 #include <testui.h>
 
 
@@ -271,4 +272,68 @@ void KisJPEGXLTest::testImportIncorrectFormat()
     TestUtil::testImportIncorrectFormat(MIMETYPE);
 }
 
+void KisJPEGXLTest::testLosslessRoundTripLarge_data()
+{
+    QTest::addColumn<bool>("flattenLayers");
+
+    QTest::newRow("flattened") << true;
+    QTest::newRow("layers") << false;
+}
+
+void KisJPEGXLTest::testLosslessRoundTripLarge()
+{
+    QFETCH(bool, flattenLayers);
+
+    // bigger than a single 2048x2048 chunk of the encoder and not aligned to it
+    const QRect bounds(0, 0, 2600, 2100);
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP original;
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        KisImageSP image = new KisImage(0, bounds.width(), bounds.height(), cs, "jxl test");
+
+        KisPaintLayerSP layer = new KisPaintLayer(image, "paint0", OPACITY_OPAQUE_U8);
+        KisSequentialIterator it(layer->paintDevice(), bounds);
+        while (it.nextPixel()) {
+            quint8 *dst = it.rawData();
+            dst[0] = quint8(it.x() * 7 + it.y());
+            dst[1] = quint8(it.y() * 3);
+            dst[2] = quint8(it.x() ^ it.y());
+            dst[3] = 255;
+        }
+        image->addNode(layer, image->root());
+        image->initialRefreshGraph();
+
+        original = new KisPaintDevice(*layer->paintDevice());
+
+        doc->setFileBatchMode(true);
+        doc->setCurrentImage(image);
+
+        KisPropertiesConfigurationSP exportConfiguration = new KisPropertiesConfiguration();
+        exportConfiguration->setProperty("lossless", true);
+        exportConfiguration->setProperty("effort", 1);
+        exportConfiguration->setProperty("flattenLayers", flattenLayers);
+        QVERIFY(doc->exportDocumentSync("test_large.jxl", MIMETYPE.toLatin1(), exportConfiguration));
+    }
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        KisImportExportManager manager(doc.data());
+        doc->setFileBatchMode(true);
+
+        const KisImportExportErrorCode status = manager.importDocument("test_large.jxl", QString());
+        QVERIFY(status.isOk());
+
+        KisImageSP image = doc->image();
+        QCOMPARE(image->bounds(), bounds);
+
+        QVERIFY(TestUtil::comparePaintDevicesClever<uint8_t>(original,
+                                                             image->root()->firstChild()->paintDevice(),
+                                                             0));
+    }
+}
+
 KISTEST_MAIN(KisJPEGXLTest)
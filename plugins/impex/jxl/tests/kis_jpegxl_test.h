@@ -23,6 +23,8 @@ private Q_SLOTS:
     void testSaveGreyAColorSpace();
     void testSaveCmykAColorSpace();
     void testImportIncorrectFormat();
+    void testLosslessRoundTripLarge_data();
+    void testLosslessRoundTripLarge();
 
 #ifndef Q_OS_WIN
 private Q_SLOTS:
@@ -14,6 +14,11 @@
 
 #include <testui.h>
 
+#include <QBuffer>
+
+#include <kis_png_converter.h>
+#include <kis_sequential_iterator.h>
+
 #ifndef FILES_DATA_DIR
 #error "FILES_DATA_DIR not set. A directory with the data used for testing the importing of files in krita"
 #endif
@@ -165,5 +170,111 @@ void KisPngTest::testSaveHDR()
                     KoColorSpaceRegistry::instance()->p2020PQProfile()));
 }
 
-KISTEST_MAIN(KisPngTest)
 
+
+namespace {
+
+KisPaintDeviceSP createNoisyDevice(const KoColorSpace *cs, const QRect &rc, int numColors)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const int pixelSize = cs->pixelSize();
+    quint32 seed = 1;
+
+    KisSequentialIterator it(dev, rc);
+    while (it.nextPixel()) {
+        quint8 *dst = it.rawData();
+
+        // smooth gradients with some noise, like a painting
+        seed = seed * 1103515245 + 12345;
+        const int noise = (seed >> 16) % 8;
+        const int colorIndex = (it.x() / 16 + it.y() / 16) % numColors;
+
+        for (int i = 0; i < pixelSize; i++) {
+            dst[i] = numColors < 256 ?
+                quint8(colorIndex * 37 + i * 11) :
+                quint8(it.x() + it.y() * (i + 1) + noise);
+        }
+
+        cs->setOpacity(dst, OPACITY_OPAQUE_U8, 1);
+    }
+
+    return dev;
+}
+
+KisPaintDeviceSP encodeAndDecode(KisPaintDeviceSP dev, const QRect &rc, const KisPNGOptions &options)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    vKisAnnotationSP annotations;
+
+    KisPNGConverter encoder(doc.data(), true);
+    KisImportExportErrorCode result =
+        encoder.buildFile(&buffer, rc, 72, 72, dev, annotations.begin(), annotations.end(), options, 0);
+
+    buffer.close();
+
+    if (!result.isOk()) return 0;
+
+    buffer.open(QIODevice::ReadOnly);
+
+    KisPNGConverter decoder(doc.data(), true);
+    if (!decoder.buildImage(&buffer).isOk()) return 0;
+
+    KisImageSP image = decoder.image();
+    image->initialRefreshGraph();
+
+    return image->projection();
+}
+
+}
+
+void KisPngTest::testParallelEncoding_data()
+{
+    QTest::addColumn<QString>("colorModel");
+    QTest::addColumn<QString>("colorDepth");
+    QTest::addColumn<bool>("alpha");
+    QTest::addColumn<int>("numColors");
+
+    QTest::newRow("rgba8") << RGBAColorModelID.id() << Integer8BitsColorDepthID.id() << true << 256;
+    QTest::newRow("rgb8") << RGBAColorModelID.id() << Integer8BitsColorDepthID.id() << false << 256;
+    QTest::newRow("rgba16") << RGBAColorModelID.id() << Integer16BitsColorDepthID.id() << true << 256;
+    QTest::newRow("graya8") << GrayAColorModelID.id() << Integer8BitsColorDepthID.id() << true << 256;
+    QTest::newRow("graya16") << GrayAColorModelID.id() << Integer16BitsColorDepthID.id() << true << 256;
+    QTest::newRow("indexed-4bit") << RGBAColorModelID.id() << Integer8BitsColorDepthID.id() << false << 12;
+}
+
+void KisPngTest::testParallelEncoding()
+{
+    QFETCH(QString, colorModel);
+    QFETCH(QString, colorDepth);
+    QFETCH(bool, alpha);
+    QFETCH(int, numColors);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(colorModel, colorDepth, 0);
+
+    // several bands with the size not aligned to the tiles
+    const QRect rc(0, 0, 1000, 1100);
+    KisPaintDeviceSP dev = createNoisyDevice(cs, rc, numColors);
+
+    KisPNGOptions options;
+    options.alpha = alpha;
+    options.compression = 6;
+
+    options.parallelEncoding = false;
+    KisPaintDeviceSP sequentialResult = encodeAndDecode(dev, rc, options);
+    QVERIFY(sequentialResult);
+
+    options.parallelEncoding = true;
+    KisPaintDeviceSP parallelResult = encodeAndDecode(dev, rc, options);
+    QVERIFY(parallelResult);
+
+    QCOMPARE(parallelResult->exactBounds(), sequentialResult->exactBounds());
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, parallelResult, sequentialResult));
+}
+
+KISTEST_MAIN(KisPngTest)
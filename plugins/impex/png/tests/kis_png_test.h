@@ -16,6 +16,9 @@ private Q_SLOTS:
     void testFiles();
     void testWriteonly();
     void testSaveHDR();
+
+    void testParallelEncoding_data();
+    void testParallelEncoding();
 };
 
 #endif
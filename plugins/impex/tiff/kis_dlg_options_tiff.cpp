@@ -54,6 +54,10 @@ KisTIFFOptionsWidget::KisTIFFOptionsWidget(QWidget *parent)
                                                || index == lzw);
             });
 
+    for (int size : {128, 256, 512, 1024}) {
+        kComboBoxTileSize->addItem(i18nc("TIFF options, tile size", "%1 x %1 px", size), size);
+    }
+
     kComboBoxPredictor->addItem(i18nc("TIFF options", "None"), 0);
     kComboBoxPredictor->addItem(
         i18nc("TIFF options", "Horizontal Differencing"),
@@ -83,6 +87,9 @@ void KisTIFFOptionsWidget::setConfiguration(const KisPropertiesConfigurationSP c
     compressionLevelDeflate->setValue(cfg->getInt("deflate", 6));
     compressionLevelPixarLog->setValue(cfg->getInt("pixarlog", 6));
     chkSaveProfile->setChecked(cfg->getBool("saveProfile", true));
+    chkTiled->setChecked(cfg->getBool("tiled", false));
+    kComboBoxTileSize->setCurrentIndex(qMax(0, kComboBoxTileSize->findData(cfg->getInt("tileSize", 256))));
+    chkPyramid->setChecked(cfg->getBool("pyramid", false));
 
     {
         const QString colorDepthId =
@@ -127,6 +134,9 @@ KisPropertiesConfigurationSP KisTIFFOptionsWidget::configuration() const
     cfg->setProperty("deflate", compressionLevelDeflate->value());
     cfg->setProperty("pixarlog", compressionLevelPixarLog->value());
     cfg->setProperty("saveProfile", chkSaveProfile->isChecked());
+    cfg->setProperty("tiled", chkTiled->isChecked());
+    cfg->setProperty("tileSize", kComboBoxTileSize->currentData());
+    cfg->setProperty("pyramid", chkPyramid->isChecked());
 
     return cfg;
 }
@@ -39,6 +39,9 @@ KisPropertiesConfigurationSP KisTIFFOptions::toProperties() const
     cfg->setProperty("deflate", deflateCompress);
     cfg->setProperty("pixarlog", pixarLogCompress);
     cfg->setProperty("saveProfile", saveProfile);
+    cfg->setProperty("tiled", tiled);
+    cfg->setProperty("tileSize", tileSize);
+    cfg->setProperty("pyramid", pyramid);
 
     return cfg;
 }
@@ -75,4 +78,8 @@ void KisTIFFOptions::fromProperties(KisPropertiesConfigurationSP cfg)
     deflateCompress = static_cast<quint16>(cfg->getInt("deflate", 6));
     pixarLogCompress = static_cast<quint16>(cfg->getInt("pixarlog", 6));
     saveProfile = cfg->getBool("saveProfile", true);
+    tiled = cfg->getBool("tiled", false);
+    // TIFF requires the tile dimensions to be multiples of 16
+    tileSize = static_cast<quint16>(qBound(16, cfg->getInt("tileSize", 256), 4096) & ~15);
+    pyramid = tiled && cfg->getBool("pyramid", false);
 }
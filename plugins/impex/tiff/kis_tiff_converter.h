@@ -23,6 +23,9 @@ struct KisTIFFOptions {
     quint16 deflateCompress = 6;
     quint16 pixarLogCompress = 6;
     bool saveProfile = true;
+    bool tiled = false;
+    quint16 tileSize = 256;
+    bool pyramid = false;
 
     KisPropertiesConfigurationSP toProperties() const;
     void fromProperties(KisPropertiesConfigurationSP cfg);
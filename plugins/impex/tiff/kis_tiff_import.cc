@@ -10,12 +10,20 @@
 #include "kis_assert.h"
 
 #include <QBuffer>
+#include <QFile>
 #include <QFileInfo>
+#include <QMutex>
 #include <QPair>
 #include <QSharedPointer>
 #include <QStack>
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
 
 #include <exiv2/exiv2.hpp>
 #include <kpluginfactory.h>
@@ -313,6 +321,167 @@ makePostProcessor(uint32_t nbsamples, const QPair<QString, QString> &id)
     }
 }
 
+/**
+ * Decodes the strips or the tiles of the current directory concurrently.
+ *
+ * A TIFF handle keeps the state of the codec, so it cannot be shared
+ * between the threads. Every worker opens the file once more, moves its
+ * own handle to the same directory and decodes the chunks with it. The
+ * decoded chunks are passed to the consumer in the file order, one batch
+ * at a time, so that the memory used by the decoded data is bounded.
+ */
+class KisTiffParallelDecoder
+{
+public:
+    struct Chunk {
+        QPoint pos;
+        // a single buffer for the contiguous planar configuration,
+        // a buffer per sample otherwise
+        QVector<QByteArray> planes;
+    };
+
+    KisTiffParallelDecoder(const QString &filename, TIFF *image, uint16_t planarconfig, uint16_t nbchannels)
+        : m_filename(filename)
+        , m_directory(TIFFCurrentDirectory(image))
+        , m_tiled(TIFFIsTiled(image))
+        , m_numPlanes(planarconfig == PLANARCONFIG_CONTIG ? 1 : nbchannels)
+    {
+        std::unique_ptr<Handle> handle = openHandle();
+        if (handle) {
+            m_freeHandles.append(handle.get());
+            m_handles.push_back(std::move(handle));
+        }
+    }
+
+    bool isValid() const
+    {
+        return !m_handles.empty();
+    }
+
+    /**
+     * Decodes the chunks starting at \p positions into the buffers of
+     * \p chunkSize bytes and passes them to \p consume in the same order
+     */
+    bool decode(const QVector<QPoint> &positions, tmsize_t chunkSize, const std::function<void(const Chunk &)> &consume)
+    {
+        const int batchSize = QThread::idealThreadCount() * 2;
+
+        for (int batchStart = 0; batchStart < positions.size(); batchStart += batchSize) {
+            QVector<Chunk> batch;
+            for (int i = batchStart; i < qMin(batchStart + batchSize, positions.size()); i++) {
+                batch.append({positions[i], QVector<QByteArray>(m_numPlanes, QByteArray(static_cast<int>(chunkSize), 0))});
+            }
+
+            std::atomic<bool> failed{false};
+
+            QtConcurrent::blockingMap(batch, [&](Chunk &chunk) {
+                Handle *handle = acquireHandle();
+                if (!handle) {
+                    failed = true;
+                    return;
+                }
+
+                const uint32_t x = static_cast<uint32_t>(chunk.pos.x());
+                const uint32_t y = static_cast<uint32_t>(chunk.pos.y());
+
+                for (int i = 0; i < chunk.planes.size(); i++) {
+                    const tsample_t sample = m_numPlanes > 1 ? static_cast<tsample_t>(i) : 0;
+                    void *data = chunk.planes[i].data();
+
+                    // like in the sequential reading, a broken chunk is left blank
+                    const tmsize_t result = m_tiled
+                        ? TIFFReadTile(handle->tiff.get(), data, x, y, 0, m_numPlanes > 1 ? sample : (tsample_t)-1)
+                        : TIFFReadEncodedStrip(handle->tiff.get(),
+                                               TIFFComputeStrip(handle->tiff.get(), y, sample),
+                                               data,
+                                               (tsize_t)-1);
+                    if (result < 0) {
+                        dbgFile << "Failed to decode the chunk at" << chunk.pos << "sample" << i;
+                    }
+                }
+
+                releaseHandle(handle);
+            });
+
+            if (failed) {
+                return false;
+            }
+
+            for (const Chunk &chunk : batch) {
+                consume(chunk);
+            }
+        }
+
+        return true;
+    }
+
+private:
+    struct Handle {
+        QFile file;
+        std::unique_ptr<TIFF, decltype(&TIFFCleanup)> tiff{nullptr, &TIFFCleanup};
+    };
+
+    std::unique_ptr<Handle> openHandle() const
+    {
+        std::unique_ptr<Handle> handle(new Handle());
+
+        handle->file.setFileName(m_filename);
+        if (!handle->file.open(QFile::ReadOnly)) {
+            return nullptr;
+        }
+
+        const QByteArray encodedFilename = QFile::encodeName(m_filename);
+
+        // https://gitlab.com/libtiff/libtiff/-/issues/173
+#ifdef Q_OS_WIN
+        const intptr_t fd = _get_osfhandle(handle->file.handle());
+#else
+        const int fd = handle->file.handle();
+#endif
+
+        handle->tiff.reset(TIFFFdOpen(fd, encodedFilename.data(), "r"));
+        if (!handle->tiff || !TIFFSetDirectory(handle->tiff.get(), m_directory)) {
+            return nullptr;
+        }
+
+        return handle;
+    }
+
+    Handle *acquireHandle()
+    {
+        {
+            QMutexLocker l(&m_mutex);
+            if (!m_freeHandles.isEmpty()) {
+                return m_freeHandles.takeLast();
+            }
+        }
+
+        std::unique_ptr<Handle> handle = openHandle();
+        if (!handle) {
+            return nullptr;
+        }
+
+        QMutexLocker l(&m_mutex);
+        m_handles.push_back(std::move(handle));
+        return m_handles.back().get();
+    }
+
+    void releaseHandle(Handle *handle)
+    {
+        QMutexLocker l(&m_mutex);
+        m_freeHandles.append(handle);
+    }
+
+    const QString m_filename;
+    const tdir_t m_directory;
+    const bool m_tiled;
+    const int m_numPlanes;
+
+    QMutex m_mutex;
+    std::vector<std::unique_ptr<Handle>> m_handles;
+    QVector<Handle *> m_freeHandles;
+};
+
 KisTIFFImport::KisTIFFImport(QObject *parent, const QVariantList &)
     : KisImportExportFilter(parent)
     , m_image(nullptr)
@@ -1052,6 +1221,32 @@ KisTIFFImport::readImageFromTiff(KisDocument *m_doc,
     }
 #endif
 
+    // The subsampled JPEG chunks are decoded with libjpeg-turbo, everything
+    // else is decoded by libtiff and can be done concurrently
+    const bool isSubsampledJpeg = planarconfig == PLANARCONFIG_CONTIG
+        && color_type == PHOTOMETRIC_YCBCR && compression == COMPRESSION_JPEG
+        && hsubsampling != 1 && vsubsampling != 1;
+
+    std::unique_ptr<KisTiffParallelDecoder> parallelDecoder;
+    if (!isSubsampledJpeg && QThread::idealThreadCount() > 1) {
+        parallelDecoder.reset(new KisTiffParallelDecoder(filename(), image, planarconfig, nbchannels));
+        if (!parallelDecoder->isValid()) {
+            dbgFile << "Could not reopen the file, decoding sequentially";
+            parallelDecoder.reset();
+        }
+    }
+
+    // copies the decoded chunk into the buffers the stream reads from
+    const auto fetchDecodedChunk = [&](const KisTiffParallelDecoder::Chunk &chunk) {
+        if (planarconfig == PLANARCONFIG_CONTIG) {
+            std::memcpy(buf.get(), chunk.planes[0].constData(), static_cast<size_t>(chunk.planes[0].size()));
+        } else {
+            for (int i = 0; i < chunk.planes.size(); i++) {
+                std::memcpy((*ps_buf)[i], chunk.planes[i].constData(), static_cast<size_t>(chunk.planes[i].size()));
+            }
+        }
+    };
+
     if (TIFFIsTiled(image)) {
         dbgFile << "tiled image";
         uint32_t tileWidth = 0;
@@ -1171,74 +1366,96 @@ KisTIFFImport::readImageFromTiff(KisDocument *m_doc,
         dbgFile << " NbOfTiles =" << TIFFNumberOfTiles(image)
                 << " tileWidth =" << tileWidth << " tileSize =" << tileSize;
 
+        const auto copyTile = [&](uint32_t x, uint32_t y) {
+            uint32_t realTileWidth =
+                (x + tileWidth) < width ? tileWidth : width - x;
+            for (uint32_t yintile = 0;
+                 yintile < tileHeight && y + yintile < height;) {
+                uint32_t linesread =
+                    tiffReader->copyDataToChannels(x,
+                                                   y + yintile,
+                                                   realTileWidth,
+                                                   tiffstream);
+                yintile += linesread;
+                tiffstream->moveToLine(yintile);
+            }
+            tiffstream->restart();
+        };
+
+        QVector<QPoint> tilePositions;
         for (y = 0; y < height; y += tileHeight) {
             for (x = 0; x < width; x += tileWidth) {
-                dbgFile << "Reading tile x =" << x << " y =" << y;
+                tilePositions.append(QPoint(static_cast<int>(x), static_cast<int>(y)));
+            }
+        }
+
+        if (parallelDecoder && tilePositions.size() > 1) {
+            const bool result =
+                parallelDecoder->decode(tilePositions, tileSize, [&](const KisTiffParallelDecoder::Chunk &chunk) {
+                    fetchDecodedChunk(chunk);
+                    copyTile(static_cast<uint32_t>(chunk.pos.x()), static_cast<uint32_t>(chunk.pos.y()));
+                });
+            if (!result) {
+                return ImportExportCodes::ErrorWhileReading;
+            }
+        } else {
+            for (y = 0; y < height; y += tileHeight) {
+                for (x = 0; x < width; x += tileWidth) {
+                    dbgFile << "Reading tile x =" << x << " y =" << y;
 #ifdef HAVE_JPEG_TURBO
-                if (planarconfig == PLANARCONFIG_CONTIG
-                    && !(color_type == PHOTOMETRIC_YCBCR
-                         && compression == COMPRESSION_JPEG && hsubsampling != 1
-                         && vsubsampling != 1)) {
+                    if (planarconfig == PLANARCONFIG_CONTIG
+                        && !(color_type == PHOTOMETRIC_YCBCR
+                             && compression == COMPRESSION_JPEG && hsubsampling != 1
+                             && vsubsampling != 1)) {
 #else
-                if (planarconfig == PLANARCONFIG_CONTIG) {
+                    if (planarconfig == PLANARCONFIG_CONTIG) {
 #endif
-                    TIFFReadTile(image, buf.get(), x, y, 0, (tsample_t)-1);
+                        TIFFReadTile(image, buf.get(), x, y, 0, (tsample_t)-1);
 #ifdef HAVE_JPEG_TURBO
-                } else if (planarconfig == PLANARCONFIG_CONTIG
-                           && (color_type == PHOTOMETRIC_YCBCR
-                               && compression == COMPRESSION_JPEG)) {
-                    uint32_t tile =
-                        TIFFComputeTile(image, x, y, 0, (tsample_t)-1);
-                    TIFFReadRawTile(image, tile, jpegBuf.data(), tileSize);
-
-                    int width = tileWidth;
-                    int height = tileHeight;
-                    int jpegSubsamp = TJ_444;
-                    int jpegColorspace = TJCS_YCbCr;
-
-                    if (tjDecompressHeader3(handle.get(),
-                                            jpegBuf.data(),
-                                            tileSize,
-                                            &width,
-                                            &height,
-                                            &jpegSubsamp,
-                                            &jpegColorspace)
-                        != 0) {
-                        errFile << tjGetErrorStr2(handle.get());
-                        return ImportExportCodes::FileFormatIncorrect;
-                    }
-
-                    if (tjDecompressToYUVPlanes(handle.get(),
+                    } else if (planarconfig == PLANARCONFIG_CONTIG
+                               && (color_type == PHOTOMETRIC_YCBCR
+                                   && compression == COMPRESSION_JPEG)) {
+                        uint32_t tile =
+                            TIFFComputeTile(image, x, y, 0, (tsample_t)-1);
+                        TIFFReadRawTile(image, tile, jpegBuf.data(), tileSize);
+
+                        int width = tileWidth;
+                        int height = tileHeight;
+                        int jpegSubsamp = TJ_444;
+                        int jpegColorspace = TJCS_YCbCr;
+
+                        if (tjDecompressHeader3(handle.get(),
                                                 jpegBuf.data(),
                                                 tileSize,
-                                                ps_buf->data(),
-                                                width,
-                                                nullptr,
-                                                height,
-                                                0)
-                        != 0) {
-                        errFile << tjGetErrorStr2(handle.get());
-                        return ImportExportCodes::FileFormatIncorrect;
-                    }
+                                                &width,
+                                                &height,
+                                                &jpegSubsamp,
+                                                &jpegColorspace)
+                            != 0) {
+                            errFile << tjGetErrorStr2(handle.get());
+                            return ImportExportCodes::FileFormatIncorrect;
+                        }
+
+                        if (tjDecompressToYUVPlanes(handle.get(),
+                                                    jpegBuf.data(),
+                                                    tileSize,
+                                                    ps_buf->data(),
+                                                    width,
+                                                    nullptr,
+                                                    height,
+                                                    0)
+                            != 0) {
+                            errFile << tjGetErrorStr2(handle.get());
+                            return ImportExportCodes::FileFormatIncorrect;
+                        }
 #endif
-                } else {
-                    for (uint16_t i = 0; i < nbchannels; i++) {
-                        TIFFReadTile(image, (*ps_buf)[i], x, y, 0, i);
+                    } else {
+                        for (uint16_t i = 0; i < nbchannels; i++) {
+                            TIFFReadTile(image, (*ps_buf)[i], x, y, 0, i);
+                        }
                     }
+                    copyTile(x, y);
                 }
-                uint32_t realTileWidth =
-                    (x + tileWidth) < width ? tileWidth : width - x;
-                for (uint32_t yintile = 0;
-                     yintile < tileHeight && y + yintile < height;) {
-                    uint32_t linesread =
-                        tiffReader->copyDataToChannels(x,
-                                                       y + yintile,
-                                                       realTileWidth,
-                                                       tiffstream);
-                    yintile += linesread;
-                    tiffstream->moveToLine(yintile);
-                }
-                tiffstream->restart();
             }
         }
     } else {
@@ -1356,73 +1573,97 @@ KisTIFFImport::readImageFromTiff(KisDocument *m_doc,
                 << " rowsPerStrip =" << rowsPerStrip
                 << " stripsize =" << stripsize;
 
-        for (uint32_t strip = 0; y < height; strip++) {
+        if (parallelDecoder && TIFFNumberOfStrips(image) > 1) {
+            QVector<QPoint> stripPositions;
+            for (uint32_t stripY = 0; stripY < height; stripY += rowsPerStrip) {
+                stripPositions.append(QPoint(0, static_cast<int>(stripY)));
+            }
+
+            const bool result =
+                parallelDecoder->decode(stripPositions, stripsize, [&](const KisTiffParallelDecoder::Chunk &chunk) {
+                    fetchDecodedChunk(chunk);
+
+                    y = static_cast<uint32_t>(chunk.pos.y());
+                    for (uint32_t yinstrip = 0; yinstrip < rowsPerStrip && y < height;) {
+                        uint32_t linesread = tiffReader->copyDataToChannels(0, y, width, tiffstream);
+                        y += linesread;
+                        yinstrip += linesread;
+                        tiffstream->moveToLine(yinstrip);
+                    }
+                    tiffstream->restart();
+                });
+            if (!result) {
+                return ImportExportCodes::ErrorWhileReading;
+            }
+        } else {
+            for (uint32_t strip = 0; y < height; strip++) {
 #ifdef HAVE_JPEG_TURBO
-            if (planarconfig == PLANARCONFIG_CONTIG
-                && !(color_type == PHOTOMETRIC_YCBCR
-                     && compression == COMPRESSION_JPEG && hsubsampling != 1
-                     && vsubsampling != 1)) {
+                if (planarconfig == PLANARCONFIG_CONTIG
+                    && !(color_type == PHOTOMETRIC_YCBCR
+                         && compression == COMPRESSION_JPEG && hsubsampling != 1
+                         && vsubsampling != 1)) {
 #else
-            if (planarconfig == PLANARCONFIG_CONTIG) {
+                if (planarconfig == PLANARCONFIG_CONTIG) {
 #endif
-                TIFFReadEncodedStrip(image,
-                                     TIFFComputeStrip(image, y, 0),
-                                     buf.get(),
-                                     (tsize_t)-1);
+                    TIFFReadEncodedStrip(image,
+                                         TIFFComputeStrip(image, y, 0),
+                                         buf.get(),
+                                         (tsize_t)-1);
 #ifdef HAVE_JPEG_TURBO
-            } else if (planarconfig == PLANARCONFIG_CONTIG
-                       && (color_type == PHOTOMETRIC_YCBCR
-                           && compression == COMPRESSION_JPEG)) {
-                TIFFReadRawStrip(image, strip, jpegBuf.data(), stripsize);
-
-                int width = basicInfo.width;
-                int height = rowsPerStrip;
-                int jpegSubsamp = TJ_444;
-                int jpegColorspace = TJCS_YCbCr;
-
-                if (tjDecompressHeader3(handle.get(),
-                                        jpegBuf.data(),
-                                        stripsize,
-                                        &width,
-                                        &height,
-                                        &jpegSubsamp,
-                                        &jpegColorspace)
-                    != 0) {
-                    errFile << tjGetErrorStr2(handle.get());
-                    return ImportExportCodes::FileFormatIncorrect;
-                }
+                } else if (planarconfig == PLANARCONFIG_CONTIG
+                           && (color_type == PHOTOMETRIC_YCBCR
+                               && compression == COMPRESSION_JPEG)) {
+                    TIFFReadRawStrip(image, strip, jpegBuf.data(), stripsize);
 
-                if (tjDecompressToYUVPlanes(
-                        handle.get(),
-                        jpegBuf.data(),
-                        stripsize,
-                        ps_buf->data(),
-                        width,
-                        nullptr,
-                        height,
-                        0)
-                    != 0) {
-                    errFile << tjGetErrorStr2(handle.get());
-                    return ImportExportCodes::FileFormatIncorrect;
-                }
+                    int width = basicInfo.width;
+                    int height = rowsPerStrip;
+                    int jpegSubsamp = TJ_444;
+                    int jpegColorspace = TJCS_YCbCr;
+
+                    if (tjDecompressHeader3(handle.get(),
+                                            jpegBuf.data(),
+                                            stripsize,
+                                            &width,
+                                            &height,
+                                            &jpegSubsamp,
+                                            &jpegColorspace)
+                        != 0) {
+                        errFile << tjGetErrorStr2(handle.get());
+                        return ImportExportCodes::FileFormatIncorrect;
+                    }
+
+                    if (tjDecompressToYUVPlanes(
+                            handle.get(),
+                            jpegBuf.data(),
+                            stripsize,
+                            ps_buf->data(),
+                            width,
+                            nullptr,
+                            height,
+                            0)
+                        != 0) {
+                        errFile << tjGetErrorStr2(handle.get());
+                        return ImportExportCodes::FileFormatIncorrect;
+                    }
 #endif
-            } else {
-                for (uint16_t i = 0; i < nbchannels; i++) {
-                    TIFFReadEncodedStrip(image,
-                                         TIFFComputeStrip(image, y, i),
-                                         (*ps_buf)[i],
-                                         (tsize_t)-1);
+                } else {
+                    for (uint16_t i = 0; i < nbchannels; i++) {
+                        TIFFReadEncodedStrip(image,
+                                             TIFFComputeStrip(image, y, i),
+                                             (*ps_buf)[i],
+                                             (tsize_t)-1);
+                    }
                 }
+                for (uint32_t yinstrip = 0;
+                     yinstrip < rowsPerStrip && y < height;) {
+                    uint32_t linesread =
+                        tiffReader->copyDataToChannels(0, y, width, tiffstream);
+                    y += linesread;
+                    yinstrip += linesread;
+                    tiffstream->moveToLine(yinstrip);
+                }
+                tiffstream->restart();
             }
-            for (uint32_t yinstrip = 0;
-                 yinstrip < rowsPerStrip && y < height;) {
-                uint32_t linesread =
-                    tiffReader->copyDataToChannels(0, y, width, tiffstream);
-                y += linesread;
-                yinstrip += linesread;
-                tiffstream->moveToLine(yinstrip);
-            }
-            tiffstream->restart();
         }
     }
     tiffReader->finalize();
@@ -1860,6 +2101,14 @@ KisTIFFImport::convert(KisDocument *document,
         // Ward off inconsistencies by blocking future attempts to parse them
         m_photoshopBlockParsed = true;
         while (TIFFReadDirectory(image.get())) {
+            // Reduced resolution copies of the first image, e.g. the
+            // pyramid levels, are not layers
+            uint32_t subfiletype = 0;
+            if (TIFFGetField(image.get(), TIFFTAG_SUBFILETYPE, &subfiletype)
+                && (subfiletype & FILETYPE_REDUCEDIMAGE)) {
+                dbgFile << "Skipping reduced resolution directory";
+                continue;
+            }
             result = readTIFFDirectory(document, image.get());
             if (!result.isOk()) {
                 return result;
@@ -6,8 +6,12 @@
  */
 
 #include <QBuffer>
+#include <QThread>
+#include <QtConcurrentMap>
 
+#include <cstring>
 #include <memory>
+#include <vector>
 
 #include <tiff.h>
 
@@ -16,8 +20,11 @@
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoID.h>
+#include <KoUpdater.h>
 #include <kis_assert.h>
+#include <kis_filter_strategy.h>
 #include <kis_meta_data_backend_registry.h>
+#include <kis_transform_worker.h>
 
 #include <KoConfig.h>
 #ifdef HAVE_OPENEXR
@@ -104,6 +111,82 @@ bool writeColorSpaceInformation(TIFF *image,
         return false;
     }
 }
+
+/**
+ * The codecs whose output for a tile depends only on the pixels of
+ * the tile, so it can be produced by a separate TIFF handle. JPEG is
+ * not in the list, since its tables are shared by the whole directory.
+ */
+bool canCompressConcurrently(quint16 compression)
+{
+    return compression == COMPRESSION_NONE || compression == COMPRESSION_LZW
+        || compression == COMPRESSION_DEFLATE || compression == COMPRESSION_ADOBE_DEFLATE
+        || compression == COMPRESSION_PACKBITS;
+}
+
+/**
+ * An in-memory file for TIFFClientOpen
+ */
+struct MemoryTiffFile {
+    QByteArray data;
+    qint64 pos = 0;
+
+    static tmsize_t read(thandle_t handle, void *buf, tmsize_t size)
+    {
+        auto *f = static_cast<MemoryTiffFile *>(handle);
+        const tmsize_t available = qBound<tmsize_t>(0, f->data.size() - f->pos, size);
+        std::memcpy(buf, f->data.constData() + f->pos, static_cast<size_t>(available));
+        f->pos += available;
+        return available;
+    }
+
+    static tmsize_t write(thandle_t handle, void *buf, tmsize_t size)
+    {
+        auto *f = static_cast<MemoryTiffFile *>(handle);
+        if (f->pos + size > f->data.size()) {
+            f->data.resize(static_cast<int>(f->pos + size));
+        }
+        std::memcpy(f->data.data() + f->pos, buf, static_cast<size_t>(size));
+        f->pos += size;
+        return size;
+    }
+
+    static toff_t seek(thandle_t handle, toff_t offset, int whence)
+    {
+        auto *f = static_cast<MemoryTiffFile *>(handle);
+        switch (whence) {
+        case SEEK_CUR:
+            f->pos += static_cast<qint64>(offset);
+            break;
+        case SEEK_END:
+            f->pos = f->data.size() + static_cast<qint64>(offset);
+            break;
+        default:
+            f->pos = static_cast<qint64>(offset);
+            break;
+        }
+        return static_cast<toff_t>(f->pos);
+    }
+
+    static int close(thandle_t)
+    {
+        return 0;
+    }
+
+    static toff_t size(thandle_t handle)
+    {
+        return static_cast<toff_t>(static_cast<MemoryTiffFile *>(handle)->data.size());
+    }
+
+    static int map(thandle_t, void **, toff_t *)
+    {
+        return 0;
+    }
+
+    static void unmap(thandle_t, void *, toff_t)
+    {
+    }
+};
 } // namespace
 
 KisTIFFWriterVisitor::KisTIFFWriterVisitor(TIFF*image, KisTIFFOptions* options)
@@ -211,8 +294,7 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
     }
 
     // Save depth
-    uint32_t depth = 8 * pd->pixelSize() / pd->channelCount();
-    TIFFSetField(image(), TIFFTAG_BITSPERSAMPLE, depth);
+    const uint32_t depth = 8 * pd->pixelSize() / pd->channelCount();
 
     {
         // WORKAROUND: block any attempts to use JPEG with >= 8 bits
@@ -224,52 +306,28 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
         }
     }
 
-    // Save number of samples
-    if (m_options->alpha) {
-        TIFFSetField(image(), TIFFTAG_SAMPLESPERPIXEL, pd->channelCount());
-        const std::array<uint16_t, 1> sampleinfo = {EXTRASAMPLE_UNASSALPHA};
-        TIFFSetField(image(), TIFFTAG_EXTRASAMPLES, 1, sampleinfo.data());
-    } else {
-        TIFFSetField(image(), TIFFTAG_SAMPLESPERPIXEL, pd->channelCount() - 1);
-        TIFFSetField(image(), TIFFTAG_EXTRASAMPLES, 0);
-    }
+    const LayerFormat format{depth, sample_format, color_type, pd->channelCount()};
+    const QSize size = layer->image()->bounds().size();
 
-    // Save colorspace information
-    TIFFSetField(image(), TIFFTAG_PHOTOMETRIC, color_type);
-    TIFFSetField(image(), TIFFTAG_SAMPLEFORMAT, sample_format);
-    TIFFSetField(image(), TIFFTAG_IMAGEWIDTH, layer->image()->width());
-    TIFFSetField(image(), TIFFTAG_IMAGELENGTH, layer->image()->height());
+    writeLayoutTags(image(), size, format);
 
-    // Set the compression options
-    TIFFSetField(image(), TIFFTAG_COMPRESSION, m_options->compressionType);
-    if (m_options->compressionType == COMPRESSION_JPEG) {
-        TIFFSetField(image(), TIFFTAG_JPEGQUALITY, m_options->jpegQuality);
-    } else if (m_options->compressionType == COMPRESSION_DEFLATE) {
-        TIFFSetField(image(), TIFFTAG_ZIPQUALITY, m_options->deflateCompress);
-    } else if (m_options->compressionType == COMPRESSION_PIXARLOG) {
-        TIFFSetField(image(),
-                     TIFFTAG_PIXARLOGQUALITY,
-                     m_options->pixarLogCompress);
-    }
-
-    // Set the predictor
-    if (m_options->compressionType == COMPRESSION_LZW
-        || m_options->compressionType == COMPRESSION_ADOBE_DEFLATE
-        || m_options->compressionType == COMPRESSION_DEFLATE)
-        TIFFSetField(image(), TIFFTAG_PREDICTOR, m_options->predictor);
-
-    // Use contiguous configuration
-    TIFFSetField(image(), TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-
-    // Do not set the rowsperstrip, as it's incompatible with JPEG
-
-    // But do set YCbCr 4:4:4 if applicable
-    if (color_type == PHOTOMETRIC_YCBCR) {
-        TIFFSetField(image(), TIFFTAG_YCBCRSUBSAMPLING, 1, 1);
-        TIFFSetField(image(), TIFFTAG_YCBCRPOSITIONING, YCBCRPOSITION_CENTERED);
-        if (m_options->compressionType == COMPRESSION_JPEG) {
-            TIFFSetField(image(), TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RAW);
+    // The reduced resolution levels are stored as SubIFDs, so that they
+    // are not mistaken for the layers by the readers
+    const int numLevels = [&]() {
+        int levels = 0;
+        if (m_options->tiled && m_options->pyramid) {
+            QSize levelSize = size;
+            while (qMax(levelSize.width(), levelSize.height()) > m_options->tileSize) {
+                levelSize = QSize((levelSize.width() + 1) / 2, (levelSize.height() + 1) / 2);
+                levels++;
+            }
         }
+        return levels;
+    }();
+
+    if (numLevels > 0) {
+        const std::vector<toff_t> subIfdOffsets(static_cast<size_t>(numLevels), 0);
+        TIFFSetField(image(), TIFFTAG_SUBIFD, static_cast<uint16_t>(numLevels), subIfdOffsets.data());
     }
 
     // Save profile
@@ -313,6 +371,140 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
         }
     }
 
+    if (!(m_options->tiled ? writeTiles(pd, size, format) : writeStrips(pd, size, format))) {
+        return false;
+    }
+
+    if (!TIFFWriteDirectory(image())) {
+        return false;
+    }
+
+    KisPaintDeviceSP levelDevice = pd;
+    QSize levelSize = size;
+
+    for (int level = 1; level <= numLevels; level++) {
+        levelDevice = new KisPaintDevice(*levelDevice);
+        levelSize = QSize((levelSize.width() + 1) / 2, (levelSize.height() + 1) / 2);
+
+        KoDummyUpdaterHolder updaterHolder;
+        KisTransformWorker worker(levelDevice,
+                                  0.5, 0.5,
+                                  0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                  updaterHolder.updater(),
+                                  KisFilterStrategyRegistry::instance()->value("Bilinear"));
+        worker.run();
+
+        TIFFSetField(image(), TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE);
+        writeLayoutTags(image(), levelSize, format);
+
+        if (!writeTiles(levelDevice, levelSize, format) || !TIFFWriteDirectory(image())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void KisTIFFWriterVisitor::writeLayoutTags(TIFF *tiff, const QSize &size, const LayerFormat &format) const
+{
+    TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, format.depth);
+
+    // Save number of samples
+    if (m_options->alpha) {
+        TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, format.channelCount);
+        const std::array<uint16_t, 1> sampleinfo = {EXTRASAMPLE_UNASSALPHA};
+        TIFFSetField(tiff, TIFFTAG_EXTRASAMPLES, 1, sampleinfo.data());
+    } else {
+        TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, format.channelCount - 1);
+        TIFFSetField(tiff, TIFFTAG_EXTRASAMPLES, 0);
+    }
+
+    // Save colorspace information
+    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, format.colorType);
+    TIFFSetField(tiff, TIFFTAG_SAMPLEFORMAT, format.sampleFormat);
+    if (format.colorType == PHOTOMETRIC_SEPARATED) {
+        TIFFSetField(tiff, TIFFTAG_INKSET, INKSET_CMYK);
+    }
+    TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, size.width());
+    TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, size.height());
+
+    // Set the compression options
+    TIFFSetField(tiff, TIFFTAG_COMPRESSION, m_options->compressionType);
+    if (m_options->compressionType == COMPRESSION_JPEG) {
+        TIFFSetField(tiff, TIFFTAG_JPEGQUALITY, m_options->jpegQuality);
+    } else if (m_options->compressionType == COMPRESSION_DEFLATE) {
+        TIFFSetField(tiff, TIFFTAG_ZIPQUALITY, m_options->deflateCompress);
+    } else if (m_options->compressionType == COMPRESSION_PIXARLOG) {
+        TIFFSetField(tiff,
+                     TIFFTAG_PIXARLOGQUALITY,
+                     m_options->pixarLogCompress);
+    }
+
+    // Set the predictor
+    if (m_options->compressionType == COMPRESSION_LZW
+        || m_options->compressionType == COMPRESSION_ADOBE_DEFLATE
+        || m_options->compressionType == COMPRESSION_DEFLATE)
+        TIFFSetField(tiff, TIFFTAG_PREDICTOR, m_options->predictor);
+
+    // Use contiguous configuration
+    TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+
+    // Do not set the rowsperstrip, as it's incompatible with JPEG
+    if (m_options->tiled) {
+        TIFFSetField(tiff, TIFFTAG_TILEWIDTH, m_options->tileSize);
+        TIFFSetField(tiff, TIFFTAG_TILELENGTH, m_options->tileSize);
+    }
+
+    // But do set YCbCr 4:4:4 if applicable
+    if (format.colorType == PHOTOMETRIC_YCBCR) {
+        TIFFSetField(tiff, TIFFTAG_YCBCRSUBSAMPLING, 1, 1);
+        TIFFSetField(tiff, TIFFTAG_YCBCRPOSITIONING, YCBCRPOSITION_CENTERED);
+        if (m_options->compressionType == COMPRESSION_JPEG) {
+            TIFFSetField(tiff, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RAW);
+        }
+    }
+}
+
+bool KisTIFFWriterVisitor::copyRowData(KisPaintDeviceSP pd,
+                                       int x,
+                                       int y,
+                                       int width,
+                                       tdata_t buff,
+                                       const LayerFormat &format)
+{
+    KisHLineConstIteratorSP it = pd->createHLineConstIteratorNG(x, y, width);
+
+    switch (format.colorType) {
+    case PHOTOMETRIC_MINISBLACK: {
+        const std::array<quint8, 5> poses = {0, 1};
+        return copyDataToStrips(it, buff, format.depth, format.sampleFormat, 1, poses);
+    }
+    case PHOTOMETRIC_RGB: {
+        const auto poses = [&]() -> std::array<quint8, 5> {
+            if (format.sampleFormat == SAMPLEFORMAT_IEEEFP) {
+                return {0, 1, 2, 3};
+            } else {
+                return {2, 1, 0, 3};
+            }
+        }();
+        return copyDataToStrips(it, buff, format.depth, format.sampleFormat, 3, poses);
+    }
+    case PHOTOMETRIC_SEPARATED: {
+        const std::array<quint8, 5> poses = {0, 1, 2, 3, 4};
+        return copyDataToStrips(it, buff, format.depth, format.sampleFormat, 4, poses);
+    }
+    case PHOTOMETRIC_ICCLAB:
+    case PHOTOMETRIC_YCBCR: {
+        const std::array<quint8, 5> poses = {0, 1, 2, 3};
+        return copyDataToStrips(it, buff, format.depth, format.sampleFormat, 3, poses);
+    }
+    }
+
+    return true;
+}
+
+bool KisTIFFWriterVisitor::writeStrips(KisPaintDeviceSP pd, const QSize &size, const LayerFormat &format)
+{
     tsize_t stripsize = TIFFStripSize(image());
     std::unique_ptr<std::remove_pointer_t<tdata_t>, decltype(&_TIFFfree)> buff(
         _TIFFmalloc(stripsize),
@@ -320,66 +512,133 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
     KIS_ASSERT_RECOVER_RETURN_VALUE(
         buff && "Unable to allocate buffer for TIFF!",
         false);
-    qint32 height = layer->image()->height();
-    qint32 width = layer->image()->width();
-    bool r = true;
-    for (int y = 0; y < height; y++) {
-        KisHLineConstIteratorSP it = pd->createHLineConstIteratorNG(0, y, width);
-        switch (color_type) {
-        case PHOTOMETRIC_MINISBLACK: {
-            const std::array<quint8, 5> poses = {0, 1};
-            r = copyDataToStrips(it,
-                                 buff.get(),
-                                 depth,
-                                 sample_format,
-                                 1,
-                                 poses);
-            }
-            break;
-        case PHOTOMETRIC_RGB: {
-            const auto poses = [&]() -> std::array<quint8, 5> {
-                if (sample_format == SAMPLEFORMAT_IEEEFP) {
-                    return {0, 1, 2, 3};
-                } else {
-                    return {2, 1, 0, 3};
-                }
-            }();
-            r = copyDataToStrips(it,
-                                 buff.get(),
-                                 depth,
-                                 sample_format,
-                                 3,
-                                 poses);
-            }
-            break;
-        case PHOTOMETRIC_SEPARATED: {
-            const std::array<quint8, 5> poses = {0, 1, 2, 3, 4};
-            r = copyDataToStrips(it,
-                                 buff.get(),
-                                 depth,
-                                 sample_format,
-                                 4,
-                                 poses);
-            }
-            break;
-            case PHOTOMETRIC_ICCLAB:
-            case PHOTOMETRIC_YCBCR: {
-                const std::array<quint8, 5> poses = {0, 1, 2, 3};
-                r = copyDataToStrips(it,
-                                     buff.get(),
-                                     depth,
-                                     sample_format,
-                                     3,
-                                     poses);
-            } break;
+
+    for (int y = 0; y < size.height(); y++) {
+        if (!copyRowData(pd, 0, y, size.width(), buff.get(), format)) {
+            return false;
         }
-        if (!r) return false;
         TIFFWriteScanline(image(),
                           buff.get(),
                           static_cast<uint32_t>(y),
                           (tsample_t)-1);
     }
-    buff.reset();
 
-    return TIFFWriteDirectory(image());
+    return true;
+}
+
+bool KisTIFFWriterVisitor::writeTiles(KisPaintDeviceSP pd, const QSize &size, const LayerFormat &format)
+{
+    const int tileSize = m_options->tileSize;
+    const tmsize_t tileBytes = TIFFTileSize(image());
+    const tmsize_t tileRowBytes = TIFFTileRowSize(image());
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(tileBytes > 0 && tileRowBytes > 0, false);
+
+    const bool compressConcurrently = canCompressConcurrently(m_options->compressionType);
+
+    struct TileJob {
+        QPoint pos;
+        QByteArray data;
+        bool success = false;
+    };
+
+    QVector<TileJob> tiles;
+    for (int y = 0; y < size.height(); y += tileSize) {
+        for (int x = 0; x < size.width(); x += tileSize) {
+            tiles.append({QPoint(x, y), QByteArray(), false});
+        }
+    }
+
+    // keep the amount of the tiles waiting to be written bounded
+    const int batchSize = qMax(1, QThread::idealThreadCount()) * 4;
+
+    for (int batchStart = 0; batchStart < tiles.size(); batchStart += batchSize) {
+        QVector<TileJob> batch = tiles.mid(batchStart, batchSize);
+
+        QtConcurrent::blockingMap(batch, [&](TileJob &job) {
+            QByteArray pixels(static_cast<int>(tileBytes), 0);
+
+            // the pixels of the edge tiles outside the image are zeroed,
+            // the device may have content there, so it is not copied
+            const int rows = qMin(tileSize, size.height() - job.pos.y());
+            const int columns = qMin(tileSize, size.width() - job.pos.x());
+            for (int row = 0; row < rows; row++) {
+                if (!copyRowData(pd,
+                                 job.pos.x(),
+                                 job.pos.y() + row,
+                                 columns,
+                                 pixels.data() + row * tileRowBytes,
+                                 format)) {
+                    return;
+                }
+            }
+
+            if (compressConcurrently) {
+                job.success = encodeTile(pixels, format, &job.data);
+            } else {
+                job.data = pixels;
+                job.success = true;
+            }
+        });
+
+        for (TileJob &job : batch) {
+            if (!job.success) {
+                return false;
+            }
+
+            const ttile_t tile = TIFFComputeTile(image(),
+                                                 static_cast<uint32_t>(job.pos.x()),
+                                                 static_cast<uint32_t>(job.pos.y()),
+                                                 0,
+                                                 0);
+            const tmsize_t written = compressConcurrently
+                ? TIFFWriteRawTile(image(), tile, job.data.data(), job.data.size())
+                : TIFFWriteEncodedTile(image(), tile, job.data.data(), job.data.size());
+
+            if (written < 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool KisTIFFWriterVisitor::encodeTile(const QByteArray &pixels, const LayerFormat &format, QByteArray *result) const
+{
+    MemoryTiffFile file;
+    std::unique_ptr<TIFF, decltype(&TIFFCleanup)> tiff(TIFFClientOpen("tile",
+                                                                      "w",
+                                                                      &file,
+                                                                      &MemoryTiffFile::read,
+                                                                      &MemoryTiffFile::write,
+                                                                      &MemoryTiffFile::seek,
+                                                                      &MemoryTiffFile::close,
+                                                                      &MemoryTiffFile::size,
+                                                                      &MemoryTiffFile::map,
+                                                                      &MemoryTiffFile::unmap),
+                                                       &TIFFCleanup);
+    if (!tiff) {
+        return false;
+    }
+
+    // a single tile image with the same codec setup as the target file
+    writeLayoutTags(tiff.get(), QSize(m_options->tileSize, m_options->tileSize), format);
+
+    QByteArray data(pixels);
+    if (TIFFWriteEncodedTile(tiff.get(), 0, data.data(), data.size()) < 0) {
+        return false;
+    }
+
+    uint64_t *offsets = nullptr;
+    uint64_t *byteCounts = nullptr;
+    if (!TIFFGetField(tiff.get(), TIFFTAG_TILEOFFSETS, &offsets)
+        || !TIFFGetField(tiff.get(), TIFFTAG_TILEBYTECOUNTS, &byteCounts)
+        || !offsets || !byteCounts
+        || offsets[0] + byteCounts[0] > static_cast<uint64_t>(file.data.size())) {
+        return false;
+    }
+
+    *result = file.data.mid(static_cast<int>(offsets[0]), static_cast<int>(byteCounts[0]));
+    return true;
 }
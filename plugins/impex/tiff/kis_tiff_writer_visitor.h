@@ -96,13 +96,40 @@ private:
     inline TIFF* image() {
         return m_image;
     }
+    struct LayerFormat {
+        uint32_t depth;
+        uint16_t sampleFormat;
+        uint16_t colorType;
+        quint32 channelCount;
+    };
+
     bool copyDataToStrips(KisHLineConstIteratorSP it,
                           tdata_t buff,
                           uint32_t depth,
                           uint16_t sample_format,
                           uint8_t nbcolorssamples,
                           const std::array<quint8, 5> &poses);
+    bool copyRowData(KisPaintDeviceSP pd, int x, int y, int width, tdata_t buff, const LayerFormat &format);
     bool saveLayerProjection(KisLayer *);
+
+    /**
+     * Sets the tags describing the pixel layout, the compression and the
+     * strips or tiles of the directory being written into \p tiff
+     */
+    void writeLayoutTags(TIFF *tiff, const QSize &size, const LayerFormat &format) const;
+
+    bool writeStrips(KisPaintDeviceSP pd, const QSize &size, const LayerFormat &format);
+
+    /**
+     * Writes the image in tiles. The tiles are filled and, for the codecs
+     * that allow it, compressed concurrently. Since the codec state of
+     * libtiff lives in the TIFF handle, every tile is compressed by a
+     * separate in-memory TIFF with the same tags, and the compressed data
+     * is copied into the file with TIFFWriteRawTile.
+     */
+    bool writeTiles(KisPaintDeviceSP pd, const QSize &size, const LayerFormat &format);
+
+    bool encodeTile(const QByteArray &pixels, const LayerFormat &format, QByteArray *result) const;
 private:
     TIFF* m_image;
     KisTIFFOptions* m_options;
@@ -10,6 +10,9 @@
 #include <simpletest.h>
 #include <QCoreApplication>
 
+#include <memory>
+#include <tiffio.h>
+
 #include "filestest.h"
 
 #include <KoColorModelStandardIds.h>
@@ -17,6 +20,7 @@
 
 #include <KoColorModelStandardIdsUtils.h>
 #include <kis_meta_data_backend_registry.h>
+#include <kis_sequential_iterator.h>
 #include <testui.h>
 
 #include <config-jpeg.h>
@@ -138,6 +142,147 @@ void KisTiffTest::testImportIncorrectFormat()
 }
 
 
+void KisTiffTest::testTiledRoundTrip_data()
+{
+    QTest::addColumn<int>("compressionType");
+    QTest::addColumn<bool>("pyramid");
+
+    // the indexes of KisTIFFOptions::fromProperties()
+    QTest::newRow("none") << 0 << false;
+    QTest::newRow("deflate") << 2 << false;
+    QTest::newRow("lzw") << 3 << false;
+    QTest::newRow("deflate-pyramid") << 2 << true;
+}
+
+void KisTiffTest::testTiledRoundTrip()
+{
+    QFETCH(int, compressionType);
+    QFETCH(bool, pyramid);
+
+    // not aligned to the tiles, so the edge tiles are padded
+    const QRect bounds(0, 0, 1000, 700);
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP original;
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        KisImageSP image = new KisImage(0, bounds.width(), bounds.height(), cs, "tiff test");
+
+        KisPaintLayerSP layer = new KisPaintLayer(image, "paint0", OPACITY_OPAQUE_U8);
+        KisSequentialIterator it(layer->paintDevice(), bounds);
+        while (it.nextPixel()) {
+            quint8 *dst = it.rawData();
+            dst[0] = quint8(it.x() * 7 + it.y());
+            dst[1] = quint8(it.y() * 3);
+            dst[2] = quint8(it.x() ^ it.y());
+            dst[3] = 255;
+        }
+        image->addNode(layer, image->root());
+        image->initialRefreshGraph();
+
+        original = new KisPaintDevice(*layer->paintDevice());
+
+        doc->setFileBatchMode(true);
+        doc->setCurrentImage(image);
+
+        KisPropertiesConfigurationSP exportConfiguration = new KisPropertiesConfiguration();
+        exportConfiguration->setProperty("compressiontype", compressionType);
+        exportConfiguration->setProperty("tiled", true);
+        exportConfiguration->setProperty("tileSize", 256);
+        exportConfiguration->setProperty("pyramid", pyramid);
+        QVERIFY(doc->exportDocumentSync("test_tiled.tif", TiffMimetype.toLatin1(), exportConfiguration));
+    }
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        KisImportExportManager manager(doc.data());
+        doc->setFileBatchMode(true);
+
+        const KisImportExportErrorCode status = manager.importDocument("test_tiled.tif", QString());
+        QVERIFY(status.isOk());
+
+        KisImageSP image = doc->image();
+        QCOMPARE(image->bounds(), bounds);
+
+        // the pyramid levels must not be loaded as layers
+        QCOMPARE(image->root()->childCount(), 1U);
+
+        QVERIFY(TestUtil::comparePaintDevicesClever<uint8_t>(original,
+                                                             image->root()->firstChild()->paintDevice(),
+                                                             0));
+    }
+}
+
+void KisTiffTest::testTiledContentOutsideImage()
+{
+    // the width is not a multiple of the tile size
+    const QRect bounds(0, 0, 300, 100);
+    const int tileSize = 256;
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        KisImageSP image = new KisImage(0, bounds.width(), bounds.height(), cs, "tiff test");
+
+        KisPaintLayerSP layer = new KisPaintLayer(image, "paint0", OPACITY_OPAQUE_U8);
+        layer->paintDevice()->fill(bounds, KoColor(Qt::green, cs));
+
+        // e.g. a part of the layer moved off the canvas
+        layer->paintDevice()->fill(QRect(300, 0, 300, 100), KoColor(Qt::red, cs));
+        layer->paintDevice()->fill(QRect(0, 100, 600, 300), KoColor(Qt::red, cs));
+
+        image->addNode(layer, image->root());
+        image->initialRefreshGraph();
+
+        doc->setFileBatchMode(true);
+        doc->setCurrentImage(image);
+
+        KisPropertiesConfigurationSP exportConfiguration = new KisPropertiesConfiguration();
+        exportConfiguration->setProperty("compressiontype", 0);
+        exportConfiguration->setProperty("tiled", true);
+        exportConfiguration->setProperty("tileSize", tileSize);
+        // the layer is written directly, the projection doesn't have
+        // anything outside the image
+        exportConfiguration->setProperty("flatten", false);
+        exportConfiguration->setProperty("saveAsPhotoshop", false);
+        QVERIFY(doc->exportDocumentSync("test_tiled_outside.tif", TiffMimetype.toLatin1(), exportConfiguration));
+    }
+
+    std::unique_ptr<TIFF, decltype(&TIFFClose)> tiff(TIFFOpen("test_tiled_outside.tif", "r"), &TIFFClose);
+    QVERIFY(tiff);
+    QVERIFY(TIFFIsTiled(tiff.get()));
+
+    const tmsize_t rowBytes = TIFFTileRowSize(tiff.get());
+    const int pixelSize = int(rowBytes / tileSize);
+    QVERIFY(pixelSize >= 3);
+
+    // the right edge tile: 44 columns and 100 rows of it are inside the image
+    QByteArray data(int(TIFFTileSize(tiff.get())), 'x');
+    QVERIFY(TIFFReadTile(tiff.get(), data.data(), 256, 0, 0, 0) > 0);
+
+    const int columnsInside = bounds.width() - 256;
+
+    for (int y = 0; y < tileSize; y++) {
+        for (int x = 0; x < tileSize; x++) {
+            const quint8 *pixel = reinterpret_cast<const quint8*>(data.constData()) + y * rowBytes + x * pixelSize;
+
+            if (x < columnsInside && y < bounds.height()) {
+                QCOMPARE(int(pixel[0]), 0);
+                QCOMPARE(int(pixel[1]), 255);
+                QCOMPARE(int(pixel[2]), 0);
+            } else {
+                for (int i = 0; i < pixelSize; i++) {
+                    if (pixel[i] != 0) {
+                        QFAIL(QString("Padding pixel (%1, %2) is not zeroed").arg(256 + x).arg(y).toLatin1());
+                    }
+                }
+            }
+        }
+    }
+}
 
 KISTEST_MAIN(KisTiffTest)
 
@@ -25,6 +25,10 @@ private Q_SLOTS:
     void testImportFromWriteonly();
     void testExportToReadonly();
     void testImportIncorrectFormat();
+
+    void testTiledRoundTrip_data();
+    void testTiledRoundTrip();
+    void testTiledContentOutsideImage();
 };
 
 #endif
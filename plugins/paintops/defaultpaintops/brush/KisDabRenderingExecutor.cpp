@@ -24,13 +24,14 @@ KisDabRenderingExecutor::KisDabRenderingExecutor(const KoColorSpace *cs,
                                                  KisDabCacheUtils::ResourcesFactory resourcesFactory,
                                                  KisRunnableStrokeJobsInterface *runnableJobsInterface,
                                                  KisMirrorOption *mirrorOption,
-                                                 KisPrecisionOption *precisionOption)
+                                                 KisPrecisionOption *precisionOption,
+                                                 KisOptimizedByteArray::MemoryAllocatorSP dabAllocator)
     : m_d(new Private)
 {
     m_d->runnableJobsInterface = runnableJobsInterface;
 
     m_d->renderingQueue.reset(
-        new KisDabRenderingQueue(cs, resourcesFactory));
+        new KisDabRenderingQueue(cs, resourcesFactory, dabAllocator));
 
     KisDabRenderingQueueCache *cache = new KisDabRenderingQueueCache();
     cache->setMirrorPostprocessing(mirrorOption);
@@ -15,6 +15,7 @@
 struct KisRenderedDab;
 
 #include "KisDabCacheUtils.h"
+#include "KisOptimizedByteArray.h"
 
 class KisMirrorOption;
 class KisPrecisionOption;
@@ -28,7 +29,8 @@ public:
                             KisDabCacheUtils::ResourcesFactory resourcesFactory,
                             KisRunnableStrokeJobsInterface *runnableJobsInterface,
                             KisMirrorOption *mirrorOption = 0,
-                            KisPrecisionOption *precisionOption = 0);
+                            KisPrecisionOption *precisionOption = 0,
+                            KisOptimizedByteArray::MemoryAllocatorSP dabAllocator = KisOptimizedByteArray::MemoryAllocatorSP());
     ~KisDabRenderingExecutor();
 
     void addDab(const KisDabCacheUtils::DabRequestInfo &request,
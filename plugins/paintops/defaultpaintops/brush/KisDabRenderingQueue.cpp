@@ -45,11 +45,14 @@ struct KisDabRenderingQueue::Private
     };
 
     Private(const KoColorSpace *_colorSpace,
-            KisDabCacheUtils::ResourcesFactory _resourcesFactory)
+            KisDabCacheUtils::ResourcesFactory _resourcesFactory,
+            KisOptimizedByteArray::MemoryAllocatorSP _paintDeviceAllocator)
         : cacheInterface(new DumbCacheInterface),
           colorSpace(_colorSpace),
           resourcesFactory(_resourcesFactory),
-          paintDeviceAllocator(new KisOptimizedByteArray::PooledMemoryAllocator()),
+          paintDeviceAllocator(_paintDeviceAllocator ?
+                                   _paintDeviceAllocator :
+                                   KisOptimizedByteArray::MemoryAllocatorSP(new KisOptimizedByteArray::PooledMemoryAllocator())),
           avgExecutionTime(50),
           avgDabSize(50)
     {
@@ -76,7 +79,7 @@ struct KisDabRenderingQueue::Private
     KisDabCacheUtils::ResourcesFactory resourcesFactory;
 
     QList<KisDabCacheUtils::DabRenderingResources*> cachedResources;
-    QSharedPointer<KisOptimizedByteArray::MemoryAllocator> paintDeviceAllocator;
+    KisOptimizedByteArray::MemoryAllocatorSP paintDeviceAllocator;
 
     QMutex mutex;
 
@@ -94,8 +97,9 @@ struct KisDabRenderingQueue::Private
 
 
 KisDabRenderingQueue::KisDabRenderingQueue(const KoColorSpace *cs,
-                                           KisDabCacheUtils::ResourcesFactory resourcesFactory)
-    : m_d(new Private(cs, resourcesFactory))
+                                           KisDabCacheUtils::ResourcesFactory resourcesFactory,
+                                           KisOptimizedByteArray::MemoryAllocatorSP dabAllocator)
+    : m_d(new Private(cs, resourcesFactory, dabAllocator))
 {
 }
 
@@ -16,6 +16,7 @@ class KisDabRenderingJob;
 struct KisRenderedDab;
 
 #include "KisDabCacheUtils.h"
+#include "KisOptimizedByteArray.h"
 
 class KRITADEFAULTPAINTOPS_EXPORT KisDabRenderingQueue
 {
@@ -34,7 +35,14 @@ public:
 
 
 public:
-    KisDabRenderingQueue(const KoColorSpace *cs, KisDabCacheUtils::ResourcesFactory resourcesFactory);
+    /**
+     * The dabs are allocated with \p dabAllocator, which is usually the
+     * stroke-wide pool provided by the painter. When no allocator is
+     * passed, the queue creates a pool of its own.
+     */
+    KisDabRenderingQueue(const KoColorSpace *cs,
+                         KisDabCacheUtils::ResourcesFactory resourcesFactory,
+                         KisOptimizedByteArray::MemoryAllocatorSP dabAllocator = KisOptimizedByteArray::MemoryAllocatorSP());
     ~KisDabRenderingQueue();
 
     KisDabRenderingJobSP addDab(const KisDabCacheUtils::DabRequestInfo &request,
@@ -94,7 +94,8 @@ KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter,
                     resourcesFactory,
                     painter->runnableStrokeJobsInterface(),
                     &m_mirrorOption,
-                    &m_precisionOption));
+                    &m_precisionOption,
+                    painter->memoryAllocator()));
 }
 
 KisBrushOp::~KisBrushOp()